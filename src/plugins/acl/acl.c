@@ -277,7 +277,18 @@ validate_and_reset_acl_counters (acl_main_t * am, u32 acl_index)
 
   int old_len = vec_len (am->combined_acl_counters);
 
-  vec_validate (am->combined_acl_counters, acl_index);
+  if (acl_index >= vec_max_len (am->combined_acl_counters))
+    {
+      /* the workers count into the vector, publish a bigger copy */
+      vlib_combined_counter_main_t *old = am->combined_acl_counters, *cms = 0;
+
+      vec_validate (cms, acl_index);
+      clib_memcpy_fast (cms, old, vec_bytes (old));
+      __atomic_store_n (&am->combined_acl_counters, cms, __ATOMIC_RELEASE);
+      vlib_rcu_vec_free (old);
+    }
+  else
+    vec_validate (am->combined_acl_counters, acl_index);
 
   for (i = old_len; i < vec_len (am->combined_acl_counters); i++)
     {
@@ -317,7 +328,7 @@ acl_add_list (u32 count, vl_api_acl_rule_t rules[],
   acl_main_t *am = &acl_main;
   acl_list_t *a;
   acl_rule_t *r;
-  acl_rule_t *acl_new_rules = 0;
+  acl_rule_t *acl_new_rules = 0, *acl_old_rules = 0;
   size_t tag_len;
   int i;
 
@@ -390,8 +401,8 @@ acl_add_list (u32 count, vl_api_acl_rule_t rules[],
 
   if (~0 == *acl_list_index)
     {
-      /* Get ACL index */
-      pool_get_aligned (am->acls, a, CLIB_CACHE_LINE_BYTES);
+      /* Get ACL index, the workers may be reading the pool */
+      vlib_rcu_pool_get_aligned (am->acls, a, CLIB_CACHE_LINE_BYTES);
       clib_memset (a, 0, sizeof (*a));
       /* Will return the newly allocated ACL index */
       *acl_list_index = a - am->acls;
@@ -399,11 +410,11 @@ acl_add_list (u32 count, vl_api_acl_rule_t rules[],
   else
     {
       a = am->acls + *acl_list_index;
-      /* Get rid of the old rules */
-      if (a->rules)
-	vec_free (a->rules);
+      acl_old_rules = a->rules;
     }
-  a->rules = acl_new_rules;
+  __atomic_store_n (&a->rules, acl_new_rules, __ATOMIC_RELEASE);
+  /* Get rid of the old rules once the workers are done with them */
+  vlib_rcu_vec_free (acl_old_rules);
   memcpy (a->tag, tag, tag_len + 1);
   if (am->trace_acl > 255)
     warning_acl_print_acl (am->vlib_main, am, *acl_list_index);
@@ -431,11 +442,21 @@ acl_is_used_by (u32 acl_index, u32 ** foo_index_vec_by_acl)
   return 0;
 }
 
+static int
+acl_is_in_use (acl_main_t *am, u32 acl_index)
+{
+  return (acl_is_used_by (acl_index, am->input_sw_if_index_vec_by_acl) ||
+	  acl_is_used_by (acl_index, am->output_sw_if_index_vec_by_acl) ||
+	  acl_is_used_by (acl_index, am->lc_index_vec_by_acl));
+}
+
 static int
 acl_del_list (u32 acl_list_index)
 {
   acl_main_t *am = &acl_main;
   acl_list_t *a;
+  u8 need_barrier_sync;
+
   if (pool_is_free_index (am->acls, acl_list_index))
     {
       return VNET_API_ERROR_NO_SUCH_ENTRY;
@@ -450,9 +471,17 @@ acl_del_list (u32 acl_list_index)
 
   /* now we can delete the ACL itself */
   a = pool_elt_at_index (am->acls, acl_list_index);
-  if (a->rules)
-    vec_free (a->rules);
+  vlib_rcu_vec_free (a->rules);
+
+  /* the workers check the free bitmap of the pool */
+  need_barrier_sync = pool_put_will_expand (am->acls, a);
+  if (PREDICT_FALSE (need_barrier_sync))
+    vlib_worker_thread_barrier_sync (vlib_get_main ());
+
   pool_put (am->acls, a);
+
+  if (PREDICT_FALSE (need_barrier_sync))
+    vlib_worker_thread_barrier_release (vlib_get_main ());
   /* acl_list_index is now free, notify the lookup contexts */
   acl_plugin_lookup_context_notify_acl_change (acl_list_index);
   return 0;
@@ -1794,10 +1823,26 @@ vl_api_acl_add_replace_t_handler (vl_api_acl_add_replace_t * mp)
   u32 acl_list_index = ntohl (mp->acl_index);
   u32 acl_count = ntohl (mp->count);
   u64 expected_len = sizeof (*mp) + acl_count * sizeof (mp->r[0]);
+  u8 need_barrier_sync;
 
   if (verify_message_len (mp, expected_len, "acl_add_replace"))
     {
+      /*
+       * the workers only see an ACL once it is applied, so the barrier
+       * is only needed to replace one in use, whose hash tables are
+       * rebuilt in place. Building them aside and publishing them would
+       * need the applied hash ACEs to be replaced by copy, which they
+       * are not yet.
+       */
+      need_barrier_sync =
+	(acl_list_index != ~0 && acl_is_in_use (am, acl_list_index));
+      if (need_barrier_sync)
+	vlib_worker_thread_barrier_sync (vlib_get_main ());
+
       rv = acl_add_list (acl_count, mp->r, &acl_list_index, mp->tag);
+
+      if (need_barrier_sync)
+	vlib_worker_thread_barrier_release (vlib_get_main ());
     }
   else
     {
@@ -3942,6 +3987,13 @@ acl_init (vlib_main_t * vm)
   /* Ask for a correctly-sized block of API message decode slots */
   am->msg_id_base = setup_message_id_table ();
 
+  /* ACLs that are not applied are added, replaced and deleted without
+     the barrier */
+  vl_api_set_msg_thread_safe (vlibapi_get_main (),
+			      am->msg_id_base + VL_API_ACL_ADD_REPLACE, 1);
+  vl_api_set_msg_thread_safe (vlibapi_get_main (),
+			      am->msg_id_base + VL_API_ACL_DEL, 1);
+
   error = acl_plugin_exports_init (&acl_plugin);
 
   if (error)
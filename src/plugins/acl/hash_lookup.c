@@ -275,7 +275,8 @@ assign_mask_type_index(acl_main_t *am, fa_5tuple_t *mask)
   u32 mask_type_index = find_mask_type_index(am, mask);
   ace_mask_type_entry_t *mte;
   if(~0 == mask_type_index) {
-    pool_get_aligned (am->ace_mask_type_pool, mte, CLIB_CACHE_LINE_BYTES);
+    /* the workers may be reading the pool */
+    vlib_rcu_pool_get_aligned (am->ace_mask_type_pool, mte, CLIB_CACHE_LINE_BYTES);
     mask_type_index = mte - am->ace_mask_type_pool;
     clib_memcpy_fast(&mte->mask, mask, sizeof(mte->mask));
     mte->refcount = 0;
@@ -294,8 +294,9 @@ single_acl_match_5tuple (acl_main_t * am, u32 acl_index, fa_5tuple_t * pkt_5tupl
   int i;
   acl_rule_t *r;
   acl_rule_t *acl_rules;
+  acl_list_t *acls = vlib_rcu_deref (am->acls);
 
-  if (pool_is_free_index (am->acls, acl_index))
+  if (pool_is_free_index (acls, acl_index))
     {
       if (r_acl_match_p)
 	*r_acl_match_p = acl_index;
@@ -304,7 +305,7 @@ single_acl_match_5tuple (acl_main_t * am, u32 acl_index, fa_5tuple_t * pkt_5tupl
       /* the ACL does not exist but is used for policy. Block traffic. */
       return 0;
     }
-  acl_rules = am->acls[acl_index].rules;
+  acl_rules = vlib_rcu_deref (acls[acl_index].rules);
   for (i = 0; i < vec_len(acl_rules); i++)
     {
       r = &acl_rules[i];
@@ -462,7 +463,8 @@ match_portranges(acl_main_t *am, fa_5tuple_t *match, u32 index)
   applied_hash_ace_entry_t **applied_hash_aces = vec_elt_at_index(am->hash_entry_vec_by_lc_index, match->pkt.lc_index);
   applied_hash_ace_entry_t *pae = vec_elt_at_index((*applied_hash_aces), index);
 
-  acl_rule_t *r = &(am->acls[pae->acl_index].rules[pae->ace_index]);
+  acl_list_t *acls = vlib_rcu_deref (am->acls);
+  acl_rule_t *r = &(acls[pae->acl_index].rules[pae->ace_index]);
 
 #ifdef FA_NODE_VERBOSE_DEBUG
   clib_warning("PORTMATCH: %d <= %d <= %d && %d <= %d <= %d ?",
@@ -570,8 +572,8 @@ multi_acl_match_get_applied_ace_index (acl_main_t * am, int is_ip6, fa_5tuple_t
 	}
 
       mask_type_index = minfo->mask_type_index;
-      ace_mask_type_entry_t *mte =
-	vec_elt_at_index (am->ace_mask_type_pool, mask_type_index);
+      ace_mask_type_entry_t *mtes = vlib_rcu_deref (am->ace_mask_type_pool);
+      ace_mask_type_entry_t *mte = vec_elt_at_index (mtes, mask_type_index);
       pmatch = (u64 *) match;
       pmask = (u64 *) & mte->mask;
       pkey = (u64 *) kv.key;
@@ -717,7 +719,8 @@ acl_plugin_match_5tuple_inline_and_count (void *p_acl_main, u32 lc_index,
   if (PREDICT_TRUE(ret)) {
     clib_thread_index_t thread_index = os_get_thread_index ();
     vlib_increment_combined_counter (
-      am->combined_acl_counters + *r_acl_match_p, thread_index,
+      vlib_rcu_deref (am->combined_acl_counters) + *r_acl_match_p,
+      thread_index,
       *r_rule_match_p, 1, packet_size);
   }
   return ret;
@@ -424,7 +424,8 @@ dpdk_ops_vpp_get_count (const struct rte_mempool *mp)
       vlib_buffer_pool_t *pool = vlib_get_buffer_pool (vm, mp->pool_id);
       if (pool)
 	{
-	  return pool->n_avail;
+	  /* buffers parked in full magazines are free too */
+	  return pool->n_avail + vlib_buffer_pool_n_magazine_buffers (pool);
 	}
     }
   return 0;
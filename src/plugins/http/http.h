@@ -87,6 +87,8 @@ typedef enum http_msg_type_
   _ (APP_ODS, ".ods", "application/vnd.oasis.opendocument.spreadsheet")       \
   _ (APP_ODT, ".odt", "application/vnd.oasis.opendocument.text")              \
   _ (APP_OGX, ".ogx", "application/ogg")                                      \
+  _ (APP_OPENMETRICS, ".om",                                                   \
+     "application/openmetrics-text; version=1.0.0; charset=utf-8")           \
   _ (APP_PDF, ".pdf", "application/pdf")                                      \
   _ (APP_PHP, ".php", "application/x-httpd-php")                              \
   _ (APP_PPT, ".ppt", "application/vnd.ms-powerpoint")                        \
@@ -2823,13 +2823,23 @@ nat44_ei_worker_db_init (nat44_ei_main_per_thread_data_t *tnm,
 			 u32 translations, u32 translation_buckets,
 			 u32 user_buckets)
 {
+  nat44_ei_main_t *nm = &nat44_ei_main;
+  clib_bihash_init2_args_8_8_t _a, *a = &_a;
   dlist_elt_t *head;
 
   pool_alloc (tnm->list_pool, translations);
   pool_alloc (tnm->lru_pool, translations);
   pool_alloc (tnm->sessions, translations);
 
-  clib_bihash_init_8_8 (&tnm->user_hash, "users", user_buckets, 0);
+  clib_memset (a, 0, sizeof (*a));
+  a->h = &tnm->user_hash;
+  a->name = "users";
+  a->nbuckets = user_buckets;
+  /* only its thread searches the table, keep it on that thread's node */
+  if (vlib_get_thread_main ()->numa_local)
+    a->heap = vlib_numa_heap (
+      vlib_worker_threads[tnm - nm->per_thread_data].numa_id);
+  clib_bihash_init2_8_8 (a);
 
   clib_bihash_set_kvp_format_fn_8_8 (&tnm->user_hash,
 				     format_nat44_ei_user_kvp);
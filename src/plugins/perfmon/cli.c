@@ -511,6 +511,9 @@ static clib_error_t *
 perfmon_reset_command_fn (vlib_main_t *vm, unformat_input_t *input,
 			  vlib_cli_command_t *cmd)
 {
+  if (perfmon_main.monitor.is_enabled)
+    return clib_error_return (0, "please turn perfmon monitor off first");
+
   perfmon_reset (vm);
   return 0;
 }
@@ -531,6 +534,9 @@ perfmon_start_command_fn (vlib_main_t *vm, unformat_input_t *input,
   perfmon_bundle_t *b = 0;
   perfmon_bundle_type_t bundle_type = PERFMON_BUNDLE_TYPE_UNKNOWN;
 
+  if (pm->monitor.is_enabled)
+    return clib_error_return (0, "please turn perfmon monitor off first");
+
   if (pm->is_running)
     return clib_error_return (0, "please stop first");
 
@@ -583,6 +589,9 @@ static clib_error_t *
 perfmon_stop_command_fn (vlib_main_t *vm, unformat_input_t *input,
 			 vlib_cli_command_t *cmd)
 {
+  if (perfmon_main.monitor.is_enabled)
+    return clib_error_return (0, "please turn perfmon monitor off first");
+
   return perfmon_stop (vm);
 }
 
@@ -592,3 +601,89 @@ VLIB_CLI_COMMAND (perfmon_stop_command, static) = {
   .function = perfmon_stop_command_fn,
   .is_mp_safe = 1,
 };
+
+static clib_error_t *
+perfmon_monitor_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			    vlib_cli_command_t *cmd)
+{
+  perfmon_monitor_t *mon = &perfmon_main.monitor;
+  unformat_input_t _line_input, *line_input = &_line_input;
+  perfmon_bundle_t *b = 0, **bundles = 0;
+  clib_error_t *err = 0;
+  f64 interval = mon->interval;
+  u32 duty = mon->duty_cycle * 100;
+  int is_off = 0;
+
+  if (unformat_user (input, unformat_line_input, line_input))
+    {
+      while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+	{
+	  if (unformat (line_input, "bundle %U", unformat_perfmon_bundle_name,
+			&b))
+	    vec_add1 (bundles, b);
+	  else if (unformat (line_input, "interval %f", &interval))
+	    ;
+	  else if (unformat (line_input, "duty-cycle %u", &duty))
+	    ;
+	  else if (unformat (line_input, "off"))
+	    is_off = 1;
+	  else
+	    {
+	      err = clib_error_return (0, "unknown input '%U'",
+				       format_unformat_error, line_input);
+	      break;
+	    }
+	}
+      unformat_free (line_input);
+    }
+
+  if (err == 0)
+    {
+      if (is_off)
+	perfmon_monitor_disable (vm);
+      else
+	err = perfmon_monitor_enable (vm, bundles, interval, duty / 100.0);
+    }
+
+  vec_free (bundles);
+  return err;
+}
+
+VLIB_CLI_COMMAND (perfmon_monitor_command, static) = {
+  .path = "perfmon monitor",
+  .short_help = "perfmon monitor [bundle <bundle-name>]... "
+		"[interval <seconds>] [duty-cycle <percent>] | off",
+  .function = perfmon_monitor_command_fn,
+};
+
+static clib_error_t *
+show_perfmon_monitor_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				 vlib_cli_command_t *cmd)
+{
+  perfmon_monitor_t *mon = &perfmon_main.monitor;
+  perfmon_monitor_bundle_t *mb;
+
+  vlib_cli_output (vm, "monitor %s, interval %.2fs, duty cycle %u%%",
+		   mon->is_enabled ? "on" : "off", mon->interval,
+		   (u32) (mon->duty_cycle * 100));
+  vlib_cli_output (vm, "skipped while perfmon ran: %lu, errors: %lu",
+		   mon->n_busy, mon->n_errors);
+
+  for (int i = 0; i < vec_len (mon->rotation); i++)
+    {
+      mb = vec_elt_at_index (mon->bundles, mon->rotation[i]);
+      vlib_cli_output (vm, "  %-20s windows %lu%s", mb->bundle->name,
+		       mb->n_windows,
+		       mon->active_bundle_index == mon->rotation[i] ?
+			 " (running)" :
+			 "");
+    }
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_perfmon_monitor_command, static) = {
+  .path = "show perfmon monitor",
+  .short_help = "show perfmon monitor",
+  .function = show_perfmon_monitor_command_fn,
+  .is_mp_safe = 1,
+};
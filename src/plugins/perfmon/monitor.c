@@ -0,0 +1,382 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+/*
+ * Always-on node bundle monitor.
+ *
+ * Runs node bundles in turn, each for a share (the duty cycle) of the
+ * interval, and adds what every node measured in that window to per node
+ * counters in the stats segment:
+ *
+ *   /perfmon/monitor/<bundle>/calls
+ *   /perfmon/monitor/<bundle>/packets
+ *   /perfmon/monitor/<bundle>/<event>
+ *
+ * indexed by thread and node index, as /sys/node/names. Ratios such as
+ * IPC or misses per packet are taken between counters of the same bundle,
+ * which are measured over the same windows.
+ */
+
+#include <vnet/vnet.h>
+#include <perfmon/perfmon.h>
+
+VLIB_REGISTER_LOG_CLASS (perfmon_monitor_log, static) = {
+  .class_name = "perfmon",
+  .subclass_name = "monitor",
+};
+
+#define log_warn(fmt, ...)                                                    \
+  vlib_log_warn (perfmon_monitor_log.class, fmt, __VA_ARGS__)
+
+typedef enum
+{
+  PERFMON_MONITOR_EVENT_CONFIG = 1,
+} perfmon_monitor_event_t;
+
+/* bundles monitored when none are given, the first ones found are used */
+static char *perfmon_monitor_default_bundles[] = {
+  "inst-and-clock", "cache-hierarchy", "branch-mispred",
+  "cache-data",	    "branch-pred",
+};
+
+static int
+perfmon_monitor_bundle_is_supported (perfmon_bundle_t *b)
+{
+  return (b->type_flags & PERFMON_BUNDLE_TYPE_NODE_FLAG) &&
+	 b->preserve_samples == 0 && b->src->config_dispatch_wrapper;
+}
+
+static u32
+perfmon_monitor_bundle_index (perfmon_bundle_t *b)
+{
+  perfmon_monitor_t *mon = &perfmon_main.monitor;
+  perfmon_monitor_bundle_t *mb;
+  perfmon_event_t *e;
+  uword *p;
+
+  p = hash_get_mem (mon->bundle_index_by_name, b->name);
+  if (p)
+    return p[0];
+
+  vec_add2 (mon->bundles, mb, 1);
+  mb->bundle = b;
+  mb->calls.stat_segment_name =
+    (char *) format (0, "/perfmon/monitor/%s/calls%c", b->name, 0);
+  vlib_validate_simple_counter (&mb->calls, 0);
+  mb->packets.stat_segment_name =
+    (char *) format (0, "/perfmon/monitor/%s/packets%c", b->name, 0);
+  vlib_validate_simple_counter (&mb->packets, 0);
+
+  /* the dispatch wrapper skips events which are not implemented */
+  for (int i = 0; i < b->n_events; i++)
+    {
+      e = b->src->events + b->events[i];
+      if (!e->implemented)
+	continue;
+      mb->events[mb->n_events].stat_segment_name =
+	(char *) format (0, "/perfmon/monitor/%s/%s%c", b->name, e->name, 0);
+      vlib_validate_simple_counter (&mb->events[mb->n_events], 0);
+      mb->n_events++;
+    }
+
+  hash_set_mem (mon->bundle_index_by_name, b->name, mb - mon->bundles);
+  return mb - mon->bundles;
+}
+
+clib_error_t *
+perfmon_monitor_enable (vlib_main_t *vm, perfmon_bundle_t **bundles,
+			f64 interval, f64 duty_cycle)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  perfmon_monitor_t *mon = &pm->monitor;
+  perfmon_bundle_t *b, **default_bundles = 0;
+  u32 *rotation = 0;
+  uword *p;
+
+  if (pm->is_running && mon->active_bundle_index == ~0)
+    return clib_error_return (0, "please stop perfmon first");
+
+  if (interval <= 0 || duty_cycle <= 0 || duty_cycle > 1)
+    return clib_error_return (0, "invalid interval or duty cycle");
+
+  if (vec_len (bundles) == 0)
+    {
+      for (int i = 0; i < ARRAY_LEN (perfmon_monitor_default_bundles); i++)
+	{
+	  p = hash_get_mem (pm->bundle_by_name,
+			    perfmon_monitor_default_bundles[i]);
+	  b = p ? (perfmon_bundle_t *) p[0] : 0;
+	  if (b && perfmon_monitor_bundle_is_supported (b))
+	    vec_add1 (default_bundles, b);
+	}
+      if (vec_len (default_bundles) == 0)
+	return clib_error_return (0, "no default bundles on this cpu");
+      bundles = default_bundles;
+    }
+
+  for (int i = 0; i < vec_len (bundles); i++)
+    {
+      b = bundles[i];
+      if (!perfmon_monitor_bundle_is_supported (b))
+	{
+	  vec_free (default_bundles);
+	  vec_free (rotation);
+	  return clib_error_return (0, "bundle '%s' can't be monitored",
+				    b->name);
+	}
+      vec_add1 (rotation, perfmon_monitor_bundle_index (b));
+    }
+  vec_free (default_bundles);
+
+  vec_free (mon->rotation);
+  mon->rotation = rotation;
+  mon->next = 0;
+  mon->interval = interval;
+  mon->duty_cycle = duty_cycle;
+  mon->is_enabled = 1;
+
+  vlib_process_signal_event (vm, mon->node_index,
+			     PERFMON_MONITOR_EVENT_CONFIG, 0);
+  return 0;
+}
+
+void
+perfmon_monitor_disable (vlib_main_t *vm)
+{
+  perfmon_monitor_t *mon = &perfmon_main.monitor;
+
+  if (!mon->is_enabled)
+    return;
+
+  mon->is_enabled = 0;
+  vlib_process_signal_event (vm, mon->node_index,
+			     PERFMON_MONITOR_EVENT_CONFIG, 0);
+}
+
+static void
+perfmon_monitor_quiesced (void *args)
+{
+  perfmon_main.monitor.is_quiesced = 1;
+}
+
+/*
+ * Stop the bundle being measured and add up what each node counted.
+ *
+ * The workers keep running: once the dispatch wrappers are unset, a grace
+ * period sees every worker out of the wrapper, after which nothing writes
+ * the node stats or reads the counters, and they can be read and freed.
+ */
+static void
+perfmon_monitor_collect (vlib_main_t *vm)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  perfmon_monitor_t *mon = &pm->monitor;
+  perfmon_monitor_bundle_t *mb;
+  perfmon_thread_runtime_t *rt;
+  perfmon_node_stats_t *ns;
+  clib_error_t *err;
+  u32 n_nodes = vec_len (vm->node_main.nodes);
+
+  mb = vec_elt_at_index (mon->bundles, mon->active_bundle_index);
+
+  for (int i = 0; i < vlib_get_n_threads (); i++)
+    vlib_node_set_dispatch_wrapper (vlib_get_main_by_index (i), 0);
+
+  mon->is_quiesced = 0;
+  vlib_rcu_call (perfmon_monitor_quiesced, 0, 0);
+  while (!mon->is_quiesced)
+    vlib_process_suspend (vm, 1e-3);
+
+  mon->active_bundle_index = ~0;
+
+  /* the monitor was turned off and the bundle stopped by hand meanwhile */
+  if (!pm->is_running || pm->active_bundle != mb->bundle)
+    return;
+
+  vlib_validate_simple_counter (&mb->calls, n_nodes - 1);
+  vlib_validate_simple_counter (&mb->packets, n_nodes - 1);
+  for (int j = 0; j < mb->n_events; j++)
+    vlib_validate_simple_counter (&mb->events[j], n_nodes - 1);
+
+  if ((err = perfmon_stop (vm)))
+    {
+      log_warn ("%U", format_clib_error, err);
+      clib_error_free (err);
+      mon->n_errors++;
+      goto done;
+    }
+
+  for (int i = 0; i < vec_len (pm->thread_runtimes); i++)
+    {
+      rt = vec_elt_at_index (pm->thread_runtimes, i);
+      for (int n = 0; n < clib_min (rt->n_nodes, n_nodes); n++)
+	{
+	  ns = vec_elt_at_index (rt->node_stats, n);
+	  if (ns->n_calls == 0)
+	    continue;
+
+	  vlib_increment_simple_counter (&mb->calls, i, n, ns->n_calls);
+	  vlib_increment_simple_counter (&mb->packets, i, n, ns->n_packets);
+	  for (int j = 0; j < clib_min (rt->n_events, mb->n_events); j++)
+	    vlib_increment_simple_counter (&mb->events[j], i, n,
+					   ns->value[j]);
+	}
+    }
+  mb->n_windows++;
+
+done:
+  perfmon_reset (vm);
+}
+
+static int
+perfmon_monitor_start_next (vlib_main_t *vm)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  perfmon_monitor_t *mon = &pm->monitor;
+  perfmon_monitor_bundle_t *mb;
+  clib_error_t *err;
+  u32 index;
+
+  /* someone is running a bundle by hand */
+  if (pm->is_running)
+    {
+      mon->n_busy++;
+      return 0;
+    }
+
+  index = mon->rotation[mon->next];
+  mon->next = (mon->next + 1) % vec_len (mon->rotation);
+
+  mb = vec_elt_at_index (mon->bundles, index);
+  mb->bundle->active_type = PERFMON_BUNDLE_TYPE_NODE;
+
+  if ((err = perfmon_start (vm, mb->bundle)))
+    {
+      log_warn ("bundle '%s': %U", mb->bundle->name, format_clib_error,
+		err);
+      clib_error_free (err);
+      mon->n_errors++;
+      return 0;
+    }
+
+  mon->active_bundle_index = index;
+  return 1;
+}
+
+static uword
+perfmon_monitor_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
+			 vlib_frame_t *f)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  perfmon_monitor_t *mon = &pm->monitor;
+  perfmon_bundle_t **bundles = 0;
+  clib_error_t *err;
+  uword *event_data = 0, *p, event_type;
+  f64 timeout = 0;
+
+  if (mon->config_enable)
+    {
+      for (int i = 0; i < vec_len (mon->config_bundle_names); i++)
+	{
+	  p = hash_get_mem (pm->bundle_by_name, mon->config_bundle_names[i]);
+	  if (p)
+	    vec_add1 (bundles, (perfmon_bundle_t *) p[0]);
+	  else
+	    log_warn ("unknown bundle '%s'", mon->config_bundle_names[i]);
+	}
+      if ((err = perfmon_monitor_enable (vm, bundles, mon->interval,
+					 mon->duty_cycle)))
+	{
+	  log_warn ("%U", format_clib_error, err);
+	  clib_error_free (err);
+	}
+      vec_free (bundles);
+    }
+
+  while (1)
+    {
+      if (mon->is_enabled)
+	vlib_process_wait_for_event_or_clock (vm, timeout);
+      else
+	vlib_process_wait_for_event (vm);
+
+      event_type = vlib_process_get_events (vm, &event_data);
+      vec_reset_length (event_data);
+
+      if (mon->active_bundle_index != ~0)
+	{
+	  perfmon_monitor_collect (vm);
+
+	  /* idle for the rest of the interval, unless reconfigured */
+	  if (event_type == ~0 && mon->is_enabled && mon->duty_cycle < 1)
+	    {
+	      timeout = mon->interval * (1 - mon->duty_cycle);
+	      continue;
+	    }
+	}
+
+      if (!mon->is_enabled)
+	continue;
+
+      if (perfmon_monitor_start_next (vm))
+	timeout = mon->interval * mon->duty_cycle;
+      else
+	timeout = mon->interval;
+    }
+
+  return 0;
+}
+
+VLIB_REGISTER_NODE (perfmon_monitor_node) = {
+  .function = perfmon_monitor_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "perfmon-monitor-process",
+};
+
+static clib_error_t *
+perfmon_monitor_init (vlib_main_t *vm)
+{
+  perfmon_monitor_t *mon = &perfmon_main.monitor;
+
+  mon->bundle_index_by_name = hash_create_string (0, sizeof (uword));
+  mon->active_bundle_index = ~0;
+  mon->node_index = perfmon_monitor_node.index;
+  if (mon->interval == 0)
+    mon->interval = 1;
+  if (mon->duty_cycle == 0)
+    mon->duty_cycle = 0.1;
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (perfmon_monitor_init);
+
+static clib_error_t *
+perfmon_config (vlib_main_t *vm, unformat_input_t *input)
+{
+  perfmon_monitor_t *mon = &perfmon_main.monitor;
+  u8 *name;
+  u32 duty;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "monitor-bundle %s", &name))
+	{
+	  vec_add1 (name, 0);
+	  vec_add1 (mon->config_bundle_names, name);
+	  mon->config_enable = 1;
+	}
+      else if (unformat (input, "monitor-interval %f", &mon->interval))
+	;
+      else if (unformat (input, "monitor-duty-cycle %u", &duty))
+	mon->duty_cycle = duty / 100.0;
+      else if (unformat (input, "monitor"))
+	mon->config_enable = 1;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+  return 0;
+}
+
+VLIB_CONFIG_FUNCTION (perfmon_config, "perfmon");
@@ -262,6 +262,8 @@ perfmon_start (vlib_main_t *vm, perfmon_bundle_t *b)
 	  return err;
 	}
 
+      /* the monitor starts bundles with the workers running */
+      CLIB_MEMORY_STORE_BARRIER ();
       for (int i = 0; i < vlib_get_n_threads (); i++)
 	vlib_node_set_dispatch_wrapper (vlib_get_main_by_index (i),
 					dispatch_wrapper);
@@ -196,6 +196,44 @@ typedef struct
   struct perf_event_mmap_page *mmap_pages[PERF_MAX_EVENTS];
 } perfmon_thread_runtime_t;
 
+/* per node counters of a bundle, accumulated by the monitor */
+typedef struct
+{
+  perfmon_bundle_t *bundle;
+  u64 n_windows;
+  u8 n_events;
+  vlib_simple_counter_main_t calls;
+  vlib_simple_counter_main_t packets;
+  vlib_simple_counter_main_t events[PERF_MAX_EVENTS];
+} perfmon_monitor_bundle_t;
+
+typedef struct
+{
+  /* bundles with counters in the stats segment, never freed */
+  perfmon_monitor_bundle_t *bundles;
+  uword *bundle_index_by_name;
+
+  /* indices of the bundles to rotate through */
+  u32 *rotation;
+  u32 next;
+  u32 active_bundle_index;
+
+  u8 is_enabled;
+  f64 interval;
+  f64 duty_cycle;
+  u32 node_index;
+
+  u64 n_busy;
+  u64 n_errors;
+
+  /* set once no worker can be in the last bundle's dispatch wrapper */
+  volatile u8 is_quiesced;
+
+  /* from the startup config, applied once the main loop runs */
+  u8 **config_bundle_names;
+  u8 config_enable;
+} perfmon_monitor_t;
+
 typedef struct
 {
   perfmon_thread_runtime_t *thread_runtimes;
@@ -210,6 +248,7 @@ typedef struct
   int *fds_to_close;
   perfmon_instance_type_t *default_instance_type;
   perfmon_instance_type_t *active_instance_type;
+  perfmon_monitor_t monitor;
 } perfmon_main_t;
 
 extern perfmon_main_t perfmon_main;
@@ -274,6 +313,10 @@ perfmon_cpu_update_bundle_type (perfmon_bundle_t *b)
 void perfmon_reset (vlib_main_t *vm);
 clib_error_t *perfmon_start (vlib_main_t *vm, perfmon_bundle_t *);
 clib_error_t *perfmon_stop (vlib_main_t *vm);
+clib_error_t *perfmon_monitor_enable (vlib_main_t *vm,
+				     perfmon_bundle_t **bundles, f64 interval,
+				     f64 duty_cycle);
+void perfmon_monitor_disable (vlib_main_t *vm);
 
 #define PERFMON_STRINGS(...)                                                  \
   (char *[]) { __VA_ARGS__, 0 }
@@ -42,142 +42,330 @@ make_stat_name (char *name)
   return pm->name_scratch_pad;
 }
 
-static u8 *
-dump_counter_vector_simple (stat_segment_data_t *res, u8 *s, u8 used_only)
+static void
+prom_stat_cache_entry_free (prom_stat_cache_t *c)
 {
-  u8 need_header = 1;
-  int j, k;
-  u8 *name;
+  vec_free (c->name);
+  vec_free (c->shape);
+  vec_free (c->headers[0]);
+  vec_free (c->headers[1]);
+  vec_free (c->text);
+  vec_free (c->line_ends);
+  vec_free (c->values);
+  clib_memset (c, 0, sizeof (*c));
+}
 
-  name = make_stat_name (res->name);
+void
+prom_stat_cache_flush (void)
+{
+  prom_main_t *pm = &prom_main;
+  prom_stat_cache_t *c;
 
-  for (k = 0; k < vec_len (res->simple_counter_vec); k++)
-    for (j = 0; j < vec_len (res->simple_counter_vec[k]); j++)
-      {
-	if (used_only && !res->simple_counter_vec[k][j])
-	  continue;
-	if (need_header)
-	  {
-	    s = format (s, "# TYPE %v counter\n", name);
-	    need_header = 0;
-	  }
-	s = format (s, "%v{thread=\"%d\",interface=\"%d\"} %lld\n", name, k, j,
-		    res->simple_counter_vec[k][j]);
-      }
+  vec_foreach (c, pm->stat_cache)
+    prom_stat_cache_entry_free (c);
+  vec_free (pm->stat_cache);
+  vec_free (pm->stat_indices);
+}
 
-  return s;
+/* Counter samples are suffixed _total in OpenMetrics */
+static_always_inline char *
+prom_counter_suffix (prom_main_t *pm)
+{
+  return pm->format == PROM_FORMAT_OPENMETRICS ? "_total" : "";
 }
 
-static u8 *
-dump_counter_vector_combined (stat_segment_data_t *res, u8 *s, u8 used_only)
+static void
+prom_stat_cache_headers (prom_main_t *pm, prom_stat_cache_t *c,
+			 stat_segment_data_t *res)
 {
-  u8 need_header = 1;
-  int j, k;
   u8 *name;
 
+  prom_stat_cache_entry_free (c);
+  c->name = format (0, "%s%c", res->name, 0);
+  c->type = res->type;
+
   name = make_stat_name (res->name);
 
-  for (k = 0; k < vec_len (res->simple_counter_vec); k++)
-    for (j = 0; j < vec_len (res->combined_counter_vec[k]); j++)
-      {
-	if (used_only && !res->combined_counter_vec[k][j].packets)
-	  continue;
-	if (need_header)
-	  {
-	    s = format (s, "# TYPE %v_packets counter\n", name);
-	    s = format (s, "# TYPE %v_bytes counter\n", name);
-	    need_header = 0;
-	  }
-	s = format (s, "%v_packets{thread=\"%d\",interface=\"%d\"} %lld\n",
-		    name, k, j, res->combined_counter_vec[k][j].packets);
-	s = format (s, "%v_bytes{thread=\"%d\",interface=\"%d\"} %lld\n", name,
-		    k, j, res->combined_counter_vec[k][j].bytes);
-      }
+  switch (res->type)
+    {
+    case STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE:
+      c->headers[0] = format (0, "# TYPE %v counter\n", name);
+      break;
+
+    case STAT_DIR_TYPE_SCALAR_INDEX:
+      /* scalars such as /sys/vector_rate go up and down */
+      c->headers[0] = format (0, "# TYPE %v gauge\n", name);
+      break;
+
+    case STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED:
+      c->headers[0] = format (0, "# TYPE %v_packets counter\n", name);
+      c->headers[1] = format (0, "# TYPE %v_bytes counter\n", name);
+      break;
+
+    case STAT_DIR_TYPE_NAME_VECTOR:
+      if (pm->format == PROM_FORMAT_OPENMETRICS)
+	c->headers[0] = format (0, "# TYPE %v info\n", name);
+      else
+	c->headers[0] = format (0, "# TYPE %v_info gauge\n", name);
+      break;
+
+    default:
+      break;
+    }
+}
 
-  return s;
+/* Values of a stat, in the order of its lines, and its counters per thread */
+static void
+prom_stat_values (prom_main_t *pm, stat_segment_data_t *res, u32 *split)
+{
+  u64 *values = pm->values_scratch;
+  u32 *shape = pm->shape_scratch;
+  u64 bits;
+  int j, k;
+
+  vec_reset_length (values);
+  vec_reset_length (shape);
+  *split = 0;
+
+  switch (res->type)
+    {
+    case STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE:
+      for (k = 0; k < vec_len (res->simple_counter_vec); k++)
+	{
+	  vec_add1 (shape, vec_len (res->simple_counter_vec[k]));
+	  vec_add (values, res->simple_counter_vec[k],
+		   vec_len (res->simple_counter_vec[k]));
+	}
+      break;
+
+    case STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED:
+      /* all the packets, then all the bytes, to keep the families apart */
+      for (k = 0; k < vec_len (res->combined_counter_vec); k++)
+	{
+	  vec_add1 (shape, vec_len (res->combined_counter_vec[k]));
+	  for (j = 0; j < vec_len (res->combined_counter_vec[k]); j++)
+	    vec_add1 (values, res->combined_counter_vec[k][j].packets);
+	}
+      *split = vec_len (values);
+      for (k = 0; k < vec_len (res->combined_counter_vec); k++)
+	for (j = 0; j < vec_len (res->combined_counter_vec[k]); j++)
+	  vec_add1 (values, res->combined_counter_vec[k][j].bytes);
+      break;
+
+    case STAT_DIR_TYPE_SCALAR_INDEX:
+      vec_add1 (shape, 1);
+      clib_memcpy (&bits, &res->scalar_value, sizeof (bits));
+      vec_add1 (values, bits);
+      break;
+
+    default:
+      break;
+    }
+
+  pm->values_scratch = values;
+  pm->shape_scratch = shape;
 }
 
 static u8 *
-dump_scalar_index (stat_segment_data_t *res, u8 *s, u8 used_only)
+prom_format_sample (prom_main_t *pm, stat_segment_data_t *res, u8 *metric,
+		    u8 *s, int is_bytes, int thread, int index, u64 value)
 {
-  u8 *name;
+  char *suffix = prom_counter_suffix (pm);
+  f64 scalar;
 
-  if (used_only && !res->scalar_value)
-    return s;
+  switch (res->type)
+    {
+    case STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE:
+      s = format (s, "%v%s{thread=\"%d\",interface=\"%d\"} %lld\n", metric,
+		  suffix, thread, index, value);
+      break;
+
+    case STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED:
+      s = format (s, "%v_%s%s{thread=\"%d\",interface=\"%d\"} %lld\n", metric,
+		  is_bytes ? "bytes" : "packets", suffix, thread, index,
+		  value);
+      break;
+
+    case STAT_DIR_TYPE_SCALAR_INDEX:
+      clib_memcpy (&scalar, &value, sizeof (scalar));
+      s = format (s, "%v %.2f\n", metric, scalar);
+      break;
+
+    default:
+      break;
+    }
 
-  name = make_stat_name (res->name);
+  return s;
+}
+
+/*
+ * Bring the lines of a counter or scalar stat up to date, copying the
+ * lines of values that have not changed since the last scrape and
+ * formatting only the others.
+ */
+static void
+prom_stat_cache_update (prom_main_t *pm, prom_stat_cache_t *c,
+			stat_segment_data_t *res)
+{
+  u32 *shape, split, v = 0, start, end, part, n_parts, *line_ends;
+  u64 *values;
+  u8 *text, *metric = 0;
+  int j, k, reuse;
 
-  s = format (s, "# TYPE %v counter\n", name);
-  s = format (s, "%v %.2f\n", name, res->scalar_value);
+  prom_stat_values (pm, res, &split);
+  values = pm->values_scratch;
+  shape = pm->shape_scratch;
 
-  return s;
+  reuse = vec_len (shape) && vec_len (shape) == vec_len (c->shape) &&
+	  0 == memcmp (shape, c->shape, vec_bytes (shape)) &&
+	  vec_len (values) == vec_len (c->values);
+
+  text = pm->text_scratch;
+  line_ends = pm->line_ends_scratch;
+  vec_reset_length (text);
+  vec_reset_length (line_ends);
+
+  n_parts = res->type == STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED ? 2 : 1;
+
+  for (part = 0; part < n_parts; part++)
+    for (k = 0; k < vec_len (shape); k++)
+      for (j = 0; j < shape[k]; j++, v++)
+	{
+	  if (reuse && values[v] == c->values[v])
+	    {
+	      start = v ? c->line_ends[v - 1] : 0;
+	      end = c->line_ends[v];
+	      vec_add (text, c->text + start, end - start);
+	      pm->n_lines_reused++;
+	    }
+	  else if (!pm->used_only || values[v])
+	    {
+	      /* the name is only needed, and formatted, for changed lines */
+	      if (!metric)
+		metric = make_stat_name (res->name);
+	      text = prom_format_sample (pm, res, metric, text, part, k, j,
+					 values[v]);
+	      pm->n_lines_formatted++;
+	    }
+	  vec_add1 (line_ends, vec_len (text));
+	}
+
+  /* the old text and values are the next scrape's scratch */
+  pm->text_scratch = c->text;
+  pm->line_ends_scratch = c->line_ends;
+  pm->values_scratch = c->values;
+  pm->shape_scratch = c->shape;
+  c->text = text;
+  c->line_ends = line_ends;
+  c->values = values;
+  c->shape = shape;
+  c->split = split;
 }
 
-static u8 *
-dump_name_vector (stat_segment_data_t *res, u8 *s, u8 used_only)
+static void
+prom_stat_cache_update_name_vector (prom_main_t *pm, prom_stat_cache_t *c,
+				    stat_segment_data_t *res)
 {
   u8 *name;
   int k;
 
+  /* few and seldom used, so not worth comparing */
   name = make_stat_name (res->name);
-
-  s = format (s, "# TYPE %v_info gauge\n", name);
+  vec_reset_length (c->text);
   for (k = 0; k < vec_len (res->name_vector); k++)
-    s = format (s, "%v_info{index=\"%d\",name=\"%s\"} 1\n", name, k,
-		res->name_vector[k]);
+    c->text = format (c->text, "%v_info{index=\"%d\",name=\"%s\"} 1\n", name,
+		      k, res->name_vector[k]);
+  pm->n_lines_formatted += k;
+}
+
+static u8 *
+prom_stat_cache_append (prom_stat_cache_t *c, u8 *s)
+{
+  u32 end = c->split ? c->line_ends[c->split - 1] : vec_len (c->text);
+
+  if (c->type == STAT_DIR_TYPE_NAME_VECTOR)
+    {
+      vec_append (s, c->headers[0]);
+      vec_append (s, c->text);
+      return s;
+    }
+
+  if (end)
+    {
+      vec_append (s, c->headers[0]);
+      vec_add (s, c->text, end);
+    }
+  if (c->split && vec_len (c->text) > end)
+    {
+      vec_append (s, c->headers[1]);
+      vec_add (s, c->text + end, vec_len (c->text) - end);
+    }
 
   return s;
 }
 
+static void
+prom_stat_indices_update (prom_main_t *pm)
+{
+  vec_free (pm->stat_indices);
+  pm->stat_indices = stat_segment_ls (pm->stats_patterns);
+  pm->stat_indices_epoch = stat_client_main.current_epoch;
+}
+
 static u8 *
-scrape_stats_segment (u8 *s, u8 **patterns, u8 used_only)
+scrape_stats_segment (prom_main_t *pm, u8 *s)
 {
+  stat_client_main_t *scm = &stat_client_main;
   stat_segment_data_t *res;
-  static u32 *stats = 0;
+  prom_stat_cache_t *c;
+  u32 index;
   int i;
 
-  stats = stat_segment_ls (patterns);
+  /* listing matches every pattern against the whole directory, so is
+   * only done again when the directory changed */
+  if (!pm->stat_indices || pm->stat_indices_epoch != scm->current_epoch)
+    prom_stat_indices_update (pm);
 
-retry:
-  res = stat_segment_dump (stats);
-  if (res == 0)
-    { /* Memory layout has changed */
-      if (stats)
-	vec_free (stats);
-      stats = stat_segment_ls (patterns);
-      goto retry;
-    }
+  /* Memory layout has changed */
+  while ((res = stat_segment_dump (pm->stat_indices)) == 0)
+    prom_stat_indices_update (pm);
 
   for (i = 0; i < vec_len (res); i++)
     {
+      index = pm->stat_indices[i];
+      vec_validate (pm->stat_cache, index);
+      c = vec_elt_at_index (pm->stat_cache, index);
+
+      if (!c->name || c->type != res[i].type ||
+	  strcmp ((char *) c->name, res[i].name))
+	prom_stat_cache_headers (pm, c, &res[i]);
+
       switch (res[i].type)
 	{
 	case STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE:
-	  s = dump_counter_vector_simple (&res[i], s, used_only);
-	  break;
-
 	case STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED:
-	  s = dump_counter_vector_combined (&res[i], s, used_only);
-	  break;
-
 	case STAT_DIR_TYPE_SCALAR_INDEX:
-	  s = dump_scalar_index (&res[i], s, used_only);
+	  prom_stat_cache_update (pm, c, &res[i]);
 	  break;
 
 	case STAT_DIR_TYPE_NAME_VECTOR:
-	  s = dump_name_vector (&res[i], s, used_only);
+	  prom_stat_cache_update_name_vector (pm, c, &res[i]);
 	  break;
 
 	case STAT_DIR_TYPE_EMPTY:
-	  break;
+	  continue;
 
 	default:
 	  clib_warning ("Unknown value %d\n", res[i].type);
-	  ;
+	  continue;
 	}
+
+      s = prom_stat_cache_append (c, s);
     }
   stat_segment_data_free (res);
-  vec_free (stats);
+
+  if (pm->format == PROM_FORMAT_OPENMETRICS)
+    s = format (s, "# EOF\n");
 
   return s;
 }
@@ -191,7 +379,9 @@ send_data_to_hss (hss_session_handle_t sh)
   args.sh = sh;
   args.data = vec_dup (pm->stats);
   args.data_len = vec_len (pm->stats);
-  args.ct = HTTP_CONTENT_TEXT_PLAIN;
+  args.ct = pm->format == PROM_FORMAT_OPENMETRICS ?
+	      HTTP_CONTENT_APP_OPENMETRICS :
+	      HTTP_CONTENT_TEXT_PLAIN;
   args.sc = HTTP_STATUS_OK;
   args.free_vec_data = 1;
 
@@ -211,7 +401,7 @@ prom_scraper_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
   uword *event_data = 0, event_type, *sh_as_uword;
   prom_main_t *pm = &prom_main;
   hss_session_handle_t sh;
-  f64 timeout = 10000.0;
+  f64 timeout = 10000.0, t0;
 
   while (1)
     {
@@ -223,9 +413,11 @@ prom_scraper_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
 	  /* timeout, do nothing */
 	  break;
 	case PROM_SCRAPER_EVT_RUN:
+	  t0 = vlib_time_now (vm);
 	  vec_reset_length (pm->stats);
-	  pm->stats = scrape_stats_segment (pm->stats, pm->stats_patterns,
-					    pm->used_only);
+	  pm->stats = scrape_stats_segment (pm, pm->stats);
+	  pm->last_scrape_duration = vlib_time_now (vm) - t0;
+	  pm->n_scrapes++;
 	  vec_foreach (sh_as_uword, event_data)
 	    {
 	      sh.as_u64 = (u64) *sh_as_uword;
@@ -325,6 +517,8 @@ prom_stat_patterns_add (u8 **patterns)
       if (!found)
 	vec_add1 (pm->stats_patterns, *pattern);
     }
+
+  vec_free (pm->stat_indices);
 }
 
 void
@@ -336,6 +530,7 @@ prom_stat_patterns_free (void)
   vec_foreach (pattern, pm->stats_patterns)
     vec_free (*pattern);
   vec_free (pm->stats_patterns);
+  vec_free (pm->stat_indices);
 }
 
 void
@@ -358,6 +553,7 @@ prom_stat_name_prefix_set (u8 *prefix)
 
   vec_free (pm->stat_name_prefix);
   pm->stat_name_prefix = prefix;
+  prom_stat_cache_flush ();
 }
 
 void
@@ -365,9 +561,36 @@ prom_report_used_only (u8 used_only)
 {
   prom_main_t *pm = &prom_main;
 
+  if (pm->used_only != used_only)
+    prom_stat_cache_flush ();
   pm->used_only = used_only;
 }
 
+void
+prom_format_set (prom_format_t fmt)
+{
+  prom_main_t *pm = &prom_main;
+
+  if (pm->format != fmt)
+    prom_stat_cache_flush ();
+  pm->format = fmt;
+}
+
+u8 *
+format_prom_format (u8 *s, va_list *args)
+{
+  prom_format_t fmt = va_arg (*args, prom_format_t);
+
+  switch (fmt)
+    {
+    case PROM_FORMAT_PROMETHEUS:
+      return format (s, "prometheus");
+    case PROM_FORMAT_OPENMETRICS:
+      return format (s, "openmetrics");
+    }
+  return format (s, "unknown %d", fmt);
+}
+
 static void
 prom_stat_segment_client_init (void)
 {
@@ -416,6 +639,7 @@ prom_init (vlib_main_t *vm)
   pm->min_scrape_interval = 1;
   pm->used_only = 0;
   pm->stat_name_prefix = 0;
+  pm->format = PROM_FORMAT_PROMETHEUS;
 
   return 0;
 }
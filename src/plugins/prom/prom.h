@@ -18,10 +18,55 @@
 
 #include <vnet/session/session.h>
 #include <http_static/http_static.h>
+#include <vlib/stats/shared.h>
+
+typedef enum prom_format_
+{
+  PROM_FORMAT_PROMETHEUS,
+  PROM_FORMAT_OPENMETRICS,
+} prom_format_t;
+
+/*
+ * Exposition of one stat, kept across scrapes. The lines of every value
+ * are kept in text, each ending at line_ends[value], and are formatted
+ * again only when the value changes.
+ */
+typedef struct prom_stat_cache_
+{
+  /* name of the stat in the segment, the cache is dropped if it changes */
+  u8 *name;
+  stat_directory_type_t type;
+  /* counters per thread the lines were formatted for */
+  u32 *shape;
+  /* # TYPE lines, for combined counters of the packets and bytes */
+  u8 *headers[2];
+  u8 *text;
+  u32 *line_ends;
+  u64 *values;
+  /* where the bytes of combined counters start, in values */
+  u32 split;
+} prom_stat_cache_t;
 
 typedef struct prom_main_
 {
   u8 *stats;
+  /* directory indices of the stats matching the patterns */
+  u32 *stat_indices;
+  u64 stat_indices_epoch;
+  /* per directory index */
+  prom_stat_cache_t *stat_cache;
+  /* scratch, swapped with a cache entry's text and line ends */
+  u8 *text_scratch;
+  u32 *line_ends_scratch;
+  u64 *values_scratch;
+  u32 *shape_scratch;
+
+  /* scrape statistics */
+  u64 n_scrapes;
+  u64 n_lines_formatted;
+  u64 n_lines_reused;
+  f64 last_scrape_duration;
+
   f64 last_scrape;
   hss_register_url_fn register_url;
   hss_session_send_fn send_data;
@@ -37,6 +82,7 @@ typedef struct prom_main_
   u8 *stat_name_prefix;
   f64 min_scrape_interval;
   u8 used_only;
+  prom_format_t format;
 } prom_main_t;
 
 typedef enum prom_process_evt_codes_
@@ -54,6 +100,9 @@ void prom_stat_patterns_free (void);
 
 void prom_stat_name_prefix_set (u8 *prefix);
 void prom_report_used_only (u8 used_only);
+void prom_format_set (prom_format_t fmt);
+void prom_stat_cache_flush (void);
+format_function_t format_prom_format;
 
 #endif /* SRC_PLUGINS_PROM_PROM_H_ */
 
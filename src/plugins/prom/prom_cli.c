@@ -115,6 +115,10 @@ prom_command_fn (vlib_main_t *vm, unformat_input_t *input,
       else if (unformat (line_input, "stat-patterns %U",
 			 unformat_stats_patterns, &patterns))
 	prom_stat_patterns_set (patterns);
+      else if (unformat (line_input, "format prometheus"))
+	prom_format_set (PROM_FORMAT_PROMETHEUS);
+      else if (unformat (line_input, "format openmetrics"))
+	prom_format_set (PROM_FORMAT_OPENMETRICS);
       else
 	{
 	  error = clib_error_return (0, "unknown input `%U'",
@@ -140,10 +144,42 @@ VLIB_CLI_COMMAND (prom_enable_command, static) = {
   .path = "prom",
   .short_help = "prom [enable] [min-scrape-interval <n>] [used-only] "
 		"[all-stats] [stat-name-prefix <prefix>] "
-		"[stat-patterns <patterns>...]",
+		"[stat-patterns <patterns>...] "
+		"[format prometheus|openmetrics]",
   .function = prom_command_fn,
 };
 
+static clib_error_t *
+show_prom_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  prom_main_t *pm = prom_get_main ();
+  u64 n_lines = pm->n_lines_formatted + pm->n_lines_reused;
+
+  if (!pm->is_enabled)
+    {
+      vlib_cli_output (vm, "prom not enabled");
+      return 0;
+    }
+
+  vlib_cli_output (vm, "format %U, %u stats matched, %llu scrapes",
+		   format_prom_format, pm->format,
+		   vec_len (pm->stat_indices), pm->n_scrapes);
+  vlib_cli_output (vm, "last scrape %.3f ms, %U exposition",
+		   pm->last_scrape_duration * 1e3, format_memory_size,
+		   vec_len (pm->stats));
+  vlib_cli_output (vm, "lines formatted %llu, reused %llu (%.1f%%)",
+		   pm->n_lines_formatted, pm->n_lines_reused,
+		   n_lines ? 100.0 * pm->n_lines_reused / n_lines : 0.0);
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_prom_command, static) = {
+  .path = "show prom",
+  .short_help = "show prom",
+  .function = show_prom_command_fn,
+};
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -0,0 +1,224 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vlib/aqm.h>
+
+/*
+ * Feed AQM instances packets leaving a queue every 10us in simulated
+ * time, with given sojourn times, and check when they drop.
+ */
+
+#define AQM_TEST_GAP_US 10
+
+typedef struct
+{
+  vlib_main_t *vm;
+  u32 aqm_index;
+  u64 now;
+  u64 clocks_per_us;
+  u64 *drop_times;
+} aqm_test_t;
+
+static clib_error_t *
+aqm_test_init (vlib_main_t *vm, aqm_test_t *t, vlib_aqm_config_t *c,
+	       char *name)
+{
+  clib_memset (t, 0, sizeof (*t));
+  t->vm = vm;
+  t->clocks_per_us = vm->clib_time.clocks_per_second * 1e-6;
+  t->now = clib_cpu_time_now ();
+  return vlib_aqm_create (c, &t->aqm_index, "test/%s", name);
+}
+
+static void
+aqm_test_free (aqm_test_t *t)
+{
+  vlib_aqm_delete (t->aqm_index);
+  vec_free (t->drop_times);
+}
+
+/* Packets leaving over duration_us, of flows taking turns from the
+ * pattern, the drops of each flow counted in n_drops. */
+static u32
+aqm_test_run (aqm_test_t *t, u32 duration_us, u32 sojourn_us, u32 *flows,
+	      u32 *n_drops)
+{
+  vlib_aqm_t *a = vlib_aqm_get (t->aqm_index);
+  u32 i, n = duration_us / AQM_TEST_GAP_US, total = 0, flow;
+
+  for (i = 0; i < n; i++)
+    {
+      t->now += AQM_TEST_GAP_US * t->clocks_per_us;
+      flow = flows ? flows[i % vec_len (flows)] : 0;
+      if (vlib_aqm_dequeue (a, t->vm->thread_index, t->now,
+			    sojourn_us * t->clocks_per_us, flow))
+	{
+	  vec_add1 (t->drop_times, t->now);
+	  if (n_drops)
+	    n_drops[flow]++;
+	  total++;
+	}
+    }
+
+  return total;
+}
+
+static clib_error_t *
+aqm_test_codel (vlib_main_t *vm)
+{
+  vlib_aqm_config_t c;
+  clib_error_t *err;
+  aqm_test_t t;
+  u64 start, gap, last_gap = 0;
+  u32 n, i;
+
+  vlib_aqm_config_init (&c, VLIB_AQM_CODEL);
+  err = aqm_test_init (vm, &t, &c, "codel");
+  if (err)
+    return err;
+
+  /* below target, nothing is dropped */
+  n = aqm_test_run (&t, 1000000, c.target / 2, 0, 0);
+  if (n)
+    {
+      err = clib_error_return (0, "codel: %u drops below target", n);
+      goto done;
+    }
+
+  /* above target, the first drop comes an interval later, then ever
+   * closer together */
+  start = t.now;
+  n = aqm_test_run (&t, 1000000, 2 * c.target, 0, 0);
+  if (n < 2)
+    {
+      err = clib_error_return (0, "codel: %u drops above target", n);
+      goto done;
+    }
+  if (t.drop_times[0] - start < c.interval * t.clocks_per_us ||
+      t.drop_times[0] - start > (c.interval + 2 * AQM_TEST_GAP_US) *
+				  t.clocks_per_us)
+    {
+      err = clib_error_return (0, "codel: first drop after %.1fus",
+			       (f64) (t.drop_times[0] - start) /
+				 t.clocks_per_us);
+      goto done;
+    }
+  for (i = 1; i < vec_len (t.drop_times); i++)
+    {
+      gap = t.drop_times[i] - t.drop_times[i - 1];
+      if (i > 1 && gap > last_gap + AQM_TEST_GAP_US * t.clocks_per_us)
+	{
+	  err = clib_error_return (0, "codel: drop %u gap grew", i);
+	  goto done;
+	}
+      last_gap = gap;
+    }
+  vlib_cli_output (vm, "codel: %u drops in 1s at twice the target", n);
+
+  /* back below target, dropping stops */
+  n = aqm_test_run (&t, 1000000, c.target / 2, 0, 0);
+  if (n)
+    err = clib_error_return (0, "codel: %u drops after recovery", n);
+
+done:
+  aqm_test_free (&t);
+  return err;
+}
+
+static clib_error_t *
+aqm_test_fq_codel (vlib_main_t *vm)
+{
+  vlib_aqm_config_t c;
+  clib_error_t *err;
+  aqm_test_t t;
+  u32 *flows = 0, n_drops[2] = {}, i;
+
+  vlib_aqm_config_init (&c, VLIB_AQM_FQ_CODEL);
+  err = aqm_test_init (vm, &t, &c, "fq-codel");
+  if (err)
+    return err;
+
+  /* flow 0 sends nine packets for each one of flow 1 */
+  for (i = 0; i < 9; i++)
+    vec_add1 (flows, 0);
+  vec_add1 (flows, 1);
+
+  aqm_test_run (&t, 2000000, 2 * c.target, flows, n_drops);
+  vlib_cli_output (vm, "fq-codel: heavy flow %u drops, light flow %u",
+		   n_drops[0], n_drops[1]);
+
+  if (n_drops[0] == 0 || n_drops[1])
+    err = clib_error_return (0, "fq-codel: heavy flow %u, light flow %u",
+			     n_drops[0], n_drops[1]);
+
+  vec_free (flows);
+  aqm_test_free (&t);
+  return err;
+}
+
+static clib_error_t *
+aqm_test_pie (vlib_main_t *vm)
+{
+  vlib_aqm_config_t c;
+  clib_error_t *err;
+  aqm_test_t t;
+  vlib_aqm_state_t *s;
+  u32 n;
+  f64 prob;
+
+  vlib_aqm_config_init (&c, VLIB_AQM_PIE);
+  err = aqm_test_init (vm, &t, &c, "pie");
+  if (err)
+    return err;
+  s = vec_elt_at_index (vlib_aqm_get (t.aqm_index)->per_thread,
+			vm->thread_index);
+
+  /* a burst is let through */
+  n = aqm_test_run (&t, c.max_burst / 2, 4 * c.target, 0, 0);
+  if (n)
+    {
+      err = clib_error_return (0, "pie: %u drops in a burst", n);
+      goto done;
+    }
+
+  /* a standing queue drives the probability up */
+  n = aqm_test_run (&t, 2000000, 4 * c.target, 0, 0);
+  prob = s->drop_prob;
+  vlib_cli_output (vm, "pie: %u drops in 2s at 4 times the target, p %.3f",
+		   n, prob);
+  if (n == 0 || prob == 0)
+    {
+      err = clib_error_return (0, "pie: %u drops, p %f", n, prob);
+      goto done;
+    }
+
+  /* and an empty one down */
+  aqm_test_run (&t, 2000000, 0, 0, 0);
+  if (s->drop_prob >= prob / 2)
+    err = clib_error_return (0, "pie: p %f after recovery", s->drop_prob);
+
+done:
+  aqm_test_free (&t);
+  return err;
+}
+
+static clib_error_t *
+test_aqm_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		     vlib_cli_command_t *cmd)
+{
+  clib_error_t *err;
+
+  if ((err = aqm_test_codel (vm)))
+    return err;
+  if ((err = aqm_test_fq_codel (vm)))
+    return err;
+  return aqm_test_pie (vm);
+}
+
+VLIB_CLI_COMMAND (test_aqm_command, static) = {
+  .path = "test aqm",
+  .short_help = "test aqm",
+  .function = test_aqm_command_fn,
+};
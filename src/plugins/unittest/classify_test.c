@@ -0,0 +1,234 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/ethernet/ethernet.h>
+#include <vnet/ip/ip4_packet.h>
+#include <vnet/classify/vnet_classify.h>
+#include <vppinfra/random.h>
+
+/*
+ * Search a chain of tables masking the IPv4 source on ever shorter
+ * prefixes, as an ACL with rules on different prefix lengths does, first
+ * table by table and then compiled, and check both find the same entries.
+ *
+ * Packets hit a random table of the chain, or none.
+ */
+
+#define CLASSIFY_TEST_PACKET_SIZE 64
+
+typedef struct
+{
+  ethernet_header_t eth;
+  ip4_header_t ip;
+} __clib_packed classify_test_header_t;
+
+/* prefix length of the source in table i of the chain */
+#define CLASSIFY_TEST_PREFIX_LEN(i) (32 - (i) * 2)
+
+static u32
+classify_test_prefix_mask (u32 len)
+{
+  return ~0ULL << (32 - len);
+}
+
+static void
+classify_test_mask (u8 *mask, u32 len)
+{
+  classify_test_header_t *h = (classify_test_header_t *) mask;
+
+  clib_memset (mask, 0, 2 * sizeof (u32x4));
+  h->ip.src_address.as_u32 =
+    clib_host_to_net_u32 (classify_test_prefix_mask (len));
+}
+
+static u64
+classify_test_chain_run (vnet_classify_main_t *cm, u8 **data,
+			 u32 *table_indices, vnet_classify_entry_t **entries,
+			 u32 n_packets, u32 table_index, int compiled)
+{
+  u64 t0, clocks = 0;
+  u32 i, n;
+
+  for (i = 0; i < n_packets; i += n)
+    {
+      n = clib_min (n_packets - i, VLIB_FRAME_SIZE);
+
+      clib_memset_u32 (table_indices + i, table_index, n);
+      t0 = clib_cpu_time_now ();
+      if (compiled)
+	vnet_classify_find_entries (cm, data + i, data + i, table_indices + i,
+				    entries + i, n, 0);
+      else
+	for (u32 j = i; j < i + n; j++)
+	  entries[j] = vnet_classify_find_entry_chain (
+	    cm, data[j], data[j], table_indices + j, 0);
+      clocks += clib_cpu_time_now () - t0;
+    }
+
+  return clocks;
+}
+
+static clib_error_t *
+test_classify_chain_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				vlib_cli_command_t *cmd)
+{
+  vnet_classify_main_t *cm = &vnet_classify_main;
+  u32 n_tables = 8, n_sessions = 1000, n_packets = 100000, n_rounds = 10;
+  u32 hit_pct = 50, seed = 0xdeadbeef;
+  u32 *table_indices = 0, *tables = 0, *keys = 0, *pkt_tables = 0;
+  vnet_classify_entry_t **entries = 0, **walked = 0;
+  u8 mask[2 * sizeof (u32x4)] __attribute__ ((aligned (16)));
+  u8 match[2 * sizeof (u32x4)] __attribute__ ((aligned (16)));
+  classify_test_header_t *h;
+  u8 *packets = 0, **data = 0;
+  u64 walk_clocks = 0, compiled_clocks = 0;
+  clib_error_t *err = 0;
+  u32 i, j, n_hits = 0, next = ~0, key;
+  int rv;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "tables %u", &n_tables))
+	;
+      else if (unformat (input, "sessions %u", &n_sessions))
+	;
+      else if (unformat (input, "packets %u", &n_packets))
+	;
+      else if (unformat (input, "rounds %u", &n_rounds))
+	;
+      else if (unformat (input, "hit %u", &hit_pct))
+	;
+      else if (unformat (input, "seed %u", &seed))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (n_tables == 0 || n_tables > VNET_CLASSIFY_CHAIN_MAX_TABLES ||
+      n_sessions == 0 || n_packets == 0 || hit_pct > 100)
+    return clib_error_return (0, "1 to %u tables, non-zero sessions and "
+				 "packets, hit at most 100",
+			      VNET_CLASSIFY_CHAIN_MAX_TABLES);
+
+  /* build the chain from its tail, /32 at the head */
+  vec_validate (tables, n_tables - 1);
+  for (i = n_tables; i > 0; i--)
+    {
+      u32 table_index = ~0;
+
+      classify_test_mask (mask, CLASSIFY_TEST_PREFIX_LEN (i - 1));
+      rv = vnet_classify_add_del_table (
+	cm, mask + sizeof (u32x4), n_sessions, (n_sessions << 10) + (1 << 20),
+	1 /* skip */, 1 /* match */, next, ~0, &table_index, 0, 0,
+	1 /* is_add */, 0);
+      if (rv)
+	{
+	  err = clib_error_return (0, "table add failed: %d", rv);
+	  goto done;
+	}
+      tables[i - 1] = next = table_index;
+    }
+
+  for (i = 0; i < n_tables; i++)
+    {
+      h = (classify_test_header_t *) match;
+      for (j = 0; j < n_sessions; j++)
+	{
+	  clib_memset (match, 0, sizeof (match));
+	  key = random_u32 (&seed) &
+		classify_test_prefix_mask (CLASSIFY_TEST_PREFIX_LEN (i));
+	  h->ip.src_address.as_u32 = clib_host_to_net_u32 (key);
+	  vec_add1 (keys, key);
+	  rv = vnet_classify_add_del_session (cm, tables[i], match, 0, j, 0, 0,
+					      0, 1 /* is_add */);
+	  if (rv)
+	    {
+	      err = clib_error_return (0, "session add failed: %d", rv);
+	      goto done;
+	    }
+	}
+    }
+
+  vec_validate_aligned (packets, n_packets * CLASSIFY_TEST_PACKET_SIZE - 1,
+			CLIB_CACHE_LINE_BYTES);
+  vec_validate (data, n_packets - 1);
+  vec_validate (table_indices, n_packets - 1);
+  vec_validate (entries, n_packets - 1);
+  vec_validate (walked, n_packets - 1);
+  vec_validate (pkt_tables, n_packets - 1);
+
+  for (i = 0; i < n_packets; i++)
+    {
+      data[i] = packets + i * CLASSIFY_TEST_PACKET_SIZE;
+      h = (classify_test_header_t *) data[i];
+      key = random_u32 (&seed);
+      if (random_u32 (&seed) % 100 < hit_pct)
+	{
+	  /* a session's prefix, with random host bits */
+	  j = random_u32 (&seed) % vec_len (keys);
+	  key = keys[j] | (key & ~classify_test_prefix_mask (
+				   CLASSIFY_TEST_PREFIX_LEN (j / n_sessions)));
+	}
+      h->ip.src_address.as_u32 = clib_host_to_net_u32 (key);
+    }
+
+  for (i = 0; i < n_rounds; i++)
+    walk_clocks += classify_test_chain_run (cm, data, table_indices, walked,
+					    n_packets, tables[0], 0);
+  clib_memcpy_fast (pkt_tables, table_indices,
+		    n_packets * sizeof (table_indices[0]));
+
+  rv = vnet_classify_chain_compile (cm, tables[0], 1 /* is_add */);
+  if (rv)
+    {
+      err = clib_error_return (0, "chain compile failed: %d", rv);
+      goto done;
+    }
+
+  for (i = 0; i < n_rounds; i++)
+    compiled_clocks += classify_test_chain_run (
+      cm, data, table_indices, entries, n_packets, tables[0], 1);
+
+  for (i = 0; i < n_packets; i++)
+    {
+      if (entries[i] != walked[i] || table_indices[i] != pkt_tables[i])
+	{
+	  err = clib_error_return (0, "failed: packet %u found %p in table %u, "
+				      "walked %p in table %u",
+				   i, entries[i], table_indices[i], walked[i],
+				   pkt_tables[i]);
+	  goto done;
+	}
+      n_hits += entries[i] != 0;
+    }
+
+  vlib_cli_output (vm, "%u tables of %u sessions, %u packets, %u hits",
+		   n_tables, n_sessions, n_packets, n_hits);
+  vlib_cli_output (vm, "table by table: %.2f clocks/packet",
+		   (f64) walk_clocks / n_rounds / n_packets);
+  vlib_cli_output (vm, "compiled:       %.2f clocks/packet",
+		   (f64) compiled_clocks / n_rounds / n_packets);
+
+done:
+  if (next != ~0)
+    vnet_classify_delete_table_index (cm, next, 1 /* del_chain */);
+  vec_free (tables);
+  vec_free (keys);
+  vec_free (packets);
+  vec_free (data);
+  vec_free (table_indices);
+  vec_free (entries);
+  vec_free (walked);
+  vec_free (pkt_tables);
+  return err;
+}
+
+VLIB_CLI_COMMAND (test_classify_chain_command, static) = {
+  .path = "test classify chain",
+  .short_help = "test classify chain [tables <n>] [sessions <n>] "
+		"[packets <n>] [rounds <n>] [hit <pct>] [seed <n>]",
+  .function = test_classify_chain_command_fn,
+};
@@ -7661,7 +7661,7 @@ u32 fib_walk_queue_get_size(fib_walk_priority_t prio);
 static int
 fib_test_walk (void)
 {
-    fib_node_back_walk_ctx_t high_ctx = {}, low_ctx = {};
+    fib_node_back_walk_ctx_t high_ctx = {}, low_ctx = {}, batch_ctx = {};
     fib_node_test_t *tc;
     vlib_main_t *vm;
     u32 ii, res;
@@ -7759,6 +7759,82 @@ fib_test_walk (void)
              "Parent has %d children post prio walk",
              fib_node_list_get_size(PARENT()->fn_children));
 
+    /*
+     * sync walks started in a batch are held until the batch ends, and
+     * those for the same reason merge, so each child is visited once.
+     */
+    batch_ctx.fnbw_reason = FIB_NODE_BW_REASON_FLAG_RESOLVE;
+    fib_walk_batch_begin();
+    fib_walk_sync(test_node_type, PARENT_INDEX, &batch_ctx);
+    batch_ctx.fnbw_depth = 0;
+    fib_walk_sync(test_node_type, PARENT_INDEX, &batch_ctx);
+
+    FOR_EACH_TEST_CHILD(tc)
+    {
+        FIB_TEST(0 == vec_len(tc->ctxs),
+                 "%d child not visited during batch", ii);
+    }
+    FIB_TEST(N_TEST_CHILDREN+1 == fib_node_list_get_size(PARENT()->fn_children),
+             "Parent has %d children during batch",
+             fib_node_list_get_size(PARENT()->fn_children));
+
+    fib_walk_batch_end();
+
+    FOR_EACH_TEST_CHILD(tc)
+    {
+        FIB_TEST(1 == vec_len(tc->ctxs),
+                 "%d child visitsed %d times by batched walk",
+                 ii, vec_len(tc->ctxs));
+        vec_free(tc->ctxs);
+    }
+    FIB_TEST(N_TEST_CHILDREN == fib_node_list_get_size(PARENT()->fn_children),
+             "Parent has %d children post batch walk",
+             fib_node_list_get_size(PARENT()->fn_children));
+
+    /*
+     * a child added while a walk is held goes in front of it. A walk for
+     * another reason that merges into the held one must still visit it.
+     * Each child sees both reasons, in order.
+     */
+    tc = &fib_test_nodes[1];
+    fib_node_child_remove(test_node_type, PARENT_INDEX, tc->sibling);
+
+    fib_walk_batch_begin();
+    batch_ctx.fnbw_reason = FIB_NODE_BW_REASON_FLAG_RESOLVE;
+    batch_ctx.fnbw_depth = 0;
+    fib_walk_sync(test_node_type, PARENT_INDEX, &batch_ctx);
+
+    tc->sibling = fib_node_child_add(test_node_type,
+                                     PARENT_INDEX,
+                                     test_node_type, 1);
+
+    batch_ctx.fnbw_reason = FIB_NODE_BW_REASON_FLAG_EVALUATE;
+    batch_ctx.fnbw_depth = 0;
+    fib_walk_sync(test_node_type, PARENT_INDEX, &batch_ctx);
+    FIB_TEST(N_TEST_CHILDREN+1 == fib_node_list_get_size(PARENT()->fn_children),
+             "Parent has %d children with a merged walk held",
+             fib_node_list_get_size(PARENT()->fn_children));
+    fib_walk_batch_end();
+
+    FOR_EACH_TEST_CHILD(tc)
+    {
+        FIB_TEST(2 == vec_len(tc->ctxs),
+                 "%d child visited %d times by merged batch walk",
+                 ii, vec_len(tc->ctxs));
+        if (2 == vec_len(tc->ctxs))
+        {
+            FIB_TEST((FIB_NODE_BW_REASON_FLAG_RESOLVE ==
+                      tc->ctxs[0].fnbw_reason) &&
+                     (FIB_NODE_BW_REASON_FLAG_EVALUATE ==
+                      tc->ctxs[1].fnbw_reason),
+                     "%d child sees both reasons", ii);
+        }
+        vec_free(tc->ctxs);
+    }
+    FIB_TEST(N_TEST_CHILDREN == fib_node_list_get_size(PARENT()->fn_children),
+             "Parent has %d children post merged batch walk",
+             fib_node_list_get_size(PARENT()->fn_children));
+
     /*
      * schedule 2 walks of the same priority that can be megred.
      * expect that each child is thus visited only once.
@@ -10860,11 +10936,677 @@ fib_test_sticky (void)
     return 0;
 }
 
+/*
+ * Add a route via the same recursive next-hop to each prefix, one at a
+ * time or all in one batch. Each single update is bracketed by a barrier,
+ * as it would be when programmed by its own API message.
+ */
+static void
+fib_test_bulk_add (u32 fib_index,
+                   const fib_prefix_t *pfxs,
+                   u32 n_pfxs,
+                   const fib_route_path_t *rpaths,
+                   int batch)
+{
+    vlib_main_t *vm = vlib_get_main();
+    fib_route_path_t *copy;
+    u32 ii;
+
+    if (batch)
+    {
+        fib_table_entry_path_add_bulk(fib_index, pfxs, n_pfxs,
+                                      FIB_SOURCE_API,
+                                      FIB_ENTRY_FLAG_NONE,
+                                      rpaths);
+        return;
+    }
+
+    for (ii = 0; ii < n_pfxs; ii++)
+    {
+        vlib_worker_thread_barrier_sync(vm);
+        copy = vec_dup((fib_route_path_t *) rpaths);
+        fib_table_entry_path_add2(fib_index, &pfxs[ii],
+                                  FIB_SOURCE_API,
+                                  FIB_ENTRY_FLAG_NONE,
+                                  copy);
+        vec_free(copy);
+        vlib_worker_thread_barrier_release(vm);
+    }
+}
+
+static void
+fib_test_bulk_del (u32 fib_index,
+                   const fib_prefix_t *pfxs,
+                   u32 n_pfxs,
+                   int batch)
+{
+    vlib_main_t *vm = vlib_get_main();
+    u32 ii;
+
+    if (batch)
+    {
+        fib_table_entry_delete_bulk(fib_index, pfxs, n_pfxs, FIB_SOURCE_API);
+        return;
+    }
+
+    for (ii = 0; ii < n_pfxs; ii++)
+    {
+        vlib_worker_thread_barrier_sync(vm);
+        fib_table_entry_delete(fib_index, &pfxs[ii], FIB_SOURCE_API);
+        vlib_worker_thread_barrier_release(vm);
+    }
+}
+
+#define FIB_TEST_BULK_CHURN_BATCH 1000
+
+static int
+fib_test_bulk (vlib_main_t *vm, u32 n_routes)
+{
+    fib_route_path_t *rpaths = NULL;
+    fib_prefix_t *pfxs = NULL;
+    test_main_t *tm;
+    u32 fib_index, ii, jj, n_churn, n_batch;
+    int batch, res, lb_count;
+    f64 t0, t1;
+
+    res = 0;
+    tm = &test_main;
+    lb_count = pool_elts(load_balance_pool);
+
+    fib_index = fib_table_find_or_create_and_lock(FIB_PROTOCOL_IP4, 13,
+                                                  FIB_SOURCE_API);
+
+    /*
+     * the routes recurse via 10.10.10.1, which resolves through an
+     * attached cover
+     */
+    const fib_prefix_t pfx_10_10_10_0_s_24 = {
+        .fp_len = 24,
+        .fp_proto = FIB_PROTOCOL_IP4,
+        .fp_addr = {
+            .ip4.as_u32 = clib_host_to_net_u32(0x0a0a0a00),
+        },
+    };
+    fib_route_path_t rpath = {
+        .frp_proto = DPO_PROTO_IP4,
+        .frp_addr = {
+            .ip4.as_u32 = clib_host_to_net_u32(0x0a0a0a01),
+        },
+        .frp_sw_if_index = ~0,
+        .frp_fib_index = fib_index,
+        .frp_weight = 1,
+    };
+    vec_add1(rpaths, rpath);
+
+    vec_validate(pfxs, n_routes - 1);
+    vec_foreach_index(ii, pfxs)
+    {
+        pfxs[ii].fp_len = 32;
+        pfxs[ii].fp_proto = FIB_PROTOCOL_IP4;
+        pfxs[ii].fp_addr.ip4.as_u32 = clib_host_to_net_u32(0x01000000 + ii);
+    }
+    n_churn = clib_max(n_routes / 10, 1);
+
+    vlib_cli_output(vm, "%d routes, %d churn updates", n_routes, n_churn);
+
+    for (batch = 0; batch < 2; batch++)
+    {
+        fib_table_entry_update_one_path(fib_index, &pfx_10_10_10_0_s_24,
+                                        FIB_SOURCE_API,
+                                        FIB_ENTRY_FLAG_NONE,
+                                        DPO_PROTO_IP4,
+                                        NULL,
+                                        tm->hw[0]->sw_if_index,
+                                        ~0, 1, NULL,
+                                        FIB_ROUTE_PATH_FLAG_NONE);
+
+        t0 = vlib_time_now(vm);
+        fib_test_bulk_add(fib_index, pfxs, n_routes, rpaths, batch);
+        t1 = vlib_time_now(vm);
+
+        vlib_cli_output(vm, "%-6s cold load: %.0f routes/sec",
+                        (batch ? "bulk" : "single"),
+                        n_routes / (t1 - t0));
+
+        /*
+         * churn: withdraw and re-announce routes while the next-hop
+         * moves between interfaces. Each move back-walks to every route.
+         */
+        t0 = vlib_time_now(vm);
+        for (ii = 0; ii < n_churn; ii += n_batch)
+        {
+            n_batch = clib_min(FIB_TEST_BULK_CHURN_BATCH, n_churn - ii);
+
+            if (batch)
+                fib_table_batch_begin();
+
+            fib_test_bulk_del(fib_index, &pfxs[ii], n_batch, batch);
+            for (jj = 0; jj < 2; jj++)
+                fib_table_entry_update_one_path(fib_index,
+                                                &pfx_10_10_10_0_s_24,
+                                                FIB_SOURCE_API,
+                                                FIB_ENTRY_FLAG_NONE,
+                                                DPO_PROTO_IP4,
+                                                NULL,
+                                                tm->hw[!jj]->sw_if_index,
+                                                ~0, 1, NULL,
+                                                FIB_ROUTE_PATH_FLAG_NONE);
+            fib_test_bulk_add(fib_index, &pfxs[ii], n_batch, rpaths, batch);
+
+            if (batch)
+                fib_table_batch_end();
+        }
+        t1 = vlib_time_now(vm);
+
+        vlib_cli_output(vm, "%-6s churn:     %.0f updates/sec",
+                        (batch ? "bulk" : "single"),
+                        (2 * n_churn) / (t1 - t0));
+
+        vec_foreach_index(ii, pfxs)
+        {
+            FIB_TEST((FIB_NODE_INDEX_INVALID !=
+                      fib_table_lookup_exact_match(fib_index, &pfxs[ii])),
+                     "%U present", format_fib_prefix, &pfxs[ii]);
+        }
+
+        fib_test_bulk_del(fib_index, pfxs, n_routes, batch);
+
+        vec_foreach_index(ii, pfxs)
+        {
+            FIB_TEST((FIB_NODE_INDEX_INVALID ==
+                      fib_table_lookup_exact_match(fib_index, &pfxs[ii])),
+                     "%U removed", format_fib_prefix, &pfxs[ii]);
+        }
+
+        fib_table_entry_delete(fib_index, &pfx_10_10_10_0_s_24,
+                               FIB_SOURCE_API);
+    }
+
+    fib_table_unlock(fib_index, FIB_PROTOCOL_IP4, FIB_SOURCE_API);
+
+    FIB_TEST(lb_count == pool_elts(load_balance_pool),
+             "LB pool size is %d", pool_elts(load_balance_pool));
+
+    vec_free(rpaths);
+    vec_free(pfxs);
+
+    return (res);
+}
+
+/*
+ * PIC: the routes recurse via a primary and a backup next-hop. When the
+ * primary fails they must all move to the backup with a single update of
+ * the load-balance they share, whatever the number of routes.
+ */
+
+static int
+fib_test_pic (vlib_main_t *vm, u32 n_routes)
+{
+    fib_path_list_pic_stats_t stats0, stats1;
+    fib_node_index_t fei, fei_nh1, fei_nh2;
+    const dpo_id_t *dpo, *pic_dpo;
+    fib_route_path_t *rpaths = NULL;
+    flow_hash_config_t fhc;
+    fib_prefix_t *pfxs = NULL;
+    index_t pic_lbi;
+    test_main_t *tm;
+    u32 fib_index, fib_index2, ii;
+    int res, lb_count, was_enabled;
+    f64 t0, t1, t2;
+
+    res = 0;
+    tm = &test_main;
+    lb_count = pool_elts(load_balance_pool);
+    was_enabled = fib_path_list_pic_is_enabled();
+
+    fib_path_list_pic_enable_disable(1);
+    fib_path_list_pic_get_stats(&stats0);
+
+    fib_index = fib_table_find_or_create_and_lock(FIB_PROTOCOL_IP4, 14,
+                                                  FIB_SOURCE_API);
+
+    const fib_prefix_t pfx_nh[2] = {
+        {
+            .fp_len = 32,
+            .fp_proto = FIB_PROTOCOL_IP4,
+            .fp_addr = {
+                .ip4.as_u32 = clib_host_to_net_u32(0x0a0a0a01),
+            },
+        },
+        {
+            .fp_len = 32,
+            .fp_proto = FIB_PROTOCOL_IP4,
+            .fp_addr = {
+                .ip4.as_u32 = clib_host_to_net_u32(0x0a0a0a02),
+            },
+        },
+    };
+
+    for (ii = 0; ii < 2; ii++)
+    {
+        fib_route_path_t rpath = {
+            .frp_proto = DPO_PROTO_IP4,
+            .frp_addr = pfx_nh[ii].fp_addr,
+            .frp_sw_if_index = ~0,
+            .frp_fib_index = fib_index,
+            .frp_weight = 1,
+            .frp_preference = ii,
+        };
+        vec_add1(rpaths, rpath);
+
+        fib_table_entry_update_one_path(fib_index, &pfx_nh[ii],
+                                        FIB_SOURCE_API,
+                                        FIB_ENTRY_FLAG_NONE,
+                                        DPO_PROTO_IP4,
+                                        &pfx_nh[ii].fp_addr,
+                                        tm->hw[ii]->sw_if_index,
+                                        ~0, 1, NULL,
+                                        FIB_ROUTE_PATH_FLAG_NONE);
+    }
+    fei_nh1 = fib_table_lookup_exact_match(fib_index, &pfx_nh[0]);
+    fei_nh2 = fib_table_lookup_exact_match(fib_index, &pfx_nh[1]);
+
+    vec_validate(pfxs, n_routes - 1);
+    vec_foreach_index(ii, pfxs)
+    {
+        pfxs[ii].fp_len = 32;
+        pfxs[ii].fp_proto = FIB_PROTOCOL_IP4;
+        pfxs[ii].fp_addr.ip4.as_u32 = clib_host_to_net_u32(0x02000000 + ii);
+    }
+
+    fib_table_entry_path_add_bulk(fib_index, pfxs, n_routes,
+                                  FIB_SOURCE_API,
+                                  FIB_ENTRY_FLAG_NONE,
+                                  rpaths);
+
+    /*
+     * every route shares the path-list's load-balance, which uses the
+     * primary
+     */
+    fei = fib_table_lookup_exact_match(fib_index, &pfxs[0]);
+    FIB_TEST(fib_path_list_is_pic(fib_entry_get_path_list(fei)),
+             "%U path-list is PIC", format_fib_prefix, &pfxs[0]);
+
+    dpo = fib_entry_contribute_ip_forwarding(fei);
+    pic_dpo = load_balance_get_bucket(dpo->dpoi_index, 0);
+    pic_lbi = pic_dpo->dpoi_index;
+
+    FIB_TEST(DPO_LOAD_BALANCE == pic_dpo->dpoi_type,
+             "%U via shared LB", format_fib_prefix, &pfxs[0]);
+    FIB_TEST(load_balance_get_bucket(pic_lbi, 0)->dpoi_index ==
+             fib_entry_contribute_ip_forwarding(fei_nh1)->dpoi_index,
+             "shared LB via primary");
+
+    vec_foreach_index(ii, pfxs)
+    {
+        fei = fib_table_lookup_exact_match(fib_index, &pfxs[ii]);
+        dpo = fib_entry_contribute_ip_forwarding(fei);
+
+        if (1 != load_balance_n_buckets(dpo->dpoi_index) ||
+            pic_lbi != load_balance_get_bucket(dpo->dpoi_index, 0)->dpoi_index)
+        {
+            FIB_TEST(0, "%U shares LB:%d", format_fib_prefix, &pfxs[ii],
+                     pic_lbi);
+            break;
+        }
+    }
+
+    /*
+     * fail the primary. The walk process is disabled so no route can be
+     * re-evaluated before the forwarding is checked.
+     */
+    fib_walk_process_disable();
+
+    t0 = vlib_time_now(vm);
+    fib_table_entry_delete(fib_index, &pfx_nh[0], FIB_SOURCE_API);
+    t1 = vlib_time_now(vm);
+
+    fib_path_list_pic_get_stats(&stats1);
+
+    FIB_TEST(load_balance_get_bucket(pic_lbi, 0)->dpoi_index ==
+             fib_entry_contribute_ip_forwarding(fei_nh2)->dpoi_index,
+             "shared LB via backup");
+    FIB_TEST((stats1.fpps_n_updates - stats0.fpps_n_updates) == 1,
+             "failover in %lld updates",
+             stats1.fpps_n_updates - stats0.fpps_n_updates);
+
+    fei = fib_table_lookup_exact_match(fib_index, &pfxs[n_routes - 1]);
+    dpo = fib_entry_contribute_ip_forwarding(fei);
+    FIB_TEST(pic_lbi == load_balance_get_bucket(dpo->dpoi_index, 0)->dpoi_index,
+             "%U still shares LB:%d", format_fib_prefix, &pfxs[n_routes - 1],
+             pic_lbi);
+
+    /*
+     * now let the deferred walk of the routes run
+     */
+    while (0 != fib_walk_queue_get_size(FIB_WALK_PRIORITY_LOW) ||
+           0 != fib_walk_queue_get_size(FIB_WALK_PRIORITY_HIGH))
+    {
+        fib_walk_process_queues(vm, 1);
+    }
+    t2 = vlib_time_now(vm);
+
+    fib_walk_process_enable();
+
+    vlib_cli_output(vm, "%d routes: failover in %.2f usecs with %lld updates, "
+                    "route walk %.2f usecs",
+                    n_routes, (t1 - t0) * 1e6,
+                    stats1.fpps_n_updates - stats0.fpps_n_updates,
+                    (t2 - t1) * 1e6);
+
+    /*
+     * restore the primary
+     */
+    fib_table_entry_update_one_path(fib_index, &pfx_nh[0],
+                                    FIB_SOURCE_API,
+                                    FIB_ENTRY_FLAG_NONE,
+                                    DPO_PROTO_IP4,
+                                    &pfx_nh[0].fp_addr,
+                                    tm->hw[0]->sw_if_index,
+                                    ~0, 1, NULL,
+                                    FIB_ROUTE_PATH_FLAG_NONE);
+    fei_nh1 = fib_table_lookup_exact_match(fib_index, &pfx_nh[0]);
+
+    FIB_TEST(load_balance_get_bucket(pic_lbi, 0)->dpoi_index ==
+             fib_entry_contribute_ip_forwarding(fei_nh1)->dpoi_index,
+             "shared LB via primary");
+
+    /*
+     * a route over the same paths in a table with a different flow-hash
+     * config gets its own shared LB, with that table's config
+     */
+    fhc = IP_FLOW_HASH_SRC_ADDR | IP_FLOW_HASH_DST_ADDR;
+    fib_index2 = fib_table_find_or_create_and_lock(FIB_PROTOCOL_IP4, 15,
+                                                   FIB_SOURCE_API);
+    fib_table_set_flow_hash_config(fib_index2, FIB_PROTOCOL_IP4, fhc);
+
+    fib_table_entry_path_add2(fib_index2, &pfxs[0],
+                              FIB_SOURCE_API,
+                              FIB_ENTRY_FLAG_NONE,
+                              rpaths);
+    fei = fib_table_lookup_exact_match(fib_index2, &pfxs[0]);
+    FIB_TEST(fib_entry_get_path_list(fei) ==
+             fib_entry_get_path_list(fib_table_lookup_exact_match(fib_index,
+                                                                  &pfxs[0])),
+             "%U shares the path-list", format_fib_prefix, &pfxs[0]);
+
+    dpo = fib_entry_contribute_ip_forwarding(fei);
+    pic_dpo = load_balance_get_bucket(dpo->dpoi_index, 0);
+    FIB_TEST(DPO_LOAD_BALANCE == pic_dpo->dpoi_type &&
+             pic_lbi != pic_dpo->dpoi_index,
+             "%U via its own shared LB", format_fib_prefix, &pfxs[0]);
+    FIB_TEST(fhc == load_balance_get(pic_dpo->dpoi_index)->lb_hash_config,
+             "shared LB uses the table's flow-hash config");
+    FIB_TEST(IP_FLOW_HASH_DEFAULT ==
+             load_balance_get(pic_lbi)->lb_hash_config,
+             "shared LB uses the default flow-hash config");
+    FIB_TEST(load_balance_get_bucket(pic_dpo->dpoi_index, 0)->dpoi_index ==
+             fib_entry_contribute_ip_forwarding(fei_nh1)->dpoi_index,
+             "table's shared LB via primary");
+
+    fib_table_entry_delete(fib_index2, &pfxs[0], FIB_SOURCE_API);
+    fib_table_unlock(fib_index2, FIB_PROTOCOL_IP4, FIB_SOURCE_API);
+
+    /*
+     * disabling PIC gives the routes their own forwarding back
+     */
+    fib_path_list_pic_enable_disable(0);
+
+    fei = fib_table_lookup_exact_match(fib_index, &pfxs[0]);
+    dpo = fib_entry_contribute_ip_forwarding(fei);
+    FIB_TEST(!fib_path_list_is_pic(fib_entry_get_path_list(fei)),
+             "%U path-list is not PIC", format_fib_prefix, &pfxs[0]);
+    FIB_TEST(load_balance_get_bucket(dpo->dpoi_index, 0)->dpoi_index ==
+             fib_entry_contribute_ip_forwarding(fei_nh1)->dpoi_index,
+             "%U via primary", format_fib_prefix, &pfxs[0]);
+
+    fib_table_entry_delete_bulk(fib_index, pfxs, n_routes, FIB_SOURCE_API);
+    for (ii = 0; ii < 2; ii++)
+    {
+        fib_table_entry_delete(fib_index, &pfx_nh[ii], FIB_SOURCE_API);
+    }
+
+    while (0 != fib_walk_queue_get_size(FIB_WALK_PRIORITY_LOW) ||
+           0 != fib_walk_queue_get_size(FIB_WALK_PRIORITY_HIGH))
+    {
+        fib_walk_process_queues(vm, 1);
+    }
+
+    fib_table_unlock(fib_index, FIB_PROTOCOL_IP4, FIB_SOURCE_API);
+    fib_path_list_pic_enable_disable(was_enabled);
+
+    fib_path_list_pic_get_stats(&stats1);
+    FIB_TEST(stats0.fpps_n_lbs == stats1.fpps_n_lbs,
+             "PIC LBs freed: %d", stats1.fpps_n_lbs);
+    FIB_TEST(lb_count == pool_elts(load_balance_pool),
+             "LB pool size is %d", pool_elts(load_balance_pool));
+
+    vec_free(rpaths);
+    vec_free(pfxs);
+
+    return (res);
+}
+
+/*
+ * Resilient hashing: when a path is removed only its buckets move. When a
+ * path is added the buckets move only once they are idle, or when the
+ * load-balance has been unbalanced for too long.
+ */
+#define FIB_TEST_RES_N_PATHS 4
+
+static void
+fib_test_resilient_count (const load_balance_t *lb,
+                          const adj_index_t *ais,
+                          u32 *n_owned)
+{
+    const dpo_id_t *bucket;
+    u32 ii, jj;
+
+    for (jj = 0; jj < FIB_TEST_RES_N_PATHS; jj++)
+        n_owned[jj] = 0;
+
+    for (ii = 0; ii < lb->lb_n_buckets; ii++)
+    {
+        bucket = load_balance_get_bucket_i(lb, ii);
+
+        for (jj = 0; jj < FIB_TEST_RES_N_PATHS; jj++)
+        {
+            if (bucket->dpoi_index == ais[jj])
+                n_owned[jj]++;
+        }
+    }
+}
+
+static int
+fib_test_resilient (vlib_main_t *vm)
+{
+    load_balance_path_t *paths = NULL, *path;
+    u32 n_owned[FIB_TEST_RES_N_PATHS], ii;
+    adj_index_t ais[FIB_TEST_RES_N_PATHS];
+    index_t *before = NULL, *after = NULL;
+    dpo_id_t dpo = DPO_INVALID;
+    u32 lb_count, lbr_count;
+    const load_balance_t *lb;
+    test_main_t *tm;
+    index_t lbi;
+    int res;
+    f64 now;
+
+    res = 0;
+    tm = &test_main;
+    lb_count = pool_elts(load_balance_pool);
+    lbr_count = pool_elts(load_balance_resilient_pool);
+
+    load_balance_resilient_set_timers(1.0, 60.0);
+
+    for (ii = 0; ii < FIB_TEST_RES_N_PATHS; ii++)
+    {
+        ip46_address_t nh = {
+            .ip4.as_u32 = clib_host_to_net_u32(0x0a0a0a02 + ii),
+        };
+
+        ais[ii] = adj_nbr_add_or_lock(FIB_PROTOCOL_IP4,
+                                      VNET_LINK_IP4,
+                                      &nh, tm->hw[0]->sw_if_index);
+        vec_add2(paths, path, 1);
+        path->path_index = ii;
+        path->path_weight = 1;
+        dpo_set(&path->path_dpo, DPO_ADJACENCY, DPO_PROTO_IP4, ais[ii]);
+    }
+
+    lbi = load_balance_create(1, DPO_PROTO_IP4, 0);
+    dpo_set(&dpo, DPO_LOAD_BALANCE, DPO_PROTO_IP4, lbi);
+
+    load_balance_multipath_update(&dpo, paths, LOAD_BALANCE_FLAG_RESILIENT);
+    lb = load_balance_get(lbi);
+
+    FIB_TEST(128 == lb->lb_n_buckets, "128 buckets: %d", lb->lb_n_buckets);
+    FIB_TEST(lb->lb_flags & LOAD_BALANCE_FLAG_RESILIENT, "LB is resilient");
+    fib_test_resilient_count(lb, ais, n_owned);
+    for (ii = 0; ii < FIB_TEST_RES_N_PATHS; ii++)
+        FIB_TEST(32 == n_owned[ii], "path %d owns 32: %d", ii, n_owned[ii]);
+
+    vec_validate(before, lb->lb_n_buckets - 1);
+    vec_validate(after, lb->lb_n_buckets - 1);
+    for (ii = 0; ii < lb->lb_n_buckets; ii++)
+        before[ii] = load_balance_get_bucket_i(lb, ii)->dpoi_index;
+
+    /*
+     * remove a path; only its buckets move, and they move now
+     */
+    load_balance_multipath_update(&dpo,
+                                  paths + 1,
+                                  LOAD_BALANCE_FLAG_RESILIENT);
+    /* reallocation of the buckets may have moved the LB */
+    lb = load_balance_get(lbi);
+
+    FIB_TEST(128 == lb->lb_n_buckets, "128 buckets: %d", lb->lb_n_buckets);
+    fib_test_resilient_count(lb, ais, n_owned);
+    FIB_TEST(0 == n_owned[0], "removed path owns none: %d", n_owned[0]);
+    FIB_TEST(128 == n_owned[1] + n_owned[2] + n_owned[3],
+             "remaining paths own all");
+    for (ii = 1; ii < FIB_TEST_RES_N_PATHS; ii++)
+        FIB_TEST(42 <= n_owned[ii] && n_owned[ii] <= 43,
+                 "path %d owns its share: %d", ii, n_owned[ii]);
+
+    for (ii = 0; ii < lb->lb_n_buckets; ii++)
+    {
+        after[ii] = load_balance_get_bucket_i(lb, ii)->dpoi_index;
+
+        if (before[ii] != ais[0])
+            FIB_TEST(before[ii] == after[ii], "bucket %d did not move", ii);
+    }
+    FIB_TEST(0 == load_balance_resilient_scan(vlib_time_now(vm)),
+             "balanced after removal");
+
+    /*
+     * add it back; nothing moves until it is idle
+     */
+    load_balance_multipath_update(&dpo, paths, LOAD_BALANCE_FLAG_RESILIENT);
+    lb = load_balance_get(lbi);
+
+    for (ii = 0; ii < lb->lb_n_buckets; ii++)
+    {
+        before[ii] = after[ii];
+        FIB_TEST(before[ii] == load_balance_get_bucket_i(lb, ii)->dpoi_index,
+                 "bucket %d did not move on add", ii);
+    }
+
+    now = vlib_time_now(vm);
+    FIB_TEST(1 == load_balance_resilient_scan(now),
+             "unbalanced before idle time");
+
+    /* the first bucket sees traffic and so must stay put */
+    load_balance_get_fwd_bucket(lb, 0);
+
+    FIB_TEST(0 == load_balance_resilient_scan(now + 2.0),
+             "balanced after idle time");
+    fib_test_resilient_count(lb, ais, n_owned);
+    for (ii = 0; ii < FIB_TEST_RES_N_PATHS; ii++)
+        FIB_TEST(32 == n_owned[ii], "path %d owns 32: %d", ii, n_owned[ii]);
+
+    for (ii = 0; ii < lb->lb_n_buckets; ii++)
+    {
+        after[ii] = load_balance_get_bucket_i(lb, ii)->dpoi_index;
+
+        FIB_TEST(before[ii] == after[ii] || ais[0] == after[ii],
+                 "bucket %d moved only to the new path", ii);
+    }
+    FIB_TEST(before[0] == after[0], "active bucket did not move");
+
+    /*
+     * change the weights with all buckets in use; nothing moves until
+     * the load-balance has been unbalanced for too long.
+     */
+    paths[0].path_weight = 3;
+    load_balance_multipath_update(&dpo, paths, LOAD_BALANCE_FLAG_RESILIENT);
+    lb = load_balance_get(lbi);
+
+    now = vlib_time_now(vm) + 2.0;
+    for (ii = 0; ii < lb->lb_n_buckets; ii++)
+        load_balance_get_fwd_bucket(lb, ii);
+
+    FIB_TEST(1 == load_balance_resilient_scan(now),
+             "active buckets do not move");
+    fib_test_resilient_count(lb, ais, n_owned);
+    FIB_TEST(32 == n_owned[0], "path 0 owns 32: %d", n_owned[0]);
+
+    load_balance_resilient_set_timers(1.0, 0.0);
+    for (ii = 0; ii < lb->lb_n_buckets; ii++)
+        load_balance_get_fwd_bucket(lb, ii);
+
+    FIB_TEST(0 == load_balance_resilient_scan(now + 2.0),
+             "forced balance");
+    fib_test_resilient_count(lb, ais, n_owned);
+    FIB_TEST(n_owned[0] > n_owned[1], "path 0 owns more: %d", n_owned[0]);
+    load_balance_resilient_set_timers(1.0, 60.0);
+
+    /*
+     * no longer resilient
+     */
+    load_balance_multipath_update(&dpo, paths, LOAD_BALANCE_FLAG_NONE);
+    lb = load_balance_get(lbi);
+    FIB_TEST(!(lb->lb_flags & LOAD_BALANCE_FLAG_RESILIENT),
+             "LB is not resilient");
+    FIB_TEST(INDEX_INVALID ==
+             load_balance_main.lbm_resilient_by_lb[lbi],
+             "resilient state unpublished");
+    /* the state itself goes once the workers are done with it */
+    vlib_rcu_poll(vlib_get_main());
+    FIB_TEST(lbr_count == pool_elts(load_balance_resilient_pool),
+             "resilient state freed");
+
+    /*
+     * cleanup
+     */
+    dpo_reset(&dpo);
+    vec_foreach(path, paths)
+    {
+        dpo_reset(&path->path_dpo);
+    }
+    for (ii = 0; ii < FIB_TEST_RES_N_PATHS; ii++)
+        adj_unlock(ais[ii]);
+
+    FIB_TEST(lb_count == pool_elts(load_balance_pool),
+             "LB pool size is %d", pool_elts(load_balance_pool));
+    vlib_rcu_poll(vlib_get_main());
+    FIB_TEST(lbr_count == pool_elts(load_balance_resilient_pool),
+             "resilient pool size is %d",
+             pool_elts(load_balance_resilient_pool));
+
+    vec_free(paths);
+    vec_free(before);
+    vec_free(after);
+
+    return (res);
+}
+
 static clib_error_t *
 fib_test (vlib_main_t * vm,
           unformat_input_t * input,
           vlib_cli_command_t * cmd_arg)
 {
+    u32 n_routes;
     int res;
 
     res = 0;
@@ -10921,6 +11663,26 @@ fib_test (vlib_main_t * vm,
     {
         res += fib_test_sticky();
     }
+    else if (unformat (input, "bulk %d", &n_routes))
+    {
+        res += fib_test_bulk(vm, n_routes);
+    }
+    else if (unformat (input, "bulk"))
+    {
+        res += fib_test_bulk(vm, 10000);
+    }
+    else if (unformat (input, "pic %d", &n_routes))
+    {
+        res += fib_test_pic(vm, n_routes);
+    }
+    else if (unformat (input, "pic"))
+    {
+        res += fib_test_pic(vm, 500000);
+    }
+    else if (unformat (input, "resilient"))
+    {
+        res += fib_test_resilient(vm);
+    }
     else
     {
         res += fib_test_v4();
@@ -0,0 +1,327 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vppinfra/random.h>
+
+/*
+ * Hand packets off between workers with a skewed flow distribution, so
+ * that one worker gets most of them, and compare the aggregate rate the
+ * workers get through with each frame queue steal mode.
+ *
+ * Every worker runs an input node that makes packets for random flows,
+ * each carrying a per producer, per flow sequence number, and hands them
+ * off to the worker of their flow. The sink burns a fixed number of
+ * clocks per packet, and counts packets seen out of order.
+ */
+
+typedef struct
+{
+  clib_thread_index_t producer;
+  u32 flow;
+  u32 seq;
+} fq_test_packet_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  u64 n_sent;
+  u64 n_dropped;
+  u64 n_received;
+  u64 n_reordered;
+  u32 seed;
+} fq_test_per_thread_t;
+
+typedef struct
+{
+  u32 frame_queue_index;
+  u32 n_workers;
+  u32 n_flows;
+  u32 skew;
+  u32 cycles;
+  u32 burst;
+
+  fq_test_per_thread_t *per_thread;
+
+  /* per producer, per flow */
+  u32 **next_seq;
+  u32 **last_seq;
+} fq_test_main_t;
+
+static fq_test_main_t fq_test_main = { .frame_queue_index = ~0 };
+
+static_always_inline clib_thread_index_t
+fq_test_flow_thread (fq_test_main_t *tm, u32 flow)
+{
+  /* skew percent of the flows belong to the first worker */
+  if (flow % 100 < tm->skew)
+    return 1;
+  return 1 + flow % tm->n_workers;
+}
+
+static uword
+fq_test_input (vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *f)
+{
+  fq_test_main_t *tm = &fq_test_main;
+  fq_test_per_thread_t *ptd;
+  clib_thread_index_t thread_index = vm->thread_index;
+  u32 buffers[VLIB_FRAME_SIZE], n, n_enq, i, *next_seq;
+  u16 threads[VLIB_FRAME_SIZE];
+  fq_test_packet_t *p;
+  vlib_buffer_t *b;
+
+  ptd = vec_elt_at_index (tm->per_thread, thread_index);
+  next_seq = tm->next_seq[thread_index];
+
+  n = vlib_buffer_alloc (vm, buffers, tm->burst);
+
+  for (i = 0; i < n; i++)
+    {
+      b = vlib_get_buffer (vm, buffers[i]);
+      p = vlib_buffer_get_current (b);
+      p->producer = thread_index;
+      p->flow = random_u32 (&ptd->seed) % tm->n_flows;
+      p->seq = next_seq[p->flow]++;
+      b->current_length = sizeof (*p);
+      threads[i] = fq_test_flow_thread (tm, p->flow);
+    }
+
+  n_enq = vlib_buffer_enqueue_to_thread (vm, node, tm->frame_queue_index,
+					 buffers, threads, n,
+					 1 /* drop on congestion */);
+  ptd->n_sent += n_enq;
+  ptd->n_dropped += n - n_enq;
+  return n;
+}
+
+VLIB_REGISTER_NODE (fq_test_input_node, static) = {
+  .function = fq_test_input,
+  .name = "frame-queue-test-input",
+  .type = VLIB_NODE_TYPE_INPUT,
+  .state = VLIB_NODE_STATE_DISABLED,
+};
+
+static uword
+fq_test_sink (vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *f)
+{
+  fq_test_main_t *tm = &fq_test_main;
+  fq_test_per_thread_t *ptd;
+  u32 *from = vlib_frame_vector_args (f), n = f->n_vectors, i, *last;
+  fq_test_packet_t *p;
+  u64 t;
+
+  ptd = vec_elt_at_index (tm->per_thread, vm->thread_index);
+
+  for (i = 0; i < n; i++)
+    {
+      p = vlib_buffer_get_current (vlib_get_buffer (vm, from[i]));
+      last = &tm->last_seq[p->producer][p->flow];
+      if (p->seq < last[0])
+	ptd->n_reordered++;
+      else
+	last[0] = p->seq;
+    }
+
+  /* the work a real node would do */
+  t = clib_cpu_time_now () + (u64) n * tm->cycles;
+  while (clib_cpu_time_now () < t)
+    CLIB_PAUSE ();
+
+  ptd->n_received += n;
+  vlib_buffer_free (vm, from, n);
+  return n;
+}
+
+VLIB_REGISTER_NODE (fq_test_sink_node, static) = {
+  .function = fq_test_sink,
+  .name = "frame-queue-test-sink",
+  .vector_size = sizeof (u32),
+};
+
+static void
+fq_test_set_input_state (vlib_main_t *vm, vlib_node_state_t state)
+{
+  vlib_worker_thread_barrier_sync (vm);
+  foreach_vlib_main ()
+    if (this_vlib_main->thread_index)
+      vlib_node_set_state (this_vlib_main, fq_test_input_node.index, state);
+  vlib_worker_thread_barrier_release (vm);
+}
+
+/* Hand off for duration with the given steal mode, the aggregate rate in
+ * mpps, the elements stolen in n_stolen. */
+static clib_error_t *
+fq_test_run (vlib_main_t *vm, vlib_frame_queue_steal_mode_t mode,
+	     f64 duration, f64 *mpps, u64 *n_stolen_p)
+{
+  vlib_thread_main_t *thm = vlib_get_thread_main ();
+  fq_test_main_t *tm = &fq_test_main;
+  vlib_frame_queue_main_t *fqm;
+  fq_test_per_thread_t *ptd;
+  u64 n_sent = 0, n_dropped = 0, n_received = 0, n_reordered = 0;
+  u64 n_stolen = 0;
+  clib_error_t *error;
+  f64 t0, dt, deadline;
+  u32 i;
+
+  error = vlib_frame_queue_set_steal_mode (tm->frame_queue_index, mode, 0);
+  if (error)
+    return error;
+
+  fqm = vec_elt_at_index (thm->frame_queue_mains, tm->frame_queue_index);
+  for (i = 0; i < vec_len (fqm->vlib_frame_queues); i++)
+    fqm->vlib_frame_queues[i]->n_stolen = 0;
+
+  for (i = 0; i < vec_len (tm->per_thread); i++)
+    {
+      ptd = vec_elt_at_index (tm->per_thread, i);
+      ptd->n_sent = ptd->n_dropped = ptd->n_received = ptd->n_reordered = 0;
+      ptd->seed = 0xdeadbeef + i;
+      clib_memset (tm->next_seq[i], 0, vec_bytes (tm->next_seq[i]));
+      clib_memset (tm->last_seq[i], 0, vec_bytes (tm->last_seq[i]));
+    }
+
+  fq_test_set_input_state (vm, VLIB_NODE_STATE_POLLING);
+  t0 = vlib_time_now (vm);
+  vlib_process_suspend (vm, duration);
+
+  /* the rate is what the sinks got through while the producers ran */
+  vec_foreach (ptd, tm->per_thread)
+    n_received += ptd->n_received;
+  dt = vlib_time_now (vm) - t0;
+  *mpps = n_received / dt / 1e6;
+
+  fq_test_set_input_state (vm, VLIB_NODE_STATE_DISABLED);
+
+  /* every packet handed off comes out of the queues */
+  deadline = vlib_time_now (vm) + 2.0;
+  do
+    {
+      vlib_process_suspend (vm, 1e-2);
+      n_sent = n_dropped = n_received = n_reordered = 0;
+      vec_foreach (ptd, tm->per_thread)
+	{
+	  n_sent += ptd->n_sent;
+	  n_dropped += ptd->n_dropped;
+	  n_received += ptd->n_received;
+	  n_reordered += ptd->n_reordered;
+	}
+    }
+  while (n_received < n_sent && vlib_time_now (vm) < deadline);
+
+  for (i = 0; i < vec_len (fqm->vlib_frame_queues); i++)
+    n_stolen += fqm->vlib_frame_queues[i]->n_stolen;
+  *n_stolen_p = n_stolen;
+
+  vlib_cli_output (vm,
+		   "steal %-8U %8.3f Mpps, %llu handed off, %llu congestion "
+		   "drops, %llu elements stolen, %llu out of order",
+		   format_vlib_frame_queue_steal_mode, mode, *mpps, n_sent,
+		   n_dropped, n_stolen, n_reordered);
+
+  for (i = 1; i < vec_len (tm->per_thread); i++)
+    vlib_cli_output (vm, "  %-20v received %llu", vlib_worker_threads[i].name,
+		     tm->per_thread[i].n_received);
+
+  if (n_received != n_sent)
+    return clib_error_return (0, "Failed: %llu of %llu packets not drained",
+			      n_sent - n_received, n_sent);
+  if (mode != VLIB_FRAME_QUEUE_STEAL_NONE && n_stolen == 0)
+    return clib_error_return (0, "Failed: nothing stolen");
+  /* only stealing any element may reorder a flow */
+  if (n_reordered && mode != VLIB_FRAME_QUEUE_STEAL_ANY)
+    return clib_error_return (0, "Failed: %llu packets out of order",
+			      n_reordered);
+  return 0;
+}
+
+static clib_error_t *
+test_frame_queue_steal_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				   vlib_cli_command_t *cmd)
+{
+  fq_test_main_t *tm = &fq_test_main;
+  clib_error_t *error = 0;
+  f64 duration = 1.0, none_mpps, any_mpps, ordered_mpps;
+  u64 n_stolen;
+  u32 i;
+
+  tm->n_flows = 1024;
+  tm->skew = 80;
+  tm->cycles = 500;
+  tm->burst = 32;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "flows %u", &tm->n_flows))
+	;
+      else if (unformat (input, "skew %u", &tm->skew))
+	;
+      else if (unformat (input, "cycles %u", &tm->cycles))
+	;
+      else if (unformat (input, "burst %u", &tm->burst))
+	;
+      else if (unformat (input, "duration %f", &duration))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  tm->n_workers = vlib_num_workers ();
+  if (tm->n_workers < 2)
+    return clib_error_return (0, "needs at least 2 workers");
+  if (tm->n_flows == 0 || tm->skew > 100 || tm->burst == 0 ||
+      tm->burst > VLIB_FRAME_SIZE)
+    return clib_error_return (0, "flows must be non-zero, skew at most "
+				 "100, burst in [1, %u]",
+			      VLIB_FRAME_SIZE);
+
+  /* frame queues can't be freed, so there is one for all runs */
+  if (tm->frame_queue_index == ~0)
+    tm->frame_queue_index =
+      vlib_frame_queue_main_init (fq_test_sink_node.index, 0);
+
+  vec_validate_aligned (tm->per_thread, tm->n_workers, CLIB_CACHE_LINE_BYTES);
+  vec_validate (tm->next_seq, tm->n_workers);
+  vec_validate (tm->last_seq, tm->n_workers);
+  for (i = 0; i <= tm->n_workers; i++)
+    {
+      vec_validate (tm->next_seq[i], tm->n_flows - 1);
+      vec_validate (tm->last_seq[i], tm->n_flows - 1);
+    }
+
+  vlib_cli_output (vm, "%u workers, %u flows, %u%% to the first, %u clocks "
+		   "per packet",
+		   tm->n_workers, tm->n_flows, tm->skew, tm->cycles);
+
+  if ((error = fq_test_run (vm, VLIB_FRAME_QUEUE_STEAL_NONE, duration,
+			    &none_mpps, &n_stolen)))
+    goto done;
+  if ((error = fq_test_run (vm, VLIB_FRAME_QUEUE_STEAL_ANY, duration,
+			    &any_mpps, &n_stolen)))
+    goto done;
+  if ((error = fq_test_run (vm, VLIB_FRAME_QUEUE_STEAL_ORDERED, duration,
+			    &ordered_mpps, &n_stolen)))
+    goto done;
+
+  /* with most flows on one worker, the others taking its elements get
+   * more through; how much depends on the machine, so it is only shown */
+  vlib_cli_output (vm, "steal any gains %.1f%%, ordered %.1f%%",
+		   100 * (any_mpps / none_mpps - 1),
+		   100 * (ordered_mpps / none_mpps - 1));
+
+done:
+  vlib_frame_queue_set_steal_mode (tm->frame_queue_index,
+				   VLIB_FRAME_QUEUE_STEAL_NONE, 0);
+  return error;
+}
+
+VLIB_CLI_COMMAND (test_frame_queue_steal_command, static) = {
+  .path = "test frame-queue steal",
+  .short_help = "test frame-queue steal [flows <n>] [skew <percent>] "
+		"[cycles <n>] [burst <n>] [duration <sec>]",
+  .function = test_frame_queue_steal_command_fn,
+  /* the workers must run while the command waits */
+  .is_mp_safe = 1,
+};
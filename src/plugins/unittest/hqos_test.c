@@ -0,0 +1,201 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/hqos/hqos.h>
+#include <vppinfra/random.h>
+
+/*
+ * Run packets through an unshaped HQoS port a frame at a time, each to a
+ * random queue of a random pipe, and check each comes out once. The
+ * buffer indices are never dereferenced, so none are allocated.
+ */
+
+static hqos_port_t *
+hqos_test_port_create (vlib_main_t *vm, hqos_port_config_t *c, int *rv)
+{
+  hqos_port_t *port;
+
+  port = clib_mem_alloc_aligned (sizeof (*port), CLIB_CACHE_LINE_BYTES);
+  *rv = hqos_port_init (vm, port, c);
+  if (*rv)
+    {
+      clib_mem_free (port);
+      return 0;
+    }
+  return port;
+}
+
+static void
+hqos_test_port_destroy (vlib_main_t *vm, hqos_port_t *port)
+{
+  hqos_port_free (vm, port);
+  clib_mem_free (port);
+}
+
+/* The strict priority classes go first, in order. */
+static clib_error_t *
+hqos_test_priority (vlib_main_t *vm)
+{
+  hqos_port_config_t c = {
+    .n_subports = 1,
+    .n_pipes = 1,
+    .queue_size = 8,
+    .frame_size = VLIB_FRAME_SIZE,
+  };
+  u32 expected[] = { 5, 4, 0, 1, 2, 3 };
+  u32 buffers[VLIB_FRAME_SIZE], i, n;
+  clib_error_t *err = 0;
+  hqos_port_t *port;
+  int rv;
+
+  port = hqos_test_port_create (vm, &c, &rv);
+  if (port == 0)
+    return clib_error_return (0, "port init failed: %d", rv);
+
+  for (i = 0; i < 4; i++)
+    hqos_port_enqueue (port, 0, hqos_queue_index (HQOS_BE_TC, 0), i, 64);
+  hqos_port_enqueue (port, 0, hqos_queue_index (1, 0), 4, 64);
+  hqos_port_enqueue (port, 0, hqos_queue_index (0, 0), 5, 64);
+
+  n = hqos_port_dequeue (vm, port, buffers, VLIB_FRAME_SIZE);
+  if (n != ARRAY_LEN (expected))
+    err = clib_error_return (0, "priority: dequeued %u of %u", n,
+			     ARRAY_LEN (expected));
+  else
+    for (i = 0; i < n; i++)
+      if (buffers[i] != expected[i])
+	{
+	  err = clib_error_return (0, "priority: %u dequeued at %u, not %u",
+				   buffers[i], i, expected[i]);
+	  break;
+	}
+
+  hqos_test_port_destroy (vm, port);
+  return err;
+}
+
+static clib_error_t *
+test_hqos_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  hqos_port_config_t c = {
+    .n_subports = 1,
+    .n_pipes = 64 << 10,
+    .queue_size = HQOS_DEFAULT_QUEUE_SIZE,
+    .frame_size = VLIB_FRAME_SIZE,
+  };
+  u32 n_packets = 1 << 20, n_rounds = 10, seed = 0xdeadbeef;
+  u32 *pipes = 0, *buffers = 0;
+  u8 *queues = 0, *seen = 0;
+  u64 t0, enqueue_clocks = 0, dequeue_clocks = 0;
+  u32 i, j, n, n_out, n_drops = 0;
+  clib_error_t *err = 0;
+  hqos_port_t *port;
+  int rv;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "subports %u", &c.n_subports))
+	;
+      else if (unformat (input, "pipes %u", &c.n_pipes))
+	;
+      else if (unformat (input, "queue-size %u", &c.queue_size))
+	;
+      else if (unformat (input, "packets %u", &n_packets))
+	;
+      else if (unformat (input, "rounds %u", &n_rounds))
+	;
+      else if (unformat (input, "seed %u", &seed))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (n_packets == 0 || n_rounds == 0)
+    return clib_error_return (0, "non-zero packets and rounds");
+
+  err = hqos_test_priority (vm);
+  if (err)
+    return err;
+
+  port = hqos_test_port_create (vm, &c, &rv);
+  if (port == 0)
+    return clib_error_return (0, "port init failed: %d", rv);
+
+  vec_validate (pipes, n_packets - 1);
+  vec_validate (queues, n_packets - 1);
+  vec_validate (seen, n_packets - 1);
+  vec_validate (buffers, VLIB_FRAME_SIZE - 1);
+
+  for (i = 0; i < n_packets; i++)
+    {
+      pipes[i] = random_u32 (&seed) % vec_len (port->pipes);
+      queues[i] = random_u32 (&seed) % HQOS_N_QUEUES;
+    }
+
+  for (j = 0; j < n_rounds; j++)
+    {
+      clib_memset (seen, 0, vec_len (seen));
+
+      for (i = 0; i < n_packets; i += n)
+	{
+	  n = clib_min (n_packets - i, VLIB_FRAME_SIZE);
+
+	  t0 = clib_cpu_time_now ();
+	  for (u32 k = i; k < i + n; k++)
+	    n_drops += !hqos_port_enqueue (port, pipes[k], queues[k], k, 64);
+	  enqueue_clocks += clib_cpu_time_now () - t0;
+
+	  t0 = clib_cpu_time_now ();
+	  n_out = hqos_port_dequeue (vm, port, buffers, VLIB_FRAME_SIZE);
+	  dequeue_clocks += clib_cpu_time_now () - t0;
+
+	  for (u32 k = 0; k < n_out; k++)
+	    seen[buffers[k]]++;
+	}
+
+      /* drain the backlog */
+      while ((n_out = hqos_port_dequeue (vm, port, buffers, VLIB_FRAME_SIZE)))
+	for (u32 k = 0; k < n_out; k++)
+	  seen[buffers[k]]++;
+
+      for (i = 0; i < n_packets; i++)
+	if (seen[i] != 1)
+	  {
+	    err = clib_error_return (0, "packet %u dequeued %u times", i,
+				     seen[i]);
+	    goto done;
+	  }
+    }
+
+  vlib_cli_output (vm, "%u subports of %u pipes, %u packets x %u rounds, "
+		       "%u drops",
+		   c.n_subports, c.n_pipes, n_packets, n_rounds, n_drops);
+  vlib_cli_output (vm, "enqueue: %.2f clocks/packet",
+		   (f64) enqueue_clocks / n_rounds / n_packets);
+  vlib_cli_output (vm, "dequeue: %.2f clocks/packet",
+		   (f64) dequeue_clocks / n_rounds / n_packets);
+  vlib_cli_output (vm, "%.2f Mpps",
+		   (f64) n_packets * n_rounds /
+		     ((enqueue_clocks + dequeue_clocks) /
+		      vm->clib_time.clocks_per_second) /
+		     1e6);
+
+done:
+  hqos_test_port_destroy (vm, port);
+  vec_free (pipes);
+  vec_free (queues);
+  vec_free (seen);
+  vec_free (buffers);
+  return err;
+}
+
+VLIB_CLI_COMMAND (test_hqos_command, static) = {
+  .path = "test hqos",
+  .short_help = "test hqos [subports <n>] [pipes <n>] [queue-size <n>] "
+		"[packets <n>] [rounds <n>] [seed <n>]",
+  .function = test_hqos_command_fn,
+};
@@ -14,6 +14,10 @@
  */
 
 #include <vnet/vnet.h>
+#include <vnet/devices/devices.h>
+#include <vnet/ethernet/ethernet.h>
+#include <vnet/interface/rx_queue_funcs.h>
+#include <vnet/interface/tx_queue_funcs.h>
 
 static clib_error_t *
 test_interface_command_fn (vlib_main_t * vm,
@@ -64,6 +68,176 @@ VLIB_CLI_COMMAND (test_interface_command, static) =
   .function = test_interface_command_fn,
 };
 
+/* Report a tx queue's size and free descriptors as a driver would. */
+static clib_error_t *
+test_interface_tx_queue_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				    vlib_cli_command_t *cmd)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 hw_if_index = ~0, queue_id = 0, queue_index, size = ~0, n_free = ~0;
+  u32 speed = ~0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "%U", unformat_vnet_hw_interface, vnm,
+		    &hw_if_index))
+	;
+      else if (unformat (input, "queue %u", &queue_id))
+	;
+      else if (unformat (input, "size %u", &size))
+	;
+      else if (unformat (input, "free %u", &n_free))
+	;
+      else if (unformat (input, "speed %u", &speed))
+	;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (hw_if_index == ~0)
+    return clib_error_return (0, "interface required");
+
+  queue_index =
+    vnet_hw_if_get_tx_queue_index_by_id (vnm, hw_if_index, queue_id);
+  if (queue_index == ~0)
+    return clib_error_return (0, "unknown queue %u", queue_id);
+
+  if (size != ~0)
+    vnet_hw_if_tx_queue_set_size (vnm, queue_index, size);
+  if (n_free != ~0)
+    vnet_hw_if_tx_queue_set_n_free (vnm, queue_index, n_free);
+  if (speed != ~0)
+    vnet_hw_interface_set_link_speed (vnm, hw_if_index, speed);
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (test_interface_tx_queue_command, static) = {
+  .path = "test interface tx-queue",
+  .short_help = "test interface tx-queue <interface> [queue <n>] "
+		"[size <n>] [free <n>] [speed <kbps>]",
+  .function = test_interface_tx_queue_command_fn,
+};
+
+static u8 *
+format_test_rxq_interface_name (u8 *s, va_list *args)
+{
+  u32 dev_instance = va_arg (*args, u32);
+  return format (s, "test-rxq%d", dev_instance);
+}
+
+static uword
+test_rxq_interface_tx (vlib_main_t *vm, vlib_node_runtime_t *node,
+		       vlib_frame_t *frame)
+{
+  vlib_buffer_free (vm, vlib_frame_vector_args (frame), frame->n_vectors);
+  return frame->n_vectors;
+}
+
+VNET_DEVICE_CLASS (test_rxq_device_class, static) = {
+  .name = "Test rx queue interface",
+  .format_device_name = format_test_rxq_interface_name,
+  .tx_function = test_rxq_interface_tx,
+};
+
+/*
+ * Register rx queues without a thread on an interface of a NUMA node, by
+ * default the first worker's, and check where numa-local placement puts
+ * them: spread over the node's workers, or on any worker if it has none.
+ */
+static clib_error_t *
+test_interface_rx_placement_command_fn (vlib_main_t *vm,
+					unformat_input_t *input,
+					vlib_cli_command_t *cmd)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_device_main_t *vdm = &vnet_device_main;
+  vnet_eth_interface_registration_t eir = {};
+  u8 address[6] = { 0x02, 0xfe, 0, 0, 0, 1 };
+  u32 numa_node = ~0, n_queues = 4, n_local = 0;
+  u32 hw_if_index, queue_index, thread_index, i;
+  uword *used = 0;
+  clib_error_t *err = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "numa %u", &numa_node))
+	;
+      else if (unformat (input, "queues %u", &n_queues))
+	;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (!vlib_get_thread_main ()->numa_local)
+    return clib_error_return (0, "FAIL: numa-local is not configured");
+  if (vdm->first_worker_thread_index == 0)
+    return clib_error_return (0, "FAIL: no workers");
+
+  if (numa_node == ~0)
+    numa_node = vlib_worker_threads[vdm->first_worker_thread_index].numa_id;
+  for (i = vdm->first_worker_thread_index; i <= vdm->last_worker_thread_index;
+       i++)
+    n_local += vlib_worker_threads[i].numa_id == numa_node;
+
+  eir.dev_class_index = test_rxq_device_class.index;
+  eir.address = address;
+  hw_if_index = vnet_eth_register_interface (vnm, &eir);
+  vnet_get_hw_interface (vnm, hw_if_index)->numa_node = numa_node;
+
+  for (i = 0; i < n_queues; i++)
+    {
+      queue_index = vnet_hw_if_register_rx_queue (vnm, hw_if_index, i,
+						  VNET_HW_IF_RXQ_THREAD_ANY);
+      thread_index = vnet_hw_if_get_rx_queue_thread_index (vnm, queue_index);
+      vlib_cli_output (vm, "queue %u: thread %u, numa %d", i, thread_index,
+		       vlib_worker_threads[thread_index].numa_id);
+
+      if (thread_index < vdm->first_worker_thread_index ||
+	  thread_index > vdm->last_worker_thread_index)
+	{
+	  err = clib_error_return (0, "FAIL: queue %u on thread %u, not a "
+				      "worker",
+				   i, thread_index);
+	  goto done;
+	}
+      if (n_local && vlib_worker_threads[thread_index].numa_id != numa_node)
+	{
+	  err = clib_error_return (0, "FAIL: queue %u on numa %d, not %u", i,
+				   vlib_worker_threads[thread_index].numa_id,
+				   numa_node);
+	  goto done;
+	}
+      used = clib_bitmap_set (used, thread_index, 1);
+    }
+
+  /* each queue went to the least loaded worker, so they are spread */
+  if (n_local > 1 && n_queues > 1 && clib_bitmap_count_set_bits (used) < 2)
+    {
+      err = clib_error_return (0, "FAIL: all queues on one of %u workers",
+			       n_local);
+      goto done;
+    }
+
+  vlib_cli_output (vm, "%u queues on %u of %u workers of numa %u, PASS",
+		   n_queues, clib_bitmap_count_set_bits (used), n_local,
+		   numa_node);
+
+done:
+  vnet_hw_if_unregister_all_rx_queues (vnm, hw_if_index);
+  ethernet_delete_interface (vnm, hw_if_index);
+  clib_bitmap_free (used);
+  return err;
+}
+
+VLIB_CLI_COMMAND (test_interface_rx_placement_command, static) = {
+  .path = "test interface rx-placement",
+  .short_help = "test interface rx-placement [numa <n>] [queues <n>]",
+  .function = test_interface_rx_placement_command_fn,
+};
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
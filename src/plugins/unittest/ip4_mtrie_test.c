@@ -0,0 +1,354 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vppinfra/random.h>
+#include <vnet/ip/ip.h>
+#include <vnet/ip/ip4_mtrie.h>
+
+/*
+ * Compare the 8-8-8-8, 16-8-8 and 24-8 (DIR-24-8) mtries on a synthetic
+ * table whose prefix length distribution roughly follows a BGP full table.
+ * All three tries must resolve every lookup to the same leaf, as must the
+ * 8 way gather lookup of the 24-8 trie where the CPU has 256 bit vectors.
+ */
+
+/* Lookup n addresses in the 24-8 trie, 8 at a time with gathers. Returns
+ * 0 if this CPU variant has no 256 bit vectors. */
+CLIB_MARCH_FN (ip4_mtrie_test_lookup_24_x8, int, ip4_mtrie_24_t *m,
+	       const ip4_address_t *addrs, u32 *res, u32 n)
+{
+#ifdef CLIB_HAVE_VEC256
+  u32x8 dst, leaf;
+  u32 i, j;
+
+  for (i = 0; i + 8 <= n; i += 8)
+    {
+      for (j = 0; j < 8; j++)
+	dst[j] = addrs[i + j].as_u32;
+
+      dst = u32x8_byte_swap (dst);
+      leaf = ip4_mtrie_24_lookup_x8 (m, dst);
+      u32x8_store_unaligned (leaf >> 1, res + i);
+    }
+  for (; i < n; i++)
+    res[i] = ip4_mtrie_leaf_get_adj_index (ip4_mtrie_24_lookup_step (
+      ip4_mtrie_24_lookup_step_one (m, addrs + i), addrs + i));
+
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+#ifndef CLIB_MARCH_VARIANT
+
+typedef struct
+{
+  ip4_address_t addr;
+  u8 len;
+  u32 adj_index;
+  u32 cover_len;
+  u32 cover_adj_index;
+} ip4_mtrie_test_route_t;
+
+typedef struct
+{
+  u32 n_routes;
+  u32 n_lookups;
+  u32 seed;
+  int verbose;
+  ip4_mtrie_test_route_t *routes;
+  ip4_address_t *addrs;
+  u32 *results[4];
+} ip4_mtrie_test_main_t;
+
+static ip4_mtrie_test_main_t ip4_mtrie_test_main;
+
+/* percentage of routes with a given prefix length, summing to 100 */
+static const u8 ip4_mtrie_test_len_pct[33] = {
+  [8] = 1,   [12] = 1,	[14] = 1,  [16] = 2,  [17] = 1,	 [18] = 2,  [19] = 3,
+  [20] = 4,  [21] = 4,	[22] = 10, [23] = 9,  [24] = 60, [28] = 1,  [32] = 1,
+};
+
+static u8
+ip4_mtrie_test_random_len (u32 *seed)
+{
+  u32 r = random_u32 (seed) % 100, sum = 0, len;
+
+  for (len = 0; len < ARRAY_LEN (ip4_mtrie_test_len_pct); len++)
+    {
+      sum += ip4_mtrie_test_len_pct[len];
+      if (r < sum)
+	return len;
+    }
+  return 24;
+}
+
+static int
+ip4_mtrie_test_route_cmp_len (void *a1, void *a2)
+{
+  ip4_mtrie_test_route_t *r1 = a1, *r2 = a2;
+
+  return ((int) r2->len - (int) r1->len);
+}
+
+#define IP4_MTRIE_TEST_KEY(_a, _l) (((u64) (_a) << 8) | (_l))
+
+static void
+ip4_mtrie_test_gen_routes (ip4_mtrie_test_main_t *tm)
+{
+  ip4_main_t *im = &ip4_main;
+  ip4_mtrie_test_route_t *r;
+  uword *by_prefix, *p;
+  u32 seed = tm->seed, i, len;
+
+  by_prefix = hash_create (tm->n_routes, sizeof (uword));
+
+  while (vec_len (tm->routes) < tm->n_routes)
+    {
+      ip4_address_t a;
+      u8 l;
+
+      l = ip4_mtrie_test_random_len (&seed);
+      a.as_u32 = random_u32 (&seed) & im->fib_masks[l];
+
+      if (hash_get (by_prefix, IP4_MTRIE_TEST_KEY (a.as_u32, l)))
+	continue;
+
+      vec_add2 (tm->routes, r, 1);
+      r->addr = a;
+      r->len = l;
+      /* leave index 0 for the empty leaf */
+      r->adj_index = vec_len (tm->routes);
+      hash_set (by_prefix, IP4_MTRIE_TEST_KEY (a.as_u32, l), r->adj_index);
+    }
+
+  /* the cover is needed to remove a route from the tries */
+  vec_foreach (r, tm->routes)
+    {
+      r->cover_len = 0;
+      r->cover_adj_index = 0;
+
+      for (len = r->len; len-- > 0;)
+	{
+	  p = hash_get (by_prefix, IP4_MTRIE_TEST_KEY (
+				     r->addr.as_u32 & im->fib_masks[len], len));
+	  if (p)
+	    {
+	      r->cover_len = len;
+	      r->cover_adj_index = p[0];
+	      break;
+	    }
+	}
+    }
+
+  /* lookups are for addresses that are covered by the table */
+  vec_validate (tm->addrs, tm->n_lookups - 1);
+  for (i = 0; i < tm->n_lookups; i++)
+    {
+      r = vec_elt_at_index (tm->routes, random_u32 (&seed) % tm->n_routes);
+      tm->addrs[i].as_u32 = r->addr.as_u32 | (clib_host_to_net_u32 (
+						random_u32 (&seed)) &
+					      ~im->fib_masks[r->len]);
+    }
+
+  hash_free (by_prefix);
+}
+
+static u32
+ip4_mtrie_test_lookup_8 (ip4_mtrie_8_t *m, const ip4_address_t *a)
+{
+  ip4_mtrie_leaf_t leaf;
+
+  leaf = ip4_mtrie_8_lookup_step_one (m, a);
+  leaf = ip4_mtrie_8_lookup_step (leaf, a, 1);
+  leaf = ip4_mtrie_8_lookup_step (leaf, a, 2);
+  leaf = ip4_mtrie_8_lookup_step (leaf, a, 3);
+
+  return (ip4_mtrie_leaf_get_adj_index (leaf));
+}
+
+static u32
+ip4_mtrie_test_lookup_16 (ip4_mtrie_16_t *m, const ip4_address_t *a)
+{
+  ip4_mtrie_leaf_t leaf;
+
+  leaf = ip4_mtrie_16_lookup_step_one (m, a);
+  leaf = ip4_mtrie_16_lookup_step (leaf, a, 2);
+  leaf = ip4_mtrie_16_lookup_step (leaf, a, 3);
+
+  return (ip4_mtrie_leaf_get_adj_index (leaf));
+}
+
+static u32
+ip4_mtrie_test_lookup_24 (ip4_mtrie_24_t *m, const ip4_address_t *a)
+{
+  ip4_mtrie_leaf_t leaf;
+
+  leaf = ip4_mtrie_24_lookup_step_one (m, a);
+  leaf = ip4_mtrie_24_lookup_step (leaf, a);
+
+  return (ip4_mtrie_leaf_get_adj_index (leaf));
+}
+
+#define foreach_ip4_mtrie_test_stride _ (8) _ (16) _ (24)
+
+#define _(s)                                                                  \
+  static int ip4_mtrie_test_run_##s (vlib_main_t *vm,                         \
+				     ip4_mtrie_test_main_t *tm, u32 *res)     \
+  {                                                                           \
+    ip4_mtrie_##s##_t *m;                                                     \
+    ip4_mtrie_test_route_t *r;                                                \
+    u64 t0, t1, t2;                                                           \
+    uword mem;                                                                \
+    u32 i;                                                                    \
+                                                                              \
+    m = clib_mem_alloc_aligned (sizeof (*m), CLIB_CACHE_LINE_BYTES);          \
+    ip4_mtrie_##s##_init (m);                                                 \
+                                                                              \
+    t0 = clib_cpu_time_now ();                                                \
+    vec_foreach (r, tm->routes)                                               \
+      ip4_mtrie_##s##_route_add (m, &r->addr, r->len, r->adj_index);          \
+    t1 = clib_cpu_time_now ();                                                \
+                                                                              \
+    mem = ip4_mtrie_##s##_memory_usage (m);                                   \
+                                                                              \
+    t2 = clib_cpu_time_now ();                                                \
+    for (i = 0; i < tm->n_lookups; i++)                                       \
+      res[i] = ip4_mtrie_test_lookup_##s (m, &tm->addrs[i]);                  \
+    t2 = clib_cpu_time_now () - t2;                                           \
+                                                                              \
+    vlib_cli_output (vm,                                                      \
+		     "%-8s add %8.2f clocks/route lookup %6.2f clocks/lookup " \
+		     "memory %U",                                             \
+		     #s, (f64) (t1 - t0) / vec_len (tm->routes),              \
+		     (f64) t2 / tm->n_lookups, format_memory_size, mem);      \
+                                                                              \
+    /* routes are sorted longest first, so each cover is still present */    \
+    vec_foreach (r, tm->routes)                                               \
+      ip4_mtrie_##s##_route_del (m, &r->addr, r->len, r->adj_index,           \
+				 r->cover_len, r->cover_adj_index);           \
+                                                                              \
+    ip4_mtrie_##s##_free (m);                                                 \
+    clib_mem_free (m);                                                        \
+    return 0;                                                                 \
+  }
+
+foreach_ip4_mtrie_test_stride
+#undef _
+
+static int
+ip4_mtrie_test_run_24_x8 (vlib_main_t *vm, ip4_mtrie_test_main_t *tm,
+			  u32 *res)
+{
+  ip4_mtrie_test_route_t *r;
+  ip4_mtrie_24_t *m;
+  u64 t;
+  int ok;
+
+  m = clib_mem_alloc_aligned (sizeof (*m), CLIB_CACHE_LINE_BYTES);
+  ip4_mtrie_24_init (m);
+
+  vec_foreach (r, tm->routes)
+    ip4_mtrie_24_route_add (m, &r->addr, r->len, r->adj_index);
+
+  t = clib_cpu_time_now ();
+  ok = CLIB_MARCH_FN_SELECT (ip4_mtrie_test_lookup_24_x8) (
+    m, tm->addrs, res, tm->n_lookups);
+  t = clib_cpu_time_now () - t;
+
+  if (ok)
+    vlib_cli_output (vm, "%-8s lookup %6.2f clocks/lookup", "24 x8",
+		     (f64) t / tm->n_lookups);
+  else
+    vlib_cli_output (vm, "24 x8 skipped, no 256 bit vectors");
+
+  vec_foreach (r, tm->routes)
+    ip4_mtrie_24_route_del (m, &r->addr, r->len, r->adj_index, r->cover_len,
+			    r->cover_adj_index);
+
+  ip4_mtrie_24_free (m);
+  clib_mem_free (m);
+  return ok;
+}
+
+static clib_error_t *
+test_ip4_mtrie_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			   vlib_cli_command_t *cmd)
+{
+  ip4_mtrie_test_main_t *tm = &ip4_mtrie_test_main;
+  clib_error_t *error = 0;
+  u32 i, n_mismatch = 0;
+  int x8;
+
+  tm->n_routes = 100000;
+  tm->n_lookups = 1000000;
+  tm->seed = 0xdeadbeef;
+  tm->verbose = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "routes %u", &tm->n_routes))
+	;
+      else if (unformat (input, "lookups %u", &tm->n_lookups))
+	;
+      else if (unformat (input, "seed %u", &tm->seed))
+	;
+      else if (unformat (input, "verbose"))
+	tm->verbose = 1;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (tm->n_routes == 0 || tm->n_lookups == 0)
+    return clib_error_return (0, "routes and lookups must be non-zero");
+
+  ip4_mtrie_test_gen_routes (tm);
+  vec_sort_with_function (tm->routes, ip4_mtrie_test_route_cmp_len);
+
+  for (i = 0; i < ARRAY_LEN (tm->results); i++)
+    vec_validate (tm->results[i], tm->n_lookups - 1);
+
+  vlib_cli_output (vm, "%u routes, %u lookups", tm->n_routes, tm->n_lookups);
+
+  ip4_mtrie_test_run_8 (vm, tm, tm->results[0]);
+  ip4_mtrie_test_run_16 (vm, tm, tm->results[1]);
+  ip4_mtrie_test_run_24 (vm, tm, tm->results[2]);
+  x8 = ip4_mtrie_test_run_24_x8 (vm, tm, tm->results[3]);
+
+  for (i = 0; i < tm->n_lookups; i++)
+    if (tm->results[0][i] != tm->results[1][i] ||
+	tm->results[0][i] != tm->results[2][i] ||
+	(x8 && tm->results[2][i] != tm->results[3][i]))
+      {
+	if (tm->verbose)
+	  vlib_cli_output (vm, "%U: 8:%d 16:%d 24:%d 24x8:%d",
+			   format_ip4_address, &tm->addrs[i],
+			   tm->results[0][i], tm->results[1][i],
+			   tm->results[2][i], x8 ? tm->results[3][i] : ~0);
+	n_mismatch++;
+      }
+
+  if (n_mismatch)
+    error = clib_error_return (0, "Failed: %u lookup mismatches", n_mismatch);
+  else
+    vlib_cli_output (vm, "all lookups match");
+
+  vec_free (tm->routes);
+  vec_free (tm->addrs);
+  for (i = 0; i < ARRAY_LEN (tm->results); i++)
+    vec_free (tm->results[i]);
+
+  return error;
+}
+
+VLIB_CLI_COMMAND (test_ip4_mtrie_command, static) = {
+  .path = "test ip4 mtrie",
+  .short_help = "test ip4 mtrie [routes <n>] [lookups <n>] [seed <n>] "
+		"[verbose]",
+  .function = test_ip4_mtrie_command_fn,
+};
+#endif
@@ -0,0 +1,324 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vppinfra/random.h>
+#include <vppinfra/bihash_24_8.h>
+#include <vppinfra/bihash_template.h>
+#include <vnet/ip/ip.h>
+#include <vnet/ip/ip6_mtrie.h>
+
+/*
+ * Compare the ip6 mtrie against the per-prefix-length bihash probing
+ * used by the ip6 forwarding table, on a synthetic table whose prefix
+ * length distribution roughly follows an IPv6 BGP full table.
+ * Both must resolve every lookup to the same leaf.
+ */
+
+typedef struct
+{
+  ip6_address_t addr;
+  u8 len;
+  u32 adj_index;
+  u32 cover_len;
+  u32 cover_adj_index;
+} ip6_mtrie_test_route_t;
+
+typedef struct
+{
+  u32 n_routes;
+  u32 n_lookups;
+  u32 seed;
+  int verbose;
+  ip6_mtrie_test_route_t *routes;
+  ip6_address_t *addrs;
+  u32 *results[3];
+} ip6_mtrie_test_main_t;
+
+static ip6_mtrie_test_main_t ip6_mtrie_test_main;
+
+/* percentage of routes with a given prefix length, summing to 100 */
+static const u8 ip6_mtrie_test_len_pct[129] = {
+  [16] = 1, [24] = 1, [28] = 1,	 [29] = 3, [32] = 10, [36] = 2,
+  [40] = 4, [44] = 8, [46] = 2,	 [47] = 2, [48] = 58, [56] = 2,
+  [64] = 4, [96] = 1, [127] = 1,
+};
+
+static u8
+ip6_mtrie_test_random_len (u32 *seed)
+{
+  u32 r = random_u32 (seed) % 100, sum = 0, len;
+
+  for (len = 0; len < ARRAY_LEN (ip6_mtrie_test_len_pct); len++)
+    {
+      sum += ip6_mtrie_test_len_pct[len];
+      if (r < sum)
+	return len;
+    }
+  return 48;
+}
+
+static int
+ip6_mtrie_test_route_cmp_len (void *a1, void *a2)
+{
+  ip6_mtrie_test_route_t *r1 = a1, *r2 = a2;
+
+  return ((int) r2->len - (int) r1->len);
+}
+
+static void
+ip6_mtrie_test_mk_key (clib_bihash_kv_24_8_t *kv, const ip6_address_t *a,
+		       u8 len)
+{
+  const ip6_address_t *mask = &ip6_main.fib_masks[len];
+
+  kv->key[0] = a->as_u64[0] & mask->as_u64[0];
+  kv->key[1] = a->as_u64[1] & mask->as_u64[1];
+  kv->key[2] = len;
+}
+
+static void
+ip6_mtrie_test_random_addr (ip6_address_t *a, u32 *seed)
+{
+  /* keep to global unicast space, as a BGP table would */
+  a->as_u32[0] = clib_host_to_net_u32 (0x20000000 |
+				       (random_u32 (seed) & 0x1fffffff));
+  a->as_u32[1] = random_u32 (seed);
+  a->as_u32[2] = random_u32 (seed);
+  a->as_u32[3] = random_u32 (seed);
+}
+
+static void
+ip6_mtrie_test_gen_routes (ip6_mtrie_test_main_t *tm,
+			   clib_bihash_24_8_t *h)
+{
+  clib_bihash_kv_24_8_t kv, value;
+  ip6_mtrie_test_route_t *r;
+  u32 seed = tm->seed, i, len;
+
+  while (vec_len (tm->routes) < tm->n_routes)
+    {
+      ip6_address_t a;
+      u8 l;
+
+      l = ip6_mtrie_test_random_len (&seed);
+      ip6_mtrie_test_random_addr (&a, &seed);
+      ip6_mtrie_test_mk_key (&kv, &a, l);
+
+      if (0 == clib_bihash_search_24_8 (h, &kv, &value))
+	continue;
+
+      vec_add2 (tm->routes, r, 1);
+      r->addr.as_u64[0] = kv.key[0];
+      r->addr.as_u64[1] = kv.key[1];
+      r->len = l;
+      /* leave index 0 for the empty leaf */
+      r->adj_index = vec_len (tm->routes);
+      kv.value = r->adj_index;
+      clib_bihash_add_del_24_8 (h, &kv, 1);
+    }
+
+  /* the cover is needed to remove a route from the trie */
+  vec_foreach (r, tm->routes)
+    {
+      r->cover_len = 0;
+      r->cover_adj_index = 0;
+
+      for (len = r->len; len-- > 0;)
+	{
+	  ip6_mtrie_test_mk_key (&kv, &r->addr, len);
+	  if (0 == clib_bihash_search_24_8 (h, &kv, &value))
+	    {
+	      r->cover_len = len;
+	      r->cover_adj_index = value.value;
+	      break;
+	    }
+	}
+    }
+
+  /* lookups are for addresses that are covered by the table */
+  vec_validate (tm->addrs, tm->n_lookups - 1);
+  for (i = 0; i < tm->n_lookups; i++)
+    {
+      const ip6_address_t *mask;
+      ip6_address_t rnd;
+
+      r = vec_elt_at_index (tm->routes, random_u32 (&seed) % tm->n_routes);
+      mask = &ip6_main.fib_masks[r->len];
+      ip6_mtrie_test_random_addr (&rnd, &seed);
+
+      tm->addrs[i].as_u64[0] =
+	r->addr.as_u64[0] | (rnd.as_u64[0] & ~mask->as_u64[0]);
+      tm->addrs[i].as_u64[1] =
+	r->addr.as_u64[1] | (rnd.as_u64[1] & ~mask->as_u64[1]);
+    }
+}
+
+static u32
+ip6_mtrie_test_hash_lookup (clib_bihash_24_8_t *h, const u8 *lens,
+			    const ip6_address_t *a)
+{
+  clib_bihash_kv_24_8_t kv, value;
+  int i;
+
+  for (i = 0; i < vec_len (lens); i++)
+    {
+      ip6_mtrie_test_mk_key (&kv, a, lens[i]);
+      if (0 == clib_bihash_search_inline_2_24_8 (h, &kv, &value))
+	return value.value;
+    }
+  return 0;
+}
+
+static clib_error_t *
+test_ip6_mtrie_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			   vlib_cli_command_t *cmd)
+{
+  ip6_mtrie_test_main_t *tm = &ip6_mtrie_test_main;
+  const ip6_address_t **dsts = 0;
+  const ip6_mtrie_t **mtries = 0;
+  ip6_mtrie_test_route_t *r;
+  clib_bihash_24_8_t h;
+  clib_error_t *error = 0;
+  u32 i, n_mismatch = 0, n_plies = 0;
+  u8 *lens = 0;
+  ip6_mtrie_t *m;
+  u64 t0, t1, t2;
+  uword mem;
+  int len;
+
+  tm->n_routes = 100000;
+  tm->n_lookups = 1000000;
+  tm->seed = 0xdeadbeef;
+  tm->verbose = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "routes %u", &tm->n_routes))
+	;
+      else if (unformat (input, "lookups %u", &tm->n_lookups))
+	;
+      else if (unformat (input, "seed %u", &tm->seed))
+	;
+      else if (unformat (input, "verbose"))
+	tm->verbose = 1;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (tm->n_routes == 0 || tm->n_lookups == 0)
+    return clib_error_return (0, "routes and lookups must be non-zero");
+
+  clib_bihash_init_24_8 (&h, "ip6 mtrie test", max_pow2 (tm->n_routes),
+			 (uword) tm->n_routes << 8);
+
+  ip6_mtrie_test_gen_routes (tm, &h);
+  vec_sort_with_function (tm->routes, ip6_mtrie_test_route_cmp_len);
+
+  for (i = 0; i < ARRAY_LEN (tm->results); i++)
+    vec_validate (tm->results[i], tm->n_lookups - 1);
+
+  vlib_cli_output (vm, "%u routes, %u lookups", tm->n_routes, tm->n_lookups);
+
+  /* the hash is searched once per non-empty length, longest first */
+  for (len = 128; len >= 0; len--)
+    if (ip6_mtrie_test_len_pct[len])
+      vec_add1 (lens, len);
+
+  t0 = clib_cpu_time_now ();
+  for (i = 0; i < tm->n_lookups; i++)
+    tm->results[0][i] = ip6_mtrie_test_hash_lookup (&h, lens, &tm->addrs[i]);
+  t0 = clib_cpu_time_now () - t0;
+
+  vlib_cli_output (vm, "%-8s lookup %6.2f clocks/lookup (%d lengths)",
+		   "hash", (f64) t0 / tm->n_lookups, vec_len (lens));
+
+  m = clib_mem_alloc_aligned (sizeof (*m), CLIB_CACHE_LINE_BYTES);
+  ip6_mtrie_init (m);
+
+  t0 = clib_cpu_time_now ();
+  vec_foreach (r, tm->routes)
+    ip6_mtrie_route_add (m, &r->addr, r->len, r->adj_index);
+  t1 = clib_cpu_time_now ();
+
+  mem = ip6_mtrie_memory_usage (m);
+
+  t2 = clib_cpu_time_now ();
+  for (i = 0; i < tm->n_lookups; i++)
+    tm->results[1][i] = ip6_mtrie_lookup (m, &tm->addrs[i]);
+  t2 = clib_cpu_time_now () - t2;
+
+  vlib_cli_output (vm,
+		   "%-8s add %8.2f clocks/route lookup %6.2f clocks/lookup "
+		   "memory %U",
+		   "mtrie", (f64) (t1 - t0) / vec_len (tm->routes),
+		   (f64) t2 / tm->n_lookups, format_memory_size, mem);
+
+  vec_validate (dsts, tm->n_lookups - 1);
+  vec_validate (mtries, tm->n_lookups - 1);
+  for (i = 0; i < tm->n_lookups; i++)
+    {
+      dsts[i] = &tm->addrs[i];
+      mtries[i] = m;
+    }
+
+  t2 = clib_cpu_time_now ();
+  for (i = 0; i < tm->n_lookups; i += VLIB_FRAME_SIZE)
+    ip6_mtrie_lookup_batch (mtries + i, dsts + i, tm->results[2] + i,
+			    clib_min (VLIB_FRAME_SIZE, tm->n_lookups - i));
+  t2 = clib_cpu_time_now () - t2;
+
+  vlib_cli_output (vm, "%-8s lookup %6.2f clocks/lookup", "batch",
+		   (f64) t2 / tm->n_lookups);
+
+  for (i = 0; i < tm->n_lookups; i++)
+    if (tm->results[0][i] != tm->results[1][i] ||
+	tm->results[0][i] != tm->results[2][i])
+      {
+	if (tm->verbose)
+	  vlib_cli_output (vm, "%U: hash:%d mtrie:%d batch:%d",
+			   format_ip6_address, &tm->addrs[i],
+			   tm->results[0][i], tm->results[1][i],
+			   tm->results[2][i]);
+	n_mismatch++;
+      }
+
+  /* routes are sorted longest first, so each cover is still present */
+  vec_foreach (r, tm->routes)
+    ip6_mtrie_route_del (m, &r->addr, r->len, r->adj_index, r->cover_len,
+			 r->cover_adj_index);
+
+  /* with all routes gone every PLY must have been returned */
+  for (i = 0; i < ARRAY_LEN (m->root_ply.leaves); i++)
+    if (!ip6_mtrie_leaf_is_terminal (m->root_ply.leaves[i]))
+      n_plies++;
+
+  if (n_mismatch)
+    error = clib_error_return (0, "Failed: %u lookup mismatches", n_mismatch);
+  else if (n_plies)
+    error = clib_error_return (0, "Failed: %u plies remain", n_plies);
+  else
+    vlib_cli_output (vm, "all lookups match");
+
+  ip6_mtrie_free (m);
+  clib_mem_free (m);
+  clib_bihash_free_24_8 (&h);
+  vec_free (lens);
+  vec_free (dsts);
+  vec_free (mtries);
+  vec_free (tm->routes);
+  vec_free (tm->addrs);
+  for (i = 0; i < ARRAY_LEN (tm->results); i++)
+    vec_free (tm->results[i]);
+
+  return error;
+}
+
+VLIB_CLI_COMMAND (test_ip6_mtrie_command, static) = {
+  .path = "test ip6 mtrie",
+  .short_help = "test ip6 mtrie [routes <n>] [lookups <n>] [seed <n>] "
+		"[verbose]",
+  .function = test_ip6_mtrie_command_fn,
+};
@@ -0,0 +1,293 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/ip/ip.h>
+#include <vnet/ip/ip.api_enum.h>
+#include <vnet/ip/reass/ip4_full_reass.h>
+#include <vnet/ip/reass/ip6_full_reass.h>
+#include <vppinfra/random.h>
+
+/*
+ * Full reassembly benchmark. Datagrams are cut into 2 to 64 fragments,
+ * which are handed to the custom reassembly node a frame at a time, in
+ * order, in reverse order or shuffled, and the node's clocks per fragment
+ * are reported. Every datagram must come out reassembled; what comes out
+ * goes to error-drop.
+ */
+
+/* fragments built and in flight at a time */
+#define IP_REASS_TEST_MAX_FRAGMENTS 4096
+
+typedef enum
+{
+  IP_REASS_TEST_IN_ORDER,
+  IP_REASS_TEST_REVERSE,
+  IP_REASS_TEST_RANDOM,
+  IP_REASS_TEST_N_ORDERS,
+} ip_reass_test_order_t;
+
+static char *ip_reass_test_order_names[] = {
+  [IP_REASS_TEST_IN_ORDER] = "in order",
+  [IP_REASS_TEST_REVERSE] = "reverse",
+  [IP_REASS_TEST_RANDOM] = "random",
+};
+
+typedef struct
+{
+  vlib_main_t *vm;
+  int is_ip6;
+  u32 node_index;
+  u32 next_index;
+  u32 seed;
+  u16 fragment_id;
+} ip_reass_test_t;
+
+static void
+ip_reass_test_build (ip_reass_test_t *t, vlib_buffer_t *b, u16 id,
+		     u32 fragment, u32 n_fragments, u32 fragment_len)
+{
+  u32 offset = fragment * fragment_len;
+  int more = fragment < n_fragments - 1;
+  u32 len;
+
+  if (t->is_ip6)
+    {
+      ip6_header_t *ip = vlib_buffer_get_current (b);
+      ip6_frag_hdr_t *frag = (ip6_frag_hdr_t *) (ip + 1);
+
+      len = sizeof (*ip) + sizeof (*frag) + fragment_len;
+      clib_memset (ip, 0, sizeof (*ip) + sizeof (*frag));
+      ip->ip_version_traffic_class_and_flow_label =
+	clib_host_to_net_u32 (0x6 << 28);
+      ip->payload_length = clib_host_to_net_u16 (len - sizeof (*ip));
+      ip->protocol = IP_PROTOCOL_IPV6_FRAGMENTATION;
+      ip->hop_limit = 64;
+      ip->src_address.as_u64[0] = clib_host_to_net_u64 (0x20010db800000000);
+      ip->src_address.as_u64[1] = clib_host_to_net_u64 (1);
+      ip->dst_address.as_u64[0] = clib_host_to_net_u64 (0x20010db800000000);
+      ip->dst_address.as_u64[1] = clib_host_to_net_u64 (2);
+      frag->next_hdr = IP_PROTOCOL_UDP;
+      frag->fragment_offset_and_more =
+	ip6_frag_hdr_offset_and_more (offset / 8, more);
+      frag->identification = clib_host_to_net_u32 (id);
+    }
+  else
+    {
+      ip4_header_t *ip = vlib_buffer_get_current (b);
+
+      len = sizeof (*ip) + fragment_len;
+      clib_memset (ip, 0, sizeof (*ip));
+      ip->ip_version_and_header_length = 0x45;
+      ip->length = clib_host_to_net_u16 (len);
+      ip->fragment_id = clib_host_to_net_u16 (id);
+      ip->flags_and_fragment_offset = clib_host_to_net_u16 (
+	(offset / 8) | (more ? IP4_HEADER_FLAG_MORE_FRAGMENTS : 0));
+      ip->ttl = 64;
+      ip->protocol = IP_PROTOCOL_UDP;
+      ip->src_address.as_u32 = clib_host_to_net_u32 (0x0a000001);
+      ip->dst_address.as_u32 = clib_host_to_net_u32 (0x0a000002);
+      ip->checksum = ip4_header_checksum (ip);
+    }
+
+  b->current_length = len;
+  b->flags &= ~VLIB_BUFFER_NEXT_PRESENT;
+  vnet_buffer (b)->sw_if_index[VLIB_RX] = 0;
+  vnet_buffer (b)->sw_if_index[VLIB_TX] = 0;
+  vnet_buffer (b)->ip.reass.next_index = t->next_index;
+  vnet_buffer (b)->ip.reass.error_next_index = t->next_index;
+}
+
+static u64
+ip_reass_test_counter (ip_reass_test_t *t, u32 code)
+{
+  vlib_node_t *n = vlib_get_node (t->vm, t->node_index);
+  return t->vm->error_main.counters[n->error_heap_index + code];
+}
+
+/* Reassemble n_datagrams of n_fragments each, n_done of which come out
+ * reassembled after n_clocks in the node. */
+static clib_error_t *
+ip_reass_test_run (ip_reass_test_t *t, u32 n_datagrams, u32 n_fragments,
+		   ip_reass_test_order_t order, u64 *n_clocks, u64 *n_done)
+{
+  vlib_main_t *vm = t->vm;
+  vlib_node_runtime_t *rt = vlib_node_get_runtime (vm, t->node_index);
+  u32 fragment_len = clib_min (1440, 65000 / n_fragments) & ~7;
+  u32 per_round = clib_max (IP_REASS_TEST_MAX_FRAGMENTS / n_fragments, 1);
+  u32 success = t->is_ip6 ? IP6_ERROR_REASS_SUCCESS : IP4_ERROR_REASS_SUCCESS;
+  u32 *buffers = 0, *frags = 0, i, j, k, n, n_alloc, tmp;
+  u64 before = ip_reass_test_counter (t, success), start;
+  clib_error_t *err = 0;
+  vlib_frame_t *f;
+
+  *n_clocks = 0;
+  vec_validate (frags, n_fragments - 1);
+
+  while (n_datagrams)
+    {
+      n = clib_min (n_datagrams, per_round);
+      vec_validate (buffers, n * n_fragments - 1);
+      n_alloc = vlib_buffer_alloc (vm, buffers, n * n_fragments);
+      if (n_alloc != n * n_fragments)
+	{
+	  vlib_buffer_free (vm, buffers, n_alloc);
+	  err = clib_error_return (0, "buffer allocation failed");
+	  goto done;
+	}
+
+      /* the fragments of each datagram follow each other, in the order
+       * they are sent in */
+      for (i = 0; i < n; i++)
+	{
+	  for (j = 0; j < n_fragments; j++)
+	    frags[j] = order == IP_REASS_TEST_REVERSE ? n_fragments - 1 - j : j;
+	  if (order == IP_REASS_TEST_RANDOM)
+	    for (j = n_fragments - 1; j > 0; j--)
+	      {
+		k = random_u32 (&t->seed) % (j + 1);
+		tmp = frags[j];
+		frags[j] = frags[k];
+		frags[k] = tmp;
+	      }
+	  for (j = 0; j < n_fragments; j++)
+	    ip_reass_test_build (
+	      t, vlib_get_buffer (vm, buffers[i * n_fragments + j]),
+	      t->fragment_id, frags[j], n_fragments, fragment_len);
+	  t->fragment_id++;
+	}
+
+      for (i = 0; i < n * n_fragments; i += VLIB_FRAME_SIZE)
+	{
+	  f = vlib_get_frame_to_node (vm, t->node_index);
+	  f->n_vectors = clib_min (VLIB_FRAME_SIZE, n * n_fragments - i);
+	  vlib_buffer_copy_indices (vlib_frame_vector_args (f), buffers + i,
+				    f->n_vectors);
+	  start = clib_cpu_time_now ();
+	  rt->function (vm, rt, f);
+	  *n_clocks += clib_cpu_time_now () - start;
+	  vlib_frame_free (vm, f);
+	}
+
+      /* let error-drop free what came out */
+      vlib_process_suspend (vm, 1e-3);
+      n_datagrams -= n;
+    }
+
+done:
+  *n_done = ip_reass_test_counter (t, success) - before;
+  vec_free (buffers);
+  vec_free (frags);
+  return err;
+}
+
+static clib_error_t *
+test_ip_full_reass_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			       vlib_cli_command_t *cmd)
+{
+  ip_reass_test_t _t = { .vm = vm }, *t = &_t;
+  u32 n_datagrams = 10000, min_fragments = 2, max_fragments = 64;
+  u32 timeout_ms, max_reass, max_reass_len, expire_walk_ms;
+  u32 order, first_order = 0, last_order = IP_REASS_TEST_N_ORDERS - 1;
+  u32 n_fragments;
+  u64 n_clocks, n_done;
+  clib_error_t *err = 0;
+  vlib_node_t *n;
+
+  t->seed = random_default_seed ();
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "ip6"))
+	t->is_ip6 = 1;
+      else if (unformat (input, "ip4"))
+	t->is_ip6 = 0;
+      else if (unformat (input, "datagrams %u", &n_datagrams))
+	;
+      else if (unformat (input, "fragments %u", &min_fragments))
+	max_fragments = min_fragments;
+      else if (unformat (input, "min-fragments %u", &min_fragments))
+	;
+      else if (unformat (input, "max-fragments %u", &max_fragments))
+	;
+      else if (unformat (input, "in-order"))
+	first_order = last_order = IP_REASS_TEST_IN_ORDER;
+      else if (unformat (input, "reverse"))
+	first_order = last_order = IP_REASS_TEST_REVERSE;
+      else if (unformat (input, "random"))
+	first_order = last_order = IP_REASS_TEST_RANDOM;
+      else if (unformat (input, "seed %u", &t->seed))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (min_fragments < 2 || max_fragments > 64 || min_fragments > max_fragments)
+    return clib_error_return (0, "fragments must be within 2 to 64");
+
+  n = vlib_get_node_by_name (vm, t->is_ip6 ?
+				   (u8 *) "ip6-full-reassembly-custom" :
+				   (u8 *) "ip4-full-reassembly-custom");
+  t->node_index = n->index;
+  t->next_index = vlib_node_add_named_next (vm, n->index, "error-drop");
+
+  /* room for the longest datagrams, and for all in flight at once */
+  if (t->is_ip6)
+    {
+      ip6_full_reass_get (&timeout_ms, &max_reass, &max_reass_len,
+			  &expire_walk_ms);
+      ip6_full_reass_set (timeout_ms, IP_REASS_TEST_MAX_FRAGMENTS / 2,
+			  max_fragments, expire_walk_ms);
+    }
+  else
+    {
+      ip4_full_reass_get (&timeout_ms, &max_reass, &max_reass_len,
+			  &expire_walk_ms);
+      ip4_full_reass_set (timeout_ms, IP_REASS_TEST_MAX_FRAGMENTS / 2,
+			  max_fragments, expire_walk_ms);
+    }
+
+  vlib_cli_output (vm, "%-10s%-10s%12s%16s", "fragments", "order",
+		   "datagrams", "clocks/fragment");
+
+  for (n_fragments = min_fragments; n_fragments <= max_fragments;
+       n_fragments = n_fragments < max_fragments ?
+		       clib_min (2 * n_fragments, max_fragments) :
+		       n_fragments + 1)
+    for (order = first_order; order <= last_order; order++)
+      {
+	err = ip_reass_test_run (t, n_datagrams, n_fragments, order,
+				 &n_clocks, &n_done);
+	if (err)
+	  goto done;
+	vlib_cli_output (vm, "%-10u%-10s%12lu%16.1f", n_fragments,
+			 ip_reass_test_order_names[order], n_done,
+			 (f64) n_clocks / (n_datagrams * n_fragments));
+	if (n_done != n_datagrams)
+	  {
+	    err = clib_error_return (
+	      0, "failed: %lu of %u datagrams of %u fragments reassembled",
+	      n_done, n_datagrams, n_fragments);
+	    goto done;
+	  }
+      }
+
+done:
+  if (t->is_ip6)
+    ip6_full_reass_set (timeout_ms, max_reass, max_reass_len,
+			expire_walk_ms);
+  else
+    ip4_full_reass_set (timeout_ms, max_reass, max_reass_len,
+			expire_walk_ms);
+  return err;
+}
+
+VLIB_CLI_COMMAND (test_ip_full_reass_command, static) = {
+  .path = "test ip full-reassembly",
+  .short_help = "test ip full-reassembly [ip4|ip6] [datagrams <n>] "
+		"[fragments <n>] [min-fragments <n>] [max-fragments <n>] "
+		"[in-order|reverse|random] [seed <n>]",
+  .function = test_ip_full_reass_command_fn,
+};
@@ -15,6 +15,7 @@
 
 #include <vlib/vlib.h>
 #include <vlib/buffer_funcs.h>
+#include <pthread.h>
 
 #define TEST_I(_cond, _comment, _args...)                                     \
   ({                                                                          \
@@ -316,6 +317,157 @@ VLIB_CLI_COMMAND (test_linearize_speed_command, static) = {
   .function = test_linearize_speed_fn,
 };
 
+typedef struct
+{
+  vlib_buffer_pool_t *bp;
+  vlib_buffer_pool_thread_t *bpt;
+  u32 n_rounds;
+  u64 n_clocks;
+} magazine_test_thread_t;
+
+static void *
+magazine_test_thread_fn (void *arg)
+{
+  magazine_test_thread_t *t = arg;
+  vlib_buffer_pool_thread_t *bpt = t->bpt;
+  u64 start = clib_cpu_time_now ();
+  u32 i;
+
+  /* give away the oldest magazine and take whichever comes next */
+  for (i = 0; i < t->n_rounds; i++)
+    {
+      if (!vlib_buffer_pool_put_magazine (t->bp, bpt))
+	break;
+      while (0 == vlib_buffer_pool_get_magazines (
+		    t->bp, bpt, bpt->cached_buffers + bpt->n_cached,
+		    VLIB_BUFFER_MAGAZINE_SZ))
+	CLIB_PAUSE ();
+      bpt->n_cached += VLIB_BUFFER_MAGAZINE_SZ;
+    }
+
+  t->n_clocks = clib_cpu_time_now () - start;
+  return 0;
+}
+
+static int
+magazine_test_u32_cmp (void *a1, void *a2)
+{
+  u32 *v1 = a1, *v2 = a2;
+
+  return (*v1 > *v2) - (*v1 < *v2);
+}
+
+static clib_error_t *
+test_buffer_magazines_fn (vlib_main_t *vm, unformat_input_t *input,
+			  vlib_cli_command_t *cmd)
+{
+  u8 bpi = vlib_buffer_pool_get_default_for_numa (vm, vm->numa_node);
+  vlib_buffer_pool_t *bp = vlib_get_buffer_pool (vm, bpi);
+  magazine_test_thread_t *threads = 0, *t;
+  pthread_t *handles = 0, handle;
+  u32 n_threads = 4, n_rounds = 100000, n_buffers, n_alloc, i;
+  u32 *buffers = 0, *returned = 0;
+  clib_error_t *err = 0;
+  u64 n_clocks = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "threads %u", &n_threads))
+	;
+      else if (unformat (input, "rounds %u", &n_rounds))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (n_threads == 0)
+    return clib_error_return (0, "threads must be non-zero");
+
+  /* each thread starts with a full cache */
+  n_buffers = n_threads * VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ;
+  vec_validate (buffers, n_buffers - 1);
+  n_alloc = vlib_buffer_alloc_from_pool (vm, buffers, n_buffers, bpi);
+  if (n_alloc != n_buffers)
+    {
+      vlib_buffer_free_no_next (vm, buffers, n_alloc);
+      vec_free (buffers);
+      return clib_error_return (0, "allocated %u of %u buffers", n_alloc,
+				n_buffers);
+    }
+
+  vec_validate (threads, n_threads - 1);
+  vec_foreach (t, threads)
+    {
+      t->bp = bp;
+      t->bpt = clib_mem_alloc_aligned (sizeof (t->bpt[0]),
+				       CLIB_CACHE_LINE_BYTES);
+      clib_memset (t->bpt, 0, sizeof (t->bpt[0]));
+      t->n_rounds = n_rounds;
+      i = t - threads;
+      vlib_buffer_copy_indices (
+	t->bpt->cached_buffers,
+	buffers + i * VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ,
+	VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ);
+      t->bpt->n_cached = VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ;
+    }
+
+  vec_foreach (t, threads)
+    {
+      if (pthread_create (&handle, NULL, magazine_test_thread_fn, t))
+	{
+	  err = clib_error_return_unix (0, "pthread_create");
+	  break;
+	}
+      vec_add1 (handles, handle);
+    }
+
+  for (i = 0; i < vec_len (handles); i++)
+    pthread_join (handles[i], NULL);
+
+  /* every buffer must come back exactly once */
+  vec_foreach (t, threads)
+    {
+      vec_add (returned, t->bpt->cached_buffers, t->bpt->n_cached);
+      n_clocks += t->n_clocks;
+      if (TEST_I (t->bpt->n_magazine_puts == t->n_rounds &&
+		    t->bpt->n_magazine_gets == t->n_rounds,
+		  "thread %u exchanged %llu/%llu magazines", t - threads,
+		  t->bpt->n_magazine_puts, t->bpt->n_magazine_gets))
+	err = clib_error_return (0, "magazines lost");
+      clib_mem_free (t->bpt);
+    }
+
+  vec_sort_with_function (buffers, magazine_test_u32_cmp);
+  vec_sort_with_function (returned, magazine_test_u32_cmp);
+  if (TEST_I (vec_len (returned) == n_buffers &&
+		0 == memcmp (returned, buffers, n_buffers * sizeof (u32)),
+	      "%u of %u buffers returned", vec_len (returned), n_buffers))
+    err = clib_error_return (0, "buffers lost or duplicated");
+  else
+    vlib_cli_output (vm, "%u threads: %.2f clocks/magazine exchange",
+		     n_threads, (f64) n_clocks / (n_threads * n_rounds));
+
+  if (TEST_I (vlib_buffer_magazine_ring_count (&bp->full_magazines) == 0 &&
+		vlib_buffer_magazine_ring_count (&bp->empty_magazines) ==
+		  bp->n_magazines,
+	      "all magazines empty"))
+    err = clib_error_return (0, "magazines lost");
+
+  vlib_buffer_free_no_next (vm, buffers, n_buffers);
+  vec_free (buffers);
+  vec_free (returned);
+  vec_free (threads);
+  vec_free (handles);
+  return err;
+}
+
+VLIB_CLI_COMMAND (test_buffer_magazines_command, static) = {
+  .path = "test buffer magazines",
+  .short_help = "test buffer magazines [threads <n>] [rounds <n>]",
+  .function = test_buffer_magazines_fn,
+};
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
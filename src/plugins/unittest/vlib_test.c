@@ -218,6 +218,252 @@ VLIB_CLI_COMMAND (test_vlib2_command, static) =
   .function = test_vlib2_command_fn,
 };
 
+typedef struct
+{
+  u32 peer;
+  u32 round;
+  u32 n_rounds;
+  u32 *n_errors;
+  uword data;
+} test_task_t;
+
+/* sleeps, then signals its peer and waits for the value to come back */
+static uword
+test_task_ping_fn (vlib_main_t *vm, vlib_task_t *t)
+{
+  test_task_t *tt = t->data;
+  uword data;
+
+  VLIB_TASK_BEGIN (t);
+  for (tt->round = 1; tt->round <= tt->n_rounds; tt->round++)
+    {
+      VLIB_TASK_SLEEP (vm, t, 1e-4);
+      vlib_task_signal (vm, tt->peer, tt->round);
+      VLIB_TASK_WAIT (vm, t, 5.0);
+      if (!vlib_task_get_signal (t, &data) || data != tt->round)
+	tt->n_errors[0]++;
+    }
+  VLIB_TASK_END (t);
+}
+
+static uword
+test_task_pong_fn (vlib_main_t *vm, vlib_task_t *t)
+{
+  test_task_t *tt = t->data;
+
+  /* locals don't survive a suspension, tt->data does */
+  VLIB_TASK_BEGIN (t);
+  for (tt->round = 1; tt->round <= tt->n_rounds; tt->round++)
+    {
+      VLIB_TASK_WAIT (vm, t, 0);
+      if (!vlib_task_get_signal (t, &tt->data))
+	tt->n_errors[0]++;
+      VLIB_TASK_YIELD (vm, t);
+      vlib_task_signal (vm, tt->peer, tt->data);
+    }
+  VLIB_TASK_END (t);
+}
+
+static clib_error_t *
+test_vlib_task_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			   vlib_cli_command_t *cmd)
+{
+  vlib_task_main_t *tm = &vm->task_main;
+  test_task_t *tasks = 0, *ping, *pong;
+  u32 n_pairs = 1000, n_rounds = 3, n_errors = 0, killed;
+  u64 n_done;
+  f64 t0, deadline;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "pairs %u", &n_pairs))
+	;
+      else if (unformat (input, "rounds %u", &n_rounds))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  vec_validate (tasks, 2 * n_pairs - 1);
+  n_done = tm->n_done;
+
+  for (int i = 0; i < n_pairs; i++)
+    {
+      ping = tasks + 2 * i;
+      pong = ping + 1;
+      ping->n_rounds = pong->n_rounds = n_rounds;
+      ping->n_errors = pong->n_errors = &n_errors;
+      pong->peer = vlib_task_create (vm, test_task_ping_fn, ping);
+      ping->peer = vlib_task_create (vm, test_task_pong_fn, pong);
+    }
+
+  /* a task killed before it runs never runs */
+  killed = vlib_task_create (vm, test_task_ping_fn, tasks);
+  vlib_task_kill (vm, killed);
+
+  t0 = vlib_time_now (vm);
+  deadline = t0 + 10.0;
+  while (tm->n_done - n_done < 2 * n_pairs && vlib_time_now (vm) < deadline)
+    vlib_process_suspend (vm, 1e-3);
+
+  vlib_cli_output (vm, "%u task pairs, %u rounds: %lu done, %u errors in "
+		   "%.3fs", n_pairs, n_rounds, tm->n_done - n_done, n_errors,
+		   vlib_time_now (vm) - t0);
+  vec_free (tasks);
+
+  if (tm->n_done - n_done != 2 * n_pairs || n_errors)
+    return clib_error_return (0, "FAIL");
+
+  vlib_cli_output (vm, "PASS");
+  return 0;
+}
+
+VLIB_CLI_COMMAND (test_vlib_task_command, static) = {
+  .path = "test vlib task",
+  .short_help = "test vlib task [pairs <n>] [rounds <n>]",
+  .function = test_vlib_task_command_fn,
+};
+
+/*
+ * An input node which, interrupted on a worker, spins there until it is
+ * released, so the worker does not get back to the top of its main loop
+ * and hold up RCU callbacks meanwhile.
+ */
+static volatile u32 test_rcu_stalled, test_rcu_released;
+
+static uword
+test_rcu_stall_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
+		   vlib_frame_t *frame)
+{
+  f64 deadline = vlib_time_now (vm) + 5.0;
+
+  __atomic_store_n (&test_rcu_stalled, 1, __ATOMIC_RELEASE);
+  while (!__atomic_load_n (&test_rcu_released, __ATOMIC_ACQUIRE) &&
+	 vlib_time_now (vm) < deadline)
+    CLIB_PAUSE ();
+  __atomic_store_n (&test_rcu_stalled, 0, __ATOMIC_RELEASE);
+  return 0;
+}
+
+VLIB_REGISTER_NODE (test_rcu_stall_node, static) = {
+  .function = test_rcu_stall_fn,
+  .name = "test-rcu-stall",
+  .type = VLIB_NODE_TYPE_INPUT,
+  .state = VLIB_NODE_STATE_DISABLED,
+};
+
+static void
+test_rcu_cb (void *args)
+{
+  u32 *n_done = *(u32 **) args;
+  n_done[0]++;
+}
+
+/* wait for up to timeout for *v to be set, or unset */
+static int
+test_rcu_wait (vlib_main_t *vm, volatile u32 *v, u32 want, f64 timeout)
+{
+  f64 deadline = vlib_time_now (vm) + timeout;
+
+  while (__atomic_load_n (v, __ATOMIC_ACQUIRE) != want)
+    {
+      if (vlib_time_now (vm) > deadline)
+	return 0;
+      vlib_process_suspend (vm, 1e-4);
+    }
+  return 1;
+}
+
+static clib_error_t *
+test_vlib_rcu_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			  vlib_cli_command_t *cmd)
+{
+  static volatile u32 n_done;
+  u32 *n_done_p = (u32 *) &n_done, n_polls = 0;
+  clib_error_t *err = 0;
+  vlib_main_t *wvm;
+  f64 hold = 0.1, deadline;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "hold %f", &hold))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (vlib_get_n_threads () < 2)
+    return clib_error_return (0, "needs a worker");
+
+  wvm = vlib_get_main_by_index (1);
+  n_done = 0;
+  test_rcu_released = 0;
+
+  vlib_worker_thread_barrier_sync (vm);
+  vlib_node_set_state (wvm, test_rcu_stall_node.index,
+		       VLIB_NODE_STATE_INTERRUPT);
+  vlib_worker_thread_barrier_release (vm);
+  vlib_node_set_interrupt_pending (wvm, test_rcu_stall_node.index);
+
+  if (!test_rcu_wait (vm, &test_rcu_stalled, 1, 1.0))
+    {
+      err = clib_error_return (0, "FAIL: worker did not stall");
+      goto done;
+    }
+
+  /* the worker is stuck before its quiescent point, the callback must
+   * wait for it, however often the main loop polls */
+  vlib_rcu_call (test_rcu_cb, &n_done_p, sizeof (n_done_p));
+  deadline = vlib_time_now (vm) + hold;
+  while (vlib_time_now (vm) < deadline)
+    {
+      vlib_rcu_poll (vm);
+      n_polls++;
+      if (n_done)
+	{
+	  err = clib_error_return (0, "FAIL: callback ran during the stall, "
+				   "after %u polls", n_polls);
+	  goto done;
+	}
+      vlib_process_suspend (vm, 1e-4);
+    }
+
+  /* once it is back at the top of its loop, the callback runs */
+  test_rcu_released = 1;
+  if (!test_rcu_wait (vm, &test_rcu_stalled, 0, 1.0))
+    {
+      err = clib_error_return (0, "FAIL: worker did not resume");
+      goto done;
+    }
+  if (!test_rcu_wait (vm, &n_done, 1, 1.0))
+    {
+      err = clib_error_return (0, "FAIL: callback did not run");
+      goto done;
+    }
+
+  vlib_cli_output (vm, "callback held for %.3fs over %u polls, PASS", hold,
+		   n_polls);
+
+done:
+  test_rcu_released = 1;
+  test_rcu_wait (vm, &test_rcu_stalled, 0, 6.0);
+  vlib_worker_thread_barrier_sync (vm);
+  vlib_node_set_state (wvm, test_rcu_stall_node.index,
+		       VLIB_NODE_STATE_DISABLED);
+  vlib_worker_thread_barrier_release (vm);
+  return err;
+}
+
+/* mp-safe, or the barrier would hold the worker and run callbacks at once */
+VLIB_CLI_COMMAND (test_vlib_rcu_command, static) = {
+  .path = "test vlib rcu",
+  .short_help = "test vlib rcu [hold <seconds>]",
+  .function = test_vlib_rcu_command_fn,
+  .is_mp_safe = 1,
+};
+
 
 
 
@@ -50,7 +50,7 @@ elog_merge_main (unformat_input_t * input)
   clib_error_t *error = 0;
   elog_main_t _em, *em = &_em;
   u32 verbose;
-  char *dump_file, *merge_file, **merge_files;
+  char *dump_file, *chrome_file, *merge_file, **merge_files;
   u8 *tag, **tags;
   f64 align_tweak;
   f64 *align_tweaks;
@@ -59,6 +59,7 @@ elog_merge_main (unformat_input_t * input)
 
   verbose = 0;
   dump_file = 0;
+  chrome_file = 0;
   merge_files = 0;
   tags = 0;
   align_tweaks = 0;
@@ -67,6 +68,8 @@ elog_merge_main (unformat_input_t * input)
     {
       if (unformat (input, "dump %s", &dump_file))
 	;
+      else if (unformat (input, "chrome %s", &chrome_file))
+	;
       else if (unformat (input, "tag %s", &tag))
 	vec_add1 (tags, tag);
       else if (unformat (input, "merge %s", &merge_file))
@@ -114,6 +117,13 @@ elog_merge_main (unformat_input_t * input)
 	goto done;
     }
 
+  if (chrome_file)
+    {
+      if ((error = elog_write_chrome_trace (em, chrome_file,
+					    0 /* do not flush ring */)))
+	goto done;
+    }
+
   if (verbose)
     {
       elog_event_t *e, *es;
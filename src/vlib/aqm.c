@@ -0,0 +1,289 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vlib/aqm.h>
+#include <vlib/stats/stats.h>
+
+vlib_aqm_main_t vlib_aqm_main = {
+  .sojourn = {
+    .name = "aqm-sojourn",
+    .stat_segment_name = "/aqm/sojourn",
+  },
+  .drops = {
+    .name = "aqm-drops",
+    .stat_segment_name = "/aqm/drops",
+  },
+};
+
+/* The defaults of RFC 8289 and RFC 8033. */
+void
+vlib_aqm_config_init (vlib_aqm_config_t *c, vlib_aqm_type_t type)
+{
+  clib_memset (c, 0, sizeof (*c));
+  c->type = type;
+
+  switch (type)
+    {
+    case VLIB_AQM_CODEL:
+    case VLIB_AQM_FQ_CODEL:
+      c->target = 5000;
+      c->interval = 100000;
+      c->n_flows = 1024;
+      break;
+    case VLIB_AQM_PIE:
+      c->target = 15000;
+      c->interval = 15000;
+      c->max_burst = 150000;
+      c->alpha = 0.125;
+      c->beta = 1.25;
+      break;
+    default:
+      break;
+    }
+}
+
+void
+vlib_aqm_pie_update (vlib_aqm_t *a, vlib_aqm_state_t *s, u64 now)
+{
+  f64 qdelay = s->qdelay * a->seconds_per_clock;
+  f64 qdelay_old = s->qdelay_old * a->seconds_per_clock;
+  f64 target = a->target * a->seconds_per_clock;
+  f64 p, prob = s->drop_prob;
+  u64 n_updates = 1;
+
+  p = a->config.alpha * (qdelay - target) +
+      a->config.beta * (qdelay - qdelay_old);
+
+  /* the lower the probability, the smaller the steps */
+  if (prob < 0.000001)
+    p /= 2048;
+  else if (prob < 0.00001)
+    p /= 512;
+  else if (prob < 0.0001)
+    p /= 128;
+  else if (prob < 0.001)
+    p /= 32;
+  else if (prob < 0.01)
+    p /= 8;
+  else if (prob < 0.1)
+    p /= 2;
+  else if (p > 0.02)
+    p = 0.02;
+
+  prob = clib_min (clib_max (prob + p, 0.0), 1.0);
+
+  /* nothing left the queue for a while, those updates saw it empty */
+  if (s->next_update && now > s->next_update)
+    n_updates += (now - s->next_update) / a->interval;
+  if (n_updates > 1 || (s->qdelay == 0 && s->qdelay_old == 0))
+    prob *= __builtin_pow (0.98, n_updates);
+
+  s->burst_allowance = s->burst_allowance > n_updates * a->interval ?
+			 s->burst_allowance - n_updates * a->interval :
+			 0;
+  if (prob == 0 && qdelay < target / 2 && qdelay_old < target / 2)
+    s->burst_allowance = a->max_burst;
+
+  s->drop_prob = prob;
+  s->qdelay_old = s->qdelay;
+  s->next_update = now + a->interval;
+}
+
+clib_error_t *
+vlib_aqm_create (const vlib_aqm_config_t *c, u32 *aqm_index, char *fmt, ...)
+{
+  vlib_aqm_main_t *am = &vlib_aqm_main;
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  vlib_main_t *vm = vlib_get_main ();
+  f64 clocks_per_us = vm->clib_time.clocks_per_second * 1e-6;
+  int with_barrier = !vlib_worker_thread_barrier_held ();
+  vlib_aqm_state_t *s;
+  vlib_aqm_t *a;
+  va_list va;
+  u32 index;
+
+  if (c->type == VLIB_AQM_NONE || c->type >= VLIB_AQM_N_TYPES)
+    return clib_error_return (0, "unknown aqm type %u", c->type);
+  if (c->target == 0 || c->interval == 0)
+    return clib_error_return (0, "target and interval must be non-zero");
+  if (c->type == VLIB_AQM_FQ_CODEL && !is_pow2 (c->n_flows))
+    return clib_error_return (0, "flows must be a power of 2");
+
+  /* data plane threads look instances and counters up by index */
+  if (with_barrier)
+    vlib_worker_thread_barrier_sync (vm);
+  pool_get_zero (am->instances, a);
+  index = a - am->instances;
+  vlib_validate_combined_counter (&am->sojourn, index);
+  vlib_zero_combined_counter (&am->sojourn, index);
+  vlib_validate_simple_counter (&am->drops, index);
+  vlib_zero_simple_counter (&am->drops, index);
+  if (with_barrier)
+    vlib_worker_thread_barrier_release (vm);
+
+  a->config = *c;
+  va_start (va, fmt);
+  a->name = va_format (0, fmt, &va);
+  va_end (va);
+
+  a->target = c->target * clocks_per_us;
+  a->interval = c->interval * clocks_per_us;
+  a->max_burst = c->max_burst * clocks_per_us;
+  a->seconds_per_clock = vm->clib_time.seconds_per_clock;
+
+  vec_validate_aligned (a->per_thread, tm->n_vlib_mains - 1,
+			CLIB_CACHE_LINE_BYTES);
+  vec_foreach (s, a->per_thread)
+    {
+      s->seed = random_default_seed () + (s - a->per_thread);
+      s->burst_allowance = a->max_burst;
+      if (c->type == VLIB_AQM_FQ_CODEL)
+	vec_validate (s->flow_packets, c->n_flows - 1);
+    }
+
+  a->sojourn_stats_index = vlib_stats_add_symlink (
+    am->sojourn.stats_entry_index, index, "/aqm/%v/sojourn", a->name);
+  a->drops_stats_index = vlib_stats_add_symlink (
+    am->drops.stats_entry_index, index, "/aqm/%v/drops", a->name);
+
+  *aqm_index = index;
+  return 0;
+}
+
+/* The instance's queues must no longer use it. */
+void
+vlib_aqm_delete (u32 aqm_index)
+{
+  vlib_aqm_main_t *am = &vlib_aqm_main;
+  vlib_aqm_t *a = vlib_aqm_get (aqm_index);
+  vlib_aqm_state_t *s;
+
+  if (a->sojourn_stats_index != ~0)
+    vlib_stats_remove_entry (a->sojourn_stats_index);
+  if (a->drops_stats_index != ~0)
+    vlib_stats_remove_entry (a->drops_stats_index);
+
+  vec_foreach (s, a->per_thread)
+    vec_free (s->flow_packets);
+  vec_free (a->per_thread);
+  vec_free (a->name);
+  pool_put (am->instances, a);
+}
+
+u8 *
+format_vlib_aqm_type (u8 *s, va_list *args)
+{
+  vlib_aqm_type_t type = va_arg (*args, vlib_aqm_type_t);
+  char *strings[] = {
+#define _(t, s) [VLIB_AQM_##t] = s,
+    foreach_vlib_aqm_type
+#undef _
+  };
+
+  if (type >= VLIB_AQM_N_TYPES)
+    return format (s, "unknown %u", type);
+  return format (s, "%s", strings[type]);
+}
+
+u8 *
+format_vlib_aqm (u8 *s, va_list *args)
+{
+  u32 aqm_index = va_arg (*args, u32);
+  vlib_aqm_main_t *am = &vlib_aqm_main;
+  vlib_aqm_t *a = vlib_aqm_get (aqm_index);
+  vlib_aqm_config_t *c = &a->config;
+  vlib_counter_t sojourn;
+  u64 drops;
+
+  s = format (s, "%U target %uus interval %uus", format_vlib_aqm_type,
+	      c->type, c->target, c->interval);
+  if (c->type == VLIB_AQM_PIE)
+    s = format (s, " burst %uus alpha %.3f beta %.3f", c->max_burst,
+		c->alpha, c->beta);
+  else if (c->type == VLIB_AQM_FQ_CODEL)
+    s = format (s, " flows %u", c->n_flows);
+
+  vlib_get_combined_counter (&am->sojourn, aqm_index, &sojourn);
+  drops = vlib_get_simple_counter (&am->drops, aqm_index);
+  s = format (s, ", %lu packets, avg sojourn %.1fus, %lu drops",
+	      sojourn.packets,
+	      sojourn.packets ? (f64) sojourn.bytes / sojourn.packets : 0.0,
+	      drops);
+  return s;
+}
+
+/* <type> [target <us>] [interval <us>] [burst <us>] [alpha <f>]
+ * [beta <f>] [flows <n>], type being none, codel, fq-codel or pie */
+uword
+unformat_vlib_aqm_config (unformat_input_t *input, va_list *args)
+{
+  vlib_aqm_config_t *c = va_arg (*args, vlib_aqm_config_t *);
+
+  if (unformat (input, "fq-codel"))
+    vlib_aqm_config_init (c, VLIB_AQM_FQ_CODEL);
+  else if (unformat (input, "codel"))
+    vlib_aqm_config_init (c, VLIB_AQM_CODEL);
+  else if (unformat (input, "pie"))
+    vlib_aqm_config_init (c, VLIB_AQM_PIE);
+  else if (unformat (input, "none") || unformat (input, "off"))
+    vlib_aqm_config_init (c, VLIB_AQM_NONE);
+  else
+    return 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "target %u", &c->target))
+	;
+      else if (unformat (input, "interval %u", &c->interval))
+	;
+      else if (unformat (input, "burst %u", &c->max_burst))
+	;
+      else if (unformat (input, "alpha %f", &c->alpha))
+	;
+      else if (unformat (input, "beta %f", &c->beta))
+	;
+      else if (unformat (input, "flows %u", &c->n_flows))
+	;
+      else
+	break;
+    }
+  return 1;
+}
+
+static clib_error_t *
+show_aqm_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		     vlib_cli_command_t *cmd)
+{
+  vlib_aqm_main_t *am = &vlib_aqm_main;
+  vlib_aqm_t *a;
+
+  pool_foreach (a, am->instances)
+    vlib_cli_output (vm, "%v: %U", a->name, format_vlib_aqm,
+		     a - am->instances);
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_aqm_command, static) = {
+  .path = "show aqm",
+  .short_help = "show aqm",
+  .function = show_aqm_command_fn,
+};
+
+static clib_error_t *
+clear_aqm_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  vlib_aqm_main_t *am = &vlib_aqm_main;
+
+  vlib_clear_combined_counters (&am->sojourn);
+  vlib_clear_simple_counters (&am->drops);
+  return 0;
+}
+
+VLIB_CLI_COMMAND (clear_aqm_command, static) = {
+  .path = "clear aqm",
+  .short_help = "clear aqm",
+  .function = clear_aqm_command_fn,
+};
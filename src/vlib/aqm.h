@@ -0,0 +1,272 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+/*
+ * Active queue management.
+ *
+ * An AQM instance decides which of the packets leaving a queue to drop,
+ * from how long they waited in it, their sojourn time, so a queue under
+ * overload settles at a short standing delay instead of filling up and
+ * tail dropping. The queue's consumer calls vlib_aqm_dequeue () for each
+ * packet it takes off the queue. Each thread has its own state, so an
+ * instance may serve one queue per thread without locking.
+ *
+ * CoDel (RFC 8289) starts dropping once sojourn times have stayed above
+ * the target for an interval, and then drops more often the longer they
+ * stay there.
+ *
+ * PIE (RFC 8033) drops at random, with a probability steered every
+ * interval by how far the sojourn time is above the target and by how
+ * fast it is growing. Short bursts are let through.
+ *
+ * FQ-CoDel runs CoDel on the whole queue, but hands each drop to the
+ * next packet of a flow sending at least its fair share of the packets
+ * seen in the last interval. The queues served here cannot be reordered,
+ * so flows share out the losses but are not scheduled separately.
+ *
+ * Packets seen, their total sojourn time in microseconds and drops of
+ * each instance are in the stats segment, under /aqm/<name>/.
+ */
+
+#ifndef included_vlib_aqm_h
+#define included_vlib_aqm_h
+
+#include <vlib/vlib.h>
+#include <vppinfra/random.h>
+
+#define foreach_vlib_aqm_type                                                 \
+  _ (NONE, "none")                                                            \
+  _ (CODEL, "codel")                                                          \
+  _ (FQ_CODEL, "fq-codel")                                                    \
+  _ (PIE, "pie")
+
+typedef enum
+{
+#define _(t, s) VLIB_AQM_##t,
+  foreach_vlib_aqm_type
+#undef _
+    VLIB_AQM_N_TYPES,
+} vlib_aqm_type_t;
+
+typedef struct vlib_aqm_config_t
+{
+  vlib_aqm_type_t type;
+  /* sojourn time aimed at, microseconds */
+  u32 target;
+  /* CoDel interval, PIE update interval, microseconds */
+  u32 interval;
+  /* PIE bursts let through, microseconds */
+  u32 max_burst;
+  /* PIE gains, per second */
+  f64 alpha;
+  f64 beta;
+  /* FQ-CoDel flow buckets, a power of 2 */
+  u32 n_flows;
+} vlib_aqm_config_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
+  /* CoDel */
+  u64 first_above_time;
+  u64 drop_next;
+  u32 count;
+  u32 last_count;
+  u8 dropping;
+
+  /* FQ-CoDel: a drop is owed to the next packet of a heavy flow */
+  u8 drop_owed;
+  u32 *flow_packets;
+  u32 n_packets;
+  u32 n_flows_active;
+  u64 window_end;
+
+  /* PIE */
+  f64 drop_prob;
+  u64 qdelay;
+  u64 qdelay_old;
+  u64 burst_allowance;
+  u64 next_update;
+  u32 seed;
+} vlib_aqm_state_t;
+
+typedef struct
+{
+  vlib_aqm_config_t config;
+  u8 *name;
+
+  /* config in CPU clocks */
+  u64 target;
+  u64 interval;
+  u64 max_burst;
+  f64 seconds_per_clock;
+
+  vlib_aqm_state_t *per_thread;
+
+  u32 sojourn_stats_index;
+  u32 drops_stats_index;
+} vlib_aqm_t;
+
+typedef struct
+{
+  vlib_aqm_t *instances;
+
+  /* packets seen and their sojourn time in microseconds, by instance */
+  vlib_combined_counter_main_t sojourn;
+  vlib_simple_counter_main_t drops;
+} vlib_aqm_main_t;
+
+extern vlib_aqm_main_t vlib_aqm_main;
+
+void vlib_aqm_config_init (vlib_aqm_config_t *c, vlib_aqm_type_t type);
+clib_error_t *vlib_aqm_create (const vlib_aqm_config_t *c, u32 *aqm_index,
+			       char *fmt, ...);
+void vlib_aqm_delete (u32 aqm_index);
+void vlib_aqm_pie_update (vlib_aqm_t *a, vlib_aqm_state_t *s, u64 now);
+
+format_function_t format_vlib_aqm;
+format_function_t format_vlib_aqm_type;
+unformat_function_t unformat_vlib_aqm_config;
+
+static_always_inline vlib_aqm_t *
+vlib_aqm_get (u32 aqm_index)
+{
+  return pool_elt_at_index (vlib_aqm_main.instances, aqm_index);
+}
+
+static_always_inline u64
+vlib_aqm_codel_control_law (vlib_aqm_t *a, vlib_aqm_state_t *s, u64 t)
+{
+  return t + (u64) (a->interval / __builtin_sqrt (s->count));
+}
+
+static_always_inline int
+vlib_aqm_codel (vlib_aqm_t *a, vlib_aqm_state_t *s, u64 now, u64 sojourn)
+{
+  int ok_to_drop = 0;
+  u32 delta;
+
+  if (sojourn < a->target)
+    s->first_above_time = 0;
+  else if (s->first_above_time == 0)
+    s->first_above_time = now + a->interval;
+  else
+    ok_to_drop = now >= s->first_above_time;
+
+  if (s->dropping)
+    {
+      if (!ok_to_drop)
+	{
+	  s->dropping = 0;
+	  return 0;
+	}
+      if (now < s->drop_next)
+	return 0;
+      s->count++;
+      s->drop_next = vlib_aqm_codel_control_law (a, s, s->drop_next);
+      return 1;
+    }
+
+  if (!ok_to_drop)
+    return 0;
+
+  /* dropping again soon after the last time, pick up where it left off */
+  delta = s->count - s->last_count;
+  if (delta > 1 && (i64) (now - s->drop_next) < 16 * (i64) a->interval)
+    s->count = delta;
+  else
+    s->count = 1;
+  s->last_count = s->count;
+  s->dropping = 1;
+  s->drop_next = vlib_aqm_codel_control_law (a, s, now);
+  return 1;
+}
+
+static_always_inline int
+vlib_aqm_fq_codel (vlib_aqm_t *a, vlib_aqm_state_t *s, u64 now, u64 sojourn,
+		   u32 flow)
+{
+  u32 *n = s->flow_packets + (flow & (a->config.n_flows - 1));
+
+  if (now >= s->window_end)
+    {
+      clib_memset_u32 (s->flow_packets, 0, a->config.n_flows);
+      s->n_packets = 0;
+      s->n_flows_active = 0;
+      s->window_end = now + a->interval;
+    }
+
+  s->n_flows_active += n[0]++ == 0;
+  s->n_packets++;
+
+  if (vlib_aqm_codel (a, s, now, sojourn))
+    s->drop_owed = 1;
+  else if (!s->dropping)
+    s->drop_owed = 0;
+
+  if (s->drop_owed && (u64) n[0] * s->n_flows_active >= s->n_packets)
+    {
+      s->drop_owed = 0;
+      return 1;
+    }
+  return 0;
+}
+
+static_always_inline int
+vlib_aqm_pie (vlib_aqm_t *a, vlib_aqm_state_t *s, u64 now, u64 sojourn)
+{
+  s->qdelay = sojourn;
+  if (now >= s->next_update)
+    vlib_aqm_pie_update (a, s, now);
+
+  if (s->burst_allowance)
+    return 0;
+  if (s->qdelay_old < a->target / 2 && s->drop_prob < 0.2)
+    return 0;
+  return random_f64 (&s->seed) < s->drop_prob;
+}
+
+/*
+ * A packet which spent sojourn clocks in the queue is leaving it on
+ * thread thread_index; returns 1 if it should be dropped. Flow is a hash
+ * of the packet's flow, only used by FQ-CoDel.
+ */
+static_always_inline int
+vlib_aqm_dequeue (vlib_aqm_t *a, clib_thread_index_t thread_index, u64 now,
+		  u64 sojourn, u32 flow)
+{
+  vlib_aqm_state_t *s = vec_elt_at_index (a->per_thread, thread_index);
+
+  switch (a->config.type)
+    {
+    case VLIB_AQM_CODEL:
+      return vlib_aqm_codel (a, s, now, sojourn);
+    case VLIB_AQM_FQ_CODEL:
+      return vlib_aqm_fq_codel (a, s, now, sojourn, flow);
+    case VLIB_AQM_PIE:
+      return vlib_aqm_pie (a, s, now, sojourn);
+    default:
+      return 0;
+    }
+}
+
+/* Count n_packets which spent sojourn clocks in the queue, n_drops of
+ * which were dropped. */
+static_always_inline void
+vlib_aqm_count (vlib_aqm_t *a, clib_thread_index_t thread_index,
+		u32 n_packets, u64 sojourn, u32 n_drops)
+{
+  vlib_aqm_main_t *am = &vlib_aqm_main;
+  u32 aqm_index = a - am->instances;
+  u64 us = sojourn * a->seconds_per_clock * 1e6;
+
+  vlib_increment_combined_counter (&am->sojourn, thread_index, aqm_index,
+				   n_packets, n_packets * us);
+  if (n_drops)
+    vlib_increment_simple_counter (&am->drops, thread_index, aqm_index,
+				   n_drops);
+}
+
+#endif /* included_vlib_aqm_h */
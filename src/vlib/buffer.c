@@ -481,6 +481,22 @@ vlib_buffer_alloc_size (uword ext_hdr_size, uword data_size)
   return alloc_size;
 }
 
+static void
+vlib_buffer_magazine_ring_init (vlib_buffer_magazine_ring_t *r,
+				u32 n_magazines)
+{
+  /* twice the magazines, so an enqueue is never held up by a slow
+     dequeue of the previous lap */
+  u32 i, n_slots = max_pow2 (2 * n_magazines);
+
+  r->slots = clib_mem_alloc_aligned (n_slots * sizeof (r->slots[0]),
+				     CLIB_CACHE_LINE_BYTES);
+  for (i = 0; i < n_slots; i++)
+    r->slots[i].seq = i;
+  r->mask = n_slots - 1;
+  r->head = r->tail = 0;
+}
+
 u8
 vlib_buffer_pool_create (vlib_main_t *vm, u32 data_size, u32 physmem_map_index,
 			 char *fmt, ...)
@@ -492,7 +508,7 @@ vlib_buffer_pool_create (vlib_main_t *vm, u32 data_size, u32 physmem_map_index,
   uword size = (uword) m->n_pages << m->log2_page_size;
   uword page_mask = ~pow2_mask (m->log2_page_size);
   u8 *p;
-  u32 alloc_size;
+  u32 alloc_size, i;
   va_list va;
 
   if (vec_len (bm->buffer_pools) >= 255)
@@ -583,6 +599,17 @@ vlib_buffer_pool_create (vlib_main_t *vm, u32 data_size, u32 physmem_map_index,
 
   bp->n_buffers = bp->n_avail;
 
+  /* one more magazine than the buffers can fill, so there is always an
+     empty one while a thread holds a full one */
+  bp->n_magazines = bp->n_buffers / VLIB_BUFFER_MAGAZINE_SZ + 1;
+  bp->magazines = clib_mem_alloc_aligned (
+    bp->n_magazines * VLIB_BUFFER_MAGAZINE_SZ * sizeof (u32),
+    CLIB_CACHE_LINE_BYTES);
+  vlib_buffer_magazine_ring_init (&bp->full_magazines, bp->n_magazines);
+  vlib_buffer_magazine_ring_init (&bp->empty_magazines, bp->n_magazines);
+  for (i = 0; i < bp->n_magazines; i++)
+    vlib_buffer_magazine_ring_enq (&bp->empty_magazines, i);
+
   return bp->index;
 }
 
@@ -592,7 +619,7 @@ format_vlib_buffer_pool (u8 * s, va_list * va)
   vlib_main_t *vm = va_arg (*va, vlib_main_t *);
   vlib_buffer_pool_t *bp = va_arg (*va, vlib_buffer_pool_t *);
   vlib_buffer_pool_thread_t *bpt;
-  u32 cached = 0;
+  u32 cached = 0, avail;
 
   if (!bp)
     return format (s, "%-20s%=6s%=6s%=6s%=11s%=6s%=8s%=8s%=8s",
@@ -602,12 +629,14 @@ format_vlib_buffer_pool (u8 * s, va_list * va)
   vec_foreach (bpt, bp->threads)
     cached += bpt->n_cached;
 
+  avail = bp->n_avail + vlib_buffer_pool_n_magazine_buffers (bp);
+
   s = format (s, "%-20v%=6d%=6d%=6u%=11u%=6u%=8u%=8u%=8u", bp->name, bp->index,
 	      bp->numa_node,
 	      bp->data_size + sizeof (vlib_buffer_t) +
 		vm->buffer_main->ext_hdr_size,
-	      bp->data_size, bp->n_buffers, bp->n_avail, cached,
-	      bp->n_buffers - bp->n_avail - cached);
+	      bp->data_size, bp->n_buffers, avail, cached,
+	      bp->n_buffers - avail - cached);
 
   return s;
 }
@@ -795,7 +824,9 @@ buffer_gauges_collect_used_fn (vlib_stats_collector_data_t *d)
   if (!bp)
     return;
 
-  d->entry->value = bp->n_buffers - bp->n_avail - buffer_get_cached (bp);
+  d->entry->value = bp->n_buffers - bp->n_avail -
+		    vlib_buffer_pool_n_magazine_buffers (bp) -
+		    buffer_get_cached (bp);
 }
 
 static void
@@ -807,7 +838,7 @@ buffer_gauges_collect_available_fn (vlib_stats_collector_data_t *d)
   if (!bp)
     return;
 
-  d->entry->value = bp->n_avail;
+  d->entry->value = bp->n_avail + vlib_buffer_pool_n_magazine_buffers (bp);
 }
 
 static void
@@ -822,6 +853,40 @@ buffer_gauges_collect_cached_fn (vlib_stats_collector_data_t *d)
   d->entry->value = buffer_get_cached (bp);
 }
 
+/* per thread, as a counter vector of one element */
+static void
+buffer_counters_collect_magazine_fn (vlib_stats_collector_data_t *d)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  vlib_buffer_pool_t *bp =
+    buffer_get_by_index (vm->buffer_main, d->private_data);
+  vlib_buffer_pool_thread_t *bpt;
+  counter_t **counters = d->entry->data;
+
+  if (!bp)
+    return;
+
+  vec_foreach (bpt, bp->threads)
+    counters[bpt - bp->threads][0] =
+      bpt->n_magazine_puts + bpt->n_magazine_gets;
+}
+
+static void
+buffer_counters_collect_locked_fn (vlib_stats_collector_data_t *d)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  vlib_buffer_pool_t *bp =
+    buffer_get_by_index (vm->buffer_main, d->private_data);
+  vlib_buffer_pool_thread_t *bpt;
+  counter_t **counters = d->entry->data;
+
+  if (!bp)
+    return;
+
+  vec_foreach (bpt, bp->threads)
+    counters[bpt - bp->threads][0] = bpt->n_locked_puts + bpt->n_locked_gets;
+}
+
 clib_error_t *
 vlib_buffer_main_init (struct vlib_main_t * vm)
 {
@@ -905,6 +970,19 @@ vlib_buffer_main_init (struct vlib_main_t * vm)
       vlib_stats_add_gauge ("/buffer-pools/%v/available", bp->name);
     reg.collect_fn = buffer_gauges_collect_available_fn;
     vlib_stats_register_collector_fn (&reg);
+
+    /* cross thread buffer exchanges, with and without the pool lock */
+    reg.entry_index = vlib_stats_add_counter_vector (
+      "/buffer-pools/%v/magazine-exchanges", bp->name);
+    vlib_stats_validate (reg.entry_index, vec_len (bp->threads) - 1, 0);
+    reg.collect_fn = buffer_counters_collect_magazine_fn;
+    vlib_stats_register_collector_fn (&reg);
+
+    reg.entry_index = vlib_stats_add_counter_vector (
+      "/buffer-pools/%v/locked-exchanges", bp->name);
+    vlib_stats_validate (reg.entry_index, vec_len (bp->threads) - 1, 0);
+    reg.collect_fn = buffer_counters_collect_locked_fn;
+    vlib_stats_register_collector_fn (&reg);
   }
 
 done:
@@ -456,13 +456,43 @@ struct vlib_main_t;
 
 #define VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ 512
 
+/* buffers handed between threads in one go, without the pool lock */
+#define VLIB_BUFFER_MAGAZINE_SZ (VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ / 2)
+
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
   u32 cached_buffers[VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ];
   u32 n_cached;
+
+  /* magazines given to and taken from other threads */
+  u64 n_magazine_puts;
+  u64 n_magazine_gets;
+
+  /* buffers returned to and taken from the pool under its lock */
+  u64 n_locked_puts;
+  u64 n_locked_gets;
 } vlib_buffer_pool_thread_t;
 
+typedef struct
+{
+  u32 seq;
+  u32 magazine_index;
+} vlib_buffer_magazine_ring_slot_t;
+
+/* multi-producer multi-consumer ring of magazine indices, each slot's
+   sequence number tells whether it is ready to be written or read */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  u32 head;
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
+  u32 tail;
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline2);
+  u32 mask;
+  vlib_buffer_magazine_ring_slot_t *slots;
+} vlib_buffer_magazine_ring_t;
+
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -483,6 +513,14 @@ typedef struct
   /* per-thread data */
   vlib_buffer_pool_thread_t *threads;
 
+  /* VLIB_BUFFER_MAGAZINE_SZ buffer indices per magazine, full ones are
+     left by threads freeing more than they allocate for those that
+     allocate more than they free */
+  u32 *magazines;
+  u32 n_magazines;
+  vlib_buffer_magazine_ring_t full_magazines;
+  vlib_buffer_magazine_ring_t empty_magazines;
+
   /* buffer metadata template */
   vlib_buffer_template_t buffer_template;
 } vlib_buffer_pool_t;
@@ -4,6 +4,7 @@
 
 #include <vppinfra/clib.h>
 #include <vlib/vlib.h>
+#include <vlib/aqm.h>
 #include <vppinfra/vector/mask_compare.h>
 #include <vppinfra/vector/compress.h>
 
@@ -258,6 +259,7 @@ static inline vlib_frame_queue_elt_t *
 vlib_get_frame_queue_elt (vlib_frame_queue_main_t *fqm, u32 index,
 			  int dont_wait)
 {
+  vlib_frame_queue_elt_t *elt;
   vlib_frame_queue_t *fq;
   u64 nelts, tail, new_tail;
 
@@ -283,7 +285,31 @@ retry:
 				    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
     goto retry;
 
-  return fq->elts + (new_tail & (nelts - 1));
+  elt = fq->elts + (new_tail & (nelts - 1));
+
+  /* a thief moves head on when it takes an element, before it is done
+     with it, so the slot is only free once valid is clear */
+  while (PREDICT_FALSE (__atomic_load_n (&elt->valid, __ATOMIC_ACQUIRE)))
+    CLIB_PAUSE ();
+
+  return elt;
+}
+
+/* wake a sibling worker, which will help out if the queue is congested */
+static_always_inline void
+vlib_frame_queue_wake_thief (vlib_frame_queue_main_t *fqm,
+			     clib_thread_index_t thread_index)
+{
+  vlib_frame_queue_t *fq = fqm->vlib_frame_queues[thread_index];
+  u32 n_workers = vec_len (fqm->vlib_frame_queues) - 1, thief;
+
+  if (n_workers < 2 || fq->tail - fq->head < fqm->steal_threshold)
+    return;
+
+  thief = 1 + fqm->next_thief++ % n_workers;
+  if (thief == thread_index)
+    thief = 1 + thief % n_workers;
+  vlib_get_main_by_index (thief)->check_frame_queues = 1;
 }
 
 static_always_inline u32
@@ -317,8 +343,13 @@ more:
       if (node->flags & VLIB_NODE_FLAG_TRACE)
 	hf->maybe_trace = 1;
       hf->n_vectors = n_comp;
+      hf->producer = vm->thread_index;
+      if (PREDICT_FALSE (fqm->aqm_index != ~0))
+	hf->enqueue_time = clib_cpu_time_now ();
       __atomic_store_n (&hf->valid, 1, __ATOMIC_RELEASE);
       vlib_get_main_by_index (thread_index)->check_frame_queues = 1;
+      if (PREDICT_FALSE (fqm->steal_mode))
+	vlib_frame_queue_wake_thief (fqm, thread_index);
     }
   else
     n_drop += n_comp;
@@ -413,6 +444,293 @@ CLIB_MULTIARCH_FN (vlib_buffer_enqueue_to_thread_with_aux_fn)
 CLIB_MARCH_FN_REGISTRATION (vlib_buffer_enqueue_to_thread_fn);
 CLIB_MARCH_FN_REGISTRATION (vlib_buffer_enqueue_to_thread_with_aux_fn);
 
+static_always_inline void
+vlib_frame_queue_sample_occupancy (vlib_frame_queue_t *fq)
+{
+  u32 n_in_use = fq->tail - fq->head;
+
+  fq->occupancy_sum += n_in_use;
+  fq->n_occupancy_samples++;
+  if (n_in_use > fq->max_occupancy)
+    fq->max_occupancy = n_in_use;
+}
+
+/* the elements taken last time round have been through the graph */
+static_always_inline void
+vlib_frame_queue_release_groups (vlib_frame_queue_main_t *fqm, u32 *held)
+{
+  vlib_frame_queue_t *fq;
+  u32 *g;
+
+  vec_foreach (g, held)
+    {
+      fq = fqm->vlib_frame_queues[g[0] >> 16];
+      __atomic_store_n (&fq->group_owners[g[0] & 0xffff], 0,
+			__ATOMIC_RELEASE);
+    }
+  vec_reset_length (held);
+}
+
+/*
+ * Take the element at the head of a queue, which other threads may be
+ * taking from too. Returns 0 if the queue is empty, or if the element
+ * belongs to a producer group held by another thread.
+ */
+static_always_inline vlib_frame_queue_elt_t *
+vlib_frame_queue_claim (vlib_frame_queue_main_t *fqm, u32 queue,
+			clib_thread_index_t thread_index, u32 **held)
+{
+  vlib_frame_queue_t *fq = fqm->vlib_frame_queues[queue];
+  vlib_frame_queue_elt_t *elt;
+  u32 owner, producer;
+  u64 head;
+
+retry:
+  head = __atomic_load_n (&fq->head, __ATOMIC_ACQUIRE);
+  if (head == __atomic_load_n (&fq->tail, __ATOMIC_ACQUIRE))
+    return 0;
+
+  elt = fq->elts + ((head + 1) & (fq->nelts - 1));
+  if (!__atomic_load_n (&elt->valid, __ATOMIC_ACQUIRE))
+    return 0;
+
+  if (fqm->steal_mode == VLIB_FRAME_QUEUE_STEAL_ORDERED)
+    {
+      /* the element can't change until head moves, which the CAS
+	 below checks, so what producer says is good if that succeeds */
+      producer = elt->producer;
+      owner = fq->group_owners[producer];
+      if (owner != thread_index + 1)
+	{
+	  if (owner)
+	    return 0;
+	  if (!__atomic_compare_exchange_n (&fq->group_owners[producer],
+					    &owner, thread_index + 1, 0,
+					    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+	    return 0;
+	  vec_add1 (*held, queue << 16 | producer);
+	}
+    }
+
+  if (!__atomic_compare_exchange_n (&fq->head, &head, head + 1, 0,
+				    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    goto retry;
+
+  return elt;
+}
+
+/* push a whole claimed element into the graph, then free its slot */
+static_always_inline void
+vlib_frame_queue_consume (vlib_main_t *vm, vlib_frame_queue_main_t *fqm,
+			  vlib_frame_queue_elt_t *elt, vlib_frame_t **fp,
+			  u32 *n_free, u8 with_aux)
+{
+  u32 n_left = elt->n_vectors, off = elt->offset, n_copy;
+  vlib_frame_t *f = fp[0];
+
+  ASSERT (elt->offset + elt->n_vectors <= VLIB_FRAME_SIZE);
+
+  while (n_left)
+    {
+      if (f == 0)
+	{
+	  f = vlib_get_frame_to_node (vm, fqm->node_index);
+	  n_free[0] = VLIB_FRAME_SIZE;
+	}
+
+      if (elt->maybe_trace)
+	f->frame_flags |= VLIB_NODE_FLAG_TRACE;
+
+      n_copy = clib_min (n_free[0], n_left);
+      vlib_buffer_copy_indices ((u32 *) vlib_frame_vector_args (f) +
+				  VLIB_FRAME_SIZE - n_free[0],
+				elt->buffer_index + off, n_copy);
+      if (with_aux)
+	vlib_buffer_copy_indices ((u32 *) vlib_frame_aux_args (f) +
+				    VLIB_FRAME_SIZE - n_free[0],
+				  elt->aux_data + off, n_copy);
+
+      n_free[0] -= n_copy;
+      n_left -= n_copy;
+      off += n_copy;
+
+      if (n_free[0] == 0)
+	{
+	  f->n_vectors = VLIB_FRAME_SIZE;
+	  vlib_put_frame_to_node (vm, fqm->node_index, f);
+	  f = 0;
+	}
+    }
+
+  fp[0] = f;
+
+  elt->maybe_trace = 0;
+  elt->n_vectors = 0;
+  elt->offset = 0;
+  __atomic_store_n (&elt->valid, 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * Gather trace data for frame queues
+ */
+static_always_inline void
+vlib_frame_queue_gather_trace (vlib_frame_queue_main_t *fqm,
+			       vlib_frame_queue_t *fq, u32 thread_id)
+{
+  u32 mask = fq->nelts - 1;
+  vlib_frame_queue_elt_t *elt;
+  frame_queue_trace_t *fqt;
+  frame_queue_nelt_counter_t *fqh;
+  u32 elix;
+
+  fqt = &fqm->frame_queue_traces[thread_id];
+
+  fqt->nelts = fq->nelts;
+  fqt->head = fq->head;
+  fqt->tail = fq->tail;
+  fqt->threshold = fq->vector_threshold;
+  fqt->n_in_use = fqt->tail - fqt->head;
+  if (fqt->n_in_use >= fqt->nelts)
+    {
+      // if beyond max then use max
+      fqt->n_in_use = fqt->nelts - 1;
+    }
+
+  /* Record the number of elements in use in the histogram */
+  fqh = &fqm->frame_queue_histogram[thread_id];
+  fqh->count[fqt->n_in_use]++;
+
+  /* Record a snapshot of the elements in use */
+  for (elix = 0; elix < fqt->nelts; elix++)
+    {
+      elt = fq->elts + ((fq->head + 1 + elix) & (mask));
+      if (1 || elt->valid)
+	{
+	  fqt->n_vectors[elix] = elt->n_vectors;
+	}
+    }
+  fqt->written = 1;
+}
+
+/*
+ * Dequeue when other threads may take from our queue, and we from
+ * theirs. Elements are only ever taken whole. Once our own queue is
+ * empty, help the most congested sibling until it drops below the
+ * steal threshold.
+ */
+static_always_inline u32
+vlib_frame_queue_steal_dequeue_inline (vlib_main_t *vm,
+				       vlib_frame_queue_main_t *fqm,
+				       u8 with_aux)
+{
+  clib_thread_index_t thread_index = vm->thread_index;
+  u32 **held = vec_elt_at_index (fqm->held_groups, thread_index);
+  vlib_frame_queue_t *fq = fqm->vlib_frame_queues[thread_index], *vfq;
+  u32 n_free = 0, vectors = 0, processed = 0, n_stolen = 0;
+  u32 i, victim = ~0, n_in_use, max_in_use = 0;
+  vlib_frame_queue_elt_t *elt;
+  vlib_frame_t *f = 0;
+
+  vlib_frame_queue_release_groups (fqm, held[0]);
+  vlib_frame_queue_sample_occupancy (fq);
+
+  /* each queue's occupancy is traced by its owner only, so a stolen
+     element shows in its victim's snapshots, not the thief's. The
+     packets' own traces carry on on the thief, as for any handoff,
+     since consume flags the frame for tracing */
+  if (PREDICT_FALSE (fq->trace))
+    vlib_frame_queue_gather_trace (fqm, fq, thread_index);
+
+  while (vectors < fq->vector_threshold &&
+	 (elt = vlib_frame_queue_claim (fqm, thread_index, thread_index,
+					held)))
+    {
+      vectors += elt->n_vectors;
+      vlib_frame_queue_consume (vm, fqm, elt, &f, &n_free, with_aux);
+      processed++;
+    }
+
+  /* the main thread has better things to do */
+  if (processed || thread_index == 0)
+    goto done;
+
+  for (i = 0; i < vec_len (fqm->vlib_frame_queues); i++)
+    {
+      vfq = fqm->vlib_frame_queues[i];
+      n_in_use = vfq->tail - vfq->head;
+      if (i != thread_index && n_in_use >= fqm->steal_threshold &&
+	  n_in_use > max_in_use)
+	{
+	  victim = i;
+	  max_in_use = n_in_use;
+	}
+    }
+
+  if (victim == ~0)
+    goto done;
+
+  vfq = fqm->vlib_frame_queues[victim];
+  while (vectors < vfq->vector_threshold &&
+	 vfq->tail - vfq->head >= fqm->steal_threshold &&
+	 (elt = vlib_frame_queue_claim (fqm, victim, thread_index, held)))
+    {
+      vectors += elt->n_vectors;
+      vlib_frame_queue_consume (vm, fqm, elt, &f, &n_free, with_aux);
+      n_stolen++;
+    }
+
+  if (n_stolen)
+    {
+      __atomic_fetch_add (&vfq->n_stolen, n_stolen, __ATOMIC_RELAXED);
+      processed += n_stolen;
+    }
+
+done:
+  if (f)
+    {
+      f->n_vectors = VLIB_FRAME_SIZE - n_free;
+      vlib_put_frame_to_node (vm, fqm->node_index, f);
+    }
+
+  return processed;
+}
+
+/*
+ * Let the queue's AQM drop packets of an element about to go into the
+ * graph. The element's packets all waited as long, FQ-CoDel takes the
+ * producer threads for flows.
+ */
+static_always_inline void
+vlib_frame_queue_aqm (vlib_main_t *vm, vlib_frame_queue_main_t *fqm,
+		      vlib_frame_queue_elt_t *elt, u8 with_aux)
+{
+  vlib_aqm_t *a = vlib_aqm_get (fqm->aqm_index);
+  u32 drops[VLIB_FRAME_SIZE], n_drops = 0, n_left = 0, i;
+  u64 now = clib_cpu_time_now (), sojourn = 0;
+
+  /* elements queued before AQM was turned on have no time */
+  if (elt->enqueue_time)
+    sojourn = now - elt->enqueue_time;
+
+  for (i = 0; i < elt->n_vectors; i++)
+    {
+      if (vlib_aqm_dequeue (a, vm->thread_index, now, sojourn, elt->producer))
+	{
+	  drops[n_drops++] = elt->buffer_index[i];
+	  continue;
+	}
+      elt->buffer_index[n_left] = elt->buffer_index[i];
+      if (with_aux)
+	elt->aux_data[n_left] = elt->aux_data[i];
+      n_left++;
+    }
+
+  vlib_aqm_count (a, vm->thread_index, elt->n_vectors, sojourn, n_drops);
+  if (n_drops)
+    vlib_buffer_free (vm, drops, n_drops);
+  elt->n_vectors = n_left;
+}
+
 static_always_inline u32
 vlib_frame_queue_dequeue_inline (vlib_main_t *vm, vlib_frame_queue_main_t *fqm,
 				 u8 with_aux)
@@ -430,43 +748,14 @@ vlib_frame_queue_dequeue_inline (vlib_main_t *vm, vlib_frame_queue_main_t *fqm,
 
   if (PREDICT_FALSE (fqm->node_index == ~0))
     return 0;
-  /*
-   * Gather trace data for frame queues
-   */
-  if (PREDICT_FALSE (fq->trace))
-    {
-      frame_queue_trace_t *fqt;
-      frame_queue_nelt_counter_t *fqh;
-      u32 elix;
-
-      fqt = &fqm->frame_queue_traces[thread_id];
-
-      fqt->nelts = fq->nelts;
-      fqt->head = fq->head;
-      fqt->tail = fq->tail;
-      fqt->threshold = fq->vector_threshold;
-      fqt->n_in_use = fqt->tail - fqt->head;
-      if (fqt->n_in_use >= fqt->nelts)
-	{
-	  // if beyond max then use max
-	  fqt->n_in_use = fqt->nelts - 1;
-	}
 
-      /* Record the number of elements in use in the histogram */
-      fqh = &fqm->frame_queue_histogram[thread_id];
-      fqh->count[fqt->n_in_use]++;
+  if (PREDICT_FALSE (fqm->steal_mode))
+    return vlib_frame_queue_steal_dequeue_inline (vm, fqm, with_aux);
 
-      /* Record a snapshot of the elements in use */
-      for (elix = 0; elix < fqt->nelts; elix++)
-	{
-	  elt = fq->elts + ((fq->head + 1 + elix) & (mask));
-	  if (1 || elt->valid)
-	    {
-	      fqt->n_vectors[elix] = elt->n_vectors;
-	    }
-	}
-      fqt->written = 1;
-    }
+  vlib_frame_queue_sample_occupancy (fq);
+
+  if (PREDICT_FALSE (fq->trace))
+    vlib_frame_queue_gather_trace (fqm, fq, thread_id);
 
   while (1)
     {
@@ -478,6 +767,20 @@ vlib_frame_queue_dequeue_inline (vlib_main_t *vm, vlib_frame_queue_main_t *fqm,
       if (!__atomic_load_n (&elt->valid, __ATOMIC_ACQUIRE))
 	break;
 
+      /* once per element, before any of it is taken */
+      if (PREDICT_FALSE (fqm->aqm_index != ~0) && elt->offset == 0)
+	{
+	  vlib_frame_queue_aqm (vm, fqm, elt, with_aux);
+	  if (elt->n_vectors == 0)
+	    {
+	      u32 sz = STRUCT_OFFSET_OF (vlib_frame_queue_elt_t, end_of_reset);
+	      clib_memset (elt, 0, sz);
+	      __atomic_store_n (&fq->head, fq->head + 1, __ATOMIC_RELEASE);
+	      processed++;
+	      continue;
+	    }
+	}
+
       from = elt->buffer_index + elt->offset;
       if (with_aux)
 	from_aux = elt->aux_data + elt->offset;
@@ -505,6 +505,144 @@ vlib_get_buffer_pool (vlib_main_t * vm, u8 buffer_pool_index)
   return vec_elt_at_index (bm->buffer_pools, buffer_pool_index);
 }
 
+static_always_inline void
+vlib_buffer_magazine_ring_enq (vlib_buffer_magazine_ring_t *r, u32 index)
+{
+  vlib_buffer_magazine_ring_slot_t *slot;
+  u32 pos = clib_atomic_load_relax_n (&r->tail);
+  i32 diff;
+
+  while (1)
+    {
+      slot = r->slots + (pos & r->mask);
+      diff = (i32) (clib_atomic_load_acq_n (&slot->seq) - pos);
+
+      if (diff == 0)
+	{
+	  if (clib_atomic_cmp_and_swap_acq_relax_n (&r->tail, &pos, pos + 1,
+						    1 /* weak */))
+	    break;
+	}
+      else if (diff < 0)
+	{
+	  /* the ring holds every magazine, so the slot is only still being
+	     read by a dequeue from the previous lap */
+	  CLIB_PAUSE ();
+	  pos = clib_atomic_load_relax_n (&r->tail);
+	}
+      else
+	pos = clib_atomic_load_relax_n (&r->tail);
+    }
+
+  slot->magazine_index = index;
+  clib_atomic_store_rel_n (&slot->seq, pos + 1);
+}
+
+static_always_inline int
+vlib_buffer_magazine_ring_deq (vlib_buffer_magazine_ring_t *r, u32 *index)
+{
+  vlib_buffer_magazine_ring_slot_t *slot;
+  u32 pos = clib_atomic_load_relax_n (&r->head);
+  i32 diff;
+
+  while (1)
+    {
+      slot = r->slots + (pos & r->mask);
+      diff = (i32) (clib_atomic_load_acq_n (&slot->seq) - (pos + 1));
+
+      if (diff == 0)
+	{
+	  if (clib_atomic_cmp_and_swap_acq_relax_n (&r->head, &pos, pos + 1,
+						    1 /* weak */))
+	    break;
+	}
+      else if (diff < 0)
+	return 0;
+      else
+	pos = clib_atomic_load_relax_n (&r->head);
+    }
+
+  *index = slot->magazine_index;
+  clib_atomic_store_rel_n (&slot->seq, pos + r->mask + 1);
+  return 1;
+}
+
+static_always_inline u32
+vlib_buffer_magazine_ring_count (vlib_buffer_magazine_ring_t *r)
+{
+  return clib_atomic_load_relax_n (&r->tail) -
+	 clib_atomic_load_relax_n (&r->head);
+}
+
+/** \brief Number of free buffers held in a pool's full magazines */
+static_always_inline u32
+vlib_buffer_pool_n_magazine_buffers (vlib_buffer_pool_t *bp)
+{
+  return vlib_buffer_magazine_ring_count (&bp->full_magazines) *
+	 VLIB_BUFFER_MAGAZINE_SZ;
+}
+
+/** \brief Give the oldest buffers of a thread's cache to other threads
+
+    Fills an empty magazine from the bottom of the cache and puts it on
+    the pool's ring of full magazines, so that buffers freed by one thread
+    reach the threads allocating them without taking the pool lock.
+
+    @return - 1 if a magazine was given away, 0 if none was available
+*/
+static_always_inline int
+vlib_buffer_pool_put_magazine (vlib_buffer_pool_t *bp,
+			       vlib_buffer_pool_thread_t *bpt)
+{
+  u32 mi, n_left;
+
+  if (bpt->n_cached < VLIB_BUFFER_MAGAZINE_SZ ||
+      !vlib_buffer_magazine_ring_deq (&bp->empty_magazines, &mi))
+    return 0;
+
+  vlib_buffer_copy_indices (bp->magazines + mi * VLIB_BUFFER_MAGAZINE_SZ,
+			    bpt->cached_buffers, VLIB_BUFFER_MAGAZINE_SZ);
+
+  /* the most recently freed, cache hot, buffers stay with the thread */
+  n_left = bpt->n_cached - VLIB_BUFFER_MAGAZINE_SZ;
+  ASSERT (n_left <= VLIB_BUFFER_MAGAZINE_SZ);
+  vlib_buffer_copy_indices (bpt->cached_buffers,
+			    bpt->cached_buffers + VLIB_BUFFER_MAGAZINE_SZ,
+			    n_left);
+  bpt->n_cached = n_left;
+
+  vlib_buffer_magazine_ring_enq (&bp->full_magazines, mi);
+  bpt->n_magazine_puts++;
+  return 1;
+}
+
+/** \brief Take whole magazines given away by other threads
+
+    @param buffers - (u32 * ) buffer index array
+    @param n_buffers - (u32) most buffers to take
+    @return - (u32) buffers taken, a multiple of VLIB_BUFFER_MAGAZINE_SZ
+*/
+static_always_inline u32
+vlib_buffer_pool_get_magazines (vlib_buffer_pool_t *bp,
+				vlib_buffer_pool_thread_t *bpt, u32 *buffers,
+				u32 n_buffers)
+{
+  u32 mi, n = 0;
+
+  while (n + VLIB_BUFFER_MAGAZINE_SZ <= n_buffers &&
+	 vlib_buffer_magazine_ring_deq (&bp->full_magazines, &mi))
+    {
+      vlib_buffer_copy_indices (buffers + n,
+				bp->magazines + mi * VLIB_BUFFER_MAGAZINE_SZ,
+				VLIB_BUFFER_MAGAZINE_SZ);
+      vlib_buffer_magazine_ring_enq (&bp->empty_magazines, mi);
+      n += VLIB_BUFFER_MAGAZINE_SZ;
+      bpt->n_magazine_gets++;
+    }
+
+  return n;
+}
+
 static_always_inline __clib_warn_unused_result uword
 vlib_buffer_pool_get (vlib_main_t * vm, u8 buffer_pool_index, u32 * buffers,
 		      u32 n_buffers)
@@ -550,7 +688,7 @@ vlib_buffer_alloc_from_pool (vlib_main_t * vm, u32 * buffers, u32 n_buffers,
   vlib_buffer_main_t *bm = vm->buffer_main;
   vlib_buffer_pool_t *bp;
   vlib_buffer_pool_thread_t *bpt;
-  u32 *src, *dst, len, n_left;
+  u32 *src, *dst, len, n_left, n_req;
 
   /* If buffer allocation fault injection is configured */
   if (VLIB_BUFFER_ALLOC_FAULT_INJECTOR > 0)
@@ -582,8 +720,13 @@ vlib_buffer_alloc_from_pool (vlib_main_t * vm, u32 * buffers, u32 n_buffers,
   /* alloc bigger than cache - take buffers directly from main pool */
   if (n_buffers >= VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ)
     {
+      n_req = n_buffers;
       n_buffers = vlib_buffer_pool_get (vm, buffer_pool_index, buffers,
 					n_buffers);
+      bpt->n_locked_gets++;
+      if (n_buffers < n_req)
+	n_buffers += vlib_buffer_pool_get_magazines (
+	  bp, bpt, buffers + n_buffers, n_req - n_buffers);
       goto done;
     }
 
@@ -596,9 +739,16 @@ vlib_buffer_alloc_from_pool (vlib_main_t * vm, u32 * buffers, u32 n_buffers,
       n_left -= len;
     }
 
-  len = round_pow2 (n_left, 32);
-  len = vlib_buffer_pool_get (vm, buffer_pool_index, bpt->cached_buffers,
-			      len);
+  /* refill from magazines freed by other threads before taking the lock */
+  len = vlib_buffer_pool_get_magazines (
+    bp, bpt, bpt->cached_buffers, round_pow2 (n_left, VLIB_BUFFER_MAGAZINE_SZ));
+  if (len < n_left)
+    {
+      len += vlib_buffer_pool_get (vm, buffer_pool_index,
+				   bpt->cached_buffers + len,
+				   round_pow2 (n_left - len, 32));
+      bpt->n_locked_gets++;
+    }
   bpt->n_cached = len;
 
   if (len)
@@ -742,9 +892,24 @@ vlib_buffer_pool_put (vlib_main_t * vm, u8 buffer_pool_index,
       return;
     }
 
+  /* make room by giving a magazine to the threads that allocate */
+  if (vlib_buffer_pool_put_magazine (bp, bpt))
+    {
+      n_cached = bpt->n_cached;
+      n_empty = VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ - n_cached;
+      if (n_buffers <= n_empty)
+	{
+	  vlib_buffer_copy_indices (bpt->cached_buffers + n_cached, buffers,
+				    n_buffers);
+	  bpt->n_cached = n_cached + n_buffers;
+	  return;
+	}
+    }
+
   vlib_buffer_copy_indices (bpt->cached_buffers + n_cached,
 			    buffers + n_buffers - n_empty, n_empty);
   bpt->n_cached = VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ;
+  bpt->n_locked_puts++;
 
   clib_spinlock_lock (&bp->lock);
   vlib_buffer_copy_indices (bp->buffers + bp->n_avail, buffers,
@@ -141,6 +141,10 @@ vlib_file_poll (vlib_main_t *vm)
   if (is_main && vm->api_queue_nonempty)
     goto skip_loops;
 
+  /* tasks ready to run */
+  if (is_main && vec_len (vm->task_main.ready))
+    goto skip_loops;
+
   if (is_main == 0)
     {
       if (*vlib_worker_threads->wait_at_barrier)
@@ -178,9 +182,16 @@ skip_loops:
   vm->file_poll_skip_loops = 1024;
 
 epoll:
+  /* a sleeping worker does not hold up reclamation */
+  if (is_main == 0)
+    vlib_rcu_offline (vm);
+
   n_fds_ready = epoll_wait (vm->epoll_fd, epoll_events,
 			    ARRAY_LEN (epoll_events), timeout_ms);
 
+  if (is_main == 0)
+    vlib_rcu_online (vm);
+
   __atomic_store_n (&vm->thread_sleeps, 0, __ATOMIC_RELAXED);
   __atomic_store_n (&vm->wakeup_pending, 0, __ATOMIC_RELAXED);
 
@@ -643,6 +643,7 @@ elog_save_buffer (vlib_main_t * vm,
   elog_main_t *em = &vlib_global_main.elog_main;
   char *file, *chroot_file;
   clib_error_t *error = 0;
+  int chrome = 0;
 
   if (!unformat (input, "%s", &file))
     {
@@ -650,6 +651,8 @@ elog_save_buffer (vlib_main_t * vm,
 		       format_unformat_error, input);
       return 0;
     }
+  if (unformat (input, "chrome"))
+    chrome = 1;
 
   /* It's fairly hard to get "../oopsie" through unformat; just in case */
   if (strstr (file, "..") || strchr (file, '/'))
@@ -667,7 +670,10 @@ elog_save_buffer (vlib_main_t * vm,
 		   elog_buffer_capacity (em), chroot_file);
 
   vlib_worker_thread_barrier_sync (vm);
-  error = elog_write_file (em, chroot_file, 1 /* flush ring */ );
+  if (chrome)
+    error = elog_write_chrome_trace (em, chroot_file, 1 /* flush ring */);
+  else
+    error = elog_write_file (em, chroot_file, 1 /* flush ring */ );
   vlib_worker_thread_barrier_release (vm);
   vec_free (chroot_file);
   return error;
@@ -684,7 +690,8 @@ vlib_post_mortem_dump (void)
 
 VLIB_CLI_COMMAND (elog_save_cli, static) = {
   .path = "event-logger save",
-  .short_help = "event-logger save <filename> (saves log in /tmp/<filename>)",
+  .short_help = "event-logger save <filename> [chrome] (saves log in "
+		"/tmp/<filename>, as a Chrome trace with chrome)",
   .function = elog_save_buffer,
 };
 
@@ -752,6 +759,38 @@ VLIB_CLI_COMMAND (elog_resize_cli, static) = {
   .function = elog_resize_command_fn,
 };
 
+static clib_error_t *
+elog_thread_rings_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			      vlib_cli_command_t *cmd)
+{
+  vlib_global_main_t *vgm = vlib_get_global_main ();
+  elog_main_t *em = &vgm->elog_main;
+
+  if (unformat (input, "on"))
+    vgm->elog_thread_rings = 1;
+  else if (unformat (input, "off"))
+    vgm->elog_thread_rings = 0;
+  else
+    return clib_error_return (0, "expected on or off, got `%U'",
+			      format_unformat_error, input);
+
+  /* Events in the thread rings are dropped either way */
+  vlib_worker_thread_barrier_sync (vm);
+  if (vgm->elog_thread_rings)
+    elog_thread_rings_enable (em, vlib_get_n_threads ());
+  else
+    elog_thread_rings_disable (em);
+  vlib_worker_thread_barrier_release (vm);
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (elog_thread_rings_cli, static) = {
+  .path = "event-logger thread-rings",
+  .short_help = "event-logger thread-rings on|off",
+  .function = elog_thread_rings_command_fn,
+};
+
 #endif /* CLIB_UNIX */
 
 static void
@@ -864,6 +903,33 @@ add_trajectory_trace (vlib_buffer_t * b, u32 node_index)
 #endif
 }
 
+static_always_inline void
+vlib_node_batch_update (vlib_node_main_t *nm, vlib_node_runtime_t *node,
+			uword n, u64 before, u64 after)
+{
+  vlib_node_batch_t *b = vec_elt_at_index (nm->node_batch, node->node_index);
+
+  /* packets that came in during the hold waited for up to this long */
+  if (b->hold_start && n)
+    {
+      b->n_held_calls++;
+      b->held_vectors += n;
+      b->held_clocks += before - b->hold_start;
+    }
+  b->hold_start = 0;
+
+  b->n_calls++;
+  b->n_vectors += n;
+
+  /* too small a vector to be worth the per call overhead, give the
+     queues some time to fill up */
+  if (n < b->min_vectors)
+    {
+      b->hold_start = after;
+      b->hold_until = after + b->budget_clocks;
+    }
+}
+
 static_always_inline u64
 dispatch_node (vlib_main_t *vm, vlib_node_runtime_t *node,
 	       vlib_node_type_t type, vlib_frame_t *frame,
@@ -900,6 +966,14 @@ dispatch_node (vlib_main_t *vm, vlib_node_runtime_t *node,
 	}
     }
 
+  if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_BATCH) &&
+      node->state == VLIB_NODE_STATE_POLLING &&
+      last_time_stamp < nm->node_batch[node->node_index].hold_until)
+    {
+      nm->node_batch[node->node_index].n_skipped++;
+      return last_time_stamp;
+    }
+
   /* Speculatively prefetch next frames. */
   if (node->n_next_nodes > 0)
     {
@@ -949,6 +1023,10 @@ dispatch_node (vlib_main_t *vm, vlib_node_runtime_t *node,
   vm->main_loop_vectors_processed += n;
   vm->main_loop_nodes_processed += n > 0;
 
+  if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_BATCH) &&
+      node->state == VLIB_NODE_STATE_POLLING)
+    vlib_node_batch_update (nm, node, n, last_time_stamp, t);
+
   v = vlib_node_runtime_update_stats (vm, node,
 				      /* n_calls */ 1,
 				      /* n_vectors */ n,
@@ -1468,6 +1546,8 @@ process_expired_timers (u32 *v)
 	{
 	  vec_add1 (nm->sched_node_pending, e.index);
 	}
+      else if (e.type == VLIB_TW_EVENT_T_TASK)
+	vlib_task_timer_expired (vm, e.index);
       else
 	ASSERT (0);
     }
@@ -1540,7 +1620,10 @@ vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
 	}
 
       if (!is_main)
-	vlib_worker_thread_barrier_check ();
+	{
+	  vlib_worker_thread_barrier_check ();
+	  vlib_rcu_quiescent (vm);
+	}
 
       if (PREDICT_FALSE (vm->check_frame_queues + frame_queue_check_counter))
 	{
@@ -1717,11 +1800,19 @@ vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
 	      CLIB_SWAP (nm->process_restore_current,
 			 nm->process_restore_next);
 	    }
+
+	  if (PREDICT_FALSE (vec_len (vm->task_main.ready) > 0))
+	    vlib_task_run_ready (vm);
 	}
       else
 	expired_timers = process_expired_timers (expired_timers);
 
       vlib_increment_main_loop_counter (vm);
+      if (is_main)
+	vlib_rcu_poll (vm);
+      /* the nodes are done with the last sampled trace, publish it */
+      if (PREDICT_FALSE (vm->trace_main.trace_ring_pending))
+	vlib_trace_ring_flush (&vm->trace_main);
       /* Record time stamp in case there are no enabled nodes and above
          calls do not update time stamp. */
       cpu_time_now = clib_cpu_time_now ();
@@ -1809,6 +1900,8 @@ vlib_main_configure (vlib_main_t * vm, unformat_input_t * input)
 			 &vgm->configured_elog_ring_size))
 	vgm->configured_elog_ring_size =
 	  1 << max_log2 (vgm->configured_elog_ring_size);
+      else if (unformat (input, "elog-thread-rings"))
+	vgm->elog_thread_rings = 1;
       else if (unformat (input, "elog-post-mortem-dump"))
 	vlib_add_del_post_mortem_callback (elog_post_mortem_dump,
 					   /* is_add */ 1);
@@ -1975,6 +2068,7 @@ vlib_main (vlib_main_t * volatile vm, unformat_input_t * input)
 
   vlib_tw_init (vm);
   vlib_file_poll_init (vm);
+  vm->task_main.current_task_index = ~0;
 
   /* See unix/main.c; most likely already set up */
   if (vgm->init_functions_called == 0)
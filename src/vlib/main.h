@@ -118,6 +118,10 @@ typedef struct vlib_main_t
   /* Incremented once for each main loop. */
   volatile u32 main_loop_count;
 
+  /* Reclamation epoch seen at the top of the last (worker) main loop,
+     VLIB_RCU_EPOCH_OFFLINE while the thread sleeps. */
+  volatile u64 rcu_epoch;
+
   /* Count of vectors processed this main loop. */
   u32 main_loop_vectors_processed;
   u32 main_loop_nodes_processed;
@@ -271,6 +275,9 @@ typedef struct vlib_main_t
   void *timing_wheel;
   u32 n_tw_timers;
 
+  /* Stackless tasks, main thread only */
+  vlib_task_main_t task_main;
+
 #ifdef CLIB_SANITIZE_ADDR
   /* address sanitizer stack save */
   void *asan_stack_save;
@@ -311,6 +318,7 @@ typedef struct vlib_global_main_t
   /* Event logger. */
   elog_main_t elog_main;
   u32 configured_elog_ring_size;
+  u8 elog_thread_rings;
 
   /* Packet trace capture filter */
   vlib_trace_filter_t trace_filter;
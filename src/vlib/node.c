@@ -933,6 +933,48 @@ vlib_node_set_march_variant (vlib_main_t *vm, u32 node_index,
   return -1;
 }
 
+clib_error_t *
+vlib_node_set_batching (vlib_main_t *vm, u32 node_index, u32 budget_us,
+			u32 min_vectors)
+{
+  vlib_node_t *n = vlib_get_node (vm, node_index);
+  vlib_node_batch_t *b;
+
+  if (n->type != VLIB_NODE_TYPE_INPUT)
+    return clib_error_return (0, "'%v' is not an input node", n->name);
+  if (budget_us && (min_vectors == 0 || min_vectors > VLIB_FRAME_SIZE))
+    return clib_error_return (0, "min-vectors must be in [1, %u]",
+			      VLIB_FRAME_SIZE);
+
+  vlib_worker_thread_barrier_sync (vm);
+
+  foreach_vlib_main ()
+    {
+      vlib_node_main_t *nm = &this_vlib_main->node_main;
+      vlib_node_t *tn = vlib_get_node (this_vlib_main, node_index);
+
+      vlib_node_set_flag (this_vlib_main, node_index, VLIB_NODE_FLAG_BATCH,
+			  budget_us != 0);
+      if (budget_us == 0)
+	continue;
+
+      vec_validate (nm->node_batch, node_index);
+      b = vec_elt_at_index (nm->node_batch, node_index);
+      clib_memset (b, 0, sizeof (*b));
+      b->budget_clocks =
+	budget_us * 1e-6 * this_vlib_main->clib_time.clocks_per_second;
+      b->min_vectors = min_vectors;
+
+      vlib_node_sync_stats (this_vlib_main, tn);
+      b->calls_before = tn->stats_total.calls - tn->stats_last_clear.calls;
+      b->vectors_before =
+	tn->stats_total.vectors - tn->stats_last_clear.vectors;
+    }
+
+  vlib_worker_thread_barrier_release (vm);
+  return 0;
+}
+
 clib_error_t *
 vlib_node_main_lazy_next_update (vlib_main_t *vm)
 {
@@ -357,6 +357,8 @@ typedef struct vlib_node_t
 #define VLIB_NODE_FLAG_TRACE_SUPPORTED (1 << 8)
 #define VLIB_NODE_FLAG_ADAPTIVE_MODE			     (1 << 9)
 #define VLIB_NODE_FLAG_ALLOW_LAZY_NEXT_NODES		     (1 << 10)
+  /* Polls of this input node are held down to build larger vectors. */
+#define VLIB_NODE_FLAG_BATCH				     (1 << 11)
 
   /* State for input nodes. */
   u8 state;
@@ -751,6 +753,37 @@ typedef struct
 }
 vlib_signal_timed_event_data_t;
 
+/*
+ * Input node micro-batching. When a poll returns fewer than min_vectors,
+ * the node is not polled again until budget clocks have passed, so its
+ * queues fill up and the next poll gets a larger vector. A packet that
+ * arrives during a hold waits at most the budget.
+ */
+typedef struct
+{
+  /* cpu time the node may next be polled, and when the hold began */
+  u64 hold_until;
+  u64 hold_start;
+
+  u64 budget_clocks;
+  u32 min_vectors;
+
+  /* vectors per call before batching was enabled */
+  u64 calls_before;
+  u64 vectors_before;
+
+  /* polls skipped, calls made after a hold, their vectors and the time
+     they were held for */
+  u64 n_skipped;
+  u64 n_held_calls;
+  u64 held_vectors;
+  u64 held_clocks;
+
+  /* all calls made while batching */
+  u64 n_calls;
+  u64 n_vectors;
+} vlib_node_batch_t;
+
 typedef struct
 {
   clib_march_variant_type_t index;
@@ -837,6 +870,9 @@ typedef struct
 
   /* Node Function march Variant by Suffix Hash */
   uword *node_fn_march_variant_by_suffix;
+
+  /* Input node batching state, by node index */
+  vlib_node_batch_t *node_batch;
 } vlib_node_main_t;
 
 typedef u16 vlib_error_t;
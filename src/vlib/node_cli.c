@@ -893,6 +893,112 @@ VLIB_CLI_COMMAND (set_node_fn_command, static) = {
   .function = set_node_fn,
 };
 
+static clib_error_t *
+set_node_batching (vlib_main_t *vm, unformat_input_t *input,
+		   vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  u32 node_index = ~0, budget_us = ~0, min_vectors = VLIB_FRAME_SIZE / 8;
+  clib_error_t *err = 0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "budget %u", &budget_us))
+	;
+      else if (unformat (line_input, "min-vectors %u", &min_vectors))
+	;
+      else if (unformat (line_input, "disable"))
+	budget_us = 0;
+      else if (unformat (line_input, "%U", unformat_vlib_node, vm,
+			 &node_index))
+	;
+      else
+	{
+	  err = clib_error_return (0, "unknown input '%U'",
+				   format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (node_index == ~0)
+    {
+      err = clib_error_return (0, "please specify valid node name");
+      goto done;
+    }
+  if (budget_us == ~0)
+    {
+      err = clib_error_return (0, "please specify budget or disable");
+      goto done;
+    }
+
+  err = vlib_node_set_batching (vm, node_index, budget_us, min_vectors);
+
+done:
+  unformat_free (line_input);
+  return err;
+}
+
+VLIB_CLI_COMMAND (set_node_batching_command, static) = {
+  .path = "set node batching",
+  .short_help = "set node batching <node-name> "
+		"(budget <usec> [min-vectors <n>] | disable)",
+  .function = set_node_batching,
+};
+
+static clib_error_t *
+show_node_batching (vlib_main_t *vm, unformat_input_t *input,
+		    vlib_cli_command_t *cmd)
+{
+  vlib_node_batch_t *b;
+  vlib_node_t *n;
+  f64 clocks_per_us;
+  u32 i;
+
+  vlib_cli_output (vm, "%-30s%-20s%8s%8s%10s%10s%12s%10s%10s", "Name",
+		   "Thread", "Budget", "Min", "Before", "Vec/Call",
+		   "Skipped", "Held", "Hold us");
+
+  foreach_vlib_main ()
+    {
+      vlib_node_main_t *nm = &this_vlib_main->node_main;
+
+      clocks_per_us = this_vlib_main->clib_time.clocks_per_second * 1e-6;
+
+      vec_foreach_index (i, nm->node_batch)
+	{
+	  n = vlib_get_node (this_vlib_main, i);
+	  if (!(n->flags & VLIB_NODE_FLAG_BATCH))
+	    continue;
+
+	  /* vectors per call before batching and since, and for calls made
+	     after a hold, with the time the oldest packet could have been
+	     held for */
+	  b = vec_elt_at_index (nm->node_batch, i);
+	  vlib_cli_output (
+	    vm, "%-30v%-20v%8.1f%8u%10.2f%10.2f%12llu%10.2f%10.2f", n->name,
+	    vlib_worker_threads[this_vlib_main->thread_index].name,
+	    b->budget_clocks / clocks_per_us, b->min_vectors,
+	    b->calls_before ? (f64) b->vectors_before / b->calls_before : 0.0,
+	    b->n_calls ? (f64) b->n_vectors / b->n_calls : 0.0, b->n_skipped,
+	    b->n_held_calls ? (f64) b->held_vectors / b->n_held_calls : 0.0,
+	    b->n_held_calls ?
+	      (f64) b->held_clocks / b->n_held_calls / clocks_per_us :
+	      0.0);
+	}
+    }
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_node_batching_command, static) = {
+  .path = "show node batching",
+  .short_help = "show node batching",
+  .function = show_node_batching,
+};
+
 /* Dummy function to get us linked in. */
 void
 vlib_node_cli_reference (void)
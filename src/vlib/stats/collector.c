@@ -128,6 +128,98 @@ update_node_counters (vlib_stats_segment_t *sm)
   vec_free (stat_vms);
 }
 
+static void
+snapshot_simple_counters (vlib_stats_snapshot_entry_t *se, counter_t **c)
+{
+  counter_t *t = se->data;
+  u32 i, j, n = 0;
+
+  for (i = 0; i < vec_len (c); i++)
+    n = clib_max (n, vec_len (c[i]));
+
+  vec_validate_aligned (t, n, CLIB_CACHE_LINE_BYTES);
+  vec_set_len (t, n);
+  clib_memset (t, 0, n * sizeof (t[0]));
+
+  for (i = 0; i < vec_len (c); i++)
+    for (j = 0; j < vec_len (c[i]); j++)
+      t[j] += c[i][j];
+
+  se->data = t;
+}
+
+static void
+snapshot_combined_counters (vlib_stats_snapshot_entry_t *se,
+			    vlib_counter_t **c)
+{
+  vlib_counter_t *t = se->data;
+  u32 i, j, n = 0;
+
+  for (i = 0; i < vec_len (c); i++)
+    n = clib_max (n, vec_len (c[i]));
+
+  vec_validate_aligned (t, n, CLIB_CACHE_LINE_BYTES);
+  vec_set_len (t, n);
+  clib_memset (t, 0, n * sizeof (t[0]));
+
+  for (i = 0; i < vec_len (c); i++)
+    for (j = 0; j < vec_len (c[i]); j++)
+      {
+	t[j].packets += c[i][j].packets;
+	t[j].bytes += c[i][j].bytes;
+      }
+
+  se->data = t;
+}
+
+/*
+ * Add up the per thread counter vectors into the snapshot not in use,
+ * then publish it. Clients read consistent totals from it without
+ * walking the per thread vectors, and without the segment lock, so
+ * neither they nor we bump the epoch.
+ */
+static void
+update_snapshot (vlib_stats_segment_t *sm)
+{
+  vlib_stats_snapshot_t *s = sm->snapshots[sm->snapshot_next];
+  vlib_stats_snapshot_entry_t *se;
+  vlib_stats_entry_t *e;
+  void *oldheap;
+  u32 i;
+
+  oldheap = clib_mem_set_heap (sm->heap);
+
+  __atomic_store_n (&s->generation, s->generation + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+
+  s->epoch = sm->shared_header->epoch;
+  vec_validate (s->entries, vec_len (sm->directory_vector) - 1);
+
+  for (i = 0; i < vec_len (sm->directory_vector); i++)
+    {
+      e = sm->directory_vector + i;
+      se = s->entries + i;
+
+      /* the entry was reused for another type since */
+      if (se->type != e->type)
+	{
+	  vec_free (se->data);
+	  se->type = e->type;
+	}
+
+      if (e->type == STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE)
+	snapshot_simple_counters (se, e->data);
+      else if (e->type == STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED)
+	snapshot_combined_counters (se, e->data);
+    }
+
+  __atomic_store_n (&s->generation, s->generation + 1, __ATOMIC_RELEASE);
+  __atomic_store_n (&sm->shared_header->snapshot, s, __ATOMIC_RELEASE);
+  sm->snapshot_next ^= 1;
+
+  clib_mem_set_heap (oldheap);
+}
+
 static void
 do_stat_segment_updates (vlib_main_t *vm, vlib_stats_segment_t *sm)
 {
@@ -146,6 +238,10 @@ do_stat_segment_updates (vlib_main_t *vm, vlib_stats_segment_t *sm)
       c->fn (&data);
     }
 
+  /* after the collectors, so their counters are current too */
+  if (sm->snapshots_enabled)
+    update_snapshot (sm);
+
   /* Heartbeat, so clients detect we're still here */
   sm->directory_vector[STAT_COUNTER_HEARTBEAT].value++;
 }
@@ -169,6 +265,16 @@ stat_segment_collector_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
 	}
     }
 
+  if (sm->snapshots_enabled)
+    for (int x = 0; x < ARRAY_LEN (sm->snapshots); x++)
+      {
+	void *oldheap = clib_mem_set_heap (sm->heap);
+	sm->snapshots[x] = clib_mem_alloc_aligned (sizeof (*sm->snapshots[x]),
+						   CLIB_CACHE_LINE_BYTES);
+	clib_memset (sm->snapshots[x], 0, sizeof (*sm->snapshots[x]));
+	clib_mem_set_heap (oldheap);
+      }
+
   sm->directory_vector[STAT_COUNTER_BOOTTIME].value = unix_time_now ();
 
   while (1)
@@ -157,6 +157,10 @@ statseg_config (vlib_main_t *vm, unformat_input_t *input)
 	sm->node_counters_enabled = 1;
       else if (unformat (input, "per-node-counters off"))
 	sm->node_counters_enabled = 0;
+      else if (unformat (input, "aggregate-counters on"))
+	sm->snapshots_enabled = 1;
+      else if (unformat (input, "aggregate-counters off"))
+	sm->snapshots_enabled = 0;
       else if (unformat (input, "update-interval %f", &sm->update_interval))
 	;
       else
@@ -35,6 +35,31 @@ typedef struct
   char name[VLIB_STATS_MAX_NAME_SZ];
 } vlib_stats_entry_t;
 
+/*
+ * Totals over all threads of a counter vector, for the directory entry
+ * of the same index.
+ */
+typedef struct
+{
+  stat_directory_type_t type;
+  void *data;
+} vlib_stats_snapshot_entry_t;
+
+/*
+ * Aggregated snapshot of the counter vectors, taken by the collector.
+ * There are two, written in turn, and the one last written is published
+ * in the shared header, so a reader finds it complete unless it takes
+ * longer than an update interval. Clients map the segment read only and
+ * cannot pin the one they read: the generation is odd while the snapshot
+ * is written, and a reader checks it did not change while it read.
+ */
+typedef struct
+{
+  volatile uint64_t generation;
+  uint64_t epoch;
+  vlib_stats_snapshot_entry_t *entries;
+} vlib_stats_snapshot_t;
+
 /*
  * Shared header first in the shared memory segment.
  */
@@ -45,6 +70,8 @@ typedef struct
   volatile uint64_t epoch;
   volatile uint64_t in_progress;
   volatile vlib_stats_entry_t *directory_vector;
+  /* 0 unless aggregated snapshots are enabled, or from an older vpp */
+  volatile vlib_stats_snapshot_t *snapshot;
 } vlib_stats_shared_header_t;
 
 #endif /* included_stat_segment_shared_h */
@@ -77,6 +77,12 @@ typedef struct
   ssize_t memory_size;
   clib_mem_page_sz_t log2_page_sz;
   u8 node_counters_enabled;
+
+  /* aggregated counter snapshots, written in turn */
+  u8 snapshots_enabled;
+  u8 snapshot_next;
+  vlib_stats_snapshot_t *snapshots[2];
+
   void *heap;
   vlib_stats_shared_header_t
     *shared_header; /* pointer to shared memory segment */
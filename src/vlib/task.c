@@ -0,0 +1,211 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+
+static_always_inline void
+vlib_task_set_state (vlib_task_main_t *tm, vlib_task_t *t,
+		     vlib_task_state_t state)
+{
+  tm->n_tasks_by_state[t->state]--;
+  tm->n_tasks_by_state[state]++;
+  t->state = state;
+}
+
+static_always_inline void
+vlib_task_make_ready (vlib_task_main_t *tm, vlib_task_t *t)
+{
+  vlib_task_set_state (tm, t, VLIB_TASK_STATE_READY);
+  vec_add1 (tm->ready, t->index);
+}
+
+static void
+vlib_task_free (vlib_task_main_t *tm, vlib_task_t *t)
+{
+  tm->n_tasks_by_state[t->state]--;
+  pool_put (tm->tasks, t);
+}
+
+u32
+vlib_task_create (vlib_main_t *vm, vlib_task_function_t *fn, void *data)
+{
+  vlib_task_main_t *tm = &vm->task_main;
+  vlib_task_t *t;
+
+  ASSERT (vlib_get_thread_index () == 0);
+
+  pool_get (tm->tasks, t);
+  t->function = fn;
+  t->data = data;
+  t->resume_point = 0;
+  t->index = t - tm->tasks;
+  t->stop_timer_handle = ~0;
+  t->is_signalled = 0;
+  t->signal_data = 0;
+
+  /* counted as running until made ready */
+  t->state = VLIB_TASK_STATE_RUNNING;
+  tm->n_tasks_by_state[t->state]++;
+  vlib_task_make_ready (tm, t);
+
+  tm->n_created++;
+  return t->index;
+}
+
+static void
+vlib_task_stop_timer (vlib_main_t *vm, vlib_task_t *t)
+{
+  if (t->stop_timer_handle == ~0)
+    return;
+  vlib_tw_timer_stop (vm, t->stop_timer_handle);
+  t->stop_timer_handle = ~0;
+}
+
+void
+vlib_task_kill (vlib_main_t *vm, u32 task_index)
+{
+  vlib_task_main_t *tm = &vm->task_main;
+  vlib_task_t *t = pool_elt_at_index (tm->tasks, task_index);
+
+  /* a task finishes itself with VLIB_TASK_EXIT */
+  ASSERT (t->state != VLIB_TASK_STATE_RUNNING);
+
+  vlib_task_stop_timer (vm, t);
+
+  /* still in the ready vector, freed when it comes up */
+  if (t->state == VLIB_TASK_STATE_READY)
+    vlib_task_set_state (tm, t, VLIB_TASK_STATE_KILLED);
+  else if (t->state != VLIB_TASK_STATE_KILLED)
+    vlib_task_free (tm, t);
+}
+
+void
+vlib_task_signal (vlib_main_t *vm, u32 task_index, uword data)
+{
+  vlib_task_main_t *tm = &vm->task_main;
+  vlib_task_t *t = pool_elt_at_index (tm->tasks, task_index);
+
+  ASSERT (vlib_get_thread_index () == 0);
+
+  if (t->state == VLIB_TASK_STATE_KILLED)
+    return;
+
+  t->is_signalled = 1;
+  t->signal_data = data;
+
+  if (t->state == VLIB_TASK_STATE_WAITING)
+    {
+      vlib_task_stop_timer (vm, t);
+      vlib_task_make_ready (tm, t);
+    }
+}
+
+void
+vlib_task_yield (vlib_main_t *vm, vlib_task_t *t)
+{
+  vlib_task_make_ready (&vm->task_main, t);
+}
+
+int
+vlib_task_suspend (vlib_main_t *vm, vlib_task_t *t, f64 dt, int is_wait)
+{
+  vlib_task_main_t *tm = &vm->task_main;
+  vlib_tw_event_t e = { .type = VLIB_TW_EVENT_T_TASK, .index = t->index };
+  u64 ticks;
+
+  ASSERT (t->state == VLIB_TASK_STATE_RUNNING);
+
+  if (is_wait && t->is_signalled)
+    return 0;
+
+  vlib_task_set_state (tm, t,
+		       is_wait ? VLIB_TASK_STATE_WAITING :
+				 VLIB_TASK_STATE_SLEEPING);
+
+  if (dt > 0 || !is_wait)
+    {
+      ticks = clib_max (dt * VLIB_TW_TICKS_PER_SECOND, 1);
+      t->stop_timer_handle = vlib_tw_timer_start (vm, e, ticks);
+    }
+  return 1;
+}
+
+void
+vlib_task_timer_expired (vlib_main_t *vm, u32 task_index)
+{
+  vlib_task_main_t *tm = &vm->task_main;
+  vlib_task_t *t = pool_elt_at_index (tm->tasks, task_index);
+
+  t->stop_timer_handle = ~0;
+  vlib_task_make_ready (tm, t);
+}
+
+void
+vlib_task_run_ready (vlib_main_t *vm)
+{
+  vlib_task_main_t *tm = &vm->task_main;
+  vlib_task_t *t;
+  uword rv;
+  u32 *i;
+
+  /* tasks made ready while these run wait for the next main loop */
+  CLIB_SWAP (tm->ready, tm->running);
+
+  vec_foreach (i, tm->running)
+    {
+      t = pool_elt_at_index (tm->tasks, i[0]);
+
+      if (t->state == VLIB_TASK_STATE_KILLED)
+	{
+	  vlib_task_free (tm, t);
+	  continue;
+	}
+
+      ASSERT (t->state == VLIB_TASK_STATE_READY);
+      vlib_task_set_state (tm, t, VLIB_TASK_STATE_RUNNING);
+
+      tm->current_task_index = i[0];
+      rv = t->function (vm, t);
+      tm->current_task_index = ~0;
+      tm->n_resumes++;
+
+      /* the task may have created tasks, moving the pool */
+      t = pool_elt_at_index (tm->tasks, i[0]);
+
+      if (rv == VLIB_TASK_DONE)
+	{
+	  vlib_task_stop_timer (vm, t);
+	  vlib_task_free (tm, t);
+	  tm->n_done++;
+	}
+      else
+	ASSERT (t->state != VLIB_TASK_STATE_RUNNING);
+    }
+
+  vec_reset_length (tm->running);
+}
+
+static clib_error_t *
+show_tasks_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		       vlib_cli_command_t *cmd)
+{
+  vlib_task_main_t *tm = &vm->task_main;
+
+  vlib_cli_output (vm, "%u tasks: %u ready, %u sleeping, %u waiting",
+		   pool_elts (tm->tasks),
+		   tm->n_tasks_by_state[VLIB_TASK_STATE_READY],
+		   tm->n_tasks_by_state[VLIB_TASK_STATE_SLEEPING],
+		   tm->n_tasks_by_state[VLIB_TASK_STATE_WAITING]);
+  vlib_cli_output (vm, "created %lu, done %lu, resumes %lu", tm->n_created,
+		   tm->n_done, tm->n_resumes);
+  vlib_cli_output (vm, "memory %U", format_memory_size,
+		   pool_elts (tm->tasks) * sizeof (vlib_task_t));
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_tasks_command, static) = {
+  .path = "show tasks",
+  .short_help = "show tasks",
+  .function = show_tasks_command_fn,
+};
@@ -0,0 +1,172 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+/*
+ * Stackless tasks.
+ *
+ * A task is a function which is called again each time it resumes, and
+ * continues where it suspended: a switch on the line it suspended at,
+ * as set up by the VLIB_TASK_* macros. Tasks have no stack of their own,
+ * so a task costs a few dozen bytes and switching to it a function call;
+ * the main thread can run hundreds of thousands of them.
+ *
+ * Local variables do not survive a suspension: keep state in the task's
+ * data. A task may not suspend from a function it calls, nor from inside
+ * a switch statement of its own.
+ *
+ *   static uword
+ *   my_task_fn (vlib_main_t *vm, vlib_task_t *t)
+ *   {
+ *     my_state_t *s = t->data;
+ *
+ *     VLIB_TASK_BEGIN (t);
+ *     for (s->n_tries = 0; s->n_tries < 3; s->n_tries++)
+ *       {
+ *         send_request (s);
+ *         VLIB_TASK_WAIT (vm, t, 1.0);
+ *         if (vlib_task_get_signal (t, &s->reply))
+ *           break;
+ *       }
+ *     my_state_free (s);
+ *     VLIB_TASK_END (t);
+ *   }
+ *
+ * Tasks run on the main thread, after process nodes, in the order they
+ * became ready. Timeouts use the main thread's timing wheel.
+ */
+
+#ifndef included_vlib_task_h
+#define included_vlib_task_h
+
+#include <vppinfra/clib.h>
+#include <vppinfra/pool.h>
+
+struct vlib_task_t;
+
+typedef uword (vlib_task_function_t) (struct vlib_main_t *vm,
+				      struct vlib_task_t *t);
+
+typedef enum
+{
+  VLIB_TASK_SUSPENDED = 0,
+  VLIB_TASK_DONE = 1,
+} vlib_task_return_t;
+
+typedef enum
+{
+  VLIB_TASK_STATE_READY,
+  VLIB_TASK_STATE_RUNNING,
+  VLIB_TASK_STATE_SLEEPING,
+  VLIB_TASK_STATE_WAITING,
+  VLIB_TASK_STATE_KILLED,
+  VLIB_TASK_N_STATE,
+} vlib_task_state_t;
+
+typedef struct vlib_task_t
+{
+  vlib_task_function_t *function;
+
+  /* Caller's state, not freed with the task. */
+  void *data;
+
+  /* Line the task suspended at, 0 before it runs. */
+  u32 resume_point;
+
+  u32 index;
+  u32 stop_timer_handle;
+  u8 state;
+  u8 is_signalled;
+  uword signal_data;
+} vlib_task_t;
+
+typedef struct
+{
+  /* Pool of tasks. */
+  vlib_task_t *tasks;
+
+  /* Indices of tasks ready to run, and of those being run. */
+  u32 *ready;
+  u32 *running;
+
+  /* Running task or ~0. */
+  u32 current_task_index;
+
+  u32 n_tasks_by_state[VLIB_TASK_N_STATE];
+  u64 n_created;
+  u64 n_done;
+  u64 n_resumes;
+} vlib_task_main_t;
+
+u32 vlib_task_create (struct vlib_main_t *vm, vlib_task_function_t *fn,
+		      void *data);
+void vlib_task_kill (struct vlib_main_t *vm, u32 task_index);
+void vlib_task_signal (struct vlib_main_t *vm, u32 task_index, uword data);
+
+/* for the VLIB_TASK_* macros */
+void vlib_task_yield (struct vlib_main_t *vm, vlib_task_t *t);
+int vlib_task_suspend (struct vlib_main_t *vm, vlib_task_t *t, f64 dt,
+		       int is_wait);
+void vlib_task_timer_expired (struct vlib_main_t *vm, u32 task_index);
+void vlib_task_run_ready (struct vlib_main_t *vm);
+
+/* Take the signal the task got, returns 0 if it was not signalled. */
+static_always_inline int
+vlib_task_get_signal (vlib_task_t *t, uword *data)
+{
+  if (!t->is_signalled)
+    return 0;
+  t->is_signalled = 0;
+  if (data)
+    *data = t->signal_data;
+  return 1;
+}
+
+#define VLIB_TASK_BEGIN(t)                                                    \
+  switch ((t)->resume_point)                                                  \
+    {                                                                         \
+    case 0:
+
+#define VLIB_TASK_END(t)                                                      \
+  }                                                                           \
+  return VLIB_TASK_DONE
+
+#define _VLIB_TASK_SUSPEND(t)                                                 \
+  (t)->resume_point = __LINE__;                                               \
+  return VLIB_TASK_SUSPENDED;                                                 \
+  case __LINE__:
+
+/* Run the tasks which are ready, then this one again. */
+#define VLIB_TASK_YIELD(vm, t)                                                \
+  do                                                                          \
+    {                                                                         \
+      vlib_task_yield (vm, t);                                                \
+      _VLIB_TASK_SUSPEND (t);                                                 \
+    }                                                                         \
+  while (0)
+
+/* Suspend for dt seconds. */
+#define VLIB_TASK_SLEEP(vm, t, dt)                                            \
+  do                                                                          \
+    {                                                                         \
+      vlib_task_suspend (vm, t, dt, 0);                                       \
+      _VLIB_TASK_SUSPEND (t);                                                 \
+    }                                                                         \
+  while (0)
+
+/* Suspend until signalled, or for at most dt seconds if dt > 0. Does not
+   suspend if a signal is pending; see vlib_task_get_signal(). */
+#define VLIB_TASK_WAIT(vm, t, dt)                                             \
+  do                                                                          \
+    {                                                                         \
+      if (vlib_task_suspend (vm, t, dt, 1))                                   \
+	{                                                                     \
+	  _VLIB_TASK_SUSPEND (t);                                             \
+	}                                                                     \
+    }                                                                         \
+  while (0)
+
+/* Finish the task. */
+#define VLIB_TASK_EXIT(t) return VLIB_TASK_DONE
+
+#endif /* included_vlib_task_h */
@@ -27,6 +27,7 @@
 #include <vlib/vlib.h>
 
 #include <vlib/threads.h>
+#include <vlib/aqm.h>
 
 #include <vlib/stats/stats.h>
 
@@ -441,6 +442,11 @@ vlib_worker_thread_init (vlib_worker_thread_t * w)
 
   clib_mem_set_heap (w->thread_mheap);
 
+  /* pages this thread touches first come from its own node */
+  if (tm->numa_local && w->numa_id >= 0 &&
+      clib_mem_set_numa_affinity (w->numa_id, 0 /* preferred */))
+    clib_warning ("Failed to set the worker numa affinity");
+
   if (vec_len (tm->thread_prefix) && w->registration->short_name)
     {
       w->name = format (0, "%v_%s_%d%c", tm->thread_prefix,
@@ -525,18 +531,22 @@ vlib_launch_thread_int (void *fp, vlib_worker_thread_t * w, unsigned cpu_id)
   cpu_set_t cpuset;
   void *(*fp_arg) (void *) = fp;
   void *numa_heap;
+  uword numa_heap_size = tm->numa_heap_size;
 
   w->cpu_id = cpu_id;
   vlib_get_thread_core_numa (w, cpu_id);
 
+  if (numa_heap_size == 0 && tm->numa_local)
+    numa_heap_size = VLIB_THREAD_NUMA_LOCAL_HEAP_SIZE;
+
   /* Set up NUMA-bound heap if indicated */
   if (mm->per_numa_mheaps[w->numa_id] == 0)
     {
       /* If the user requested a NUMA heap, create it... */
-      if (tm->numa_heap_size)
+      if (numa_heap_size)
 	{
 	  clib_mem_set_numa_affinity (w->numa_id, 1 /* force */ );
-	  numa_heap = clib_mem_create_heap (0 /* DIY */ , tm->numa_heap_size,
+	  numa_heap = clib_mem_create_heap (0 /* DIY */ , numa_heap_size,
 					    1 /* is_locked */ ,
 					    "numa %u heap", w->numa_id);
 	  clib_mem_set_default_numa_affinity ();
@@ -605,6 +615,8 @@ start_workers (vlib_main_t * vm)
   vgm->elog_main.lock =
     clib_mem_alloc_aligned (CLIB_CACHE_LINE_BYTES, CLIB_CACHE_LINE_BYTES);
   vgm->elog_main.lock[0] = 0;
+  if (vgm->elog_thread_rings)
+    elog_thread_rings_enable (&vgm->elog_main, n_vlib_mains);
 
   clib_callback_data_init (&vm->vlib_node_runtime_perf_callbacks,
 			   &vm->worker_thread_main_loop_callback_lock);
@@ -768,6 +780,7 @@ start_workers (vlib_main_t * vm)
 
 	      nm_clone->processes = vec_dup_aligned (nm->processes,
 						     CLIB_CACHE_LINE_BYTES);
+	      nm_clone->node_batch = vec_dup (nm->node_batch);
 
 	      /* Create per-thread frame freelist */
 	      nm_clone->frame_sizes = 0;
@@ -1148,6 +1161,8 @@ cpu_config (vlib_main_t * vm, unformat_input_t * input)
       else if (unformat (input, "numa-heap-size %U",
 			 unformat_memory_size, &tm->numa_heap_size))
 	;
+      else if (unformat (input, "numa-local"))
+	tm->numa_local = 1;
       else if (unformat (input, "coremask-%s %U", &name,
 			 unformat_bitmap_mask, &bitmap) ||
 	       unformat (input, "corelist-%s %U", &name,
@@ -1642,6 +1657,129 @@ vlib_worker_flush_pending_rpc_requests (vlib_main_t *vm)
   clib_spinlock_unlock_if_init (&vm_global->pending_rpc_lock);
 }
 
+vlib_rcu_main_t vlib_rcu_main;
+
+/* oldest epoch a worker may still hold references from */
+static u64
+vlib_rcu_min_epoch (void)
+{
+  u64 epoch, min_epoch = VLIB_RCU_EPOCH_OFFLINE;
+  u32 ii;
+
+  for (ii = 1; ii < vlib_get_n_threads (); ii++)
+    {
+      epoch = __atomic_load_n (&vlib_get_main_by_index (ii)->rcu_epoch,
+			       __ATOMIC_ACQUIRE);
+      min_epoch = clib_min (min_epoch, epoch);
+    }
+
+  return min_epoch;
+}
+
+void
+vlib_rcu_call (vlib_rcu_fn_t *fn, void *args, u32 size)
+{
+  vlib_rcu_main_t *rm = &vlib_rcu_main;
+  vlib_rcu_callback_t *c;
+
+  /* with the workers held at the barrier, or none, no one can be
+     reading the data; unless callbacks are pending, which run first */
+  if (vlib_get_thread_index () == 0 && vlib_worker_thread_barrier_held () &&
+      rm->n_calls == rm->n_completed)
+    {
+      fn (args);
+      return;
+    }
+
+  clib_spinlock_lock_if_init (&rm->lock);
+
+  vec_add2 (rm->pending, c, 1);
+  c->fn = fn;
+  c->args = 0;
+  vec_add (c->args, args, size);
+
+  /* the caller has unpublished the data, a worker that sees the new
+     epoch can no longer find it */
+  c->epoch = __atomic_add_fetch (&rm->epoch, 1, __ATOMIC_SEQ_CST);
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+  rm->n_calls++;
+
+  clib_spinlock_unlock_if_init (&rm->lock);
+}
+
+void
+vlib_rcu_poll (vlib_main_t *vm)
+{
+  vlib_rcu_main_t *rm = &vlib_rcu_main;
+  vlib_rcu_callback_t *c;
+  u64 epoch, min_epoch;
+  u32 n_ready, n_pending;
+
+  ASSERT (vlib_get_thread_index () == 0);
+
+  if (PREDICT_TRUE (rm->n_calls == rm->n_completed))
+    return;
+
+  /* only the callbacks queued before the workers are scanned can be
+     released: one queued after, maybe on another thread, is not covered
+     by the scan of a worker that came online in between */
+  clib_spinlock_lock_if_init (&rm->lock);
+  epoch = rm->epoch;
+  n_pending = vec_len (rm->pending);
+  clib_spinlock_unlock_if_init (&rm->lock);
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+  /* an offline worker counts as ~0, so clamp to the snapshot */
+  min_epoch = clib_min (vlib_rcu_min_epoch (), epoch);
+
+  clib_spinlock_lock_if_init (&rm->lock);
+  for (n_ready = 0; n_ready < n_pending; n_ready++)
+    if (rm->pending[n_ready].epoch > min_epoch)
+      break;
+  if (n_ready)
+    {
+      vec_add (rm->ready, rm->pending, n_ready);
+      vec_delete (rm->pending, n_ready, 0);
+    }
+  clib_spinlock_unlock_if_init (&rm->lock);
+
+  /* callbacks may call vlib_rcu_call, so run them unlocked */
+  vec_foreach (c, rm->ready)
+    {
+      c->fn (c->args);
+      vec_free (c->args);
+    }
+
+  rm->n_completed += vec_len (rm->ready);
+  vec_reset_length (rm->ready);
+}
+
+static void
+vlib_rcu_vec_free_cb (void *args)
+{
+  void *v = *(void **) args;
+  vec_free (v);
+}
+
+void
+vlib_rcu_vec_free_fn (void *v)
+{
+  vlib_rcu_call (vlib_rcu_vec_free_cb, &v, sizeof (v));
+}
+
+static void
+vlib_rcu_pool_free_cb (void *args)
+{
+  void *p = *(void **) args;
+  pool_free (p);
+}
+
+void
+vlib_rcu_pool_free_fn (void *p)
+{
+  vlib_rcu_call (vlib_rcu_pool_free_cb, &p, sizeof (p));
+}
+
 extern clib_march_fn_registration
   *vlib_frame_queue_dequeue_with_aux_fn_march_fn_registrations;
 extern clib_march_fn_registration
@@ -1680,6 +1818,7 @@ vlib_frame_queue_main_init (u32 node_index, u32 frame_queue_nelts)
 
   fqm->node_index = node_index;
   fqm->frame_queue_nelts = frame_queue_nelts;
+  fqm->aqm_index = ~0;
 
   vec_validate (fqm->vlib_frame_queues, tm->n_vlib_mains - 1);
   vec_set_len (fqm->vlib_frame_queues, 0);
@@ -1692,6 +1831,111 @@ vlib_frame_queue_main_init (u32 node_index, u32 frame_queue_nelts)
   return (fqm - tm->frame_queue_mains);
 }
 
+clib_error_t *
+vlib_frame_queue_set_steal_mode (u32 frame_queue_index,
+				 vlib_frame_queue_steal_mode_t mode,
+				 u32 threshold)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  vlib_main_t *vm = vlib_get_main ();
+  vlib_frame_queue_main_t *fqm;
+  vlib_frame_queue_t *fq;
+  int i;
+
+  if (frame_queue_index >= vec_len (tm->frame_queue_mains))
+    return clib_error_return (0, "no frame queue %u", frame_queue_index);
+
+  fqm = vec_elt_at_index (tm->frame_queue_mains, frame_queue_index);
+
+  if (mode != VLIB_FRAME_QUEUE_STEAL_NONE && fqm->aqm_index != ~0)
+    return clib_error_return (0, "frame queue %u has AQM", frame_queue_index);
+
+  /* congested once more than a quarter of the ring is in use */
+  if (threshold == 0)
+    threshold = clib_max (fqm->frame_queue_nelts / 4, 1);
+  if (threshold >= fqm->frame_queue_nelts)
+    return clib_error_return (0, "threshold must be below the ring size %u",
+			      fqm->frame_queue_nelts);
+
+  /* no thread may be half way through an element when the rules change */
+  vlib_worker_thread_barrier_sync (vm);
+
+  fqm->steal_mode = mode;
+  fqm->steal_threshold = threshold;
+
+  vec_validate (fqm->held_groups, tm->n_vlib_mains - 1);
+  for (i = 0; i < tm->n_vlib_mains; i++)
+    {
+      vec_validate (fqm->held_groups[i], 2 * tm->n_vlib_mains - 1);
+      vec_reset_length (fqm->held_groups[i]);
+      fq = fqm->vlib_frame_queues[i];
+      vec_validate (fq->group_owners, tm->n_vlib_mains - 1);
+      clib_memset ((void *) fq->group_owners, 0,
+		   vec_bytes (fq->group_owners));
+    }
+
+  vlib_worker_thread_barrier_release (vm);
+  return 0;
+}
+
+/*
+ * AQM state is per queue and not locked, so each queue must only be
+ * drained by its own thread.
+ */
+clib_error_t *
+vlib_frame_queue_set_aqm (u32 frame_queue_index, const vlib_aqm_config_t *c)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  vlib_main_t *vm = vlib_get_main ();
+  vlib_frame_queue_main_t *fqm;
+  u32 aqm_index = ~0, old_aqm_index;
+  clib_error_t *error;
+
+  if (frame_queue_index >= vec_len (tm->frame_queue_mains))
+    return clib_error_return (0, "no frame queue %u", frame_queue_index);
+
+  fqm = vec_elt_at_index (tm->frame_queue_mains, frame_queue_index);
+
+  if (c->type != VLIB_AQM_NONE)
+    {
+      if (fqm->steal_mode != VLIB_FRAME_QUEUE_STEAL_NONE)
+	return clib_error_return (0, "frame queue %u is stolen from",
+				  frame_queue_index);
+      error = vlib_aqm_create (c, &aqm_index, "frame-queue/%u",
+			       frame_queue_index);
+      if (error)
+	return error;
+    }
+
+  vlib_worker_thread_barrier_sync (vm);
+  old_aqm_index = fqm->aqm_index;
+  fqm->aqm_index = aqm_index;
+  vlib_worker_thread_barrier_release (vm);
+
+  if (old_aqm_index != ~0)
+    vlib_aqm_delete (old_aqm_index);
+
+  return 0;
+}
+
+u8 *
+format_vlib_frame_queue_steal_mode (u8 *s, va_list *args)
+{
+  vlib_frame_queue_steal_mode_t mode =
+    va_arg (*args, vlib_frame_queue_steal_mode_t);
+
+  switch (mode)
+    {
+    case VLIB_FRAME_QUEUE_STEAL_NONE:
+      return format (s, "off");
+    case VLIB_FRAME_QUEUE_STEAL_ANY:
+      return format (s, "any");
+    case VLIB_FRAME_QUEUE_STEAL_ORDERED:
+      return format (s, "ordered");
+    }
+  return format (s, "unknown %d", mode);
+}
+
 void
 vlib_process_signal_event_mt_helper (vlib_process_signal_event_mt_args_t *
 				     args)
@@ -1724,6 +1968,8 @@ threads_init (vlib_main_t * vm)
     return clib_error_return (0, "Configuration error, a main core must "
 				 "be specified when using worker threads");
 
+  clib_spinlock_init (&vlib_rcu_main.lock);
+
   return 0;
 }
 
@@ -1769,6 +2015,37 @@ VLIB_CLI_COMMAND (f_command, static) =
   .function = show_clock_command_fn,
 };
 
+static clib_error_t *
+show_rcu_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		     vlib_cli_command_t *cmd)
+{
+  vlib_rcu_main_t *rm = &vlib_rcu_main;
+  u64 epoch;
+
+  vlib_cli_output (vm, "epoch %llu, %llu calls, %llu completed",
+		   rm->epoch, rm->n_calls, rm->n_completed);
+
+  foreach_vlib_main ()
+    {
+      if (this_vlib_main->thread_index == 0)
+	continue;
+      epoch = this_vlib_main->rcu_epoch;
+      if (epoch == VLIB_RCU_EPOCH_OFFLINE)
+	vlib_cli_output (vm, "%d: offline", this_vlib_main->thread_index);
+      else
+	vlib_cli_output (vm, "%d: epoch %llu", this_vlib_main->thread_index,
+			 epoch);
+    }
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_rcu_command, static) = {
+  .path = "show rcu",
+  .short_help = "show rcu",
+  .function = show_rcu_command_fn,
+};
+
 vlib_thread_main_t *
 vlib_get_thread_main_not_inline (void)
 {
@@ -59,6 +59,9 @@ typedef struct
   u32 maybe_trace : 1;
   u32 n_vectors;
   u32 offset;
+  clib_thread_index_t producer;
+  /* when the element was handed over, only set for queues with AQM */
+  u64 enqueue_time;
   STRUCT_MARK (end_of_reset);
 
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
@@ -112,6 +115,10 @@ typedef struct
   u64 trace;
   u32 nelts;
 
+  /* owner of each producer's elements, thread index + 1, 0 if none.
+     Only used when stealing in order */
+  volatile u32 *group_owners;
+
   /* modified by enqueue side  */
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
   volatile u64 tail;
@@ -119,9 +126,29 @@ typedef struct
   /* modified by dequeue side  */
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline2);
   volatile u64 head;
+
+  /* occupancy seen by the owner each time it checks the queue */
+  u64 occupancy_sum;
+  u64 n_occupancy_samples;
+  u32 max_occupancy;
+
+  /* elements taken by other threads */
+  u64 n_stolen;
 }
 vlib_frame_queue_t;
 
+typedef enum
+{
+  /* each thread only dequeues from its own queue */
+  VLIB_FRAME_QUEUE_STEAL_NONE = 0,
+  /* idle threads take elements from congested queues, for nodes which
+     don't care which thread sees a packet, or in what order */
+  VLIB_FRAME_QUEUE_STEAL_ANY,
+  /* as above, but no two threads hold elements of the same producer at
+     once. A flow is handed off by one producer, so it stays in order */
+  VLIB_FRAME_QUEUE_STEAL_ORDERED,
+} vlib_frame_queue_steal_mode_t;
+
 struct vlib_frame_queue_main_t_;
 typedef u32 (vlib_frame_queue_dequeue_fn_t) (
   vlib_main_t *vm, struct vlib_frame_queue_main_t_ *fqm);
@@ -136,6 +163,17 @@ typedef struct vlib_frame_queue_main_t_
   frame_queue_trace_t *frame_queue_traces;
   frame_queue_nelt_counter_t *frame_queue_histogram;
   vlib_frame_queue_dequeue_fn_t *frame_queue_dequeue_fn;
+
+  /* work stealing */
+  vlib_frame_queue_steal_mode_t steal_mode;
+  u32 steal_threshold;
+  u32 next_thief;
+
+  /* per thread, producer groups held, as queue << 16 | producer */
+  u32 **held_groups;
+
+  /* active queue management of each thread's queue, ~0 if none */
+  u32 aqm_index;
 } vlib_frame_queue_main_t;
 
 typedef struct
@@ -155,6 +193,13 @@ void vlib_create_worker_threads (vlib_main_t * vm, int n,
 
 void vlib_worker_thread_init (vlib_worker_thread_t * w);
 u32 vlib_frame_queue_main_init (u32 node_index, u32 frame_queue_nelts);
+clib_error_t *
+vlib_frame_queue_set_steal_mode (u32 frame_queue_index,
+				 vlib_frame_queue_steal_mode_t mode,
+				 u32 threshold);
+format_function_t format_vlib_frame_queue_steal_mode;
+clib_error_t *vlib_frame_queue_set_aqm (u32 frame_queue_index,
+				       const struct vlib_aqm_config_t *c);
 
 /* Check for a barrier sync request every 30ms */
 #define BARRIER_SYNC_DELAY (0.030000)
@@ -186,6 +231,127 @@ void vlib_worker_wait_one_loop (void);
  */
 void vlib_worker_flush_pending_rpc_requests (vlib_main_t *vm);
 
+/*
+ * Epoch based reclamation.
+ *
+ * A control plane update that replaces data the workers read, a pool
+ * that grows or a vector of buckets, publishes the new copy and hands
+ * the old one to vlib_rcu_call instead of stopping the workers with the
+ * barrier. The callback runs on the main thread once every worker has
+ * been back to the top of its main loop, when none can still hold a
+ * reference to the old copy. Workers asleep in epoll are offline and do
+ * not hold up the callbacks.
+ *
+ * Updates that still take the barrier are those that change data the
+ * workers write, or rebuild structures in place rather than replacing
+ * them: growing the load-balance counters, which is amortised over the
+ * growth of the load-balance pool, and replacing an ACL that is applied,
+ * whose hash tables are rebuilt in place.
+ */
+
+#define VLIB_RCU_EPOCH_OFFLINE (~0ULL)
+
+typedef void (vlib_rcu_fn_t) (void *args);
+
+typedef struct
+{
+  /* runs once every worker has seen this epoch */
+  u64 epoch;
+  vlib_rcu_fn_t *fn;
+  u8 *args;
+} vlib_rcu_callback_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
+  /* bumped by each vlib_rcu_call, read by the workers each loop */
+  volatile u64 epoch;
+
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
+
+  /* callbacks in epoch order, appended to by any thread */
+  clib_spinlock_t lock;
+  vlib_rcu_callback_t *pending;
+
+  /* callbacks taken off pending by the main thread */
+  vlib_rcu_callback_t *ready;
+
+  u64 n_calls;
+  u64 n_completed;
+} vlib_rcu_main_t;
+
+extern vlib_rcu_main_t vlib_rcu_main;
+
+/**
+ * Run fn with a copy of args on the main thread once no worker can
+ * still see data unpublished before the call; at once if the workers
+ * are held at the barrier. Callbacks run in the order they are made.
+ */
+void vlib_rcu_call (vlib_rcu_fn_t *fn, void *args, u32 size);
+/**
+ * Run the callbacks whose grace period has passed, from the main loop
+ */
+void vlib_rcu_poll (vlib_main_t *vm);
+/**
+ * Defer vec_free of a vector the workers may still read, once it has
+ * been replaced by a new one
+ */
+void vlib_rcu_vec_free_fn (void *v);
+#define vlib_rcu_vec_free(V)                                                  \
+  do                                                                          \
+    {                                                                         \
+      if (V)                                                                  \
+	vlib_rcu_vec_free_fn (V);                                             \
+      (V) = 0;                                                                \
+    }                                                                         \
+  while (0)
+/**
+ * Defer pool_free of a pool the workers may still read
+ */
+void vlib_rcu_pool_free_fn (void *p);
+
+/**
+ * Make room in a pool that the workers read without the barrier.
+ *
+ * If the next get would reallocate the pool, a bigger copy is published
+ * in its place and the old one freed after a grace period, so a worker
+ * never reads from freed memory. Workers must load the pool with
+ * vlib_rcu_deref, so that an index handed out after the copy is never
+ * applied to the old one.
+ */
+#define vlib_rcu_pool_expand(P, A)                                            \
+  do                                                                          \
+    {                                                                         \
+      if ((P) && pool_get_will_expand (P))                                    \
+	{                                                                     \
+	  __typeof__ (P) _rcu_old = (P), _rcu_new;                            \
+	  uword _rcu_align = clib_max ((A), vec_get_align (_rcu_old));        \
+	  _rcu_new = pool_dup_aligned (_rcu_old, _rcu_align);                 \
+	  pool_alloc_aligned (_rcu_new, clib_max (pool_len (_rcu_old), 16),   \
+			      _rcu_align);                                    \
+	  __atomic_store_n (&(P), _rcu_new, __ATOMIC_RELEASE);                \
+	  vlib_rcu_pool_free_fn (_rcu_old);                                   \
+	}                                                                     \
+    }                                                                         \
+  while (0)
+
+#define vlib_rcu_pool_get_aligned(P, E, A)                                    \
+  do                                                                          \
+    {                                                                         \
+      vlib_rcu_pool_expand (P, A);                                            \
+      pool_get_aligned (P, E, A);                                             \
+    }                                                                         \
+  while (0)
+
+#define vlib_rcu_pool_get(P, E) vlib_rcu_pool_get_aligned (P, E, 0)
+
+/**
+ * Load a pool or vector replaced by copy, from a worker. Pairs with the
+ * release store that publishes the copy.
+ */
+#define vlib_rcu_deref(P) __atomic_load_n (&(P), __ATOMIC_ACQUIRE)
+
 static_always_inline clib_thread_index_t
 vlib_get_thread_index (void)
 {
@@ -305,10 +471,27 @@ typedef struct
   /* NUMA-bound heap size */
   uword numa_heap_size;
 
+  /* Place rx queues and worker memory on the NIC's / worker's NUMA node */
+  u8 numa_local;
+
 } vlib_thread_main_t;
 
 extern vlib_thread_main_t vlib_thread_main;
 
+/* NUMA heap size in numa-local mode, unless numa-heap-size is set */
+#define VLIB_THREAD_NUMA_LOCAL_HEAP_SIZE (64 << 20)
+
+/* Heap on the given NUMA node, or the main heap if it has none */
+always_inline void *
+vlib_numa_heap (u32 numa_node)
+{
+  void *heap = 0;
+
+  if (numa_node < ARRAY_LEN (clib_mem_main.per_numa_mheaps))
+    heap = clib_mem_get_per_numa_heap (numa_node);
+  return heap ? heap : clib_mem_get_per_cpu_heap ();
+}
+
 #include <vlib/global_funcs.h>
 
 #define VLIB_REGISTER_THREAD(x,...)                     \
@@ -465,6 +648,37 @@ vlib_worker_thread_barrier_check (void)
     }
 }
 
+/*
+ * A worker at the top of its main loop holds no reference to data
+ * unpublished before the epoch it now reads.
+ */
+static_always_inline void
+vlib_rcu_quiescent (vlib_main_t *vm)
+{
+  u64 epoch = __atomic_load_n (&vlib_rcu_main.epoch, __ATOMIC_ACQUIRE);
+
+  if (PREDICT_FALSE (vm->rcu_epoch != epoch))
+    __atomic_store_n (&vm->rcu_epoch, epoch, __ATOMIC_RELEASE);
+}
+
+static_always_inline void
+vlib_rcu_offline (vlib_main_t *vm)
+{
+  __atomic_store_n (&vm->rcu_epoch, VLIB_RCU_EPOCH_OFFLINE, __ATOMIC_RELEASE);
+}
+
+static_always_inline void
+vlib_rcu_online (vlib_main_t *vm)
+{
+  __atomic_store_n (&vm->rcu_epoch,
+		    __atomic_load_n (&vlib_rcu_main.epoch, __ATOMIC_ACQUIRE),
+		    __ATOMIC_RELAXED);
+
+  /* a reclaimer either sees the worker online or the worker sees what
+     the reclaimer published */
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+}
+
 always_inline vlib_main_t *
 vlib_get_worker_vlib_main (u32 worker_index)
 {
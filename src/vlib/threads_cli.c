@@ -20,6 +20,7 @@
 #include <vlib/vlib.h>
 
 #include <vlib/threads.h>
+#include <vlib/aqm.h>
 #include <vlib/unix/unix.h>
 
 static u8 *
@@ -383,6 +384,181 @@ VLIB_CLI_COMMAND (cmd_show_frame_queue_histogram,static) = {
     .function = show_frame_queue_histogram,
 };
 
+static clib_error_t *
+show_frame_queue_occupancy (vlib_main_t *vm, unformat_input_t *input,
+			    vlib_cli_command_t *cmd)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  vlib_frame_queue_main_t *fqm;
+  vlib_frame_queue_t *fq;
+  u32 i;
+
+  vec_foreach (fqm, tm->frame_queue_mains)
+    {
+      vlib_cli_output (vm,
+		       "Worker handoff queue index %u (next node '%U'), "
+		       "steal %U, threshold %u:",
+		       fqm - tm->frame_queue_mains, format_vlib_node_name, vm,
+		       fqm->node_index, format_vlib_frame_queue_steal_mode,
+		       fqm->steal_mode, fqm->steal_threshold);
+      vlib_cli_output (vm, "  %-20s%8s%12s%8s%12s", "Thread", "Ring",
+		       "Avg in use", "Max", "Stolen");
+      for (i = 0; i < vec_len (fqm->vlib_frame_queues); i++)
+	{
+	  fq = fqm->vlib_frame_queues[i];
+	  vlib_cli_output (vm, "  %-20v%8u%12.2f%8u%12llu",
+			   vlib_worker_threads[i].name, fq->nelts,
+			   fq->n_occupancy_samples ?
+			     (f64) fq->occupancy_sum / fq->n_occupancy_samples :
+			     0.0,
+			   fq->max_occupancy, fq->n_stolen);
+	}
+      if (fqm->aqm_index != ~0)
+	vlib_cli_output (vm, "  aqm %U", format_vlib_aqm, fqm->aqm_index);
+    }
+  return 0;
+}
+
+VLIB_CLI_COMMAND (cmd_show_frame_queue_occupancy, static) = {
+  .path = "show frame-queue occupancy",
+  .short_help = "show frame-queue occupancy",
+  .function = show_frame_queue_occupancy,
+};
+
+static clib_error_t *
+clear_frame_queue_occupancy (vlib_main_t *vm, unformat_input_t *input,
+			     vlib_cli_command_t *cmd)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  vlib_frame_queue_main_t *fqm;
+  vlib_frame_queue_t *fq;
+  u32 i;
+
+  vec_foreach (fqm, tm->frame_queue_mains)
+    for (i = 0; i < vec_len (fqm->vlib_frame_queues); i++)
+      {
+	fq = fqm->vlib_frame_queues[i];
+	fq->occupancy_sum = 0;
+	fq->n_occupancy_samples = 0;
+	fq->max_occupancy = 0;
+	fq->n_stolen = 0;
+      }
+  return 0;
+}
+
+VLIB_CLI_COMMAND (cmd_clear_frame_queue_occupancy, static) = {
+  .path = "clear frame-queue occupancy",
+  .short_help = "clear frame-queue occupancy",
+  .function = clear_frame_queue_occupancy,
+};
+
+/*
+ * Let idle workers drain congested frame queues
+ */
+static clib_error_t *
+set_frame_queue_steal (vlib_main_t *vm, unformat_input_t *input,
+		       vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vlib_frame_queue_steal_mode_t mode = ~0;
+  clib_error_t *error = NULL;
+  u32 index = ~0, threshold = 0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "index %u", &index))
+	;
+      else if (unformat (line_input, "threshold %u", &threshold))
+	;
+      else if (unformat (line_input, "off"))
+	mode = VLIB_FRAME_QUEUE_STEAL_NONE;
+      else if (unformat (line_input, "any"))
+	mode = VLIB_FRAME_QUEUE_STEAL_ANY;
+      else if (unformat (line_input, "ordered"))
+	mode = VLIB_FRAME_QUEUE_STEAL_ORDERED;
+      else
+	{
+	  error = clib_error_return (0, "parse error: '%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (index == ~0 || mode == ~0)
+    {
+      error = clib_error_return (0, "expecting index and steal mode");
+      goto done;
+    }
+
+  error = vlib_frame_queue_set_steal_mode (index, mode, threshold);
+
+done:
+  unformat_free (line_input);
+
+  return error;
+}
+
+VLIB_CLI_COMMAND (cmd_set_frame_queue_steal, static) = {
+  .path = "set frame-queue steal",
+  .short_help = "set frame-queue steal index <n> (off|any|ordered) "
+		"[threshold <n>]",
+  .function = set_frame_queue_steal,
+};
+
+
+/*
+ * Drop from frame queues before they build a standing queue
+ */
+static clib_error_t *
+set_frame_queue_aqm (vlib_main_t *vm, unformat_input_t *input,
+		     vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vlib_aqm_config_t c = { .type = VLIB_AQM_N_TYPES };
+  clib_error_t *error = NULL;
+  u32 index = ~0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "index %u", &index))
+	;
+      else if (unformat (line_input, "%U", unformat_vlib_aqm_config, &c))
+	;
+      else
+	{
+	  error = clib_error_return (0, "parse error: '%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (index == ~0 || c.type == VLIB_AQM_N_TYPES)
+    {
+      error = clib_error_return (0, "expecting index and aqm type");
+      goto done;
+    }
+
+  error = vlib_frame_queue_set_aqm (index, &c);
+
+done:
+  unformat_free (line_input);
+
+  return error;
+}
+
+VLIB_CLI_COMMAND (cmd_set_frame_queue_aqm, static) = {
+  .path = "set frame-queue aqm",
+  .short_help = "set frame-queue aqm index <n> (off|codel|fq-codel|pie) "
+		"[target <us>] [interval <us>] [burst <us>] [alpha <f>] "
+		"[beta <f>] [flows <n>]",
+  .function = set_frame_queue_aqm,
+};
 
 /*
  * Modify the number of elements on the frame_queues
@@ -39,7 +39,11 @@
 
 #include <vlib/vlib.h>
 #include <vlib/threads.h>
+#include <vlib/unix/unix.h>
 #include <vnet/classify/vnet_classify.h>
+#include <vppinfra/random.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 
 u8 *vnet_trace_placeholder;
 
@@ -370,6 +374,7 @@ vlib_enable_disable_pkt_trace_filter (int enable)
 void
 vlib_trace_stop_and_clear (void)
 {
+  vlib_trace_sample_disable ();
   vlib_enable_disable_pkt_trace_filter (0);	/* disble tracing */
   clear_trace_buffer ();
 }
@@ -457,6 +462,13 @@ cli_add_trace_buffer (vlib_main_t * vm,
       goto done;
     }
 
+  if (vm->trace_main.sample_interval)
+    {
+      error = clib_error_create ("sampled tracing is on, see 'trace sample "
+				 "off'");
+      goto done;
+    }
+
   trace_update_capture_options (add, node_index, filter, verbose);
 
 done:
@@ -587,6 +599,396 @@ VLIB_CLI_COMMAND (clear_trace_cli,static) = {
   .function = cli_clear_trace_buffer,
 };
 
+typedef struct
+{
+  vlib_trace_ring_header_t *header;
+  uword size;
+  u8 *file;
+} vlib_trace_sample_main_t;
+
+static vlib_trace_sample_main_t vlib_trace_sample_main;
+
+/*
+ * Publish the record last handed out. Its trace data is filled in by the
+ * node as soon as it gets it, so is complete by the time the thread starts
+ * another record, or ends its dispatch cycle, which both call this.
+ */
+void
+vlib_trace_ring_flush (vlib_trace_main_t *tm)
+{
+  vlib_trace_ring_t *ring = tm->trace_ring;
+  vlib_trace_ring_record_t *rec;
+  u64 head;
+
+  if (!tm->trace_ring_pending)
+    return;
+
+  head = ring->head;
+  rec = vlib_trace_ring_record (ring, tm->trace_ring_n_records, head);
+  CLIB_MEMORY_STORE_BARRIER ();
+  rec->seq = head + 1;
+  clib_atomic_store_rel_n (&ring->head, head + 1);
+  tm->trace_ring_pending = 0;
+}
+
+void *
+vlib_trace_ring_add (vlib_main_t *vm, vlib_node_runtime_t *r,
+		     vlib_buffer_t *b, u32 n_data_bytes)
+{
+  vlib_trace_main_t *tm = &vm->trace_main;
+  vlib_trace_ring_t *ring = tm->trace_ring;
+  vlib_trace_ring_record_t *rec;
+
+  if (PREDICT_FALSE (n_data_bytes > VLIB_TRACE_RING_DATA_BYTES))
+    {
+      ring->n_too_big++;
+      ASSERT (vec_len (vnet_trace_placeholder) >= n_data_bytes);
+      return vnet_trace_placeholder;
+    }
+
+  vlib_trace_ring_flush (tm);
+
+  /* readers that overlap the rewrite of the slot see seq change */
+  rec = vlib_trace_ring_record (ring, tm->trace_ring_n_records, ring->head);
+  rec->seq = 0;
+  CLIB_MEMORY_STORE_BARRIER ();
+
+  rec->time = vm->cpu_time_last_node_dispatch;
+  rec->trace_id = b->trace_handle;
+  rec->node_index = r->node_index;
+  rec->n_data = n_data_bytes;
+  tm->trace_ring_pending = 1;
+
+  return rec->data;
+}
+
+int
+vlib_trace_sample_buffer (vlib_main_t *vm, vlib_node_runtime_t *r,
+			  u32 next_index, vlib_buffer_t *b, int follow_chain)
+{
+  vlib_trace_main_t *tm = &vm->trace_main;
+  u32 handle;
+
+  /* one in sample_interval on average, but not periodically, so as not
+   * to beat with the traffic */
+  tm->sample_countdown =
+    1 + random_u32 (&tm->sample_seed) % (2 * tm->sample_interval - 1);
+
+  tm->trace_ring->n_sampled++;
+  vlib_trace_ring_flush (tm);
+  vlib_trace_next_frame (vm, r, next_index);
+
+  handle = vlib_buffer_make_trace_handle (vm->thread_index,
+					  tm->sample_index++ % 0x00FFFFFF);
+  do
+    {
+      b->flags |= VLIB_BUFFER_IS_TRACED;
+      b->trace_handle = handle;
+    }
+  while (follow_chain && (b = vlib_get_next_buffer (vm, b)));
+
+  return 1;
+}
+
+clib_error_t *
+vlib_trace_sample_enable (vlib_main_t *vm, u32 node_index, u32 interval,
+			  u32 n_records, char *file, int filter)
+{
+  vlib_trace_sample_main_t *tsm = &vlib_trace_sample_main;
+  vlib_node_main_t *nm = &vm->node_main;
+  u32 n_threads = vlib_get_n_threads (), i;
+  uword size, names_size, ring_size;
+  vlib_trace_ring_header_t *h;
+  vlib_trace_main_t *tm;
+  vlib_trace_node_t *tn;
+  vlib_node_t *n;
+  int fd;
+
+  if (interval == 0)
+    return clib_error_return (0, "sample interval must be non-zero");
+
+  n_records = 1 << max_log2 (clib_max (n_records, 2));
+  names_size = round_pow2 (vec_len (nm->nodes) * VLIB_TRACE_RING_NAME_BYTES,
+			   CLIB_CACHE_LINE_BYTES);
+  ring_size = sizeof (vlib_trace_ring_t) +
+	      (uword) n_records * VLIB_TRACE_RING_RECORD_SIZE;
+  size = round_pow2 (sizeof (*h), CLIB_CACHE_LINE_BYTES) + names_size +
+	 n_threads * ring_size;
+
+  vlib_trace_sample_disable ();
+
+  fd = open (file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return clib_error_return_unix (0, "open '%s'", file);
+  if (ftruncate (fd, size) < 0)
+    {
+      close (fd);
+      return clib_error_return_unix (0, "ftruncate '%s'", file);
+    }
+  h = mmap (0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close (fd);
+  if (h == MAP_FAILED)
+    return clib_error_return_unix (0, "mmap '%s'", file);
+
+  /* fault the pages in here rather than on the workers */
+  clib_memset (h, 0, size);
+
+  h->version = VLIB_TRACE_RING_VERSION;
+  h->n_threads = n_threads;
+  h->n_records = n_records;
+  h->record_size = VLIB_TRACE_RING_RECORD_SIZE;
+  h->n_nodes = vec_len (nm->nodes);
+  h->names_offset = round_pow2 (sizeof (*h), CLIB_CACHE_LINE_BYTES);
+  h->rings_offset = h->names_offset + names_size;
+  h->ring_size = ring_size;
+  h->cpu_time_base = vm->clib_time.init_cpu_time;
+  h->unix_time_base = vm->clib_time.init_reference_time;
+  h->clocks_per_second = vm->clib_time.clocks_per_second;
+  h->sample_interval = interval;
+
+  for (i = 0; i < vec_len (nm->nodes); i++)
+    {
+      n = nm->nodes[i];
+      clib_memcpy (vlib_trace_ring_node_name (h, i), n->name,
+		   clib_min (vec_len (n->name), VLIB_TRACE_RING_NAME_BYTES - 1));
+    }
+
+  /* readers check the magic last */
+  clib_atomic_store_rel_n (&h->magic, VLIB_TRACE_RING_MAGIC);
+
+  tsm->header = h;
+  tsm->size = size;
+  vec_reset_length (tsm->file);
+  tsm->file = format (tsm->file, "%s%c", file, 0);
+
+  if (vnet_trace_placeholder == 0)
+    vec_validate_aligned (vnet_trace_placeholder, 2048,
+			  CLIB_CACHE_LINE_BYTES);
+
+  vlib_worker_thread_barrier_sync (vm);
+
+  /* the sampled trace is the only trace */
+  clear_trace_buffer ();
+
+  foreach_vlib_main ()
+    {
+      tm = &this_vlib_main->trace_main;
+      tm->trace_ring = vlib_trace_ring_get (h, this_vlib_main->thread_index);
+      tm->trace_ring_n_records = n_records;
+      tm->trace_ring_pending = 0;
+      tm->sample_interval = interval;
+      tm->sample_seed = clib_cpu_time_now () + this_vlib_main->thread_index;
+      tm->sample_countdown =
+	1 + random_u32 (&tm->sample_seed) % (2 * interval - 1);
+      tm->sample_index = 0;
+
+      vec_validate (tm->nodes, node_index);
+      tn = tm->nodes + node_index;
+      tn->limit = ~0;
+      tn->count = 0;
+      tm->trace_enable = 1;
+    }
+
+  vlib_enable_disable_pkt_trace_filter (!!filter);
+
+  vlib_worker_thread_barrier_release (vm);
+  return 0;
+}
+
+/* Stop sampling. The file is left for offline reading */
+void
+vlib_trace_sample_disable (void)
+{
+  vlib_trace_sample_main_t *tsm = &vlib_trace_sample_main;
+  vlib_main_t *vm = vlib_get_main ();
+  vlib_trace_main_t *tm;
+
+  if (!tsm->header)
+    return;
+
+  vlib_worker_thread_barrier_sync (vm);
+
+  foreach_vlib_main ()
+    {
+      tm = &this_vlib_main->trace_main;
+      vlib_trace_ring_flush (tm);
+      tm->trace_ring = 0;
+      tm->sample_interval = 0;
+    }
+
+  vlib_enable_disable_pkt_trace_filter (0);
+  clear_trace_buffer ();
+
+  vlib_worker_thread_barrier_release (vm);
+
+  munmap (tsm->header, tsm->size);
+  tsm->header = 0;
+}
+
+static clib_error_t *
+cli_trace_sample (vlib_main_t *vm, unformat_input_t *input,
+		  vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  u32 node_index = ~0, interval = 0, n_records = 4096;
+  clib_error_t *error = 0;
+  u8 *file = 0;
+  int filter = 0, is_off = 0;
+  vlib_node_t *node;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "off"))
+	is_off = 1;
+      else if (unformat (line_input, "every %u", &interval))
+	;
+      else if (unformat (line_input, "records %u", &n_records))
+	;
+      else if (unformat (line_input, "file %s", &file))
+	;
+      else if (unformat (line_input, "filter"))
+	filter = 1;
+      else if (unformat (line_input, "%U", unformat_vlib_node, vm,
+			 &node_index))
+	;
+      else
+	{
+	  error = clib_error_create ("unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (is_off)
+    {
+      vlib_trace_sample_disable ();
+      goto done;
+    }
+
+  if (node_index == ~0 || interval == 0)
+    {
+      error = clib_error_create ("expected NODE every N");
+      goto done;
+    }
+
+  node = vlib_get_node (vm, node_index);
+  if ((node->flags & VLIB_NODE_FLAG_TRACE_SUPPORTED) == 0)
+    {
+      error = clib_error_create ("node '%U' doesn't support per-node "
+				 "tracing",
+				 format_vlib_node_name, vm, node_index);
+      goto done;
+    }
+
+  if (!file)
+    file = format (0, "%s/trace-samples%c", vlib_unix_get_runtime_dir (), 0);
+  else
+    vec_add1 (file, 0);
+
+  error = vlib_trace_sample_enable (vm, node_index, interval, n_records,
+				    (char *) file, filter);
+
+done:
+  vec_free (file);
+  unformat_free (line_input);
+  return error;
+}
+
+/*?
+ * Trace one in N packets from an input node, on average, continuously.
+ * The traces are written to a ring per thread in a file mapped shared,
+ * by default in the runtime directory, which can be read while the
+ * workers run, with 'show trace sample' or with vpp_trace_samples.
+ * With 'filter', only packets that match the trace filter are sampled.
+ *
+ * @cliexpar
+ * @cliexcmd{trace sample dpdk-input every 10000}
+ * @cliexcmd{trace sample off}
+?*/
+VLIB_CLI_COMMAND (trace_sample_cli, static) = {
+  .path = "trace sample",
+  .short_help = "trace sample <input-graph-node> every <n> [records <n>] "
+		"[file <path>] [filter] | off",
+  .function = cli_trace_sample,
+};
+
+static clib_error_t *
+cli_show_trace_sample (vlib_main_t *vm, unformat_input_t *input,
+		       vlib_cli_command_t *cmd)
+{
+  vlib_trace_sample_main_t *tsm = &vlib_trace_sample_main;
+  vlib_trace_ring_header_t *h = tsm->header;
+  u64 rec_data[VLIB_TRACE_RING_RECORD_SIZE / sizeof (u64)];
+  vlib_trace_ring_record_t *rec = (vlib_trace_ring_record_t *) rec_data;
+  u32 max = 50, i;
+  vlib_trace_ring_t *ring;
+  vlib_node_t *node;
+  u64 head, index;
+  f64 t;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "max %u", &max))
+	;
+      else
+	return clib_error_create ("unknown input `%U'", format_unformat_error,
+				  input);
+    }
+
+  if (!h)
+    {
+      vlib_cli_output (vm, "sampled tracing is off");
+      return 0;
+    }
+
+  vlib_cli_output (vm, "one in %u packets, %u records per thread in %s",
+		   h->sample_interval, h->n_records, tsm->file);
+
+  for (i = 0; i < h->n_threads; i++)
+    {
+      ring = vlib_trace_ring_get (h, i);
+      head = clib_atomic_load_acq_n (&ring->head);
+
+      vlib_cli_output (vm, "------------------- Start of thread %d %v -------"
+			   "------------",
+		       i, vlib_worker_threads[i].name);
+      vlib_cli_output (vm, "%llu packets sampled, %llu records, %llu traces "
+			   "too big",
+		       ring->n_sampled, head, ring->n_too_big);
+
+      for (index = head > max ? head - max : 0; index < head; index++)
+	{
+	  if (!vlib_trace_ring_read (ring, h->n_records, index, rec))
+	    continue;
+	  if (rec->node_index >= vec_len (vm->node_main.nodes))
+	    continue;
+
+	  node = vlib_get_node (vm, rec->node_index);
+	  t = (rec->time - vm->cpu_time_main_loop_start) *
+	      vm->clib_time.seconds_per_clock;
+	  vlib_cli_output (vm, "%U: packet %u/%u %v", format_time_interval,
+			   "h:m:s:u", t, rec->trace_id >> 24,
+			   rec->trace_id & 0x00FFFFFF, node->name);
+	  if (node->format_trace)
+	    vlib_cli_output (vm, "  %U", node->format_trace, vm, node,
+			     rec->data);
+	  else
+	    vlib_cli_output (vm, "  %U", node->format_buffer, rec->data);
+	}
+    }
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_trace_sample_cli, static) = {
+  .path = "show trace sample",
+  .short_help = "show trace sample [max <n>]",
+  .function = cli_show_trace_sample,
+};
+
 /* Placeholder function to get us linked in. */
 void
 vlib_trace_cli_reference (void)
@@ -41,6 +41,7 @@
 #define included_vlib_trace_h
 
 #include <vppinfra/pool.h>
+#include <vlib/trace_ring.h>
 
 typedef struct
 {
@@ -122,6 +123,17 @@ typedef struct
 
   vlib_is_packet_traced_fn_t *current_trace_filter_function;
 
+  /* sampled tracing, of one in sample_interval packets on average */
+  u32 sample_interval;
+  u32 sample_countdown;
+  u32 sample_seed;
+  u32 sample_index;
+
+  /* this thread's ring of sampled traces, its last record not published */
+  vlib_trace_ring_t *trace_ring;
+  u32 trace_ring_n_records;
+  u8 trace_ring_pending;
+
 } vlib_trace_main_t;
 
 format_function_t format_vlib_trace;
@@ -156,6 +168,11 @@ void trace_update_capture_options (u32 add, u32 node_index,
 void trace_filter_set (u32 node_index, u32 flag, u32 count);
 void clear_trace_buffer (void);
 void vlib_set_trace_filter_function (vlib_is_packet_traced_fn_t *x);
+clib_error_t *vlib_trace_sample_enable (struct vlib_main_t *vm,
+				       u32 node_index, u32 interval,
+				       u32 n_records, char *file, int filter);
+void vlib_trace_sample_disable (void);
+void vlib_trace_ring_flush (vlib_trace_main_t *tm);
 uword unformat_vlib_trace_filter_function (unformat_input_t *input,
 					   va_list *args);
 
@@ -50,6 +50,11 @@ vlib_validate_trace (vlib_trace_main_t * tm, vlib_buffer_t * b)
 }
 
 int vlib_add_handoff_trace (vlib_main_t * vm, vlib_buffer_t * b);
+void *vlib_trace_ring_add (vlib_main_t *vm, vlib_node_runtime_t *r,
+			   vlib_buffer_t *b, u32 n_data_bytes);
+int vlib_trace_sample_buffer (vlib_main_t *vm, vlib_node_runtime_t *r,
+			      u32 next_index, vlib_buffer_t *b,
+			      int follow_chain);
 
 always_inline void *
 vlib_add_trace_inline (vlib_main_t * vm,
@@ -78,6 +83,10 @@ vlib_add_trace_inline (vlib_main_t * vm,
       return vnet_trace_placeholder;
     }
 
+  /* Sampled traces go to the thread's ring, wherever they were sampled */
+  if (PREDICT_FALSE (tm->trace_ring != 0))
+    return vlib_trace_ring_add (vm, r, b, n_data_bytes);
+
   /* Are we trying to trace a handoff case? */
   if (PREDICT_FALSE (vlib_buffer_get_trace_thread (b) != vm->thread_index))
     if (PREDICT_FALSE (!vlib_add_handoff_trace (vm, b)))
@@ -167,6 +176,14 @@ vlib_trace_buffer (vlib_main_t * vm,
 	return 0;
     }
 
+  /* Sampling, the countdown is all that most packets see */
+  if (PREDICT_FALSE (tm->sample_interval != 0))
+    {
+      if (PREDICT_TRUE (--tm->sample_countdown != 0))
+	return 0;
+      return vlib_trace_sample_buffer (vm, r, next_index, b, follow_chain);
+    }
+
   /*
    * Apply filter to existing traces to keep number of allocated traces low.
    * Performed each time around the main loop.
@@ -225,6 +242,10 @@ vlib_set_trace_count (vlib_main_t * vm, vlib_node_runtime_t * rt, u32 count)
   vlib_trace_main_t *tm = &vm->trace_main;
   vlib_trace_node_t *tn = vec_elt_at_index (tm->nodes, rt->node_index);
 
+  /* sampling doesn't run out */
+  if (PREDICT_FALSE (tm->sample_interval != 0))
+    return;
+
   ASSERT (count <= tn->limit);
   tn->count = tn->limit - count;
 }
@@ -0,0 +1,131 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+/*
+ * Sampled packet trace rings.
+ *
+ * Sampled traces are written as fixed size binary records to a ring per
+ * thread, in a file mapped shared so that other processes can read them
+ * while the workers run. The file starts with a header, followed by the
+ * node names, then the rings.
+ *
+ * Each thread's ring has one writer, its thread. A record is published
+ * once the next one is started, as the node fills in its trace data
+ * after the record is handed out, or when the thread flushes its ring.
+ * A record's seq is its index plus one once it is published, 0 while it
+ * is written; readers check seq before and after copying a record.
+ */
+
+#ifndef included_vlib_trace_ring_h
+#define included_vlib_trace_ring_h
+
+#include <vppinfra/clib.h>
+#include <vppinfra/cache.h>
+#include <vppinfra/string.h>
+
+#define VLIB_TRACE_RING_MAGIC	    0x76707472 /* "vptr" */
+#define VLIB_TRACE_RING_VERSION	    1
+#define VLIB_TRACE_RING_NAME_BYTES  64
+#define VLIB_TRACE_RING_RECORD_SIZE 256
+
+typedef struct
+{
+  u32 magic;
+  u32 version;
+  u32 n_threads;
+  u32 n_records;	/* per ring, a power of 2 */
+  u32 record_size;
+  u32 n_nodes;
+  u64 names_offset;
+  u64 rings_offset;
+  u64 ring_size;
+
+  /* to convert record times */
+  u64 cpu_time_base;
+  f64 unix_time_base;
+  f64 clocks_per_second;
+
+  u32 sample_interval;
+} vlib_trace_ring_header_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
+  /* records published, the last n_records of them are in the ring */
+  volatile u64 head;
+
+  /* packets sampled, and traces too big for a record */
+  u64 n_sampled;
+  u64 n_too_big;
+
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
+  u8 records[0];
+} vlib_trace_ring_t;
+
+typedef struct
+{
+  volatile u64 seq;
+  u64 time;
+
+  /* thread which sampled the packet and packet number, as in the buffer's
+   * trace handle; the same for all the records of a packet */
+  u32 trace_id;
+  u32 node_index;
+  u32 n_data;
+  u32 pad;
+  u8 data[0];
+} vlib_trace_ring_record_t;
+
+#define VLIB_TRACE_RING_DATA_BYTES                                            \
+  (VLIB_TRACE_RING_RECORD_SIZE - sizeof (vlib_trace_ring_record_t))
+
+static_always_inline vlib_trace_ring_t *
+vlib_trace_ring_get (vlib_trace_ring_header_t *h, u32 thread_index)
+{
+  return (vlib_trace_ring_t *) ((u8 *) h + h->rings_offset +
+				thread_index * h->ring_size);
+}
+
+static_always_inline vlib_trace_ring_record_t *
+vlib_trace_ring_record (vlib_trace_ring_t *ring, u32 n_records, u64 index)
+{
+  return (vlib_trace_ring_record_t *) (ring->records +
+				       (index & (n_records - 1)) *
+					 VLIB_TRACE_RING_RECORD_SIZE);
+}
+
+static_always_inline char *
+vlib_trace_ring_node_name (vlib_trace_ring_header_t *h, u32 node_index)
+{
+  if (node_index >= h->n_nodes)
+    return 0;
+  return (char *) h + h->names_offset +
+	 node_index * VLIB_TRACE_RING_NAME_BYTES;
+}
+
+/*
+ * Copy record index of a ring to rec, which has room for a whole record.
+ * Returns 0 if the record has been overwritten or is being written.
+ */
+static_always_inline int
+vlib_trace_ring_read (vlib_trace_ring_t *ring, u32 n_records, u64 index,
+		      vlib_trace_ring_record_t *rec)
+{
+  vlib_trace_ring_record_t *r;
+
+  r = vlib_trace_ring_record (ring, n_records, index);
+  if (clib_atomic_load_acq_n (&r->seq) != index + 1)
+    return 0;
+
+  clib_memcpy_fast (rec, r, VLIB_TRACE_RING_RECORD_SIZE);
+
+  __atomic_thread_fence (__ATOMIC_ACQUIRE);
+  if (r->seq != index + 1)
+    return 0;
+
+  return rec->n_data <= VLIB_TRACE_RING_DATA_BYTES;
+}
+
+#endif /* included_vlib_trace_ring_h */
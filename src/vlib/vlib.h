@@ -50,6 +50,7 @@
 /* Forward declarations of structs to avoid circular dependencies. */
 struct vlib_main_t;
 struct vlib_global_main_t;
+struct vlib_aqm_config_t;
 typedef u32 vlib_log_class_t;
 
 /* All includes in alphabetical order. */
@@ -61,6 +62,7 @@ typedef u32 vlib_log_class_t;
 #include <vlib/init.h>
 #include <vlib/node.h>
 #include <vlib/punt.h>
+#include <vlib/task.h>
 #include <vlib/trace.h>
 #include <vlib/log.h>
 
@@ -405,7 +405,7 @@ static void vl_api_classify_add_del_session_t_handler
   int rv;
   u32 table_index, hit_next_index, opaque_index, metadata, match_len;
   i32 advance;
-  u8 action;
+  u8 action, need_barrier_sync;
   vnet_classify_table_t *t;
 
   table_index = ntohl (mp->table_index);
@@ -430,10 +430,22 @@ static void vl_api_classify_add_del_session_t_handler
       goto out;
     }
 
+  /*
+   * sessions are added to and deleted from a table that the workers
+   * are searching, only finding or creating a FIB needs the barrier
+   */
+  need_barrier_sync = (action == CLASSIFY_ACTION_SET_IP4_FIB_INDEX ||
+		       action == CLASSIFY_ACTION_SET_IP6_FIB_INDEX);
+  if (need_barrier_sync)
+    vlib_worker_thread_barrier_sync (vlib_get_main ());
+
   rv = vnet_classify_add_del_session
     (cm, table_index, mp->match, hit_next_index, opaque_index,
      advance, action, metadata, mp->is_add);
 
+  if (need_barrier_sync)
+    vlib_worker_thread_barrier_release (vlib_get_main ());
+
 out:
   REPLY_MACRO (VL_API_CLASSIFY_ADD_DEL_SESSION_REPLY);
 }
@@ -967,6 +979,9 @@ classify_api_hookup (vlib_main_t * vm)
    */
   msg_id_base = setup_message_id_table ();
 
+  vl_api_set_msg_thread_safe (
+    am, REPLY_MSG_ID_BASE + VL_API_CLASSIFY_ADD_DEL_SESSION, 1);
+
   return 0;
 }
 
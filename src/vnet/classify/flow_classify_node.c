@@ -75,6 +75,9 @@ flow_classify_inline (vlib_main_t * vm,
   u32 misses = 0;
   u32 chain_hits = 0;
   u32 drop = 0;
+  vnet_classify_entry_t *entries[VLIB_FRAME_SIZE];
+  u32 table_indices[VLIB_FRAME_SIZE];
+  u8 *data[VLIB_FRAME_SIZE];
 
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
@@ -169,6 +172,20 @@ flow_classify_inline (vlib_main_t * vm,
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
 
+  /* Compiled chains: search the frame at once */
+  if (PREDICT_FALSE (vcm->n_compiled_chains))
+    {
+      for (u32 i = 0; i < n_left_from; i++)
+	{
+	  vlib_buffer_t *b0 = vlib_get_buffer (vm, from[i]);
+
+	  data[i] = b0->data;
+	  table_indices[i] = vnet_buffer (b0)->l2_classify.table_index;
+	}
+      vnet_classify_find_entries (vcm, data, data, table_indices, entries,
+				  n_left_from, now);
+    }
+
   while (n_left_from > 0)
     {
       u32 n_left_to_next;
@@ -178,6 +195,7 @@ flow_classify_inline (vlib_main_t * vm,
       /* Not enough load/store slots to dual loop... */
       while (n_left_from > 0 && n_left_to_next > 0)
 	{
+	  u32 i0 = frame->n_vectors - n_left_from;
 	  u32 bi0;
 	  vlib_buffer_t *b0;
 	  u32 next0 = FLOW_CLASSIFY_NEXT_INDEX_DROP;
@@ -223,7 +241,29 @@ flow_classify_inline (vlib_main_t * vm,
 				&b0->current_config_index, &next0,
 				/* # bytes of config data */ 0);
 
-	  if (PREDICT_TRUE (table_index0 != ~0))
+	  if (PREDICT_FALSE (vcm->n_compiled_chains) && table_index0 != ~0)
+	    {
+	      /* a flow seen in none of the chain's tables goes to the head */
+	      e0 = entries[i0];
+	      t0 = pool_elt_at_index (vcm->tables, table_indices[i0]);
+	      if (e0)
+		{
+		  hits++;
+		  if (table_indices[i0] != table_index0)
+		    chain_hits++;
+		}
+	      else
+		{
+		  misses++;
+		  t0 = pool_elt_at_index (vcm->tables, table_index0);
+		  vnet_classify_add_del_session (vcm, table_index0, h0, ~0, 0,
+						 0, 0, 0, 1);
+		  /* increment counter */
+		  vnet_classify_find_entry (
+		    t0, h0, vnet_buffer (b0)->l2_classify.hash, now);
+		}
+	    }
+	  else if (PREDICT_TRUE (table_index0 != ~0))
 	    {
 	      hash0 = vnet_buffer (b0)->l2_classify.hash;
 	      t0 = pool_elt_at_index (vcm->tables, table_index0);
@@ -137,12 +137,15 @@ vnet_classify_new_table (vnet_classify_main_t *cm, const u8 *mask,
 
   nbuckets = 1 << (max_log2 (nbuckets));
 
-  pool_get_aligned_zero (cm->tables, t, CLIB_CACHE_LINE_BYTES);
+  /* the workers may be reading the pool */
+  vlib_rcu_pool_get_aligned (cm->tables, t, CLIB_CACHE_LINE_BYTES);
+  clib_memset (t, 0, sizeof (*t));
 
   clib_memset_u32 (t->mask, 0, 4 * ARRAY_LEN (t->mask));
   clib_memcpy_fast (t->mask, mask, match_n_vectors * sizeof (u32x4));
 
   t->next_table_index = ~0;
+  t->chain_index = ~0;
   t->nbuckets = nbuckets;
   t->log2_nbuckets = max_log2 (nbuckets);
   t->match_n_vectors = match_n_vectors;
@@ -161,10 +164,30 @@ vnet_classify_new_table (vnet_classify_main_t *cm, const u8 *mask,
   return (t);
 }
 
+typedef struct
+{
+  vnet_classify_bucket_t *buckets;
+  void *mheap;
+  vnet_classify_bloom_t *bloom;
+} vnet_classify_table_free_args_t;
+
+static void
+vnet_classify_table_free_cb (void *args)
+{
+  vnet_classify_table_free_args_t *a = args;
+
+  vec_free (a->buckets);
+  clib_mem_destroy_heap (a->mheap);
+  if (a->bloom)
+    clib_mem_free (a->bloom);
+}
+
 void
 vnet_classify_delete_table_index (vnet_classify_main_t * cm,
 				  u32 table_index, int del_chain)
 {
+  vnet_classify_table_free_args_t a;
+
   vnet_classify_table_t *t;
 
   /* Tolerate multiple frees, up to a point */
@@ -176,9 +199,19 @@ vnet_classify_delete_table_index (vnet_classify_main_t * cm,
     /* Recursively delete the entire chain */
     vnet_classify_delete_table_index (cm, t->next_table_index, del_chain);
 
-  vec_free (t->buckets);
-  clib_mem_destroy_heap (t->mheap);
+  /* take the table out of the compiled chains */
+  if (cm->n_compiled_chains)
+    {
+      vnet_classify_chains_update (cm, table_index, 1 /* is_del */);
+      t = pool_elt_at_index (cm->tables, table_index);
+    }
+
+  /* the workers may still be searching the table */
+  a.buckets = t->buckets;
+  a.mheap = t->mheap;
+  a.bloom = t->bloom;
   pool_put (cm->tables, t);
+  vlib_rcu_call (vnet_classify_table_free_cb, &a, sizeof (a));
 }
 
 static vnet_classify_entry_t *
@@ -225,6 +258,73 @@ vnet_classify_entry_free (vnet_classify_table_t * t,
   t->freelists[log2_pages] = v;
 }
 
+typedef struct
+{
+  u32 table_index;
+  u32 log2_pages;
+  void *mheap;
+  vnet_classify_entry_t *v;
+} vnet_classify_entry_free_args_t;
+
+/*
+ * Pages the workers may still be reading are put on the freelist, or
+ * back on the heap, once they are done with them; unless the table
+ * has been deleted meanwhile, and its heap with it.
+ */
+static void
+vnet_classify_entry_free_now (vnet_classify_table_t *t,
+			      vnet_classify_entry_t *v, u32 log2_pages)
+{
+  void *oldheap;
+
+  /* ~0 pages is a working copy, straight from the heap */
+  if (log2_pages == ~0)
+    {
+      oldheap = clib_mem_set_heap (t->mheap);
+      clib_mem_free (v);
+      clib_mem_set_heap (oldheap);
+    }
+  else
+    vnet_classify_entry_free (t, v, log2_pages);
+}
+
+static void
+vnet_classify_entry_free_cb (void *args)
+{
+  vnet_classify_main_t *cm = &vnet_classify_main;
+  vnet_classify_entry_free_args_t *a = args;
+  vnet_classify_table_t *t;
+
+  if (pool_is_free_index (cm->tables, a->table_index))
+    return;
+
+  t = pool_elt_at_index (cm->tables, a->table_index);
+  if (t->mheap != a->mheap)
+    return;
+
+  clib_spinlock_lock (&t->writer_lock);
+  vnet_classify_entry_free_now (t, a->v, a->log2_pages);
+  clib_spinlock_unlock (&t->writer_lock);
+}
+
+static void
+vnet_classify_entry_free_deferred (vnet_classify_table_t *t,
+				   vnet_classify_entry_t *v, u32 log2_pages)
+{
+  vnet_classify_entry_free_args_t a = {
+    .table_index = t - vnet_classify_main.tables,
+    .log2_pages = log2_pages,
+    .mheap = t->mheap,
+    .v = v,
+  };
+
+  /* the writer lock is held, so no waiting for it in the callback */
+  if (vlib_get_thread_index () == 0 && vlib_worker_thread_barrier_held ())
+    vnet_classify_entry_free_now (t, v, log2_pages);
+  else
+    vlib_rcu_call (vnet_classify_entry_free_cb, &a, sizeof (a));
+}
+
 static inline void make_working_copy
   (vnet_classify_table_t * t, vnet_classify_bucket_t * b)
 {
@@ -233,7 +333,7 @@ static inline void make_working_copy
   void *oldheap;
   vnet_classify_entry_t *working_copy;
   clib_thread_index_t thread_index = vlib_get_thread_index ();
-  int working_copy_length, required_length;
+  int required_length;
 
   if (thread_index >= vec_len (t->working_copies))
     {
@@ -247,27 +347,22 @@ static inline void make_working_copy
   /*
    * working_copies are per-cpu so that near-simultaneous
    * updates from multiple threads will not result in sporadic, spurious
-   * lookup failures.
+   * lookup failures. The copy is a fresh one each time, since workers
+   * pointed at the last one may still be reading it; it is retired at
+   * the end of the update.
    */
-  working_copy = t->working_copies[thread_index];
-  working_copy_length = t->working_copy_lengths[thread_index];
+  ASSERT (t->working_copies[thread_index] == 0);
   required_length =
     (sizeof (vnet_classify_entry_t) + (t->match_n_vectors * sizeof (u32x4)))
     * t->entries_per_page * (1 << b->log2_pages);
 
   t->saved_bucket.as_u64 = b->as_u64;
-  oldheap = clib_mem_set_heap (t->mheap);
-
-  if (required_length > working_copy_length)
-    {
-      if (working_copy)
-	clib_mem_free (working_copy);
-      working_copy =
-	clib_mem_alloc_aligned (required_length, CLIB_CACHE_LINE_BYTES);
-      t->working_copies[thread_index] = working_copy;
-    }
 
+  oldheap = clib_mem_set_heap (t->mheap);
+  working_copy =
+    clib_mem_alloc_aligned (required_length, CLIB_CACHE_LINE_BYTES);
   clib_mem_set_heap (oldheap);
+  t->working_copy_lengths[thread_index] = required_length;
 
   v = vnet_classify_get_entry (t, b->offset);
 
@@ -280,6 +375,20 @@ static inline void make_working_copy
   t->working_copies[thread_index] = working_copy;
 }
 
+/*
+ * The bucket no longer points at the working copy, but workers that
+ * found it there may still be reading it.
+ */
+static void
+retire_working_copy (vnet_classify_table_t *t)
+{
+  clib_thread_index_t thread_index = vlib_get_thread_index ();
+
+  vnet_classify_entry_free_deferred (t, t->working_copies[thread_index], ~0);
+  t->working_copies[thread_index] = 0;
+  t->working_copy_lengths[thread_index] = -1;
+}
+
 static vnet_classify_entry_t *
 split_and_rehash (vnet_classify_table_t * t,
 		  vnet_classify_entry_t * old_values, u32 old_log2_pages,
@@ -503,7 +612,7 @@ vnet_classify_add_del (vnet_classify_table_t *t, vnet_classify_entry_t *add_v,
 	      CLIB_MEMORY_BARRIER ();
 	      /* Restore the previous (k,v) pairs */
 	      b->as_u64 = t->saved_bucket.as_u64;
-	      goto unlock;
+	      goto retire;
 	    }
 	}
       for (i = 0; i < limit; i++)
@@ -520,7 +629,7 @@ vnet_classify_add_del (vnet_classify_table_t *t, vnet_classify_entry_t *add_v,
 	      CLIB_MEMORY_BARRIER ();
 	      b->as_u64 = t->saved_bucket.as_u64;
 	      t->active_elements++;
-	      goto unlock;
+	      goto retire;
 	    }
 	}
       /* no room at the inn... split case... */
@@ -542,12 +651,12 @@ vnet_classify_add_del (vnet_classify_table_t *t, vnet_classify_entry_t *add_v,
 	      CLIB_MEMORY_BARRIER ();
 	      b->as_u64 = t->saved_bucket.as_u64;
 	      t->active_elements--;
-	      goto unlock;
+	      goto retire;
 	    }
 	}
       rv = -3;
       b->as_u64 = t->saved_bucket.as_u64;
-      goto unlock;
+      goto retire;
     }
 
   old_log2_pages = t->saved_bucket.log2_pages;
@@ -633,7 +742,10 @@ expand_ok:
   b->as_u64 = tmp_b.as_u64;
   t->active_elements++;
   v = vnet_classify_get_entry (t, t->saved_bucket.offset);
-  vnet_classify_entry_free (t, v, old_log2_pages);
+  vnet_classify_entry_free_deferred (t, v, old_log2_pages);
+
+retire:
+  retire_working_copy (t);
 
 unlock:
   clib_spinlock_unlock (&t->writer_lock);
@@ -780,6 +892,8 @@ vnet_classify_add_del_table (vnet_classify_main_t *cm, const u8 *mask,
 
 	  t = pool_elt_at_index (cm->tables, *table_index);
 	  t->next_table_index = next_table_index;
+	  if (cm->n_compiled_chains)
+	    vnet_classify_chains_update (cm, *table_index, 0 /* is_del */);
 	}
       return 0;
     }
@@ -2815,8 +2929,15 @@ vnet_classify_add_del_session (vnet_classify_main_t *cm, u32 table_index,
   for (i = 0; i < t->match_n_vectors; i++)
     e->key[i] &= t->mask[i];
 
+  /* the filter must know the key before the workers can hit it */
+  if (PREDICT_FALSE (t->bloom != 0) && is_add)
+    vnet_classify_bloom_add (t, e);
+
   rv = vnet_classify_add_del (t, e, is_add);
 
+  if (PREDICT_FALSE (t->bloom != 0) && rv == 0)
+    vnet_classify_bloom_update (t, is_add);
+
   vnet_classify_entry_release_resource (e);
 
   if (rv)
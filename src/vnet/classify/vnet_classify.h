@@ -23,6 +23,7 @@
 #include <vppinfra/cache.h>
 #include <vppinfra/crc32.h>
 #include <vppinfra/xxhash.h>
+#include <vppinfra/vector/mask_compare.h>
 
 extern vlib_node_registration_t ip4_classify_node;
 extern vlib_node_registration_t ip6_classify_node;
@@ -152,9 +153,9 @@ typedef struct
   /* hash Buckets */
   vnet_classify_bucket_t *buckets;
 
-  /* Private allocation arena, protected by the writer lock,
-   * where the entries are stored. */
-  void *mheap;
+  /* Filter on the keys, while the table is in a compiled chain; replaced
+   * under RCU, so read it with vlib_rcu_deref */
+  struct _vnet_classify_bloom *bloom;
 
   /* User/client data associated with the table */
   uword user_ctx;
@@ -175,11 +176,18 @@ typedef struct
   /* Miss next index, return if next_table_index = 0 */
   u32 miss_next_index;
 
+  /* Compiled chain headed by this table, or ~0 */
+  u32 chain_index;
+
   /**
    * All members accessed in the DP above here
    */
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
 
+  /* Private allocation arena, protected by the writer lock,
+   * where the entries are stored. */
+  void *mheap;
+
   /* Config parameters */
   u32 linear_buckets;
   u32 active_elements;
@@ -212,6 +220,41 @@ typedef struct
 STATIC_ASSERT_OFFSET_OF (vnet_classify_table_t, cacheline1,
 			 CLIB_CACHE_LINE_BYTES);
 
+/*
+ * Compiled chains.
+ *
+ * The tables of a chain are normally searched one after the other, each
+ * miss costing a hash and a bucket fetch before the next table is tried.
+ * A compiled chain is searched a batch of packets at a time: the hashes
+ * of all its tables are computed first and tested against a bloom filter
+ * on each table's keys, the buckets of the tables which may hold a match
+ * are prefetched, and only those tables are then searched, in chain
+ * order. The first hit wins, as with the walk.
+ */
+#define VNET_CLASSIFY_CHAIN_MAX_TABLES 16
+
+typedef struct
+{
+  /* Tables in lookup order, the head first */
+  u32 table_indices[VNET_CLASSIFY_CHAIN_MAX_TABLES];
+  u32 n_tables;
+} vnet_classify_chain_t;
+
+/* Bloom filter over the hashes of a table's keys, two bits per key */
+typedef struct _vnet_classify_bloom
+{
+  u32 log2_n_bits;
+
+  /* keys set, including the deleted ones */
+  u32 n_keys;
+  u32 n_deleted;
+
+  u64 bits[0];
+} vnet_classify_bloom_t;
+
+#define VNET_CLASSIFY_BLOOM_BITS_PER_KEY 16
+#define VNET_CLASSIFY_BLOOM_MIN_BITS	 512
+
 /**
  * The vector size for the classifier
  *  in the add/del table 'match' is the number of vectors of this size
@@ -234,6 +277,10 @@ struct _vnet_classify_main
   /* Per-interface filter table.  [0] is used for pcap */
   u32 *classify_table_index_by_sw_if_index;
 
+  /* Compiled chain pool */
+  vnet_classify_chain_t *chains;
+  u32 n_compiled_chains;
+
   /* convenience variables */
   vlib_main_t *vlib_main;
   vnet_main_t *vnet_main;
@@ -581,6 +628,166 @@ vnet_classify_find_entry_inline (const vnet_classify_table_t *t, const u8 *h,
   return 0;
 }
 
+static_always_inline void
+vnet_classify_bloom_bits (const vnet_classify_bloom_t *bf, u32 hash,
+			  u32 *bit0, u32 *bit1)
+{
+  *bit0 = hash & pow2_mask (bf->log2_n_bits);
+  *bit1 = (hash * 0x9e3779b1) >> (32 - bf->log2_n_bits);
+}
+
+/* Returns 0 if no key of the filter has this hash */
+static_always_inline int
+vnet_classify_bloom_test (const vnet_classify_bloom_t *bf, u32 hash)
+{
+  u32 bit0, bit1;
+
+  if (!bf)
+    return 1;
+
+  vnet_classify_bloom_bits (bf, hash, &bit0, &bit1);
+  return (bf->bits[bit0 / 64] >> (bit0 % 64)) &
+	 (bf->bits[bit1 / 64] >> (bit1 % 64)) & 1;
+}
+
+static_always_inline u8 *
+vnet_classify_table_data (const vnet_classify_table_t *t, u8 *data,
+			  u8 *current)
+{
+  if (t->current_data_flag == CLASSIFY_FLAG_USE_CURR_DATA)
+    return current + t->current_data_offset;
+  return data;
+}
+
+/*
+ * Search the tables chained from *table_index one after the other.
+ * Returns the entry hit or 0, with *table_index set to the table hit or to
+ * the last table of the chain.
+ */
+static_always_inline vnet_classify_entry_t *
+vnet_classify_find_entry_chain (vnet_classify_main_t *cm, u8 *data,
+				u8 *current, u32 *table_index, f64 now)
+{
+  vnet_classify_table_t *t;
+  vnet_classify_entry_t *e;
+  u8 *h;
+
+  while (1)
+    {
+      t = pool_elt_at_index (cm->tables, *table_index);
+      h = vnet_classify_table_data (t, data, current);
+      e = vnet_classify_find_entry_inline (
+	t, h, vnet_classify_hash_packet_inline (t, h), now);
+      if (e || t->next_table_index == ~0)
+	return e;
+      *table_index = t->next_table_index;
+    }
+}
+
+#define VNET_CLASSIFY_FIND_BATCH 64
+
+/*
+ * Search n packets in the chains headed by table_indices[i], or in none
+ * where that is ~0, packet i's data being at data[i] and its current data
+ * at current[i]. Compiled chains are searched a batch at a time, the
+ * others walked.
+ *
+ * On return entries[i] is the entry hit or 0, and table_indices[i] the
+ * table hit or the last table of the chain.
+ */
+static_always_inline void
+vnet_classify_find_entries (vnet_classify_main_t *cm, u8 **data,
+			    u8 **current, u32 *table_indices,
+			    vnet_classify_entry_t **entries, u32 n_left,
+			    f64 now)
+{
+  u32 hashes[VNET_CLASSIFY_FIND_BATCH][VNET_CLASSIFY_CHAIN_MAX_TABLES];
+  vnet_classify_chain_t *chains[VNET_CLASSIFY_FIND_BATCH], *c, *cp;
+  u16 candidates[VNET_CLASSIFY_FIND_BATCH];
+  vnet_classify_table_t *t;
+  vnet_classify_entry_t *e;
+  u64 searched, walked, valid;
+  u32 n, i, j, cand, hash;
+  u8 *h;
+
+  while (n_left)
+    {
+      n = clib_min (n_left, VNET_CLASSIFY_FIND_BATCH);
+      valid = n == 64 ? ~0ULL : pow2_mask (n);
+      walked = 0;
+
+      /* hash the packets in all the tables of their chains, keeping the
+	 tables whose filter does not rule a match out */
+      for (i = 0; i < n; i++)
+	{
+	  entries[i] = 0;
+	  candidates[i] = 0;
+
+	  if (table_indices[i] == ~0)
+	    continue;
+
+	  t = pool_elt_at_index (cm->tables, table_indices[i]);
+	  if (t->chain_index == ~0)
+	    {
+	      walked |= 1ULL << i;
+	      continue;
+	    }
+
+	  cp = vlib_rcu_deref (cm->chains);
+	  c = chains[i] = pool_elt_at_index (cp, t->chain_index);
+	  for (j = 0; j < c->n_tables; j++)
+	    {
+	      t = pool_elt_at_index (cm->tables, c->table_indices[j]);
+	      h = vnet_classify_table_data (t, data[i], current[i]);
+	      hash = vnet_classify_hash_packet_inline (t, h);
+	      if (!vnet_classify_bloom_test (vlib_rcu_deref (t->bloom), hash))
+		continue;
+	      hashes[i][j] = hash;
+	      candidates[i] |= 1 << j;
+	      vnet_classify_prefetch_bucket (t, hash);
+	    }
+
+	  /* a miss is taken in the last table */
+	  table_indices[i] = c->table_indices[c->n_tables - 1];
+	}
+
+      /* packets with candidates, the others missed or are walked */
+      if (n == VNET_CLASSIFY_FIND_BATCH)
+	searched = ~clib_mask_compare_u16_x64 (0, candidates);
+      else
+	searched = ~clib_mask_compare_u16_x64_n (0, candidates, n);
+      searched &= valid;
+
+      foreach_set_bit_index (i, searched)
+	{
+	  c = chains[i];
+	  for (cand = candidates[i]; cand; cand = clear_lowest_set_bit (cand))
+	    {
+	      j = get_lowest_set_bit_index (cand);
+	      t = pool_elt_at_index (cm->tables, c->table_indices[j]);
+	      h = vnet_classify_table_data (t, data[i], current[i]);
+	      e = vnet_classify_find_entry_inline (t, h, hashes[i][j], now);
+	      if (e)
+		{
+		  entries[i] = e;
+		  table_indices[i] = c->table_indices[j];
+		  break;
+		}
+	    }
+	}
+
+      foreach_set_bit_index (i, walked)
+	entries[i] = vnet_classify_find_entry_chain (
+	  cm, data[i], current[i], table_indices + i, now);
+
+      data += n;
+      current += n;
+      table_indices += n;
+      entries += n;
+      n_left -= n;
+    }
+}
+
 vnet_classify_table_t *vnet_classify_new_table (vnet_classify_main_t *cm,
 						const u8 *mask, u32 nbuckets,
 						u32 memory_size,
@@ -601,6 +808,14 @@ int vnet_classify_add_del_table (vnet_classify_main_t *cm, const u8 *mask,
 void vnet_classify_delete_table_index (vnet_classify_main_t *cm,
 				       u32 table_index, int del_chain);
 
+int vnet_classify_chain_compile (vnet_classify_main_t *cm, u32 table_index,
+				 int is_add);
+void vnet_classify_chains_update (vnet_classify_main_t *cm, u32 table_index,
+				  int is_del);
+void vnet_classify_bloom_add (vnet_classify_table_t *t,
+			      vnet_classify_entry_t *e);
+void vnet_classify_bloom_update (vnet_classify_table_t *t, int is_add);
+
 unformat_function_t unformat_ip4_mask;
 unformat_function_t unformat_ip6_mask;
 unformat_function_t unformat_l3_mask;
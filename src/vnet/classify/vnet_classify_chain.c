@@ -0,0 +1,402 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+/*
+ * Compiled classifier chains, see vnet_classify.h.
+ *
+ * A chain is compiled from its head table, following next_table_index.
+ * The chain and the filters of its tables are only ever replaced, never
+ * changed in place: the workers see either the old or the new one, and
+ * the old one is freed once they have all moved on.
+ */
+
+#include <vnet/classify/vnet_classify.h>
+
+static vnet_classify_bloom_t *
+vnet_classify_bloom_build (vnet_classify_table_t *t)
+{
+  vnet_classify_bloom_t *bf;
+  vnet_classify_bucket_t *b;
+  vnet_classify_entry_t *v, *save_v;
+  u32 n_bits, bit0, bit1;
+  uword size;
+  u8 *key_minus_skip;
+  int i, j;
+
+  n_bits = clib_max (t->active_elements * VNET_CLASSIFY_BLOOM_BITS_PER_KEY,
+		     VNET_CLASSIFY_BLOOM_MIN_BITS);
+  n_bits = 1 << max_log2 (n_bits);
+  size = sizeof (*bf) + n_bits / 8;
+
+  bf = clib_mem_alloc_aligned (size, CLIB_CACHE_LINE_BYTES);
+  clib_memset (bf, 0, size);
+  bf->log2_n_bits = min_log2 (n_bits);
+
+  clib_spinlock_lock (&t->writer_lock);
+
+  for (i = 0; i < t->nbuckets; i++)
+    {
+      b = &t->buckets[i];
+      if (b->offset == 0)
+	continue;
+
+      save_v = vnet_classify_get_entry (t, b->offset);
+      for (j = 0; j < (1 << b->log2_pages) * t->entries_per_page; j++)
+	{
+	  v = vnet_classify_entry_at_index (t, save_v, j);
+	  if (vnet_classify_entry_is_free (v))
+	    continue;
+
+	  key_minus_skip = (u8 *) v->key;
+	  key_minus_skip -= t->skip_n_vectors * sizeof (u32x4);
+	  vnet_classify_bloom_bits (
+	    bf, vnet_classify_hash_packet (t, key_minus_skip), &bit0, &bit1);
+	  bf->bits[bit0 / 64] |= 1ULL << (bit0 % 64);
+	  bf->bits[bit1 / 64] |= 1ULL << (bit1 % 64);
+	  bf->n_keys++;
+	}
+    }
+
+  clib_spinlock_unlock (&t->writer_lock);
+
+  return bf;
+}
+
+static void
+vnet_classify_bloom_free_cb (void *args)
+{
+  clib_mem_free (*(vnet_classify_bloom_t **) args);
+}
+
+static void
+vnet_classify_bloom_replace (vnet_classify_table_t *t,
+			     vnet_classify_bloom_t *bf)
+{
+  vnet_classify_bloom_t *old = t->bloom;
+
+  __atomic_store_n (&t->bloom, bf, __ATOMIC_RELEASE);
+  if (old)
+    vlib_rcu_call (vnet_classify_bloom_free_cb, &old, sizeof (old));
+}
+
+void
+vnet_classify_bloom_add (vnet_classify_table_t *t, vnet_classify_entry_t *e)
+{
+  vnet_classify_bloom_t *bf = t->bloom;
+  u32 bit0, bit1;
+  u8 *key_minus_skip;
+
+  key_minus_skip = (u8 *) e->key;
+  key_minus_skip -= t->skip_n_vectors * sizeof (u32x4);
+  vnet_classify_bloom_bits (bf, vnet_classify_hash_packet (t, key_minus_skip),
+			    &bit0, &bit1);
+
+  /* flow-classify adds sessions from the workers */
+  __atomic_fetch_or (&bf->bits[bit0 / 64], 1ULL << (bit0 % 64),
+		     __ATOMIC_RELEASE);
+  __atomic_fetch_or (&bf->bits[bit1 / 64], 1ULL << (bit1 % 64),
+		     __ATOMIC_RELEASE);
+}
+
+void
+vnet_classify_bloom_update (vnet_classify_table_t *t, int is_add)
+{
+  vnet_classify_bloom_t *bf = t->bloom;
+  u32 n_keys, n_deleted;
+
+  if (is_add)
+    n_keys = __atomic_add_fetch (&bf->n_keys, 1, __ATOMIC_RELAXED);
+  else
+    n_keys = __atomic_load_n (&bf->n_keys, __ATOMIC_RELAXED);
+  if (is_add)
+    n_deleted = __atomic_load_n (&bf->n_deleted, __ATOMIC_RELAXED);
+  else
+    n_deleted = __atomic_add_fetch (&bf->n_deleted, 1, __ATOMIC_RELAXED);
+
+  /* filters are replaced from the main thread only */
+  if (vlib_get_thread_index () != 0)
+    return;
+
+  /* rebuild at half the bits per key we aim for, or once half the keys
+     set are gone */
+  if (n_keys * VNET_CLASSIFY_BLOOM_BITS_PER_KEY / 2 > 1 << bf->log2_n_bits ||
+      (n_deleted >= 64 && n_deleted > n_keys / 2))
+    vnet_classify_bloom_replace (t, vnet_classify_bloom_build (t));
+}
+
+static int
+vnet_classify_chain_is_live (vnet_classify_main_t *cm,
+			     vnet_classify_chain_t *c)
+{
+  u32 head = c->table_indices[0];
+
+  return !pool_is_free_index (cm->tables, head) &&
+	 pool_elt_at_index (cm->tables, head)->chain_index ==
+	   c - cm->chains;
+}
+
+/* Drop the filters of the tables no compiled chain uses any more */
+static void
+vnet_classify_bloom_gc (vnet_classify_main_t *cm)
+{
+  vnet_classify_chain_t *c;
+  vnet_classify_table_t *t;
+  uword *used = 0;
+
+  pool_foreach (c, cm->chains)
+    {
+      if (!vnet_classify_chain_is_live (cm, c))
+	continue;
+      for (int i = 0; i < c->n_tables; i++)
+	used = clib_bitmap_set (used, c->table_indices[i], 1);
+    }
+
+  pool_foreach (t, cm->tables)
+    {
+      if (t->bloom && !clib_bitmap_get (used, t - cm->tables))
+	vnet_classify_bloom_replace (t, 0);
+    }
+
+  clib_bitmap_free (used);
+}
+
+static void
+vnet_classify_chain_free_cb (void *args)
+{
+  vnet_classify_main_t *cm = &vnet_classify_main;
+
+  pool_put_index (cm->chains, *(u32 *) args);
+}
+
+static void
+vnet_classify_chain_unpublish (vnet_classify_main_t *cm,
+			       vnet_classify_table_t *t)
+{
+  u32 chain_index = t->chain_index;
+
+  __atomic_store_n (&t->chain_index, ~0, __ATOMIC_RELEASE);
+  cm->n_compiled_chains--;
+  vlib_rcu_call (vnet_classify_chain_free_cb, &chain_index,
+		 sizeof (chain_index));
+}
+
+/* Compile the chain headed by table_index, leaving skip_index out */
+static int
+vnet_classify_chain_publish (vnet_classify_main_t *cm, u32 table_index,
+			     u32 skip_index)
+{
+  u32 table_indices[VNET_CLASSIFY_CHAIN_MAX_TABLES];
+  vnet_classify_chain_t *c;
+  vnet_classify_table_t *t;
+  u32 ti, n_tables = 0, old;
+
+  for (ti = table_index; ti != ~0 && ti != skip_index &&
+			 !pool_is_free_index (cm->tables, ti);
+       ti = pool_elt_at_index (cm->tables, ti)->next_table_index)
+    {
+      /* too long, or a loop */
+      if (n_tables == VNET_CLASSIFY_CHAIN_MAX_TABLES)
+	return VNET_API_ERROR_INVALID_VALUE;
+      table_indices[n_tables++] = ti;
+    }
+
+  if (n_tables == 0)
+    return VNET_API_ERROR_NO_SUCH_TABLE;
+
+  /* the workers use the filters as soon as the chain is there */
+  for (int i = 0; i < n_tables; i++)
+    {
+      t = pool_elt_at_index (cm->tables, table_indices[i]);
+      if (!t->bloom)
+	vnet_classify_bloom_replace (t, vnet_classify_bloom_build (t));
+    }
+
+  vlib_rcu_pool_get (cm->chains, c);
+  clib_memcpy_fast (c->table_indices, table_indices,
+		    n_tables * sizeof (table_indices[0]));
+  c->n_tables = n_tables;
+
+  t = pool_elt_at_index (cm->tables, table_index);
+  old = t->chain_index;
+  __atomic_store_n (&t->chain_index, c - cm->chains, __ATOMIC_RELEASE);
+
+  if (old == ~0)
+    cm->n_compiled_chains++;
+  else
+    vlib_rcu_call (vnet_classify_chain_free_cb, &old, sizeof (old));
+
+  return 0;
+}
+
+int
+vnet_classify_chain_compile (vnet_classify_main_t *cm, u32 table_index,
+			     int is_add)
+{
+  vnet_classify_table_t *t;
+  int rv = 0;
+
+  if (pool_is_free_index (cm->tables, table_index))
+    return VNET_API_ERROR_NO_SUCH_TABLE;
+
+  t = pool_elt_at_index (cm->tables, table_index);
+
+  if (is_add)
+    rv = vnet_classify_chain_publish (cm, table_index, ~0);
+  else if (t->chain_index != ~0)
+    vnet_classify_chain_unpublish (cm, t);
+  else
+    rv = VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  vnet_classify_bloom_gc (cm);
+  return rv;
+}
+
+/*
+ * A table was relinked, or is about to be deleted: compile again the
+ * chains it is in, without it if it goes.
+ */
+void
+vnet_classify_chains_update (vnet_classify_main_t *cm, u32 table_index,
+			     int is_del)
+{
+  vnet_classify_chain_t *c;
+  u32 *heads = 0, *head;
+
+  pool_foreach (c, cm->chains)
+    {
+      if (!vnet_classify_chain_is_live (cm, c))
+	continue;
+      for (int i = 0; i < c->n_tables; i++)
+	if (c->table_indices[i] == table_index)
+	  {
+	    vec_add1 (heads, c->table_indices[0]);
+	    break;
+	  }
+    }
+
+  vec_foreach (head, heads)
+    {
+      if ((is_del && head[0] == table_index) ||
+	  vnet_classify_chain_publish (cm, head[0],
+				       is_del ? table_index : ~0))
+	vnet_classify_chain_unpublish (
+	  cm, pool_elt_at_index (cm->tables, head[0]));
+    }
+
+  vec_free (heads);
+  vnet_classify_bloom_gc (cm);
+}
+
+static u8 *
+format_vnet_classify_chain (u8 *s, va_list *args)
+{
+  vnet_classify_main_t *cm = va_arg (*args, vnet_classify_main_t *);
+  vnet_classify_chain_t *c = va_arg (*args, vnet_classify_chain_t *);
+  u32 indent = format_get_indent (s);
+  vnet_classify_bloom_t *bf;
+  vnet_classify_table_t *t;
+
+  s = format (s, "[%u] head table %u, %u tables", c - cm->chains,
+	      c->table_indices[0], c->n_tables);
+
+  for (int i = 0; i < c->n_tables; i++)
+    {
+      t = pool_elt_at_index (cm->tables, c->table_indices[i]);
+      s = format (s, "\n%Utable %u: %u sessions", format_white_space,
+		  indent + 2, c->table_indices[i], t->active_elements);
+      if ((bf = t->bloom))
+	s = format (s, ", filter %u bits, %u keys, %u deleted",
+		    1 << bf->log2_n_bits, bf->n_keys, bf->n_deleted);
+    }
+
+  return s;
+}
+
+static clib_error_t *
+classify_chain_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			   vlib_cli_command_t *cmd)
+{
+  vnet_classify_main_t *cm = &vnet_classify_main;
+  u32 table_index = ~0;
+  int is_add = 1, rv;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "table %u", &table_index))
+	;
+      else if (unformat (input, "del"))
+	is_add = 0;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (table_index == ~0)
+    return clib_error_return (0, "table index required");
+
+  rv = vnet_classify_chain_compile (cm, table_index, is_add);
+
+  switch (rv)
+    {
+    case 0:
+      break;
+    case VNET_API_ERROR_NO_SUCH_TABLE:
+      return clib_error_return (0, "no such table %u", table_index);
+    case VNET_API_ERROR_NO_SUCH_ENTRY:
+      return clib_error_return (0, "table %u heads no compiled chain",
+				table_index);
+    case VNET_API_ERROR_INVALID_VALUE:
+      return clib_error_return (0, "chain longer than %u tables, or a loop",
+				VNET_CLASSIFY_CHAIN_MAX_TABLES);
+    default:
+      return clib_error_return (0, "vnet_classify_chain_compile returned %d",
+				rv);
+    }
+
+  return 0;
+}
+
+/*?
+ * Compile the chain of classifier tables headed by a table, or stop
+ * using the compiled chain with 'del'. The ip4/ip6 in/out ACL, policer
+ * classify and flow classify nodes search compiled chains a batch of
+ * packets at a time, skipping the tables which cannot match. The chain is
+ * compiled again when one of its tables is relinked or deleted.
+ *
+ * @cliexpar
+ * @cliexcmd{classify chain table 0}
+?*/
+VLIB_CLI_COMMAND (classify_chain_command, static) = {
+  .path = "classify chain",
+  .short_help = "classify chain table <table-index> [del]",
+  .function = classify_chain_command_fn,
+};
+
+static clib_error_t *
+show_classify_chains_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				 vlib_cli_command_t *cmd)
+{
+  vnet_classify_main_t *cm = &vnet_classify_main;
+  vnet_classify_chain_t *c;
+
+  if (cm->n_compiled_chains == 0)
+    {
+      vlib_cli_output (vm, "No compiled chains");
+      return 0;
+    }
+
+  pool_foreach (c, cm->chains)
+    {
+      if (vnet_classify_chain_is_live (cm, c))
+	vlib_cli_output (vm, "%U", format_vnet_classify_chain, cm, c);
+    }
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_classify_chains_command, static) = {
+  .path = "show classify chains",
+  .short_help = "show classify chains",
+  .function = show_classify_chains_command_fn,
+};
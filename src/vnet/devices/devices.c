@@ -94,6 +94,44 @@ input_rate_collector_fn (vlib_stats_collector_data_t *d)
   e2->value = now;
 }
 
+/*
+ * Packets each thread received on interfaces attached to another NUMA
+ * node, indexed by thread and sw_if_index; 0 where they are local. These
+ * are the rx counters of such interfaces, not a count of buffers from
+ * remote pools.
+ */
+static void
+rx_remote_numa_collector_fn (vlib_stats_collector_data_t *d)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_interface_main_t *im = &vnm->interface_main;
+  vlib_combined_counter_main_t *cm =
+    im->combined_sw_if_counters + VNET_INTERFACE_COUNTER_RX;
+  u32 n_threads = vlib_get_n_threads ();
+  vnet_hw_interface_t *hi;
+  counter_t **counters;
+  u32 sw_if_index, i;
+
+  vlib_stats_validate (d->entry_index, n_threads - 1,
+		       vec_len (im->sw_interfaces) - 1);
+  counters = d->entry->data;
+
+  pool_foreach (hi, im->hw_interfaces)
+    {
+      sw_if_index = hi->sw_if_index;
+      if (vec_len (hi->rx_queue_indices) == 0 ||
+	  sw_if_index >= vec_len (counters[0]))
+	continue;
+
+      for (i = 0; i < n_threads && i < vec_len (cm->counters); i++)
+	if (vlib_worker_threads[i].numa_id == hi->numa_node ||
+	    sw_if_index >= vec_len (cm->counters[i]))
+	  counters[i][sw_if_index] = 0;
+	else
+	  counters[i][sw_if_index] = cm->counters[i][sw_if_index].packets;
+    }
+}
+
 static clib_error_t *
 vnet_device_init (vlib_main_t * vm)
 {
@@ -120,6 +158,12 @@ vnet_device_init (vlib_main_t * vm)
   reg.collect_fn = input_rate_collector_fn;
   vlib_stats_register_collector_fn (&reg);
 
+  reg.private_data = 0;
+  reg.entry_index =
+    vlib_stats_add_counter_vector ("/if/rx-remote-numa-interface");
+  reg.collect_fn = rx_remote_numa_collector_fn;
+  vlib_stats_register_collector_fn (&reg);
+
   return 0;
 }
 
@@ -53,7 +53,9 @@ extern classify_dpo_t *classify_dpo_pool;
 static inline classify_dpo_t *
 classify_dpo_get (index_t index)
 {
-    return (pool_elt_at_index(classify_dpo_pool, index));
+    classify_dpo_t *pool = vlib_rcu_deref(classify_dpo_pool);
+
+    return (pool_elt_at_index(pool, index));
 }
 
 extern void classify_dpo_module_init(void);
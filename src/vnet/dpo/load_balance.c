@@ -53,6 +53,33 @@ vlib_log_class_t load_balance_logger;
  */
 load_balance_t *load_balance_pool;
 
+/**
+ * Pool of resilient hashing states. It's not static so the DP can mark
+ * the buckets it uses.
+ */
+load_balance_resilient_t *load_balance_resilient_pool;
+
+/**
+ * Resilient hashing configuration: the number of buckets a resilient
+ * load-balance has, the time a bucket must be idle before it is moved to
+ * rebalance, and the time after which the buckets of an unbalanced
+ * load-balance are moved whether idle or not.
+ */
+static u32 lb_resilient_n_buckets = 128;
+static f64 lb_resilient_idle_timer = 1.0;
+static f64 lb_resilient_unbalanced_timer = 60.0;
+
+/**
+ * Resilient hashing counters; buckets moved because their path was removed,
+ * because they were idle and because the load-balance was unbalanced for
+ * too long.
+ */
+static u64 lb_resilient_n_orphaned;
+static u64 lb_resilient_n_idle_moves;
+static u64 lb_resilient_n_forced_moves;
+
+static vlib_node_registration_t load_balance_resilient_process_node;
+
 /**
  * The one instance of load-balance main
  */
@@ -92,41 +119,54 @@ load_balance_get_buckets (load_balance_t *lb)
     }
 }
 
+static load_balance_resilient_t *
+load_balance_resilient_get (const load_balance_t *lb)
+{
+    index_t lbi = load_balance_get_index(lb);
+
+    if (lbi >= vec_len(load_balance_main.lbm_resilient_by_lb) ||
+        INDEX_INVALID == load_balance_main.lbm_resilient_by_lb[lbi])
+    {
+        return (NULL);
+    }
+    return (pool_elt_at_index(load_balance_resilient_pool,
+                              load_balance_main.lbm_resilient_by_lb[lbi]));
+}
+
 static load_balance_t *
 load_balance_alloc_i (void)
 {
     load_balance_t *lb;
     u8 need_barrier_sync = 0;
     vlib_main_t *vm = vlib_get_main();
+    u32 max_index;
     ASSERT (vm->thread_index == 0);
 
-    need_barrier_sync = pool_get_will_expand (load_balance_pool);
-
-    if (need_barrier_sync)
-        vlib_worker_thread_barrier_sync (vm);
-
-    pool_get_aligned(load_balance_pool, lb, CLIB_CACHE_LINE_BYTES);
+    /*
+     * the DP only reads the pool, so if it grows the old one is freed
+     * once the workers are done with it. The counters are written by
+     * the workers, and a copy would lose the counts made into the old
+     * one, so growing those still needs the barrier. They are sized to
+     * the pool's capacity, so that happens only when the pool grows.
+     */
+    vlib_rcu_pool_get_aligned(load_balance_pool, lb, CLIB_CACHE_LINE_BYTES);
     clib_memset(lb, 0, sizeof(*lb));
 
     lb->lb_map = INDEX_INVALID;
     lb->lb_urpf = INDEX_INVALID;
 
-    if (need_barrier_sync == 0)
-    {
-        need_barrier_sync += vlib_validate_combined_counter_will_expand
-            (&(load_balance_main.lbm_to_counters),
-             load_balance_get_index(lb));
-        need_barrier_sync += vlib_validate_combined_counter_will_expand
-            (&(load_balance_main.lbm_via_counters),
-             load_balance_get_index(lb));
-        if (need_barrier_sync)
-            vlib_worker_thread_barrier_sync (vm);
-    }
+    max_index = clib_max(pool_max_len(load_balance_pool), 1) - 1;
+    need_barrier_sync += vlib_validate_combined_counter_will_expand
+        (&(load_balance_main.lbm_to_counters), max_index);
+    need_barrier_sync += vlib_validate_combined_counter_will_expand
+        (&(load_balance_main.lbm_via_counters), max_index);
+    if (need_barrier_sync)
+        vlib_worker_thread_barrier_sync (vm);
 
     vlib_validate_combined_counter(&(load_balance_main.lbm_to_counters),
-                                   load_balance_get_index(lb));
+                                   max_index);
     vlib_validate_combined_counter(&(load_balance_main.lbm_via_counters),
-                                   load_balance_get_index(lb));
+                                   max_index);
     vlib_zero_combined_counter(&(load_balance_main.lbm_to_counters),
                                load_balance_get_index(lb));
     vlib_zero_combined_counter(&(load_balance_main.lbm_via_counters),
@@ -193,6 +233,25 @@ load_balance_format (index_t lbi,
                    format_white_space, indent+4,
                    format_load_balance_map, lb->lb_map, indent+4);
     }
+    if (lb->lb_flags & LOAD_BALANCE_FLAG_RESILIENT)
+    {
+        load_balance_resilient_t *lbr = load_balance_resilient_get(lb);
+
+        if (NULL != lbr)
+        {
+            s = format(s, "\n%Uresilient: %s",
+                       format_white_space, indent+4,
+                       (lbr->lbr_unbalanced_since ? "unbalanced" : "balanced"));
+            for (i = 0; i < vec_len(lbr->lbr_paths); i++)
+            {
+                s = format(s, "\n%Upath:%d share:%d %U",
+                           format_white_space, indent+6, i,
+                           lbr->lbr_paths[i].path_weight,
+                           format_dpo_id, &lbr->lbr_paths[i].path_dpo,
+                           indent+8);
+            }
+        }
+    }
     for (i = 0; i < lb->lb_n_buckets; i++)
     {
         s = format(s, "\n%U[%d] %U",
@@ -620,6 +679,319 @@ load_balance_fill_buckets_sticky (load_balance_t *lb,
     vec_free(fwding_paths);
 }
 
+static load_balance_resilient_t *
+load_balance_resilient_alloc (const load_balance_t *lb)
+{
+    load_balance_resilient_t *lbr;
+    index_t lbi, *by_lb, *old;
+
+    lbi = load_balance_get_index(lb);
+
+    /*
+     * the DP reads both the pool and the index vector, so if either
+     * grows a bigger copy is published in its place and the old one
+     * freed once the workers are done with it.
+     */
+    vlib_rcu_pool_get(load_balance_resilient_pool, lbr);
+    clib_memset(lbr, 0, sizeof(*lbr));
+
+    if (lbi >= vec_max_len(load_balance_main.lbm_resilient_by_lb))
+    {
+        by_lb = NULL;
+        vec_validate_init_empty(by_lb, lbi, INDEX_INVALID);
+        clib_memcpy_fast(by_lb, load_balance_main.lbm_resilient_by_lb,
+                         vec_bytes(load_balance_main.lbm_resilient_by_lb));
+
+        old = load_balance_main.lbm_resilient_by_lb;
+        __atomic_store_n(&load_balance_main.lbm_resilient_by_lb, by_lb,
+                         __ATOMIC_RELEASE);
+        vlib_rcu_vec_free(old);
+    }
+    else
+    {
+        vec_validate_init_empty(load_balance_main.lbm_resilient_by_lb, lbi,
+                                INDEX_INVALID);
+    }
+
+    clib_bitmap_alloc(lbr->lbr_active, LB_MAX_BUCKETS);
+    lbr->lbr_lb = lbi;
+    __atomic_store_n(&load_balance_main.lbm_resilient_by_lb[lbi],
+                     lbr - load_balance_resilient_pool, __ATOMIC_RELEASE);
+
+    return (lbr);
+}
+
+static void
+load_balance_resilient_free_cb (void *args)
+{
+    load_balance_resilient_t *lbr;
+
+    lbr = pool_elt_at_index(load_balance_resilient_pool, *(index_t *)args);
+
+    clib_bitmap_free(lbr->lbr_active);
+    pool_put(load_balance_resilient_pool, lbr);
+}
+
+/**
+ * The LB is no longer marked resilient, but a worker that saw the flag
+ * may still be marking buckets active, so the bitmap and the pool entry
+ * go once the workers are done with them.
+ */
+static void
+load_balance_resilient_free (const load_balance_t *lb)
+{
+    load_balance_resilient_t *lbr;
+    load_balance_path_t *path;
+    index_t lbri;
+
+    lbr = load_balance_resilient_get(lb);
+
+    if (NULL == lbr)
+        return;
+
+    ASSERT(!(lb->lb_flags & LOAD_BALANCE_FLAG_RESILIENT));
+
+    __atomic_store_n(&load_balance_main.lbm_resilient_by_lb[
+                         load_balance_get_index(lb)],
+                     INDEX_INVALID, __ATOMIC_RELEASE);
+
+    vec_foreach(path, lbr->lbr_paths)
+    {
+        dpo_reset(&path->path_dpo);
+    }
+    vec_free(lbr->lbr_paths);
+    vec_free(lbr->lbr_owner);
+
+    /* skipped by the scan and the show until it is freed */
+    lbr->lbr_lb = INDEX_INVALID;
+    lbr->lbr_unbalanced_since = 0;
+
+    lbri = lbr - load_balance_resilient_pool;
+    vlib_rcu_call(load_balance_resilient_free_cb, &lbri, sizeof(lbri));
+}
+
+/**
+ * @brief Share the buckets amongst the paths in proportion to their weights,
+ * the largest remainders get the buckets left over. The share of each path
+ * replaces its weight.
+ */
+static void
+load_balance_resilient_share (load_balance_path_t *paths,
+                              u32 n_buckets)
+{
+    u32 sum_of_weights, n_shared, ii, best;
+    u64 *remainders;
+
+    sum_of_weights = n_shared = 0;
+    remainders = NULL;
+
+    vec_foreach_index(ii, paths)
+    {
+        sum_of_weights += paths[ii].path_weight;
+    }
+    vec_validate(remainders, vec_len(paths) - 1);
+
+    vec_foreach_index(ii, paths)
+    {
+        u64 share = (u64) paths[ii].path_weight * n_buckets;
+
+        remainders[ii] = share % sum_of_weights;
+        paths[ii].path_weight = share / sum_of_weights;
+        n_shared += paths[ii].path_weight;
+    }
+    while (n_shared < n_buckets)
+    {
+        best = 0;
+        vec_foreach_index(ii, paths)
+        {
+            if (remainders[ii] > remainders[best])
+                best = ii;
+        }
+        paths[best].path_weight++;
+        remainders[best] = 0;
+        n_shared++;
+    }
+    vec_free(remainders);
+}
+
+/**
+ * @brief the path that is furthest below its share of buckets
+ */
+static u16
+load_balance_resilient_neediest (const load_balance_path_t *paths,
+                                 const u32 *n_owned)
+{
+    i32 need, most;
+    u16 ii, best;
+
+    best = 0;
+    most = (i32) paths[0].path_weight - (i32) n_owned[0];
+
+    for (ii = 1; ii < vec_len(paths); ii++)
+    {
+        need = (i32) paths[ii].path_weight - (i32) n_owned[ii];
+        if (need > most)
+        {
+            most = need;
+            best = ii;
+        }
+    }
+    return (best);
+}
+
+static int
+load_balance_resilient_is_balanced (const load_balance_resilient_t *lbr)
+{
+    u32 *n_owned = NULL, ii;
+    int balanced = 1;
+
+    vec_validate(n_owned, vec_len(lbr->lbr_paths) - 1);
+    vec_foreach_index(ii, lbr->lbr_owner)
+    {
+        n_owned[lbr->lbr_owner[ii]]++;
+    }
+    vec_foreach_index(ii, lbr->lbr_paths)
+    {
+        if (n_owned[ii] != lbr->lbr_paths[ii].path_weight)
+            balanced = 0;
+    }
+    vec_free(n_owned);
+
+    return (balanced);
+}
+
+static void
+load_balance_fill_buckets_resilient (load_balance_t *lb,
+                                     load_balance_path_t *nhs,
+                                     dpo_id_t *buckets,
+                                     u32 n_buckets)
+{
+    load_balance_path_t *paths, *nh, *path;
+    load_balance_resilient_t *lbr;
+    u32 *n_owned, *old_to_new, ii, jj;
+    u16 *owner, o;
+    f64 now;
+
+    lbr = load_balance_resilient_get(lb);
+    if (NULL == lbr)
+    {
+        lbr = load_balance_resilient_alloc(lb);
+    }
+
+    /*
+     * as with sticky, paths that drop do not own buckets, unless all do.
+     */
+    paths = NULL;
+    vec_foreach (nh, nhs)
+    {
+        if (!dpo_is_drop(&nh->path_dpo))
+        {
+            vec_add2(paths, path, 1);
+            path->path_index = nh->path_index;
+            path->path_weight = nh->path_weight;
+            dpo_copy(&path->path_dpo, &nh->path_dpo);
+        }
+    }
+    if (0 == vec_len(paths))
+    {
+        vec_foreach (nh, nhs)
+        {
+            vec_add2(paths, path, 1);
+            path->path_index = nh->path_index;
+            path->path_weight = nh->path_weight;
+            dpo_copy(&path->path_dpo, &nh->path_dpo);
+        }
+    }
+    load_balance_resilient_share(paths, n_buckets);
+
+    /*
+     * the buckets owned by a path that remains keep their owner. This is
+     * only possible if the number of buckets has not changed.
+     */
+    old_to_new = NULL;
+    vec_validate_init_empty(old_to_new, vec_len(lbr->lbr_paths), ~0);
+    vec_foreach_index(ii, lbr->lbr_paths)
+    {
+        vec_foreach_index(jj, paths)
+        {
+            if (0 == dpo_cmp(&lbr->lbr_paths[ii].path_dpo,
+                             &paths[jj].path_dpo))
+            {
+                old_to_new[ii] = jj;
+                break;
+            }
+        }
+    }
+
+    owner = NULL;
+    n_owned = NULL;
+    vec_validate_init_empty(owner, n_buckets - 1, (u16) ~0);
+    vec_validate(n_owned, vec_len(paths) - 1);
+
+    if (vec_len(lbr->lbr_owner) == n_buckets)
+    {
+        for (ii = 0; ii < n_buckets; ii++)
+        {
+            o = lbr->lbr_owner[ii];
+
+            if (~0 != old_to_new[o])
+            {
+                owner[ii] = old_to_new[o];
+                n_owned[owner[ii]]++;
+            }
+        }
+    }
+
+    /*
+     * the buckets that lost their owner must move now, to the paths most
+     * in need
+     */
+    for (ii = 0; ii < n_buckets; ii++)
+    {
+        if ((u16) ~0 == owner[ii])
+        {
+            owner[ii] = load_balance_resilient_neediest(paths, n_owned);
+            n_owned[owner[ii]]++;
+            lb_resilient_n_orphaned++;
+        }
+        load_balance_set_bucket_i(lb, ii, buckets,
+                                  &paths[owner[ii]].path_dpo);
+    }
+
+    vec_foreach(path, lbr->lbr_paths)
+    {
+        dpo_reset(&path->path_dpo);
+    }
+    vec_free(lbr->lbr_paths);
+    vec_free(lbr->lbr_owner);
+    lbr->lbr_paths = paths;
+    lbr->lbr_owner = owner;
+
+    /*
+     * the others move when they are idle.
+     */
+    if (load_balance_resilient_is_balanced(lbr))
+    {
+        lbr->lbr_unbalanced_since = 0;
+    }
+    else if (0 == lbr->lbr_unbalanced_since)
+    {
+        vlib_main_t *vm = vlib_get_main();
+
+        now = vlib_time_now(vm);
+        lbr->lbr_unbalanced_since = now;
+        lbr->lbr_last_scan = now;
+        clib_bitmap_zero(lbr->lbr_active);
+
+        vlib_process_signal_event(vm,
+                                  load_balance_resilient_process_node.index,
+                                  0, 0);
+    }
+
+    vec_free(n_owned);
+    vec_free(old_to_new);
+}
+
 static void
 load_balance_fill_buckets (load_balance_t *lb,
                            load_balance_path_t *nhs,
@@ -627,7 +999,11 @@ load_balance_fill_buckets (load_balance_t *lb,
                            u32 n_buckets,
                            load_balance_flags_t flags)
 {
-    if (flags & LOAD_BALANCE_FLAG_STICKY)
+    if (flags & LOAD_BALANCE_FLAG_RESILIENT)
+    {
+        load_balance_fill_buckets_resilient(lb, nhs, buckets, n_buckets);
+    }
+    else if (flags & LOAD_BALANCE_FLAG_STICKY)
     {
         load_balance_fill_buckets_sticky(lb, nhs, buckets, n_buckets);
     }
@@ -646,6 +1022,28 @@ load_balance_set_n_buckets (load_balance_t *lb,
     lb->lb_n_buckets_minus_1 = n_buckets-1;
 }
 
+static void
+load_balance_buckets_free_cb (void *args)
+{
+    dpo_id_t *buckets = *(dpo_id_t **)args, *tmp_dpo;
+
+    vec_foreach(tmp_dpo, buckets)
+    {
+        dpo_reset(tmp_dpo);
+    }
+    vec_free(buckets);
+}
+
+/**
+ * Release the out-of-line buckets an LB no longer uses, once the
+ * workers can no longer be reading them, or what they point to.
+ */
+static void
+load_balance_buckets_free (dpo_id_t *buckets)
+{
+    vlib_rcu_call(load_balance_buckets_free_cb, &buckets, sizeof(buckets));
+}
+
 void
 load_balance_multipath_update (const dpo_id_t *dpo,
                                const load_balance_path_t * raw_nhs,
@@ -655,13 +1053,28 @@ load_balance_multipath_update (const dpo_id_t *dpo,
     u32 sum_of_weights, n_buckets, ii;
     index_t lbmi, old_lbmi;
     load_balance_t *lb;
-    dpo_id_t *tmp_dpo;
 
     nhs = NULL;
 
     ASSERT(DPO_LOAD_BALANCE == dpo->dpoi_type);
     lb = load_balance_get(dpo->dpoi_index);
-    lb->lb_flags = flags;
+
+    if (flags & LOAD_BALANCE_FLAG_RESILIENT)
+    {
+        /*
+         * the buckets are assigned to paths individually, so a map is of
+         * no use.
+         */
+        flags &= ~LOAD_BALANCE_FLAG_USES_MAP;
+    }
+    /*
+     * the DP finds the resilient state from the flag, so the flag is set
+     * only once that state is built below, and cleared before it is freed.
+     */
+    __atomic_store_n(&lb->lb_flags,
+                     (flags & ~LOAD_BALANCE_FLAG_RESILIENT) |
+                     (flags & lb->lb_flags & LOAD_BALANCE_FLAG_RESILIENT),
+                     __ATOMIC_RELEASE);
     fixed_nhs = load_balance_multipath_next_hop_fixup(raw_nhs, lb->lb_proto);
     n_buckets =
         ip_multipath_normalize_next_hops((NULL == fixed_nhs ?
@@ -671,6 +1084,18 @@ load_balance_multipath_update (const dpo_id_t *dpo,
                                          &sum_of_weights,
                                          multipath_next_hop_error_tolerance);
 
+    if (flags & LOAD_BALANCE_FLAG_RESILIENT)
+    {
+        /*
+         * a resilient load-balance keeps its number of buckets, unless
+         * the paths need more.
+         */
+        n_buckets = clib_max(n_buckets,
+                             (NULL != load_balance_resilient_get(lb) ?
+                              lb->lb_n_buckets :
+                              lb_resilient_n_buckets));
+    }
+
     /*
      * Save the old load-balance map used, and get a new one if required.
      */
@@ -776,7 +1201,7 @@ load_balance_multipath_update (const dpo_id_t *dpo,
                      * we are not crossing the threshold. We need a new bucket array to
                      * hold the increased number of choices.
                      */
-                    dpo_id_t *new_buckets, *old_buckets, *tmp_dpo;
+                    dpo_id_t *new_buckets, *old_buckets;
 
                     new_buckets = NULL;
                     old_buckets = load_balance_get_buckets(lb);
@@ -792,11 +1217,7 @@ load_balance_multipath_update (const dpo_id_t *dpo,
                     CLIB_MEMORY_BARRIER();
                     load_balance_set_n_buckets(lb, n_buckets);
 
-                    vec_foreach(tmp_dpo, old_buckets)
-                    {
-                        dpo_reset(tmp_dpo);
-                    }
-                    vec_free(old_buckets);
+                    load_balance_buckets_free(old_buckets);
                 }
             }
 
@@ -835,11 +1256,8 @@ load_balance_multipath_update (const dpo_id_t *dpo,
                 load_balance_set_n_buckets(lb, n_buckets);
                 CLIB_MEMORY_BARRIER();
 
-                vec_foreach(tmp_dpo, lb->lb_buckets)
-                {
-                    dpo_reset(tmp_dpo);
-                }
-                vec_free(lb->lb_buckets);
+                load_balance_buckets_free(lb->lb_buckets);
+                lb->lb_buckets = NULL;
             }
             else
             {
@@ -876,6 +1294,15 @@ load_balance_multipath_update (const dpo_id_t *dpo,
     vec_free(nhs);
     vec_free(fixed_nhs);
 
+    if (flags & LOAD_BALANCE_FLAG_RESILIENT)
+    {
+        __atomic_store_n(&lb->lb_flags, flags, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        load_balance_resilient_free(lb);
+    }
+
     load_balance_map_unlock(old_lbmi);
 }
 
@@ -911,6 +1338,8 @@ load_balance_destroy (load_balance_t *lb)
 
     fib_urpf_list_unlock(lb->lb_urpf);
     load_balance_map_unlock(lb->lb_map);
+    lb->lb_flags &= ~LOAD_BALANCE_FLAG_RESILIENT;
+    load_balance_resilient_free(lb);
 
     need_barrier_sync = pool_put_will_expand (load_balance_pool, lb);
     if (PREDICT_FALSE (need_barrier_sync))
@@ -1101,6 +1530,211 @@ VLIB_CLI_COMMAND (load_balance_show_command, static) = {
     .function = load_balance_show,
 };
 
+/**
+ * @brief Move the idle buckets of an unbalanced resilient load-balance
+ * to the paths that are short of their share.
+ */
+static void
+load_balance_resilient_rebalance (load_balance_resilient_t *lbr,
+                                  f64 now)
+{
+    u32 *n_owned, ii, o, n;
+    load_balance_t *lb;
+    dpo_id_t *buckets;
+    int forced;
+
+    lb = load_balance_get(lbr->lbr_lb);
+    buckets = load_balance_get_buckets(lb);
+    forced = (now - lbr->lbr_unbalanced_since >=
+              lb_resilient_unbalanced_timer);
+    n_owned = NULL;
+
+    vec_validate(n_owned, vec_len(lbr->lbr_paths) - 1);
+    vec_foreach_index(ii, lbr->lbr_owner)
+    {
+        n_owned[lbr->lbr_owner[ii]]++;
+    }
+
+    vec_foreach_index(ii, lbr->lbr_owner)
+    {
+        o = lbr->lbr_owner[ii];
+
+        if (n_owned[o] <= lbr->lbr_paths[o].path_weight)
+            continue;
+        if (!forced && clib_bitmap_get(lbr->lbr_active, ii))
+            continue;
+
+        n = load_balance_resilient_neediest(lbr->lbr_paths, n_owned);
+
+        if (n_owned[n] >= lbr->lbr_paths[n].path_weight)
+            break;
+
+        n_owned[o]--;
+        n_owned[n]++;
+        lbr->lbr_owner[ii] = n;
+        load_balance_set_bucket_i(lb, ii, buckets,
+                                  &lbr->lbr_paths[n].path_dpo);
+
+        if (forced)
+            lb_resilient_n_forced_moves++;
+        else
+            lb_resilient_n_idle_moves++;
+    }
+
+    vec_free(n_owned);
+}
+
+u32
+load_balance_resilient_scan (f64 now)
+{
+    load_balance_resilient_t *lbr;
+    u32 n_unbalanced;
+
+    n_unbalanced = 0;
+
+    pool_foreach (lbr, load_balance_resilient_pool)
+    {
+        if (0 == lbr->lbr_unbalanced_since)
+            continue;
+
+        /*
+         * a bucket is idle if it has not been used since the last scan,
+         * which must be at least the idle time ago.
+         */
+        if (now - lbr->lbr_last_scan >= lb_resilient_idle_timer)
+        {
+            load_balance_resilient_rebalance(lbr, now);
+
+            lbr->lbr_last_scan = now;
+            clib_bitmap_zero(lbr->lbr_active);
+
+            if (load_balance_resilient_is_balanced(lbr))
+            {
+                lbr->lbr_unbalanced_since = 0;
+                continue;
+            }
+        }
+        n_unbalanced++;
+    }
+
+    return (n_unbalanced);
+}
+
+void
+load_balance_resilient_set_timers (f64 idle, f64 unbalanced)
+{
+    lb_resilient_idle_timer = idle;
+    lb_resilient_unbalanced_timer = unbalanced;
+}
+
+static uword
+load_balance_resilient_process (vlib_main_t * vm,
+                                vlib_node_runtime_t * rt,
+                                vlib_frame_t * f)
+{
+    u32 n_unbalanced = 0;
+
+    while (1)
+    {
+        if (n_unbalanced)
+            vlib_process_wait_for_event_or_clock(vm, lb_resilient_idle_timer);
+        else
+            vlib_process_wait_for_event(vm);
+
+        vlib_process_get_events(vm, NULL);
+
+        n_unbalanced = load_balance_resilient_scan(vlib_time_now(vm));
+    }
+    return (0);
+}
+
+VLIB_REGISTER_NODE (load_balance_resilient_process_node, static) = {
+    .function = load_balance_resilient_process,
+    .type = VLIB_NODE_TYPE_PROCESS,
+    .name = "load-balance-resilient-process",
+};
+
+static clib_error_t *
+load_balance_resilient_set (vlib_main_t * vm,
+                            unformat_input_t * input,
+                            vlib_cli_command_t * cmd)
+{
+    f64 idle, unbalanced;
+    u32 n_buckets;
+
+    n_buckets = lb_resilient_n_buckets;
+    idle = lb_resilient_idle_timer;
+    unbalanced = lb_resilient_unbalanced_timer;
+
+    while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+        if (unformat (input, "buckets %d", &n_buckets))
+            ;
+        else if (unformat (input, "idle-timer %f", &idle))
+            ;
+        else if (unformat (input, "unbalanced-timer %f", &unbalanced))
+            ;
+        else
+            return (clib_error_return (0, "unknown input '%U'",
+                                       format_unformat_error, input));
+    }
+
+    if (!is_pow2(n_buckets) || n_buckets > LB_MAX_BUCKETS)
+        return (clib_error_return (0, "buckets must be a power of 2 <= %d",
+                                   LB_MAX_BUCKETS));
+
+    lb_resilient_n_buckets = n_buckets;
+    load_balance_resilient_set_timers(idle, unbalanced);
+
+    return (NULL);
+}
+
+/*?
+ * Configure resilient hashing for the load-balances that use it, e.g. the
+ * routes added with the 'resilient' flag. The number of buckets applies to
+ * load-balances that become resilient after it is set.
+ *
+ * @cliexpar
+ * @cliexcmd{set load-balance resilient buckets 256 idle-timer 2}
+ ?*/
+VLIB_CLI_COMMAND (load_balance_resilient_set_command, static) = {
+    .path = "set load-balance resilient",
+    .short_help = "set load-balance resilient [buckets <n>] "
+                  "[idle-timer <secs>] [unbalanced-timer <secs>]",
+    .function = load_balance_resilient_set,
+};
+
+static clib_error_t *
+load_balance_resilient_show (vlib_main_t * vm,
+                             unformat_input_t * input,
+                             vlib_cli_command_t * cmd)
+{
+    load_balance_resilient_t *lbr;
+
+    vlib_cli_output (vm, "buckets:%d idle-timer:%.2f unbalanced-timer:%.2f",
+                     lb_resilient_n_buckets, lb_resilient_idle_timer,
+                     lb_resilient_unbalanced_timer);
+    vlib_cli_output (vm, "moved: orphaned:%lld idle:%lld forced:%lld",
+                     lb_resilient_n_orphaned, lb_resilient_n_idle_moves,
+                     lb_resilient_n_forced_moves);
+
+    pool_foreach (lbr, load_balance_resilient_pool)
+    {
+        if (INDEX_INVALID == lbr->lbr_lb)
+            continue;
+        vlib_cli_output (vm, "%U", format_load_balance, lbr->lbr_lb,
+                         LOAD_BALANCE_FORMAT_NONE);
+    }
+
+    return (NULL);
+}
+
+VLIB_CLI_COMMAND (load_balance_resilient_show_command, static) = {
+    .path = "show load-balance resilient",
+    .short_help = "show load-balance resilient",
+    .function = load_balance_resilient_show,
+};
+
 
 always_inline u32
 ip_flow_hash (void *data)
@@ -45,6 +45,11 @@ typedef struct load_balance_main_t_
 {
     vlib_combined_counter_main_t lbm_to_counters;
     vlib_combined_counter_main_t lbm_via_counters;
+
+    /**
+     * Per-load-balance index of its resilient hashing state
+     */
+    index_t *lbm_resilient_by_lb;
 } load_balance_main_t;
 
 extern load_balance_main_t load_balance_main;
@@ -88,20 +93,23 @@ typedef struct load_balance_path_t_ {
 typedef enum load_balance_attr_t_ {
     LOAD_BALANCE_ATTR_USES_MAP = 0,
     LOAD_BALANCE_ATTR_STICKY = 1,
+    LOAD_BALANCE_ATTR_RESILIENT = 2,
 } load_balance_attr_t;
 
 #define LOAD_BALANCE_ATTR_NAMES  {                  \
     [LOAD_BALANCE_ATTR_USES_MAP] = "uses-map",      \
     [LOAD_BALANCE_ATTR_STICKY] = "sticky",          \
+    [LOAD_BALANCE_ATTR_RESILIENT] = "resilient",    \
 }
 
 #define FOR_EACH_LOAD_BALANCE_ATTR(_attr)                       \
-    for (_attr = 0; _attr <= LOAD_BALANCE_ATTR_STICKY; _attr++)
+    for (_attr = 0; _attr <= LOAD_BALANCE_ATTR_RESILIENT; _attr++)
 
 typedef enum load_balance_flags_t_ {
     LOAD_BALANCE_FLAG_NONE = 0,
     LOAD_BALANCE_FLAG_USES_MAP = (1 << 0),
     LOAD_BALANCE_FLAG_STICKY = (1 << 1),
+    LOAD_BALANCE_FLAG_RESILIENT = (1 << 2),
 } __attribute__((packed)) load_balance_flags_t;
 
 /**
@@ -187,6 +195,51 @@ STATIC_ASSERT (LB_MAX_BUCKETS <= CLIB_U16_MAX,
 STATIC_ASSERT (LB_MAX_BUCKETS && !(LB_MAX_BUCKETS & (LB_MAX_BUCKETS - 1)),
 	       "LB_MAX_BUCKETS must be a power of 2");
 
+/**
+ * @brief Resilient hashing state of a load-balance.
+ *
+ * A resilient load-balance has a fixed number of buckets, each owned by
+ * one path. When a path is removed only the buckets it owned are moved.
+ * When a path is added, or the weights change, buckets are moved to
+ * rebalance only once they have been idle, so flows in progress keep
+ * their path without the need for per-flow state.
+ */
+typedef struct load_balance_resilient_t_ {
+    /**
+     * Bitmap of the buckets the data-plane has used since the last scan.
+     * Sized for LB_MAX_BUCKETS so it is never reallocated.
+     */
+    uword *lbr_active;
+
+    /**
+     * The paths. The path's weight is the number of buckets it should own
+     */
+    load_balance_path_t *lbr_paths;
+
+    /**
+     * Per-bucket, the index in lbr_paths of the owner
+     */
+    u16 *lbr_owner;
+
+    /**
+     * The load-balance this is the state of
+     */
+    index_t lbr_lb;
+
+    /**
+     * The time the buckets were first found not to match the paths' weights,
+     * zero if they do.
+     */
+    f64 lbr_unbalanced_since;
+
+    /**
+     * The time the active buckets were last cleared
+     */
+    f64 lbr_last_scan;
+} load_balance_resilient_t;
+
+extern load_balance_resilient_t *load_balance_resilient_pool;
+
 /**
  * Flags controlling load-balance formatting/display
  */
@@ -222,6 +275,14 @@ extern u16 load_balance_n_buckets(index_t lbi);
 
 extern f64 load_balance_get_multipath_tolerance(void);
 
+/**
+ * Scan the resilient load-balances and move the idle buckets of those that
+ * are unbalanced. Returns the number that remain unbalanced.
+ * Run periodically by a process; exposed for testing.
+ */
+extern u32 load_balance_resilient_scan(f64 now);
+extern void load_balance_resilient_set_timers(f64 idle, f64 unbalanced);
+
 /**
  * The encapsulation breakages are for fast DP access
  */
@@ -229,20 +290,67 @@ extern load_balance_t *load_balance_pool;
 static inline load_balance_t*
 load_balance_get (index_t lbi)
 {
-    return (pool_elt_at_index(load_balance_pool, lbi));
+    load_balance_t *pool = vlib_rcu_deref(load_balance_pool);
+
+    return (pool_elt_at_index(pool, lbi));
 }
 
 static inline load_balance_t *
 load_balance_get_or_null (index_t lbi)
 {
-  if (pool_is_free_index (load_balance_pool, lbi))
+  load_balance_t *pool = vlib_rcu_deref (load_balance_pool);
+
+  if (pool_is_free_index (pool, lbi))
     return 0;
-  return (pool_elt_at_index (load_balance_pool, lbi));
+  return (pool_elt_at_index (pool, lbi));
 }
 
 #define LB_HAS_INLINE_BUCKETS(_lb)		\
     ((_lb)->lb_n_buckets <= LB_NUM_INLINE_BUCKETS)
 
+/**
+ * Note the use of a resilient load-balance's bucket, so that it is not
+ * considered idle. The bit is tested first so that, once set, the
+ * cache-line is not written again until the next scan. A worker that
+ * races with the LB ceasing to be resilient may find no state.
+ *
+ * The LB may have been looked up in a copy of the pool that has since
+ * been replaced by a bigger one. Its index is not known then, and the
+ * use is not noted; the flow's next packet notes it. The active bitmap
+ * is allocated apart from the resilient pool, so a bit set through an
+ * old copy of that pool is not lost.
+ */
+static inline void
+load_balance_resilient_mark_active (const load_balance_t *lb,
+                                    u32 bucket)
+{
+    load_balance_resilient_t *lbr;
+    load_balance_t *pool;
+    index_t *by_lb, lbri, lbi;
+    uword *active, bit;
+
+    pool = vlib_rcu_deref(load_balance_pool);
+    if (PREDICT_FALSE(lb < pool || lb >= pool + vec_len(pool)))
+        return;
+    lbi = lb - pool;
+    by_lb = vlib_rcu_deref(load_balance_main.lbm_resilient_by_lb);
+    if (PREDICT_FALSE(lbi >= vec_len(by_lb)))
+        return;
+    lbri = __atomic_load_n(&by_lb[lbi], __ATOMIC_ACQUIRE);
+    if (PREDICT_FALSE(INDEX_INVALID == lbri))
+        return;
+
+    lbr = vlib_rcu_deref(load_balance_resilient_pool);
+    lbr = pool_elt_at_index(lbr, lbri);
+    active = &lbr->lbr_active[bucket / uword_bits];
+    bit = (uword) 1 << (bucket % uword_bits);
+
+    if (!(*active & bit))
+    {
+        __atomic_fetch_or(active, bit, __ATOMIC_RELAXED);
+    }
+}
+
 static inline const dpo_id_t *
 load_balance_get_bucket_i (const load_balance_t *lb,
 			   u32 bucket)
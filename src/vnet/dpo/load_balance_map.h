@@ -76,7 +76,9 @@ extern load_balance_map_t *load_balance_map_pool;
 static inline load_balance_map_t*
 load_balance_map_get (index_t lbmi)
 {
-    return (pool_elt_at_index(load_balance_map_pool, lbmi));
+    load_balance_map_t *pool = vlib_rcu_deref(load_balance_map_pool);
+
+    return (pool_elt_at_index(pool, lbmi));
 }
 
 static inline u16
@@ -100,6 +102,10 @@ load_balance_get_fwd_bucket (const load_balance_t *lb,
     {
         bucket = load_balance_map_translate(lb->lb_map, bucket);
     }
+    else if (PREDICT_FALSE(lb->lb_flags & LOAD_BALANCE_FLAG_RESILIENT))
+    {
+        load_balance_resilient_mark_active(lb, bucket);
+    }
 
     if (PREDICT_TRUE(LB_HAS_INLINE_BUCKETS(lb)))
     {
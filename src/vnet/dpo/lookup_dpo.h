@@ -126,7 +126,9 @@ extern lookup_dpo_t *lookup_dpo_pool;
 static inline lookup_dpo_t *
 lookup_dpo_get (index_t index)
 {
-    return (pool_elt_at_index(lookup_dpo_pool, index));
+    lookup_dpo_t *pool = vlib_rcu_deref(lookup_dpo_pool);
+
+    return (pool_elt_at_index(pool, index));
 }
 
 extern void lookup_dpo_module_init(void);
@@ -145,7 +145,9 @@ extern mpls_label_dpo_t *mpls_label_dpo_pool;
 static inline mpls_label_dpo_t *
 mpls_label_dpo_get (index_t index)
 {
-    return (pool_elt_at_index(mpls_label_dpo_pool, index));
+    mpls_label_dpo_t *pool = vlib_rcu_deref(mpls_label_dpo_pool);
+
+    return (pool_elt_at_index(pool, index));
 }
 
 extern void mpls_label_dpo_module_init(void);
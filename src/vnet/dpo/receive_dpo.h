@@ -64,7 +64,9 @@ extern receive_dpo_t *receive_dpo_pool;
 static inline receive_dpo_t *
 receive_dpo_get (index_t index)
 {
-    return (pool_elt_at_index(receive_dpo_pool, index));
+    receive_dpo_t *pool = vlib_rcu_deref(receive_dpo_pool);
+
+    return (pool_elt_at_index(pool, index));
 }
 
 #endif
@@ -50,7 +50,9 @@ vlib_log_class_t fib_entry_logger;
 fib_entry_t *
 fib_entry_get (fib_node_index_t index)
 {
-    return (pool_elt_at_index(fib_entry_pool, index));
+    fib_entry_t *pool = vlib_rcu_deref(fib_entry_pool);
+
+    return (pool_elt_at_index(pool, index));
 }
 
 static fib_node_t *
@@ -537,17 +539,13 @@ fib_entry_alloc (u32 fib_index,
 {
     fib_entry_t *fib_entry;
     fib_prefix_t *fep;
-    u8 need_barrier_sync = pool_get_will_expand (fib_entry_pool);
-    vlib_main_t *vm = vlib_get_main();
-    ASSERT (vm->thread_index == 0);
-
-    if (need_barrier_sync)
-        vlib_worker_thread_barrier_sync (vm);
-
-    pool_get(fib_entry_pool, fib_entry);
+    ASSERT (vlib_get_thread_index() == 0);
 
-    if (need_barrier_sync)
-        vlib_worker_thread_barrier_release (vm);
+    /*
+     * the workers may be reading the pool, so if it grows the old one
+     * is freed once they are done with it.
+     */
+    vlib_rcu_pool_get(fib_entry_pool, fib_entry);
 
     clib_memset(fib_entry, 0, sizeof(*fib_entry));
 
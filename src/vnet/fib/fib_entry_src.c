@@ -269,6 +269,14 @@ static load_balance_flags_t
 fib_entry_calc_lb_flags (fib_entry_src_collect_forwarding_ctx_t *ctx,
                          const fib_entry_src_t *esrc)
 {
+    /**
+     * Resilient hashing assigns each bucket to a path, so it has no need
+     * for a map.
+     */
+    if (esrc->fes_entry_flags & FIB_ENTRY_FLAG_RESILIENT)
+    {
+        return (LOAD_BALANCE_FLAG_RESILIENT);
+    }
     /**
      * We'll use a LB map if the path-list has multiple recursive paths.
      * recursive paths implies BGP, and hence scale.
@@ -521,6 +529,35 @@ fib_entry_src_collect_forwarding (fib_node_index_t pl_index,
     return (FIB_PATH_LIST_WALK_CONTINUE);
 }
 
+/*
+ * fib_entry_src_use_pic
+ *
+ * An entry can share the load-balance of its path-list when that load-balance
+ * is exactly what the entry would build for itself; i.e. there are no path
+ * extensions nor interposers to stack and no special DPO.
+ */
+static int
+fib_entry_src_use_pic (const fib_entry_t *fib_entry,
+                       const fib_entry_src_t *esrc,
+                       u32 start, u32 end,
+                       fib_forward_chain_type_t fct)
+{
+    if (!fib_path_list_is_pic(esrc->fes_pl))
+        return (0);
+    if (start != end)
+        return (0);
+    if (0 != vec_len(esrc->fes_path_exts.fpel_exts))
+        return (0);
+    if (esrc->fes_entry_flags & (FIB_ENTRY_FLAG_EXCLUSIVE |
+                                 FIB_ENTRY_FLAG_MULTICAST |
+                                 FIB_ENTRY_FLAG_RESILIENT))
+        return (0);
+
+    return ((FIB_FORW_CHAIN_TYPE_UNICAST_IP4 == fct ||
+             FIB_FORW_CHAIN_TYPE_UNICAST_IP6 == fct) &&
+            fct == fib_entry_get_default_chain_type(fib_entry));
+}
+
 void
 fib_entry_src_mk_lb (fib_entry_t *fib_entry,
                      fib_source_t source,
@@ -584,9 +621,31 @@ fib_entry_src_mk_lb (fib_entry_t *fib_entry,
 
     lb_proto = fib_forw_chain_type_to_dpo_proto(fct);
 
-    fib_path_list_walk(esrc->fes_pl,
-                       fib_entry_src_collect_forwarding,
-                       &ctx);
+    if (fib_entry_src_use_pic(fib_entry, esrc, start, end, fct))
+    {
+        /*
+         * the path-list's shared load-balance is the only choice. It is
+         * updated in place when the paths change state, so this entry
+         * converges without being re-evaluated.
+         */
+        load_balance_path_t *nh;
+        flow_hash_config_t fhc;
+
+        fhc = fib_table_get_flow_hash_config(fib_entry->fe_fib_index,
+                                             dpo_proto_to_fib(lb_proto));
+
+        vec_add2(ctx.next_hops, nh, 1);
+        nh->path_index = FIB_NODE_INDEX_INVALID;
+        nh->path_weight = 1;
+        fib_path_list_contribute_pic_forwarding(esrc->fes_pl, fct, fhc,
+                                                &nh->path_dpo);
+    }
+    else
+    {
+        fib_path_list_walk(esrc->fes_pl,
+                           fib_entry_src_collect_forwarding,
+                           &ctx);
+    }
 
     if (esrc->fes_entry_flags & FIB_ENTRY_FLAG_EXCLUSIVE)
     {
@@ -742,9 +801,17 @@ fib_entry_src_action_install (fib_entry_t *fib_entry,
     });
 }
 
+static void
+fib_entry_src_lb_unlock (void *args)
+{
+    dpo_reset((dpo_id_t*)args);
+}
+
 void
 fib_entry_src_action_uninstall (fib_entry_t *fib_entry)
 {
+    dpo_id_t invalid = DPO_INVALID;
+
     /*
      * uninstall the forwarding chain from the forwarding tables
      */
@@ -757,8 +824,13 @@ fib_entry_src_action_uninstall (fib_entry_t *fib_entry)
 	    &fib_entry->fe_prefix,
 	    &fib_entry->fe_lb);
 
-	vlib_worker_wait_one_loop();
-	dpo_reset(&fib_entry->fe_lb);
+	/*
+	 * the workers may still be using the LB, so its lock is released
+	 * once they are done with it.
+	 */
+	vlib_rcu_call(fib_entry_src_lb_unlock, &fib_entry->fe_lb,
+		      sizeof(fib_entry->fe_lb));
+	fib_entry->fe_lb = invalid;
     }
 }
 
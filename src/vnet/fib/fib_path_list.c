@@ -37,6 +37,28 @@
  */
 #define FIB_PATH_LIST_POPULAR 64
 
+/**
+ * A load-balance shared by the children of a PIC path-list
+ */
+typedef struct fib_path_list_pic_lb_t_
+{
+    /**
+     * The chain type and flow-hash config the children asked for
+     */
+    fib_forward_chain_type_t fppl_fct;
+    flow_hash_config_t fppl_fhc;
+
+    /**
+     * The next-hops the load-balance was last built from
+     */
+    load_balance_path_t *fppl_nhs;
+
+    /**
+     * The load-balance
+     */
+    dpo_id_t fppl_dpo;
+} fib_path_list_pic_lb_t;
+
 /**
  * FIB path-list
  * A representation of the list/set of path trough which a prefix is reachable
@@ -62,6 +84,12 @@ typedef struct fib_path_list_t_ {
      * the RPF list calculated for this path list
      */
     fib_node_index_t fpl_urpf;
+
+    /**
+     * The load-balances shared by the children of a PIC path-list, one
+     * per-chain type and flow-hash config. Allocated on demand.
+     */
+    fib_path_list_pic_lb_t *fpl_pic_lbs;
 } fib_path_list_t;
 
 /*
@@ -79,6 +107,12 @@ static fib_path_list_t * fib_path_list_pool;
  */
 static uword *fib_path_list_db;
 
+/**
+ * Is prefix independent convergence enabled, and its counters
+ */
+static int fib_path_list_pic_enabled;
+static fib_path_list_pic_stats_t fib_path_list_pic_stats;
+
 /**
  * the logger
  */
@@ -304,6 +338,161 @@ fib_path_list_db_remove (fib_node_index_t path_list_index)
     FIB_PATH_LIST_DBG(path_list, "DB-removed");
 }
 
+/**
+ * @brief Gather the forwarding of the resolved paths with the best
+ * preference. This is what a child entry without path extensions would
+ * construct for itself.
+ */
+static load_balance_path_t *
+fib_path_list_pic_mk_nhs (fib_path_list_t *path_list,
+                          fib_forward_chain_type_t fct)
+{
+    fib_node_index_t *path_index;
+    load_balance_path_t *nhs;
+    u16 preference;
+
+    nhs = NULL;
+    preference = 0xffff;
+
+    vec_foreach (path_index, path_list->fpl_paths)
+    {
+        if (!fib_path_is_resolved(*path_index))
+        {
+            continue;
+        }
+        if (0xffff == preference)
+        {
+            preference = fib_path_get_preference(*path_index);
+        }
+        else if (preference != fib_path_get_preference(*path_index))
+        {
+            /*
+             * the paths are sorted by preference, so we are done
+             */
+            break;
+        }
+        nhs = fib_path_append_nh_for_multipath_hash(
+            *path_index, fct,
+            fib_forw_chain_type_to_dpo_proto(fct),
+            nhs);
+    }
+
+    return (nhs);
+}
+
+static int
+fib_path_list_pic_nhs_equal (const load_balance_path_t *nhs1,
+                             const load_balance_path_t *nhs2)
+{
+    u32 ii;
+
+    if (vec_len(nhs1) != vec_len(nhs2))
+        return (0);
+
+    vec_foreach_index (ii, nhs1)
+    {
+        if (nhs1[ii].path_index != nhs2[ii].path_index ||
+            nhs1[ii].path_weight != nhs2[ii].path_weight ||
+            dpo_cmp(&nhs1[ii].path_dpo, &nhs2[ii].path_dpo))
+            return (0);
+    }
+    return (1);
+}
+
+static void
+fib_path_list_pic_nhs_free (load_balance_path_t *nhs)
+{
+    load_balance_path_t *nh;
+
+    vec_foreach (nh, nhs)
+    {
+        dpo_reset(&nh->path_dpo);
+    }
+    vec_free(nhs);
+}
+
+/**
+ * @brief Build the load-balance from the path-list's current next-hops.
+ * Returns 0 if they have not changed since it was last built.
+ */
+static int
+fib_path_list_pic_build (fib_path_list_t *path_list,
+                         fib_path_list_pic_lb_t *plb)
+{
+    load_balance_path_t *nhs;
+
+    nhs = fib_path_list_pic_mk_nhs(path_list, plb->fppl_fct);
+
+    if (dpo_id_is_valid(&plb->fppl_dpo) &&
+        fib_path_list_pic_nhs_equal(nhs, plb->fppl_nhs))
+    {
+        fib_path_list_pic_nhs_free(nhs);
+        return (0);
+    }
+
+    if (!dpo_id_is_valid(&plb->fppl_dpo))
+    {
+        dpo_proto_t dproto = fib_forw_chain_type_to_dpo_proto(plb->fppl_fct);
+
+        dpo_set(&plb->fppl_dpo,
+                DPO_LOAD_BALANCE,
+                dproto,
+                load_balance_create(0, dproto, plb->fppl_fhc));
+    }
+    load_balance_multipath_update(&plb->fppl_dpo, nhs,
+                                  LOAD_BALANCE_FLAG_NONE);
+
+    fib_path_list_pic_nhs_free(plb->fppl_nhs);
+    plb->fppl_nhs = nhs;
+
+    return (1);
+}
+
+/**
+ * @brief Update, in place, the load-balances shared by the path-list's
+ * children. A load-balance whose next-hops have not changed is left alone,
+ * so a path failing costs one update of each, whatever the number of
+ * walks that report it.
+ */
+static void
+fib_path_list_pic_update (fib_path_list_t *path_list)
+{
+    fib_path_list_pic_lb_t *plb;
+    u32 n_updates;
+
+    n_updates = 0;
+
+    vec_foreach (plb, path_list->fpl_pic_lbs)
+    {
+        n_updates += fib_path_list_pic_build(path_list, plb);
+    }
+
+    if (n_updates)
+    {
+        fib_path_list_pic_stats.fpps_n_updates += n_updates;
+        fib_path_list_pic_stats.fpps_n_children +=
+            fib_node_get_n_children(FIB_NODE_TYPE_PATH_LIST,
+                                    fib_path_list_get_index(path_list));
+
+        FIB_PATH_LIST_DBG(path_list, "pic-update: %d", n_updates);
+    }
+}
+
+static void
+fib_path_list_pic_reset (fib_path_list_t *path_list)
+{
+    fib_path_list_pic_lb_t *plb;
+
+    vec_foreach (plb, path_list->fpl_pic_lbs)
+    {
+        dpo_reset(&plb->fppl_dpo);
+        fib_path_list_pic_nhs_free(plb->fppl_nhs);
+        fib_path_list_pic_stats.fpps_n_lbs--;
+    }
+    vec_free(path_list->fpl_pic_lbs);
+    path_list->fpl_flags &= ~FIB_PATH_LIST_FLAG_PIC;
+}
+
 static void
 fib_path_list_destroy (fib_path_list_t *path_list)
 {
@@ -311,6 +500,8 @@ fib_path_list_destroy (fib_path_list_t *path_list)
 
     FIB_PATH_LIST_DBG(path_list, "destroy");
 
+    fib_path_list_pic_reset(path_list);
+
     vec_foreach (path_index, path_list->fpl_paths)
     {
 	fib_path_destroy(*path_index);
@@ -476,6 +667,18 @@ fib_path_list_back_walk (fib_node_index_t path_list_index,
     FIB_PATH_LIST_DBG(path_list, "bw:%U",
                       format_fib_node_bw_reason, ctx->fnbw_reason);
 
+    if (path_list->fpl_flags & FIB_PATH_LIST_FLAG_PIC)
+    {
+        /*
+         * the children that share the path-list's load-balances have
+         * converged once they are updated. The walk that follows is still
+         * needed for the children to pick up the new uRPF list and for
+         * those that build their own forwarding, but it is no longer in
+         * the way of their traffic.
+         */
+        fib_path_list_pic_update(path_list);
+    }
+
     /*
      * propagate the backwalk further
      */
@@ -665,6 +868,16 @@ fib_path_list_is_popular (fib_node_index_t path_list_index)
     return (path_list->fpl_flags & FIB_PATH_LIST_FLAG_POPULAR);
 }
 
+int
+fib_path_list_is_pic (fib_node_index_t path_list_index)
+{
+    fib_path_list_t *path_list;
+
+    path_list = fib_path_list_get(path_list_index);
+
+    return (path_list->fpl_flags & FIB_PATH_LIST_FLAG_PIC);
+}
+
 static fib_path_list_flags_t
 fib_path_list_flags_fixup (fib_path_list_flags_t flags)
 {
@@ -1233,6 +1446,46 @@ fib_path_list_contribute_forwarding (fib_node_index_t path_list_index,
     }
 }
 
+/*
+ * fib_path_list_contribute_pic_forwarding
+ *
+ * Return the load-balance shared by all the children of a PIC path-list
+ * that use the same chain type and flow-hash config. It is not collapsed,
+ * since a child that used the bucket directly would not see the in-place
+ * updates.
+ */
+void
+fib_path_list_contribute_pic_forwarding (fib_node_index_t path_list_index,
+                                         fib_forward_chain_type_t fct,
+                                         flow_hash_config_t fhc,
+                                         dpo_id_t *dpo)
+{
+    fib_path_list_pic_lb_t *plb;
+    fib_path_list_t *path_list;
+
+    path_list = fib_path_list_get(path_list_index);
+
+    ASSERT(path_list->fpl_flags & FIB_PATH_LIST_FLAG_PIC);
+
+    vec_foreach (plb, path_list->fpl_pic_lbs)
+    {
+        if (plb->fppl_fct == fct && plb->fppl_fhc == fhc)
+            goto done;
+    }
+
+    vec_add2(path_list->fpl_pic_lbs, plb, 1);
+    plb->fppl_fct = fct;
+    plb->fppl_fhc = fhc;
+    fib_path_list_pic_build(path_list, plb);
+
+    fib_path_list_pic_stats.fpps_n_lbs++;
+
+    FIB_PATH_LIST_DBG(path_list, "pic lb: %d", plb->fppl_dpo.dpoi_index);
+
+done:
+    dpo_copy(dpo, &plb->fppl_dpo);
+}
+
 /*
  * fib_path_list_get_adj
  *
@@ -1318,6 +1571,10 @@ fib_path_list_child_add (fib_node_index_t path_list_index,
 
         path_list = fib_path_list_get(path_list_index);
         path_list->fpl_flags |= FIB_PATH_LIST_FLAG_POPULAR;
+        if (fib_path_list_pic_enabled)
+        {
+            path_list->fpl_flags |= FIB_PATH_LIST_FLAG_PIC;
+        }
 
 	fib_walk_sync(FIB_NODE_TYPE_PATH_LIST, path_list_index, &ctx);
     }
@@ -1433,6 +1690,72 @@ fib_path_list_module_init (void)
     fib_path_list_logger = vlib_log_register_class("fib", "path-list");
 }
 
+void
+fib_path_list_pic_enable_disable (int enable)
+{
+    fib_node_back_walk_ctx_t ctx = {
+        .fnbw_reason = FIB_NODE_BW_REASON_FLAG_EVALUATE,
+    };
+    fib_node_index_t *plis, *pli;
+    fib_path_list_t *path_list;
+
+    enable = !!enable;
+    if (enable == fib_path_list_pic_enabled)
+    {
+        return;
+    }
+    fib_path_list_pic_enabled = enable;
+
+    /*
+     * switch the existing popular path-lists, and have their children
+     * re-evaluate their forwarding
+     */
+    plis = NULL;
+    pool_foreach (path_list, fib_path_list_pool)
+    {
+        if (path_list->fpl_flags & FIB_PATH_LIST_FLAG_POPULAR)
+        {
+            vec_add1(plis, fib_path_list_get_index(path_list));
+        }
+    }
+
+    vec_foreach (pli, plis)
+    {
+        path_list = fib_path_list_get(*pli);
+
+        if (enable)
+        {
+            path_list->fpl_flags |= FIB_PATH_LIST_FLAG_PIC;
+            fib_walk_sync(FIB_NODE_TYPE_PATH_LIST, *pli, &ctx);
+        }
+        else
+        {
+            path_list->fpl_flags &= ~FIB_PATH_LIST_FLAG_PIC;
+            fib_walk_sync(FIB_NODE_TYPE_PATH_LIST, *pli, &ctx);
+
+            /*
+             * the children no longer use the shared load-balances
+             */
+            path_list = fib_path_list_get(*pli);
+            fib_path_list_pic_reset(path_list);
+        }
+    }
+
+    vec_free(plis);
+}
+
+int
+fib_path_list_pic_is_enabled (void)
+{
+    return (fib_path_list_pic_enabled);
+}
+
+void
+fib_path_list_pic_get_stats (fib_path_list_pic_stats_t *stats)
+{
+    *stats = fib_path_list_pic_stats;
+}
+
 static clib_error_t *
 show_fib_path_list_command (vlib_main_t * vm,
 			    unformat_input_t * input,
@@ -1479,3 +1802,62 @@ VLIB_CLI_COMMAND (show_fib_path_list, static) = {
   .function = show_fib_path_list_command,
   .short_help = "show fib path-lists",
 };
+
+static clib_error_t *
+set_fib_pic_command (vlib_main_t * vm,
+                     unformat_input_t * input,
+                     vlib_cli_command_t * cmd)
+{
+    int enable;
+
+    if (unformat (input, "enable"))
+        enable = 1;
+    else if (unformat (input, "disable"))
+        enable = 0;
+    else
+        return (clib_error_return (0, "unknown input '%U'",
+                                   format_unformat_error, input));
+
+    fib_path_list_pic_enable_disable(enable);
+
+    return (NULL);
+}
+
+/*?
+ * Enable or disable prefix independent convergence. Path-lists that are
+ * shared by many prefixes contribute a load-balance that all those prefixes
+ * use and that is updated in place when a path fails, or is restored.
+ * The cost is an extra load-balance in the switch path for those prefixes.
+ *
+ * @cliexpar
+ * @cliexcmd{set fib pic enable}
+ ?*/
+VLIB_CLI_COMMAND (set_fib_pic, static) = {
+  .path = "set fib pic",
+  .function = set_fib_pic_command,
+  .short_help = "set fib pic <enable|disable>",
+};
+
+static clib_error_t *
+show_fib_pic_command (vlib_main_t * vm,
+                      unformat_input_t * input,
+                      vlib_cli_command_t * cmd)
+{
+    const fib_path_list_pic_stats_t *stats = &fib_path_list_pic_stats;
+
+    vlib_cli_output (vm, "FIB PIC: %s",
+                     (fib_path_list_pic_enabled ? "enabled" : "disabled"));
+    vlib_cli_output (vm, "  shared load-balances: %d", stats->fpps_n_lbs);
+    vlib_cli_output (vm, "  in-place updates:     %lld",
+                     stats->fpps_n_updates);
+    vlib_cli_output (vm, "  children converged:   %lld",
+                     stats->fpps_n_children);
+
+    return (NULL);
+}
+
+VLIB_CLI_COMMAND (show_fib_pic, static) = {
+  .path = "show fib pic",
+  .function = show_fib_pic_command,
+  .short_help = "show fib pic",
+};
@@ -70,10 +70,15 @@ typedef enum fib_path_list_attribute_t_ {
      * no uRPF - do not generate unicast RPF list for this path-list
      */
     FIB_PATH_LIST_ATTRIBUTE_NO_URPF,
+    /**
+     * prefix independent convergence - the popular path-list contributes
+     * a shared load-balance to its children that is updated in place
+     */
+    FIB_PATH_LIST_ATTRIBUTE_PIC,
     /**
      * Marher. Add new flags before this one, and then update it.
      */
-    FIB_PATH_LIST_ATTRIBUTE_LAST = FIB_PATH_LIST_ATTRIBUTE_NO_URPF,
+    FIB_PATH_LIST_ATTRIBUTE_LAST = FIB_PATH_LIST_ATTRIBUTE_PIC,
 } fib_path_list_attribute_t;
 
 typedef enum fib_path_list_flags_t_ {
@@ -86,6 +91,7 @@ typedef enum fib_path_list_flags_t_ {
     FIB_PATH_LIST_FLAG_LOOPED    = (1 << FIB_PATH_LIST_ATTRIBUTE_LOOPED),
     FIB_PATH_LIST_FLAG_POPULAR   = (1 << FIB_PATH_LIST_ATTRIBUTE_POPULAR),
     FIB_PATH_LIST_FLAG_NO_URPF   = (1 << FIB_PATH_LIST_ATTRIBUTE_NO_URPF),
+    FIB_PATH_LIST_FLAG_PIC       = (1 << FIB_PATH_LIST_ATTRIBUTE_PIC),
 } fib_path_list_flags_t;
 
 #define FIB_PATH_LIST_ATTRIBUTES {       		 \
@@ -97,6 +103,7 @@ typedef enum fib_path_list_flags_t_ {
     [FIB_PATH_LIST_ATTRIBUTE_LOOPED]    = "looped",	 \
     [FIB_PATH_LIST_ATTRIBUTE_POPULAR]   = "popular",	 \
     [FIB_PATH_LIST_ATTRIBUTE_NO_URPF]   = "no-uRPF",	 \
+    [FIB_PATH_LIST_ATTRIBUTE_PIC]       = "pic",	 \
 }
 
 #define FOR_EACH_PATH_LIST_ATTRIBUTE(_item)		\
@@ -148,6 +155,10 @@ extern void fib_path_list_contribute_forwarding(fib_node_index_t path_list_index
 						fib_forward_chain_type_t type,
                                                 fib_path_list_fwd_flags_t flags,
 						dpo_id_t *dpo);
+extern void fib_path_list_contribute_pic_forwarding(fib_node_index_t path_list_index,
+                                                    fib_forward_chain_type_t type,
+                                                    flow_hash_config_t fhc,
+                                                    dpo_id_t *dpo);
 extern void fib_path_list_contribute_urpf(fib_node_index_t path_index,
 					  index_t urpf);
 extern index_t fib_path_list_get_urpf(fib_node_index_t path_list_index);
@@ -168,6 +179,7 @@ extern int fib_path_list_recursive_loop_detect(fib_node_index_t path_list_index,
 extern u32 fib_path_list_get_resolving_interface(fib_node_index_t path_list_index);
 extern int fib_path_list_is_looped(fib_node_index_t path_list_index);
 extern int fib_path_list_is_popular(fib_node_index_t path_list_index);
+extern int fib_path_list_is_pic(fib_node_index_t path_list_index);
 extern dpo_proto_t fib_path_list_get_proto(fib_node_index_t path_list_index);
 extern u8 * fib_path_list_format(fib_node_index_t pl_index,
 				 u8 * s);
@@ -203,6 +215,37 @@ extern void fib_path_list_walk_w_ext(fib_node_index_t pl_index,
 
 extern void fib_path_list_module_init(void);
 
+/**
+ * Prefix independent convergence (PIC).
+ * When enabled, popular path-lists contribute a load-balance, shared by
+ * all their children, that is updated in place when the path-list's
+ * paths change state. The children's forwarding then converges in time
+ * proportional to the number of paths, not the number of children.
+ */
+extern void fib_path_list_pic_enable_disable(int enable);
+extern int fib_path_list_pic_is_enabled(void);
+
+/**
+ * PIC counters
+ */
+typedef struct fib_path_list_pic_stats_t_
+{
+    /**
+     * number of in-place updates of shared load-balances
+     */
+    u64 fpps_n_updates;
+    /**
+     * number of children whose forwarding converged through those updates
+     */
+    u64 fpps_n_children;
+    /**
+     * number of shared load-balances currently allocated
+     */
+    u32 fpps_n_lbs;
+} fib_path_list_pic_stats_t;
+
+extern void fib_path_list_pic_get_stats(fib_path_list_pic_stats_t *stats);
+
 /*
  * functions for testing.
  */
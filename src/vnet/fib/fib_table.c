@@ -19,6 +19,7 @@
 #include <vnet/fib/fib_table.h>
 #include <vnet/fib/fib_entry_cover.h>
 #include <vnet/fib/fib_internal.h>
+#include <vnet/fib/fib_walk.h>
 #include <vnet/fib/ip4_fib.h>
 #include <vnet/fib/ip6_fib.h>
 #include <vnet/fib/mpls_fib.h>
@@ -943,6 +944,71 @@ fib_table_entry_delete_index (fib_node_index_t fib_entry_index,
                              fib_entry_index, prefix, source);
 }
 
+void
+fib_table_batch_begin (void)
+{
+    vlib_main_t *vm = vlib_get_main();
+
+    ASSERT(0 == vm->thread_index);
+
+    /*
+     * the workers are held for the whole batch, so none of the individual
+     * updates need to sync them
+     */
+    vlib_worker_thread_barrier_sync(vm);
+    fib_walk_batch_begin();
+}
+
+void
+fib_table_batch_end (void)
+{
+    vlib_main_t *vm = vlib_get_main();
+
+    fib_walk_batch_end();
+    vlib_worker_thread_barrier_release(vm);
+}
+
+void
+fib_table_entry_path_add_bulk (u32 fib_index,
+                               const fib_prefix_t *prefixes,
+                               u32 n_prefixes,
+                               fib_source_t source,
+                               fib_entry_flag_t flags,
+                               const fib_route_path_t *rpaths)
+{
+    fib_route_path_t *copy;
+    u32 ii;
+
+    fib_table_batch_begin();
+
+    for (ii = 0; ii < n_prefixes; ii++)
+    {
+        /* the paths are fixed up per-prefix, so each needs its own copy */
+        copy = vec_dup((fib_route_path_t *) rpaths);
+        fib_table_entry_path_add2(fib_index, &prefixes[ii],
+                                  source, flags, copy);
+        vec_free(copy);
+    }
+
+    fib_table_batch_end();
+}
+
+void
+fib_table_entry_delete_bulk (u32 fib_index,
+                             const fib_prefix_t *prefixes,
+                             u32 n_prefixes,
+                             fib_source_t source)
+{
+    u32 ii;
+
+    fib_table_batch_begin();
+
+    for (ii = 0; ii < n_prefixes; ii++)
+        fib_table_entry_delete(fib_index, &prefixes[ii], source);
+
+    fib_table_batch_end();
+}
+
 u32
 fib_table_entry_get_stats_index (u32 fib_index,
                                  const fib_prefix_t *prefix)
@@ -388,6 +388,74 @@ extern fib_node_index_t fib_table_entry_path_add2(u32 fib_index,
 						  fib_entry_flag_t flags,
 						  fib_route_path_t *rpath);
 
+/**
+ * @brief
+ *  Begin a batch of updates to the FIB.
+ *  The worker threads are held at the barrier until the batch ends, and the
+ *  back-walks the updates trigger are coalesced and run once, at the end.
+ *  Batches nest. They may only be used from the main thread.
+ */
+extern void fib_table_batch_begin(void);
+
+/**
+ * @brief
+ *  End a batch of updates to the FIB, run the coalesced back-walks and
+ *  release the workers.
+ */
+extern void fib_table_batch_end(void);
+
+/**
+ * @brief
+ *  Add the same set of paths to many entries, within one batch.
+ *  Equivalent to calling fib_table_entry_path_add2() for each prefix.
+ *
+ * @param fib_index
+ *  The index of the FIB
+ *
+ * @param prefixes
+ *  The prefixes of the entries to add
+ *
+ * @param n_prefixes
+ *  The number of prefixes
+ *
+ * @param source
+ *  The ID of the client/source adding the entries.
+ *
+ * @param flags
+ *  Flags for the entries.
+ *
+ * @param rpaths
+ *  A vector of paths. It is copied for each entry.
+ */
+extern void fib_table_entry_path_add_bulk(u32 fib_index,
+                                          const fib_prefix_t *prefixes,
+                                          u32 n_prefixes,
+                                          fib_source_t source,
+                                          fib_entry_flag_t flags,
+                                          const fib_route_path_t *rpaths);
+
+/**
+ * @brief
+ *  Delete many entries, within one batch.
+ *  Equivalent to calling fib_table_entry_delete() for each prefix.
+ *
+ * @param fib_index
+ *  The index of the FIB
+ *
+ * @param prefixes
+ *  The prefixes of the entries to delete
+ *
+ * @param n_prefixes
+ *  The number of prefixes
+ *
+ * @param source
+ *  The ID of the client/source removing the entries.
+ */
+extern void fib_table_entry_delete_bulk(u32 fib_index,
+                                        const fib_prefix_t *prefixes,
+                                        u32 n_prefixes,
+                                        fib_source_t source);
+
 /**
  * @brief
  * remove one path to an entry (aka route) in the FIB. If this is the entry's
@@ -55,17 +55,13 @@ index_t
 fib_urpf_list_alloc_and_lock (void)
 {
     fib_urpf_list_t *urpf;
-    u8 need_barrier_sync = pool_get_will_expand (fib_urpf_list_pool);
-    vlib_main_t *vm = vlib_get_main();
-    ASSERT (vm->thread_index == 0);
+    ASSERT (vlib_get_thread_index() == 0);
 
-    if (need_barrier_sync)
-        vlib_worker_thread_barrier_sync (vm);
-
-    pool_get(fib_urpf_list_pool, urpf);
-
-    if (need_barrier_sync)
-        vlib_worker_thread_barrier_release (vm);
+    /*
+     * the workers may be reading the pool, so if it grows the old one
+     * is freed once they are done with it.
+     */
+    vlib_rcu_pool_get(fib_urpf_list_pool, urpf);
 
     clib_memset(urpf, 0, sizeof(*urpf));
 
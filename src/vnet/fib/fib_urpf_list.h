@@ -95,7 +95,9 @@ extern fib_urpf_list_t *fib_urpf_list_pool;
 static inline fib_urpf_list_t *
 fib_urpf_list_get (index_t index)
 {
-    return (pool_elt_at_index(fib_urpf_list_pool, index));
+    fib_urpf_list_t *pool = vlib_rcu_deref(fib_urpf_list_pool);
+
+    return (pool_elt_at_index(pool, index));
 }
 
 /**
@@ -40,6 +40,11 @@ typedef enum fib_walk_flags_t_
      * An indication that the walk is currently executing.
      */
     FIB_WALK_FLAG_EXECUTING = (1 << 2),
+    /**
+     * A synchronous walk requested during a batch. It is held,
+     * and merged with others from the same parent, until the batch ends.
+     */
+    FIB_WALK_FLAG_DEFERRED = (1 << 3),
 } fib_walk_flags_t;
 
 /**
@@ -97,6 +102,43 @@ typedef struct fib_walk_t_
  */
 static fib_walk_t *fib_walk_pool;
 
+/**
+ * @brief The state of a batch of updates, during which synchronous walks
+ * are deferred.
+ */
+typedef struct fib_walk_batch_t_
+{
+    /**
+     * Nesting depth of the batch begin/end calls
+     */
+    u32 fwb_depth;
+
+    /**
+     * The deferred walks, keyed by their parent
+     */
+    uword *fwb_walk_by_parent;
+
+    /**
+     * The parents with deferred walks, in the order they were requested
+     */
+    fib_node_ptr_t *fwb_parents;
+
+    /**
+     * The number of sync walks that were merged into a deferred one
+     */
+    u64 fwb_n_merged;
+
+    /**
+     * The number of deferred walks that ran
+     */
+    u64 fwb_n_run;
+} fib_walk_batch_t;
+
+static fib_walk_batch_t fib_walk_batch;
+
+#define FIB_WALK_BATCH_KEY(_type, _index) \
+    (((u64)(_type) << 32) | (_index))
+
 /**
  * Statistics maintained per-walk queue
  */
@@ -187,6 +229,8 @@ typedef struct fib_walk_history_t_ {
 static fib_walk_history_t fib_walk_history[HISTORY_N_WALKS];
 
 static u8* format_fib_walk (u8* s, va_list *ap);
+static fib_node_back_walk_rc_t fib_walk_back_walk_notify (fib_node_t *node,
+                                                          fib_node_back_walk_ctx_t *ctx);
 
 #define FIB_WALK_DBG(_walk, _fmt, _args...)                     \
 {                                                               \
@@ -255,6 +299,16 @@ fib_walk_destroy (index_t fwi)
 
     fwalk = fib_walk_get(fwi);
 
+    if (FIB_WALK_FLAG_DEFERRED & fwalk->fw_flags)
+    {
+        /*
+         * the walk may run before the batch ends, if another walk
+         * merges with it.
+         */
+        hash_unset(fib_walk_batch.fwb_walk_by_parent,
+                   FIB_WALK_BATCH_KEY(fwalk->fw_parent.fnp_type,
+                                      fwalk->fw_parent.fnp_index));
+    }
     if (FIB_NODE_INDEX_INVALID != fwalk->fw_prio_sibling)
     {
 	fib_node_list_elt_remove(fwalk->fw_prio_sibling);
@@ -733,50 +787,17 @@ fib_walk_async (fib_node_type_t parent_type,
 }
 
 /**
- * @brief Back walk all the children of a FIB node.
- *
- * note this is a synchronous depth first walk. Children visited may propagate
- * the walk to their children. Other children node types may not propagate,
- * synchronously but instead queue the walk for later async completion.
+ * @brief Run a sync walk, that is already a child of its parent, to
+ * completion.
  */
-void
-fib_walk_sync (fib_node_type_t parent_type,
-	       fib_node_index_t parent_index,
-	       fib_node_back_walk_ctx_t *ctx)
+static void
+fib_walk_sync_run (fib_node_index_t fwi,
+                   fib_node_back_walk_ctx_t *ctx)
 {
     fib_walk_advance_rc_t rc;
-    fib_node_index_t fwi;
     fib_walk_t *fwalk;
 
-    if (FIB_NODE_GRAPH_MAX_DEPTH < ++ctx->fnbw_depth)
-    {
-	/*
-	 * The walk has reached the maximum depth. there is a loop in the graph.
-	 * bail.
-	 */
-	return;
-    }
-    if (0 == fib_node_get_n_children(parent_type,
-                                     parent_index))
-    {
-        /*
-         * no children to walk - quit now
-         */
-        return;
-    }
-
-    fwalk = fib_walk_alloc(parent_type,
-			   parent_index,
-			   FIB_WALK_FLAG_SYNC,
-			   ctx);
-
-    fwalk->fw_dep_sibling = fib_node_child_add(parent_type,
-					       parent_index,
-					       FIB_NODE_TYPE_WALK,
-					       fib_walk_get_index(fwalk));
-    fwi = fib_walk_get_index(fwalk);
-    FIB_WALK_DBG(fwalk, "sync-start: %U",
-                 format_fib_node_bw_reason, ctx->fnbw_reason);
+    fwalk = fib_walk_get(fwi);
 
     while (1)
     {
@@ -856,6 +877,174 @@ fib_walk_sync (fib_node_type_t parent_type,
     }
 }
 
+/**
+ * @brief Hold a sync walk until the batch ends, merging it with any
+ * other walk already held for the same parent.
+ */
+static void
+fib_walk_defer (fib_node_type_t parent_type,
+                fib_node_index_t parent_index,
+                fib_node_back_walk_ctx_t *ctx)
+{
+    fib_walk_t *fwalk;
+    uword *p;
+
+    p = hash_get(fib_walk_batch.fwb_walk_by_parent,
+                 FIB_WALK_BATCH_KEY(parent_type, parent_index));
+
+    if (NULL != p)
+    {
+        fib_node_index_t sibling;
+
+        fwalk = fib_walk_get(p[0]);
+        fib_walk_back_walk_notify(&fwalk->fw_node, ctx);
+        fib_walk_batch.fwb_n_merged++;
+
+        /*
+         * children added since the walk was held are in front of it, and
+         * the merged reasons are for them too. Move the walk back to the
+         * head of the list; the new place is taken before the old one is
+         * given up, so the parent's lock never drops.
+         */
+        sibling = fib_node_child_add(parent_type,
+                                     parent_index,
+                                     FIB_NODE_TYPE_WALK,
+                                     p[0]);
+        fib_node_child_remove(parent_type,
+                              parent_index,
+                              fwalk->fw_dep_sibling);
+        fwalk->fw_dep_sibling = sibling;
+        return;
+    }
+
+    fwalk = fib_walk_alloc(parent_type,
+			   parent_index,
+			   FIB_WALK_FLAG_SYNC | FIB_WALK_FLAG_DEFERRED,
+			   ctx);
+
+    /*
+     * the walk is a child of the parent, so the parent is locked
+     * until the walk is run.
+     */
+    fwalk->fw_dep_sibling = fib_node_child_add(parent_type,
+					       parent_index,
+					       FIB_NODE_TYPE_WALK,
+					       fib_walk_get_index(fwalk));
+
+    hash_set(fib_walk_batch.fwb_walk_by_parent,
+             FIB_WALK_BATCH_KEY(parent_type, parent_index),
+             fib_walk_get_index(fwalk));
+    vec_add1(fib_walk_batch.fwb_parents, fwalk->fw_parent);
+
+    FIB_WALK_DBG(fwalk, "deferred: %U",
+                 format_fib_node_bw_reason, ctx->fnbw_reason);
+}
+
+/**
+ * @brief Back walk all the children of a FIB node.
+ *
+ * note this is a synchronous depth first walk. Children visited may propagate
+ * the walk to their children. Other children node types may not propagate,
+ * synchronously but instead queue the walk for later async completion.
+ */
+void
+fib_walk_sync (fib_node_type_t parent_type,
+	       fib_node_index_t parent_index,
+	       fib_node_back_walk_ctx_t *ctx)
+{
+    fib_node_index_t fwi;
+    fib_walk_t *fwalk;
+
+    if (FIB_NODE_GRAPH_MAX_DEPTH < ++ctx->fnbw_depth)
+    {
+	/*
+	 * The walk has reached the maximum depth. there is a loop in the graph.
+	 * bail.
+	 */
+	return;
+    }
+    if (0 == fib_node_get_n_children(parent_type,
+                                     parent_index))
+    {
+        /*
+         * no children to walk - quit now
+         */
+        return;
+    }
+
+    if (0 != fib_walk_batch.fwb_depth)
+    {
+        fib_walk_defer(parent_type, parent_index, ctx);
+        return;
+    }
+
+    fwalk = fib_walk_alloc(parent_type,
+			   parent_index,
+			   FIB_WALK_FLAG_SYNC,
+			   ctx);
+
+    fwalk->fw_dep_sibling = fib_node_child_add(parent_type,
+					       parent_index,
+					       FIB_NODE_TYPE_WALK,
+					       fib_walk_get_index(fwalk));
+    fwi = fib_walk_get_index(fwalk);
+    FIB_WALK_DBG(fwalk, "sync-start: %U",
+                 format_fib_node_bw_reason, ctx->fnbw_reason);
+
+    fib_walk_sync_run(fwi, ctx);
+}
+
+void
+fib_walk_batch_begin (void)
+{
+    fib_walk_batch.fwb_depth++;
+}
+
+void
+fib_walk_batch_end (void)
+{
+    fib_node_back_walk_ctx_t ctx;
+    fib_node_ptr_t *parent;
+    fib_walk_t *fwalk;
+    uword *p;
+    u32 ii;
+
+    ASSERT(fib_walk_batch.fwb_depth > 0);
+
+    if (0 != --fib_walk_batch.fwb_depth)
+        return;
+
+    /*
+     * run each of the deferred walks, in the order they were first
+     * requested. Walks started now run to completion, as normal.
+     * The vector is indexed, since running a walk can grow it.
+     */
+    for (ii = 0; ii < vec_len(fib_walk_batch.fwb_parents); ii++)
+    {
+        parent = &fib_walk_batch.fwb_parents[ii];
+        p = hash_get(fib_walk_batch.fwb_walk_by_parent,
+                     FIB_WALK_BATCH_KEY(parent->fnp_type,
+                                        parent->fnp_index));
+
+        if (NULL == p)
+            /* it merged with, and was run by, an earlier walk */
+            continue;
+
+        fwalk = fib_walk_get(p[0]);
+        fwalk->fw_flags &= ~FIB_WALK_FLAG_DEFERRED;
+        hash_unset(fib_walk_batch.fwb_walk_by_parent,
+                   FIB_WALK_BATCH_KEY(parent->fnp_type,
+                                      parent->fnp_index));
+        ctx = fwalk->fw_ctx[0];
+
+        fib_walk_batch.fwb_n_run++;
+        fib_walk_sync_run(fwalk - fib_walk_pool, &ctx);
+    }
+
+    vec_reset_length(fib_walk_batch.fwb_parents);
+    ASSERT(0 == hash_elts(fib_walk_batch.fwb_walk_by_parent));
+}
+
 static fib_node_t *
 fib_walk_get_node (fib_node_index_t index)
 {
@@ -1033,6 +1222,11 @@ fib_walk_show (vlib_main_t * vm,
 	}
     }
 
+    vlib_cli_output(vm, "Batched walks: deferred:%lld merged:%lld pending:%d",
+                    fib_walk_batch.fwb_n_run,
+                    fib_walk_batch.fwb_n_merged,
+                    hash_elts(fib_walk_batch.fwb_walk_by_parent));
+
     vlib_cli_output(vm, "Histogram Statistics:");
     vlib_cli_output(vm, " Number of Elements visit per-quota:");
     for (ii = 0; ii < N_ELTS_BUCKETS; ii++)
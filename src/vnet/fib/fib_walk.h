@@ -52,6 +52,16 @@ extern void fib_walk_sync(fib_node_type_t parent_type,
                           fib_node_index_t parent_index,
                           fib_node_back_walk_ctx_t *ctx);
 
+/**
+ * @brief Begin a batch of updates to the graph.
+ * Until the matching end, synchronous walks are not run but are held,
+ * one per parent, and each held walk then runs once when the outermost
+ * batch ends. The caller must not depend on a walk having completed
+ * before then. Batches nest.
+ */
+extern void fib_walk_batch_begin(void);
+extern void fib_walk_batch_end(void);
+
 extern u8* format_fib_walk_priority(u8 *s, va_list *ap);
 
 extern void fib_walk_process_enable(void);
@@ -36,14 +36,36 @@
 #include <vnet/fib/fib_table.h>
 #include <vnet/fib/ip4_fib_8.h>
 #include <vnet/fib/ip4_fib_16.h>
+#include <vnet/fib/ip4_fib_24.h>
 
-// for the VPP_IP_FIB_MTRIE_16 definition
+// for the VPP_IP_FIB_MTRIE_16 and VPP_IP_FIB_MTRIE_24 definitions
 #include <vpp/vnet/config.h>
 
+/**
+ * the FIB module uses the 24-8 (DIR-24-8) stride trie
+ */
+#if defined(VPP_IP_FIB_MTRIE_24)
+typedef ip4_fib_24_t ip4_fib_t;
+
+#define ip4_fibs ip4_fib_24s
+#define ip4_fib_table_lookup ip4_fib_24_table_lookup
+#define ip4_fib_table_lookup_exact_match ip4_fib_24_table_lookup_exact_match
+#define ip4_fib_table_entry_remove ip4_fib_24_table_entry_remove
+#define ip4_fib_table_entry_insert ip4_fib_24_table_entry_insert
+#define ip4_fib_table_fwding_dpo_update ip4_fib_24_table_fwding_dpo_update
+#define ip4_fib_table_fwding_dpo_remove ip4_fib_24_table_fwding_dpo_remove
+#define ip4_fib_table_lookup_lb ip4_fib_24_table_lookup_lb
+#define ip4_fib_table_walk ip4_fib_24_table_walk
+#define ip4_fib_table_sub_tree_walk ip4_fib_24_table_sub_tree_walk
+#define ip4_fib_table_init ip4_fib_24_table_init
+#define ip4_fib_table_free ip4_fib_24_table_free
+#define ip4_mtrie_memory_usage ip4_mtrie_24_memory_usage
+#define format_ip4_mtrie format_ip4_mtrie_24
+
 /**
  * the FIB module uses the 16-8-8 stride trie
  */
-#ifdef VPP_IP_FIB_MTRIE_16
+#elif defined(VPP_IP_FIB_MTRIE_16)
 typedef ip4_fib_16_t ip4_fib_t;
 
 #define ip4_fibs ip4_fib_16s
@@ -132,7 +154,142 @@ u32 ip4_fib_index_from_table_id (u32 table_id)
 
 extern u32 ip4_fib_table_get_index_for_sw_if_index(u32 sw_if_index);
 
-#ifdef VPP_IP_FIB_MTRIE_16
+#if defined(VPP_IP_FIB_MTRIE_24)
+always_inline index_t
+ip4_fib_forwarding_lookup (u32 fib_index,
+                           const ip4_address_t * addr)
+{
+    ip4_mtrie_leaf_t leaf;
+    ip4_mtrie_24_t * mtrie;
+
+    mtrie = &ip4_fib_get(fib_index)->mtrie;
+
+    leaf = ip4_mtrie_24_lookup_step_one (mtrie, addr);
+    leaf = ip4_mtrie_24_lookup_step (leaf, addr);
+
+    return (ip4_mtrie_leaf_get_adj_index(leaf));
+}
+
+static_always_inline void
+ip4_fib_forwarding_lookup_x2 (u32 fib_index0,
+                              u32 fib_index1,
+                              const ip4_address_t * addr0,
+                              const ip4_address_t * addr1,
+                              index_t *lb0,
+                              index_t *lb1)
+{
+    ip4_mtrie_leaf_t leaf[2];
+    ip4_mtrie_24_t * mtrie[2];
+
+    mtrie[0] = &ip4_fib_get(fib_index0)->mtrie;
+    mtrie[1] = &ip4_fib_get(fib_index1)->mtrie;
+
+    leaf[0] = ip4_mtrie_24_lookup_step_one (mtrie[0], addr0);
+    leaf[1] = ip4_mtrie_24_lookup_step_one (mtrie[1], addr1);
+    leaf[0] = ip4_mtrie_24_lookup_step (leaf[0], addr0);
+    leaf[1] = ip4_mtrie_24_lookup_step (leaf[1], addr1);
+
+    *lb0 = ip4_mtrie_leaf_get_adj_index(leaf[0]);
+    *lb1 = ip4_mtrie_leaf_get_adj_index(leaf[1]);
+}
+
+static_always_inline void
+ip4_fib_forwarding_lookup_x4 (u32 fib_index0,
+                              u32 fib_index1,
+                              u32 fib_index2,
+                              u32 fib_index3,
+                              const ip4_address_t * addr0,
+                              const ip4_address_t * addr1,
+                              const ip4_address_t * addr2,
+                              const ip4_address_t * addr3,
+                              index_t *lb0,
+                              index_t *lb1,
+                              index_t *lb2,
+                              index_t *lb3)
+{
+    ip4_mtrie_leaf_t leaf[4];
+    ip4_mtrie_24_t * mtrie[4];
+
+    mtrie[0] = &ip4_fib_get(fib_index0)->mtrie;
+    mtrie[1] = &ip4_fib_get(fib_index1)->mtrie;
+    mtrie[2] = &ip4_fib_get(fib_index2)->mtrie;
+    mtrie[3] = &ip4_fib_get(fib_index3)->mtrie;
+
+    leaf[0] = ip4_mtrie_24_lookup_step_one (mtrie[0], addr0);
+    leaf[1] = ip4_mtrie_24_lookup_step_one (mtrie[1], addr1);
+    leaf[2] = ip4_mtrie_24_lookup_step_one (mtrie[2], addr2);
+    leaf[3] = ip4_mtrie_24_lookup_step_one (mtrie[3], addr3);
+
+    leaf[0] = ip4_mtrie_24_lookup_step (leaf[0], addr0);
+    leaf[1] = ip4_mtrie_24_lookup_step (leaf[1], addr1);
+    leaf[2] = ip4_mtrie_24_lookup_step (leaf[2], addr2);
+    leaf[3] = ip4_mtrie_24_lookup_step (leaf[3], addr3);
+
+    *lb0 = ip4_mtrie_leaf_get_adj_index(leaf[0]);
+    *lb1 = ip4_mtrie_leaf_get_adj_index(leaf[1]);
+    *lb2 = ip4_mtrie_leaf_get_adj_index(leaf[2]);
+    *lb3 = ip4_mtrie_leaf_get_adj_index(leaf[3]);
+}
+
+/**
+ * @brief Lookup a whole frame of addresses.
+ * Runs of 8 addresses in the same table are resolved with gathers, the
+ * remainder one at a time.
+ */
+static_always_inline void
+ip4_fib_forwarding_lookup_frame (const u32 *fib_indices,
+                                 const ip4_address_t **addrs,
+                                 index_t *lbs,
+                                 u32 n_left)
+{
+#ifdef CLIB_HAVE_VEC256
+    while (n_left >= 8)
+      {
+        u32x8 fibs = u32x8_load_unaligned ((void *) fib_indices);
+
+        if (PREDICT_TRUE (u32x8_is_all_equal (fibs, fib_indices[0])))
+          {
+            u32x8 dst, leaf;
+            u32 i;
+
+            for (i = 0; i < 8; i++)
+              dst[i] = addrs[i]->as_u32;
+
+            dst = u32x8_byte_swap (dst);
+            leaf = ip4_mtrie_24_lookup_x8 (&ip4_fib_get(fib_indices[0])->mtrie,
+                                           dst);
+            u32x8_store_unaligned (leaf >> 1, lbs);
+          }
+        else
+          {
+            ip4_fib_forwarding_lookup_x4 (fib_indices[0], fib_indices[1],
+                                          fib_indices[2], fib_indices[3],
+                                          addrs[0], addrs[1], addrs[2],
+                                          addrs[3], &lbs[0], &lbs[1],
+                                          &lbs[2], &lbs[3]);
+            ip4_fib_forwarding_lookup_x4 (fib_indices[4], fib_indices[5],
+                                          fib_indices[6], fib_indices[7],
+                                          addrs[4], addrs[5], addrs[6],
+                                          addrs[7], &lbs[4], &lbs[5],
+                                          &lbs[6], &lbs[7]);
+          }
+        fib_indices += 8;
+        addrs += 8;
+        lbs += 8;
+        n_left -= 8;
+      }
+#endif
+    while (n_left > 0)
+      {
+        lbs[0] = ip4_fib_forwarding_lookup (fib_indices[0], addrs[0]);
+        fib_indices += 1;
+        addrs += 1;
+        lbs += 1;
+        n_left -= 1;
+      }
+}
+
+#elif defined(VPP_IP_FIB_MTRIE_16)
 always_inline index_t
 ip4_fib_forwarding_lookup (u32 fib_index,
                            const ip4_address_t * addr)
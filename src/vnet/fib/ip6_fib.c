@@ -102,6 +102,13 @@ create_fib_with_table_id (u32 table_id,
 
     v6_fib->fib_entry_by_dst_address = hash_create_mem(2, sizeof(ip6_fib_hash_key_t), sizeof(fib_node_index_t));
 
+    if (ip6_fib_fwding_table.use_mtrie)
+    {
+        v6_fib->mtrie = clib_mem_alloc_aligned(sizeof(*v6_fib->mtrie),
+                                               CLIB_CACHE_LINE_BYTES);
+        ip6_mtrie_init(v6_fib->mtrie);
+    }
+
     /*
      * add the special entries into the new FIB
      */
@@ -185,7 +192,13 @@ ip6_fib_table_destroy (u32 fib_index)
     }
     vec_free (fib_table->ft_locks);
     vec_free(fib_table->ft_src_route_counts);
-    hash_free(pool_elt_at_index(ip6_main.v6_fibs, fib_index)->fib_entry_by_dst_address);
+    ip6_fib_t *v6_fib = pool_elt_at_index(ip6_main.v6_fibs, fib_index);
+    hash_free(v6_fib->fib_entry_by_dst_address);
+    if (v6_fib->mtrie)
+    {
+        ip6_mtrie_free(v6_fib->mtrie);
+        clib_mem_free(v6_fib->mtrie);
+    }
     pool_put_index(ip6_main.v6_fibs, fib_table->ft_index);
     pool_put(ip6_main.fibs, fib_table);
 }
@@ -301,10 +314,46 @@ compute_prefix_lengths_in_search_order (ip6_fib_fwding_table_instance_t *table)
     table->prefix_lengths_in_search_order = prefix_lengths_in_search_order;
 
     /*
-     * let the workers go once round the track before we free the old set
+     * free the old set once the workers have gone round the track
      */
-    vlib_worker_wait_one_loop();
-    vec_free(old);
+    vlib_rcu_vec_free(old);
+}
+
+static void
+ip6_fib_table_fwding_find_cover (ip6_fib_fwding_table_instance_t *table,
+                                 u32 fib_index,
+                                 const ip6_address_t *addr,
+                                 u32 len,
+                                 u32 *cover_len,
+                                 u32 *cover_lbi)
+{
+    clib_bihash_kv_24_8_t kv, value;
+    ip6_address_t *mask;
+    u64 fib;
+    int i;
+
+    fib = ((u64)((fib_index))<<32);
+
+    vec_foreach_index(i, table->prefix_lengths_in_search_order)
+    {
+        int dst_address_length = table->prefix_lengths_in_search_order[i];
+
+        if (dst_address_length >= len)
+            continue;
+
+        mask = &ip6_main.fib_masks[dst_address_length];
+        kv.key[0] = addr->as_u64[0] & mask->as_u64[0];
+        kv.key[1] = addr->as_u64[1] & mask->as_u64[1];
+        kv.key[2] = fib | dst_address_length;
+
+        if (0 == clib_bihash_search_inline_2_24_8(&table->ip6_hash,
+                                                  &kv, &value))
+        {
+            *cover_len = dst_address_length;
+            *cover_lbi = value.value;
+            return;
+        }
+    }
 }
 
 void
@@ -329,6 +378,10 @@ ip6_fib_table_fwding_dpo_update (u32 fib_index,
 
     clib_bihash_add_del_24_8(&table->ip6_hash, &kv, 1);
 
+    if (table->use_mtrie)
+        ip6_mtrie_route_add(ip6_fib_get(fib_index)->mtrie,
+                            addr, len, dpo->dpoi_index);
+
     if (0 == table->dst_address_length_refcounts[len]++)
     {
         table->non_empty_dst_address_length_bitmap =
@@ -369,6 +422,25 @@ ip6_fib_table_fwding_dpo_remove (u32 fib_index,
                              128 - len, 0);
 	compute_prefix_lengths_in_search_order (table);
     }
+
+    if (table->use_mtrie)
+    {
+        u32 cover_len, cover_lbi;
+
+        /*
+         * The mtrie needs the cover's length and LB to back-fill
+         * the slots the removed prefix occupied. The hash holds only
+         * the forwarding entries, so the first less specific match is
+         * the cover.
+         */
+        cover_len = 0;
+        cover_lbi = 0;
+        ip6_fib_table_fwding_find_cover(table, fib_index, addr, len,
+                                        &cover_len, &cover_lbi);
+        ip6_mtrie_route_del(ip6_fib_get(fib_index)->mtrie,
+                            addr, len, dpo->dpoi_index,
+                            cover_len, cover_lbi);
+    }
 }
 
 void
@@ -490,6 +562,14 @@ format_ip6_fib_table_memory (u8 * s, va_list * args)
 
     bytes_inuse = alloc_arena_next(&ip6_fib_fwding_table.ip6_hash);
 
+    if (ip6_fib_fwding_table.use_mtrie)
+    {
+        ip6_fib_t *v6_fib;
+
+        pool_foreach (v6_fib, ip6_main.v6_fibs)
+          bytes_inuse += ip6_mtrie_memory_usage(v6_fib->mtrie);
+    }
+
     s = format(s, "%=30s %=6d %=12ld\n",
                "IPv6 unicast",
                pool_elts(ip6_main.fibs),
@@ -608,6 +688,14 @@ ip6_show_fib (vlib_main_t * vm,
                          BV (format_bihash),
                          &ip6_fib_fwding_table.ip6_hash,
                          detail);
+        if (ip6_fib_fwding_table.use_mtrie)
+        {
+            pool_foreach (fib, im6->v6_fibs)
+              vlib_cli_output (vm, "%U mtrie: %U",
+                               format_fib_table_name, fib->index,
+                               FIB_PROTOCOL_IP6,
+                               format_ip6_mtrie, fib->mtrie);
+        }
         return (NULL);
     }
 
@@ -754,6 +842,8 @@ ip6_config (vlib_main_t * vm, unformat_input_t * input)
 	;
       else if (unformat (input, "default-table-name %s", &default_name))
 	;
+      else if (unformat (input, "fwding-mtrie"))
+	ip6_fib_fwding_table.use_mtrie = 1;
       else
 	return clib_error_return (0, "unknown input '%U'",
 				  format_unformat_error, input);
@@ -43,6 +43,9 @@ typedef struct ip6_fib_fwding_table_instance_t_
   uword *non_empty_dst_address_length_bitmap;
   u8 *prefix_lengths_in_search_order;
   i32 dst_address_length_refcounts[129];
+
+  /* use the per-table mtrie, rather than the hash, for lookups */
+  u8 use_mtrie;
 } ip6_fib_fwding_table_instance_t;
 
 /**
@@ -101,6 +104,12 @@ ip6_fib_table_fwding_lookup (u32 fib_index,
     u64 fib;
 
     table = &ip6_fib_fwding_table;
+
+    if (table->use_mtrie)
+        return (ip6_mtrie_lookup(
+                    pool_elt_at_index(ip6_main.v6_fibs, fib_index)->mtrie,
+                    dst));
+
     len = vec_len (table->prefix_lengths_in_search_order);
 
     kv.key[0] = dst->as_u64[0];
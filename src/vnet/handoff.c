@@ -254,6 +254,7 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
 				  unformat_input_t * input,
 				  vlib_cli_command_t * cmd)
 {
+  vlib_frame_queue_steal_mode_t steal = VLIB_FRAME_QUEUE_STEAL_NONE;
   u32 sw_if_index = ~0, is_sym = 0, is_l4 = 0;
   int enable_disable = 1;
   uword *bitmap = 0;
@@ -274,6 +275,10 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
 	is_sym = 0;
       else if (unformat (input, "l4"))
 	is_l4 = 1;
+      else if (unformat (input, "steal any"))
+	steal = VLIB_FRAME_QUEUE_STEAL_ANY;
+      else if (unformat (input, "steal ordered"))
+	steal = VLIB_FRAME_QUEUE_STEAL_ORDERED;
       else
 	break;
     }
@@ -309,13 +314,18 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
       return clib_error_return (0, "unknown return value %d", rv);
     }
 
+  /* the queue is shared by all interfaces handing off */
+  if (steal != VLIB_FRAME_QUEUE_STEAL_NONE)
+    return vlib_frame_queue_set_steal_mode (handoff_main.frame_queue_index,
+					    steal, 0 /* threshold */);
+
   return 0;
 }
 
 VLIB_CLI_COMMAND (set_interface_handoff_command, static) = {
   .path = "set interface handoff",
   .short_help = "set interface handoff <interface-name> workers <workers-list>"
-		" [symmetrical|asymmetrical]",
+		" [symmetrical|asymmetrical] [steal any|ordered]",
   .function = set_interface_handoff_command_fn,
 };
 
@@ -0,0 +1,873 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vnet/hqos/hqos.h>
+#include <vnet/feature/feature.h>
+#include <vnet/interface/tx_queue_funcs.h>
+
+hqos_main_t hqos_main;
+
+#define log_debug(fmt, ...)                                                   \
+  vlib_log_debug (hqos_main.log_class, fmt, __VA_ARGS__)
+
+/* buckets hold at most this many bytes, so refills cannot overflow */
+#define HQOS_MAX_BURST 0x7fffffff
+
+static void
+hqos_bucket_init (hqos_bucket_t *b, u64 rate, u32 burst, f64 clocks_per_second)
+{
+  clib_memset (b, 0, sizeof (*b));
+  b->last_refill = clib_cpu_time_now ();
+
+  if (rate == 0)
+    {
+      /* unlimited, always full */
+      b->size = b->tokens = ~0ULL;
+      return;
+    }
+
+  /* 1ms worth of the rate by default */
+  if (burst == 0)
+    burst = clib_max (rate / 8000, 2048);
+  burst = clib_min (burst, HQOS_MAX_BURST);
+
+  b->size = b->tokens = (u64) burst << 32;
+  b->rate = clib_max ((u64) (rate / 8.0 * (1ULL << 32) / clocks_per_second),
+		      1);
+  b->fill_clocks = b->size / b->rate + 1;
+}
+
+int
+hqos_port_init (vlib_main_t *vm, hqos_port_t *port,
+		const hqos_port_config_t *c)
+{
+  f64 clocks_per_second = vm->clib_time.clocks_per_second;
+  u32 i, j, n_pipes;
+
+  if (c->n_subports == 0 || c->n_pipes == 0 ||
+      (u64) c->n_subports * c->n_pipes > (1 << 24))
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  if (!is_pow2 (c->queue_size) || c->queue_size < 2 ||
+      c->queue_size > (1 << 15))
+    return VNET_API_ERROR_INVALID_VALUE_2;
+
+  if (c->frame_size == 0 || c->frame_size > VLIB_FRAME_SIZE)
+    return VNET_API_ERROR_INVALID_VALUE_3;
+
+  clib_memset (port, 0, sizeof (*port));
+  n_pipes = c->n_subports * c->n_pipes;
+  port->queue_mask = c->queue_size - 1;
+  port->frame_size = c->frame_size;
+  port->tx_queue_index = ~0;
+  port->clocks_per_tick = clib_max (clocks_per_second * HQOS_TIMER_TICK, 1);
+  hqos_bucket_init (&port->bucket, c->rate, c->burst, clocks_per_second);
+
+  vec_validate (port->subports, c->n_subports - 1);
+  vec_validate (port->active_subports.elts, c->n_subports - 1);
+  vec_validate_aligned (port->pipes, n_pipes - 1, CLIB_CACHE_LINE_BYTES);
+
+  for (i = 0; i < c->n_subports; i++)
+    {
+      hqos_subport_t *s = port->subports + i;
+
+      /* subports are shaped at the port's rate until told otherwise */
+      hqos_bucket_init (&s->bucket, c->rate, c->burst, clocks_per_second);
+      s->timer_handle = ~0;
+      s->first_pipe = i * c->n_pipes;
+      s->n_pipes = c->n_pipes;
+      vec_validate (s->active_pipes.elts, c->n_pipes - 1);
+
+      for (j = s->first_pipe; j < s->first_pipe + s->n_pipes; j++)
+	{
+	  hqos_pipe_t *p = port->pipes + j;
+
+	  hqos_bucket_init (&p->bucket, 0, 0, clocks_per_second);
+	  p->timer_handle = ~0;
+	  p->subport = i;
+	  clib_memset (p->wrr_weights, 1, sizeof (p->wrr_weights));
+	}
+    }
+
+  clib_memset (port->queue_by_qos, hqos_queue_index (HQOS_BE_TC, 0),
+	       sizeof (port->queue_by_qos));
+
+  TW (tw_timer_wheel_init) (&port->wheel, 0, HQOS_TIMER_TICK, ~0);
+  vec_validate (port->expired, 0);
+  vec_set_len (port->expired, 0);
+
+  return 0;
+}
+
+void
+hqos_port_free (vlib_main_t *vm, hqos_port_t *port)
+{
+  u32 *buffers = 0;
+  hqos_subport_t *s;
+  hqos_pipe_t *p;
+  hqos_queue_t *q;
+
+  vec_foreach (p, port->pipes)
+    for (q = p->queues; q < p->queues + HQOS_N_QUEUES; q++)
+      {
+	for (; q->n_entries; q->n_entries--)
+	  {
+	    vec_add1 (buffers, (u32) q->entries[q->head]);
+	    q->head = (q->head + 1) & port->queue_mask;
+	  }
+	vec_free (q->entries);
+      }
+
+  if (vec_len (buffers))
+    vlib_buffer_free (vm, buffers, vec_len (buffers));
+  vec_free (buffers);
+
+  vec_foreach (s, port->subports)
+    vec_free (s->active_pipes.elts);
+  vec_free (port->subports);
+  vec_free (port->pipes);
+  vec_free (port->active_subports.elts);
+  vec_free (port->expired);
+  vec_free (port->sw_if_indices);
+  TW (tw_timer_wheel_free) (&port->wheel);
+}
+
+static hqos_port_t *
+hqos_port_get (u32 sw_if_index)
+{
+  hqos_main_t *hm = &hqos_main;
+
+  if (sw_if_index >= vec_len (hm->port_index_by_sw_if_index) ||
+      hm->port_index_by_sw_if_index[sw_if_index] == ~0)
+    return 0;
+
+  return pool_elt_at_index (hm->ports,
+			    hm->port_index_by_sw_if_index[sw_if_index]);
+}
+
+/* Point an interface at a pipe of the port, and have its packets go
+ * through hqos-enqueue. */
+static void
+hqos_map_set (hqos_port_t *port, u32 sw_if_index, u32 pipe)
+{
+  hqos_main_t *hm = &hqos_main;
+  hqos_map_t *m, empty = { .port_index = ~0, .pipe = ~0 };
+
+  vec_validate_init_empty (hm->map_by_sw_if_index, sw_if_index, empty);
+  m = hm->map_by_sw_if_index + sw_if_index;
+
+  if (m->port_index == ~0)
+    {
+      vec_add1 (port->sw_if_indices, sw_if_index);
+      vnet_feature_enable_disable ("interface-output", "hqos-enqueue",
+				   sw_if_index, 1, 0, 0);
+    }
+
+  m->port_index = port - hm->ports;
+  m->pipe = pipe;
+}
+
+static void
+hqos_map_clear (hqos_port_t *port, u32 sw_if_index)
+{
+  hqos_main_t *hm = &hqos_main;
+  hqos_map_t *m = hm->map_by_sw_if_index + sw_if_index;
+  u32 i;
+
+  m->port_index = ~0;
+  m->pipe = ~0;
+  vnet_feature_enable_disable ("interface-output", "hqos-enqueue",
+			       sw_if_index, 0, 0, 0);
+
+  i = vec_search (port->sw_if_indices, sw_if_index);
+  if (i != ~0)
+    vec_del1 (port->sw_if_indices, i);
+}
+
+/* The thread owning a new port, and the tx queue it sends to from it. */
+static clib_thread_index_t
+hqos_port_thread (vnet_main_t *vnm, vnet_hw_interface_t *hw, u32 worker,
+		  u32 *tx_queue_index)
+{
+  hqos_main_t *hm = &hqos_main;
+  clib_thread_index_t thread_index = 0;
+  vnet_hw_if_tx_queue_t *txq;
+  u32 *qi;
+
+  if (worker != ~0)
+    thread_index = vlib_get_worker_thread_index (worker);
+  else if (vlib_num_workers ())
+    thread_index = vlib_get_worker_thread_index (pool_elts (hm->ports) %
+						 vlib_num_workers ());
+
+  *tx_queue_index = ~0;
+  vec_foreach (qi, hw->tx_queue_indices)
+    {
+      txq = vnet_hw_if_get_tx_queue (vnm, qi[0]);
+      if (clib_bitmap_get (txq->threads, thread_index))
+	{
+	  *tx_queue_index = qi[0];
+	  break;
+	}
+    }
+
+  return thread_index;
+}
+
+static void
+hqos_schedule_node_update (clib_thread_index_t thread_index)
+{
+  hqos_main_t *hm = &hqos_main;
+
+  vlib_node_set_state (vlib_get_main_by_index (thread_index),
+		       hqos_schedule_node.index,
+		       vec_len (hm->ports_by_thread[thread_index]) ?
+			 VLIB_NODE_STATE_POLLING :
+			 VLIB_NODE_STATE_DISABLED);
+}
+
+int
+hqos_port_add (vlib_main_t *vm, u32 sw_if_index, const hqos_port_config_t *c)
+{
+  hqos_main_t *hm = &hqos_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_hw_interface_t *hw;
+  clib_thread_index_t thread_index;
+  hqos_port_t *port;
+  u32 tx_queue_index;
+  int rv;
+
+  if (!vnet_sw_interface_is_api_valid (vnm, sw_if_index))
+    return VNET_API_ERROR_INVALID_SW_IF_INDEX;
+
+  hw = vnet_get_sup_hw_interface (vnm, sw_if_index);
+  if (hw->sw_if_index != sw_if_index)
+    return VNET_API_ERROR_INVALID_SW_IF_INDEX_2;
+
+  if (hqos_port_get (sw_if_index))
+    return VNET_API_ERROR_VALUE_EXIST;
+
+  if (c->worker != ~0 && c->worker >= vlib_num_workers ())
+    return VNET_API_ERROR_INVALID_WORKER;
+
+  thread_index = hqos_port_thread (vnm, hw, c->worker, &tx_queue_index);
+  vec_validate (hm->ports_by_thread, vlib_get_n_threads () - 1);
+
+  pool_get_aligned (hm->ports, port, CLIB_CACHE_LINE_BYTES);
+  rv = hqos_port_init (vm, port, c);
+  if (rv)
+    {
+      pool_put (hm->ports, port);
+      return rv;
+    }
+
+  port->sw_if_index = sw_if_index;
+  port->hw_if_index = hw->hw_if_index;
+  port->thread_index = thread_index;
+  port->tx_queue_index = tx_queue_index;
+
+  vec_validate_init_empty (hm->port_index_by_sw_if_index, sw_if_index, ~0);
+  hm->port_index_by_sw_if_index[sw_if_index] = port - hm->ports;
+
+  /* the port's own packets go to its first pipe */
+  hqos_map_set (port, sw_if_index, 0);
+
+  vec_add1 (hm->ports_by_thread[thread_index], port - hm->ports);
+  hqos_schedule_node_update (thread_index);
+
+  log_debug ("port %U on thread %u", format_vnet_sw_if_index_name, vnm,
+	     sw_if_index, thread_index);
+
+  return 0;
+}
+
+int
+hqos_port_del (vlib_main_t *vm, u32 sw_if_index)
+{
+  hqos_main_t *hm = &hqos_main;
+  hqos_port_t *port;
+  u32 port_index, i;
+
+  port = hqos_port_get (sw_if_index);
+  if (port == 0)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  port_index = port - hm->ports;
+
+  while (vec_len (port->sw_if_indices))
+    hqos_map_clear (port, vec_elt (port->sw_if_indices, 0));
+
+  i = vec_search (hm->ports_by_thread[port->thread_index], port_index);
+  vec_del1 (hm->ports_by_thread[port->thread_index], i);
+  hqos_schedule_node_update (port->thread_index);
+
+  hm->port_index_by_sw_if_index[sw_if_index] = ~0;
+  hqos_port_free (vm, port);
+  pool_put_index (hm->ports, port_index);
+
+  return 0;
+}
+
+int
+hqos_subport_set (u32 sw_if_index, u32 subport, u64 rate, u32 burst)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  hqos_port_t *port;
+
+  port = hqos_port_get (sw_if_index);
+  if (port == 0)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  if (subport >= vec_len (port->subports))
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  hqos_bucket_init (&port->subports[subport].bucket, rate, burst,
+		    vm->clib_time.clocks_per_second);
+  return 0;
+}
+
+int
+hqos_pipe_set (u32 sw_if_index, u32 subport, u32 first_pipe, u32 n_pipes,
+	       u64 rate, u32 burst, const u8 *wrr_weights)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  hqos_port_t *port;
+  hqos_subport_t *s;
+  hqos_pipe_t *p;
+  u32 i;
+
+  port = hqos_port_get (sw_if_index);
+  if (port == 0)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  if (subport >= vec_len (port->subports))
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  s = port->subports + subport;
+  if (n_pipes == 0 || (u64) first_pipe + n_pipes > s->n_pipes)
+    return VNET_API_ERROR_INVALID_VALUE_2;
+
+  if (wrr_weights)
+    for (i = 0; i < HQOS_N_BE_QUEUES; i++)
+      if (wrr_weights[i] == 0)
+	return VNET_API_ERROR_INVALID_VALUE_3;
+
+  for (i = 0; i < n_pipes; i++)
+    {
+      p = port->pipes + s->first_pipe + first_pipe + i;
+      hqos_bucket_init (&p->bucket, rate, burst,
+			vm->clib_time.clocks_per_second);
+      if (wrr_weights)
+	clib_memcpy (p->wrr_weights, wrr_weights, sizeof (p->wrr_weights));
+    }
+
+  return 0;
+}
+
+int
+hqos_map (u32 sw_if_index, u32 port_sw_if_index, u32 subport, u32 pipe,
+	  int is_add)
+{
+  hqos_main_t *hm = &hqos_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  hqos_port_t *port;
+  hqos_subport_t *s;
+
+  if (!vnet_sw_interface_is_api_valid (vnm, sw_if_index))
+    return VNET_API_ERROR_INVALID_SW_IF_INDEX;
+
+  port = hqos_port_get (port_sw_if_index);
+  if (port == 0)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  if (vnet_get_sup_hw_interface (vnm, sw_if_index)->hw_if_index !=
+      port->hw_if_index)
+    return VNET_API_ERROR_INVALID_SW_IF_INDEX_2;
+
+  if (!is_add)
+    {
+      if (sw_if_index == port_sw_if_index ||
+	  sw_if_index >= vec_len (hm->map_by_sw_if_index) ||
+	  hm->map_by_sw_if_index[sw_if_index].port_index !=
+	    port - hm->ports)
+	return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+      hqos_map_clear (port, sw_if_index);
+      return 0;
+    }
+
+  if (subport >= vec_len (port->subports))
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  s = port->subports + subport;
+  if (pipe >= s->n_pipes)
+    return VNET_API_ERROR_INVALID_VALUE_2;
+
+  hqos_map_set (port, sw_if_index, s->first_pipe + pipe);
+  return 0;
+}
+
+int
+hqos_qos_map (u32 sw_if_index, u8 qos_bits, u32 tc, u32 queue)
+{
+  hqos_port_t *port;
+
+  port = hqos_port_get (sw_if_index);
+  if (port == 0)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  if (tc >= HQOS_N_TCS)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  if (queue >= (tc == HQOS_BE_TC ? HQOS_N_BE_QUEUES : 1))
+    return VNET_API_ERROR_INVALID_VALUE_2;
+
+  port->queue_by_qos[qos_bits] = hqos_queue_index (tc, queue);
+  return 0;
+}
+
+static clib_error_t *
+hqos_sw_interface_add_del (vnet_main_t *vnm, u32 sw_if_index, u32 is_add)
+{
+  hqos_main_t *hm = &hqos_main;
+  hqos_map_t *m;
+
+  if (is_add)
+    return 0;
+
+  if (hqos_port_get (sw_if_index))
+    hqos_port_del (vlib_get_main (), sw_if_index);
+  else if (sw_if_index < vec_len (hm->map_by_sw_if_index))
+    {
+      m = hm->map_by_sw_if_index + sw_if_index;
+      if (m->port_index != ~0)
+	hqos_map_clear (pool_elt_at_index (hm->ports, m->port_index),
+			sw_if_index);
+    }
+
+  return 0;
+}
+
+VNET_SW_INTERFACE_ADD_DEL_FUNCTION (hqos_sw_interface_add_del);
+
+static u8 *
+format_hqos_bucket (u8 *s, va_list *args)
+{
+  hqos_bucket_t *b = va_arg (*args, hqos_bucket_t *);
+  f64 clocks_per_second = vlib_get_main ()->clib_time.clocks_per_second;
+
+  if (b->rate == 0)
+    return format (s, "unshaped");
+
+  return format (s, "rate %.0f bps burst %lu bytes tokens %lu",
+		 (f64) b->rate * clocks_per_second * 8 / (1ULL << 32),
+		 b->size >> 32, b->tokens >> 32);
+}
+
+u8 *
+format_hqos_port (u8 *s, va_list *args)
+{
+  hqos_port_t *port = va_arg (*args, hqos_port_t *);
+  int verbose = va_arg (*args, int);
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 indent = format_get_indent (s);
+  hqos_subport_t *sp;
+  hqos_pipe_t *p;
+  u32 *sw_if_index;
+
+  s = format (s, "%U: thread %u, %u subports of %u pipes, queue size %u",
+	      format_vnet_sw_if_index_name, vnm, port->sw_if_index,
+	      port->thread_index, vec_len (port->subports),
+	      vec_len (port->pipes) / vec_len (port->subports),
+	      port->queue_mask + 1);
+  s = format (s, "\n%U%U", format_white_space, indent + 2, format_hqos_bucket,
+	      &port->bucket);
+  s = format (s, "\n%Uenqueued %lu dropped %lu dequeued %lu",
+	      format_white_space, indent + 2, port->n_enqueued,
+	      port->n_dropped, port->n_dequeued);
+
+  vec_foreach (sw_if_index, port->sw_if_indices)
+    s = format (s, "\n%U%U -> pipe %u", format_white_space, indent + 2,
+		format_vnet_sw_if_index_name, vnm, sw_if_index[0],
+		hqos_main.map_by_sw_if_index[sw_if_index[0]].pipe);
+
+  if (!verbose)
+    return s;
+
+  vec_foreach (sp, port->subports)
+    {
+      s = format (s, "\n%Usubport %u: %U", format_white_space, indent + 2,
+		  sp - port->subports, format_hqos_bucket, &sp->bucket);
+
+      for (p = port->pipes + sp->first_pipe;
+	   p < port->pipes + sp->first_pipe + sp->n_pipes; p++)
+	if (p->n_tx_packets || p->n_drops || p->active_queues)
+	  s = format (s,
+		      "\n%Upipe %u: %U, tx %lu packets %lu bytes, drops %lu",
+		      format_white_space, indent + 4,
+		      p - port->pipes - sp->first_pipe, format_hqos_bucket,
+		      &p->bucket, p->n_tx_packets, p->n_tx_bytes, p->n_drops);
+    }
+
+  return s;
+}
+
+static clib_error_t *
+hqos_port_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vnet_main_t *vnm = vnet_get_main ();
+  hqos_port_config_t c = {
+    .n_subports = 1,
+    .n_pipes = 1,
+    .queue_size = HQOS_DEFAULT_QUEUE_SIZE,
+    .frame_size = VLIB_FRAME_SIZE,
+    .worker = ~0,
+  };
+  clib_error_t *error = 0;
+  u32 sw_if_index = ~0;
+  int is_del = 0, rv;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (line_input, "rate %lu", &c.rate))
+	;
+      else if (unformat (line_input, "burst %u", &c.burst))
+	;
+      else if (unformat (line_input, "subports %u", &c.n_subports))
+	;
+      else if (unformat (line_input, "pipes %u", &c.n_pipes))
+	;
+      else if (unformat (line_input, "queue-size %u", &c.queue_size))
+	;
+      else if (unformat (line_input, "frame-size %u", &c.frame_size))
+	;
+      else if (unformat (line_input, "worker %u", &c.worker))
+	;
+      else if (unformat (line_input, "del"))
+	is_del = 1;
+      else
+	{
+	  error = clib_error_return (0, "unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0)
+    {
+      error = clib_error_return (0, "interface required");
+      goto done;
+    }
+
+  if (is_del)
+    rv = hqos_port_del (vm, sw_if_index);
+  else
+    rv = hqos_port_add (vm, sw_if_index, &c);
+
+  if (rv)
+    error = clib_error_return (0, "failed: %U", format_vnet_api_errno, rv);
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+VLIB_CLI_COMMAND (hqos_port_command, static) = {
+  .path = "hqos port",
+  .short_help = "hqos port <interface> [rate <bps>] [burst <bytes>] "
+		"[subports <n>] [pipes <n>] [queue-size <n>] "
+		"[frame-size <n>] [worker <n>] [del]",
+  .function = hqos_port_command_fn,
+};
+
+static clib_error_t *
+hqos_subport_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			 vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vnet_main_t *vnm = vnet_get_main ();
+  clib_error_t *error = 0;
+  u32 sw_if_index = ~0, subport = ~0, burst = 0;
+  u64 rate = 0;
+  int rv;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (line_input, "rate %lu", &rate))
+	;
+      else if (unformat (line_input, "burst %u", &burst))
+	;
+      else if (unformat (line_input, "%u", &subport))
+	;
+      else
+	{
+	  error = clib_error_return (0, "unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0 || subport == ~0)
+    {
+      error = clib_error_return (0, "interface and subport required");
+      goto done;
+    }
+
+  rv = hqos_subport_set (sw_if_index, subport, rate, burst);
+  if (rv)
+    error = clib_error_return (0, "failed: %U", format_vnet_api_errno, rv);
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+VLIB_CLI_COMMAND (hqos_subport_command, static) = {
+  .path = "hqos subport",
+  .short_help = "hqos subport <interface> <subport> [rate <bps>] "
+		"[burst <bytes>]",
+  .function = hqos_subport_command_fn,
+};
+
+static clib_error_t *
+hqos_pipe_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vnet_main_t *vnm = vnet_get_main ();
+  clib_error_t *error = 0;
+  u32 sw_if_index = ~0, subport = 0, first = ~0, last = ~0, burst = 0;
+  u32 w[HQOS_N_BE_QUEUES];
+  u8 weights[HQOS_N_BE_QUEUES];
+  int have_weights = 0, rv, i;
+  u64 rate = 0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (line_input, "subport %u", &subport))
+	;
+      else if (unformat (line_input, "pipe %u-%u", &first, &last))
+	;
+      else if (unformat (line_input, "pipe %u", &first))
+	last = first;
+      else if (unformat (line_input, "rate %lu", &rate))
+	;
+      else if (unformat (line_input, "burst %u", &burst))
+	;
+      else if (unformat (line_input, "weights %u %u %u %u", &w[0], &w[1],
+			 &w[2], &w[3]))
+	have_weights = 1;
+      else
+	{
+	  error = clib_error_return (0, "unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0 || first == ~0 || last < first)
+    {
+      error = clib_error_return (0, "interface and pipe required");
+      goto done;
+    }
+
+  for (i = 0; i < HQOS_N_BE_QUEUES; i++)
+    weights[i] = clib_min (w[i], 255);
+
+  rv = hqos_pipe_set (sw_if_index, subport, first, last - first + 1, rate,
+		      burst, have_weights ? weights : 0);
+  if (rv)
+    error = clib_error_return (0, "failed: %U", format_vnet_api_errno, rv);
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+VLIB_CLI_COMMAND (hqos_pipe_command, static) = {
+  .path = "hqos pipe",
+  .short_help = "hqos pipe <interface> [subport <n>] pipe <n>[-<n>] "
+		"[rate <bps>] [burst <bytes>] [weights <w0> <w1> <w2> <w3>]",
+  .function = hqos_pipe_command_fn,
+};
+
+static clib_error_t *
+hqos_map_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		     vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vnet_main_t *vnm = vnet_get_main ();
+  clib_error_t *error = 0;
+  u32 sw_if_index = ~0, port_sw_if_index = ~0, subport = 0, pipe = 0;
+  int is_add = 1, rv;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "port %U", unformat_vnet_sw_interface, vnm,
+		    &port_sw_if_index))
+	;
+      else if (unformat (line_input, "%U", unformat_vnet_sw_interface, vnm,
+			 &sw_if_index))
+	;
+      else if (unformat (line_input, "subport %u", &subport))
+	;
+      else if (unformat (line_input, "pipe %u", &pipe))
+	;
+      else if (unformat (line_input, "del"))
+	is_add = 0;
+      else
+	{
+	  error = clib_error_return (0, "unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0 || port_sw_if_index == ~0)
+    {
+      error = clib_error_return (0, "interface and port required");
+      goto done;
+    }
+
+  rv = hqos_map (sw_if_index, port_sw_if_index, subport, pipe, is_add);
+  if (rv)
+    error = clib_error_return (0, "failed: %U", format_vnet_api_errno, rv);
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+VLIB_CLI_COMMAND (hqos_map_command, static) = {
+  .path = "hqos map",
+  .short_help = "hqos map <sub-interface> port <interface> [subport <n>] "
+		"[pipe <n>] [del]",
+  .function = hqos_map_command_fn,
+};
+
+static clib_error_t *
+hqos_qos_map_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			 vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vnet_main_t *vnm = vnet_get_main ();
+  clib_error_t *error = 0;
+  u32 sw_if_index = ~0, bits = ~0, tc = ~0, queue = 0;
+  int rv;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (line_input, "qos %u", &bits))
+	;
+      else if (unformat (line_input, "tc %u", &tc))
+	;
+      else if (unformat (line_input, "queue %u", &queue))
+	;
+      else
+	{
+	  error = clib_error_return (0, "unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0 || bits > 255 || tc == ~0)
+    {
+      error = clib_error_return (0, "interface, qos and tc required");
+      goto done;
+    }
+
+  rv = hqos_qos_map (sw_if_index, bits, tc, queue);
+  if (rv)
+    error = clib_error_return (0, "failed: %U", format_vnet_api_errno, rv);
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+VLIB_CLI_COMMAND (hqos_qos_map_command, static) = {
+  .path = "hqos qos-map",
+  .short_help = "hqos qos-map <interface> qos <bits> tc <tc> [queue <n>]",
+  .function = hqos_qos_map_command_fn,
+};
+
+static clib_error_t *
+show_hqos_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  hqos_main_t *hm = &hqos_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 sw_if_index = ~0;
+  hqos_port_t *port;
+  int verbose = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (input, "verbose"))
+	verbose = 1;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  pool_foreach (port, hm->ports)
+    {
+      if (sw_if_index == ~0 || sw_if_index == port->sw_if_index)
+	vlib_cli_output (vm, "%U", format_hqos_port, port, verbose);
+    }
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_hqos_command, static) = {
+  .path = "show hqos",
+  .short_help = "show hqos [<interface>] [verbose]",
+  .function = show_hqos_command_fn,
+};
+
+static clib_error_t *
+hqos_init (vlib_main_t *vm)
+{
+  hqos_main_t *hm = &hqos_main;
+
+  hm->log_class = vlib_log_register_class ("hqos", 0);
+  hm->fq_index = vlib_frame_queue_main_init (hqos_enqueue_node.index, 0);
+
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (hqos_init);
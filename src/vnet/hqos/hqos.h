@@ -0,0 +1,321 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+/*
+ * Hierarchical QoS scheduler.
+ *
+ * An interface with HQoS enabled is a port. A port has subports, each
+ * subport has pipes, and each pipe has HQOS_N_TCS traffic classes. The
+ * first HQOS_N_TCS - 1 classes have one queue each and are served in
+ * strict priority. The last, best-effort, class has HQOS_N_BE_QUEUES
+ * queues served by weighted round robin.
+ *
+ * The port, its subports and its pipes are each shaped by a token bucket.
+ * Subports with packets and credits are served round robin by the port,
+ * and pipes with packets and credits round robin by their subport, up to
+ * HQOS_PIPE_QUANTUM packets at a time. A pipe or subport short of credits
+ * for its next packet is parked on the port's timing wheel until enough
+ * credits have built up, so only pipes which can send are ever visited.
+ *
+ * Packets are enqueued by the hqos-enqueue node on the interface-output
+ * feature arc of the port and of the sub-interfaces mapped onto its
+ * pipes. A port is owned by a single thread. Packets enqueued on other
+ * threads are handed off to it, so a port's queues are never locked. The
+ * hqos-schedule input node polls the ports of its thread and sends up to
+ * a frame, or the free space of the tx queue when the driver reports it,
+ * to the interface-output-arc-end node.
+ */
+
+#ifndef included_vnet_hqos_h
+#define included_vnet_hqos_h
+
+#include <vnet/vnet.h>
+#include <vppinfra/tw_timer_2t_1w_2048sl.h>
+
+#define HQOS_N_TCS	 4
+#define HQOS_BE_TC	 (HQOS_N_TCS - 1)
+#define HQOS_N_BE_QUEUES 4
+#define HQOS_N_QUEUES	 (HQOS_BE_TC + HQOS_N_BE_QUEUES)
+
+/* packets sent from a pipe each time it is visited */
+#define HQOS_PIPE_QUANTUM 8
+
+/* timing wheel tick */
+#define HQOS_TIMER_TICK 10e-6
+
+#define HQOS_TIMER_PIPE	   0
+#define HQOS_TIMER_SUBPORT 1
+
+#define HQOS_DEFAULT_QUEUE_SIZE 64
+
+/* queue of the best effort class, or of a strict priority class */
+#define hqos_queue_index(tc, q) ((tc) < HQOS_BE_TC ? (tc) : HQOS_BE_TC + (q))
+
+typedef enum
+{
+  HQOS_STATE_IDLE,	/* no packets */
+  HQOS_STATE_ACTIVE,	/* on its parent's round robin */
+  HQOS_STATE_WAITING,	/* waiting for credits on the timing wheel */
+} hqos_state_t;
+
+/*
+ * A token bucket. Tokens are bytes in 32.32 fixed point, and the rate is
+ * in bytes per CPU clock, so refilling as often as every packet does not
+ * lose the fractions. A bucket of rate 0 is unlimited.
+ */
+typedef struct
+{
+  u64 tokens;
+  u64 size;
+  u64 rate;
+  /* clocks to fill an empty bucket */
+  u64 fill_clocks;
+  u64 last_refill;
+} hqos_bucket_t;
+
+typedef struct
+{
+  /* ring of (length << 32 | buffer index), allocated on first use */
+  u64 *entries;
+  u16 head;
+  u16 n_entries;
+} hqos_queue_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  hqos_bucket_t bucket;
+  u8 state;
+  /* bitmap of the queues with packets */
+  u8 active_queues;
+  /* best effort queue being served, and packets left for it */
+  u8 wrr_queue;
+  u8 wrr_left;
+  u32 timer_handle;
+  u32 subport;
+  u8 wrr_weights[HQOS_N_BE_QUEUES];
+  hqos_queue_t queues[HQOS_N_QUEUES];
+  u64 n_tx_packets;
+  u64 n_tx_bytes;
+  u64 n_drops;
+} hqos_pipe_t;
+
+/* A ring of indices, each present at most once. */
+typedef struct
+{
+  u32 *elts;
+  u32 head;
+  u32 n_elts;
+} hqos_ring_t;
+
+typedef struct
+{
+  hqos_bucket_t bucket;
+  u8 state;
+  u32 timer_handle;
+  u32 first_pipe;
+  u32 n_pipes;
+  /* pipes with packets and credits */
+  hqos_ring_t active_pipes;
+} hqos_subport_t;
+
+typedef struct
+{
+  u64 rate;	/* bits per second, 0 for unshaped */
+  u32 burst;	/* bytes */
+  u32 n_subports;
+  u32 n_pipes;	/* per subport */
+  u32 queue_size;
+  u32 frame_size;
+  u32 worker;	/* ~0 for any */
+} hqos_port_config_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  hqos_bucket_t bucket;
+  clib_thread_index_t thread_index;
+  u32 sw_if_index;
+  u32 hw_if_index;
+  u32 tx_queue_index;
+  u32 queue_mask;
+  u32 frame_size;
+
+  /* subports with packets and credits */
+  hqos_ring_t active_subports;
+  hqos_subport_t *subports;
+  hqos_pipe_t *pipes;
+
+  TWT (tw_timer_wheel) wheel;
+  u32 *expired;
+  u64 clocks_per_tick;
+
+  /* queue of a packet by its vnet_buffer2 qos bits */
+  u8 queue_by_qos[256];
+
+  /* sub-interfaces mapped onto the port's pipes */
+  u32 *sw_if_indices;
+
+  u64 n_enqueued;
+  u64 n_dropped;
+  u64 n_dequeued;
+} hqos_port_t;
+
+typedef struct
+{
+  u32 port_index;
+  u32 pipe;
+} hqos_map_t;
+
+typedef struct
+{
+  hqos_port_t *ports;
+  u32 *port_index_by_sw_if_index;
+
+  /* port and pipe of the packets sent on an interface */
+  hqos_map_t *map_by_sw_if_index;
+
+  /* ports owned by each thread */
+  u32 **ports_by_thread;
+
+  /* frame queue for handoff to the owning thread */
+  u32 fq_index;
+
+  vlib_log_class_t log_class;
+} hqos_main_t;
+
+extern hqos_main_t hqos_main;
+
+extern vlib_node_registration_t hqos_enqueue_node;
+extern vlib_node_registration_t hqos_schedule_node;
+
+int hqos_port_add (vlib_main_t *vm, u32 sw_if_index,
+		   const hqos_port_config_t *c);
+int hqos_port_del (vlib_main_t *vm, u32 sw_if_index);
+int hqos_subport_set (u32 sw_if_index, u32 subport, u64 rate, u32 burst);
+int hqos_pipe_set (u32 sw_if_index, u32 subport, u32 first_pipe, u32 n_pipes,
+		   u64 rate, u32 burst, const u8 *wrr_weights);
+int hqos_map (u32 sw_if_index, u32 port_sw_if_index, u32 subport, u32 pipe,
+	      int is_add);
+int hqos_qos_map (u32 sw_if_index, u8 qos_bits, u32 tc, u32 queue);
+
+/* A port not bound to an interface, for benchmarks. */
+int hqos_port_init (vlib_main_t *vm, hqos_port_t *port,
+		    const hqos_port_config_t *c);
+void hqos_port_free (vlib_main_t *vm, hqos_port_t *port);
+
+format_function_t format_hqos_port;
+
+static_always_inline void
+hqos_bucket_refill (hqos_bucket_t *b, u64 now)
+{
+  u64 clocks = now - b->last_refill;
+
+  b->last_refill = now;
+  if (clocks >= b->fill_clocks)
+    b->tokens = b->size;
+  else
+    b->tokens = clib_min (b->tokens + clocks * b->rate, b->size);
+}
+
+/* Tokens needed to send n_bytes. A packet larger than the bucket needs a
+ * full bucket. */
+static_always_inline u64
+hqos_bucket_need (hqos_bucket_t *b, u32 n_bytes)
+{
+  return clib_min ((u64) n_bytes << 32, b->size);
+}
+
+static_always_inline int
+hqos_bucket_has (hqos_bucket_t *b, u32 n_bytes)
+{
+  return b->tokens >= hqos_bucket_need (b, n_bytes);
+}
+
+static_always_inline void
+hqos_bucket_take (hqos_bucket_t *b, u32 n_bytes)
+{
+  b->tokens -= hqos_bucket_need (b, n_bytes);
+}
+
+static_always_inline void
+hqos_ring_push (hqos_ring_t *r, u32 elt)
+{
+  u32 size = vec_len (r->elts);
+  u32 tail = r->head + r->n_elts;
+
+  ASSERT (r->n_elts < size);
+  r->elts[tail >= size ? tail - size : tail] = elt;
+  r->n_elts++;
+}
+
+static_always_inline u32
+hqos_ring_pop (hqos_ring_t *r)
+{
+  u32 elt = r->elts[r->head];
+
+  ASSERT (r->n_elts);
+  if (++r->head == vec_len (r->elts))
+    r->head = 0;
+  r->n_elts--;
+  return elt;
+}
+
+static_always_inline void
+hqos_subport_activate (hqos_port_t *port, u32 subport)
+{
+  hqos_subport_t *s = port->subports + subport;
+
+  s->state = HQOS_STATE_ACTIVE;
+  hqos_ring_push (&port->active_subports, subport);
+}
+
+static_always_inline void
+hqos_pipe_activate (hqos_port_t *port, hqos_pipe_t *p)
+{
+  hqos_subport_t *s = port->subports + p->subport;
+
+  p->state = HQOS_STATE_ACTIVE;
+  hqos_ring_push (&s->active_pipes, p - port->pipes);
+  if (s->state == HQOS_STATE_IDLE)
+    hqos_subport_activate (port, p->subport);
+}
+
+/*
+ * Enqueue a packet on one of a pipe's queues of the port, returning 0 if
+ * the queue is full. Only the port's thread may call this.
+ */
+static_always_inline int
+hqos_port_enqueue (hqos_port_t *port, u32 pipe, u32 queue, u32 bi,
+		   u32 n_bytes)
+{
+  hqos_pipe_t *p = port->pipes + pipe;
+  hqos_queue_t *q = p->queues + queue;
+
+  if (PREDICT_FALSE (q->n_entries > port->queue_mask))
+    {
+      p->n_drops++;
+      port->n_dropped++;
+      return 0;
+    }
+
+  if (PREDICT_FALSE (q->entries == 0))
+    vec_validate_aligned (q->entries, port->queue_mask,
+			  CLIB_CACHE_LINE_BYTES);
+
+  q->entries[(q->head + q->n_entries++) & port->queue_mask] =
+    (u64) n_bytes << 32 | bi;
+  p->active_queues |= 1 << queue;
+  port->n_enqueued++;
+
+  if (p->state == HQOS_STATE_IDLE)
+    hqos_pipe_activate (port, p);
+
+  return 1;
+}
+
+u32 hqos_port_dequeue (vlib_main_t *vm, hqos_port_t *port, u32 *buffers,
+		       u32 n_max);
+
+#endif /* included_vnet_hqos_h */
@@ -0,0 +1,434 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vnet/hqos/hqos.h>
+#include <vnet/feature/feature.h>
+#include <vnet/interface/tx_queue_funcs.h>
+
+typedef struct
+{
+  u32 port_index;
+  u32 pipe;
+  u8 queue;
+  u8 enqueued;
+} hqos_enqueue_trace_t;
+
+static u8 *
+format_hqos_enqueue_trace (u8 *s, va_list *args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  hqos_enqueue_trace_t *t = va_arg (*args, hqos_enqueue_trace_t *);
+
+  if (t->port_index == ~0)
+    return format (s, "no hqos port");
+
+  return format (s, "port %u pipe %u queue %u%s", t->port_index, t->pipe,
+		 t->queue, t->enqueued ? "" : " dropped");
+}
+
+#define foreach_hqos_enqueue_error                                            \
+  _ (ENQUEUED, "packets enqueued")                                            \
+  _ (QUEUE_FULL, "queue full drops")                                          \
+  _ (NO_PORT, "no hqos port")                                                 \
+  _ (CONGESTION, "handoff congestion drops")
+
+typedef enum
+{
+#define _(sym, str) HQOS_ENQUEUE_ERROR_##sym,
+  foreach_hqos_enqueue_error
+#undef _
+    HQOS_ENQUEUE_N_ERROR,
+} hqos_enqueue_error_t;
+
+static char *hqos_enqueue_error_strings[] = {
+#define _(sym, string) string,
+  foreach_hqos_enqueue_error
+#undef _
+};
+
+typedef enum
+{
+  HQOS_ENQUEUE_NEXT_DROP,
+  HQOS_ENQUEUE_N_NEXT,
+} hqos_enqueue_next_t;
+
+VLIB_NODE_FN (hqos_enqueue_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  hqos_main_t *hm = &hqos_main;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
+  u32 handoff_buffers[VLIB_FRAME_SIZE], drop_buffers[VLIB_FRAME_SIZE];
+  u16 thread_indices[VLIB_FRAME_SIZE];
+  u32 n_handoff = 0, n_drop = 0, n_enqueued = 0, n_full = 0;
+  u32 *from, n_left, i, queue, sw_if_index;
+  clib_thread_index_t thread_index = vm->thread_index;
+  hqos_port_t *port;
+  hqos_map_t *m;
+
+  from = vlib_frame_vector_args (frame);
+  n_left = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left);
+
+  for (i = 0; i < frame->n_vectors; i++, b++)
+    {
+      int enqueued = 0;
+
+      if (i + 4 < frame->n_vectors)
+	vlib_prefetch_buffer_header (b[4], LOAD);
+
+      sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_TX];
+      m = sw_if_index < vec_len (hm->map_by_sw_if_index) ?
+	    hm->map_by_sw_if_index + sw_if_index :
+	    0;
+
+      if (PREDICT_FALSE (m == 0 || m->port_index == ~0))
+	{
+	  b[0]->error = node->errors[HQOS_ENQUEUE_ERROR_NO_PORT];
+	  drop_buffers[n_drop++] = from[i];
+	  port = 0;
+	  queue = 0;
+	  goto trace;
+	}
+
+      port = pool_elt_at_index (hm->ports, m->port_index);
+
+      if (PREDICT_FALSE (port->thread_index != thread_index))
+	{
+	  handoff_buffers[n_handoff] = from[i];
+	  thread_indices[n_handoff++] = port->thread_index;
+	  continue;
+	}
+
+      queue = port->queue_by_qos[b[0]->flags & VNET_BUFFER_F_QOS_DATA_VALID ?
+				   vnet_buffer2 (b[0])->qos.bits :
+				   0];
+
+      enqueued = hqos_port_enqueue (port, m->pipe, queue, from[i],
+				    vlib_buffer_length_in_chain (vm, b[0]));
+      if (PREDICT_TRUE (enqueued))
+	n_enqueued++;
+      else
+	{
+	  b[0]->error = node->errors[HQOS_ENQUEUE_ERROR_QUEUE_FULL];
+	  drop_buffers[n_drop++] = from[i];
+	  n_full++;
+	}
+
+    trace:
+      if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE) &&
+			 (b[0]->flags & VLIB_BUFFER_IS_TRACED)))
+	{
+	  hqos_enqueue_trace_t *t =
+	    vlib_add_trace (vm, node, b[0], sizeof (*t));
+	  t->port_index = port ? port - hm->ports : ~0;
+	  t->pipe = port ? m->pipe : ~0;
+	  t->queue = queue;
+	  t->enqueued = enqueued;
+	}
+    }
+
+  if (n_handoff)
+    {
+      u32 n_enq = vlib_buffer_enqueue_to_thread (
+	vm, node, hm->fq_index, handoff_buffers, thread_indices, n_handoff, 1);
+
+      if (n_enq < n_handoff)
+	vlib_node_increment_counter (vm, node->node_index,
+				     HQOS_ENQUEUE_ERROR_CONGESTION,
+				     n_handoff - n_enq);
+    }
+
+  if (n_drop)
+    vlib_buffer_enqueue_to_single_next (vm, node, drop_buffers,
+					HQOS_ENQUEUE_NEXT_DROP, n_drop);
+
+  vlib_node_increment_counter (vm, node->node_index,
+			       HQOS_ENQUEUE_ERROR_ENQUEUED, n_enqueued);
+  vlib_node_increment_counter (vm, node->node_index,
+			       HQOS_ENQUEUE_ERROR_QUEUE_FULL, n_full);
+
+  return frame->n_vectors;
+}
+
+VLIB_REGISTER_NODE (hqos_enqueue_node) = {
+  .name = "hqos-enqueue",
+  .vector_size = sizeof (u32),
+  .format_trace = format_hqos_enqueue_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .n_errors = ARRAY_LEN (hqos_enqueue_error_strings),
+  .error_strings = hqos_enqueue_error_strings,
+  .n_next_nodes = HQOS_ENQUEUE_N_NEXT,
+  .next_nodes = {
+    [HQOS_ENQUEUE_NEXT_DROP] = "error-drop",
+  },
+};
+
+VNET_FEATURE_INIT (hqos_enqueue, static) = {
+  .arc_name = "interface-output",
+  .node_name = "hqos-enqueue",
+  .runs_after = VNET_FEATURES ("span-output", "ipsec-if-output"),
+  .runs_before = VNET_FEATURES ("interface-output-arc-end"),
+};
+
+typedef enum
+{
+  HQOS_DEQUEUE_EMPTY,
+  HQOS_DEQUEUE_QUANTUM,
+  HQOS_DEQUEUE_PIPE,
+  HQOS_DEQUEUE_SUBPORT,
+  HQOS_DEQUEUE_PORT,
+} hqos_dequeue_result_t;
+
+/* The queue to serve next: strict priority classes first, then the best
+ * effort queues by weighted round robin. */
+static_always_inline u32
+hqos_pipe_next_queue (hqos_pipe_t *p)
+{
+  u32 strict = p->active_queues & pow2_mask (HQOS_BE_TC);
+
+  if (strict)
+    return count_trailing_zeros (strict);
+
+  if (p->wrr_left == 0 ||
+      !(p->active_queues & (1 << (HQOS_BE_TC + p->wrr_queue))))
+    {
+      do
+	p->wrr_queue = (p->wrr_queue + 1) % HQOS_N_BE_QUEUES;
+      while (!(p->active_queues & (1 << (HQOS_BE_TC + p->wrr_queue))));
+      p->wrr_left = p->wrr_weights[p->wrr_queue];
+    }
+
+  return HQOS_BE_TC + p->wrr_queue;
+}
+
+static_always_inline hqos_dequeue_result_t
+hqos_pipe_dequeue (hqos_port_t *port, hqos_subport_t *s, hqos_pipe_t *p,
+		   u32 *buffers, u32 n_max, u32 *n_sent, u32 *n_bytes_next)
+{
+  hqos_dequeue_result_t rv;
+  hqos_queue_t *q;
+  u32 n = 0, qi, len = 0;
+  u64 e;
+
+  while (1)
+    {
+      if (p->active_queues == 0)
+	{
+	  rv = HQOS_DEQUEUE_EMPTY;
+	  break;
+	}
+      if (n == n_max)
+	{
+	  rv = HQOS_DEQUEUE_QUANTUM;
+	  break;
+	}
+
+      qi = hqos_pipe_next_queue (p);
+      q = p->queues + qi;
+      e = q->entries[q->head];
+      len = e >> 32;
+
+      if (PREDICT_FALSE (!hqos_bucket_has (&p->bucket, len)))
+	{
+	  rv = HQOS_DEQUEUE_PIPE;
+	  break;
+	}
+      if (PREDICT_FALSE (!hqos_bucket_has (&s->bucket, len)))
+	{
+	  rv = HQOS_DEQUEUE_SUBPORT;
+	  break;
+	}
+      if (PREDICT_FALSE (!hqos_bucket_has (&port->bucket, len)))
+	{
+	  rv = HQOS_DEQUEUE_PORT;
+	  break;
+	}
+
+      hqos_bucket_take (&p->bucket, len);
+      hqos_bucket_take (&s->bucket, len);
+      hqos_bucket_take (&port->bucket, len);
+
+      buffers[n++] = (u32) e;
+      q->head = (q->head + 1) & port->queue_mask;
+      if (--q->n_entries == 0)
+	p->active_queues &= ~(1 << qi);
+      if (qi >= HQOS_BE_TC)
+	p->wrr_left--;
+      p->n_tx_bytes += len;
+    }
+
+  p->n_tx_packets += n;
+  *n_sent = n;
+  *n_bytes_next = len;
+  return rv;
+}
+
+/* Park a pipe or subport on the timing wheel until its bucket holds the
+ * tokens for n_bytes. */
+static u32
+hqos_wait (hqos_port_t *port, hqos_bucket_t *b, u32 n_bytes, u32 index,
+	   u32 timer_id)
+{
+  u64 clocks, ticks;
+
+  clocks = (hqos_bucket_need (b, n_bytes) - b->tokens) / b->rate + 1;
+  ticks = clocks / port->clocks_per_tick + 1;
+  ticks = clib_min (ticks, TW_SLOTS_PER_RING - 1);
+
+  return TW (tw_timer_start) (&port->wheel, index, timer_id, ticks);
+}
+
+static void
+hqos_timer_expired (hqos_port_t *port, u32 handle)
+{
+  u32 index = handle & pow2_mask (31);
+  hqos_subport_t *s;
+  hqos_pipe_t *p;
+
+  if ((handle >> 31) == HQOS_TIMER_PIPE)
+    {
+      p = port->pipes + index;
+      p->timer_handle = ~0;
+      if (p->active_queues)
+	hqos_pipe_activate (port, p);
+      else
+	p->state = HQOS_STATE_IDLE;
+    }
+  else
+    {
+      s = port->subports + index;
+      s->timer_handle = ~0;
+      if (s->active_pipes.n_elts)
+	hqos_subport_activate (port, index);
+      else
+	s->state = HQOS_STATE_IDLE;
+    }
+}
+
+u32
+hqos_port_dequeue (vlib_main_t *vm, hqos_port_t *port, u32 *buffers,
+		   u32 n_max)
+{
+  hqos_dequeue_result_t rv;
+  hqos_subport_t *s;
+  hqos_pipe_t *p;
+  u32 n = 0, n_sent, n_bytes, si, pi, *h;
+  u64 now;
+
+  port->expired = TW (tw_timer_expire_timers_vec) (
+    &port->wheel, vlib_time_now (vm), port->expired);
+  vec_foreach (h, port->expired)
+    hqos_timer_expired (port, h[0]);
+  vec_set_len (port->expired, 0);
+
+  if (port->active_subports.n_elts == 0)
+    return 0;
+
+  now = clib_cpu_time_now ();
+  hqos_bucket_refill (&port->bucket, now);
+
+  while (n < n_max && port->active_subports.n_elts)
+    {
+      si = hqos_ring_pop (&port->active_subports);
+      s = port->subports + si;
+      hqos_bucket_refill (&s->bucket, now);
+
+      pi = hqos_ring_pop (&s->active_pipes);
+      p = port->pipes + pi;
+      if (s->active_pipes.n_elts)
+	clib_prefetch_store (port->pipes +
+			     s->active_pipes.elts[s->active_pipes.head]);
+      hqos_bucket_refill (&p->bucket, now);
+
+      rv = hqos_pipe_dequeue (port, s, p, buffers + n,
+			      clib_min (n_max - n, HQOS_PIPE_QUANTUM), &n_sent,
+			      &n_bytes);
+      n += n_sent;
+
+      if (rv == HQOS_DEQUEUE_EMPTY)
+	p->state = HQOS_STATE_IDLE;
+      else if (rv == HQOS_DEQUEUE_PIPE)
+	{
+	  p->state = HQOS_STATE_WAITING;
+	  p->timer_handle =
+	    hqos_wait (port, &p->bucket, n_bytes, pi, HQOS_TIMER_PIPE);
+	}
+      else
+	hqos_ring_push (&s->active_pipes, pi);
+
+      if (rv == HQOS_DEQUEUE_SUBPORT)
+	{
+	  s->state = HQOS_STATE_WAITING;
+	  s->timer_handle =
+	    hqos_wait (port, &s->bucket, n_bytes, si, HQOS_TIMER_SUBPORT);
+	  continue;
+	}
+
+      if (s->active_pipes.n_elts)
+	hqos_ring_push (&port->active_subports, si);
+      else
+	s->state = HQOS_STATE_IDLE;
+
+      if (rv == HQOS_DEQUEUE_PORT)
+	break;
+    }
+
+  port->n_dequeued += n;
+  return n;
+}
+
+typedef enum
+{
+  HQOS_SCHEDULE_NEXT_TX,
+  HQOS_SCHEDULE_N_NEXT,
+} hqos_schedule_next_t;
+
+/* Send no more than the tx queue has room for, when the driver says. */
+static_always_inline u32
+hqos_port_budget (vnet_main_t *vnm, hqos_port_t *port)
+{
+  vnet_hw_if_tx_queue_t *txq;
+
+  if (port->tx_queue_index == ~0)
+    return port->frame_size;
+
+  txq = vnet_hw_if_get_tx_queue (vnm, port->tx_queue_index);
+  if (PREDICT_FALSE (txq == 0))
+    return port->frame_size;
+
+  return clib_min (port->frame_size, txq->n_free);
+}
+
+VLIB_NODE_FN (hqos_schedule_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  hqos_main_t *hm = &hqos_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 buffers[VLIB_FRAME_SIZE];
+  u32 n, n_total = 0, *pi;
+  hqos_port_t *port;
+
+  vec_foreach (pi, hm->ports_by_thread[vm->thread_index])
+    {
+      port = pool_elt_at_index (hm->ports, pi[0]);
+      n = hqos_port_dequeue (vm, port, buffers, hqos_port_budget (vnm, port));
+      if (n)
+	vlib_buffer_enqueue_to_single_next (vm, node, buffers,
+					    HQOS_SCHEDULE_NEXT_TX, n);
+      n_total += n;
+    }
+
+  return n_total;
+}
+
+VLIB_REGISTER_NODE (hqos_schedule_node) = {
+  .name = "hqos-schedule",
+  .type = VLIB_NODE_TYPE_INPUT,
+  .state = VLIB_NODE_STATE_DISABLED,
+  .n_next_nodes = HQOS_SCHEDULE_N_NEXT,
+  .next_nodes = {
+    [HQOS_SCHEDULE_NEXT_TX] = "interface-output-arc-end",
+  },
+};
@@ -641,6 +641,13 @@ typedef struct
 
   /* bitmap of threads which use this queue */
   clib_bitmap_t *threads;
+
+  /* free descriptors as last seen by the driver, ~0 if it does not tell */
+  u32 n_free;
+  /* descriptors in the queue, 0 if the driver does not tell */
+  u32 size;
+  /* active queue management, ~0 if none */
+  u32 aqm_index;
 } vnet_hw_if_tx_queue_t;
 
 typedef enum
@@ -26,16 +26,47 @@ VLIB_REGISTER_LOG_CLASS (if_rxq_log, static) = {
 #define log_debug(fmt, ...) vlib_log_debug (if_rxq_log.class, fmt, __VA_ARGS__)
 #define log_err(fmt, ...)   vlib_log_err (if_rxq_log.class, fmt, __VA_ARGS__)
 
+/* Least loaded worker on the interface's NUMA node, or ~0 if none */
 static u32
-next_thread_index (vnet_main_t *vnm, clib_thread_index_t thread_index)
+numa_local_thread_index (vnet_main_t *vnm, vnet_hw_interface_t *hi)
+{
+  vnet_interface_main_t *im = &vnm->interface_main;
+  vnet_device_main_t *vdm = &vnet_device_main;
+  vnet_hw_if_rx_queue_t *rxq;
+  u32 *n_queues = 0, best = ~0, i;
+
+  vec_validate (n_queues, vdm->last_worker_thread_index);
+  pool_foreach (rxq, im->hw_if_rx_queues)
+    if (rxq->thread_index < vec_len (n_queues))
+      n_queues[rxq->thread_index]++;
+
+  for (i = vdm->first_worker_thread_index;
+       i <= vdm->last_worker_thread_index; i++)
+    if (vlib_worker_threads[i].numa_id == hi->numa_node &&
+	(best == ~0 || n_queues[i] < n_queues[best]))
+      best = i;
+
+  vec_free (n_queues);
+  return best;
+}
+
+static u32
+next_thread_index (vnet_main_t *vnm, vnet_hw_interface_t *hi,
+		   clib_thread_index_t thread_index)
 {
   vnet_device_main_t *vdm = &vnet_device_main;
+  u32 ti;
+
   if (vdm->first_worker_thread_index == 0)
     return 0;
 
   if (thread_index != 0 && (thread_index < vdm->first_worker_thread_index ||
 			    thread_index > vdm->last_worker_thread_index))
     {
+      if (vlib_get_thread_main ()->numa_local &&
+	  (ti = numa_local_thread_index (vnm, hi)) != ~0)
+	return ti;
+
       thread_index = vdm->next_worker_thread_index++;
       if (vdm->next_worker_thread_index > vdm->last_worker_thread_index)
 	vdm->next_worker_thread_index = vdm->first_worker_thread_index;
@@ -75,7 +106,7 @@ vnet_hw_if_register_rx_queue (vnet_main_t *vnm, u32 hw_if_index, u32 queue_id,
 		"interface %v\n",
 		queue_id, hi->name);
 
-  thread_index = next_thread_index (vnm, thread_index);
+  thread_index = next_thread_index (vnm, hi, thread_index);
 
   pool_get_zero (im->hw_if_rx_queues, rxq);
   queue_index = rxq - im->hw_if_rx_queues;
@@ -0,0 +1,443 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/devices/devices.h>
+#include <vnet/interface/rx_queue_funcs.h>
+#include <vnet/interface/rx_rebalance.h>
+
+VLIB_REGISTER_LOG_CLASS (if_rx_rebalance_log, static) = {
+  .class_name = "interface",
+  .subclass_name = "rx-rebalance",
+};
+
+#define log_debug(fmt, ...)                                                   \
+  vlib_log_debug (if_rx_rebalance_log.class, fmt, __VA_ARGS__)
+#define log_notice(fmt, ...)                                                  \
+  vlib_log_notice (if_rx_rebalance_log.class, fmt, __VA_ARGS__)
+
+typedef enum
+{
+  RX_REBALANCE_EVENT_CONFIG = 1,
+} rx_rebalance_event_t;
+
+vnet_hw_if_rx_rebalance_main_t vnet_hw_if_rx_rebalance_main;
+
+static_always_inline int
+rx_rebalance_is_worker (clib_thread_index_t thread_index)
+{
+  vnet_device_main_t *vdm = &vnet_device_main;
+
+  return vdm->first_worker_thread_index &&
+	 thread_index >= vdm->first_worker_thread_index &&
+	 thread_index <= vdm->last_worker_thread_index;
+}
+
+/* Measure worker vector rates and queue packet rates since the last call */
+static void
+rx_rebalance_sample (vlib_main_t *vm, f64 now)
+{
+  vnet_hw_if_rx_rebalance_main_t *rm = &vnet_hw_if_rx_rebalance_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_interface_main_t *im = &vnm->interface_main;
+  vlib_combined_counter_main_t *cm =
+    im->combined_sw_if_counters + VNET_INTERFACE_COUNTER_RX;
+  vnet_hw_if_rx_rebalance_thread_t *rt;
+  vnet_hw_if_rx_rebalance_queue_t *q;
+  vnet_hw_if_rx_queue_t *rxq, *other;
+  vnet_hw_interface_t *hi;
+  vlib_main_t *tvm;
+  u64 vectors, calls, packets;
+  f64 dt = now - rm->last_sample_time;
+  u32 qi, i, n_shared, sw_if_index;
+
+  rm->last_sample_time = now;
+
+  vec_validate (rm->threads, vlib_get_n_threads () - 1);
+  vec_foreach (rt, rm->threads)
+    {
+      tvm = vlib_get_main_by_index (rt - rm->threads);
+      vectors = tvm->internal_node_vectors;
+      calls = tvm->internal_node_calls;
+      rt->vector_rate = calls > rt->last_calls ?
+			  (f64) (vectors - rt->last_vectors) /
+			    (f64) (calls - rt->last_calls) :
+			  0;
+      rt->last_vectors = vectors;
+      rt->last_calls = calls;
+      rt->pps = 0;
+      rt->n_queues = 0;
+    }
+
+  pool_foreach (rxq, im->hw_if_rx_queues)
+    {
+      qi = rxq - im->hw_if_rx_queues;
+      vec_validate (rm->queues, qi);
+      q = vec_elt_at_index (rm->queues, qi);
+
+      if (!rx_rebalance_is_worker (rxq->thread_index))
+	{
+	  q->last_thread_index = ~0;
+	  continue;
+	}
+
+      hi = vnet_get_hw_interface (vnm, rxq->hw_if_index);
+      sw_if_index = hi->sw_if_index;
+      packets = 0;
+      if (rxq->thread_index < vec_len (cm->counters) &&
+	  sw_if_index < vec_len (cm->counters[rxq->thread_index]))
+	packets = cm->counters[rxq->thread_index][sw_if_index].packets;
+
+      /* new, just moved, or counters cleared: start over */
+      if (q->last_thread_index != rxq->thread_index ||
+	  packets < q->last_packets || dt <= 0)
+	q->pps = 0;
+      else
+	{
+	  n_shared = 0;
+	  vec_foreach_index (i, hi->rx_queue_indices)
+	    {
+	      other = vnet_hw_if_get_rx_queue (vnm, hi->rx_queue_indices[i]);
+	      n_shared += other->thread_index == rxq->thread_index;
+	    }
+	  q->pps = (packets - q->last_packets) / dt / n_shared;
+	}
+
+      q->last_packets = packets;
+      q->last_thread_index = rxq->thread_index;
+
+      rt = vec_elt_at_index (rm->threads, rxq->thread_index);
+      rt->pps += q->pps;
+      rt->n_queues++;
+    }
+}
+
+static void
+rx_rebalance_move (vlib_main_t *vm, u32 queue_index,
+		   clib_thread_index_t to_thread_index, f64 now)
+{
+  vnet_hw_if_rx_rebalance_main_t *rm = &vnet_hw_if_rx_rebalance_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_hw_if_rx_queue_t *rxq = vnet_hw_if_get_rx_queue (vnm, queue_index);
+  vnet_hw_if_rx_rebalance_queue_t *q = vec_elt_at_index (rm->queues,
+							 queue_index);
+  vnet_hw_if_rx_rebalance_decision_t *d;
+
+  if (vec_len (rm->decisions) < VNET_HW_IF_RX_REBALANCE_N_DECISIONS)
+    vec_add2 (rm->decisions, d, 1);
+  else
+    d = vec_elt_at_index (rm->decisions, rm->next_decision);
+  rm->next_decision =
+    (rm->next_decision + 1) % VNET_HW_IF_RX_REBALANCE_N_DECISIONS;
+
+  d->time = unix_time_now ();
+  d->hw_if_index = rxq->hw_if_index;
+  d->queue_id = rxq->queue_id;
+  d->from_thread_index = rxq->thread_index;
+  d->to_thread_index = to_thread_index;
+  d->queue_pps = q->pps;
+  d->from_vector_rate = rm->threads[rxq->thread_index].vector_rate;
+  d->to_vector_rate = rm->threads[to_thread_index].vector_rate;
+
+  log_notice ("%U", format_vnet_hw_if_rx_rebalance_decision, d);
+
+  vnet_hw_if_set_rx_queue_thread_index (vnm, queue_index, to_thread_index);
+  vnet_hw_if_update_runtime_data (vnm, rxq->hw_if_index);
+
+  q->last_move_time = now;
+  rm->n_moves++;
+}
+
+static void
+rx_rebalance_run (vlib_main_t *vm, f64 now)
+{
+  vnet_hw_if_rx_rebalance_main_t *rm = &vnet_hw_if_rx_rebalance_main;
+  vnet_device_main_t *vdm = &vnet_device_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_interface_main_t *im = &vnm->interface_main;
+  vnet_hw_if_rx_rebalance_thread_t *busy, *idle, *rt;
+  vnet_hw_if_rx_rebalance_queue_t *q;
+  vnet_hw_if_rx_queue_t *rxq;
+  u32 best = ~0, qi;
+  f64 target, diff, best_diff = 0;
+  clib_thread_index_t ti;
+
+  rx_rebalance_sample (vm, now);
+
+  if (vdm->first_worker_thread_index == 0 ||
+      vdm->first_worker_thread_index == vdm->last_worker_thread_index)
+    return;
+
+  busy = idle = vec_elt_at_index (rm->threads, vdm->first_worker_thread_index);
+  for (ti = vdm->first_worker_thread_index + 1;
+       ti <= vdm->last_worker_thread_index; ti++)
+    {
+      rt = vec_elt_at_index (rm->threads, ti);
+      if (rt->vector_rate > busy->vector_rate)
+	busy = rt;
+      if (rt->vector_rate < idle->vector_rate ||
+	  (rt->vector_rate == idle->vector_rate && rt->pps < idle->pps))
+	idle = rt;
+    }
+
+  /* hysteresis: a worker must stay busy, with another one spare, for
+     n_samples samples in a row */
+  if (busy == idle || busy->vector_rate < rm->threshold ||
+      idle->vector_rate >= rm->threshold || busy->n_queues < 2)
+    {
+      rm->n_busy = 0;
+      return;
+    }
+
+  if (++rm->n_busy < rm->n_samples)
+    return;
+
+  /* the queue which evens the two workers out best, without just moving
+     the imbalance over */
+  target = (busy->pps - idle->pps) / 2;
+  pool_foreach (rxq, im->hw_if_rx_queues)
+    {
+      qi = rxq - im->hw_if_rx_queues;
+      q = vec_elt_at_index (rm->queues, qi);
+
+      if (rxq->thread_index != busy - rm->threads || q->pps <= 0 ||
+	  q->pps >= 2 * target ||
+	  (q->last_move_time && now - q->last_move_time < rm->hold_down))
+	continue;
+
+      diff = clib_abs (q->pps - target);
+      if (best == ~0 || diff < best_diff)
+	{
+	  best = qi;
+	  best_diff = diff;
+	}
+    }
+
+  if (best == ~0)
+    {
+      log_debug ("thread %u busy, no queue to move to thread %u",
+		 (u32) (busy - rm->threads), (u32) (idle - rm->threads));
+      return;
+    }
+
+  rx_rebalance_move (vm, best, idle - rm->threads, now);
+  rm->n_busy = 0;
+}
+
+static uword
+rx_rebalance_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
+		      vlib_frame_t *f)
+{
+  vnet_hw_if_rx_rebalance_main_t *rm = &vnet_hw_if_rx_rebalance_main;
+  uword *event_data = 0;
+
+  while (1)
+    {
+      if (rm->is_enabled)
+	vlib_process_wait_for_event_or_clock (vm, rm->interval);
+      else
+	vlib_process_wait_for_event (vm);
+
+      /* a config change restarts sampling */
+      if (vlib_process_get_events (vm, &event_data) != ~0)
+	{
+	  vec_reset_length (event_data);
+	  rm->n_busy = 0;
+	  rx_rebalance_sample (vm, vlib_time_now (vm));
+	  continue;
+	}
+
+      if (rm->is_enabled)
+	rx_rebalance_run (vm, vlib_time_now (vm));
+    }
+
+  return 0;
+}
+
+VLIB_REGISTER_NODE (rx_rebalance_node) = {
+  .function = rx_rebalance_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "rx-queue-rebalance-process",
+};
+
+void
+vnet_hw_if_rx_rebalance_enable_disable (vlib_main_t *vm, int enable,
+					f64 interval, f64 hold_down,
+					u32 threshold, u32 n_samples)
+{
+  vnet_hw_if_rx_rebalance_main_t *rm = &vnet_hw_if_rx_rebalance_main;
+
+  if (interval > 0)
+    rm->interval = interval;
+  if (hold_down > 0)
+    rm->hold_down = hold_down;
+  if (threshold)
+    rm->threshold = threshold;
+  if (n_samples)
+    rm->n_samples = n_samples;
+  rm->is_enabled = enable != 0;
+
+  vlib_process_signal_event (vm, rm->node_index, RX_REBALANCE_EVENT_CONFIG,
+			     0);
+}
+
+void
+vnet_hw_if_rx_rebalance_decision_walk (
+  vnet_hw_if_rx_rebalance_decision_cb_t *fn, void *ctx)
+{
+  vnet_hw_if_rx_rebalance_main_t *rm = &vnet_hw_if_rx_rebalance_main;
+  u32 n = vec_len (rm->decisions), i;
+
+  /* before the ring is full next_decision is its length, i.e. 0 mod n */
+  for (i = 0; i < n; i++)
+    fn (vec_elt_at_index (rm->decisions, (rm->next_decision + i) % n), ctx);
+}
+
+u8 *
+format_vnet_hw_if_rx_rebalance_decision (u8 *s, va_list *args)
+{
+  vnet_hw_if_rx_rebalance_decision_t *d =
+    va_arg (*args, vnet_hw_if_rx_rebalance_decision_t *);
+  vnet_main_t *vnm = vnet_get_main ();
+
+  return format (s,
+		 "%U queue %u: thread %u (vector rate %.1f) -> thread %u "
+		 "(vector rate %.1f), %.0f pps",
+		 format_vnet_hw_if_index_name, vnm, d->hw_if_index, d->queue_id,
+		 d->from_thread_index, d->from_vector_rate, d->to_thread_index,
+		 d->to_vector_rate, d->queue_pps);
+}
+
+static void
+show_rx_rebalance_decision (vnet_hw_if_rx_rebalance_decision_t *d, void *ctx)
+{
+  vlib_main_t *vm = ctx;
+
+  vlib_cli_output (vm, "  %U %U", format_time_float, NULL, d->time,
+		   format_vnet_hw_if_rx_rebalance_decision, d);
+}
+
+static clib_error_t *
+set_interface_rx_rebalance_command_fn (vlib_main_t *vm,
+				       unformat_input_t *input,
+				       vlib_cli_command_t *cmd)
+{
+  vnet_hw_if_rx_rebalance_main_t *rm = &vnet_hw_if_rx_rebalance_main;
+  f64 interval = 0, hold_down = 0;
+  u32 threshold = 0, n_samples = 0;
+  int enable = 1;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "disable"))
+	enable = 0;
+      else if (unformat (input, "enable"))
+	enable = 1;
+      else if (unformat (input, "interval %f", &interval))
+	;
+      else if (unformat (input, "hold-down %f", &hold_down))
+	;
+      else if (unformat (input, "threshold %u", &threshold))
+	;
+      else if (unformat (input, "samples %u", &n_samples))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (threshold > VLIB_FRAME_SIZE)
+    return clib_error_return (0, "threshold is a vector rate, at most %u",
+			      VLIB_FRAME_SIZE);
+
+  vnet_hw_if_rx_rebalance_enable_disable (vm, enable, interval, hold_down,
+					  threshold, n_samples);
+
+  if (enable && vnet_device_main.first_worker_thread_index == 0)
+    vlib_cli_output (vm, "no workers, nothing to rebalance");
+  else if (enable)
+    vlib_cli_output (vm,
+		     "sampling every %.2fs, moving after %u samples at vector "
+		     "rate %u or more",
+		     rm->interval, rm->n_samples, rm->threshold);
+  return 0;
+}
+
+/*?
+ * Move rx queues between workers when one of them is busy while another
+ * one has capacity to spare. Every <em>interval</em> seconds the vector
+ * rate of each worker and the packet rate of each rx queue are measured.
+ * When the busiest worker has been at or above the <em>threshold</em>
+ * vector rate, and the idlest one below it, for <em>samples</em> samples
+ * in a row, a queue of the busy worker is moved to the idle one. A queue
+ * is moved at most once every <em>hold-down</em> seconds.
+ *
+ * @cliexpar
+ * @cliexcmd{set interface rx-rebalance interval 1 threshold 64 samples 3}
+ * @cliexcmd{set interface rx-rebalance disable}
+?*/
+VLIB_CLI_COMMAND (set_interface_rx_rebalance_command, static) = {
+  .path = "set interface rx-rebalance",
+  .short_help = "set interface rx-rebalance [enable|disable] "
+		"[interval <sec>] [threshold <vector-rate>] "
+		"[samples <n>] [hold-down <sec>]",
+  .function = set_interface_rx_rebalance_command_fn,
+};
+
+static clib_error_t *
+show_interface_rx_rebalance_command_fn (vlib_main_t *vm,
+					unformat_input_t *input,
+					vlib_cli_command_t *cmd)
+{
+  vnet_hw_if_rx_rebalance_main_t *rm = &vnet_hw_if_rx_rebalance_main;
+  vnet_device_main_t *vdm = &vnet_device_main;
+  vnet_hw_if_rx_rebalance_thread_t *rt;
+  clib_thread_index_t ti;
+
+  vlib_cli_output (vm,
+		   "rx-rebalance %s: interval %.2fs, threshold %u, "
+		   "samples %u, hold-down %.0fs",
+		   rm->is_enabled ? "enabled" : "disabled", rm->interval,
+		   rm->threshold, rm->n_samples, rm->hold_down);
+
+  if (rm->is_enabled && vdm->first_worker_thread_index)
+    {
+      vlib_cli_output (vm, "%-8s%-14s%-14s%s", "thread", "vector-rate", "pps",
+		       "queues");
+      for (ti = vdm->first_worker_thread_index;
+	   ti <= vdm->last_worker_thread_index && ti < vec_len (rm->threads);
+	   ti++)
+	{
+	  rt = vec_elt_at_index (rm->threads, ti);
+	  vlib_cli_output (vm, "%-8u%-14.1f%-14.0f%u", ti, rt->vector_rate,
+			   rt->pps, rt->n_queues);
+	}
+    }
+
+  vlib_cli_output (vm, "%lu queues moved, last %u:", rm->n_moves,
+		   vec_len (rm->decisions));
+  vnet_hw_if_rx_rebalance_decision_walk (show_rx_rebalance_decision, vm);
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_interface_rx_rebalance_command, static) = {
+  .path = "show interface rx-rebalance",
+  .short_help = "show interface rx-rebalance",
+  .function = show_interface_rx_rebalance_command_fn,
+};
+
+static clib_error_t *
+rx_rebalance_init (vlib_main_t *vm)
+{
+  vnet_hw_if_rx_rebalance_main_t *rm = &vnet_hw_if_rx_rebalance_main;
+
+  rm->node_index = rx_rebalance_node.index;
+  rm->interval = 1;
+  rm->hold_down = 30;
+  rm->threshold = 64;
+  rm->n_samples = 3;
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (rx_rebalance_init);
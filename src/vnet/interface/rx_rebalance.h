@@ -0,0 +1,99 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+/*
+ * Automatic rx-queue rebalancing.
+ *
+ * A process samples, every interval, the vector rate of each worker and
+ * the packet rate of each rx queue. A queue's rate is estimated from the
+ * rx counter of its interface on the queue's thread, shared evenly among
+ * the queues of the interface polled by that thread.
+ *
+ * When the busiest worker's vector rate has been at or above the
+ * threshold, and the idlest one's below it, for n_samples samples in a
+ * row, the queue of the busiest worker whose rate is closest to half the
+ * difference of the two workers' rates is moved to the idlest worker.
+ * A worker polling a single queue is left alone, and a queue which has
+ * been moved stays put for hold_down seconds.
+ */
+
+#ifndef included_vnet_interface_rx_rebalance_h
+#define included_vnet_interface_rx_rebalance_h
+
+#include <vnet/vnet.h>
+
+#define VNET_HW_IF_RX_REBALANCE_N_DECISIONS 64
+
+typedef struct
+{
+  /* unix time */
+  f64 time;
+  u32 hw_if_index;
+  u32 queue_id;
+  clib_thread_index_t from_thread_index;
+  clib_thread_index_t to_thread_index;
+  f64 queue_pps;
+  f64 from_vector_rate;
+  f64 to_vector_rate;
+} vnet_hw_if_rx_rebalance_decision_t;
+
+typedef struct
+{
+  /* rx packets of the interface on the queue's thread at the last sample */
+  u64 last_packets;
+  clib_thread_index_t last_thread_index;
+  f64 pps;
+  f64 last_move_time;
+} vnet_hw_if_rx_rebalance_queue_t;
+
+typedef struct
+{
+  u64 last_vectors;
+  u64 last_calls;
+  f64 vector_rate;
+  f64 pps;
+  u32 n_queues;
+} vnet_hw_if_rx_rebalance_thread_t;
+
+typedef struct
+{
+  u8 is_enabled;
+
+  /* configuration */
+  f64 interval;
+  f64 hold_down;
+  u32 threshold;
+  u32 n_samples;
+
+  /* busy samples in a row */
+  u32 n_busy;
+
+  f64 last_sample_time;
+  vnet_hw_if_rx_rebalance_queue_t *queues; /* by queue index */
+  vnet_hw_if_rx_rebalance_thread_t *threads;
+
+  /* the last moves, oldest at next_decision once the ring is full */
+  vnet_hw_if_rx_rebalance_decision_t *decisions;
+  u32 next_decision;
+  u64 n_moves;
+
+  u32 node_index;
+} vnet_hw_if_rx_rebalance_main_t;
+
+extern vnet_hw_if_rx_rebalance_main_t vnet_hw_if_rx_rebalance_main;
+
+/* Zero values leave the current setting unchanged. */
+void vnet_hw_if_rx_rebalance_enable_disable (vlib_main_t *vm, int enable,
+					     f64 interval, f64 hold_down,
+					     u32 threshold, u32 n_samples);
+
+/* Call fn on the recorded decisions, oldest first. */
+typedef void (vnet_hw_if_rx_rebalance_decision_cb_t) (
+  vnet_hw_if_rx_rebalance_decision_t *d, void *ctx);
+void vnet_hw_if_rx_rebalance_decision_walk (
+  vnet_hw_if_rx_rebalance_decision_cb_t *fn, void *ctx);
+
+format_function_t format_vnet_hw_if_rx_rebalance_decision;
+
+#endif /* included_vnet_interface_rx_rebalance_h */
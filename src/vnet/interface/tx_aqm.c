@@ -0,0 +1,267 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+/*
+ * Active queue management of tx queues.
+ *
+ * Packets do not wait in software on their way to a tx queue, they wait
+ * in the queue itself, where VPP cannot timestamp them. The sojourn time
+ * a packet is about to see is estimated from what the driver last said
+ * of the queue, as the descriptors in use times the time the link takes
+ * to send a packet of its size, and the AQM of the queue decides whether
+ * to send it, as it would for a packet leaving a software queue after
+ * that long. FQ-CoDel flows are those of the interface's tx hash.
+ *
+ * Each thread sending to a queue runs its own AQM state.
+ */
+
+#include <vnet/vnet.h>
+#include <vlib/aqm.h>
+#include <vnet/feature/feature.h>
+#include <vnet/interface/tx_queue_funcs.h>
+
+typedef struct
+{
+  u32 sw_if_index;
+  u32 queue_id;
+  u32 sojourn_us;
+  u8 dropped;
+} interface_tx_aqm_trace_t;
+
+static u8 *
+format_interface_tx_aqm_trace (u8 *s, va_list *args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  interface_tx_aqm_trace_t *t = va_arg (*args, interface_tx_aqm_trace_t *);
+
+  if (t->queue_id == ~0)
+    return format (s, "sw_if_index %u: no aqm", t->sw_if_index);
+
+  return format (s, "sw_if_index %u queue %u: sojourn %uus%s", t->sw_if_index,
+		 t->queue_id, t->sojourn_us, t->dropped ? " dropped" : "");
+}
+
+#define foreach_interface_tx_aqm_error _ (DROP, "aqm drops")
+
+typedef enum
+{
+#define _(sym, str) INTERFACE_TX_AQM_ERROR_##sym,
+  foreach_interface_tx_aqm_error
+#undef _
+    INTERFACE_TX_AQM_N_ERROR,
+} interface_tx_aqm_error_t;
+
+static char *interface_tx_aqm_error_strings[] = {
+#define _(sym, string) string,
+  foreach_interface_tx_aqm_error
+#undef _
+};
+
+typedef enum
+{
+  INTERFACE_TX_AQM_NEXT_DROP,
+  INTERFACE_TX_AQM_N_NEXT,
+} interface_tx_aqm_next_t;
+
+/* Clocks the queue takes to send what it holds, in packets of n_bytes. */
+static_always_inline u64
+interface_tx_aqm_sojourn (vnet_hw_if_tx_queue_t *txq, f64 clocks_per_byte,
+			  u32 n_bytes)
+{
+  if (txq->size == 0 || txq->n_free >= txq->size)
+    return 0;
+  return (txq->size - txq->n_free) * n_bytes * clocks_per_byte;
+}
+
+VLIB_NODE_FN (interface_tx_aqm_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
+  u16 nexts[VLIB_FRAME_SIZE], *next = nexts;
+  clib_thread_index_t thread_index = vm->thread_index;
+  vnet_hw_if_output_node_runtime_t *r = 0;
+  vnet_hw_if_tx_queue_t *txq = 0;
+  vnet_hw_interface_t *hi = 0;
+  u32 *from, i, n_drops = 0, sw_if_index, last_sw_if_index = ~0;
+  u32 queue_id, last_queue_id = ~0, hash, n_bytes;
+  u64 now = clib_cpu_time_now (), sojourn;
+  f64 clocks_per_byte = 0;
+  vlib_aqm_t *a;
+  void *p;
+  int drop;
+
+  from = vlib_frame_vector_args (frame);
+  vlib_get_buffers (vm, from, bufs, frame->n_vectors);
+
+  for (i = 0; i < frame->n_vectors; i++, b++, next++)
+    {
+      if (i + 4 < frame->n_vectors)
+	vlib_prefetch_buffer_header (b[4], LOAD);
+
+      vnet_feature_next_u16 (next, b[0]);
+      drop = 0;
+      sojourn = 0;
+      queue_id = ~0;
+
+      sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_TX];
+      if (PREDICT_FALSE (sw_if_index != last_sw_if_index))
+	{
+	  last_sw_if_index = sw_if_index;
+	  last_queue_id = ~0;
+	  txq = 0;
+	  hi = vnet_get_sup_hw_interface (vnm, sw_if_index);
+	  r = hi->output_node_thread_runtimes ?
+		vec_elt_at_index (hi->output_node_thread_runtimes,
+				  thread_index) :
+		0;
+	  clocks_per_byte =
+	    hi->link_speed && hi->link_speed != ~0 ?
+	      8 * vm->clib_time.clocks_per_second / (hi->link_speed * 1e3) :
+	      0;
+	}
+
+      if (PREDICT_FALSE (r == 0 || r->n_queues == 0))
+	goto trace;
+
+      /* the queue interface-output is going to pick */
+      hash = 0;
+      if (hi->hf)
+	{
+	  p = vlib_buffer_get_current (b[0]);
+	  hi->hf (&p, &hash, 1);
+	}
+      queue_id = r->n_queues == 1 ?
+		   r->frame[0].queue_id :
+		   r->lookup_table[hash & (vec_len (r->lookup_table) - 1)];
+
+      if (queue_id != last_queue_id)
+	{
+	  last_queue_id = queue_id;
+	  txq = vnet_hw_if_get_tx_queue (
+	    vnm, vnet_hw_if_get_tx_queue_index_by_id (vnm, hi->hw_if_index,
+						      queue_id));
+	}
+
+      if (txq == 0 || txq->aqm_index == ~0)
+	{
+	  queue_id = ~0;
+	  goto trace;
+	}
+
+      a = vlib_aqm_get (txq->aqm_index);
+      n_bytes = vlib_buffer_length_in_chain (vm, b[0]);
+      sojourn = interface_tx_aqm_sojourn (txq, clocks_per_byte, n_bytes);
+      drop = vlib_aqm_dequeue (a, thread_index, now, sojourn, hash);
+      vlib_aqm_count (a, thread_index, 1, sojourn, drop);
+
+      if (PREDICT_FALSE (drop))
+	{
+	  next[0] = INTERFACE_TX_AQM_NEXT_DROP;
+	  b[0]->error = node->errors[INTERFACE_TX_AQM_ERROR_DROP];
+	  n_drops++;
+	}
+
+    trace:
+      if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE) &&
+			 (b[0]->flags & VLIB_BUFFER_IS_TRACED)))
+	{
+	  interface_tx_aqm_trace_t *t =
+	    vlib_add_trace (vm, node, b[0], sizeof (*t));
+	  t->sw_if_index = sw_if_index;
+	  t->queue_id = queue_id;
+	  t->sojourn_us = sojourn * vm->clib_time.seconds_per_clock * 1e6;
+	  t->dropped = drop;
+	}
+    }
+
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+  vlib_node_increment_counter (vm, node->node_index,
+			       INTERFACE_TX_AQM_ERROR_DROP, n_drops);
+
+  return frame->n_vectors;
+}
+
+VLIB_REGISTER_NODE (interface_tx_aqm_node) = {
+  .name = "interface-tx-aqm",
+  .vector_size = sizeof (u32),
+  .format_trace = format_interface_tx_aqm_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .n_errors = ARRAY_LEN (interface_tx_aqm_error_strings),
+  .error_strings = interface_tx_aqm_error_strings,
+  .n_next_nodes = INTERFACE_TX_AQM_N_NEXT,
+  .next_nodes = {
+    [INTERFACE_TX_AQM_NEXT_DROP] = "error-drop",
+  },
+};
+
+/* last, so it sees what is actually sent */
+VNET_FEATURE_INIT (interface_tx_aqm, static) = {
+  .arc_name = "interface-output",
+  .node_name = "interface-tx-aqm",
+  .runs_after = VNET_FEATURES ("hqos-enqueue"),
+  .runs_before = VNET_FEATURES ("interface-output-arc-end"),
+};
+
+static clib_error_t *
+set_interface_tx_queue_aqm (vlib_main_t *vm, unformat_input_t *input,
+			    vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vnet_main_t *vnm = vnet_get_main ();
+  vlib_aqm_config_t c = { .type = VLIB_AQM_N_TYPES };
+  u32 hw_if_index = ~0, queue_id = 0, queue_index;
+  clib_error_t *error = 0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_hw_interface, vnm,
+		    &hw_if_index))
+	;
+      else if (unformat (line_input, "queue %u", &queue_id))
+	;
+      else if (unformat (line_input, "%U", unformat_vlib_aqm_config, &c))
+	;
+      else
+	{
+	  error = clib_error_return (0, "parse error: '%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (hw_if_index == ~0 || c.type == VLIB_AQM_N_TYPES)
+    {
+      error = clib_error_return (0, "expecting interface and aqm type");
+      goto done;
+    }
+
+  queue_index =
+    vnet_hw_if_get_tx_queue_index_by_id (vnm, hw_if_index, queue_id);
+  if (queue_index == ~0)
+    {
+      error = clib_error_return (
+	0, "unknown queue %u on interface %v", queue_id,
+	vnet_get_hw_interface (vnm, hw_if_index)->name);
+      goto done;
+    }
+
+  error = vnet_hw_if_tx_queue_set_aqm (vnm, queue_index, &c);
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+VLIB_CLI_COMMAND (cmd_set_if_tx_queue_aqm, static) = {
+  .path = "set interface tx-queue aqm",
+  .short_help = "set interface tx-queue aqm <interface> [queue <n>] "
+		"(off|codel|fq-codel|pie) [target <us>] [interval <us>] "
+		"[burst <us>] [alpha <f>] [beta <f>] [flows <n>]",
+  .function = set_interface_tx_queue_aqm,
+};
@@ -3,8 +3,10 @@
  */
 
 #include <vnet/vnet.h>
+#include <vlib/aqm.h>
 #include <vnet/devices/devices.h>
 #include <vnet/interface/tx_queue_funcs.h>
+#include <vnet/feature/feature.h>
 #include <vlib/unix/unix.h>
 
 VLIB_REGISTER_LOG_CLASS (if_txq_log, static) = {
@@ -52,12 +54,47 @@ vnet_hw_if_register_tx_queue (vnet_main_t *vnm, u32 hw_if_index, u32 queue_id)
 		      queue_index);
   txq->hw_if_index = hw_if_index;
   txq->queue_id = queue_id;
+  txq->n_free = ~0;
+  txq->aqm_index = ~0;
 
   log_debug ("register: interface %v queue-id %u", hi->name, queue_id);
 
   return queue_index;
 }
 
+/* The interface-tx-aqm feature runs while any queue of the interface has
+ * AQM. */
+static void
+tx_queue_aqm_feature_update (vnet_main_t *vnm, u32 hw_if_index)
+{
+  vnet_hw_interface_t *hi = vnet_get_hw_interface (vnm, hw_if_index);
+  vnet_hw_if_tx_queue_t *txq;
+  int enable = 0;
+
+  for (int i = 0; i < vec_len (hi->tx_queue_indices); i++)
+    {
+      txq = vnet_hw_if_get_tx_queue (vnm, hi->tx_queue_indices[i]);
+      enable |= txq->aqm_index != ~0;
+    }
+
+  if (enable != vnet_feature_is_enabled ("interface-output",
+					 "interface-tx-aqm", hi->sw_if_index))
+    vnet_feature_enable_disable ("interface-output", "interface-tx-aqm",
+				 hi->sw_if_index, enable, 0, 0);
+}
+
+static void
+tx_queue_aqm_free (vnet_hw_if_tx_queue_t *txq)
+{
+  u32 aqm_index = txq->aqm_index;
+
+  if (aqm_index == ~0)
+    return;
+
+  txq->aqm_index = ~0;
+  vlib_aqm_delete (aqm_index);
+}
+
 void
 vnet_hw_if_unregister_tx_queue (vnet_main_t *vnm, u32 queue_index)
 {
@@ -78,6 +115,11 @@ vnet_hw_if_unregister_tx_queue (vnet_main_t *vnm, u32 queue_index)
       }
 
   log_debug ("unregister: interface %v queue-id %u", hi->name, txq->queue_id);
+  if (txq->aqm_index != ~0)
+    {
+      tx_queue_aqm_free (txq);
+      tx_queue_aqm_feature_update (vnm, txq->hw_if_index);
+    }
   clib_bitmap_free (txq->threads);
   pool_put_index (im->hw_if_tx_queues, queue_index);
 }
@@ -88,6 +130,7 @@ vnet_hw_if_unregister_all_tx_queues (vnet_main_t *vnm, u32 hw_if_index)
   vnet_hw_interface_t *hi = vnet_get_hw_interface (vnm, hw_if_index);
   vnet_interface_main_t *im = &vnm->interface_main;
   vnet_hw_if_tx_queue_t *txq;
+  int had_aqm = 0;
   u64 key;
 
   log_debug ("unregister_all: interface %v", hi->name);
@@ -98,11 +141,16 @@ vnet_hw_if_unregister_all_tx_queues (vnet_main_t *vnm, u32 hw_if_index)
       key = tx_queue_key (txq->hw_if_index, txq->queue_id);
       hash_unset_mem_free (&im->txq_index_by_hw_if_index_and_queue_id, &key);
 
+      had_aqm |= txq->aqm_index != ~0;
+      tx_queue_aqm_free (txq);
       clib_bitmap_free (txq->threads);
       pool_put_index (im->hw_if_tx_queues, hi->tx_queue_indices[i]);
     }
 
   vec_free (hi->tx_queue_indices);
+
+  if (had_aqm)
+    tx_queue_aqm_feature_update (vnm, hw_if_index);
 }
 
 void
@@ -134,3 +182,46 @@ vnet_hw_if_tx_queue_unassign_thread (vnet_main_t *vnm, u32 queue_index,
     hi->name, txq->queue_id, thread_index,
     (txq->shared_queue == 1 ? "yes" : "no"));
 }
+
+/*
+ * Drop packets sent to a tx queue once it holds a standing queue. Only
+ * the driver knows how full the queue is, so without size and n_free
+ * from it the queue never looks congested.
+ */
+clib_error_t *
+vnet_hw_if_tx_queue_set_aqm (vnet_main_t *vnm, u32 queue_index,
+			     const vlib_aqm_config_t *c)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  vnet_hw_if_tx_queue_t *txq = vnet_hw_if_get_tx_queue (vnm, queue_index);
+  vnet_hw_interface_t *hi;
+  u32 aqm_index = ~0, old_aqm_index;
+  clib_error_t *error;
+
+  if (txq == 0)
+    return clib_error_return (0, "unknown tx queue %u", queue_index);
+
+  hi = vnet_get_hw_interface (vnm, txq->hw_if_index);
+
+  if (c->type != VLIB_AQM_NONE)
+    {
+      error = vlib_aqm_create (c, &aqm_index, "tx/%v/%u", hi->name,
+			       txq->queue_id);
+      if (error)
+	return error;
+    }
+
+  vlib_worker_thread_barrier_sync (vm);
+  old_aqm_index = txq->aqm_index;
+  txq->aqm_index = aqm_index;
+  vlib_worker_thread_barrier_release (vm);
+
+  if (old_aqm_index != ~0)
+    vlib_aqm_delete (old_aqm_index);
+
+  tx_queue_aqm_feature_update (vnm, txq->hw_if_index);
+
+  log_debug ("aqm: interface %v queue-id %u %U", hi->name, txq->queue_id,
+	     format_vlib_aqm_type, c->type);
+  return 0;
+}
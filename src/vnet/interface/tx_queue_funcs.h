@@ -16,6 +16,8 @@ void vnet_hw_if_tx_queue_assign_thread (vnet_main_t *vnm, u32 queue_index,
 					clib_thread_index_t thread_index);
 void vnet_hw_if_tx_queue_unassign_thread (vnet_main_t *vnm, u32 queue_index,
 					  clib_thread_index_t thread_index);
+clib_error_t *vnet_hw_if_tx_queue_set_aqm (vnet_main_t *vnm, u32 queue_index,
+					   const struct vlib_aqm_config_t *c);
 
 /* inline functions */
 
@@ -28,6 +30,24 @@ vnet_hw_if_get_tx_queue (vnet_main_t *vnm, u32 queue_index)
   return pool_elt_at_index (im->hw_if_tx_queues, queue_index);
 }
 
+/* Drivers may tell how much room is left in a tx queue, for nodes pacing
+ * what they send to it. */
+static_always_inline void
+vnet_hw_if_tx_queue_set_n_free (vnet_main_t *vnm, u32 queue_index, u32 n_free)
+{
+  vnet_interface_main_t *im = &vnm->interface_main;
+  im->hw_if_tx_queues[queue_index].n_free = n_free;
+}
+
+/* Drivers may tell the number of descriptors of a tx queue, which with
+ * n_free gives how much is waiting in it. */
+static_always_inline void
+vnet_hw_if_tx_queue_set_size (vnet_main_t *vnm, u32 queue_index, u32 size)
+{
+  vnet_interface_main_t *im = &vnm->interface_main;
+  im->hw_if_tx_queues[queue_index].size = size;
+}
+
 static_always_inline int
 vnet_hw_if_txq_cmp_cli_api (vnet_hw_if_tx_queue_t **a,
 			    vnet_hw_if_tx_queue_t **b)
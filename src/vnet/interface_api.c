@@ -26,6 +26,8 @@
 #include <vnet/interface.h>
 #include <vnet/interface/rx_queue_funcs.h>
 #include <vnet/interface/tx_queue_funcs.h>
+#include <vnet/interface/rx_rebalance.h>
+#include <vnet/devices/devices.h>
 #include <vnet/api_errno.h>
 #include <vnet/ethernet/ethernet.h>
 #include <vnet/ip/ip.h>
@@ -63,6 +65,9 @@ vpe_api_main_t vpe_api_main;
   _ (SW_INTERFACE_TX_PLACEMENT_GET, sw_interface_tx_placement_get)            \
   _ (SW_INTERFACE_SET_RX_PLACEMENT, sw_interface_set_rx_placement)            \
   _ (SW_INTERFACE_SET_TX_PLACEMENT, sw_interface_set_tx_placement)            \
+  _ (SW_INTERFACE_RX_REBALANCE_ENABLE_DISABLE,                                \
+     sw_interface_rx_rebalance_enable_disable)                                \
+  _ (SW_INTERFACE_RX_REBALANCE_DUMP, sw_interface_rx_rebalance_dump)          \
   _ (SW_INTERFACE_SET_TABLE, sw_interface_set_table)                          \
   _ (SW_INTERFACE_GET_TABLE, sw_interface_get_table)                          \
   _ (SW_INTERFACE_SET_UNNUMBERED, sw_interface_set_unnumbered)                \
@@ -1207,6 +1212,75 @@ out:
   REPLY_MACRO (VL_API_SW_INTERFACE_SET_RX_PLACEMENT_REPLY);
 }
 
+static void
+vl_api_sw_interface_rx_rebalance_enable_disable_t_handler (
+  vl_api_sw_interface_rx_rebalance_enable_disable_t *mp)
+{
+  vl_api_sw_interface_rx_rebalance_enable_disable_reply_t *rmp;
+  int rv = 0;
+
+  if (mp->threshold > VLIB_FRAME_SIZE || mp->interval < 0 ||
+      mp->hold_down < 0)
+    rv = VNET_API_ERROR_INVALID_VALUE;
+  else
+    vnet_hw_if_rx_rebalance_enable_disable (
+      vlib_get_main (), mp->enable, mp->interval, mp->hold_down,
+      mp->threshold, mp->n_samples);
+
+  REPLY_MACRO_END (VL_API_SW_INTERFACE_RX_REBALANCE_ENABLE_DISABLE_REPLY);
+}
+
+typedef struct
+{
+  vl_api_registration_t *reg;
+  u32 context;
+} rx_rebalance_dump_ctx_t;
+
+static void
+send_interface_rx_rebalance_details (vnet_hw_if_rx_rebalance_decision_t *d,
+				     void *arg)
+{
+  rx_rebalance_dump_ctx_t *ctx = arg;
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_device_main_t *vdm = &vnet_device_main;
+  vl_api_sw_interface_rx_rebalance_details_t *rmp;
+  vl_api_registration_t *rp = ctx->reg;
+  u32 context = ctx->context;
+  vnet_hw_interface_t *hi;
+
+  /* the interface may be gone */
+  if (pool_is_free_index (vnm->interface_main.hw_interfaces, d->hw_if_index))
+    return;
+  hi = vnet_get_hw_interface (vnm, d->hw_if_index);
+
+  REPLY_MACRO_DETAILS4_END (
+    VL_API_SW_INTERFACE_RX_REBALANCE_DETAILS, rp, context, ({
+      rmp->timestamp = d->time;
+      rmp->sw_if_index = hi->sw_if_index;
+      rmp->queue_id = d->queue_id;
+      rmp->from_worker_id =
+	d->from_thread_index - vdm->first_worker_thread_index;
+      rmp->to_worker_id = d->to_thread_index - vdm->first_worker_thread_index;
+      rmp->queue_pps = d->queue_pps;
+      rmp->from_vector_rate = d->from_vector_rate;
+      rmp->to_vector_rate = d->to_vector_rate;
+    }));
+}
+
+static void
+vl_api_sw_interface_rx_rebalance_dump_t_handler (
+  vl_api_sw_interface_rx_rebalance_dump_t *mp)
+{
+  rx_rebalance_dump_ctx_t ctx = { .context = mp->context };
+
+  ctx.reg = vl_api_client_index_to_registration (mp->client_index);
+  if (!ctx.reg)
+    return;
+
+  vnet_hw_if_rx_rebalance_decision_walk (send_interface_rx_rebalance_details,
+					 &ctx);
+}
+
 static void
 send_interface_tx_placement_details (vnet_hw_if_tx_queue_t **all_queues,
 				     u32 index, vl_api_registration_t *rp,
@@ -38,6 +38,7 @@
  */
 
 #include <vnet/vnet.h>
+#include <vlib/aqm.h>
 #include <vppinfra/bitmap.h>
 #include <vnet/l2/l2_input.h>
 #include <vnet/l2/l2_output.h>
@@ -223,6 +224,9 @@ format_vnet_hw_interface (u8 * s, va_list * args)
 	    s, "\n%U%-6u%-7s%U", format_white_space, indent + 4, txq->queue_id,
 	    clib_bitmap_count_set_bits (txq->threads) > 1 ? "yes" : "no",
 	    format_bitmap_list, txq->threads);
+	  if (txq->aqm_index != ~0)
+	    s = format (s, "\n%Uaqm %U", format_white_space, indent + 6,
+			format_vlib_aqm, txq->aqm_index);
 	}
     }
 
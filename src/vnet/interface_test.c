@@ -901,6 +901,24 @@ vl_api_sw_interface_rx_placement_details_t_handler (
 			   ((mp->mode == 2) ? "interrupt" : "adaptive"));
 }
 
+static int
+api_sw_interface_rx_rebalance_enable_disable (vat_main_t *vam)
+{
+  return -1;
+}
+
+static int
+api_sw_interface_rx_rebalance_dump (vat_main_t *vam)
+{
+  return -1;
+}
+
+static void
+vl_api_sw_interface_rx_rebalance_details_t_handler (
+  vl_api_sw_interface_rx_rebalance_details_t *mp)
+{
+}
+
 static __clib_unused void
 vl_api_sw_interface_tx_placement_details_t_handler (
   vl_api_sw_interface_tx_placement_details_t *mp)
@@ -69,12 +69,42 @@ ip4_lookup_inline (vlib_main_t * vm,
   next = nexts;
   vlib_get_buffers (vm, from, bufs, n_left);
 
+#if defined(VPP_IP_FIB_MTRIE_24)
+  /*
+   * With the DIR-24-8 trie the lookups for the whole frame are done up
+   * front, so they can be batched with gathers; the loops below then
+   * only resolve the load-balance.
+   */
+  const ip4_address_t *dst_addrs[VLIB_FRAME_SIZE];
+  u32 fib_indices[VLIB_FRAME_SIZE];
+  index_t lb_indices[VLIB_FRAME_SIZE], *lbi = lb_indices;
+  u32 i;
+
+  for (i = 0; i < n_left; i++)
+    {
+      ip4_header_t *ip;
+
+      if (i + 4 < n_left)
+	{
+	  vlib_prefetch_buffer_header (b[i + 4], LOAD);
+	  CLIB_PREFETCH (b[i + 4]->data, sizeof (ip[0]), LOAD);
+	}
+
+      ip = vlib_buffer_get_current (b[i]);
+      ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, b[i]);
+      fib_indices[i] = vnet_buffer (b[i])->ip.fib_index;
+      dst_addrs[i] = &ip->dst_address;
+    }
+
+  ip4_fib_forwarding_lookup_frame (fib_indices, dst_addrs, lb_indices,
+				   n_left);
+#endif
+
 #if (CLIB_N_PREFETCHES >= 8)
   while (n_left >= 4)
     {
       ip4_header_t *ip0, *ip1, *ip2, *ip3;
       const load_balance_t *lb0, *lb1, *lb2, *lb3;
-      ip4_address_t *dst_addr0, *dst_addr1, *dst_addr2, *dst_addr3;
       u32 lb_index0, lb_index1, lb_index2, lb_index3;
       flow_hash_config_t flow_hash_config0, flow_hash_config1;
       flow_hash_config_t flow_hash_config2, flow_hash_config3;
@@ -100,6 +130,15 @@ ip4_lookup_inline (vlib_main_t * vm,
       ip2 = vlib_buffer_get_current (b[2]);
       ip3 = vlib_buffer_get_current (b[3]);
 
+#if defined(VPP_IP_FIB_MTRIE_24)
+      lb_index0 = lbi[0];
+      lb_index1 = lbi[1];
+      lb_index2 = lbi[2];
+      lb_index3 = lbi[3];
+      lbi += 4;
+#else
+      ip4_address_t *dst_addr0, *dst_addr1, *dst_addr2, *dst_addr3;
+
       dst_addr0 = &ip0->dst_address;
       dst_addr1 = &ip1->dst_address;
       dst_addr2 = &ip2->dst_address;
@@ -115,6 +154,7 @@ ip4_lookup_inline (vlib_main_t * vm,
 	vnet_buffer (b[2])->ip.fib_index, vnet_buffer (b[3])->ip.fib_index,
 	dst_addr0, dst_addr1, dst_addr2, dst_addr3, &lb_index0, &lb_index1,
 	&lb_index2, &lb_index3);
+#endif
 
       ASSERT (lb_index0 && lb_index1 && lb_index2 && lb_index3);
       lb0 = load_balance_get (lb_index0);
@@ -224,7 +264,6 @@ ip4_lookup_inline (vlib_main_t * vm,
     {
       ip4_header_t *ip0, *ip1;
       const load_balance_t *lb0, *lb1;
-      ip4_address_t *dst_addr0, *dst_addr1;
       u32 lb_index0, lb_index1;
       flow_hash_config_t flow_hash_config0, flow_hash_config1;
       u32 hash_c0, hash_c1;
@@ -242,6 +281,13 @@ ip4_lookup_inline (vlib_main_t * vm,
       ip0 = vlib_buffer_get_current (b[0]);
       ip1 = vlib_buffer_get_current (b[1]);
 
+#if defined(VPP_IP_FIB_MTRIE_24)
+      lb_index0 = lbi[0];
+      lb_index1 = lbi[1];
+      lbi += 2;
+#else
+      ip4_address_t *dst_addr0, *dst_addr1;
+
       dst_addr0 = &ip0->dst_address;
       dst_addr1 = &ip1->dst_address;
 
@@ -251,6 +297,7 @@ ip4_lookup_inline (vlib_main_t * vm,
       ip4_fib_forwarding_lookup_x2 (
 	vnet_buffer (b[0])->ip.fib_index, vnet_buffer (b[1])->ip.fib_index,
 	dst_addr0, dst_addr1, &lb_index0, &lb_index1);
+#endif
 
       ASSERT (lb_index0 && lb_index1);
       lb0 = load_balance_get (lb_index0);
@@ -314,18 +361,24 @@ ip4_lookup_inline (vlib_main_t * vm,
     {
       ip4_header_t *ip0;
       const load_balance_t *lb0;
-      ip4_address_t *dst_addr0;
       u32 lbi0;
       flow_hash_config_t flow_hash_config0;
       const dpo_id_t *dpo0;
       u32 hash_c0;
 
       ip0 = vlib_buffer_get_current (b[0]);
+#if defined(VPP_IP_FIB_MTRIE_24)
+      lbi0 = lbi[0];
+      lbi += 1;
+#else
+      ip4_address_t *dst_addr0;
+
       dst_addr0 = &ip0->dst_address;
       ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, b[0]);
 
       lbi0 = ip4_fib_forwarding_lookup (vnet_buffer (b[0])->ip.fib_index,
 					dst_addr0);
+#endif
 
       ASSERT (lbi0);
       lb0 = load_balance_get (lbi0);
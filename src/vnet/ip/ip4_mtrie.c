@@ -47,62 +47,6 @@
  */
 ip4_mtrie_8_ply_t *ip4_ply_pool;
 
-always_inline u32
-ip4_mtrie_leaf_is_non_empty (ip4_mtrie_8_ply_t *p, u8 dst_byte)
-{
-  /*
-   * It's 'non-empty' if the length of the leaf stored is greater than the
-   * length of a leaf in the covering ply. i.e. the leaf is more specific
-   * than it's would be cover in the covering ply
-   */
-  if (p->dst_address_bits_of_leaves[dst_byte] > p->dst_address_bits_base)
-    return (1);
-  return (0);
-}
-
-always_inline ip4_mtrie_leaf_t
-ip4_mtrie_leaf_set_adj_index (u32 adj_index)
-{
-  ip4_mtrie_leaf_t l;
-  l = 1 + 2 * adj_index;
-  ASSERT (ip4_mtrie_leaf_get_adj_index (l) == adj_index);
-  return l;
-}
-
-always_inline u32
-ip4_mtrie_leaf_is_next_ply (ip4_mtrie_leaf_t n)
-{
-  return (n & 1) == 0;
-}
-
-always_inline u32
-ip4_mtrie_leaf_get_next_ply_index (ip4_mtrie_leaf_t n)
-{
-  ASSERT (ip4_mtrie_leaf_is_next_ply (n));
-  return n >> 1;
-}
-
-always_inline ip4_mtrie_leaf_t
-ip4_mtrie_leaf_set_next_ply_index (u32 i)
-{
-  ip4_mtrie_leaf_t l;
-  l = 0 + 2 * i;
-  ASSERT (ip4_mtrie_leaf_get_next_ply_index (l) == i);
-  return l;
-}
-
-static void
-ply_8_init (ip4_mtrie_8_ply_t *p, ip4_mtrie_leaf_t init, uword prefix_len,
-	    u32 ply_base_len)
-{
-  p->n_non_empty_leafs = prefix_len > ply_base_len ? ARRAY_LEN (p->leaves) : 0;
-  clib_memset_u8 (p->dst_address_bits_of_leaves, prefix_len,
-		  sizeof (p->dst_address_bits_of_leaves));
-  p->dst_address_bits_base = ply_base_len;
-
-  clib_memset_u32 (p->leaves, init, ARRAY_LEN (p->leaves));
-}
-
 static void
 ply_16_init (ip4_mtrie_16_ply_t *p, ip4_mtrie_leaf_t init, uword prefix_len)
 {
@@ -111,38 +55,6 @@ ply_16_init (ip4_mtrie_16_ply_t *p, ip4_mtrie_leaf_t init, uword prefix_len)
   clib_memset_u32 (p->leaves, init, ARRAY_LEN (p->leaves));
 }
 
-static ip4_mtrie_leaf_t
-ply_create (ip4_mtrie_leaf_t init_leaf, u32 leaf_prefix_len, u32 ply_base_len)
-{
-  ip4_mtrie_8_ply_t *p;
-  ip4_mtrie_leaf_t l;
-  u8 need_barrier_sync = pool_get_will_expand (ip4_ply_pool);
-  vlib_main_t *vm = vlib_get_main ();
-  ASSERT (vm->thread_index == 0);
-
-  if (need_barrier_sync)
-    vlib_worker_thread_barrier_sync (vm);
-
-  /* Get cache aligned ply. */
-  pool_get_aligned (ip4_ply_pool, p, CLIB_CACHE_LINE_BYTES);
-
-  ply_8_init (p, init_leaf, leaf_prefix_len, ply_base_len);
-  l = ip4_mtrie_leaf_set_next_ply_index (p - ip4_ply_pool);
-
-  if (need_barrier_sync)
-    vlib_worker_thread_barrier_release (vm);
-
-  return l;
-}
-
-always_inline ip4_mtrie_8_ply_t *
-get_next_ply_for_leaf (ip4_mtrie_leaf_t l)
-{
-  uword n = ip4_mtrie_leaf_get_next_ply_index (l);
-
-  return pool_elt_at_index (ip4_ply_pool, n);
-}
-
 void
 ip4_mtrie_16_free (ip4_mtrie_16_t *m)
 {
@@ -154,7 +66,7 @@ ip4_mtrie_16_free (ip4_mtrie_16_t *m)
   int i;
   for (i = 0; i < ARRAY_LEN (m->root_ply.leaves); i++)
     {
-      ASSERT (!ip4_mtrie_leaf_is_next_ply (m->root_ply.leaves[i]));
+      ASSERT (!ip_mtrie_leaf_is_next_ply (m->root_ply.leaves[i]));
     }
 #endif
 }
@@ -178,7 +90,7 @@ ip4_mtrie_8_free (ip4_mtrie_8_t *m)
   int i;
   for (i = 0; i < ARRAY_LEN (root->leaves); i++)
     {
-      ASSERT (!ip4_mtrie_leaf_is_next_ply (root->leaves[i]));
+      ASSERT (!ip_mtrie_leaf_is_next_ply (root->leaves[i]));
     }
 #endif
 
@@ -193,435 +105,93 @@ ip4_mtrie_8_init (ip4_mtrie_8_t *m)
   pool_get_aligned (ip4_ply_pool, root, CLIB_CACHE_LINE_BYTES);
   m->root_ply = root - ip4_ply_pool;
 
-  ply_8_init (root, IP4_MTRIE_LEAF_EMPTY, 0, 0);
-}
-
-typedef struct
-{
-  ip4_address_t dst_address;
-  u32 dst_address_length;
-  u32 adj_index;
-  u32 cover_address_length;
-  u32 cover_adj_index;
-} ip4_mtrie_set_unset_leaf_args_t;
-
-static void
-set_ply_with_more_specific_leaf (ip4_mtrie_8_ply_t *ply,
-				 ip4_mtrie_leaf_t new_leaf,
-				 uword new_leaf_dst_address_bits)
-{
-  ip4_mtrie_leaf_t old_leaf;
-  uword i;
-
-  ASSERT (ip4_mtrie_leaf_is_terminal (new_leaf));
-
-  for (i = 0; i < ARRAY_LEN (ply->leaves); i++)
-    {
-      old_leaf = ply->leaves[i];
-
-      /* Recurse into sub plies. */
-      if (!ip4_mtrie_leaf_is_terminal (old_leaf))
-	{
-	  ip4_mtrie_8_ply_t *sub_ply = get_next_ply_for_leaf (old_leaf);
-	  set_ply_with_more_specific_leaf (sub_ply, new_leaf,
-					   new_leaf_dst_address_bits);
-	}
-
-      /* Replace less specific terminal leaves with new leaf. */
-      else if (new_leaf_dst_address_bits >=
-	       ply->dst_address_bits_of_leaves[i])
-	{
-	  clib_atomic_store_rel_n (&ply->leaves[i], new_leaf);
-	  ply->dst_address_bits_of_leaves[i] = new_leaf_dst_address_bits;
-	  ply->n_non_empty_leafs += ip4_mtrie_leaf_is_non_empty (ply, i);
-	}
-    }
+  ip_mtrie_ply_8_init (root, IP4_MTRIE_LEAF_EMPTY, 0, 0);
 }
 
-static void
-set_leaf (const ip4_mtrie_set_unset_leaf_args_t *a, u32 old_ply_index,
-	  u32 dst_address_byte_index)
-{
-  ip4_mtrie_leaf_t old_leaf, new_leaf;
-  i32 n_dst_bits_next_plies;
-  u8 dst_byte;
-  ip4_mtrie_8_ply_t *old_ply;
-
-  old_ply = pool_elt_at_index (ip4_ply_pool, old_ply_index);
-
-  ASSERT (a->dst_address_length <= 32);
-  ASSERT (dst_address_byte_index < ARRAY_LEN (a->dst_address.as_u8));
-
-  /* how many bits of the destination address are in the next PLY */
-  n_dst_bits_next_plies =
-    a->dst_address_length - BITS (u8) * (dst_address_byte_index + 1);
-
-  dst_byte = a->dst_address.as_u8[dst_address_byte_index];
-
-  /* Number of bits next plies <= 0 => insert leaves this ply. */
-  if (n_dst_bits_next_plies <= 0)
-    {
-      /* The mask length of the address to insert maps to this ply */
-      uword old_leaf_is_terminal;
-      u32 i, n_dst_bits_this_ply;
-
-      /* The number of bits, and hence slots/buckets, we will fill */
-      n_dst_bits_this_ply = clib_min (8, -n_dst_bits_next_plies);
-      ASSERT ((a->dst_address.as_u8[dst_address_byte_index] &
-	       pow2_mask (n_dst_bits_this_ply)) == 0);
-
-      /* Starting at the value of the byte at this section of the v4 address
-       * fill the buckets/slots of the ply */
-      for (i = dst_byte; i < dst_byte + (1 << n_dst_bits_this_ply); i++)
-	{
-	  ip4_mtrie_8_ply_t *new_ply;
-
-	  old_leaf = old_ply->leaves[i];
-	  old_leaf_is_terminal = ip4_mtrie_leaf_is_terminal (old_leaf);
-
-	  if (a->dst_address_length >= old_ply->dst_address_bits_of_leaves[i])
-	    {
-	      /* The new leaf is more or equally specific than the one currently
-	       * occupying the slot */
-	      new_leaf = ip4_mtrie_leaf_set_adj_index (a->adj_index);
-
-	      if (old_leaf_is_terminal)
-		{
-		  /* The current leaf is terminal, we can replace it with
-		   * the new one */
-		  old_ply->n_non_empty_leafs -=
-		    ip4_mtrie_leaf_is_non_empty (old_ply, i);
-
-		  old_ply->dst_address_bits_of_leaves[i] =
-		    a->dst_address_length;
-		  clib_atomic_store_rel_n (&old_ply->leaves[i], new_leaf);
-
-		  old_ply->n_non_empty_leafs +=
-		    ip4_mtrie_leaf_is_non_empty (old_ply, i);
-		  ASSERT (old_ply->n_non_empty_leafs <=
-			  ARRAY_LEN (old_ply->leaves));
-		}
-	      else
-		{
-		  /* Existing leaf points to another ply.  We need to place
-		   * new_leaf into all more specific slots. */
-		  new_ply = get_next_ply_for_leaf (old_leaf);
-		  set_ply_with_more_specific_leaf (new_ply, new_leaf,
-						   a->dst_address_length);
-		}
-	    }
-	  else if (!old_leaf_is_terminal)
-	    {
-	      /* The current leaf is less specific and not termial (i.e. a ply),
-	       * recurse on down the trie */
-	      new_ply = get_next_ply_for_leaf (old_leaf);
-	      set_leaf (a, new_ply - ip4_ply_pool, dst_address_byte_index + 1);
-	    }
-	  /*
-	   * else
-	   *  the route we are adding is less specific than the leaf currently
-	   *  occupying this slot. leave it there
-	   */
-	}
-    }
-  else
-    {
-      /* The address to insert requires us to move down at a lower level of
-       * the trie - recurse on down */
-      ip4_mtrie_8_ply_t *new_ply;
-      u8 ply_base_len;
-
-      ply_base_len = 8 * (dst_address_byte_index + 1);
-
-      old_leaf = old_ply->leaves[dst_byte];
-
-      if (ip4_mtrie_leaf_is_terminal (old_leaf))
-	{
-	  /* There is a leaf occupying the slot. Replace it with a new ply */
-	  old_ply->n_non_empty_leafs -=
-	    ip4_mtrie_leaf_is_non_empty (old_ply, dst_byte);
-
-	  new_leaf = ply_create (old_leaf,
-				 old_ply->dst_address_bits_of_leaves[dst_byte],
-				 ply_base_len);
-	  new_ply = get_next_ply_for_leaf (new_leaf);
-
-	  /* Refetch since ply_create may move pool. */
-	  old_ply = pool_elt_at_index (ip4_ply_pool, old_ply_index);
-
-	  clib_atomic_store_rel_n (&old_ply->leaves[dst_byte], new_leaf);
-	  old_ply->dst_address_bits_of_leaves[dst_byte] = ply_base_len;
-
-	  old_ply->n_non_empty_leafs +=
-	    ip4_mtrie_leaf_is_non_empty (old_ply, dst_byte);
-	  ASSERT (old_ply->n_non_empty_leafs >= 0);
-	}
-      else
-	new_ply = get_next_ply_for_leaf (old_leaf);
-
-      set_leaf (a, new_ply - ip4_ply_pool, dst_address_byte_index + 1);
-    }
-}
-
-static void
-set_root_leaf (ip4_mtrie_16_t *m, const ip4_mtrie_set_unset_leaf_args_t *a)
+void
+ip4_mtrie_24_free (ip4_mtrie_24_t *m)
 {
-  ip4_mtrie_leaf_t old_leaf, new_leaf;
-  ip4_mtrie_16_ply_t *old_ply;
-  i32 n_dst_bits_next_plies;
-  u16 dst_byte;
-
-  old_ply = &m->root_ply;
-
-  ASSERT (a->dst_address_length <= 32);
-
-  /* how many bits of the destination address are in the next PLY */
-  n_dst_bits_next_plies = a->dst_address_length - BITS (u16);
-
-  dst_byte = a->dst_address.as_u16[0];
-
-  /* Number of bits next plies <= 0 => insert leaves this ply. */
-  if (n_dst_bits_next_plies <= 0)
+  /* the assumption being that the IP4 FIB table has emptied the trie
+   * before deletion, so there are no plys to return to the pool.
+   */
+#if CLIB_DEBUG > 0
+  int i;
+  for (i = 0; i < PLY_24_SIZE; i++)
     {
-      /* The mask length of the address to insert maps to this ply */
-      uword old_leaf_is_terminal;
-      u32 i, n_dst_bits_this_ply;
-
-      /* The number of bits, and hence slots/buckets, we will fill */
-      n_dst_bits_this_ply = 16 - a->dst_address_length;
-      ASSERT ((clib_host_to_net_u16 (a->dst_address.as_u16[0]) &
-	       pow2_mask (n_dst_bits_this_ply)) == 0);
-
-      /* Starting at the value of the byte at this section of the v4 address
-       * fill the buckets/slots of the ply */
-      for (i = 0; i < (1 << n_dst_bits_this_ply); i++)
-	{
-	  ip4_mtrie_8_ply_t *new_ply;
-	  u16 slot;
-
-	  slot = clib_net_to_host_u16 (dst_byte);
-	  slot += i;
-	  slot = clib_host_to_net_u16 (slot);
-
-	  old_leaf = old_ply->leaves[slot];
-	  old_leaf_is_terminal = ip4_mtrie_leaf_is_terminal (old_leaf);
-
-	  if (a->dst_address_length >=
-	      old_ply->dst_address_bits_of_leaves[slot])
-	    {
-	      /* The new leaf is more or equally specific than the one currently
-	       * occupying the slot */
-	      new_leaf = ip4_mtrie_leaf_set_adj_index (a->adj_index);
-
-	      if (old_leaf_is_terminal)
-		{
-		  /* The current leaf is terminal, we can replace it with
-		   * the new one */
-		  old_ply->dst_address_bits_of_leaves[slot] =
-		    a->dst_address_length;
-		  clib_atomic_store_rel_n (&old_ply->leaves[slot], new_leaf);
-		}
-	      else
-		{
-		  /* Existing leaf points to another ply.  We need to place
-		   * new_leaf into all more specific slots. */
-		  new_ply = get_next_ply_for_leaf (old_leaf);
-		  set_ply_with_more_specific_leaf (new_ply, new_leaf,
-						   a->dst_address_length);
-		}
-	    }
-	  else if (!old_leaf_is_terminal)
-	    {
-	      /* The current leaf is less specific and not termial (i.e. a ply),
-	       * recurse on down the trie */
-	      new_ply = get_next_ply_for_leaf (old_leaf);
-	      set_leaf (a, new_ply - ip4_ply_pool, 2);
-	    }
-	  /*
-	   * else
-	   *  the route we are adding is less specific than the leaf currently
-	   *  occupying this slot. leave it there
-	   */
-	}
+      ASSERT (!ip_mtrie_leaf_is_next_ply (m->root_ply.leaves[i]));
     }
-  else
-    {
-      /* The address to insert requires us to move down at a lower level of
-       * the trie - recurse on down */
-      ip4_mtrie_8_ply_t *new_ply;
-      u8 ply_base_len;
-
-      ply_base_len = 16;
-
-      old_leaf = old_ply->leaves[dst_byte];
-
-      if (ip4_mtrie_leaf_is_terminal (old_leaf))
-	{
-	  /* There is a leaf occupying the slot. Replace it with a new ply */
-	  new_leaf = ply_create (old_leaf,
-				 old_ply->dst_address_bits_of_leaves[dst_byte],
-				 ply_base_len);
-	  new_ply = get_next_ply_for_leaf (new_leaf);
-
-	  clib_atomic_store_rel_n (&old_ply->leaves[dst_byte], new_leaf);
-	  old_ply->dst_address_bits_of_leaves[dst_byte] = ply_base_len;
-	}
-      else
-	new_ply = get_next_ply_for_leaf (old_leaf);
+#endif
 
-      set_leaf (a, new_ply - ip4_ply_pool, 2);
-    }
+  clib_mem_free (m->root_ply.leaves);
+  clib_mem_free (m->root_ply.dst_address_bits_of_leaves);
+  m->root_ply.leaves = NULL;
+  m->root_ply.dst_address_bits_of_leaves = NULL;
 }
 
-static uword
-unset_leaf (const ip4_mtrie_set_unset_leaf_args_t *a,
-	    ip4_mtrie_8_ply_t *old_ply, u32 dst_address_byte_index)
+void
+ip4_mtrie_24_init (ip4_mtrie_24_t *m)
 {
-  ip4_mtrie_leaf_t old_leaf, del_leaf;
-  i32 n_dst_bits_next_plies;
-  i32 i, n_dst_bits_this_ply, old_leaf_is_terminal;
-  u8 dst_byte;
-
-  ASSERT (a->dst_address_length <= 32);
-  ASSERT (dst_address_byte_index < ARRAY_LEN (a->dst_address.as_u8));
-
-  n_dst_bits_next_plies =
-    a->dst_address_length - BITS (u8) * (dst_address_byte_index + 1);
-
-  dst_byte = a->dst_address.as_u8[dst_address_byte_index];
-  if (n_dst_bits_next_plies < 0)
-    dst_byte &= ~pow2_mask (-n_dst_bits_next_plies);
-
-  n_dst_bits_this_ply =
-    n_dst_bits_next_plies <= 0 ? -n_dst_bits_next_plies : 0;
-  n_dst_bits_this_ply = clib_min (8, n_dst_bits_this_ply);
-
-  del_leaf = ip4_mtrie_leaf_set_adj_index (a->adj_index);
-
-  for (i = dst_byte; i < dst_byte + (1 << n_dst_bits_this_ply); i++)
-    {
-      old_leaf = old_ply->leaves[i];
-      old_leaf_is_terminal = ip4_mtrie_leaf_is_terminal (old_leaf);
-
-      if (old_leaf == del_leaf ||
-	  (!old_leaf_is_terminal &&
-	   unset_leaf (a, get_next_ply_for_leaf (old_leaf),
-		       dst_address_byte_index + 1)))
-	{
-	  old_ply->n_non_empty_leafs -=
-	    ip4_mtrie_leaf_is_non_empty (old_ply, i);
+  ip4_mtrie_24_ply_t *p = &m->root_ply;
 
-	  clib_atomic_store_rel_n (
-	    &old_ply->leaves[i],
-	    ip4_mtrie_leaf_set_adj_index (a->cover_adj_index));
-	  old_ply->dst_address_bits_of_leaves[i] = a->cover_address_length;
+  p->leaves = clib_mem_alloc_aligned (PLY_24_SIZE * sizeof (p->leaves[0]),
+				      CLIB_CACHE_LINE_BYTES);
+  p->dst_address_bits_of_leaves =
+    clib_mem_alloc_aligned (PLY_24_SIZE, CLIB_CACHE_LINE_BYTES);
 
-	  old_ply->n_non_empty_leafs +=
-	    ip4_mtrie_leaf_is_non_empty (old_ply, i);
-
-	  ASSERT (old_ply->n_non_empty_leafs >= 0);
-	  if (old_ply->n_non_empty_leafs == 0 && dst_address_byte_index > 0)
-	    {
-	      pool_put (ip4_ply_pool, old_ply);
-	      /* Old ply was deleted. */
-	      return 1;
-	    }
-#if CLIB_DEBUG > 0
-	  else if (dst_address_byte_index)
-	    {
-	      int ii, count = 0;
-	      for (ii = 0; ii < ARRAY_LEN (old_ply->leaves); ii++)
-		{
-		  count += ip4_mtrie_leaf_is_non_empty (old_ply, ii);
-		}
-	      ASSERT (count);
-	    }
-#endif
-	}
-    }
-
-  /* Old ply was not deleted. */
-  return 0;
+  clib_memset_u8 (p->dst_address_bits_of_leaves, 0, PLY_24_SIZE);
+  clib_memset_u32 (p->leaves, IP4_MTRIE_LEAF_EMPTY, PLY_24_SIZE);
 }
 
 static void
-unset_root_leaf (ip4_mtrie_16_t *m, const ip4_mtrie_set_unset_leaf_args_t *a)
+ip4_mtrie_mk_args (ip_mtrie_set_unset_leaf_args_t *a,
+		   const ip4_address_t *dst_address, u32 dst_address_length)
 {
-  ip4_mtrie_leaf_t old_leaf, del_leaf;
-  i32 n_dst_bits_next_plies;
-  i32 i, n_dst_bits_this_ply, old_leaf_is_terminal;
-  u16 dst_byte;
-  ip4_mtrie_16_ply_t *old_ply;
-
-  ASSERT (a->dst_address_length <= 32);
-
-  old_ply = &m->root_ply;
-  n_dst_bits_next_plies = a->dst_address_length - BITS (u16);
-
-  dst_byte = a->dst_address.as_u16[0];
-
-  n_dst_bits_this_ply = (n_dst_bits_next_plies <= 0 ?
-			 (16 - a->dst_address_length) : 0);
-
-  del_leaf = ip4_mtrie_leaf_set_adj_index (a->adj_index);
-
-  /* Starting at the value of the byte at this section of the v4 address
-   * fill the buckets/slots of the ply */
-  for (i = 0; i < (1 << n_dst_bits_this_ply); i++)
-    {
-      u16 slot;
-
-      slot = clib_net_to_host_u16 (dst_byte);
-      slot += i;
-      slot = clib_host_to_net_u16 (slot);
+  ip4_main_t *im = &ip4_main;
 
-      old_leaf = old_ply->leaves[slot];
-      old_leaf_is_terminal = ip4_mtrie_leaf_is_terminal (old_leaf);
+  ASSERT (dst_address_length <= 32);
 
-      if (old_leaf == del_leaf ||
-	  (!old_leaf_is_terminal &&
-	   unset_leaf (a, get_next_ply_for_leaf (old_leaf), 2)))
-	{
-	  clib_atomic_store_rel_n (
-	    &old_ply->leaves[slot],
-	    ip4_mtrie_leaf_set_adj_index (a->cover_adj_index));
-	  old_ply->dst_address_bits_of_leaves[slot] = a->cover_address_length;
-	}
-    }
+  /* Honor dst_address_length. Fib masks are in network byte order */
+  a->dst_address.ip4.as_u32 =
+    (dst_address->as_u32 & im->fib_masks[dst_address_length]);
+  a->dst_address_length = dst_address_length;
 }
 
 void
 ip4_mtrie_16_route_add (ip4_mtrie_16_t *m, const ip4_address_t *dst_address,
 			u32 dst_address_length, u32 adj_index)
 {
-  ip4_mtrie_set_unset_leaf_args_t a;
-  ip4_main_t *im = &ip4_main;
-
-  /* Honor dst_address_length. Fib masks are in network byte order */
-  a.dst_address.as_u32 = (dst_address->as_u32 &
-			  im->fib_masks[dst_address_length]);
-  a.dst_address_length = dst_address_length;
-  a.adj_index = adj_index;
+  ip_mtrie_set_unset_leaf_args_t a = {
+    .adj_index = adj_index,
+  };
 
-  set_root_leaf (m, &a);
+  ip4_mtrie_mk_args (&a, dst_address, dst_address_length);
+  ip_mtrie_set_root_leaf (&ip4_ply_pool, m->root_ply.leaves,
+			  m->root_ply.dst_address_bits_of_leaves, 16, &a);
 }
 
 void
 ip4_mtrie_8_route_add (ip4_mtrie_8_t *m, const ip4_address_t *dst_address,
 		       u32 dst_address_length, u32 adj_index)
 {
-  ip4_mtrie_set_unset_leaf_args_t a;
-  ip4_main_t *im = &ip4_main;
+  ip_mtrie_set_unset_leaf_args_t a = {
+    .adj_index = adj_index,
+  };
 
-  /* Honor dst_address_length. Fib masks are in network byte order */
-  a.dst_address.as_u32 =
-    (dst_address->as_u32 & im->fib_masks[dst_address_length]);
-  a.dst_address_length = dst_address_length;
-  a.adj_index = adj_index;
+  ip4_mtrie_mk_args (&a, dst_address, dst_address_length);
+  ip_mtrie_set_leaf (&ip4_ply_pool, &a, m->root_ply, 0);
+}
 
-  ip4_mtrie_8_ply_t *root = pool_elt_at_index (ip4_ply_pool, m->root_ply);
+void
+ip4_mtrie_24_route_add (ip4_mtrie_24_t *m, const ip4_address_t *dst_address,
+			u32 dst_address_length, u32 adj_index)
+{
+  ip_mtrie_set_unset_leaf_args_t a = {
+    .adj_index = adj_index,
+  };
 
-  set_leaf (&a, root - ip4_ply_pool, 0);
+  ip4_mtrie_mk_args (&a, dst_address, dst_address_length);
+  ip_mtrie_set_root_leaf (&ip4_ply_pool, m->root_ply.leaves,
+			  m->root_ply.dst_address_bits_of_leaves, 24, &a);
 }
 
 void
@@ -629,19 +199,17 @@ ip4_mtrie_16_route_del (ip4_mtrie_16_t *m, const ip4_address_t *dst_address,
 			u32 dst_address_length, u32 adj_index,
 			u32 cover_address_length, u32 cover_adj_index)
 {
-  ip4_mtrie_set_unset_leaf_args_t a;
-  ip4_main_t *im = &ip4_main;
+  ip_mtrie_set_unset_leaf_args_t a = {
+    .adj_index = adj_index,
+    .cover_adj_index = cover_adj_index,
+    .cover_address_length = cover_address_length,
+  };
 
-  /* Honor dst_address_length. Fib masks are in network byte order */
-  a.dst_address.as_u32 = (dst_address->as_u32 &
-			  im->fib_masks[dst_address_length]);
-  a.dst_address_length = dst_address_length;
-  a.adj_index = adj_index;
-  a.cover_adj_index = cover_adj_index;
-  a.cover_address_length = cover_address_length;
+  ip4_mtrie_mk_args (&a, dst_address, dst_address_length);
 
   /* the top level ply is never removed */
-  unset_root_leaf (m, &a);
+  ip_mtrie_unset_root_leaf (&ip4_ply_pool, m->root_ply.leaves,
+			    m->root_ply.dst_address_bits_of_leaves, 16, &a);
 }
 
 void
@@ -649,72 +217,63 @@ ip4_mtrie_8_route_del (ip4_mtrie_8_t *m, const ip4_address_t *dst_address,
 		       u32 dst_address_length, u32 adj_index,
 		       u32 cover_address_length, u32 cover_adj_index)
 {
-  ip4_main_t *im = &ip4_main;
-
-  /* Honor dst_address_length. Fib masks are in network byte order */
-  ip4_mtrie_set_unset_leaf_args_t a = {
-    .dst_address.as_u32 =
-      (dst_address->as_u32 & im->fib_masks[dst_address_length]),
-    .dst_address_length = dst_address_length,
+  ip_mtrie_set_unset_leaf_args_t a = {
     .adj_index = adj_index,
     .cover_adj_index = cover_adj_index,
     .cover_address_length = cover_address_length,
   };
 
+  ip4_mtrie_mk_args (&a, dst_address, dst_address_length);
+
   /* the top level ply is never removed */
   ip4_mtrie_8_ply_t *root = pool_elt_at_index (ip4_ply_pool, m->root_ply);
 
-  unset_leaf (&a, root, 0);
+  ip_mtrie_unset_leaf (&ip4_ply_pool, &a, root, 0);
 }
 
-/* Returns number of bytes of memory used by mtrie. */
-static uword
-mtrie_ply_memory_usage (ip4_mtrie_8_ply_t *p)
+void
+ip4_mtrie_24_route_del (ip4_mtrie_24_t *m, const ip4_address_t *dst_address,
+			u32 dst_address_length, u32 adj_index,
+			u32 cover_address_length, u32 cover_adj_index)
 {
-  uword bytes, i;
+  ip_mtrie_set_unset_leaf_args_t a = {
+    .adj_index = adj_index,
+    .cover_adj_index = cover_adj_index,
+    .cover_address_length = cover_address_length,
+  };
 
-  bytes = sizeof (p[0]);
-  for (i = 0; i < ARRAY_LEN (p->leaves); i++)
-    {
-      ip4_mtrie_leaf_t l = p->leaves[i];
-      if (ip4_mtrie_leaf_is_next_ply (l))
-	bytes += mtrie_ply_memory_usage (get_next_ply_for_leaf (l));
-    }
+  ip4_mtrie_mk_args (&a, dst_address, dst_address_length);
 
-  return bytes;
+  /* the top level ply is never removed */
+  ip_mtrie_unset_root_leaf (&ip4_ply_pool, m->root_ply.leaves,
+			    m->root_ply.dst_address_bits_of_leaves, 24, &a);
 }
 
 /* Returns number of bytes of memory used by mtrie. */
 uword
 ip4_mtrie_16_memory_usage (ip4_mtrie_16_t *m)
 {
-  uword bytes, i;
-
-  bytes = sizeof (*m);
-  for (i = 0; i < ARRAY_LEN (m->root_ply.leaves); i++)
-    {
-      ip4_mtrie_leaf_t l = m->root_ply.leaves[i];
-      if (ip4_mtrie_leaf_is_next_ply (l))
-	bytes += mtrie_ply_memory_usage (get_next_ply_for_leaf (l));
-    }
-
-  return bytes;
+  return (sizeof (*m) +
+	  ip_mtrie_leaves_memory_usage (ip4_ply_pool, m->root_ply.leaves,
+					ARRAY_LEN (m->root_ply.leaves)));
 }
+
 uword
 ip4_mtrie_8_memory_usage (ip4_mtrie_8_t *m)
 {
   ip4_mtrie_8_ply_t *root = pool_elt_at_index (ip4_ply_pool, m->root_ply);
-  uword bytes, i;
 
-  bytes = sizeof (*m);
-  for (i = 0; i < ARRAY_LEN (root->leaves); i++)
-    {
-      ip4_mtrie_leaf_t l = root->leaves[i];
-      if (ip4_mtrie_leaf_is_next_ply (l))
-	bytes += mtrie_ply_memory_usage (get_next_ply_for_leaf (l));
-    }
+  return (sizeof (*m) +
+	  ip_mtrie_leaves_memory_usage (ip4_ply_pool, root->leaves,
+					ARRAY_LEN (root->leaves)));
+}
 
-  return bytes;
+uword
+ip4_mtrie_24_memory_usage (ip4_mtrie_24_t *m)
+{
+  return (sizeof (*m) + PLY_24_SIZE * (sizeof (ip4_mtrie_leaf_t) + 1) +
+	  ip_mtrie_leaves_memory_usage (ip4_ply_pool, m->root_ply.leaves,
+					PLY_24_SIZE));
 }
 
 static u8 *
@@ -725,7 +284,7 @@ format_ip4_mtrie_leaf (u8 *s, va_list *va)
   if (ip4_mtrie_leaf_is_terminal (l))
     s = format (s, "lb-index %d", ip4_mtrie_leaf_get_adj_index (l));
   else
-    s = format (s, "next ply %d", ip4_mtrie_leaf_get_next_ply_index (l));
+    s = format (s, "next ply %d", ip_mtrie_leaf_get_next_ply_index (l));
   return s;
 }
 
@@ -742,9 +301,9 @@ format_ip4_mtrie_leaf (u8 *s, va_list *va)
 		format_ip4_address_and_length, &ia, ia_length,                \
 		format_ip4_mtrie_leaf, _l);                                   \
                                                                               \
-    if (ip4_mtrie_leaf_is_next_ply (_l))                                      \
+    if (ip_mtrie_leaf_is_next_ply (_l))                                       \
       s = format (s, "\n%U", format_ip4_mtrie_ply, m, a, (_indent) + 8,       \
-		  ip4_mtrie_leaf_get_next_ply_index (_l));                    \
+		  ip_mtrie_leaf_get_next_ply_index (_l));                     \
     s;                                                                        \
   })
 
@@ -764,7 +323,7 @@ format_ip4_mtrie_ply (u8 *s, va_list *va)
 
   for (i = 0; i < ARRAY_LEN (p->leaves); i++)
     {
-      if (ip4_mtrie_leaf_is_non_empty (p, i))
+      if (ip_mtrie_leaf_is_non_empty (p, i))
 	{
 	  s = FORMAT_PLY (s, p, i, i, base_address,
 			  p->dst_address_bits_base + 8, indent);
@@ -840,6 +399,35 @@ format_ip4_mtrie_8 (u8 *s, va_list *va)
   return s;
 }
 
+u8 *
+format_ip4_mtrie_24 (u8 *s, va_list *va)
+{
+  ip4_mtrie_24_t *m = va_arg (*va, ip4_mtrie_24_t *);
+  int verbose = va_arg (*va, int);
+  ip4_mtrie_24_ply_t *p;
+  u32 base_address = 0;
+  u32 slot;
+
+  s = format (s, "24-8: %d plies, memory usage %U\n", pool_elts (ip4_ply_pool),
+	      format_memory_size, ip4_mtrie_24_memory_usage (m));
+  p = &m->root_ply;
+
+  if (verbose)
+    {
+      s = format (s, "root-ply");
+
+      for (slot = 0; slot < PLY_24_SIZE; slot++)
+	{
+	  if (p->dst_address_bits_of_leaves[slot] > 0)
+	    {
+	      s = FORMAT_PLY (s, p, slot, slot, base_address, 24, 0);
+	    }
+	}
+    }
+
+  return s;
+}
+
 /** Default heap size for the IPv4 mtries */
 #define IP4_FIB_DEFAULT_MTRIE_HEAP_SIZE (32<<20)
 #ifndef MAP_HUGE_SHIFT
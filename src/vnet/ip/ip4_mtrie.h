@@ -44,14 +44,12 @@
 #include <vppinfra/vector.h>
 #include <vnet/ip/lookup.h>
 #include <vnet/ip/ip4_packet.h>	/* for ip4_address_t */
+#include <vnet/ip/ip_mtrie.h>
 
-/* ip4 fib leafs: 4 ply 8-8-8-8 mtrie.
-   1 + 2*adj_index for terminal leaves.
-   0 + 2*next_ply_index for non-terminals, i.e. PLYs
-   1 => empty (adjacency index of zero is special miss adjacency). */
-typedef u32 ip4_mtrie_leaf_t;
+/* ip4 fib leafs: 4 ply 8-8-8-8 mtrie, encoded as described in ip_mtrie.h */
+typedef ip_mtrie_leaf_t ip4_mtrie_leaf_t;
 
-#define IP4_MTRIE_LEAF_EMPTY (1 + 2 * 0)
+#define IP4_MTRIE_LEAF_EMPTY IP_MTRIE_LEAF_EMPTY
 
 /**
  * @brief the 16 way stride that is the top PLY of the mtrie
@@ -74,36 +72,30 @@ typedef struct ip4_mtrie_16_ply_t_
 } ip4_mtrie_16_ply_t;
 
 /**
- * @brief One ply of the 4 ply mtrie fib.
+ * @brief the 24 way stride that is the top PLY of the DIR-24-8 mtrie
+ * At 80MB it is too big to embed in the FIB, so the leaves and prefix
+ * lengths are separately allocated. As with the 16 way ply the count of
+ * 'real' leaves is not maintained.
  */
-typedef struct ip4_mtrie_8_ply_t_
+#define PLY_24_SIZE (1<<24)
+typedef struct ip4_mtrie_24_ply_t_
 {
-  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
-  /**
-   * The leaves/slots/buckets to be filed with leafs
-   */
-  ip4_mtrie_leaf_t leaves[256];
-
-  /**
-   * Prefix length for leaves/ply.
-   */
-  u8 dst_address_bits_of_leaves[256];
-
   /**
-   * Number of non-empty leafs (whether terminal or not).
+   * The leaves/slots/buckets to be filed with leafs. The slot is
+   * the top 24 bits of the address in host byte order.
    */
-  i32 n_non_empty_leafs;
+  ip4_mtrie_leaf_t *leaves;
 
   /**
-   * The length of the ply's covering prefix. Also a measure of its depth
-   * If a leaf in a slot has a mask length longer than this then it is
-   * 'non-empty'. Otherwise it is the value of the cover.
+   * Prefix length for terminal leaves.
    */
-  i32 dst_address_bits_base;
-} ip4_mtrie_8_ply_t;
+  u8 *dst_address_bits_of_leaves;
+} ip4_mtrie_24_ply_t;
 
-STATIC_ASSERT (0 == sizeof (ip4_mtrie_8_ply_t) % CLIB_CACHE_LINE_BYTES,
-	       "IP4 Mtrie ply cache line");
+/**
+ * @brief One ply of the 4 ply mtrie fib.
+ */
+typedef ip_mtrie_8_ply_t ip4_mtrie_8_ply_t;
 
 /**
  * @brief The mutiway-TRIE with a 16-8-8 stride.
@@ -129,17 +121,30 @@ typedef struct
   u32 root_ply;
 } ip4_mtrie_8_t;
 
+/**
+ * @brief The mutiway-TRIE with a 24-8 stride, a.k.a. DIR-24-8.
+ * Any prefix up to /24 is resolved with one memory access, longer
+ * prefixes with two. The second level uses the same 8 bit plys as
+ * the other strides.
+ */
+typedef struct
+{
+  ip4_mtrie_24_ply_t root_ply;
+} ip4_mtrie_24_t;
+
 /**
  * @brief Initialise an mtrie
  */
 void ip4_mtrie_16_init (ip4_mtrie_16_t *m);
 void ip4_mtrie_8_init (ip4_mtrie_8_t *m);
+void ip4_mtrie_24_init (ip4_mtrie_24_t *m);
 
 /**
  * @brief Free an mtrie, It must be empty when free'd
  */
 void ip4_mtrie_16_free (ip4_mtrie_16_t *m);
 void ip4_mtrie_8_free (ip4_mtrie_8_t *m);
+void ip4_mtrie_24_free (ip4_mtrie_24_t *m);
 
 /**
  * @brief Add a route/entry to the mtrie
@@ -149,6 +154,9 @@ void ip4_mtrie_16_route_add (ip4_mtrie_16_t *m,
 			     u32 dst_address_length, u32 adj_index);
 void ip4_mtrie_8_route_add (ip4_mtrie_8_t *m, const ip4_address_t *dst_address,
 			    u32 dst_address_length, u32 adj_index);
+void ip4_mtrie_24_route_add (ip4_mtrie_24_t *m,
+			     const ip4_address_t *dst_address,
+			     u32 dst_address_length, u32 adj_index);
 
 /**
  * @brief remove a route/entry to the mtrie
@@ -160,18 +168,24 @@ void ip4_mtrie_16_route_del (ip4_mtrie_16_t *m,
 void ip4_mtrie_8_route_del (ip4_mtrie_8_t *m, const ip4_address_t *dst_address,
 			    u32 dst_address_length, u32 adj_index,
 			    u32 cover_address_length, u32 cover_adj_index);
+void ip4_mtrie_24_route_del (ip4_mtrie_24_t *m,
+			     const ip4_address_t *dst_address,
+			     u32 dst_address_length, u32 adj_index,
+			     u32 cover_address_length, u32 cover_adj_index);
 
 /**
  * @brief return the memory used by the table
  */
 uword ip4_mtrie_16_memory_usage (ip4_mtrie_16_t *m);
 uword ip4_mtrie_8_memory_usage (ip4_mtrie_8_t *m);
+uword ip4_mtrie_24_memory_usage (ip4_mtrie_24_t *m);
 
 /**
  * @brief Format/display the contents of the mtrie
  */
 format_function_t format_ip4_mtrie_16;
 format_function_t format_ip4_mtrie_8;
+format_function_t format_ip4_mtrie_24;
 
 /**
  * @brief A global pool of 8bit stride plys
@@ -189,7 +203,7 @@ extern void ip4_mtrie_pool_alloc (uword size);
 always_inline u32
 ip4_mtrie_leaf_is_terminal (ip4_mtrie_leaf_t n)
 {
-  return n & 1;
+  return ip_mtrie_leaf_is_terminal (n);
 }
 
 /**
@@ -198,8 +212,7 @@ ip4_mtrie_leaf_is_terminal (ip4_mtrie_leaf_t n)
 always_inline u32
 ip4_mtrie_leaf_get_adj_index (ip4_mtrie_leaf_t n)
 {
-  ASSERT (ip4_mtrie_leaf_is_terminal (n));
-  return n >> 1;
+  return ip_mtrie_leaf_get_adj_index (n);
 }
 
 /**
@@ -268,6 +281,62 @@ ip4_mtrie_8_lookup_step_one (const ip4_mtrie_8_t *m,
   return next_leaf;
 }
 
+always_inline ip4_mtrie_leaf_t
+ip4_mtrie_24_lookup_step (ip4_mtrie_leaf_t current_leaf,
+			  const ip4_address_t *dst_address)
+{
+  ip4_mtrie_8_ply_t *ply;
+
+  uword current_is_terminal = ip4_mtrie_leaf_is_terminal (current_leaf);
+
+  if (!current_is_terminal)
+    {
+      ply = ip4_ply_pool + (current_leaf >> 1);
+      return (ply->leaves[dst_address->as_u8[3]]);
+    }
+
+  return current_leaf;
+}
+
+always_inline ip4_mtrie_leaf_t
+ip4_mtrie_24_lookup_step_one (const ip4_mtrie_24_t *m,
+			      const ip4_address_t *dst_address)
+{
+  ip4_mtrie_leaf_t next_leaf;
+
+  next_leaf =
+    m->root_ply.leaves[clib_net_to_host_u32 (dst_address->as_u32) >> 8];
+
+  return next_leaf;
+}
+
+#ifdef CLIB_HAVE_VEC256
+/**
+ * @brief Lookup 8 addresses in the same DIR-24-8 mtrie using gathers.
+ * The addresses are passed in host byte order. Lanes that resolve in the
+ * root ply gather from the burnt ply at index 0 in the second step, so
+ * every gathered address is valid and no masked gather is needed.
+ */
+static_always_inline u32x8
+ip4_mtrie_24_lookup_x8 (const ip4_mtrie_24_t *m, u32x8 dst)
+{
+  u32x8 leaf, is_ply, ply_slot;
+
+  leaf = u32x8_gather_u32 (m->root_ply.leaves, dst >> 8, 4);
+  is_ply = (u32x8) ((leaf & 1) == 0);
+
+  if (PREDICT_TRUE (u32x8_is_all_zero (is_ply)))
+    return leaf;
+
+  ply_slot = (leaf >> 1) * (sizeof (ip4_mtrie_8_ply_t) / sizeof (u32)) +
+	     (dst & 0xff);
+  ply_slot &= is_ply;
+
+  return (u32x8_gather_u32 (ip4_ply_pool, ply_slot, 4) & is_ply) |
+	 (leaf & ~is_ply);
+}
+#endif
+
 #endif /* included_ip_ip4_fib_h */
 
 /*
@@ -50,6 +50,7 @@
 #include <vnet/ip/lookup.h>
 #include <vnet/ip/ip_interface.h>
 #include <vnet/ip/ip_flow_hash.h>
+#include <vnet/ip/ip6_mtrie.h>
 
 typedef struct
 {
@@ -73,6 +74,12 @@ typedef struct
    * The hash table DB
    */
   uword *fib_entry_by_dst_address;
+
+  /**
+   * The forwarding mtrie, present only when the fwding-mtrie
+   * option is configured
+   */
+  ip6_mtrie_t *mtrie;
 } ip6_fib_t;
 
 typedef struct ip6_mfib_t
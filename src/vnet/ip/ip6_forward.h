@@ -61,11 +61,37 @@ ip6_lookup_inline (vlib_main_t * vm,
   u32 n_left_from, n_left_to_next, *from, *to_next;
   ip_lookup_next_t next;
   clib_thread_index_t thread_index = vm->thread_index;
+  u32 lbis[VLIB_FRAME_SIZE], *lbi = NULL;
 
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
   next = node->cached_next_index;
 
+  if (ip6_fib_fwding_table.use_mtrie)
+    {
+      /*
+       * Walk the tries for the whole frame up front, so the PLY loads
+       * of the different packets are in flight together.
+       */
+      const ip6_address_t *dsts[VLIB_FRAME_SIZE];
+      const ip6_mtrie_t *mtries[VLIB_FRAME_SIZE];
+      vlib_buffer_t *b;
+      ip6_header_t *ip;
+      u32 i;
+
+      for (i = 0; i < n_left_from; i++)
+	{
+	  b = vlib_get_buffer (vm, from[i]);
+	  ip = vlib_buffer_get_current (b);
+	  ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, b);
+	  mtries[i] = ip6_fib_get (vnet_buffer (b)->ip.fib_index)->mtrie;
+	  dsts[i] = &ip->dst_address;
+	}
+
+      ip6_mtrie_lookup_batch (mtries, dsts, lbis, n_left_from);
+      lbi = lbis;
+    }
+
   while (n_left_from > 0)
     {
       vlib_get_next_frame (vm, node, next, to_next, n_left_to_next);
@@ -109,10 +135,19 @@ ip6_lookup_inline (vlib_main_t * vm,
 	  ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, p0);
 	  ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, p1);
 
-	  lbi0 = ip6_fib_table_fwding_lookup (vnet_buffer (p0)->ip.fib_index,
-					      dst_addr0);
-	  lbi1 = ip6_fib_table_fwding_lookup (vnet_buffer (p1)->ip.fib_index,
-					      dst_addr1);
+	  if (lbi)
+	    {
+	      lbi0 = lbi[0];
+	      lbi1 = lbi[1];
+	      lbi += 2;
+	    }
+	  else
+	    {
+	      lbi0 = ip6_fib_table_fwding_lookup (
+		vnet_buffer (p0)->ip.fib_index, dst_addr0);
+	      lbi1 = ip6_fib_table_fwding_lookup (
+		vnet_buffer (p1)->ip.fib_index, dst_addr1);
+	    }
 
 	  lb0 = load_balance_get (lbi0);
 	  lb1 = load_balance_get (lbi1);
@@ -236,8 +271,11 @@ ip6_lookup_inline (vlib_main_t * vm,
 	  ip0 = vlib_buffer_get_current (p0);
 	  dst_addr0 = &ip0->dst_address;
 	  ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, p0);
-	  lbi0 = ip6_fib_table_fwding_lookup (vnet_buffer (p0)->ip.fib_index,
-					      dst_addr0);
+	  if (lbi)
+	    lbi0 = *lbi++;
+	  else
+	    lbi0 = ip6_fib_table_fwding_lookup (
+	      vnet_buffer (p0)->ip.fib_index, dst_addr0);
 
 	  lb0 = load_balance_get (lbi0);
 	  flow_hash_config0 = lb0->lb_hash_config;
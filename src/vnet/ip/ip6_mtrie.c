@@ -0,0 +1,110 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vnet/ip/ip.h>
+#include <vnet/ip/ip6_mtrie.h>
+
+/**
+ * Global pool of IPv6 8bit PLYs
+ */
+ip6_mtrie_8_ply_t *ip6_ply_pool;
+
+void
+ip6_mtrie_init (ip6_mtrie_t *m)
+{
+  clib_memset_u8 (m->root_ply.dst_address_bits_of_leaves, 0,
+		  sizeof (m->root_ply.dst_address_bits_of_leaves));
+  clib_memset_u32 (m->root_ply.leaves, IP6_MTRIE_LEAF_EMPTY,
+		   ARRAY_LEN (m->root_ply.leaves));
+}
+
+void
+ip6_mtrie_free (ip6_mtrie_t *m)
+{
+  /* the root ply is embedded so there is nothing to do, the table
+   * must be emptied before it is freed */
+#if CLIB_DEBUG > 0
+  int i;
+  for (i = 0; i < ARRAY_LEN (m->root_ply.leaves); i++)
+    ASSERT (!ip_mtrie_leaf_is_next_ply (m->root_ply.leaves[i]));
+#endif
+}
+
+static void
+ip6_mtrie_mk_args (ip_mtrie_set_unset_leaf_args_t *a,
+		   const ip6_address_t *dst_address, u32 dst_address_length)
+{
+  const ip6_address_t *mask = &ip6_main.fib_masks[dst_address_length];
+
+  ASSERT (dst_address_length <= 128);
+
+  /* Honor dst_address_length. Fib masks are in network byte order */
+  a->dst_address.ip6.as_u64[0] = dst_address->as_u64[0] & mask->as_u64[0];
+  a->dst_address.ip6.as_u64[1] = dst_address->as_u64[1] & mask->as_u64[1];
+  a->dst_address_length = dst_address_length;
+}
+
+void
+ip6_mtrie_route_add (ip6_mtrie_t *m, const ip6_address_t *dst_address,
+		     u32 dst_address_length, u32 adj_index)
+{
+  ip_mtrie_set_unset_leaf_args_t a = {
+    .adj_index = adj_index,
+  };
+
+  ip6_mtrie_mk_args (&a, dst_address, dst_address_length);
+  ip_mtrie_set_root_leaf (&ip6_ply_pool, m->root_ply.leaves,
+			  m->root_ply.dst_address_bits_of_leaves, 16, &a);
+}
+
+void
+ip6_mtrie_route_del (ip6_mtrie_t *m, const ip6_address_t *dst_address,
+		     u32 dst_address_length, u32 adj_index,
+		     u32 cover_address_length, u32 cover_adj_index)
+{
+  ip_mtrie_set_unset_leaf_args_t a = {
+    .adj_index = adj_index,
+    .cover_adj_index = cover_adj_index,
+    .cover_address_length = cover_address_length,
+  };
+
+  ip6_mtrie_mk_args (&a, dst_address, dst_address_length);
+
+  /* the top level ply is never removed */
+  ip_mtrie_unset_root_leaf (&ip6_ply_pool, m->root_ply.leaves,
+			    m->root_ply.dst_address_bits_of_leaves, 16, &a);
+}
+
+uword
+ip6_mtrie_memory_usage (ip6_mtrie_t *m)
+{
+  return (sizeof (*m) +
+	  ip_mtrie_leaves_memory_usage (ip6_ply_pool, m->root_ply.leaves,
+					ARRAY_LEN (m->root_ply.leaves)));
+}
+
+u8 *
+format_ip6_mtrie (u8 *s, va_list *va)
+{
+  ip6_mtrie_t *m = va_arg (*va, ip6_mtrie_t *);
+
+  s = format (s, "16-8-...-8: %d plies, memory usage %U",
+	      pool_elts (ip6_ply_pool), format_memory_size,
+	      ip6_mtrie_memory_usage (m));
+
+  return s;
+}
+
+static clib_error_t *
+ip6_mtrie_module_init (vlib_main_t *vm)
+{
+  CLIB_UNUSED (ip6_mtrie_8_ply_t * p);
+
+  /* Burn one ply so index 0 is taken */
+  pool_get_aligned (ip6_ply_pool, p, CLIB_CACHE_LINE_BYTES);
+
+  return (NULL);
+}
+
+VLIB_INIT_FUNCTION (ip6_mtrie_module_init);
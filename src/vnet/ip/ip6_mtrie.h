@@ -0,0 +1,145 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#ifndef included_ip_ip6_mtrie_h
+#define included_ip_ip6_mtrie_h
+
+#include <vnet/ip/ip_mtrie.h>
+
+/**
+ * @brief ip6 mtrie: a leaf pushed multibit trie with a 16-8-8-...-8 stride.
+ *
+ * This is the IPv6 equivalent of the ip4 16-8-8 mtrie. It is an
+ * optional forwarding structure that the ip6-lookup node uses in place
+ * of probing the forwarding bihash once per prefix length. The bihash is
+ * still maintained and remains the data-base from which covers are found
+ * when routes are removed.
+ *
+ * The leaf encoding, the 8 bit plys and the update algorithm are those
+ * of the ip4 mtrie, see ip_mtrie.h.
+ */
+typedef ip_mtrie_leaf_t ip6_mtrie_leaf_t;
+
+#define IP6_MTRIE_LEAF_EMPTY IP_MTRIE_LEAF_EMPTY
+
+/**
+ * @brief The 16 way stride that is the top PLY of the mtrie.
+ * As with ip4, the count of 'real' leaves in this PLY is not maintained
+ * since it is only removed when the table is.
+ */
+#define IP6_MTRIE_PLY_16_SIZE (1 << 16)
+typedef struct ip6_mtrie_16_ply_t_
+{
+  ip6_mtrie_leaf_t leaves[IP6_MTRIE_PLY_16_SIZE];
+  u8 dst_address_bits_of_leaves[IP6_MTRIE_PLY_16_SIZE];
+} ip6_mtrie_16_ply_t;
+
+/**
+ * @brief One 8 bit stride ply.
+ */
+typedef ip_mtrie_8_ply_t ip6_mtrie_8_ply_t;
+
+typedef struct ip6_mtrie_t_
+{
+  ip6_mtrie_16_ply_t root_ply;
+} ip6_mtrie_t;
+
+/**
+ * @brief A global pool of 8bit stride plys
+ */
+extern ip6_mtrie_8_ply_t *ip6_ply_pool;
+
+extern void ip6_mtrie_init (ip6_mtrie_t *m);
+extern void ip6_mtrie_free (ip6_mtrie_t *m);
+
+extern void ip6_mtrie_route_add (ip6_mtrie_t *m,
+				 const ip6_address_t *dst_address,
+				 u32 dst_address_length, u32 adj_index);
+extern void ip6_mtrie_route_del (ip6_mtrie_t *m,
+				 const ip6_address_t *dst_address,
+				 u32 dst_address_length, u32 adj_index,
+				 u32 cover_address_length,
+				 u32 cover_adj_index);
+
+extern uword ip6_mtrie_memory_usage (ip6_mtrie_t *m);
+extern format_function_t format_ip6_mtrie;
+
+always_inline u32
+ip6_mtrie_leaf_is_terminal (ip6_mtrie_leaf_t n)
+{
+  return ip_mtrie_leaf_is_terminal (n);
+}
+
+always_inline u32
+ip6_mtrie_leaf_get_adj_index (ip6_mtrie_leaf_t n)
+{
+  return ip_mtrie_leaf_get_adj_index (n);
+}
+
+always_inline u32
+ip6_mtrie_lookup (const ip6_mtrie_t *m, const ip6_address_t *dst)
+{
+  ip6_mtrie_leaf_t leaf;
+  u32 byte = 2;
+
+  leaf = m->root_ply.leaves[dst->as_u16[0]];
+
+  while (!ip6_mtrie_leaf_is_terminal (leaf))
+    {
+      ASSERT (byte < ARRAY_LEN (dst->as_u8));
+      leaf = ip6_ply_pool[leaf >> 1].leaves[dst->as_u8[byte++]];
+    }
+
+  return ip6_mtrie_leaf_get_adj_index (leaf);
+}
+
+/**
+ * @brief Lookup a batch of addresses, walking all of them one ply at a
+ * time so the ply loads of the different addresses are issued together.
+ */
+#define IP6_MTRIE_LOOKUP_BATCH 8
+
+static_always_inline void
+ip6_mtrie_lookup_batch (const ip6_mtrie_t **m, const ip6_address_t **dst,
+			u32 *lbs, u32 n_left)
+{
+  ip6_mtrie_leaf_t leaf[IP6_MTRIE_LOOKUP_BATCH];
+  u32 i, n, byte, n_non_terminal;
+
+  while (n_left > 0)
+    {
+      n = clib_min (n_left, IP6_MTRIE_LOOKUP_BATCH);
+      n_non_terminal = 0;
+
+      for (i = 0; i < n; i++)
+	{
+	  leaf[i] = m[i]->root_ply.leaves[dst[i]->as_u16[0]];
+	  n_non_terminal += !ip6_mtrie_leaf_is_terminal (leaf[i]);
+	}
+
+      for (byte = 2; n_non_terminal; byte++)
+	{
+	  ASSERT (byte < ARRAY_LEN (dst[0]->as_u8));
+	  n_non_terminal = 0;
+
+	  for (i = 0; i < n; i++)
+	    if (!ip6_mtrie_leaf_is_terminal (leaf[i]))
+	      {
+		leaf[i] =
+		  ip6_ply_pool[leaf[i] >> 1].leaves[dst[i]->as_u8[byte]];
+		n_non_terminal += !ip6_mtrie_leaf_is_terminal (leaf[i]);
+	      }
+	}
+
+      for (i = 0; i < n; i++)
+	lbs[i] = ip6_mtrie_leaf_get_adj_index (leaf[i]);
+
+      m += n;
+      dst += n;
+      lbs += n;
+      n_left -= n;
+    }
+}
+
+#endif /* included_ip_ip6_mtrie_h */
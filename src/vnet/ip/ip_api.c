@@ -845,6 +845,59 @@ vl_api_ip_route_add_del_v2_t_handler (vl_api_ip_route_add_del_v2_t *mp)
   /* clang-format on */
 }
 
+void
+vl_api_ip_route_add_del_bulk_t_handler (vl_api_ip_route_add_del_bulk_t *mp)
+{
+  vl_api_ip_route_add_del_bulk_reply_t *rmp;
+  vl_api_ip_route_bulk_entry_t *route;
+  fib_route_path_t *rpaths = NULL;
+  fib_entry_flag_t entry_flags;
+  u32 fib_index, n_routes, ii;
+  fib_prefix_t pfx;
+  int rv = 0;
+
+  n_routes = ntohl (mp->n_routes);
+  vec_validate (rpaths, 0);
+
+  fib_table_batch_begin ();
+
+  for (ii = 0; ii < n_routes; ii++)
+    {
+      route = &mp->routes[ii];
+      entry_flags = FIB_ENTRY_FLAG_NONE;
+      ip_prefix_decode (&route->prefix, &pfx);
+
+      rv = fib_api_table_id_decode (pfx.fp_proto, ntohl (route->table_id),
+				    &fib_index);
+      if (0 != rv)
+	break;
+
+      vec_set_len (rpaths, 0);
+      if (mp->is_add || route->is_multipath)
+	{
+	  vec_set_len (rpaths, 1);
+	  rv = fib_api_path_decode (&route->path, &rpaths[0]);
+	  if (0 != rv)
+	    break;
+
+	  if ((rpaths[0].frp_flags & FIB_ROUTE_PATH_LOCAL) &&
+	      (~0 == rpaths[0].frp_sw_if_index))
+	    entry_flags |= (FIB_ENTRY_FLAG_CONNECTED | FIB_ENTRY_FLAG_LOCAL);
+	}
+
+      rv = fib_api_route_add_del (mp->is_add, route->is_multipath, fib_index,
+				  &pfx, FIB_SOURCE_API, entry_flags, rpaths);
+      if (0 != rv)
+	break;
+    }
+
+  fib_table_batch_end ();
+  vec_free (rpaths);
+
+  REPLY_MACRO2 (VL_API_IP_ROUTE_ADD_DEL_BULK_REPLY,
+		({ rmp->n_done = htonl (ii); }));
+}
+
 void
 vl_api_ip_route_lookup_t_handler (vl_api_ip_route_lookup_t * mp)
 {
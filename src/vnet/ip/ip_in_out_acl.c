@@ -111,6 +111,143 @@ static char *ip_outacl_error_strings[] = {
 #undef _
 };
 
+static_always_inline void
+ip_in_out_acl_hit (vnet_classify_entry_t *e, vlib_buffer_t *b, u32 *next,
+		   u32 n_next_nodes, u32 *fib_index_by_sw_if_index,
+		   const vlib_error_t error_none, const vlib_error_t error_deny,
+		   const int is_output)
+{
+  vnet_buffer (b)->l2_classify.opaque_index = e->opaque_index;
+  vlib_buffer_advance (b, e->advance);
+
+  *next = (e->next_index < n_next_nodes) ? e->next_index : *next;
+
+  b->error = (*next == ACL_NEXT_INDEX_DENY) ? error_deny : error_none;
+
+  if (!is_output)
+    {
+      if (e->action == CLASSIFY_ACTION_SET_IP4_FIB_INDEX ||
+	  e->action == CLASSIFY_ACTION_SET_IP6_FIB_INDEX)
+	vnet_buffer (b)->sw_if_index[VLIB_TX] = e->metadata;
+      else if (e->action == CLASSIFY_ACTION_SET_METADATA)
+	{
+	  vnet_buffer (b)->ip.adj_index[VLIB_TX] = e->metadata;
+	  /* For source check in case we skip the lookup node */
+	  ip_lookup_set_buffer_fib_index (fib_index_by_sw_if_index, b);
+	}
+    }
+}
+
+/* The frame searched at once, when some chains are compiled */
+static_always_inline void
+ip_in_out_acl_compiled_inline (
+  vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame,
+  vlib_buffer_t **b, u16 *next, u32 n_left, u32 *hits__, u32 *misses__,
+  u32 *chain_hits__, const vlib_error_t error_none,
+  const vlib_error_t error_deny, const vlib_error_t error_miss,
+  vnet_classify_table_t *tables, const u32 *table_index_by_sw_if_index,
+  u32 *fib_index_by_sw_if_index, vnet_config_main_t *cm,
+  const vlib_rx_or_tx_t way, const int is_output, const int do_trace)
+{
+  vnet_classify_main_t *vcm = &vnet_classify_main;
+  vnet_classify_entry_t *entries[VLIB_FRAME_SIZE], *e;
+  u32 table_indices[VLIB_FRAME_SIZE];
+  u8 *data[VLIB_FRAME_SIZE], *current[VLIB_FRAME_SIZE];
+  f64 now = vlib_time_now (vm);
+  u32 hits = 0;
+  u32 misses = 0;
+  u32 chain_hits = 0;
+  u32 n_next_nodes = node->n_next_nodes;
+  u32 sw_if_index, next0, i;
+  vnet_classify_table_t *t;
+
+  for (i = 0; i < n_left; i++)
+    {
+      if (i + 4 < n_left)
+	{
+	  vlib_prefetch_buffer_header (b[i + 4], LOAD);
+	  clib_prefetch_load (b[i + 4]->data);
+	}
+
+      /* ~0 is used as a wildcard to say 'always use sw_if_index 0'
+       * aka local0. It is used when we do not care about the sw_if_index, as
+       * when punting */
+      sw_if_index = ~0 == way ? 0 : vnet_buffer (b[i])->sw_if_index[way];
+      table_indices[i] = table_index_by_sw_if_index[sw_if_index];
+      data[i] = b[i]->data;
+      current[i] = vlib_buffer_get_current (b[i]);
+
+      if (is_output)
+	{
+	  /* Save the rewrite length, since we are using the l2_classify struct */
+	  vnet_buffer (b[i])->l2.l2_len =
+	    vnet_buffer (b[i])->ip.save_rewrite_length;
+	  /* advance the match pointers so the matching happens on IP header */
+	  data[i] += vnet_buffer (b[i])->l2.l2_len;
+	  current[i] += vnet_buffer (b[i])->l2.l2_len;
+	}
+
+      vnet_buffer (b[i])->l2_classify.table_index = table_indices[i];
+      vnet_buffer (b[i])->l2_classify.opaque_index = ~0;
+    }
+
+  vnet_classify_find_entries (vcm, data, current, table_indices, entries,
+			      n_left, now);
+
+  for (i = 0; i < n_left; i++)
+    {
+      next0 = ACL_NEXT_INDEX_DENY;
+      vnet_get_config_data (cm, &b[i]->current_config_index, &next0,
+			    /* # bytes of config data */ 0);
+
+      e = entries[i];
+      t = 0;
+      if (PREDICT_TRUE (table_indices[i] != ~0))
+	t = pool_elt_at_index (tables, table_indices[i]);
+
+      if (e)
+	{
+	  ip_in_out_acl_hit (e, b[i], &next0, n_next_nodes,
+			     fib_index_by_sw_if_index, error_none, error_deny,
+			     is_output);
+	  hits++;
+	  if (table_indices[i] != vnet_buffer (b[i])->l2_classify.table_index)
+	    chain_hits++;
+	}
+      else if (t)
+	{
+	  next0 = (t->miss_next_index < n_next_nodes) ? t->miss_next_index :
+							  next0;
+	  misses++;
+	  b[i]->error =
+	    (next0 == ACL_NEXT_INDEX_DENY) ? error_miss : error_none;
+	}
+
+      if (do_trace && b[i]->flags & VLIB_BUFFER_IS_TRACED)
+	{
+	  ip_in_out_acl_trace_t *_t =
+	    vlib_add_trace (vm, node, b[i], sizeof (*_t));
+	  _t->sw_if_index =
+	    ~0 == way ? 0 : vnet_buffer (b[i])->sw_if_index[way];
+	  _t->next_index = next0;
+	  _t->table_index = table_indices[i];
+	  _t->offset = e ? vnet_classify_get_offset (t, e) : ~0;
+	}
+
+      if ((next0 == ACL_NEXT_INDEX_DENY) && is_output)
+	{
+	  /* on output, for the drop node to work properly, go back to ip header */
+	  vlib_buffer_advance (b[i], vnet_buffer (b[i])->l2.l2_len);
+	}
+
+      next[i] = next0;
+    }
+
+  *hits__ = hits;
+  *misses__ = misses;
+  *chain_hits__ = chain_hits;
+}
+
 static_always_inline void
 ip_in_out_acl_inline_trace (
   vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame,
@@ -768,7 +905,21 @@ ip_in_out_acl_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
     table_index_by_sw_if_index, fib_index_by_sw_if_index, cm, way, is_output, \
     do_trace)
 
-  if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE))
+#define ip_in_out_acl_compiled_inline__(do_trace)                             \
+  ip_in_out_acl_compiled_inline (                                             \
+    vm, node, frame, bufs, nexts, frame->n_vectors, &hits, &misses,           \
+    &chain_hits, error_deny, error_miss, error_none, tables,                  \
+    table_index_by_sw_if_index, fib_index_by_sw_if_index, cm, way, is_output, \
+    do_trace)
+
+  if (PREDICT_FALSE (am->vnet_classify_main->n_compiled_chains))
+    {
+      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE))
+	ip_in_out_acl_compiled_inline__ (1 /* do_trace */);
+      else
+	ip_in_out_acl_compiled_inline__ (0 /* do_trace */);
+    }
+  else if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE))
     ip_in_out_acl_inline_trace__ (1 /* do_trace */);
   else
     ip_in_out_acl_inline_trace__ (0 /* do_trace */);
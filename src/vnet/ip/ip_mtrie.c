@@ -0,0 +1,467 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vlib/threads.h>
+#include <vnet/ip/ip_mtrie.h>
+
+void
+ip_mtrie_ply_8_init (ip_mtrie_8_ply_t *p, ip_mtrie_leaf_t init,
+		     uword prefix_len, u32 ply_base_len)
+{
+  p->n_non_empty_leafs = prefix_len > ply_base_len ? ARRAY_LEN (p->leaves) : 0;
+  clib_memset_u8 (p->dst_address_bits_of_leaves, prefix_len,
+		  sizeof (p->dst_address_bits_of_leaves));
+  p->dst_address_bits_base = ply_base_len;
+
+  clib_memset_u32 (p->leaves, init, ARRAY_LEN (p->leaves));
+}
+
+static ip_mtrie_leaf_t
+ply_create (ip_mtrie_8_ply_t **pool, ip_mtrie_leaf_t init_leaf,
+	    u32 leaf_prefix_len, u32 ply_base_len)
+{
+  ip_mtrie_8_ply_t *p;
+  ip_mtrie_leaf_t l;
+  u8 need_barrier_sync = pool_get_will_expand (*pool);
+  vlib_main_t *vm = vlib_get_main ();
+  ASSERT (vm->thread_index == 0);
+
+  if (need_barrier_sync)
+    vlib_worker_thread_barrier_sync (vm);
+
+  /* Get cache aligned ply. */
+  pool_get_aligned (*pool, p, CLIB_CACHE_LINE_BYTES);
+
+  ip_mtrie_ply_8_init (p, init_leaf, leaf_prefix_len, ply_base_len);
+  l = ip_mtrie_leaf_set_next_ply_index (p - *pool);
+
+  if (need_barrier_sync)
+    vlib_worker_thread_barrier_release (vm);
+
+  return l;
+}
+
+always_inline ip_mtrie_8_ply_t *
+get_next_ply_for_leaf (ip_mtrie_8_ply_t *pool, ip_mtrie_leaf_t l)
+{
+  uword n = ip_mtrie_leaf_get_next_ply_index (l);
+
+  return pool_elt_at_index (pool, n);
+}
+
+static void
+set_ply_with_more_specific_leaf (ip_mtrie_8_ply_t *pool,
+				 ip_mtrie_8_ply_t *ply,
+				 ip_mtrie_leaf_t new_leaf,
+				 uword new_leaf_dst_address_bits)
+{
+  ip_mtrie_leaf_t old_leaf;
+  uword i;
+
+  ASSERT (ip_mtrie_leaf_is_terminal (new_leaf));
+
+  for (i = 0; i < ARRAY_LEN (ply->leaves); i++)
+    {
+      old_leaf = ply->leaves[i];
+
+      /* Recurse into sub plies. */
+      if (!ip_mtrie_leaf_is_terminal (old_leaf))
+	{
+	  ip_mtrie_8_ply_t *sub_ply = get_next_ply_for_leaf (pool, old_leaf);
+	  set_ply_with_more_specific_leaf (pool, sub_ply, new_leaf,
+					   new_leaf_dst_address_bits);
+	}
+
+      /* Replace less specific terminal leaves with new leaf. */
+      else if (new_leaf_dst_address_bits >=
+	       ply->dst_address_bits_of_leaves[i])
+	{
+	  clib_atomic_store_rel_n (&ply->leaves[i], new_leaf);
+	  ply->dst_address_bits_of_leaves[i] = new_leaf_dst_address_bits;
+	  ply->n_non_empty_leafs += ip_mtrie_leaf_is_non_empty (ply, i);
+	}
+    }
+}
+
+void
+ip_mtrie_set_leaf (ip_mtrie_8_ply_t **pool,
+		   const ip_mtrie_set_unset_leaf_args_t *a, u32 old_ply_index,
+		   u32 dst_address_byte_index)
+{
+  ip_mtrie_leaf_t old_leaf, new_leaf;
+  i32 n_dst_bits_next_plies;
+  u8 dst_byte;
+  ip_mtrie_8_ply_t *old_ply;
+
+  old_ply = pool_elt_at_index (*pool, old_ply_index);
+
+  ASSERT (a->dst_address_length <= 128);
+  ASSERT (dst_address_byte_index < ARRAY_LEN (a->dst_address.as_u8));
+
+  /* how many bits of the destination address are in the next PLY */
+  n_dst_bits_next_plies =
+    a->dst_address_length - BITS (u8) * (dst_address_byte_index + 1);
+
+  dst_byte = a->dst_address.as_u8[dst_address_byte_index];
+
+  /* Number of bits next plies <= 0 => insert leaves this ply. */
+  if (n_dst_bits_next_plies <= 0)
+    {
+      /* The mask length of the address to insert maps to this ply */
+      uword old_leaf_is_terminal;
+      u32 i, n_dst_bits_this_ply;
+
+      /* The number of bits, and hence slots/buckets, we will fill */
+      n_dst_bits_this_ply = clib_min (8, -n_dst_bits_next_plies);
+      ASSERT ((a->dst_address.as_u8[dst_address_byte_index] &
+	       pow2_mask (n_dst_bits_this_ply)) == 0);
+
+      /* Starting at the value of the byte at this section of the address
+       * fill the buckets/slots of the ply */
+      for (i = dst_byte; i < dst_byte + (1 << n_dst_bits_this_ply); i++)
+	{
+	  ip_mtrie_8_ply_t *new_ply;
+
+	  old_leaf = old_ply->leaves[i];
+	  old_leaf_is_terminal = ip_mtrie_leaf_is_terminal (old_leaf);
+
+	  if (a->dst_address_length >= old_ply->dst_address_bits_of_leaves[i])
+	    {
+	      /* The new leaf is more or equally specific than the one currently
+	       * occupying the slot */
+	      new_leaf = ip_mtrie_leaf_set_adj_index (a->adj_index);
+
+	      if (old_leaf_is_terminal)
+		{
+		  /* The current leaf is terminal, we can replace it with
+		   * the new one */
+		  old_ply->n_non_empty_leafs -=
+		    ip_mtrie_leaf_is_non_empty (old_ply, i);
+
+		  old_ply->dst_address_bits_of_leaves[i] =
+		    a->dst_address_length;
+		  clib_atomic_store_rel_n (&old_ply->leaves[i], new_leaf);
+
+		  old_ply->n_non_empty_leafs +=
+		    ip_mtrie_leaf_is_non_empty (old_ply, i);
+		  ASSERT (old_ply->n_non_empty_leafs <=
+			  ARRAY_LEN (old_ply->leaves));
+		}
+	      else
+		{
+		  /* Existing leaf points to another ply.  We need to place
+		   * new_leaf into all more specific slots. */
+		  new_ply = get_next_ply_for_leaf (*pool, old_leaf);
+		  set_ply_with_more_specific_leaf (*pool, new_ply, new_leaf,
+						   a->dst_address_length);
+		}
+	    }
+	  else if (!old_leaf_is_terminal)
+	    {
+	      /* The current leaf is less specific and not termial (i.e. a ply),
+	       * recurse on down the trie */
+	      new_ply = get_next_ply_for_leaf (*pool, old_leaf);
+	      ip_mtrie_set_leaf (pool, a, new_ply - *pool,
+				 dst_address_byte_index + 1);
+	    }
+	  /*
+	   * else
+	   *  the route we are adding is less specific than the leaf currently
+	   *  occupying this slot. leave it there
+	   */
+	}
+    }
+  else
+    {
+      /* The address to insert requires us to move down at a lower level of
+       * the trie - recurse on down */
+      ip_mtrie_8_ply_t *new_ply;
+      u8 ply_base_len;
+
+      ply_base_len = 8 * (dst_address_byte_index + 1);
+
+      old_leaf = old_ply->leaves[dst_byte];
+
+      if (ip_mtrie_leaf_is_terminal (old_leaf))
+	{
+	  /* There is a leaf occupying the slot. Replace it with a new ply */
+	  old_ply->n_non_empty_leafs -=
+	    ip_mtrie_leaf_is_non_empty (old_ply, dst_byte);
+
+	  new_leaf =
+	    ply_create (pool, old_leaf,
+			old_ply->dst_address_bits_of_leaves[dst_byte],
+			ply_base_len);
+	  new_ply = get_next_ply_for_leaf (*pool, new_leaf);
+
+	  /* Refetch since ply_create may move pool. */
+	  old_ply = pool_elt_at_index (*pool, old_ply_index);
+
+	  clib_atomic_store_rel_n (&old_ply->leaves[dst_byte], new_leaf);
+	  old_ply->dst_address_bits_of_leaves[dst_byte] = ply_base_len;
+
+	  old_ply->n_non_empty_leafs +=
+	    ip_mtrie_leaf_is_non_empty (old_ply, dst_byte);
+	  ASSERT (old_ply->n_non_empty_leafs >= 0);
+	}
+      else
+	new_ply = get_next_ply_for_leaf (*pool, old_leaf);
+
+      ip_mtrie_set_leaf (pool, a, new_ply - *pool, dst_address_byte_index + 1);
+    }
+}
+
+uword
+ip_mtrie_unset_leaf (ip_mtrie_8_ply_t **pool,
+		     const ip_mtrie_set_unset_leaf_args_t *a,
+		     ip_mtrie_8_ply_t *old_ply, u32 dst_address_byte_index)
+{
+  ip_mtrie_leaf_t old_leaf, del_leaf;
+  i32 n_dst_bits_next_plies;
+  i32 i, n_dst_bits_this_ply, old_leaf_is_terminal;
+  u8 dst_byte;
+
+  ASSERT (a->dst_address_length <= 128);
+  ASSERT (dst_address_byte_index < ARRAY_LEN (a->dst_address.as_u8));
+
+  n_dst_bits_next_plies =
+    a->dst_address_length - BITS (u8) * (dst_address_byte_index + 1);
+
+  dst_byte = a->dst_address.as_u8[dst_address_byte_index];
+  if (n_dst_bits_next_plies < 0)
+    dst_byte &= ~pow2_mask (-n_dst_bits_next_plies);
+
+  n_dst_bits_this_ply =
+    n_dst_bits_next_plies <= 0 ? -n_dst_bits_next_plies : 0;
+  n_dst_bits_this_ply = clib_min (8, n_dst_bits_this_ply);
+
+  del_leaf = ip_mtrie_leaf_set_adj_index (a->adj_index);
+
+  for (i = dst_byte; i < dst_byte + (1 << n_dst_bits_this_ply); i++)
+    {
+      old_leaf = old_ply->leaves[i];
+      old_leaf_is_terminal = ip_mtrie_leaf_is_terminal (old_leaf);
+
+      if (old_leaf == del_leaf ||
+	  (!old_leaf_is_terminal &&
+	   ip_mtrie_unset_leaf (pool, a, get_next_ply_for_leaf (*pool, old_leaf),
+				dst_address_byte_index + 1)))
+	{
+	  old_ply->n_non_empty_leafs -=
+	    ip_mtrie_leaf_is_non_empty (old_ply, i);
+
+	  clib_atomic_store_rel_n (
+	    &old_ply->leaves[i],
+	    ip_mtrie_leaf_set_adj_index (a->cover_adj_index));
+	  old_ply->dst_address_bits_of_leaves[i] = a->cover_address_length;
+
+	  old_ply->n_non_empty_leafs +=
+	    ip_mtrie_leaf_is_non_empty (old_ply, i);
+
+	  ASSERT (old_ply->n_non_empty_leafs >= 0);
+	  if (old_ply->n_non_empty_leafs == 0 && dst_address_byte_index > 0)
+	    {
+	      pool_put (*pool, old_ply);
+	      /* Old ply was deleted. */
+	      return 1;
+	    }
+#if CLIB_DEBUG > 0
+	  else if (dst_address_byte_index)
+	    {
+	      int ii, count = 0;
+	      for (ii = 0; ii < ARRAY_LEN (old_ply->leaves); ii++)
+		{
+		  count += ip_mtrie_leaf_is_non_empty (old_ply, ii);
+		}
+	      ASSERT (count);
+	    }
+#endif
+	}
+    }
+
+  /* Old ply was not deleted. */
+  return 0;
+}
+
+/*
+ * The slot in a root ply of n_bits for the top n_bits of the address
+ * plus i.
+ */
+always_inline u32
+ip_mtrie_root_slot (const ip_mtrie_set_unset_leaf_args_t *a, u32 n_bits,
+		    u32 i)
+{
+  u32 slot;
+
+  slot = ((a->dst_address.as_u8[0] << 16) | (a->dst_address.as_u8[1] << 8) |
+	  a->dst_address.as_u8[2]) >>
+	 (24 - n_bits);
+  slot += i;
+
+  if (16 == n_bits)
+    return clib_host_to_net_u16 (slot);
+  return slot;
+}
+
+void
+ip_mtrie_set_root_leaf (ip_mtrie_8_ply_t **pool, ip_mtrie_leaf_t *leaves,
+			u8 *dst_address_bits_of_leaves, u32 n_bits,
+			const ip_mtrie_set_unset_leaf_args_t *a)
+{
+  ip_mtrie_leaf_t old_leaf, new_leaf;
+  i32 n_dst_bits_next_plies;
+  u32 slot;
+
+  ASSERT (16 == n_bits || 24 == n_bits);
+
+  /* how many bits of the destination address are in the next PLY */
+  n_dst_bits_next_plies = a->dst_address_length - n_bits;
+
+  /* Number of bits next plies <= 0 => insert leaves this ply. */
+  if (n_dst_bits_next_plies <= 0)
+    {
+      /* The mask length of the address to insert maps to this ply */
+      uword old_leaf_is_terminal;
+      u32 i, n_dst_bits_this_ply;
+
+      /* The number of bits, and hence slots/buckets, we will fill */
+      n_dst_bits_this_ply = n_bits - a->dst_address_length;
+
+      /* Starting at the value of the top bits of the address
+       * fill the buckets/slots of the ply */
+      for (i = 0; i < (1 << n_dst_bits_this_ply); i++)
+	{
+	  ip_mtrie_8_ply_t *new_ply;
+
+	  slot = ip_mtrie_root_slot (a, n_bits, i);
+
+	  old_leaf = leaves[slot];
+	  old_leaf_is_terminal = ip_mtrie_leaf_is_terminal (old_leaf);
+
+	  if (a->dst_address_length >= dst_address_bits_of_leaves[slot])
+	    {
+	      /* The new leaf is more or equally specific than the one currently
+	       * occupying the slot */
+	      new_leaf = ip_mtrie_leaf_set_adj_index (a->adj_index);
+
+	      if (old_leaf_is_terminal)
+		{
+		  /* The current leaf is terminal, we can replace it with
+		   * the new one */
+		  dst_address_bits_of_leaves[slot] = a->dst_address_length;
+		  clib_atomic_store_rel_n (&leaves[slot], new_leaf);
+		}
+	      else
+		{
+		  /* Existing leaf points to another ply.  We need to place
+		   * new_leaf into all more specific slots. */
+		  new_ply = get_next_ply_for_leaf (*pool, old_leaf);
+		  set_ply_with_more_specific_leaf (*pool, new_ply, new_leaf,
+						   a->dst_address_length);
+		}
+	    }
+	  else if (!old_leaf_is_terminal)
+	    {
+	      /* The current leaf is less specific and not termial (i.e. a ply),
+	       * recurse on down the trie */
+	      new_ply = get_next_ply_for_leaf (*pool, old_leaf);
+	      ip_mtrie_set_leaf (pool, a, new_ply - *pool, n_bits / 8);
+	    }
+	  /*
+	   * else
+	   *  the route we are adding is less specific than the leaf currently
+	   *  occupying this slot. leave it there
+	   */
+	}
+    }
+  else
+    {
+      /* The address to insert requires us to move down at a lower level of
+       * the trie - recurse on down */
+      ip_mtrie_8_ply_t *new_ply;
+
+      slot = ip_mtrie_root_slot (a, n_bits, 0);
+      old_leaf = leaves[slot];
+
+      if (ip_mtrie_leaf_is_terminal (old_leaf))
+	{
+	  /* There is a leaf occupying the slot. Replace it with a new ply */
+	  new_leaf = ply_create (pool, old_leaf,
+				 dst_address_bits_of_leaves[slot], n_bits);
+	  new_ply = get_next_ply_for_leaf (*pool, new_leaf);
+
+	  clib_atomic_store_rel_n (&leaves[slot], new_leaf);
+	  dst_address_bits_of_leaves[slot] = n_bits;
+	}
+      else
+	new_ply = get_next_ply_for_leaf (*pool, old_leaf);
+
+      ip_mtrie_set_leaf (pool, a, new_ply - *pool, n_bits / 8);
+    }
+}
+
+void
+ip_mtrie_unset_root_leaf (ip_mtrie_8_ply_t **pool, ip_mtrie_leaf_t *leaves,
+			  u8 *dst_address_bits_of_leaves, u32 n_bits,
+			  const ip_mtrie_set_unset_leaf_args_t *a)
+{
+  ip_mtrie_leaf_t old_leaf, del_leaf;
+  i32 n_dst_bits_next_plies;
+  i32 i, n_dst_bits_this_ply, old_leaf_is_terminal;
+  u32 slot;
+
+  ASSERT (16 == n_bits || 24 == n_bits);
+
+  n_dst_bits_next_plies = a->dst_address_length - n_bits;
+
+  n_dst_bits_this_ply =
+    (n_dst_bits_next_plies <= 0 ? (n_bits - a->dst_address_length) : 0);
+
+  del_leaf = ip_mtrie_leaf_set_adj_index (a->adj_index);
+
+  for (i = 0; i < (1 << n_dst_bits_this_ply); i++)
+    {
+      slot = ip_mtrie_root_slot (a, n_bits, i);
+
+      old_leaf = leaves[slot];
+      old_leaf_is_terminal = ip_mtrie_leaf_is_terminal (old_leaf);
+
+      if (old_leaf == del_leaf ||
+	  (!old_leaf_is_terminal &&
+	   ip_mtrie_unset_leaf (pool, a, get_next_ply_for_leaf (*pool, old_leaf),
+				n_bits / 8)))
+	{
+	  clib_atomic_store_rel_n (
+	    &leaves[slot], ip_mtrie_leaf_set_adj_index (a->cover_adj_index));
+	  dst_address_bits_of_leaves[slot] = a->cover_address_length;
+	}
+    }
+}
+
+/* Returns number of bytes of memory used by mtrie. */
+static uword
+mtrie_ply_memory_usage (ip_mtrie_8_ply_t *pool, ip_mtrie_8_ply_t *p)
+{
+  return (sizeof (p[0]) +
+	  ip_mtrie_leaves_memory_usage (pool, p->leaves,
+					ARRAY_LEN (p->leaves)));
+}
+
+uword
+ip_mtrie_leaves_memory_usage (ip_mtrie_8_ply_t *pool,
+			      const ip_mtrie_leaf_t *leaves, uword n_leaves)
+{
+  uword bytes, i;
+
+  bytes = 0;
+  for (i = 0; i < n_leaves; i++)
+    {
+      ip_mtrie_leaf_t l = leaves[i];
+      if (ip_mtrie_leaf_is_next_ply (l))
+	bytes += mtrie_ply_memory_usage (pool, get_next_ply_for_leaf (pool, l));
+    }
+
+  return bytes;
+}
@@ -0,0 +1,180 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#ifndef included_ip_ip_mtrie_h
+#define included_ip_ip_mtrie_h
+
+#include <vppinfra/cache.h>
+#include <vppinfra/pool.h>
+#include <vnet/ip/ip4_packet.h>
+#include <vnet/ip/ip6_packet.h>
+
+/**
+ * @brief The parts of the leaf pushed multibit trie that the ip4 and ip6
+ * mtries share: the leaf encoding, the 8 bit stride ply and the
+ * algorithms that add and remove routes from a root ply and the 8 bit
+ * plys below it. Each address family keeps its own root ply layouts and
+ * its own pool of 8 bit plys, which is passed to the functions here.
+ *
+ * Leaves are encoded as:
+ *   1 + 2*lb_index for terminal leaves.
+ *   0 + 2*next_ply_index for non-terminals, i.e. PLYs
+ *   1 => empty (adjacency index of zero is special miss adjacency).
+ */
+typedef u32 ip_mtrie_leaf_t;
+
+#define IP_MTRIE_LEAF_EMPTY (1 + 2 * 0)
+
+/**
+ * @brief One 8 bit stride ply.
+ */
+typedef struct ip_mtrie_8_ply_t_
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /**
+   * The leaves/slots/buckets to be filed with leafs
+   */
+  ip_mtrie_leaf_t leaves[256];
+
+  /**
+   * Prefix length for leaves/ply.
+   */
+  u8 dst_address_bits_of_leaves[256];
+
+  /**
+   * Number of non-empty leafs (whether terminal or not).
+   */
+  i32 n_non_empty_leafs;
+
+  /**
+   * The length of the ply's covering prefix. Also a measure of its depth
+   * If a leaf in a slot has a mask length longer than this then it is
+   * 'non-empty'. Otherwise it is the value of the cover.
+   */
+  i32 dst_address_bits_base;
+} ip_mtrie_8_ply_t;
+
+STATIC_ASSERT (0 == sizeof (ip_mtrie_8_ply_t) % CLIB_CACHE_LINE_BYTES,
+	       "IP Mtrie ply cache line");
+
+/**
+ * @brief A route to add or remove. The address is masked to its length
+ * and the ip4 address, like the ip6 one, starts at its first byte.
+ */
+typedef struct ip_mtrie_set_unset_leaf_args_t_
+{
+  union
+  {
+    ip4_address_t ip4;
+    ip6_address_t ip6;
+    u8 as_u8[16];
+  } dst_address;
+  u32 dst_address_length;
+  u32 adj_index;
+  u32 cover_address_length;
+  u32 cover_adj_index;
+} ip_mtrie_set_unset_leaf_args_t;
+
+/**
+ * Is the leaf terminal (i.e. an LB index) or non-terminal (i.e. a PLY index)
+ */
+always_inline u32
+ip_mtrie_leaf_is_terminal (ip_mtrie_leaf_t n)
+{
+  return n & 1;
+}
+
+/**
+ * From the stored slot value extract the LB index value
+ */
+always_inline u32
+ip_mtrie_leaf_get_adj_index (ip_mtrie_leaf_t n)
+{
+  ASSERT (ip_mtrie_leaf_is_terminal (n));
+  return n >> 1;
+}
+
+always_inline ip_mtrie_leaf_t
+ip_mtrie_leaf_set_adj_index (u32 adj_index)
+{
+  ip_mtrie_leaf_t l;
+  l = 1 + 2 * adj_index;
+  ASSERT (ip_mtrie_leaf_get_adj_index (l) == adj_index);
+  return l;
+}
+
+always_inline u32
+ip_mtrie_leaf_is_next_ply (ip_mtrie_leaf_t n)
+{
+  return (n & 1) == 0;
+}
+
+always_inline u32
+ip_mtrie_leaf_get_next_ply_index (ip_mtrie_leaf_t n)
+{
+  ASSERT (ip_mtrie_leaf_is_next_ply (n));
+  return n >> 1;
+}
+
+always_inline ip_mtrie_leaf_t
+ip_mtrie_leaf_set_next_ply_index (u32 i)
+{
+  ip_mtrie_leaf_t l;
+  l = 0 + 2 * i;
+  ASSERT (ip_mtrie_leaf_get_next_ply_index (l) == i);
+  return l;
+}
+
+always_inline u32
+ip_mtrie_leaf_is_non_empty (ip_mtrie_8_ply_t *p, u8 dst_byte)
+{
+  /*
+   * It's 'non-empty' if the length of the leaf stored is greater than the
+   * length of a leaf in the covering ply. i.e. the leaf is more specific
+   * than it's would be cover in the covering ply
+   */
+  if (p->dst_address_bits_of_leaves[dst_byte] > p->dst_address_bits_base)
+    return (1);
+  return (0);
+}
+
+extern void ip_mtrie_ply_8_init (ip_mtrie_8_ply_t *p, ip_mtrie_leaf_t init,
+				 uword prefix_len, u32 ply_base_len);
+
+/**
+ * @brief Add/remove a route to/from the 8 bit ply, and the plys below it,
+ * that holds the given byte of the address.
+ */
+extern void ip_mtrie_set_leaf (ip_mtrie_8_ply_t **pool,
+			       const ip_mtrie_set_unset_leaf_args_t *a,
+			       u32 old_ply_index, u32 dst_address_byte_index);
+extern uword ip_mtrie_unset_leaf (ip_mtrie_8_ply_t **pool,
+				  const ip_mtrie_set_unset_leaf_args_t *a,
+				  ip_mtrie_8_ply_t *old_ply,
+				  u32 dst_address_byte_index);
+
+/**
+ * @brief Add/remove a route to/from a root ply of n_bits, 16 or 24, and
+ * the 8 bit plys below it. A 16 bit root is indexed by the first two
+ * bytes of the address as they are loaded from the packet, a 24 bit root
+ * by the top 24 bits of the address in host byte order.
+ */
+extern void ip_mtrie_set_root_leaf (ip_mtrie_8_ply_t **pool,
+				    ip_mtrie_leaf_t *leaves,
+				    u8 *dst_address_bits_of_leaves, u32 n_bits,
+				    const ip_mtrie_set_unset_leaf_args_t *a);
+extern void ip_mtrie_unset_root_leaf (ip_mtrie_8_ply_t **pool,
+				      ip_mtrie_leaf_t *leaves,
+				      u8 *dst_address_bits_of_leaves,
+				      u32 n_bits,
+				      const ip_mtrie_set_unset_leaf_args_t *a);
+
+/**
+ * @brief Memory used by the 8 bit plys below a set of leaves.
+ */
+extern uword ip_mtrie_leaves_memory_usage (ip_mtrie_8_ply_t *pool,
+					   const ip_mtrie_leaf_t *leaves,
+					   uword n_leaves);
+
+#endif /* included_ip_ip_mtrie_h */
@@ -598,6 +598,18 @@ vl_api_ip_route_add_del_v2_reply_t_handler (
 {
 }
 
+static int
+api_ip_route_add_del_bulk (vat_main_t *vam)
+{
+  return -1;
+}
+
+static void
+vl_api_ip_route_add_del_bulk_reply_t_handler (
+  vl_api_ip_route_add_del_bulk_reply_t *mp)
+{
+}
+
 static void
 vl_api_ip_route_details_t_handler (vl_api_ip_route_details_t *mp)
 {
@@ -250,6 +250,7 @@ vnet_ip_route_cmd (vlib_main_t * vm,
   dpo_id_t dpo = DPO_INVALID, *dpos = NULL;
   fib_route_path_t *rpaths = NULL, rpath;
   fib_prefix_t *prefixs = NULL, pfx;
+  fib_entry_flag_t entry_flags;
   clib_error_t *error = NULL;
   f64 count;
   int i;
@@ -257,6 +258,7 @@ vnet_ip_route_cmd (vlib_main_t * vm,
   is_del = 0;
   table_id = 0;
   count = 1;
+  entry_flags = FIB_ENTRY_FLAG_NONE;
   clib_memset (&pfx, 0, sizeof (pfx));
 
   /* Get a line of input. */
@@ -295,6 +297,8 @@ vnet_ip_route_cmd (vlib_main_t * vm,
 	{
 	  vec_add1 (dpos, dpo);
 	}
+      else if (unformat (line_input, "resilient"))
+	entry_flags |= FIB_ENTRY_FLAG_RESILIENT;
       else if (unformat (line_input, "del"))
 	is_del = 1;
       else if (unformat (line_input, "add"))
@@ -384,10 +388,8 @@ vnet_ip_route_cmd (vlib_main_t * vm,
 		fib_table_entry_path_remove2 (fib_index,
 					      &rpfx, FIB_SOURCE_CLI, rpaths);
 	      else
-		fib_table_entry_path_add2 (fib_index,
-					   &rpfx,
-					   FIB_SOURCE_CLI,
-					   FIB_ENTRY_FLAG_NONE, rpaths);
+		fib_table_entry_path_add2 (fib_index, &rpfx, FIB_SOURCE_CLI,
+					   entry_flags, rpaths);
 
 	      fib_prefix_increment (&prefixs[i]);
 	    }
@@ -606,6 +608,9 @@ VLIB_CLI_COMMAND (vlib_cli_show_ip6_command, static) = {
  * second path, 1/4 following the first path:
  * @cliexcmd{ip route add 7.0.0.1/32 via 6.0.0.1 GigabitEthernet2/0/0 weight 1}
  * @cliexcmd{ip route add 7.0.0.1/32 via 6.0.0.2 GigabitEthernet2/0/0 weight 3}
+ * To keep flows on their path when other paths are added or removed, use
+ * resilient hashing:
+ * @cliexcmd{ip route add 7.0.0.2/32 via 6.0.0.1 GigabitEthernet2/0/0 resilient}
  * To add a route to a particular FIB table (VRF), use:
  * @cliexcmd{ip route add 172.16.24.0/24 table 7 via GigabitEthernet2/0/0}
  * To add a route to drop the traffic:
@@ -619,7 +624,8 @@ VLIB_CLI_COMMAND (ip_route_command, static) = {
 		"<value>] [udp-encap <value>] [ip4-lookup-in-table <value>] "
 		"[ip6-lookup-in-table <value>] [mpls-lookup-in-table <value>] "
 		"[resolve-via-host] [resolve-via-connected] [rx-ip4|rx-ip6 "
-		"<interface>] [out-labels <value value value>] [drop]",
+		"<interface>] [out-labels <value value value>] [drop] "
+		"[resilient]",
   .function = vnet_ip_route_cmd,
   .is_mp_safe = 1,
 };
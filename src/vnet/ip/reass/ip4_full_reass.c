@@ -122,6 +122,14 @@ ip4_full_reass_buffer_get_data_len (vlib_buffer_t * b)
      ip4_full_reass_buffer_get_data_offset (b)) + 1;
 }
 
+/* a range of the chain, as found in the buffer opaque of its first buffer */
+typedef struct
+{
+  u16 range_first;
+  u16 range_last;
+  u32 range_bi;
+} ip4_full_reass_range_t;
+
 typedef struct
 {
   // hash table key
@@ -151,11 +159,16 @@ typedef struct
   // thread which received fragment with offset 0 and which sends out the
   // completed reassembly
   clib_thread_index_t sendout_thread_index;
+  // ranges of the chain sorted by offset, so a fragment overlapping none of
+  // them is placed without walking the chain
+  ip4_full_reass_range_t *ranges;
 } ip4_full_reass_t;
 
 typedef struct
 {
   ip4_full_reass_t *pool;
+  // range index vectors of freed contexts, for reuse
+  ip4_full_reass_range_t **free_ranges;
   u32 reass_n;
   u32 id_counter;
   // for pacing the main thread timeouts
@@ -406,6 +419,12 @@ always_inline void
 ip4_full_reass_free_ctx (ip4_full_reass_per_thread_t * rt,
 			 ip4_full_reass_t * reass)
 {
+  if (reass->ranges)
+    {
+      vec_reset_length (reass->ranges);
+      vec_add1 (rt->free_ranges, reass->ranges);
+      reass->ranges = NULL;
+    }
   pool_put (rt->pool, reass);
   --rt->reass_n;
 }
@@ -532,6 +551,52 @@ sanitize_reass_buffers_add_missing (vlib_main_t *vm, ip4_full_reass_t *reass,
     }
 }
 
+/* Index of the first range ending at or after offset, or the number of
+ * ranges if there is none. */
+always_inline u32
+ip4_full_reass_ranges_search (ip4_full_reass_t *reass, u32 offset)
+{
+  u32 lo = 0, hi = vec_len (reass->ranges), mid;
+
+  while (lo < hi)
+    {
+      mid = (lo + hi) / 2;
+      if (reass->ranges[mid].range_last < offset)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+always_inline void
+ip4_full_reass_ranges_insert (ip4_full_reass_t *reass, u32 index,
+			      vnet_buffer_opaque_t *vnb, u32 bi)
+{
+  ip4_full_reass_range_t r = {
+    .range_first = vnb->ip.reass.range_first,
+    .range_last = vnb->ip.reass.range_last,
+    .range_bi = bi,
+  };
+  vec_insert_elts (reass->ranges, &r, 1, index);
+}
+
+/* after the chain was changed by a fragment overlapping some ranges */
+always_inline void
+ip4_full_reass_ranges_rebuild (vlib_main_t *vm, ip4_full_reass_t *reass)
+{
+  u32 bi = reass->first_bi;
+  vnet_buffer_opaque_t *vnb;
+
+  vec_reset_length (reass->ranges);
+  while (~0 != bi)
+    {
+      vnb = vnet_buffer (vlib_get_buffer (vm, bi));
+      ip4_full_reass_ranges_insert (reass, vec_len (reass->ranges), vnb, bi);
+      bi = vnb->ip.reass.next_range_bi;
+    }
+}
+
 always_inline void
 ip4_full_reass_init (ip4_full_reass_t * reass)
 {
@@ -546,7 +611,8 @@ always_inline ip4_full_reass_t *
 ip4_full_reass_find_or_create (vlib_main_t *vm, vlib_node_runtime_t *node,
 			       ip4_full_reass_main_t *rm,
 			       ip4_full_reass_per_thread_t *rt,
-			       ip4_full_reass_kv_t *kv, u8 *do_handoff)
+			       ip4_full_reass_kv_t *kv, u64 hash,
+			       u8 *do_handoff)
 {
   ip4_full_reass_t *reass;
   f64 now;
@@ -555,7 +621,8 @@ again:
 
   reass = NULL;
   now = vlib_time_now (vm);
-  if (!clib_bihash_search_16_8 (&rm->hash, &kv->kv, &kv->kv))
+  if (!clib_bihash_search_inline_2_with_hash_16_8 (&rm->hash, hash, &kv->kv,
+						     &kv->kv))
     {
       if (vm->thread_index != kv->v.memory_owner_thread_index)
 	{
@@ -592,6 +659,8 @@ again:
     {
       pool_get (rt->pool, reass);
       clib_memset (reass, 0, sizeof (*reass));
+      if (vec_len (rt->free_ranges))
+	reass->ranges = vec_pop (rt->free_ranges);
       reass->id = ((u64) vm->thread_index * 1000000000) + rt->id_counter;
       reass->memory_owner_thread_index = vm->thread_index;
       ++rt->id_counter;
@@ -604,7 +673,7 @@ again:
   kv->v.memory_owner_thread_index = vm->thread_index;
   reass->last_heard = now;
 
-  int rv = clib_bihash_add_del_16_8 (&rm->hash, &kv->kv, 2);
+  int rv = clib_bihash_add_del_with_hash_16_8 (&rm->hash, &kv->kv, hash, 2);
   if (rv)
     {
       ip4_full_reass_free_ctx (rt, reass);
@@ -960,6 +1029,7 @@ ip4_full_reass_update (vlib_main_t *vm, vlib_node_runtime_t *node,
 	{
 	  return rc;
 	}
+      ip4_full_reass_ranges_insert (reass, 0, fvnb, *bi0);
       if (PREDICT_FALSE (fb->flags & VLIB_BUFFER_IS_TRACED))
 	{
 	  ip4_full_reass_add_trace (vm, node, reass, *bi0, RANGE_NEW, 0, ~0);
@@ -972,6 +1042,23 @@ ip4_full_reass_update (vlib_main_t *vm, vlib_node_runtime_t *node,
   reass->min_fragment_length =
     clib_min (clib_net_to_host_u16 (fip->length),
 	      fvnb->ip.reass.estimated_mtu);
+  // most fragments overlap nothing, the index tells where they go
+  u32 index = ip4_full_reass_ranges_search (reass, fragment_first);
+  int overlaps = index < vec_len (reass->ranges) &&
+		 fragment_last >= reass->ranges[index].range_first;
+  if (!overlaps)
+    {
+      prev_range_bi = index ? reass->ranges[index - 1].range_bi : ~0;
+      rc = ip4_full_reass_insert_range_in_chain (vm, reass, prev_range_bi,
+						 *bi0);
+      if (IP4_REASS_RC_OK != rc)
+	{
+	  return rc;
+	}
+      ip4_full_reass_ranges_insert (reass, index, fvnb, *bi0);
+      consumed = 1;
+      candidate_range_bi = ~0;
+    }
   while (~0 != candidate_range_bi)
     {
       vlib_buffer_t *candidate_b = vlib_get_buffer (vm, candidate_range_bi);
@@ -1117,6 +1204,10 @@ ip4_full_reass_update (vlib_main_t *vm, vlib_node_runtime_t *node,
 	}
       break;
     }
+  if (overlaps)
+    {
+      ip4_full_reass_ranges_rebuild (vm, reass);
+    }
   ++reass->fragments_n;
   if (consumed)
     {
@@ -1168,6 +1259,41 @@ ip4_full_reass_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   ip4_full_reass_main_t *rm = &ip4_full_reass_main;
   ip4_full_reass_per_thread_t *rt = &rm->per_thread_data[vm->thread_index];
   u16 nexts[VLIB_FRAME_SIZE];
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE];
+  ip4_full_reass_kv_t kvs[VLIB_FRAME_SIZE];
+  u64 hashes[VLIB_FRAME_SIZE];
+  u8 is_fragment[VLIB_FRAME_SIZE];
+  u32 i;
+
+  /* Hash the keys of all fragments of the frame first and load their
+   * buckets, the lookups below then find them in cache. The lookups
+   * themselves are done in order, as each fragment may create or finish
+   * the reassembly the next one belongs to. */
+  vlib_get_buffers (vm, from, bufs, frame->n_vectors);
+  for (i = 0; i < frame->n_vectors; i++)
+    {
+      vlib_buffer_t *b = bufs[i];
+      ip4_header_t *ip = vlib_buffer_get_current (b);
+
+      is_fragment[i] = ip4_get_fragment_more (ip) ||
+		       ip4_get_fragment_offset (ip);
+      if (!is_fragment[i])
+	continue;
+
+      kvs[i].k.fib_index =
+	(vnet_buffer (b)->sw_if_index[VLIB_TX] == (u32) ~0) ?
+	  vec_elt (ip4_main.fib_index_by_sw_if_index,
+		   vnet_buffer (b)->sw_if_index[VLIB_RX]) :
+	  vnet_buffer (b)->sw_if_index[VLIB_TX];
+      kvs[i].k.src.as_u32 = ip->src_address.as_u32;
+      kvs[i].k.dst.as_u32 = ip->dst_address.as_u32;
+      kvs[i].k.frag_id = ip->fragment_id;
+      kvs[i].k.proto = ip->protocol;
+      kvs[i].k.unused = 0;
+      kvs[i].v.as_u64 = 0;
+      hashes[i] = clib_bihash_hash_16_8 (&kvs[i].kv);
+      clib_bihash_prefetch_bucket_16_8 (&rm->hash, hashes[i]);
+    }
 
   clib_spinlock_lock (&rt->lock);
 
@@ -1179,11 +1305,15 @@ ip4_full_reass_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
       u32 next0;
       u32 error0 = IP4_ERROR_NONE;
 
+      i = frame->n_vectors - n_left;
+      if (n_left > 4 && is_fragment[i + 4])
+	clib_bihash_prefetch_data_16_8 (&rm->hash, hashes[i + 4]);
+
       bi0 = from[0];
-      b0 = vlib_get_buffer (vm, bi0);
+      b0 = bufs[i];
 
       ip4_header_t *ip0 = vlib_buffer_get_current (b0);
-      if (!ip4_get_fragment_more (ip0) && !ip4_get_fragment_offset (ip0))
+      if (!is_fragment[i])
 	{
 	  // this is a whole packet - no fragmentation
 	  if (CUSTOM != type)
@@ -1223,22 +1353,11 @@ ip4_full_reass_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  goto packet_enqueue;
 	}
 
-      u32 fib_index = (vnet_buffer (b0)->sw_if_index[VLIB_TX] == (u32) ~0) ?
-			      vec_elt (ip4_main.fib_index_by_sw_if_index,
-				 vnet_buffer (b0)->sw_if_index[VLIB_RX]) :
-			      vnet_buffer (b0)->sw_if_index[VLIB_TX];
-
-      ip4_full_reass_kv_t kv = { .k.fib_index = fib_index,
-				 .k.src.as_u32 = ip0->src_address.as_u32,
-				 .k.dst.as_u32 = ip0->dst_address.as_u32,
-				 .k.frag_id = ip0->fragment_id,
-				 .k.proto = ip0->protocol
-
-      };
+      ip4_full_reass_kv_t kv = kvs[i];
       u8 do_handoff = 0;
 
-      ip4_full_reass_t *reass =
-	ip4_full_reass_find_or_create (vm, node, rm, rt, &kv, &do_handoff);
+      ip4_full_reass_t *reass = ip4_full_reass_find_or_create (
+	vm, node, rm, rt, &kv, hashes[i], &do_handoff);
 
       if (reass)
 	{
@@ -1487,24 +1606,7 @@ typedef enum
   IP4_EVENT_CONFIG_CHANGED = 1,
 } ip4_full_reass_event_t;
 
-typedef struct
-{
-  int failure;
-  clib_bihash_16_8_t *new_hash;
-} ip4_rehash_cb_ctx;
-
 #ifndef CLIB_MARCH_VARIANT
-static int
-ip4_rehash_cb (clib_bihash_kv_16_8_t * kv, void *_ctx)
-{
-  ip4_rehash_cb_ctx *ctx = _ctx;
-  if (clib_bihash_add_del_16_8 (ctx->new_hash, kv, 1))
-    {
-      ctx->failure = 1;
-    }
-  return (BIHASH_WALK_CONTINUE);
-}
-
 static void
 ip4_full_reass_set_params (u32 timeout_ms, u32 max_reassemblies,
 			   u32 max_reassembly_length,
@@ -1517,41 +1619,33 @@ ip4_full_reass_set_params (u32 timeout_ms, u32 max_reassemblies,
   ip4_full_reass_main.expire_walk_interval_ms = expire_walk_interval_ms;
 }
 
+/* Contexts are taken from the per-thread pools in the data path, so the
+ * pools are sized for max_reass_n up front and never grow there. */
+static void
+ip4_full_reass_pools_reserve (ip4_full_reass_main_t *rm)
+{
+  ip4_full_reass_per_thread_t *rt;
+
+  vec_foreach (rt, rm->per_thread_data)
+    {
+      clib_spinlock_lock (&rt->lock);
+      if (vec_max_len (rt->pool) < rm->max_reass_n)
+	pool_alloc (rt->pool, rm->max_reass_n - vec_len (rt->pool));
+      clib_spinlock_unlock (&rt->lock);
+    }
+}
+
 vnet_api_error_t
 ip4_full_reass_set (u32 timeout_ms, u32 max_reassemblies,
 		    u32 max_reassembly_length, u32 expire_walk_interval_ms)
 {
-  u32 old_nbuckets = ip4_full_reass_get_nbuckets ();
   ip4_full_reass_set_params (timeout_ms, max_reassemblies,
 			     max_reassembly_length, expire_walk_interval_ms);
+  ip4_full_reass_pools_reserve (&ip4_full_reass_main);
   vlib_process_signal_event (ip4_full_reass_main.vlib_main,
 			     ip4_full_reass_main.ip4_full_reass_expire_node_idx,
 			     IP4_EVENT_CONFIG_CHANGED, 0);
-  u32 new_nbuckets = ip4_full_reass_get_nbuckets ();
-  if (ip4_full_reass_main.max_reass_n > 0 && new_nbuckets > old_nbuckets)
-    {
-      clib_bihash_16_8_t new_hash;
-      clib_memset (&new_hash, 0, sizeof (new_hash));
-      ip4_rehash_cb_ctx ctx;
-      ctx.failure = 0;
-      ctx.new_hash = &new_hash;
-      clib_bihash_init_16_8 (&new_hash, "ip4-dr", new_nbuckets,
-			     new_nbuckets * 1024);
-      clib_bihash_foreach_key_value_pair_16_8 (&ip4_full_reass_main.hash,
-					       ip4_rehash_cb, &ctx);
-      if (ctx.failure)
-	{
-	  clib_bihash_free_16_8 (&new_hash);
-	  return -1;
-	}
-      else
-	{
-	  clib_bihash_free_16_8 (&ip4_full_reass_main.hash);
-	  clib_memcpy_fast (&ip4_full_reass_main.hash, &new_hash,
-			    sizeof (ip4_full_reass_main.hash));
-	  clib_bihash_copied (&ip4_full_reass_main.hash, &new_hash);
-	}
-    }
+  /* the table doubles its buckets by itself as reassemblies come in */
   return 0;
 }
 
@@ -1572,6 +1666,7 @@ ip4_full_reass_init_function (vlib_main_t * vm)
 {
   ip4_full_reass_main_t *rm = &ip4_full_reass_main;
   clib_error_t *error = 0;
+  clib_bihash_init2_args_16_8_t _a, *a = &_a;
   u32 nbuckets;
   vlib_node_t *node;
 
@@ -1582,7 +1677,6 @@ ip4_full_reass_init_function (vlib_main_t * vm)
   vec_foreach (rt, rm->per_thread_data)
   {
     clib_spinlock_init (&rt->lock);
-    pool_alloc (rt->pool, rm->max_reass_n);
   }
 
   node = vlib_get_node_by_name (vm, (u8 *) "ip4-full-reassembly-expire-walk");
@@ -1593,9 +1687,18 @@ ip4_full_reass_init_function (vlib_main_t * vm)
 			     IP4_REASS_MAX_REASSEMBLIES_DEFAULT,
 			     IP4_REASS_MAX_REASSEMBLY_LENGTH_DEFAULT,
 			     IP4_REASS_EXPIRE_WALK_INTERVAL_DEFAULT_MS);
+  ip4_full_reass_pools_reserve (rm);
 
   nbuckets = ip4_full_reass_get_nbuckets ();
-  clib_bihash_init_16_8 (&rm->hash, "ip4-dr", nbuckets, nbuckets * 1024);
+  clib_memset (a, 0, sizeof (*a));
+  a->h = &rm->hash;
+  a->name = "ip4-dr";
+  a->nbuckets = nbuckets;
+  a->memory_size = (uword) nbuckets * 1024;
+  /* grow with max_reass_n, finding old entries while the buckets move */
+  a->auto_resize = 1;
+  a->reclaim_fn = vlib_rcu_call;
+  clib_bihash_init2_16_8 (a);
 
   rm->fq_index = vlib_frame_queue_main_init (ip4_full_reass_node.index, 0);
   rm->fq_local_index =
@@ -102,6 +102,14 @@ ip6_full_reass_buffer_get_data_len (vlib_buffer_t * b)
      ip6_full_reass_buffer_get_data_offset (b)) + 1;
 }
 
+/* a range of the chain, as found in the buffer opaque of its first buffer */
+typedef struct
+{
+  u16 range_first;
+  u16 range_last;
+  u32 range_bi;
+} ip6_full_reass_range_t;
+
 typedef struct
 {
   // hash table key
@@ -131,11 +139,16 @@ typedef struct
   // thread which received fragment with offset 0 and which sends out the
   // completed reassembly
   u32 sendout_thread_index;
+  // ranges of the chain sorted by offset, so a fragment overlapping none of
+  // them is placed without walking the chain
+  ip6_full_reass_range_t *ranges;
 } ip6_full_reass_t;
 
 typedef struct
 {
   ip6_full_reass_t *pool;
+  // range index vectors of freed contexts, for reuse
+  ip6_full_reass_range_t **free_ranges;
   u32 reass_n;
   u32 id_counter;
   // for pacing the main thread timeouts
@@ -403,6 +416,12 @@ always_inline void
 ip6_full_reass_free_ctx (ip6_full_reass_per_thread_t * rt,
 			 ip6_full_reass_t * reass)
 {
+  if (reass->ranges)
+    {
+      vec_reset_length (reass->ranges);
+      vec_add1 (rt->free_ranges, reass->ranges);
+      reass->ranges = NULL;
+    }
   pool_put (rt->pool, reass);
   --rt->reass_n;
 }
@@ -594,7 +613,7 @@ always_inline ip6_full_reass_t *
 ip6_full_reass_find_or_create (vlib_main_t *vm, vlib_node_runtime_t *node,
 			       ip6_full_reass_main_t *rm,
 			       ip6_full_reass_per_thread_t *rt,
-			       ip6_full_reass_kv_t *kv, u32 *icmp_bi,
+			       ip6_full_reass_kv_t *kv, u64 hash, u32 *icmp_bi,
 			       u8 *do_handoff, int skip_bihash,
 			       u32 *n_left_to_next, u32 **to_next)
 {
@@ -606,7 +625,8 @@ again:
   reass = NULL;
   now = vlib_time_now (vm);
 
-  if (!skip_bihash && !clib_bihash_search_48_8 (&rm->hash, &kv->kv, &kv->kv))
+  if (!skip_bihash && !clib_bihash_search_inline_2_with_hash_48_8 (
+			 &rm->hash, hash, &kv->kv, &kv->kv))
     {
       if (vm->thread_index != kv->v.memory_owner_thread_index)
 	{
@@ -645,6 +665,8 @@ again:
     {
       pool_get (rt->pool, reass);
       clib_memset (reass, 0, sizeof (*reass));
+      if (vec_len (rt->free_ranges))
+	reass->ranges = vec_pop (rt->free_ranges);
       reass->id = ((u64) vm->thread_index * 1000000000) + rt->id_counter;
       ++rt->id_counter;
       reass->first_bi = ~0;
@@ -669,7 +691,8 @@ again:
       reass->key.as_u64[4] = kv->kv.key[4];
       reass->key.as_u64[5] = kv->kv.key[5];
 
-      int rv = clib_bihash_add_del_48_8 (&rm->hash, &kv->kv, 2);
+      int rv =
+	clib_bihash_add_del_with_hash_48_8 (&rm->hash, &kv->kv, hash, 2);
       if (rv)
 	{
 	  ip6_full_reass_free (rm, rt, reass);
@@ -932,6 +955,36 @@ free_buffers_and_return:
   return rv;
 }
 
+/* Index of the first range ending at or after offset, or the number of
+ * ranges if there is none. */
+always_inline u32
+ip6_full_reass_ranges_search (ip6_full_reass_t *reass, u32 offset)
+{
+  u32 lo = 0, hi = vec_len (reass->ranges), mid;
+
+  while (lo < hi)
+    {
+      mid = (lo + hi) / 2;
+      if (reass->ranges[mid].range_last < offset)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+always_inline void
+ip6_full_reass_ranges_insert (ip6_full_reass_t *reass, u32 index,
+			      vnet_buffer_opaque_t *vnb, u32 bi)
+{
+  ip6_full_reass_range_t r = {
+    .range_first = vnb->ip.reass.range_first,
+    .range_last = vnb->ip.reass.range_last,
+    .range_bi = bi,
+  };
+  vec_insert_elts (reass->ranges, &r, 1, index);
+}
+
 always_inline void
 ip6_full_reass_insert_range_in_chain (vlib_main_t * vm,
 				      ip6_full_reass_t * reass,
@@ -998,7 +1051,6 @@ ip6_full_reass_update (vlib_main_t *vm, vlib_node_runtime_t *node,
   u32 fragment_last = fvnb->ip.reass.fragment_last =
     fragment_first + fragment_length - 1;
   int more_fragments = ip6_frag_hdr_more (frag_hdr);
-  u32 candidate_range_bi = reass->first_bi;
   u32 prev_range_bi = ~0;
   fvnb->ip.reass.range_first = fragment_first;
   fvnb->ip.reass.range_last = fragment_last;
@@ -1011,6 +1063,7 @@ ip6_full_reass_update (vlib_main_t *vm, vlib_node_runtime_t *node,
     {
       // starting a new reassembly
       ip6_full_reass_insert_range_in_chain (vm, reass, prev_range_bi, *bi0);
+      ip6_full_reass_ranges_insert (reass, 0, fvnb, *bi0);
       reass->min_fragment_length = clib_net_to_host_u16 (fip->payload_length);
       consumed = 1;
       reass->fragments_n = 1;
@@ -1019,49 +1072,30 @@ ip6_full_reass_update (vlib_main_t *vm, vlib_node_runtime_t *node,
   reass->min_fragment_length =
     clib_min (clib_net_to_host_u16 (fip->payload_length),
 	      fvnb->ip.reass.estimated_mtu);
-  while (~0 != candidate_range_bi)
+  u32 index = ip6_full_reass_ranges_search (reass, fragment_first);
+  if (index == vec_len (reass->ranges) ||
+      fragment_last < reass->ranges[index].range_first)
     {
-      vlib_buffer_t *candidate_b = vlib_get_buffer (vm, candidate_range_bi);
-      vnet_buffer_opaque_t *candidate_vnb = vnet_buffer (candidate_b);
-      if (fragment_first > candidate_vnb->ip.reass.range_last)
-	{
-	  // this fragments starts after candidate range
-	  prev_range_bi = candidate_range_bi;
-	  candidate_range_bi = candidate_vnb->ip.reass.next_range_bi;
-	  if (candidate_vnb->ip.reass.range_last < fragment_last &&
-	      ~0 == candidate_range_bi)
-	    {
-	      // special case - this fragment falls beyond all known ranges
-	      ip6_full_reass_insert_range_in_chain (vm, reass, prev_range_bi,
-						    *bi0);
-	      consumed = 1;
-	      break;
-	    }
-	  continue;
-	}
-      if (fragment_last < candidate_vnb->ip.reass.range_first)
-	{
-	  // this fragment ends before candidate range without any overlap
-	  ip6_full_reass_insert_range_in_chain (vm, reass, prev_range_bi,
-						*bi0);
-	  consumed = 1;
-	}
-      else if (fragment_first == candidate_vnb->ip.reass.range_first &&
-	       fragment_last == candidate_vnb->ip.reass.range_last)
-	{
-	  // duplicate fragment - ignore
-	}
-      else
+      // this fragment overlaps no range
+      prev_range_bi = index ? reass->ranges[index - 1].range_bi : ~0;
+      ip6_full_reass_insert_range_in_chain (vm, reass, prev_range_bi, *bi0);
+      ip6_full_reass_ranges_insert (reass, index, fvnb, *bi0);
+      consumed = 1;
+    }
+  else if (fragment_first == reass->ranges[index].range_first &&
+	   fragment_last == reass->ranges[index].range_last)
+    {
+      // duplicate fragment - ignore
+    }
+  else
+    {
+      // overlapping fragment - not allowed by RFC 8200
+      if (PREDICT_FALSE (fb->flags & VLIB_BUFFER_IS_TRACED))
 	{
-	  // overlapping fragment - not allowed by RFC 8200
-	  if (PREDICT_FALSE (fb->flags & VLIB_BUFFER_IS_TRACED))
-	    {
-	      ip6_full_reass_add_trace (vm, node, reass, *bi0, frag_hdr,
-					RANGE_OVERLAP, ~0);
-	    }
-	  return IP6_FULL_REASS_RC_OVERLAP;
+	  ip6_full_reass_add_trace (vm, node, reass, *bi0, frag_hdr,
+				    RANGE_OVERLAP, ~0);
 	}
-      break;
+      return IP6_FULL_REASS_RC_OVERLAP;
     }
   ++reass->fragments_n;
 check_if_done_maybe:
@@ -1184,6 +1218,29 @@ ip6_full_reass_verify_packet_size_lt_64k (vlib_main_t *vm,
   return true;
 }
 
+always_inline void
+ip6_full_reass_make_key (vlib_buffer_t *b, ip6_header_t *ip,
+			 ip6_frag_hdr_t *frag_hdr, ip6_full_reass_kv_t *kv)
+{
+  u32 fib_index = (vnet_buffer (b)->sw_if_index[VLIB_TX] == (u32) ~0) ?
+		    vec_elt (ip6_main.fib_index_by_sw_if_index,
+			     vnet_buffer (b)->sw_if_index[VLIB_RX]) :
+		    vnet_buffer (b)->sw_if_index[VLIB_TX];
+  kv->k.as_u64[0] = ip->src_address.as_u64[0];
+  kv->k.as_u64[1] = ip->src_address.as_u64[1];
+  kv->k.as_u64[2] = ip->dst_address.as_u64[0];
+  kv->k.as_u64[3] = ip->dst_address.as_u64[1];
+  kv->k.as_u64[4] = ((u64) fib_index) << 32 | (u64) frag_hdr->identification;
+  /* RFC 8200: The Next Header values in the Fragment headers of
+   * different fragments of the same original packet may differ.
+   * Only the value from the Offset zero fragment packet is used
+   * for reassembly.
+   *
+   * Also, IPv6 Header doesnt contain the protocol value unlike
+   * IPv4.*/
+  kv->k.as_u64[5] = 0;
+}
+
 always_inline uword
 ip6_full_reassembly_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 			    vlib_frame_t *frame, bool is_feature,
@@ -1193,6 +1250,37 @@ ip6_full_reassembly_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   u32 n_left_from, n_left_to_next, *to_next, next_index;
   ip6_full_reass_main_t *rm = &ip6_full_reass_main;
   ip6_full_reass_per_thread_t *rt = &rm->per_thread_data[vm->thread_index];
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE];
+  u64 hashes[VLIB_FRAME_SIZE];
+  u8 is_hashed[VLIB_FRAME_SIZE];
+  u32 i;
+
+  /* Hash the keys of the fragments of the frame first and load their
+   * buckets, the lookups below then find them in cache. Only fragment
+   * headers right after the IPv6 header, as nearly all are, are looked
+   * for here, the others are hashed when their turn comes. The lookups
+   * themselves are done in order, as each fragment may create or finish
+   * the reassembly the next one belongs to. */
+  vlib_get_buffers (vm, from, bufs, frame->n_vectors);
+  for (i = 0; i < frame->n_vectors; i++)
+    {
+      vlib_buffer_t *b = bufs[i];
+      ip6_header_t *ip = vlib_buffer_get_current (b);
+      ip6_frag_hdr_t *frag_hdr = (ip6_frag_hdr_t *) (ip + 1);
+      ip6_full_reass_kv_t kv;
+
+      is_hashed[i] =
+	ip->protocol == IP_PROTOCOL_IPV6_FRAGMENTATION &&
+	b->current_length >= sizeof (*ip) + sizeof (*frag_hdr) &&
+	(ip6_frag_hdr_offset (frag_hdr) || ip6_frag_hdr_more (frag_hdr));
+      if (!is_hashed[i])
+	continue;
+
+      ip6_full_reass_make_key (b, ip, frag_hdr, &kv);
+      hashes[i] = clib_bihash_hash_48_8 (&kv.kv);
+      clib_bihash_prefetch_bucket_48_8 (&rm->hash, hashes[i]);
+    }
+
   clib_spinlock_lock (&rt->lock);
 
   n_left_from = frame->n_vectors;
@@ -1208,9 +1296,14 @@ ip6_full_reassembly_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  u32 next0 = IP6_FULL_REASSEMBLY_NEXT_DROP;
 	  u32 error0 = IP6_ERROR_NONE;
 	  u32 icmp_bi = ~0;
+	  u64 hash = 0;
+
+	  i = frame->n_vectors - n_left_from;
+	  if (n_left_from > 4 && is_hashed[i + 4])
+	    clib_bihash_prefetch_data_48_8 (&rm->hash, hashes[i + 4]);
 
 	  bi0 = from[0];
-	  b0 = vlib_get_buffer (vm, bi0);
+	  b0 = bufs[i];
 
 	  ip6_header_t *ip0 = vlib_buffer_get_current (b0);
 	  ip6_frag_hdr_t *frag_hdr = NULL;
@@ -1279,29 +1372,12 @@ ip6_full_reassembly_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	    }
 	  else
 	    {
-	      u32 fib_index =
-		(vnet_buffer (b0)->sw_if_index[VLIB_TX] == (u32) ~0) ?
-			vec_elt (ip6_main.fib_index_by_sw_if_index,
-			   vnet_buffer (b0)->sw_if_index[VLIB_RX]) :
-			vnet_buffer (b0)->sw_if_index[VLIB_TX];
-	      kv.k.as_u64[0] = ip0->src_address.as_u64[0];
-	      kv.k.as_u64[1] = ip0->src_address.as_u64[1];
-	      kv.k.as_u64[2] = ip0->dst_address.as_u64[0];
-	      kv.k.as_u64[3] = ip0->dst_address.as_u64[1];
-	      kv.k.as_u64[4] =
-		((u64) fib_index) << 32 | (u64) frag_hdr->identification;
-	      /* RFC 8200: The Next Header values in the Fragment headers of
-	       * different fragments of the same original packet may differ.
-	       * Only the value from the Offset zero fragment packet is used
-	       * for reassembly.
-	       *
-	       * Also, IPv6 Header doesnt contain the protocol value unlike
-	       * IPv4.*/
-	      kv.k.as_u64[5] = 0;
+	      ip6_full_reass_make_key (b0, ip0, frag_hdr, &kv);
+	      hash = is_hashed[i] ? hashes[i] : clib_bihash_hash_48_8 (&kv.kv);
 	    }
 
 	  ip6_full_reass_t *reass = ip6_full_reass_find_or_create (
-	    vm, node, rm, rt, &kv, &icmp_bi, &do_handoff, skip_bihash,
+	    vm, node, rm, rt, &kv, hash, &icmp_bi, &do_handoff, skip_bihash,
 	    &n_left_to_next, &to_next);
 
 	  if (reass)
@@ -1579,23 +1655,6 @@ typedef enum
 } ip6_full_reass_event_t;
 
 #ifndef CLIB_MARCH_VARIANT
-typedef struct
-{
-  int failure;
-  clib_bihash_48_8_t *new_hash;
-} ip6_rehash_cb_ctx;
-
-static int
-ip6_rehash_cb (clib_bihash_kv_48_8_t * kv, void *_ctx)
-{
-  ip6_rehash_cb_ctx *ctx = _ctx;
-  if (clib_bihash_add_del_48_8 (ctx->new_hash, kv, 1))
-    {
-      ctx->failure = 1;
-    }
-  return (BIHASH_WALK_CONTINUE);
-}
-
 static void
 ip6_full_reass_set_params (u32 timeout_ms, u32 max_reassemblies,
 			   u32 max_reassembly_length,
@@ -1608,41 +1667,33 @@ ip6_full_reass_set_params (u32 timeout_ms, u32 max_reassemblies,
   ip6_full_reass_main.expire_walk_interval_ms = expire_walk_interval_ms;
 }
 
+/* Contexts are taken from the per-thread pools in the data path, so the
+ * pools are sized for max_reass_n up front and never grow there. */
+static void
+ip6_full_reass_pools_reserve (ip6_full_reass_main_t *rm)
+{
+  ip6_full_reass_per_thread_t *rt;
+
+  vec_foreach (rt, rm->per_thread_data)
+    {
+      clib_spinlock_lock (&rt->lock);
+      if (vec_max_len (rt->pool) < rm->max_reass_n)
+	pool_alloc (rt->pool, rm->max_reass_n - vec_len (rt->pool));
+      clib_spinlock_unlock (&rt->lock);
+    }
+}
+
 vnet_api_error_t
 ip6_full_reass_set (u32 timeout_ms, u32 max_reassemblies,
 		    u32 max_reassembly_length, u32 expire_walk_interval_ms)
 {
-  u32 old_nbuckets = ip6_full_reass_get_nbuckets ();
   ip6_full_reass_set_params (timeout_ms, max_reassemblies,
 			     max_reassembly_length, expire_walk_interval_ms);
+  ip6_full_reass_pools_reserve (&ip6_full_reass_main);
   vlib_process_signal_event (ip6_full_reass_main.vlib_main,
 			     ip6_full_reass_main.ip6_full_reass_expire_node_idx,
 			     IP6_EVENT_CONFIG_CHANGED, 0);
-  u32 new_nbuckets = ip6_full_reass_get_nbuckets ();
-  if (ip6_full_reass_main.max_reass_n > 0 && new_nbuckets > old_nbuckets)
-    {
-      clib_bihash_48_8_t new_hash;
-      clib_memset (&new_hash, 0, sizeof (new_hash));
-      ip6_rehash_cb_ctx ctx;
-      ctx.failure = 0;
-      ctx.new_hash = &new_hash;
-      clib_bihash_init_48_8 (&new_hash, "ip6-full-reass", new_nbuckets,
-			     new_nbuckets * 1024);
-      clib_bihash_foreach_key_value_pair_48_8 (&ip6_full_reass_main.hash,
-					       ip6_rehash_cb, &ctx);
-      if (ctx.failure)
-	{
-	  clib_bihash_free_48_8 (&new_hash);
-	  return -1;
-	}
-      else
-	{
-	  clib_bihash_free_48_8 (&ip6_full_reass_main.hash);
-	  clib_memcpy_fast (&ip6_full_reass_main.hash, &new_hash,
-			    sizeof (ip6_full_reass_main.hash));
-	  clib_bihash_copied (&ip6_full_reass_main.hash, &new_hash);
-	}
-    }
+  /* the table doubles its buckets by itself as reassemblies come in */
   return 0;
 }
 
@@ -1663,6 +1714,7 @@ ip6_full_reass_init_function (vlib_main_t * vm)
 {
   ip6_full_reass_main_t *rm = &ip6_full_reass_main;
   clib_error_t *error = 0;
+  clib_bihash_init2_args_48_8_t _a, *a = &_a;
   u32 nbuckets;
   vlib_node_t *node;
 
@@ -1673,7 +1725,6 @@ ip6_full_reass_init_function (vlib_main_t * vm)
   vec_foreach (rt, rm->per_thread_data)
   {
     clib_spinlock_init (&rt->lock);
-    pool_alloc (rt->pool, rm->max_reass_n);
   }
 
   node = vlib_get_node_by_name (vm, (u8 *) "ip6-full-reassembly-expire-walk");
@@ -1684,10 +1735,18 @@ ip6_full_reass_init_function (vlib_main_t * vm)
 			     IP6_FULL_REASS_MAX_REASSEMBLIES_DEFAULT,
 			     IP6_FULL_REASS_MAX_REASSEMBLY_LENGTH_DEFAULT,
 			     IP6_FULL_REASS_EXPIRE_WALK_INTERVAL_DEFAULT_MS);
+  ip6_full_reass_pools_reserve (rm);
 
   nbuckets = ip6_full_reass_get_nbuckets ();
-  clib_bihash_init_48_8 (&rm->hash, "ip6-full-reass", nbuckets,
-			 nbuckets * 1024);
+  clib_memset (a, 0, sizeof (*a));
+  a->h = &rm->hash;
+  a->name = "ip6-full-reass";
+  a->nbuckets = nbuckets;
+  a->memory_size = (uword) nbuckets * 1024;
+  /* grow with max_reass_n, finding old entries while the buckets move */
+  a->auto_resize = 1;
+  a->reclaim_fn = vlib_rcu_call;
+  clib_bihash_init2_48_8 (a);
 
   node = vlib_get_node_by_name (vm, (u8 *) "ip6-icmp-error");
   ASSERT (node);
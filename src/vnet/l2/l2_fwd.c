@@ -239,27 +239,20 @@ l2fwd_node_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
   vlib_node_t *n = vlib_get_node (vm, l2fwd_node.index);
   CLIB_UNUSED (u32 node_counter_base_index) = n->error_heap_index;
   vlib_error_main_t *em = &vm->error_main;
-  l2fib_entry_key_t cached_key;
-  l2fib_entry_result_t cached_result;
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  BVT (clib_bihash_kv) kvs[VLIB_FRAME_SIZE], *kv;
   u16 nexts[VLIB_FRAME_SIZE], *next;
 
-  /* Clear the one-entry cache in case mac table was updated */
-  cached_key.raw = ~0;
-  cached_result.raw = ~0;
-
   from = vlib_frame_vector_args (frame);
   n_left = frame->n_vectors;	/* number of packets to process */
   vlib_get_buffers (vm, from, bufs, n_left);
-  next = nexts;
   b = bufs;
+  kv = kvs;
 
+  /* make the mac table keys of the whole frame */
   while (n_left >= 8)
     {
-      u32 sw_if_index0, sw_if_index1, sw_if_index2, sw_if_index3;
       const ethernet_header_t *h0, *h1, *h2, *h3;
-      l2fib_entry_key_t key0, key1, key2, key3;
-      l2fib_entry_result_t result0, result1, result2, result3;
 
       /* Prefetch next iteration. */
       {
@@ -274,116 +267,66 @@ l2fwd_node_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 	clib_prefetch_load (b[7]->data);
       }
 
-      /* RX interface handles */
-      sw_if_index0 = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
-      sw_if_index1 = vnet_buffer (b[1])->sw_if_index[VLIB_RX];
-      sw_if_index2 = vnet_buffer (b[2])->sw_if_index[VLIB_RX];
-      sw_if_index3 = vnet_buffer (b[3])->sw_if_index[VLIB_RX];
-
       h0 = vlib_buffer_get_current (b[0]);
       h1 = vlib_buffer_get_current (b[1]);
       h2 = vlib_buffer_get_current (b[2]);
       h3 = vlib_buffer_get_current (b[3]);
 
-#ifdef COUNTERS
-      em->counters[node_counter_base_index + L2FWD_ERROR_L2FWD] += 4;
-#endif
-      l2fib_lookup_4 (msm->mac_table, &cached_key, &cached_result,
-                      h0->dst_address, h1->dst_address,
-                      h2->dst_address, h3->dst_address,
-                      vnet_buffer (b[0])->l2.bd_index,
-                      vnet_buffer (b[1])->l2.bd_index,
-                      vnet_buffer (b[2])->l2.bd_index,
-                      vnet_buffer (b[3])->l2.bd_index,
-                      &key0,	/* not used */
-                      &key1,	/* not used */
-                      &key2,	/* not used */
-                      &key3,	/* not used */
-                      &result0,
-                      &result1,
-                      &result2,
-                      &result3);
-      l2fwd_process (vm, node, msm, em, b[0], sw_if_index0, &result0, next);
-      l2fwd_process (vm, node, msm, em, b[1], sw_if_index1, &result1,
-		     next + 1);
-      l2fwd_process (vm, node, msm, em, b[2], sw_if_index2, &result2,
-		     next + 2);
-      l2fwd_process (vm, node, msm, em, b[3], sw_if_index3, &result3,
-		     next + 3);
-
-      /* verify speculative enqueues, maybe switch current next frame */
-      /* if next0==next1==next_index then nothing special needs to be done */
-      if (do_trace)
-	{
-	  if (b[0]->flags & VLIB_BUFFER_IS_TRACED)
-	    {
-	      l2fwd_trace_t *t = vlib_add_trace (vm, node, b[0], sizeof (*t));
-	      t->sw_if_index = sw_if_index0;
-	      t->bd_index = vnet_buffer (b[0])->l2.bd_index;
-	      clib_memcpy_fast (t->dst_and_src, h0->dst_address,
-				sizeof (h0->dst_address) +
-				sizeof (h0->src_address));
-	      t->result = result0;
-	    }
-	  if (b[1]->flags & VLIB_BUFFER_IS_TRACED)
-	    {
-	      l2fwd_trace_t *t = vlib_add_trace (vm, node, b[1], sizeof (*t));
-	      t->sw_if_index = sw_if_index1;
-	      t->bd_index = vnet_buffer (b[1])->l2.bd_index;
-	      clib_memcpy_fast (t->dst_and_src, h1->dst_address,
-				sizeof (h1->dst_address) +
-				sizeof (h1->src_address));
-	      t->result = result1;
-	    }
-	  if (b[2]->flags & VLIB_BUFFER_IS_TRACED)
-	    {
-	      l2fwd_trace_t *t = vlib_add_trace (vm, node, b[2], sizeof (*t));
-	      t->sw_if_index = sw_if_index2;
-	      t->bd_index = vnet_buffer (b[2])->l2.bd_index;
-	      clib_memcpy_fast (t->dst_and_src, h2->dst_address,
-				sizeof (h2->dst_address) +
-				sizeof (h2->src_address));
-	      t->result = result2;
-	    }
-	  if (b[3]->flags & VLIB_BUFFER_IS_TRACED)
-	    {
-	      l2fwd_trace_t *t = vlib_add_trace (vm, node, b[3], sizeof (*t));
-	      t->sw_if_index = sw_if_index3;
-	      t->bd_index = vnet_buffer (b[3])->l2.bd_index;
-	      clib_memcpy_fast (t->dst_and_src, h3->dst_address,
-				sizeof (h3->dst_address) +
-				sizeof (h3->src_address));
-	      t->result = result3;
-	    }
-	}
-
-      next += 4;
+      kv[0].key = l2fib_make_key (h0->dst_address,
+				  vnet_buffer (b[0])->l2.bd_index);
+      kv[1].key = l2fib_make_key (h1->dst_address,
+				  vnet_buffer (b[1])->l2.bd_index);
+      kv[2].key = l2fib_make_key (h2->dst_address,
+				  vnet_buffer (b[2])->l2.bd_index);
+      kv[3].key = l2fib_make_key (h3->dst_address,
+				  vnet_buffer (b[3])->l2.bd_index);
+      kv[0].value = kv[1].value = kv[2].value = kv[3].value = ~0ULL;
+
+      kv += 4;
       b += 4;
       n_left -= 4;
     }
 
   while (n_left > 0)
     {
-      u32 sw_if_index0;
-      ethernet_header_t *h0;
-      l2fib_entry_key_t key0;
-      l2fib_entry_result_t result0;
-
-      sw_if_index0 = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
+      const ethernet_header_t *h0;
 
       h0 = vlib_buffer_get_current (b[0]);
+      kv[0].key = l2fib_make_key (h0->dst_address,
+				  vnet_buffer (b[0])->l2.bd_index);
+      kv[0].value = ~0ULL;
+
+      kv += 1;
+      b += 1;
+      n_left -= 1;
+    }
+
+  /* lookups that miss leave the result at ~0 */
+  BV (clib_bihash_search_batch) (msm->mac_table, kvs, frame->n_vectors);
 
-      /* process 1 pkt */
 #ifdef COUNTERS
-      em->counters[node_counter_base_index + L2FWD_ERROR_L2FWD] += 1;
+  em->counters[node_counter_base_index + L2FWD_ERROR_L2FWD] +=
+    frame->n_vectors;
 #endif
-      l2fib_lookup_1 (msm->mac_table, &cached_key, &cached_result,
-		      h0->dst_address, vnet_buffer (b[0])->l2.bd_index, &key0,
-		      /* not used */ &result0);
+
+  n_left = frame->n_vectors;
+  next = nexts;
+  b = bufs;
+  kv = kvs;
+
+  while (n_left > 0)
+    {
+      u32 sw_if_index0;
+      l2fib_entry_result_t result0;
+
+      sw_if_index0 = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
+      result0.raw = kv[0].value;
+
       l2fwd_process (vm, node, msm, em, b[0], sw_if_index0, &result0, next);
 
       if (do_trace && PREDICT_FALSE (b[0]->flags & VLIB_BUFFER_IS_TRACED))
 	{
+	  ethernet_header_t *h0 = vlib_buffer_get_current (b[0]);
 	  l2fwd_trace_t *t = vlib_add_trace (vm, node, b[0], sizeof (*t));
 	  t->sw_if_index = sw_if_index0;
 	  t->bd_index = vnet_buffer (b[0])->l2.bd_index;
@@ -393,8 +336,8 @@ l2fwd_node_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  t->result = result0;
 	}
 
-      /* verify speculative enqueue, maybe switch current next frame */
       next += 1;
+      kv += 1;
       b += 1;
       n_left -= 1;
     }
@@ -24,6 +24,8 @@
 #include <vnet/classify/vnet_classify.h>
 #include <vnet/l2/feat_bitmap.h>
 #include <vnet/l2/l2_input.h>
+#include <vppinfra/vector/mask_compare.h>
+#include <vppinfra/vector/compress.h>
 
 
 /* Dispatch functions meant to be instantiated elsewhere */
@@ -66,187 +68,111 @@ static char *vnet_policer_error_strings[] = {
 #undef _
 };
 
+/*
+ * The packets of a frame are grouped by policer, and each group is policed
+ * in one go, so a policer's buckets, or this worker's lease of a shared
+ * policer, are read and written back once per frame rather than once per
+ * packet.
+ */
 static inline uword
 vnet_policer_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 		     vlib_frame_t *frame, vlib_dir_t dir)
 {
-  u32 n_left_from, *from, *to_next;
-  vnet_policer_next_t next_index;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  vlib_buffer_t *group_bufs[VLIB_FRAME_SIZE];
+  u32 policer_indices[VLIB_FRAME_SIZE], lens[VLIB_FRAME_SIZE];
+  u32 slots[VLIB_FRAME_SIZE], group_slots[VLIB_FRAME_SIZE];
+  u32 group_lens[VLIB_FRAME_SIZE];
+  u16 nexts[VLIB_FRAME_SIZE];
+  u8 acts[VLIB_FRAME_SIZE], group_acts[VLIB_FRAME_SIZE];
+  vlib_frame_bitmap_t used_elts = {}, mask = {};
   vnet_policer_main_t *pm = &vnet_policer_main;
+  u32 n_left, n_group, *from, pi, off = 0;
   u64 time_in_policer_periods;
   u32 transmitted = 0;
+  u32 i, next;
 
   time_in_policer_periods =
     clib_cpu_time_now () >> POLICER_TICKS_PER_PERIOD_SHIFT;
 
   from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
-  next_index = node->cached_next_index;
+  n_left = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left);
 
-  while (n_left_from > 0)
+  for (i = 0; i < frame->n_vectors; i++)
     {
-      u32 n_left_to_next;
-
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
+      u32 sw_if_index = vnet_buffer (bufs[i])->sw_if_index[dir];
 
-      while (n_left_from >= 4 && n_left_to_next >= 2)
-	{
-	  u32 bi0, bi1;
-	  vlib_buffer_t *b0, *b1;
-	  u32 next0, next1;
-	  u32 sw_if_index0, sw_if_index1;
-	  u32 pi0 = 0, pi1 = 0;
-	  u8 act0, act1;
-
-	  /* Prefetch next iteration. */
-	  {
-	    vlib_buffer_t *b2, *b3;
-
-	    b2 = vlib_get_buffer (vm, from[2]);
-	    b3 = vlib_get_buffer (vm, from[3]);
-
-	    vlib_prefetch_buffer_header (b2, LOAD);
-	    vlib_prefetch_buffer_header (b3, LOAD);
-	  }
-
-	  /* speculatively enqueue b0 and b1 to the current next frame */
-	  to_next[0] = bi0 = from[0];
-	  to_next[1] = bi1 = from[1];
-	  from += 2;
-	  to_next += 2;
-	  n_left_from -= 2;
-	  n_left_to_next -= 2;
+      policer_indices[i] = pm->policer_index_by_sw_if_index[dir][sw_if_index];
+      lens[i] = vlib_buffer_length_in_chain (vm, bufs[i]);
+      slots[i] = i;
+    }
 
-	  b0 = vlib_get_buffer (vm, bi0);
-	  b1 = vlib_get_buffer (vm, bi1);
+  pi = policer_indices[0];
 
-	  sw_if_index0 = vnet_buffer (b0)->sw_if_index[dir];
-	  sw_if_index1 = vnet_buffer (b1)->sw_if_index[dir];
+more:
+  /* the packets of the frame using the same policer as the first unused */
+  clib_mask_compare_u32 (pi, policer_indices, mask, frame->n_vectors);
+  n_group = clib_compress_u32 (group_slots, slots, mask, frame->n_vectors);
 
-	  pi0 = pm->policer_index_by_sw_if_index[dir][sw_if_index0];
-	  pi1 = pm->policer_index_by_sw_if_index[dir][sw_if_index1];
+  for (i = 0; i < n_group; i++)
+    {
+      group_bufs[i] = bufs[group_slots[i]];
+      group_lens[i] = lens[group_slots[i]];
+    }
 
-	  act0 = vnet_policer_police (vm, b0, pi0, time_in_policer_periods,
-				      POLICE_CONFORM /* no chaining */, true);
+  vnet_policer_police_n (vm, group_bufs, pi, group_lens, group_acts, n_group,
+			 time_in_policer_periods,
+			 POLICE_CONFORM /* no chaining */, true);
 
-	  act1 = vnet_policer_police (vm, b1, pi1, time_in_policer_periods,
-				      POLICE_CONFORM /* no chaining */, true);
+  for (i = 0; i < n_group; i++)
+    acts[group_slots[i]] = group_acts[i];
 
-	  if (PREDICT_FALSE (act0 == QOS_ACTION_HANDOFF))
-	    {
-	      next0 = VNET_POLICER_NEXT_HANDOFF;
-	      vnet_buffer (b0)->policer.index = pi0;
-	    }
-	  else if (PREDICT_FALSE (act0 == QOS_ACTION_DROP))
-	    {
-	      next0 = VNET_POLICER_NEXT_DROP;
-	      b0->error = node->errors[VNET_POLICER_ERROR_DROP];
-	    }
-	  else /* transmit or mark-and-transmit action */
-	    {
-	      transmitted++;
-	      vnet_feature_next (&next0, b0);
-	    }
+  n_left -= n_group;
+  if (n_left)
+    {
+      vlib_frame_bitmap_or (used_elts, mask);
 
-	  if (PREDICT_FALSE (act1 == QOS_ACTION_HANDOFF))
-	    {
-	      next1 = VNET_POLICER_NEXT_HANDOFF;
-	      vnet_buffer (b1)->policer.index = pi1;
-	    }
-	  else if (PREDICT_FALSE (act1 == QOS_ACTION_DROP)) /* drop action */
-	    {
-	      next1 = VNET_POLICER_NEXT_DROP;
-	      b1->error = node->errors[VNET_POLICER_ERROR_DROP];
-	    }
-	  else /* transmit or mark-and-transmit action */
-	    {
-	      transmitted++;
-	      vnet_feature_next (&next1, b1);
-	    }
+      while (PREDICT_FALSE (used_elts[off] == ~0))
+	off++;
 
-	  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)))
-	    {
-	      if (b0->flags & VLIB_BUFFER_IS_TRACED)
-		{
-		  vnet_policer_trace_t *t =
-		    vlib_add_trace (vm, node, b0, sizeof (*t));
-		  t->sw_if_index = sw_if_index0;
-		  t->next_index = next0;
-		}
-	      if (b1->flags & VLIB_BUFFER_IS_TRACED)
-		{
-		  vnet_policer_trace_t *t =
-		    vlib_add_trace (vm, node, b1, sizeof (*t));
-		  t->sw_if_index = sw_if_index1;
-		  t->next_index = next1;
-		}
-	    }
+      pi = policer_indices[(off << 6) + count_trailing_zeros (~used_elts[off])];
+      goto more;
+    }
 
-	  /* verify speculative enqueues, maybe switch current next frame */
-	  vlib_validate_buffer_enqueue_x2 (vm, node, next_index,
-					   to_next, n_left_to_next,
-					   bi0, bi1, next0, next1);
+  b = bufs;
+  for (i = 0; i < frame->n_vectors; i++, b++)
+    {
+      if (PREDICT_FALSE (acts[i] == QOS_ACTION_HANDOFF))
+	{
+	  next = VNET_POLICER_NEXT_HANDOFF;
+	  vnet_buffer (b[0])->policer.index = policer_indices[i];
 	}
-
-      while (n_left_from > 0 && n_left_to_next > 0)
+      else if (PREDICT_FALSE (acts[i] == QOS_ACTION_DROP))
 	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  u32 next0;
-	  u32 sw_if_index0;
-	  u32 pi0 = 0;
-	  u8 act0;
-
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
-
-	  b0 = vlib_get_buffer (vm, bi0);
-
-	  sw_if_index0 = vnet_buffer (b0)->sw_if_index[dir];
-	  pi0 = pm->policer_index_by_sw_if_index[dir][sw_if_index0];
-
-	  act0 = vnet_policer_police (vm, b0, pi0, time_in_policer_periods,
-				      POLICE_CONFORM /* no chaining */, true);
-
-	  if (PREDICT_FALSE (act0 == QOS_ACTION_HANDOFF))
-	    {
-	      next0 = VNET_POLICER_NEXT_HANDOFF;
-	      vnet_buffer (b0)->policer.index = pi0;
-	    }
-	  else if (PREDICT_FALSE (act0 == QOS_ACTION_DROP))
-	    {
-	      next0 = VNET_POLICER_NEXT_DROP;
-	      b0->error = node->errors[VNET_POLICER_ERROR_DROP];
-	    }
-	  else /* transmit or mark-and-transmit action */
-	    {
-	      transmitted++;
-	      vnet_feature_next (&next0, b0);
-	    }
-
-	  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
-			     && (b0->flags & VLIB_BUFFER_IS_TRACED)))
-	    {
-	      vnet_policer_trace_t *t =
-		vlib_add_trace (vm, node, b0, sizeof (*t));
-	      t->sw_if_index = sw_if_index0;
-	      t->next_index = next0;
-	      t->policer_index = pi0;
-	    }
-
-	  /* verify speculative enqueue, maybe switch current next frame */
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index,
-					   to_next, n_left_to_next,
-					   bi0, next0);
+	  next = VNET_POLICER_NEXT_DROP;
+	  b[0]->error = node->errors[VNET_POLICER_ERROR_DROP];
+	}
+      else /* transmit or mark-and-transmit action */
+	{
+	  transmitted++;
+	  vnet_feature_next (&next, b[0]);
 	}
+      nexts[i] = next;
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+      if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE) &&
+			 (b[0]->flags & VLIB_BUFFER_IS_TRACED)))
+	{
+	  vnet_policer_trace_t *t =
+	    vlib_add_trace (vm, node, b[0], sizeof (*t));
+	  t->sw_if_index = vnet_buffer (b[0])->sw_if_index[dir];
+	  t->next_index = next;
+	  t->policer_index = policer_indices[i];
+	}
     }
 
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+
   vlib_node_increment_counter (vm, node->node_index,
 			       VNET_POLICER_ERROR_TRANSMIT, transmitted);
   return frame->n_vectors;
@@ -410,6 +336,9 @@ policer_classify_inline (vlib_main_t * vm,
   u32 chain_hits = 0;
   u32 n_next_nodes;
   u64 time_in_policer_periods;
+  vnet_classify_entry_t *entries[VLIB_FRAME_SIZE];
+  u32 table_indices[VLIB_FRAME_SIZE];
+  u8 *data[VLIB_FRAME_SIZE];
 
   time_in_policer_periods =
     clib_cpu_time_now () >> POLICER_TICKS_PER_PERIOD_SHIFT;
@@ -512,6 +441,20 @@ policer_classify_inline (vlib_main_t * vm,
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
 
+  /* Compiled chains: search the frame at once */
+  if (PREDICT_FALSE (vcm->n_compiled_chains))
+    {
+      for (u32 i = 0; i < n_left_from; i++)
+	{
+	  vlib_buffer_t *b0 = vlib_get_buffer (vm, from[i]);
+
+	  data[i] = b0->data;
+	  table_indices[i] = vnet_buffer (b0)->l2_classify.table_index;
+	}
+      vnet_classify_find_entries (vcm, data, data, table_indices, entries,
+				  n_left_from, now);
+    }
+
   while (n_left_from > 0)
     {
       u32 n_left_to_next;
@@ -521,6 +464,7 @@ policer_classify_inline (vlib_main_t * vm,
       /* Not enough load/store slots to dual loop... */
       while (n_left_from > 0 && n_left_to_next > 0)
 	{
+	  u32 i0 = frame->n_vectors - n_left_from;
 	  u32 bi0;
 	  vlib_buffer_t *b0;
 	  u32 next0 = POLICER_CLASSIFY_NEXT_INDEX_DROP;
@@ -576,7 +520,33 @@ policer_classify_inline (vlib_main_t * vm,
 
 	  vnet_buffer (b0)->l2_classify.opaque_index = ~0;
 
-	  if (PREDICT_TRUE (table_index0 != ~0))
+	  if (PREDICT_FALSE (vcm->n_compiled_chains) && table_index0 != ~0)
+	    {
+	      e0 = entries[i0];
+	      t0 = pool_elt_at_index (vcm->tables, table_indices[i0]);
+	      if (e0)
+		{
+		  act0 = vnet_policer_police (vm, b0, e0->next_index,
+					      time_in_policer_periods,
+					      e0->opaque_index, false);
+		  if (PREDICT_FALSE (act0 == QOS_ACTION_DROP))
+		    {
+		      next0 = POLICER_CLASSIFY_NEXT_INDEX_DROP;
+		      b0->error = node->errors[POLICER_CLASSIFY_ERROR_DROP];
+		    }
+		  hits++;
+		  if (table_indices[i0] != table_index0)
+		    chain_hits++;
+		}
+	      else
+		{
+		  next0 = (t0->miss_next_index < n_next_nodes) ?
+			    t0->miss_next_index :
+			    next0;
+		  misses++;
+		}
+	    }
+	  else if (PREDICT_TRUE (table_index0 != ~0))
 	    {
 	      hash0 = vnet_buffer (b0)->l2_classify.hash;
 	      t0 = pool_elt_at_index (vcm->tables, table_index0);
@@ -66,6 +66,15 @@ typedef enum
 // The lock field should be used for a spin-lock on the struct. Alternatively,
 // a thread index field is provided so that policed packets may be handed
 // off to a single worker thread.
+//
+// A shared policer is policed by every worker without handoff. Each worker
+// leases tokens from the buckets into its own policer_lease_t and polices
+// from the lease, going back to the buckets only once it runs dry. The two
+// buckets are updated together with a 64-bit compare-and-swap, and the
+// thread winning the compare-and-swap of last_update_time adds the tokens
+// of the elapsed periods, so no lock is taken. Tokens left in the lease of
+// an idle worker are lost to the others, which bounds the error to one
+// lease per worker.
 
 #define POLICER_TICKS_PER_PERIOD_SHIFT 17
 #define POLICER_TICKS_PER_PERIOD       (1 << POLICER_TICKS_PER_PERIOD_SHIFT)
@@ -73,12 +82,14 @@ typedef enum
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
-  u32 single_rate;		// 1 = single rate policer, 0 = two rate policer
-  u32 color_aware;		// for hierarchical policing
+  u8 single_rate;		// 1 = single rate policer, 0 = two rate policer
+  u8 color_aware;		// for hierarchical policing
+  u8 pad0[2];
   u32 scale;			// power-of-2 shift amount for lower rates
   qos_action_type_en action[3];
   ip_dscp_t mark_dscp[3];
   u8 pad[2];
+  u32 lease_index;		// Per-worker token leases, ~0 if not shared
 
   // Fields are marked as 2R if they are only used for a 2-rate policer,
   // and MOD if they are modified as part of the update operation.
@@ -88,16 +99,91 @@ typedef struct
   u32 pir_tokens_per_period;	// 2R
 
   u32 current_limit;
-  u32 current_bucket;		// MOD
   u32 extended_limit;
-  u32 extended_bucket;		// MOD
   clib_thread_index_t
     thread_index;		// Tie policer to a thread, rather than lock
+  u16 pad1;
+  union
+  {
+    struct
+    {
+      u32 current_bucket;	// MOD
+      u32 extended_bucket;	// MOD
+    };
+    u64 buckets;		// Both buckets, for a shared policer
+  };
   u64 last_update_time;		// MOD
   u8 *name;
 } policer_t;
 
 STATIC_ASSERT_SIZEOF (policer_t, CLIB_CACHE_LINE_BYTES);
+STATIC_ASSERT_OFFSET_OF (policer_t, buckets, 40);
+
+// The tokens a worker has leased from a shared policer. Each worker's lease
+// is on its own cache-line.
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  u32 current_tokens;
+  u32 extended_tokens;
+  u32 quantum;			// # of tokens to lease at once
+} policer_lease_t;
+
+// Color a packet against the given tokens and consume them.
+static_always_inline policer_result_e
+vnet_police_color (policer_t *policer, u64 *current_tokens,
+		   u64 *extended_tokens, u32 packet_length,
+		   policer_result_e packet_color)
+{
+  if (policer->single_rate)
+    {
+      if ((!policer->color_aware || (packet_color == POLICE_CONFORM))
+	  && (*current_tokens >= packet_length))
+	{
+	  *current_tokens -= packet_length;
+	  *extended_tokens -= clib_min (*extended_tokens, packet_length);
+	  return POLICE_CONFORM;
+	}
+      else if ((!policer->color_aware || (packet_color != POLICE_VIOLATE))
+	       && (*extended_tokens >= packet_length))
+	{
+	  *extended_tokens -= packet_length;
+	  return POLICE_EXCEED;
+	}
+      return POLICE_VIOLATE;
+    }
+
+  // Two-rate policer
+  if ((policer->color_aware && (packet_color == POLICE_VIOLATE))
+      || (*extended_tokens < packet_length))
+    return POLICE_VIOLATE;
+  else if ((policer->color_aware && (packet_color == POLICE_EXCEED))
+	   || (*current_tokens < packet_length))
+    {
+      *extended_tokens -= packet_length;
+      return POLICE_EXCEED;
+    }
+  *current_tokens -= packet_length;
+  *extended_tokens -= packet_length;
+  return POLICE_CONFORM;
+}
+
+// Add the tokens of n_periods to the given ones, up to the limits.
+static_always_inline void
+vnet_police_refill (policer_t *policer, u64 n_periods, u64 *current_tokens,
+		    u64 *extended_tokens)
+{
+  u32 eir_tokens_per_period = policer->single_rate ?
+				policer->cir_tokens_per_period :
+				policer->pir_tokens_per_period;
+
+  *current_tokens += n_periods * policer->cir_tokens_per_period;
+  *extended_tokens += n_periods * eir_tokens_per_period;
+  if (*current_tokens > policer->current_limit)
+    *current_tokens = policer->current_limit;
+  if (*extended_tokens > policer->extended_limit)
+    *extended_tokens = policer->extended_limit;
+}
 
 static inline policer_result_e
 vnet_police_packet (policer_t *policer, u32 packet_length,
@@ -129,90 +215,135 @@ vnet_police_packet (policer_t *policer, u32 packet_length,
   // packet. This constraint on tokens_per_period lets the ucode omit
   // code to dynamically check for or prevent the overflow.
 
-  if (policer->single_rate)
-    {
+  current_tokens = policer->current_bucket;
+  extended_tokens = policer->extended_bucket;
+  vnet_police_refill (policer, n_periods, &current_tokens, &extended_tokens);
 
-      // Compute number of tokens for this time period
-      current_tokens =
-	policer->current_bucket + n_periods * policer->cir_tokens_per_period;
-      if (current_tokens > policer->current_limit)
-	{
-	  current_tokens = policer->current_limit;
-	}
+  result = vnet_police_color (policer, &current_tokens, &extended_tokens,
+			      packet_length, packet_color);
 
-      extended_tokens =
-	policer->extended_bucket + n_periods * policer->cir_tokens_per_period;
-      if (extended_tokens > policer->extended_limit)
-	{
-	  extended_tokens = policer->extended_limit;
-	}
+  policer->current_bucket = current_tokens;
+  policer->extended_bucket = extended_tokens;
+  return result;
+}
 
-      // Determine color
+// Police a group of packets against the same policer, refilling and
+// writing back the buckets once for the whole group. The color of each
+// packet is returned in results.
+static_always_inline void
+vnet_police_packets (policer_t *policer, u32 *packet_lengths, u8 *results,
+		     u32 n_packets, policer_result_e packet_color, u64 time)
+{
+  u64 current_tokens = policer->current_bucket;
+  u64 extended_tokens = policer->extended_bucket;
 
-      if ((!policer->color_aware || (packet_color == POLICE_CONFORM))
-	  && (current_tokens >= packet_length))
-	{
-	  policer->current_bucket = current_tokens - packet_length;
-	  policer->extended_bucket = extended_tokens - packet_length;
-	  result = POLICE_CONFORM;
-	}
-      else if ((!policer->color_aware || (packet_color != POLICE_VIOLATE))
-	       && (extended_tokens >= packet_length))
-	{
-	  policer->current_bucket = current_tokens;
-	  policer->extended_bucket = extended_tokens - packet_length;
-	  result = POLICE_EXCEED;
-	}
-      else
-	{
-	  policer->current_bucket = current_tokens;
-	  policer->extended_bucket = extended_tokens;
-	  result = POLICE_VIOLATE;
-	}
+  vnet_police_refill (policer, time - policer->last_update_time,
+		      &current_tokens, &extended_tokens);
+  policer->last_update_time = time;
+
+  for (u32 i = 0; i < n_packets; i++)
+    results[i] = vnet_police_color (policer, &current_tokens,
+				    &extended_tokens,
+				    packet_lengths[i] << policer->scale,
+				    packet_color);
+
+  policer->current_bucket = current_tokens;
+  policer->extended_bucket = extended_tokens;
+}
+
+// Add the tokens of the periods since the last update to the buckets of a
+// shared policer. Only the thread moving last_update_time forward adds them.
+static_always_inline void
+vnet_police_refill_shared (policer_t *policer, u64 time)
+{
+  u64 last = clib_atomic_load_relax_n (&policer->last_update_time);
+  u64 current_tokens, extended_tokens, old, new;
 
+  if (time <= last ||
+      !clib_atomic_bool_cmp_and_swap (&policer->last_update_time, last, time))
+    return;
+
+  old = clib_atomic_load_relax_n (&policer->buckets);
+  do
+    {
+      current_tokens = (u32) old;
+      extended_tokens = old >> 32;
+      vnet_police_refill (policer, time - last, &current_tokens,
+			  &extended_tokens);
+      new = current_tokens | (extended_tokens << 32);
     }
-  else
+  while (!clib_atomic_cmp_and_swap_acq_relax_n (&policer->buckets, &old, new,
+						 1 /* weak */));
+}
+
+// Top up a worker's lease to at least want tokens, or whatever is left in
+// the buckets of the shared policer.
+static_always_inline void
+vnet_police_lease (policer_t *policer, policer_lease_t *lease, u32 want,
+		   u64 time)
+{
+  u32 current_tokens, extended_tokens, current_take, extended_take;
+  u64 old, new;
+
+  vnet_police_refill_shared (policer, time);
+
+  old = clib_atomic_load_relax_n (&policer->buckets);
+  do
     {
-      // Two-rate policer
-
-      // Compute number of tokens for this time period
-      current_tokens =
-	policer->current_bucket + n_periods * policer->cir_tokens_per_period;
-      extended_tokens =
-	policer->extended_bucket + n_periods * policer->pir_tokens_per_period;
-      if (current_tokens > policer->current_limit)
-	{
-	  current_tokens = policer->current_limit;
-	}
-      if (extended_tokens > policer->extended_limit)
-	{
-	  extended_tokens = policer->extended_limit;
-	}
+      current_tokens = (u32) old;
+      extended_tokens = old >> 32;
+      current_take = want > lease->current_tokens ?
+		       clib_min (current_tokens, want - lease->current_tokens) :
+		       0;
+      extended_take =
+	want > lease->extended_tokens ?
+	  clib_min (extended_tokens, want - lease->extended_tokens) :
+	  0;
+      if (current_take == 0 && extended_take == 0)
+	return;
+      new = (u64) (current_tokens - current_take) |
+	    ((u64) (extended_tokens - extended_take) << 32);
+    }
+  while (!clib_atomic_cmp_and_swap_acq_relax_n (&policer->buckets, &old, new,
+						 1 /* weak */));
 
-      // Determine color
+  lease->current_tokens += current_take;
+  lease->extended_tokens += extended_take;
+}
 
-      if ((policer->color_aware && (packet_color == POLICE_VIOLATE))
-	  || (extended_tokens < packet_length))
-	{
-	  policer->current_bucket = current_tokens;
-	  policer->extended_bucket = extended_tokens;
-	  result = POLICE_VIOLATE;
-	}
-      else if ((policer->color_aware && (packet_color == POLICE_EXCEED))
-	       || (current_tokens < packet_length))
-	{
-	  policer->current_bucket = current_tokens;
-	  policer->extended_bucket = extended_tokens - packet_length;
-	  result = POLICE_EXCEED;
-	}
-      else
+// Police a group of packets against a shared policer from this worker's
+// lease.
+static_always_inline void
+vnet_police_packets_leased (policer_t *policer, policer_lease_t *lease,
+			    u32 *packet_lengths, u8 *results, u32 n_packets,
+			    policer_result_e packet_color, u64 time)
+{
+  u64 current_tokens = lease->current_tokens;
+  u64 extended_tokens = lease->extended_tokens;
+  u32 packet_length;
+
+  for (u32 i = 0; i < n_packets; i++)
+    {
+      packet_length = packet_lengths[i] << policer->scale;
+
+      if (PREDICT_FALSE (current_tokens < packet_length ||
+			 extended_tokens < packet_length))
 	{
-	  policer->current_bucket = current_tokens - packet_length;
-	  policer->extended_bucket = extended_tokens - packet_length;
-	  result = POLICE_CONFORM;
+	  lease->current_tokens = current_tokens;
+	  lease->extended_tokens = extended_tokens;
+	  vnet_police_lease (policer, lease,
+			     clib_max (lease->quantum, packet_length), time);
+	  current_tokens = lease->current_tokens;
+	  extended_tokens = lease->extended_tokens;
 	}
+
+      results[i] = vnet_police_color (policer, &current_tokens,
+				      &extended_tokens, packet_length,
+				      packet_color);
     }
-  return result;
+
+  lease->current_tokens = current_tokens;
+  lease->extended_tokens = extended_tokens;
 }
 
 #endif // __POLICE_H__
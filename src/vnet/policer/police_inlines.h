@@ -71,25 +71,40 @@ vnet_policer_police (vlib_main_t *vm, vlib_buffer_t *b, u32 policer_index,
 				  vm->thread_index, policer_index);
 
   pol = &pm->policers[policer_index];
+  len = vlib_buffer_length_in_chain (vm, b);
+
+  if (pol->lease_index != ~0)
+    {
+      /* shared policer, police from this worker's lease */
+      u8 res;
 
-  if (handoff)
+      vnet_police_packets_leased (
+	pol, vec_elt_at_index (pm->leases[pol->lease_index], vm->thread_index),
+	&len, &res, 1, packet_color, time_in_policer_periods);
+      col = res;
+    }
+  else
     {
-      if (PREDICT_FALSE (pol->thread_index == CLIB_INVALID_THREAD_INDEX))
-	/*
-	 * This is the first packet to use this policer. Set the
-	 * thread index in the policer to this thread and any
-	 * packets seen by this node on other threads will
-	 * be handed off to this one.
-	 *
-	 * This could happen simultaneously on another thread.
-	 */
-	clib_atomic_cmp_and_swap (&pol->thread_index, ~0, vm->thread_index);
-      else if (PREDICT_FALSE (pol->thread_index != vm->thread_index))
-	return QOS_ACTION_HANDOFF;
+      if (handoff)
+	{
+	  if (PREDICT_FALSE (pol->thread_index == CLIB_INVALID_THREAD_INDEX))
+	    /*
+	     * This is the first packet to use this policer. Set the
+	     * thread index in the policer to this thread and any
+	     * packets seen by this node on other threads will
+	     * be handed off to this one.
+	     *
+	     * This could happen simultaneously on another thread.
+	     */
+	    clib_atomic_cmp_and_swap (&pol->thread_index, ~0,
+				      vm->thread_index);
+	  else if (PREDICT_FALSE (pol->thread_index != vm->thread_index))
+	    return QOS_ACTION_HANDOFF;
+	}
+      col =
+	vnet_police_packet (pol, len, packet_color, time_in_policer_periods);
     }
 
-  len = vlib_buffer_length_in_chain (vm, b);
-  col = vnet_police_packet (pol, len, packet_color, time_in_policer_periods);
   act = pol->action[col];
   vlib_increment_combined_counter (&policer_counters[col], vm->thread_index,
 				   policer_index, 1, len);
@@ -99,6 +114,66 @@ vnet_policer_police (vlib_main_t *vm, vlib_buffer_t *b, u32 policer_index,
   return act;
 }
 
+/*
+ * Police a group of packets using the same policer, of the given lengths,
+ * and return the action for each in acts. The buckets, or this worker's
+ * lease of a shared policer, are updated once for the group.
+ */
+static_always_inline void
+vnet_policer_police_n (vlib_main_t *vm, vlib_buffer_t **b, u32 policer_index,
+		       u32 *lens, u8 *acts, u32 n_packets,
+		       u64 time_in_policer_periods,
+		       policer_result_e packet_color, bool handoff)
+{
+  vnet_policer_main_t *pm = &vnet_policer_main;
+  u64 n_bytes[NUM_POLICE_RESULTS] = {};
+  u32 n_pkts[NUM_POLICE_RESULTS] = {};
+  policer_t *pol;
+  u32 i, col;
+
+  pol = &pm->policers[policer_index];
+
+  if (pol->lease_index != ~0)
+    {
+      vnet_police_packets_leased (
+	pol, vec_elt_at_index (pm->leases[pol->lease_index], vm->thread_index),
+	lens, acts, n_packets, packet_color, time_in_policer_periods);
+    }
+  else
+    {
+      if (handoff)
+	{
+	  if (PREDICT_FALSE (pol->thread_index == CLIB_INVALID_THREAD_INDEX))
+	    clib_atomic_cmp_and_swap (&pol->thread_index, ~0,
+				      vm->thread_index);
+	  else if (PREDICT_FALSE (pol->thread_index != vm->thread_index))
+	    {
+	      clib_memset_u8 (acts, QOS_ACTION_HANDOFF, n_packets);
+	      return;
+	    }
+	}
+      vnet_police_packets (pol, lens, acts, n_packets, packet_color,
+			   time_in_policer_periods);
+    }
+
+  /* the colors are replaced by the actions */
+  for (i = 0; i < n_packets; i++)
+    {
+      col = acts[i];
+      n_pkts[col]++;
+      n_bytes[col] += lens[i];
+      acts[i] = pol->action[col];
+      if (PREDICT_TRUE (acts[i] == QOS_ACTION_MARK_AND_TRANSMIT))
+	vnet_policer_mark (b[i], pol->mark_dscp[col]);
+    }
+
+  for (col = 0; col < NUM_POLICE_RESULTS; col++)
+    if (n_pkts[col])
+      vlib_increment_combined_counter (&policer_counters[col],
+				       vm->thread_index, policer_index,
+				       n_pkts[col], n_bytes[col]);
+}
+
 typedef enum
 {
   POLICER_HANDOFF_ERROR_CONGESTION_DROP,
@@ -49,6 +49,39 @@ vlib_combined_counter_main_t policer_counters[] = {
   },
 };
 
+/*
+ * Empty the leases of a shared policer, returning their tokens to its
+ * buckets, and size the quantum each worker leases at once. A quarter of
+ * the committed burst is shared among the threads, which bounds the tokens
+ * held back from the buckets, and so the error of the policer.
+ */
+static void
+policer_leases_flush (policer_t *policer)
+{
+  vnet_policer_main_t *pm = &vnet_policer_main;
+  policer_lease_t *lease;
+  u64 current_tokens, extended_tokens;
+  u32 quantum;
+
+  current_tokens = policer->current_bucket;
+  extended_tokens = policer->extended_bucket;
+  quantum = policer->current_limit / (4 * vlib_get_n_threads ());
+  quantum = clib_max (quantum, policer->cir_tokens_per_period);
+
+  vec_foreach (lease, pm->leases[policer->lease_index])
+    {
+      current_tokens += lease->current_tokens;
+      extended_tokens += lease->extended_tokens;
+      lease->current_tokens = 0;
+      lease->extended_tokens = 0;
+      lease->quantum = quantum;
+    }
+
+  policer->current_bucket = clib_min (current_tokens, policer->current_limit);
+  policer->extended_bucket =
+    clib_min (extended_tokens, policer->extended_limit);
+}
+
 int
 policer_add (vlib_main_t *vm, const u8 *name, const qos_pol_cfg_params_st *cfg,
 	     u32 *policer_index)
@@ -87,6 +120,7 @@ policer_add (vlib_main_t *vm, const u8 *name, const qos_pol_cfg_params_st *cfg,
   hash_set_mem (pm->policer_index_by_name, policer->name, pi);
   *policer_index = pi;
   policer->thread_index = ~0;
+  policer->lease_index = ~0;
 
   for (i = 0; i < NUM_POLICE_RESULTS; i++)
     {
@@ -118,6 +152,12 @@ policer_del (vlib_main_t *vm, u32 policer_index)
       hash_unset_mem (pm->policer_config_by_name, policer->name);
     }
 
+  if (policer->lease_index != ~0)
+    {
+      vec_free (pm->leases[policer->lease_index]);
+      pool_put_index (pm->leases, policer->lease_index);
+    }
+
   /* free policer */
   hash_unset_mem (pm->policer_index_by_name, policer->name);
   vec_free (policer->name);
@@ -134,7 +174,9 @@ policer_update (vlib_main_t *vm, u32 policer_index,
   policer_t test_policer;
   policer_t *policer;
   qos_pol_cfg_params_st *cp;
+  policer_lease_t *lease;
   uword *p;
+  u32 lease_index;
   u8 *name;
   int rv;
   int i;
@@ -164,12 +206,25 @@ policer_update (vlib_main_t *vm, u32 policer_index,
     }
 
   name = policer->name;
+  lease_index = policer->lease_index;
 
   clib_memcpy (cp, cfg, sizeof (*cp));
   clib_memcpy (policer, &test_policer, sizeof (*policer));
 
   policer->name = name;
   policer->thread_index = ~0;
+  policer->lease_index = lease_index;
+
+  if (lease_index != ~0)
+    {
+      /* the leased tokens were taken under the old configuration */
+      vec_foreach (lease, pm->leases[lease_index])
+	{
+	  lease->current_tokens = 0;
+	  lease->extended_tokens = 0;
+	}
+      policer_leases_flush (policer);
+    }
 
   for (i = 0; i < NUM_POLICE_RESULTS; i++)
     vlib_zero_combined_counter (&policer_counters[i], policer_index);
@@ -191,6 +246,9 @@ policer_reset (vlib_main_t *vm, u32 policer_index)
   policer->current_bucket = policer->current_limit;
   policer->extended_bucket = policer->extended_limit;
 
+  if (policer->lease_index != ~0)
+    policer_leases_flush (policer);
+
   return 0;
 }
 
@@ -212,6 +270,8 @@ policer_bind_worker (u32 policer_index, u32 worker, bool bind)
 	  return VNET_API_ERROR_INVALID_WORKER;
 	}
 
+      /* a policer tied to a worker is no longer shared */
+      policer_share (policer_index, false);
       policer->thread_index = vlib_get_worker_thread_index (worker);
     }
   else
@@ -221,6 +281,41 @@ policer_bind_worker (u32 policer_index, u32 worker, bool bind)
   return 0;
 }
 
+int
+policer_share (u32 policer_index, bool share)
+{
+  vnet_policer_main_t *pm = &vnet_policer_main;
+  policer_lease_t **leases;
+  policer_t *policer;
+
+  if (pool_is_free_index (pm->policers, policer_index))
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  policer = &pm->policers[policer_index];
+
+  if (share == (policer->lease_index != ~0))
+    return 0;
+
+  if (share)
+    {
+      pool_get (pm->leases, leases);
+      leases[0] = 0;
+      vec_validate_aligned (leases[0], vlib_get_n_threads () - 1,
+			    CLIB_CACHE_LINE_BYTES);
+      policer->lease_index = leases - pm->leases;
+      policer->thread_index = ~0;
+      policer_leases_flush (policer);
+    }
+  else
+    {
+      policer_leases_flush (policer);
+      vec_free (pm->leases[policer->lease_index]);
+      pool_put_index (pm->leases, policer->lease_index);
+      policer->lease_index = ~0;
+    }
+  return 0;
+}
+
 int
 policer_input (u32 policer_index, u32 sw_if_index, vlib_dir_t dir, bool apply)
 {
@@ -278,6 +373,9 @@ format_policer_instance (u8 * s, va_list * va)
 	      i->current_limit,
 	      i->current_bucket, i->extended_limit, i->extended_bucket);
   s = format (s, "last update %llu\n", i->last_update_time);
+  if (i->lease_index != ~0)
+    s = format (s, "shared, lease quantum %u\n",
+		pm->leases[i->lease_index][0].quantum);
   s = format (s, "conform %llu packets, %llu bytes\n",
 	      counts[POLICE_CONFORM].packets, counts[POLICE_CONFORM].bytes);
   s = format (s, "exceed %llu packets, %llu bytes\n",
@@ -764,6 +862,60 @@ done:
   return error;
 }
 
+static clib_error_t *
+policer_share_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			  vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  clib_error_t *error = NULL;
+  vnet_policer_main_t *pm = &vnet_policer_main;
+  u8 share = 1;
+  u8 *name = 0;
+  u32 policer_index = ~0;
+  uword *p;
+  int rv;
+
+  /* Get a line of input. */
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "name %s", &name))
+	;
+      else if (unformat (line_input, "index %u", &policer_index))
+	;
+      else if (unformat (line_input, "unshare"))
+	share = 0;
+      else
+	{
+	  error = clib_error_return (0, "unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (~0 == policer_index && 0 != name)
+    {
+      p = hash_get_mem (pm->policer_index_by_name, name);
+      if (p != NULL)
+	policer_index = p[0];
+    }
+
+  rv = VNET_API_ERROR_NO_SUCH_ENTRY;
+  if (~0 != policer_index)
+    rv = policer_share (policer_index, share);
+
+  if (rv)
+    error = clib_error_return (0, "failed: `%d'", rv);
+
+done:
+  unformat_free (line_input);
+  vec_free (name);
+
+  return error;
+}
+
 static clib_error_t *
 policer_input_command_fn (vlib_main_t *vm, unformat_input_t *input,
 			  vlib_cli_command_t *cmd)
@@ -923,6 +1075,12 @@ VLIB_CLI_COMMAND (policer_bind_command, static) = {
   .function = policer_bind_command_fn,
 };
 
+VLIB_CLI_COMMAND (policer_share_command, static) = {
+  .path = "policer share",
+  .short_help = "policer share [unshare] [name <name> | index <index>]",
+  .function = policer_share_command_fn,
+};
+
 VLIB_CLI_COMMAND (policer_input_command, static) = {
   .path = "policer input",
   .short_help =
@@ -32,6 +32,9 @@ typedef struct
   qos_pol_cfg_params_st *configs;
   policer_t *policer_templates;
 
+  /* pool of per-worker token lease vectors of shared policers */
+  policer_lease_t **leases;
+
   /* Config by policer name hash */
   uword *policer_config_by_name;
 
@@ -79,6 +82,7 @@ int policer_update (vlib_main_t *vm, u32 policer_index,
 int policer_del (vlib_main_t *vm, u32 policer_index);
 int policer_reset (vlib_main_t *vm, u32 policer_index);
 int policer_bind_worker (u32 policer_index, u32 worker, bool bind);
+int policer_share (u32 policer_index, bool share);
 int policer_input (u32 policer_index, u32 sw_if_index, vlib_dir_t dir,
 		   bool apply);
 
@@ -221,6 +221,20 @@ vl_api_policer_bind_v2_t_handler (vl_api_policer_bind_v2_t *mp)
   REPLY_MACRO (VL_API_POLICER_BIND_V2_REPLY);
 }
 
+static void
+vl_api_policer_share_t_handler (vl_api_policer_share_t *mp)
+{
+  vl_api_policer_share_reply_t *rmp;
+  u32 policer_index;
+  int rv;
+
+  policer_index = ntohl (mp->policer_index);
+
+  rv = policer_share (policer_index, mp->share_enable);
+
+  REPLY_MACRO (VL_API_POLICER_SHARE_REPLY);
+}
+
 static void
 vl_api_policer_input_t_handler (vl_api_policer_input_t *mp)
 {
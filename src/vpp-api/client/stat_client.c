@@ -445,6 +445,238 @@ stat_segment_dump (uint32_t * stats)
   return stat_segment_dump_r (stats, sm);
 }
 
+/* Replace the per thread vectors of a counter with a single vector of
+   their totals */
+static void
+fold_threads (stat_segment_data_t *r)
+{
+  counter_t *st = 0;
+  vlib_counter_t *ct = 0;
+  int i, j;
+
+  switch (r->type)
+    {
+    case STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE:
+      for (i = 0; i < vec_len (r->simple_counter_vec); i++)
+	{
+	  counter_t *c = r->simple_counter_vec[i];
+	  if (vec_len (c) > vec_len (st))
+	    vec_validate (st, vec_len (c) - 1);
+	  for (j = 0; j < vec_len (c); j++)
+	    st[j] += c[j];
+	  vec_free (c);
+	}
+      vec_reset_length (r->simple_counter_vec);
+      vec_add1 (r->simple_counter_vec, st);
+      break;
+
+    case STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED:
+      for (i = 0; i < vec_len (r->combined_counter_vec); i++)
+	{
+	  vlib_counter_t *c = r->combined_counter_vec[i];
+	  if (vec_len (c) > vec_len (ct))
+	    vec_validate (ct, vec_len (c) - 1);
+	  for (j = 0; j < vec_len (c); j++)
+	    {
+	      ct[j].packets += c[j].packets;
+	      ct[j].bytes += c[j].bytes;
+	    }
+	  vec_free (c);
+	}
+      vec_reset_length (r->combined_counter_vec);
+      vec_add1 (r->combined_counter_vec, ct);
+      break;
+
+    default:
+      break;
+    }
+}
+
+static vlib_stats_snapshot_t *
+get_snapshot_r (stat_client_main_t *sm)
+{
+  vlib_stats_shared_header_t *shared_header = sm->shared_header;
+  void *s;
+
+  /* zero on segments of older vpp, which leave the rest of the header
+   * page untouched */
+  s = (void *) __atomic_load_n (&shared_header->snapshot, __ATOMIC_ACQUIRE);
+  return s ? stat_segment_adjust (sm, s) : 0;
+}
+
+/*
+ * Copy the totals of a counter, or of one of its elements if index2 is
+ * specified, from the snapshot. Returns false if the snapshot does not
+ * have it.
+ */
+static bool
+copy_totals (vlib_stats_snapshot_t *s, vlib_stats_entry_t *ep, u32 index2,
+	     stat_segment_data_t *result, stat_client_main_t *sm)
+{
+  vlib_stats_snapshot_entry_t *entries, *se;
+  u32 index = ep - sm->directory_vector;
+
+  entries = stat_segment_adjust (sm, s->entries);
+  if (!entries || index >= vec_len (entries))
+    return false;
+
+  se = entries + index;
+  if (se->type != ep->type)
+    return false;
+
+  switch (ep->type)
+    {
+    case STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE:
+      {
+	counter_t *t = stat_segment_adjust (sm, se->data), *c = 0;
+	if (index2 == ~0)
+	  c = stat_vec_dup (sm, t);
+	else if (index2 < vec_len (t))
+	  c = stat_vec_simple_init (t[index2]);
+	else
+	  return false;
+	vec_add1 (result->simple_counter_vec, c);
+      }
+      break;
+
+    case STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED:
+      {
+	vlib_counter_t *t = stat_segment_adjust (sm, se->data), *c = 0;
+	if (index2 == ~0)
+	  c = stat_vec_dup (sm, t);
+	else if (index2 < vec_len (t))
+	  c = stat_vec_combined_init (t[index2]);
+	else
+	  return false;
+	vec_add1 (result->combined_counter_vec, c);
+      }
+      break;
+
+    default:
+      return false;
+    }
+
+  result->type = ep->type;
+  return true;
+}
+
+/*
+ * Copy the totals of the stats from snapshot s into *resp. Returns 0 on
+ * success, 1 if the snapshot was rewritten or the directory moved while
+ * it was read, and -1 on error.
+ */
+static int
+dump_totals_snapshot (uint32_t *stats, vlib_stats_snapshot_t *s,
+		      stat_segment_data_t **resp, stat_client_main_t *sm)
+{
+  vlib_stats_shared_header_t *shared_header = sm->shared_header;
+  vlib_stats_entry_t *ep, *target;
+  stat_segment_data_t *res = 0, r;
+  stat_segment_access_t sa;
+  uint64_t generation;
+  bool need_epoch = false;
+  void *directory;
+  u32 index2;
+  int i, rv = -1;
+
+  generation = __atomic_load_n (&s->generation, __ATOMIC_ACQUIRE);
+  if (stat_segment_access_start (&sa, sm))
+    return -1;
+  directory = (void *) shared_header->directory_vector;
+
+  vec_alloc (res, vec_len (stats));
+
+  for (i = 0; i < vec_len (stats); i++)
+    {
+      if (stats[i] >= vec_len (sm->directory_vector))
+	goto fail;
+
+      ep = target = vec_elt_at_index (sm->directory_vector, stats[i]);
+      index2 = ~0;
+      if (ep->type == STAT_DIR_TYPE_SYMLINK)
+	{
+	  if (ep->index1 >= vec_len (sm->directory_vector))
+	    goto fail;
+	  target = vec_elt_at_index (sm->directory_vector, ep->index1);
+	  index2 = ep->index2;
+	}
+
+      clib_memset (&r, 0, sizeof (r));
+      if (copy_totals (s, target, index2, &r, sm))
+	{
+	  r.via_symlink = target != ep;
+	  r.name = strndup (ep->name, VLIB_STATS_MAX_NAME_SZ);
+	}
+      else
+	{
+	  /* not in the snapshot, read it as usual */
+	  r = copy_data (ep, ~0, 0, sm, false);
+	  fold_threads (&r);
+	  need_epoch = true;
+	}
+      vec_add1 (res, r);
+    }
+
+  /* the snapshot was not rewritten, nor the directory moved, meanwhile */
+  if (__atomic_load_n (&s->generation, __ATOMIC_ACQUIRE) == generation &&
+      !(generation & 1) && shared_header->directory_vector == directory &&
+      (!need_epoch || stat_segment_access_end (&sa, sm)))
+    {
+      *resp = res;
+      return 0;
+    }
+  rv = 1;
+
+fail:
+  stat_segment_data_free (res);
+  return rv;
+}
+
+/*
+ * Like stat_segment_dump_r (), but counter vectors come with a single
+ * vector of totals over all threads. If vpp keeps aggregated snapshots
+ * the totals are read from the last one, in a single pass which neither
+ * walks the per thread vectors nor depends on the segment epoch, so it
+ * does not fail when counters are added or grow meanwhile. Otherwise the
+ * per thread vectors are dumped and added up here.
+ *
+ * The segment is mapped read only, so a reader cannot pin the snapshot
+ * it reads; it checks the generation instead. A read is torn only if it
+ * outlasts an update interval, when the snapshot published next is read
+ * once more; if that one is torn too, this fails like any other dump.
+ */
+stat_segment_data_t *
+stat_segment_dump_totals_r (uint32_t *stats, stat_client_main_t *sm)
+{
+  stat_segment_data_t *res = 0;
+  vlib_stats_snapshot_t *s;
+  int i, rv;
+
+  s = get_snapshot_r (sm);
+  if (!s)
+    {
+      res = stat_segment_dump_r (stats, sm);
+      for (i = 0; i < vec_len (res); i++)
+	fold_threads (res + i);
+      return res;
+    }
+
+  /* the collector writes the two snapshots in turn, so once a read is
+   * torn the one published next is complete */
+  rv = dump_totals_snapshot (stats, s, &res, sm);
+  if (rv == 1)
+    rv = dump_totals_snapshot (stats, get_snapshot_r (sm), &res, sm);
+
+  return rv ? 0 : res;
+}
+
+stat_segment_data_t *
+stat_segment_dump_totals (uint32_t *stats)
+{
+  stat_client_main_t *sm = &stat_client_main;
+  return stat_segment_dump_totals_r (stats, sm);
+}
+
 /* Wrapper for accessing vectors from other languages */
 int
 stat_segment_vec_len (void *vec)
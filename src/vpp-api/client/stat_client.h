@@ -18,7 +18,7 @@
 #define included_stat_client_h
 
 #define STAT_VERSION_MAJOR     1
-#define STAT_VERSION_MINOR     2
+#define STAT_VERSION_MINOR     3
 
 #include <stdint.h>
 #include <unistd.h>
@@ -76,6 +76,9 @@ stat_segment_data_t *stat_segment_dump (uint32_t * counter_vec);
 stat_segment_data_t *stat_segment_dump_entry_r (uint32_t index,
 						stat_client_main_t * sm);
 stat_segment_data_t *stat_segment_dump_entry (uint32_t index);
+stat_segment_data_t *stat_segment_dump_totals_r (uint32_t *stats,
+						 stat_client_main_t *sm);
+stat_segment_data_t *stat_segment_dump_totals (uint32_t *stats);
 
 void stat_segment_data_free (stat_segment_data_t * res);
 double stat_segment_heartbeat_r (stat_client_main_t * sm);
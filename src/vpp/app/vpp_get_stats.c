@@ -102,6 +102,60 @@ stat_poll_loop (u8 ** patterns)
     }
 }
 
+static u64
+stat_n_counters (stat_segment_data_t *res)
+{
+  u64 n = 0;
+  int i, k;
+
+  for (i = 0; i < vec_len (res); i++)
+    if (res[i].type == STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE)
+      for (k = 0; k < vec_len (res[i].simple_counter_vec); k++)
+	n += vec_len (res[i].simple_counter_vec[k]);
+    else if (res[i].type == STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED)
+      for (k = 0; k < vec_len (res[i].combined_counter_vec); k++)
+	n += vec_len (res[i].combined_counter_vec[k]);
+  return n;
+}
+
+/*
+ * Time scrapes of the per thread counters against scrapes of their
+ * totals, failed scrapes (epoch changes) included, each retried until
+ * it succeeds.
+ */
+static void
+stat_bench (u8 **patterns, u32 iterations)
+{
+  stat_segment_data_t *res;
+  u64 t, ns[2] = {}, n_failed[2] = {}, n_counters[2] = {};
+  u32 *dir = stat_segment_ls (patterns);
+  int i, which;
+
+  for (which = 0; which < 2; which++)
+    for (i = 0; i < iterations; i++)
+      {
+	t = _time_now_nsec ();
+	while (!(res = which ? stat_segment_dump_totals (dir) :
+			       stat_segment_dump (dir)))
+	  {
+	    n_failed[which]++;
+	    vec_free (dir);
+	    dir = stat_segment_ls (patterns);
+	  }
+	ns[which] += _time_now_nsec () - t;
+	n_counters[which] = stat_n_counters (res);
+	stat_segment_data_free (res);
+      }
+
+  fformat (stdout, "%u entries, %u scrapes each\n", vec_len (dir),
+	   iterations);
+  fformat (stdout, "per thread: %12llu counters %10.2f us/scrape %llu failed\n",
+	   n_counters[0], (f64) ns[0] / iterations / 1e3, n_failed[0]);
+  fformat (stdout, "totals:     %12llu counters %10.2f us/scrape %llu failed\n",
+	   n_counters[1], (f64) ns[1] / iterations / 1e3, n_failed[1]);
+  vec_free (dir);
+}
+
 enum stat_client_cmd_e
 {
   STAT_CLIENT_CMD_UNKNOWN,
@@ -109,6 +163,7 @@ enum stat_client_cmd_e
   STAT_CLIENT_CMD_POLL,
   STAT_CLIENT_CMD_DUMP,
   STAT_CLIENT_CMD_TIGHTPOLL,
+  STAT_CLIENT_CMD_BENCH,
 };
 
 #ifdef CLIB_SANITIZE_ADDR
@@ -125,7 +180,8 @@ main (int argc, char **argv)
 {
   unformat_input_t _argv, *a = &_argv;
   u8 *stat_segment_name, *pattern = 0, **patterns = 0;
-  int rv;
+  int rv, totals = 0;
+  u32 iterations = 100;
   enum stat_client_cmd_e cmd = STAT_CLIENT_CMD_UNKNOWN;
 
   /* Create a heap of 64MB */
@@ -155,6 +211,14 @@ main (int argc, char **argv)
 	{
 	  cmd = STAT_CLIENT_CMD_TIGHTPOLL;
 	}
+      else if (unformat (a, "bench"))
+	{
+	  cmd = STAT_CLIENT_CMD_BENCH;
+	}
+      else if (unformat (a, "iterations %u", &iterations))
+	;
+      else if (unformat (a, "totals"))
+	totals = 1;
       else if (unformat (a, "%s", &pattern))
 	{
 	  vec_add1 (patterns, pattern);
@@ -162,7 +226,8 @@ main (int argc, char **argv)
       else
 	{
 	  fformat (stderr,
-		   "%s: usage [socket-name <name>] [ls|dump|poll] <patterns> ...\n",
+		   "%s: usage [socket-name <name>] [ls|dump [totals]|poll|"
+		   "bench [iterations <n>]] <patterns> ...\n",
 		   argv[0]);
 	  exit (1);
 	}
@@ -197,7 +262,7 @@ reconnect:
       break;
 
     case STAT_CLIENT_CMD_DUMP:
-      res = stat_segment_dump (dir);
+      res = totals ? stat_segment_dump_totals (dir) : stat_segment_dump (dir);
       for (i = 0; i < vec_len (res); i++)
 	{
 	  switch (res[i].type)
@@ -253,6 +318,10 @@ reconnect:
       goto reconnect;
       break;
 
+    case STAT_CLIENT_CMD_BENCH:
+      stat_bench (patterns, iterations);
+      break;
+
     case STAT_CLIENT_CMD_TIGHTPOLL:
       while (1)
 	{
@@ -270,7 +339,8 @@ reconnect:
 
     default:
       fformat (stderr,
-	       "%s: usage [socket-name <name>] [ls|dump|poll] <patterns> ...\n",
+	       "%s: usage [socket-name <name>] [ls|dump [totals]|poll|"
+		   "bench [iterations <n>]] <patterns> ...\n",
 	       argv[0]);
     }
 
@@ -0,0 +1,169 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+/*
+ * Read the sampled packet traces of a running vpp, see 'trace sample',
+ * without stopping its workers.
+ */
+
+#include <vppinfra/clib.h>
+#include <vppinfra/mem.h>
+#include <vppinfra/format.h>
+#include <vppinfra/time.h>
+#include <vlib/trace_ring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+typedef struct
+{
+  vlib_trace_ring_header_t *h;
+  u64 *next;
+  int hex;
+} trace_samples_main_t;
+
+static void
+print_record (trace_samples_main_t *tsm, u32 thread_index,
+	      vlib_trace_ring_record_t *rec)
+{
+  vlib_trace_ring_header_t *h = tsm->h;
+  char *name = vlib_trace_ring_node_name (h, rec->node_index);
+  f64 t;
+
+  t = h->unix_time_base +
+      (f64) (rec->time - h->cpu_time_base) / h->clocks_per_second;
+
+  if (name)
+    fformat (stdout, "%.6f thread %u packet %u/%u %s", t, thread_index,
+	     rec->trace_id >> 24, rec->trace_id & 0x00FFFFFF, name);
+  else
+    fformat (stdout, "%.6f thread %u packet %u/%u node %u", t, thread_index,
+	     rec->trace_id >> 24, rec->trace_id & 0x00FFFFFF,
+	     rec->node_index);
+
+  if (tsm->hex)
+    fformat (stdout, "\n  %U\n", format_hexdump, rec->data, rec->n_data);
+  else
+    fformat (stdout, " %u bytes\n", rec->n_data);
+}
+
+/* Print the records added to each ring since the last call */
+static void
+print_new_records (trace_samples_main_t *tsm)
+{
+  vlib_trace_ring_header_t *h = tsm->h;
+  u64 rec_data[VLIB_TRACE_RING_RECORD_SIZE / sizeof (u64)];
+  vlib_trace_ring_record_t *rec = (vlib_trace_ring_record_t *) rec_data;
+  vlib_trace_ring_t *ring;
+  u64 head, index, n_lost;
+  u32 i;
+
+  for (i = 0; i < h->n_threads; i++)
+    {
+      ring = vlib_trace_ring_get (h, i);
+      head = clib_atomic_load_acq_n (&ring->head);
+
+      index = tsm->next[i];
+      if (head - index > h->n_records)
+	index = head - h->n_records;
+
+      for (n_lost = 0; index < head; index++)
+	if (vlib_trace_ring_read (ring, h->n_records, index, rec))
+	  print_record (tsm, i, rec);
+	else
+	  n_lost++;
+
+      if (n_lost)
+	fformat (stdout, "thread %u: %llu records overwritten while read\n",
+		 i, n_lost);
+      tsm->next[i] = head;
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  trace_samples_main_t _tsm = {}, *tsm = &_tsm;
+  unformat_input_t _argv, *a = &_argv;
+  u8 *file = (u8 *) "/run/vpp/trace-samples";
+  vlib_trace_ring_header_t *h;
+  f64 interval = 0;
+  struct stat st;
+  vlib_trace_ring_t *ring;
+  u32 i;
+  int fd;
+
+  clib_mem_init (0, 64 << 20);
+
+  unformat_init_command_line (a, argv);
+
+  while (unformat_check_input (a) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (a, "file %s", &file))
+	vec_add1 (file, 0);
+      else if (unformat (a, "follow %f", &interval))
+	;
+      else if (unformat (a, "follow"))
+	interval = 0.1;
+      else if (unformat (a, "hex"))
+	tsm->hex = 1;
+      else
+	{
+	  fformat (stderr,
+		   "%s: usage [file <path>] [follow [<seconds>]] [hex]\n",
+		   argv[0]);
+	  exit (1);
+	}
+    }
+
+  fd = open ((char *) file, O_RDONLY);
+  if (fd < 0 || fstat (fd, &st) < 0)
+    {
+      fformat (stderr, "Couldn't open %s, is sampled tracing on?\n", file);
+      exit (1);
+    }
+
+  h = mmap (0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (h == MAP_FAILED)
+    {
+      fformat (stderr, "Couldn't map %s\n", file);
+      exit (1);
+    }
+
+  if (st.st_size < (off_t) sizeof (*h) ||
+      clib_atomic_load_acq_n (&h->magic) != VLIB_TRACE_RING_MAGIC ||
+      h->version != VLIB_TRACE_RING_VERSION ||
+      h->record_size != VLIB_TRACE_RING_RECORD_SIZE ||
+      h->rings_offset + h->n_threads * h->ring_size > st.st_size)
+    {
+      fformat (stderr, "%s is not a trace sample file of this version\n",
+	       file);
+      exit (1);
+    }
+
+  tsm->h = h;
+  vec_validate (tsm->next, h->n_threads - 1);
+
+  fformat (stdout, "one in %u packets, %u threads, %u records per thread\n",
+	   h->sample_interval, h->n_threads, h->n_records);
+  for (i = 0; i < h->n_threads; i++)
+    {
+      ring = vlib_trace_ring_get (h, i);
+      fformat (stdout, "thread %u: %llu packets sampled, %llu traces too big\n",
+	       i, ring->n_sampled, ring->n_too_big);
+    }
+
+  do
+    {
+      print_new_records (tsm);
+      if (interval)
+	usleep (interval * 1e6);
+    }
+  while (interval);
+
+  munmap (h, st.st_size);
+  return 0;
+}
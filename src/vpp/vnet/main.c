@@ -545,6 +545,41 @@ VLIB_CLI_COMMAND (show_bihash_command, static) =
   .function = show_bihash_command_fn,
 };
 
+/*
+ * Adds and deletes move a few buckets of a resizing table each; this
+ * finishes the resize of tables that have stopped being written.
+ */
+static uword
+bihash_resize_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
+		       vlib_frame_t *f)
+{
+  f64 timeout = 1.0;
+  clib_bihash_8_8_t *h;
+  int i;
+
+  while (1)
+    {
+      vlib_process_wait_for_event_or_clock (vm, timeout);
+      vlib_process_get_events (vm, 0);
+
+      timeout = 1.0;
+      for (i = 0; i < vec_len (clib_all_bihashes); i++)
+	{
+	  h = (clib_bihash_8_8_t *) clib_all_bihashes[i];
+	  if (h->resize_step_fn (h, 1024))
+	    timeout = 1e-3;
+	}
+    }
+
+  return 0;
+}
+
+VLIB_REGISTER_NODE (bihash_resize_process_node) = {
+  .function = bihash_resize_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "bihash-resize-process",
+};
+
 #ifdef CLIB_SANITIZE_ADDR
 /* default options for Address Sanitizer */
 const char *
@@ -89,6 +89,47 @@ clib_bihash_key_compare_16_8 (u64 * a, u64 * b)
 #endif
 }
 
+#if defined(CLIB_HAVE_VEC512) || defined(CLIB_HAVE_VEC256)
+#define BIHASH_KVP_PAGE_MATCH 1
+
+/** Compare a key with all the keys of a page at once
+    @param kvp - the page's key/value pairs
+    @param key - search key
+    @return mask of the matching key/value pairs
+*/
+static_always_inline u32
+clib_bihash_key_match_page_16_8 (clib_bihash_kv_16_8_t *kvp, u64 *key)
+{
+  u64 *p = (u64 *) kvp;
+  u64 a = key[0], b = key[1];
+  u32 m;
+#if defined(CLIB_HAVE_VEC512)
+  u64x8 k0 = { a, b, 0, a, b, 0, a, b };
+  u64x4 k1 = { 0, a, b, 0 };
+
+  m = u64x8_is_equal_mask (u64x8_load_unaligned (p), k0);
+  m |= (u32) u64x4_is_equal_mask (u64x4_load_unaligned (p + 8), k1) << 8;
+#else
+  u64x4 k[3] = { { a, b, 0, a }, { b, 0, a, b }, { 0, a, b, 0 } };
+  u32 i, lanes;
+
+  for (m = 0, i = 0; i < 3; i++)
+    {
+      /* one bit per lane from the byte mask */
+      lanes = u8x32_msb_mask ((u8x32) (u64x4_load_unaligned (p + 4 * i) ==
+				       k[i]));
+      lanes &= 0x01010101;
+      lanes = (lanes | (lanes >> 7)) & 0x00030003;
+      lanes = (lanes | (lanes >> 14)) & 0xf;
+      m |= lanes << (4 * i);
+    }
+#endif
+  /* lane n is word n % 3 of kvp n / 3, which matches if words 0 and 1 do */
+  m &= m >> 1;
+  return (m & 1) | ((m >> 2) & 2) | ((m >> 4) & 4) | ((m >> 6) & 8);
+}
+#endif
+
 #undef __included_bihash_template_h__
 #include <vppinfra/bihash_template.h>
 
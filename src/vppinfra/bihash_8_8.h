@@ -99,6 +99,48 @@ clib_bihash_key_compare_8_8 (u64 a, u64 b)
   return a == b;
 }
 
+#if defined(CLIB_HAVE_VEC512) || defined(CLIB_HAVE_VEC256)
+#define BIHASH_KVP_PAGE_MATCH 1
+
+/** Compare a key with all the keys of a page at once
+    @param kvp - the page's key/value pairs
+    @param key - search key
+    @return mask of the matching key/value pairs
+*/
+static_always_inline u32
+clib_bihash_key_match_page_8_8 (clib_bihash_kv_8_8_t *kvp, u64 key)
+{
+  u64 *p = (u64 *) kvp;
+  u32 m;
+#if defined(CLIB_HAVE_VEC512)
+  u64x8 k = u64x8_splat (key);
+
+  /* keys are the even lanes, the two loads overlap on the 4th kvp */
+  m = u64x8_is_equal_mask (u64x8_load_unaligned (p), k);
+  m |= (u32) u64x8_is_equal_mask (u64x8_load_unaligned (p + 6), k) << 6;
+
+  /* kvp n is at bit 2n, compact */
+  m &= 0x1555;
+  m = (m | (m >> 1)) & 0x3333;
+  m = (m | (m >> 2)) & 0x0f0f;
+  m = (m | (m >> 4)) & 0x00ff;
+#else
+  u64x4 k = u64x4_splat (key);
+  u32 i, lanes;
+
+  /* keys are lanes 0 and 2, i.e. bits 0 and 16 of the byte mask */
+  for (m = 0, i = 0; i < 3; i++)
+    {
+      lanes = u8x32_msb_mask ((u8x32) (u64x4_load_unaligned (p + 4 * i) == k));
+      m |= ((lanes & 1) | ((lanes >> 15) & 2)) << (2 * i);
+    }
+  lanes = u8x32_msb_mask ((u8x32) (u64x4_load_unaligned (p + 10) == k));
+  m |= ((lanes >> 16) & 1) << 6;
+#endif
+  return m;
+}
+#endif
+
 #undef __included_bihash_template_h__
 #include <vppinfra/bihash_template.h>
 
@@ -114,9 +114,26 @@ void clib_bihash_init
  *   format_function_t - format function for the bihash kv pairs
  *   instantiate_immediately - allocate memory right away
  *   dont_add_to_all_bihash_list - dont mention in 'show bihash'
+ *   auto_resize - double the number of buckets as the table fills,
+ *     moving a few buckets per add or delete; requires reclaim_fn
+ *   reclaim_fn - call back once readers are done with retired pages
+ *     and buckets, e.g. vlib_rcu_call
  */
 void BV (clib_bihash_init2) (BVT (clib_bihash_init2_args) * a);
 
+/**
+ * Move buckets of a table that is being resized to the new buckets
+ *
+ * Adds and deletes move a few buckets each. A table that stops being
+ * written is finished by vpp's bihash-resize-process, which calls this
+ * for every table on clib_all_bihashes, or by its owner.
+ *
+ * @param h - the bi-hash table
+ * @param n_buckets - the most buckets to move, ~0 to finish the resize
+ * @return the number of buckets still to move
+ */
+u32 BV (clib_bihash_resize_step) (BVT (clib_bihash) * h, u32 n_buckets);
+
 /**
  * Set the formating function for the bihash
  *
@@ -254,6 +271,32 @@ void clib_bihash_prefetch_data (clib_bihash * h, u64 hash);
 int clib_bihash_search_inline_2
   (clib_bihash * h, clib_bihash_kv * search_key, clib_bihash_kv * valuep);
 
+/**
+ * Search a bi-hash table for a batch of keys, with the bucket and data
+ * prefetches of the keys pipelined
+ *
+ * @param h - the bi-hash table to search
+ * @param in_out_kvs - (key,value) pairs containing the search keys, those
+ *   found are set to the search result, the others are left alone
+ * @param n_kvs - number of keys
+ * @returns the number of keys found
+ */
+u32 clib_bihash_search_batch (clib_bihash * h, clib_bihash_kv * in_out_kvs,
+			      u32 n_kvs);
+
+/**
+ * Search a bi-hash table for a batch of keys with precomputed hash codes
+ *
+ * @param h - the bi-hash table to search
+ * @param hashes - the hash codes of the keys
+ * @param in_out_kvs - (key,value) pairs containing the search keys
+ * @param n_kvs - number of keys
+ * @returns the number of keys found
+ */
+u32 clib_bihash_search_batch_with_hash (clib_bihash * h, u64 * hashes,
+					clib_bihash_kv * in_out_kvs,
+					u32 n_kvs);
+
 /**
  * Calback function for walking a bihash table
  *
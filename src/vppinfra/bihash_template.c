@@ -27,6 +27,24 @@
 #define BIHASH_USE_HEAP 1
 #endif
 
+/*
+ * An auto-resizing table doubles once its buckets use this many pages
+ * on average, not counting those at the bucket level.
+ */
+#ifndef BIHASH_RESIZE_PAGES_PER_BUCKET
+#define BIHASH_RESIZE_PAGES_PER_BUCKET (2 - BIHASH_KVP_AT_BUCKET_LEVEL)
+#endif
+
+/* Buckets moved to the new table by each add or delete while resizing */
+#ifndef BIHASH_RESIZE_BUCKETS_PER_UPDATE
+#define BIHASH_RESIZE_BUCKETS_PER_UPDATE 2
+#endif
+
+static u32 BV (resize_step_any) (void *h, u32 n_buckets)
+{
+  return BV (clib_bihash_resize_step) (h, n_buckets);
+}
+
 static inline void *BV (alloc_aligned) (BVT (clib_bihash) * h, uword nbytes)
 {
   uword rv;
@@ -139,13 +157,55 @@ static inline void *BV (alloc_aligned) (BVT (clib_bihash) * h, uword nbytes)
   return (void *) (uword) (rv + alloc_arena (h));
 }
 
+/*
+ * Give back an allocation that has a heap chunk of its own, i.e. one that
+ * was at least the chunk size. Others are only freed with the table.
+ */
+static void BV (free_aligned) (BVT (clib_bihash) * h, void *p, uword nbytes)
+{
+  uword page_sz = sizeof (BVT (clib_bihash_value));
+  uword chunk_sz = round_pow2 (page_sz << BIIHASH_MIN_ALLOC_LOG2_PAGES,
+			       CLIB_CACHE_LINE_BYTES);
+  BVT (clib_bihash_alloc_chunk) * c;
+  void *oldheap;
+
+  if (BIHASH_USE_HEAP == 0 ||
+      round_pow2 (nbytes, CLIB_CACHE_LINE_BYTES) < chunk_sz)
+    return;
+
+  c = (BVT (clib_bihash_alloc_chunk) *) p - 1;
+
+  if (c->prev)
+    c->prev->next = c->next;
+  else
+    h->chunks = c->next;
+
+  if (c->next)
+    c->next->prev = c->prev;
+
+  oldheap = clib_mem_set_heap (h->heap);
+  clib_mem_free (c);
+  clib_mem_set_heap (oldheap);
+}
+
+static uword BV (bucket_array_size) (u32 nbuckets)
+{
+  uword bucket_size = sizeof (BVT (clib_bihash_bucket));
+
+  if (BIHASH_KVP_AT_BUCKET_LEVEL)
+    bucket_size += BIHASH_KVP_PER_PAGE * sizeof (BVT (clib_bihash_kv));
+
+  return bucket_size * nbuckets;
+}
+
 static void BV (clib_bihash_instantiate) (BVT (clib_bihash) * h)
 {
   uword bucket_size;
 
   if (BIHASH_USE_HEAP)
     {
-      h->heap = clib_mem_get_heap ();
+      if (h->heap == 0)
+	h->heap = clib_mem_get_heap ();
       h->chunks = 0;
       alloc_arena (h) = (uword) clib_mem_get_heap_base (h->heap);
     }
@@ -160,11 +220,7 @@ static void BV (clib_bihash_instantiate) (BVT (clib_bihash) * h)
       alloc_arena_mapped (h) = 0;
     }
 
-  bucket_size = h->nbuckets * sizeof (h->buckets[0]);
-
-  if (BIHASH_KVP_AT_BUCKET_LEVEL)
-    bucket_size +=
-      h->nbuckets * BIHASH_KVP_PER_PAGE * sizeof (BVT (clib_bihash_kv));
+  bucket_size = BV (bucket_array_size) (h->nbuckets);
 
   h->buckets = BV (alloc_aligned) (h, bucket_size);
   clib_memset_u8 (h->buckets, 0, bucket_size);
@@ -213,7 +269,26 @@ void BV (clib_bihash_init2) (BVT (clib_bihash_init2_args) * a)
   h->instantiated = 0;
   h->dont_add_to_all_bihash_list = a->dont_add_to_all_bihash_list;
   h->fmt_fn = BV (format_bihash);
+  h->resize_step_fn = BV (resize_step_any);
   h->kvp_fmt_fn = a->kvp_fmt_fn;
+  h->resizing = 0;
+  h->n_value_pages = 0;
+  h->heap = BIHASH_USE_HEAP ? a->heap : 0;
+  h->reclaim_fn = a->reclaim_fn;
+  h->n_reclaims_pending = 0;
+
+  /* a shared memory table cannot move its buckets */
+#if BIHASH_32_64_SVM
+  h->auto_resize = 0;
+#else
+  /*
+   * the old pages and buckets of a resize must outlive the readers that
+   * may still be searching them, which only the caller can tell
+   */
+  if (a->auto_resize && a->reclaim_fn == 0)
+    clib_panic ("bihash %s: auto_resize needs a reclaim_fn", a->name);
+  h->auto_resize = a->auto_resize;
+#endif
 
   alloc_arena (h) = 0;
 
@@ -344,6 +419,7 @@ void BV (clib_bihash_initiator_init_svm)
   h->freelists = (void *) (freelist_vh->vector_data);
 
   h->fmt_fn = BV (format_bihash);
+  h->resize_step_fn = BV (resize_step_any);
   h->kvp_fmt_fn = NULL;
   h->instantiated = 1;
 }
@@ -395,6 +471,7 @@ void BV (clib_bihash_responder_init_svm)
   h->alloc_lock = BV (clib_bihash_get_value) (h, h->sh->alloc_lock_as_u64);
   h->freelists = BV (clib_bihash_get_value) (h, h->sh->freelists_as_u64);
   h->fmt_fn = BV (format_bihash);
+  h->resize_step_fn = BV (resize_step_any);
   h->kvp_fmt_fn = NULL;
 }
 #endif /* BIHASH_32_64_SVM */
@@ -436,6 +513,14 @@ void BV (clib_bihash_free) (BVT (clib_bihash) * h)
 
   vec_free (h->working_copies);
   vec_free (h->working_copy_lengths);
+  /* the reclaim callbacks would free into the table */
+  ASSERT (h->n_reclaims_pending == 0);
+  vec_free (h->retired_pages);
+  for (i = 0; i < ARRAY_LEN (h->resize_kvs); i++)
+    {
+      vec_free (h->resize_kvs[i]);
+      vec_free (h->resize_hashes[i]);
+    }
   clib_mem_free ((void *) h->alloc_lock);
 #if BIHASH_32_64_SVM == 0
   vec_free (h->freelists);
@@ -489,6 +574,7 @@ BV (value_alloc) (BVT (clib_bihash) * h, u32 log2_pages)
 
 initialize:
   ASSERT (rv);
+  h->n_value_pages += 1 << log2_pages;
 
   BVT (clib_bihash_kv) * v;
   v = (BVT (clib_bihash_kv) *) rv;
@@ -509,25 +595,13 @@ BV (value_free) (BVT (clib_bihash) * h, BVT (clib_bihash_value) * v,
 
   ASSERT (vec_len (h->freelists) > log2_pages);
 
+  h->n_value_pages -= 1 << log2_pages;
+
   if (BIHASH_USE_HEAP && log2_pages >= BIIHASH_MIN_ALLOC_LOG2_PAGES)
     {
       /* allocations bigger or equal to chunk size always contain single
        * alloc and they can be given back to heap */
-      void *oldheap;
-      BVT (clib_bihash_alloc_chunk) * c;
-      c = (BVT (clib_bihash_alloc_chunk) *) v - 1;
-
-      if (c->prev)
-	c->prev->next = c->next;
-      else
-	h->chunks = c->next;
-
-      if (c->next)
-	c->next->prev = c->prev;
-
-      oldheap = clib_mem_set_heap (h->heap);
-      clib_mem_free (c);
-      clib_mem_set_heap (oldheap);
+      BV (free_aligned) (h, v, sizeof (*v) << log2_pages);
       return;
     }
 
@@ -594,7 +668,7 @@ BV (make_working_copy) (BVT (clib_bihash) * h, BVT (clib_bihash_bucket) * b)
 static
 BVT (clib_bihash_value) *
 BV (split_and_rehash)
-  (BVT (clib_bihash) * h,
+  (BVT (clib_bihash) * h, u32 log2_nbuckets,
    BVT (clib_bihash_value) * old_values, u32 old_log2_pages,
    u32 new_log2_pages)
 {
@@ -616,7 +690,7 @@ BV (split_and_rehash)
 
       /* rehash the item onto its new home-page */
       new_hash = BV (clib_bihash_hash) (&(old_values->kvp[i]));
-      new_hash = extract_bits (new_hash, h->log2_nbuckets, new_log2_pages);
+      new_hash = extract_bits (new_hash, log2_nbuckets, new_log2_pages);
       new_v = &new_values[new_hash];
 
       /* Across the new home-page */
@@ -686,6 +760,300 @@ BV (split_and_rehash_linear)
   return new_values;
 }
 
+/*
+ * Fill a bucket of the new table with kvps from the old, as a split would:
+ * try a few sizes of page array before falling back to linear search.
+ * Nobody else looks at the bucket until the resize index passes it.
+ */
+static void
+BV (resize_fill_bucket) (BVT (clib_bihash) * h, BVT (clib_bihash_bucket) * b,
+			 BVT (clib_bihash_kv) * kvs, u64 * hashes)
+{
+  BVT (clib_bihash_bucket) tmp_b = {.as_u64 = 0 };
+  BVT (clib_bihash_value) * v;
+  u32 log2_nbuckets, log2_pages, min_log2_pages, n_kvps, i, j, page;
+
+  log2_nbuckets = h->resize_log2_nbuckets + 1;
+  n_kvps = vec_len (kvs);
+
+#if BIHASH_KVP_AT_BUCKET_LEVEL
+  v = (void *) (b + 1);
+  for (i = 0; i < BIHASH_KVP_PER_PAGE; i++)
+    BV (clib_bihash_mark_free) (&v->kvp[i]);
+  tmp_b.offset = BV (clib_bihash_get_offset) (h, v);
+  tmp_b.refcnt = 1;
+
+  if (n_kvps <= BIHASH_KVP_PER_PAGE)
+    {
+      clib_memcpy_fast (v->kvp, kvs, n_kvps * sizeof (kvs[0]));
+      tmp_b.refcnt += n_kvps;
+      goto done;
+    }
+#else
+  if (n_kvps == 0)
+    goto done;
+#endif
+
+  min_log2_pages = max_log2 ((n_kvps + BIHASH_KVP_PER_PAGE - 1) /
+			     BIHASH_KVP_PER_PAGE);
+
+  for (log2_pages = min_log2_pages; log2_pages <= min_log2_pages + 2;
+       log2_pages++)
+    {
+      v = BV (value_alloc) (h, log2_pages);
+
+      for (i = 0; i < n_kvps; i++)
+	{
+	  page = extract_bits (hashes[i], log2_nbuckets, log2_pages);
+
+	  for (j = 0; j < BIHASH_KVP_PER_PAGE; j++)
+	    {
+	      if (BV (clib_bihash_is_free) (&v[page].kvp[j]))
+		{
+		  clib_memcpy_fast (&v[page].kvp[j], &kvs[i], sizeof (kvs[i]));
+		  break;
+		}
+	    }
+	  if (j == BIHASH_KVP_PER_PAGE)
+	    break;
+	}
+      if (i == n_kvps)
+	goto placed;
+
+      BV (value_free) (h, v, log2_pages);
+    }
+
+  /* pinned collisions, use linear search */
+  log2_pages = min_log2_pages;
+  v = BV (value_alloc) (h, log2_pages);
+  clib_memcpy_fast (v->kvp, kvs, n_kvps * sizeof (kvs[0]));
+  tmp_b.linear_search = 1;
+  BV (clib_bihash_increment_stat) (h, BIHASH_STAT_linear, 1);
+
+placed:
+  tmp_b.offset = BV (clib_bihash_get_offset) (h, v);
+  tmp_b.log2_pages = log2_pages;
+  tmp_b.refcnt = n_kvps + BIHASH_KVP_AT_BUCKET_LEVEL;
+
+done:
+  b->as_u64 = tmp_b.as_u64;
+}
+
+/*
+ * Move the kvps of a (locked) old bucket to the two new buckets they
+ * now hash to.
+ */
+static void
+BV (resize_move_bucket) (BVT (clib_bihash) * h, BVT (clib_bihash_bucket) * b,
+			 u32 index)
+{
+  BVT (clib_bihash_value) * v;
+  u32 log2, half, i, n_kvps;
+  u64 hash;
+
+  ASSERT (h->alloc_lock[0]);
+
+  log2 = h->resize_log2_nbuckets;
+
+  if (!BV (clib_bihash_bucket_is_empty) (b))
+    {
+      v = BV (clib_bihash_get_value) (h, b->offset);
+      n_kvps = BIHASH_KVP_PER_PAGE << b->log2_pages;
+
+      for (i = 0; i < n_kvps; i++)
+	{
+	  if (BV (clib_bihash_is_free) (&v->kvp[i]))
+	    continue;
+
+	  hash = BV (clib_bihash_hash) (&v->kvp[i]);
+	  half = (hash >> log2) & 1;
+	  vec_add1 (h->resize_kvs[half], v->kvp[i]);
+	  vec_add1 (h->resize_hashes[half], hash);
+	}
+
+      /*
+       * readers that chose the old bucket before the index moved may still
+       * be looking at its pages, so they are freed on the next step, or
+       * when the caller reclaims them.
+       */
+      if (BIHASH_KVP_AT_BUCKET_LEVEL == 0 || b->log2_pages > 0)
+	vec_add1 (h->retired_pages, b->as_u64);
+    }
+
+  for (half = 0; half < 2; half++)
+    {
+      BV (resize_fill_bucket)
+	(h,
+	 BV (clib_bihash_get_bucket_in) (h->resize_new_buckets, log2 + 1,
+					 index + (half << log2)),
+	 h->resize_kvs[half], h->resize_hashes[half]);
+      vec_reset_length (h->resize_kvs[half]);
+      vec_reset_length (h->resize_hashes[half]);
+    }
+}
+
+typedef struct
+{
+  BVT (clib_bihash) * h;
+  u64 *pages;
+  void *buckets;
+  uword buckets_size;
+} BVT (clib_bihash_reclaim);
+
+/*
+ * Take what was retired since the last call, for the caller's reclaim
+ * function to give back once readers are done with it.
+ */
+static void BV (reclaim_take) (BVT (clib_bihash) * h,
+			       BVT (clib_bihash_reclaim) * r)
+{
+  ASSERT (h->alloc_lock[0]);
+
+  r->h = h;
+  r->pages = h->retired_pages;
+  r->buckets = h->resize_retired_buckets;
+  r->buckets_size = h->resize_retired_size;
+  h->retired_pages = 0;
+  h->resize_retired_buckets = 0;
+
+  if (r->pages || r->buckets)
+    h->n_reclaims_pending++;
+}
+
+static void BV (reclaim_cb) (void *arg)
+{
+  BVT (clib_bihash_reclaim) *r = arg;
+  BVT (clib_bihash) * h = r->h;
+  BVT (clib_bihash_bucket) b;
+  u64 *as_u64;
+
+  BV (clib_bihash_alloc_lock) (h);
+  vec_foreach (as_u64, r->pages)
+    {
+      b.as_u64 = *as_u64;
+      BV (value_free) (h, BV (clib_bihash_get_value) (h, b.offset),
+		       b.log2_pages);
+    }
+  if (r->buckets)
+    BV (free_aligned) (h, r->buckets, r->buckets_size);
+  h->n_reclaims_pending--;
+  BV (clib_bihash_alloc_unlock) (h);
+
+  vec_free (r->pages);
+}
+
+/*
+ * Hand what was taken to the reclaim function. Not under the alloc lock:
+ * it may call back right away.
+ */
+static void BV (reclaim_give) (BVT (clib_bihash_reclaim) * r)
+{
+  if (r->pages || r->buckets)
+    r->h->reclaim_fn (BV (reclaim_cb), r, sizeof (*r));
+}
+
+/*
+ * Free pages a reader may still be searching, when the caller reclaims
+ * them. Otherwise at once, they only hold kvps that are elsewhere too.
+ */
+static void BV (value_retire) (BVT (clib_bihash) * h,
+			       BVT (clib_bihash_value) * v, u32 log2_pages)
+{
+  BVT (clib_bihash_bucket) b = { .as_u64 = 0 };
+
+  if (h->reclaim_fn == 0)
+    {
+      BV (value_free) (h, v, log2_pages);
+      return;
+    }
+
+  b.offset = BV (clib_bihash_get_offset) (h, v);
+  b.log2_pages = log2_pages;
+  vec_add1 (h->retired_pages, b.as_u64);
+}
+
+static void BV (resize_start) (BVT (clib_bihash) * h)
+{
+  ASSERT (h->alloc_lock[0]);
+  ASSERT (h->reclaim_fn);
+
+  /* the new buckets are initialized as the old ones are moved */
+  h->resize_new_buckets =
+    BV (alloc_aligned) (h, BV (bucket_array_size) (h->nbuckets << 1));
+  h->resize_old_buckets = h->buckets;
+  h->resize_log2_nbuckets = h->log2_nbuckets;
+  h->resize_index = 0;
+  CLIB_MEMORY_STORE_BARRIER ();
+  h->resizing = 1;
+}
+
+static void BV (resize_finish) (BVT (clib_bihash) * h)
+{
+  ASSERT (h->alloc_lock[0]);
+
+  h->resize_retired_buckets = h->buckets;
+  h->resize_retired_size = BV (bucket_array_size) (h->nbuckets);
+
+  h->buckets = h->resize_new_buckets;
+  h->nbuckets <<= 1;
+  h->log2_nbuckets += 1;
+  CLIB_MEMORY_STORE_BARRIER ();
+  h->resizing = 0;
+}
+
+u32 BV (clib_bihash_resize_step) (BVT (clib_bihash) * h, u32 n_buckets)
+{
+  BVT (clib_bihash_bucket) * b;
+  BVT (clib_bihash_reclaim) r = {};
+  u32 index, n_left;
+
+  if (PREDICT_TRUE (h->resizing == 0))
+    return 0;
+
+  BV (clib_bihash_alloc_lock) (h);
+
+  while (h->resizing && n_buckets)
+    {
+      index = h->resize_index;
+      b = BV (clib_bihash_get_bucket_in) (h->resize_old_buckets,
+					  h->resize_log2_nbuckets, index);
+
+      /*
+       * writers take the bucket lock before the alloc lock, so we must
+       * not wait for the bucket while holding the alloc lock
+       */
+      if (!BV (clib_bihash_trylock_bucket) (b))
+	{
+	  BV (clib_bihash_alloc_unlock) (h);
+	  CLIB_PAUSE ();
+	  BV (clib_bihash_alloc_lock) (h);
+	  continue;
+	}
+
+      BV (resize_move_bucket) (h, b, index);
+
+      /* writers waiting for the old bucket will find it has moved */
+      CLIB_MEMORY_STORE_BARRIER ();
+      h->resize_index = index + 1;
+      BV (clib_bihash_unlock_bucket) (b);
+
+      if (h->resize_index == 1 << h->resize_log2_nbuckets)
+	BV (resize_finish) (h);
+
+      n_buckets--;
+    }
+
+  n_left = 0;
+  if (h->resizing)
+    n_left = (1 << h->resize_log2_nbuckets) - h->resize_index;
+
+  BV (reclaim_take) (h, &r);
+  BV (clib_bihash_alloc_unlock) (h);
+  BV (reclaim_give) (&r);
+
+  return n_left;
+}
+
 static_always_inline int BV (clib_bihash_add_del_inline_with_hash) (
   BVT (clib_bihash) * h, BVT (clib_bihash_kv) * add_v, u64 hash, int is_add,
   int (*is_stale_cb) (BVT (clib_bihash_kv) *, void *), void *is_stale_arg,
@@ -695,7 +1063,7 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash) (
   BVT (clib_bihash_value) * v, *new_v, *save_new_v, *working_copy;
   int i, limit;
   u64 new_hash;
-  u32 new_log2_pages, old_log2_pages;
+  u32 new_log2_pages, old_log2_pages, log2_nbuckets;
   clib_thread_index_t thread_index = os_get_thread_index ();
   int mark_bucket_linear;
   int resplit_once;
@@ -731,10 +1099,25 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash) (
    */
   ASSERT ((is_add && BV (clib_bihash_is_free) (add_v)) == 0);
 
-  b = BV (clib_bihash_get_bucket) (h, hash);
+  if (PREDICT_FALSE (h->resizing))
+    BV (clib_bihash_resize_step) (h, BIHASH_RESIZE_BUCKETS_PER_UPDATE);
+
+again:
+  b = BV (clib_bihash_get_bucket_and_log2) (h, hash, &log2_nbuckets);
 
   BV (clib_bihash_lock_bucket) (b);
 
+  /*
+   * The bucket may have moved to a new table before we had it locked.
+   * Once locked it cannot.
+   */
+  if (PREDICT_FALSE (h->auto_resize) &&
+      b != BV (clib_bihash_get_bucket_and_log2) (h, hash, &log2_nbuckets))
+    {
+      BV (clib_bihash_unlock_bucket) (b);
+      goto again;
+    }
+
   /* First elt in the bucket? */
   if (BIHASH_KVP_AT_BUCKET_LEVEL == 0 && BV (clib_bihash_bucket_is_empty) (b))
     {
@@ -769,7 +1152,7 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash) (
       if (PREDICT_FALSE (b->linear_search))
 	limit <<= b->log2_pages;
       else
-	v += extract_bits (hash, h->log2_nbuckets, b->log2_pages);
+	v += extract_bits (hash, log2_nbuckets, b->log2_pages);
     }
 
   if (is_add)
@@ -931,16 +1314,16 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash) (
   resplit_once = 0;
   BV (clib_bihash_increment_stat) (h, BIHASH_STAT_splits, 1);
 
-  new_v = BV (split_and_rehash) (h, working_copy, old_log2_pages,
-				 new_log2_pages);
+  new_v = BV (split_and_rehash) (h, log2_nbuckets, working_copy,
+				 old_log2_pages, new_log2_pages);
   if (new_v == 0)
     {
     try_resplit:
       resplit_once = 1;
       new_log2_pages++;
       /* Try re-splitting. If that fails, fall back to linear search */
-      new_v = BV (split_and_rehash) (h, working_copy, old_log2_pages,
-				     new_log2_pages);
+      new_v = BV (split_and_rehash) (h, log2_nbuckets, working_copy,
+				     old_log2_pages, new_log2_pages);
       if (new_v == 0)
 	{
 	mark_linear:
@@ -964,7 +1347,7 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash) (
   if (mark_bucket_linear)
     limit <<= new_log2_pages;
   else
-    new_v += extract_bits (new_hash, h->log2_nbuckets, new_log2_pages);
+    new_v += extract_bits (new_hash, log2_nbuckets, new_log2_pages);
 
   for (i = 0; i < limit; i++)
     {
@@ -1007,12 +1390,27 @@ expand_ok:
 
       /* free the old bucket, except at the bucket level if so configured */
       v = BV (clib_bihash_get_value) (h, h->saved_bucket.offset);
-      BV (value_free) (h, v, h->saved_bucket.log2_pages);
+      BV (value_retire) (h, v, h->saved_bucket.log2_pages);
 
 #if BIHASH_KVP_AT_BUCKET_LEVEL
     }
 #endif
 
+  if (PREDICT_FALSE (h->auto_resize) && h->resizing == 0 &&
+      h->log2_nbuckets < 31 &&
+      h->n_value_pages >=
+	(u64) h->nbuckets * BIHASH_RESIZE_PAGES_PER_BUCKET)
+    BV (resize_start) (h);
+
+  if (h->reclaim_fn)
+    {
+      BVT (clib_bihash_reclaim) r;
+
+      BV (reclaim_take) (h, &r);
+      BV (clib_bihash_alloc_unlock) (h);
+      BV (reclaim_give) (&r);
+      return (0);
+    }
 
   BV (clib_bihash_alloc_unlock) (h);
   return (0);
@@ -1064,6 +1462,28 @@ int BV (clib_bihash_search)
   return BV (clib_bihash_search_inline_2) (h, search_key, valuep);
 }
 
+/*
+ * The bucket at an index of a table, or while it is being resized of the
+ * old and new tables; an index of the new table whose bucket is still
+ * in the old has none.
+ */
+static BVT (clib_bihash_bucket) *
+BV (clib_bihash_get_bucket_by_index) (BVT (clib_bihash) * h, u32 i)
+{
+  u32 log2 = h->resize_log2_nbuckets;
+
+  if (h->resizing == 0)
+    return BV (clib_bihash_get_bucket) (h, i);
+
+  if ((i & pow2_mask (log2)) < h->resize_index)
+    return BV (clib_bihash_get_bucket_in) (h->resize_new_buckets, log2 + 1,
+					   i);
+  if (i < (1 << log2))
+    return BV (clib_bihash_get_bucket_in) (h->resize_old_buckets, log2, i);
+
+  return 0;
+}
+
 u8 *BV (format_bihash) (u8 * s, va_list * args)
 {
   BVT (clib_bihash) * h = va_arg (*args, BVT (clib_bihash) *);
@@ -1074,6 +1494,7 @@ u8 *BV (format_bihash) (u8 * s, va_list * args)
   u64 active_elements = 0;
   u64 active_buckets = 0;
   u64 linear_buckets = 0;
+  u32 nbuckets;
 
   s = format (s, "Hash table '%s'\n", h->name ? h->name : (u8 *) "(unnamed)");
 
@@ -1082,9 +1503,19 @@ u8 *BV (format_bihash) (u8 * s, va_list * args)
     return format (s, "    empty, uninitialized");
 #endif
 
-  for (i = 0; i < h->nbuckets; i++)
+  nbuckets = h->nbuckets;
+  if (h->resizing)
     {
-      b = BV (clib_bihash_get_bucket) (h, i);
+      nbuckets = 2 << h->resize_log2_nbuckets;
+      s = format (s, "    resizing to %u buckets, %u of %u moved\n",
+		  nbuckets, h->resize_index, h->nbuckets);
+    }
+
+  for (i = 0; i < nbuckets; i++)
+    {
+      b = BV (clib_bihash_get_bucket_by_index) (h, i);
+      if (b == 0)
+	continue;
       if (BV (clib_bihash_bucket_is_empty) (b))
 	{
 	  if (verbose > 1)
@@ -1197,6 +1628,7 @@ void BV (clib_bihash_foreach_key_value_pair)
   int i, j, k;
   BVT (clib_bihash_bucket) * b;
   BVT (clib_bihash_value) * v;
+  u8 auto_resize;
 
 
 #if BIHASH_LAZY_INSTANTIATE
@@ -1204,6 +1636,14 @@ void BV (clib_bihash_foreach_key_value_pair)
     return;
 #endif
 
+  /*
+   * The callback may add or delete, which must not move buckets under
+   * us: finish any resize and start no other until the walk is done.
+   */
+  BV (clib_bihash_resize_step) (h, ~0);
+  auto_resize = h->auto_resize;
+  h->auto_resize = 0;
+
   for (i = 0; i < h->nbuckets; i++)
     {
       b = BV (clib_bihash_get_bucket) (h, i);
@@ -1219,7 +1659,7 @@ void BV (clib_bihash_foreach_key_value_pair)
 		continue;
 
 	      if (BIHASH_WALK_STOP == cb (&v->kvp[k], arg))
-		return;
+		goto done;
 	      /*
 	       * In case the callback deletes the last entry in the bucket...
 	       */
@@ -1231,6 +1671,8 @@ void BV (clib_bihash_foreach_key_value_pair)
     doublebreak:
       ;
     }
+done:
+  h->auto_resize = auto_resize;
 }
 
 /** @endcond */
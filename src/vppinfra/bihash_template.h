@@ -48,6 +48,16 @@
 #define BIHASH_LOG2_HUGEPAGE_SIZE 21
 #endif
 
+/* how many keys ahead a batch search loads buckets, pages at half that */
+#ifndef BIHASH_SEARCH_BATCH_AHEAD
+#define BIHASH_SEARCH_BATCH_AHEAD 8
+#endif
+
+/* keys hashed at a time by a batch search */
+#ifndef BIHASH_SEARCH_BATCH_SIZE
+#define BIHASH_SEARCH_BATCH_SIZE 256
+#endif
+
 #define _bv(a,b) a##b
 #define __bv(a,b) _bv(a,b)
 #define BV(a) __bv(a,BIHASH_TYPE)
@@ -154,11 +164,53 @@ BVS (clib_bihash)
   u64 memory_size;
   u8 *name;
   format_function_t *fmt_fn;
+  /** clib_bihash_resize_step, for those walking clib_all_bihashes */
+  u32 (*resize_step_fn) (void *h, u32 n_buckets);
   void *heap;
   BVT (clib_bihash_alloc_chunk) * chunks;
 
   u64 *freelists;
 
+  /**
+   * Incremental resize. While resizing, the buckets of resize_old_buckets
+   * below resize_index have been moved to resize_new_buckets, which has
+   * twice as many. The buckets and their number are constant for the
+   * duration of the resize, so readers need only test resizing and then
+   * compare with the index.
+   */
+  volatile u8 resizing;
+  u8 auto_resize;
+  volatile u32 resize_index;
+  u32 resize_log2_nbuckets;
+  BVT (clib_bihash_bucket) * resize_old_buckets;
+  BVT (clib_bihash_bucket) * resize_new_buckets;
+
+  /**
+   * Pages readers may still be searching: moved by the last resize step
+   * and freed by the next, or, with a reclaim function, also replaced by
+   * splits and freed once it calls back
+   */
+  u64 *retired_pages;
+
+  /** Bucket array replaced by the last resize, for reclaim_fn */
+  void *resize_retired_buckets;
+  uword resize_retired_size;
+
+  /**
+   * Call fn with a copy of arg once no reader can still be looking at
+   * what was retired before the call, e.g. vlib_rcu_call. Required to
+   * auto-resize, optional otherwise.
+   */
+  void (*reclaim_fn) (void (*fn) (void *), void *arg, u32 arg_size);
+  u32 n_reclaims_pending;
+
+  /** Per new bucket scratch for moving a bucket */
+  BVT (clib_bihash_kv) * resize_kvs[2];
+  u64 *resize_hashes[2];
+
+  /** Number of pages in use by the buckets, decides when to resize */
+  u64 n_value_pages;
+
 #if BIHASH_32_64_SVM
   BVT (clib_bihash_shared_header) * sh;
   int memfd;
@@ -194,6 +246,11 @@ typedef struct
   format_function_t *kvp_fmt_fn;
   u8 instantiate_immediately;
   u8 dont_add_to_all_bihash_list;
+  u8 auto_resize;
+  /* heap the table is allocated from, default the current one */
+  void *heap;
+  /* defers frees past readers, see clib_bihash_t; needed by auto_resize */
+  void (*reclaim_fn) (void (*fn) (void *), void *arg, u32 arg_size);
 } BVT (clib_bihash_init2_args);
 
 extern void **clib_all_bihashes;
@@ -294,6 +351,14 @@ try_again:
     }
 }
 
+static inline int BV (clib_bihash_trylock_bucket)
+  (BVT (clib_bihash_bucket) * b)
+{
+  BVT (clib_bihash_bucket) mask = { .lock = 1 };
+
+  return !(clib_atomic_fetch_or (&b->as_u64, mask.as_u64) & mask.as_u64);
+}
+
 static inline void BV (clib_bihash_unlock_bucket)
   (BVT (clib_bihash_bucket) * b)
 {
@@ -371,6 +436,8 @@ int BV (clib_bihash_search) (BVT (clib_bihash) * h,
 
 int BV (clib_bihash_is_initialised) (const BVT (clib_bihash) * h);
 
+u32 BV (clib_bihash_resize_step) (BVT (clib_bihash) * h, u32 n_buckets);
+
 #define BIHASH_WALK_STOP 0
 #define BIHASH_WALK_CONTINUE 1
 
@@ -403,13 +470,106 @@ BV (clib_bihash_get_bucket) (BVT (clib_bihash) * h, u64 hash)
 #endif
 }
 
+static inline
+BVT (clib_bihash_bucket) *
+BV (clib_bihash_get_bucket_in) (BVT (clib_bihash_bucket) * buckets,
+				u32 log2_nbuckets, u64 hash)
+{
+#if BIHASH_KVP_AT_BUCKET_LEVEL
+  uword offset;
+  offset = (hash & pow2_mask (log2_nbuckets));
+  offset = offset * (sizeof (BVT (clib_bihash_bucket))
+		     + (BIHASH_KVP_PER_PAGE * sizeof (BVT (clib_bihash_kv))));
+  return ((BVT (clib_bihash_bucket) *) (((u8 *) buckets) + offset));
+#else
+  return buckets + (hash & pow2_mask (log2_nbuckets));
+#endif
+}
+
+/*
+ * The bucket a hash is in, and the log2 number of buckets of its table,
+ * which selects the page within the bucket, whether or not the table
+ * is being resized.
+ */
+static inline
+BVT (clib_bihash_bucket) *
+BV (clib_bihash_get_bucket_and_log2) (BVT (clib_bihash) * h, u64 hash,
+				      u32 * log2_nbuckets)
+{
+  u32 log2;
+
+  if (PREDICT_TRUE (h->resizing == 0))
+    {
+      *log2_nbuckets = h->log2_nbuckets;
+      return BV (clib_bihash_get_bucket) (h, hash);
+    }
+
+  log2 = h->resize_log2_nbuckets;
+
+  if ((hash & pow2_mask (log2)) < h->resize_index)
+    {
+      *log2_nbuckets = log2 + 1;
+      return BV (clib_bihash_get_bucket_in) (h->resize_new_buckets, log2 + 1,
+					     hash);
+    }
+
+  *log2_nbuckets = log2;
+  return BV (clib_bihash_get_bucket_in) (h->resize_old_buckets, log2, hash);
+}
+
+/*
+ * Search pages of kvps for a key. The first slot whose key matches
+ * decides; if it is free the key is not present. A kvp type can provide
+ * clib_bihash_key_match_page to compare all the keys in a page at once,
+ * returning the mask of the slots that match.
+ */
+static_always_inline int BV (clib_bihash_search_pages)
+  (BVT (clib_bihash_value) * v, int n_pages,
+   BVT (clib_bihash_kv) * search_key, BVT (clib_bihash_kv) * valuep)
+{
+  BVT (clib_bihash_kv) rv;
+
+#ifdef BIHASH_KVP_PAGE_MATCH
+  u32 match;
+
+  for (; n_pages > 0; n_pages--, v++)
+    {
+      match = BV (clib_bihash_key_match_page) (v->kvp, search_key->key);
+      if (match)
+	{
+	  rv = v->kvp[count_trailing_zeros (match)];
+	  goto found;
+	}
+    }
+  return -1;
+#else
+  int i, limit = n_pages * BIHASH_KVP_PER_PAGE;
+
+  for (i = 0; i < limit; i++)
+    {
+      if (BV (clib_bihash_key_compare) (v->kvp[i].key, search_key->key))
+	{
+	  rv = v->kvp[i];
+	  goto found;
+	}
+    }
+  return -1;
+#endif
+
+found:
+  if (BV (clib_bihash_is_free) (&rv))
+    return -1;
+  *valuep = rv;
+  return 0;
+}
+
 static inline int BV (clib_bihash_search_inline_with_hash)
   (BVT (clib_bihash) * h, u64 hash, BVT (clib_bihash_kv) * key_result)
 {
-  BVT (clib_bihash_kv) rv;
   BVT (clib_bihash_value) * v;
   BVT (clib_bihash_bucket) * b;
-  int i, limit;
+  u32 log2_nbuckets;
+  int n_pages;
 
   static const BVT (clib_bihash_bucket) mask = {
     .linear_search = 1,
@@ -421,7 +581,7 @@ static inline int BV (clib_bihash_search_inline_with_hash)
     return -1;
 #endif
 
-  b = BV (clib_bihash_get_bucket) (h, hash);
+  b = BV (clib_bihash_get_bucket_and_log2) (h, hash, &log2_nbuckets);
 
   if (PREDICT_FALSE (BV (clib_bihash_bucket_is_empty) (b)))
     return -1;
@@ -436,28 +596,17 @@ static inline int BV (clib_bihash_search_inline_with_hash)
   v = BV (clib_bihash_get_value) (h, b->offset);
 
   /* If the bucket has unresolvable collisions, use linear search */
-  limit = BIHASH_KVP_PER_PAGE;
+  n_pages = 1;
 
   if (PREDICT_FALSE (b->as_u64 & mask.as_u64))
     {
       if (PREDICT_FALSE (b->linear_search))
-	limit <<= b->log2_pages;
+	n_pages <<= b->log2_pages;
       else
-	v += extract_bits (hash, h->log2_nbuckets, b->log2_pages);
+	v += extract_bits (hash, log2_nbuckets, b->log2_pages);
     }
 
-  for (i = 0; i < limit; i++)
-    {
-      if (BV (clib_bihash_key_compare) (v->kvp[i].key, key_result->key))
-	{
-	  rv = v->kvp[i];
-	  if (BV (clib_bihash_is_free) (&rv))
-	    return -1;
-	  *key_result = rv;
-	  return 0;
-	}
-    }
-  return -1;
+  return BV (clib_bihash_search_pages) (v, n_pages, key_result, key_result);
 }
 
 static inline int BV (clib_bihash_search_inline)
@@ -473,7 +622,10 @@ static inline int BV (clib_bihash_search_inline)
 static inline void BV (clib_bihash_prefetch_bucket)
   (BVT (clib_bihash) * h, u64 hash)
 {
-  CLIB_PREFETCH (BV (clib_bihash_get_bucket) (h, hash),
+  u32 log2_nbuckets;
+
+  CLIB_PREFETCH (BV (clib_bihash_get_bucket_and_log2) (h, hash,
+						       &log2_nbuckets),
 		 BIHASH_BUCKET_PREFETCH_CACHE_LINES * CLIB_CACHE_LINE_BYTES,
 		 LOAD);
 }
@@ -483,13 +635,14 @@ static inline void BV (clib_bihash_prefetch_data)
 {
   BVT (clib_bihash_value) * v;
   BVT (clib_bihash_bucket) * b;
+  u32 log2_nbuckets;
 
 #if BIHASH_LAZY_INSTANTIATE
   if (PREDICT_FALSE (h->instantiated == 0))
     return;
 #endif
 
-  b = BV (clib_bihash_get_bucket) (h, hash);
+  b = BV (clib_bihash_get_bucket_and_log2) (h, hash, &log2_nbuckets);
 
   if (PREDICT_FALSE (BV (clib_bihash_bucket_is_empty) (b)))
     return;
@@ -497,7 +650,7 @@ static inline void BV (clib_bihash_prefetch_data)
   v = BV (clib_bihash_get_value) (h, b->offset);
 
   if (PREDICT_FALSE (b->log2_pages && b->linear_search == 0))
-    v += extract_bits (hash, h->log2_nbuckets, b->log2_pages);
+    v += extract_bits (hash, log2_nbuckets, b->log2_pages);
 
   CLIB_PREFETCH (v, BIHASH_KVP_PER_PAGE * sizeof (BVT (clib_bihash_kv)),
 		 LOAD);
@@ -507,10 +660,10 @@ static inline int BV (clib_bihash_search_inline_2_with_hash)
   (BVT (clib_bihash) * h,
    u64 hash, BVT (clib_bihash_kv) * search_key, BVT (clib_bihash_kv) * valuep)
 {
-  BVT (clib_bihash_kv) rv;
   BVT (clib_bihash_value) * v;
   BVT (clib_bihash_bucket) * b;
-  int i, limit;
+  u32 log2_nbuckets;
+  int n_pages;
 
   static const BVT (clib_bihash_bucket) mask = {
     .linear_search = 1,
@@ -524,7 +677,7 @@ static inline int BV (clib_bihash_search_inline_2_with_hash)
     return -1;
 #endif
 
-  b = BV (clib_bihash_get_bucket) (h, hash);
+  b = BV (clib_bihash_get_bucket_and_log2) (h, hash, &log2_nbuckets);
 
   if (PREDICT_FALSE (BV (clib_bihash_bucket_is_empty) (b)))
     return -1;
@@ -539,28 +692,17 @@ static inline int BV (clib_bihash_search_inline_2_with_hash)
   v = BV (clib_bihash_get_value) (h, b->offset);
 
   /* If the bucket has unresolvable collisions, use linear search */
-  limit = BIHASH_KVP_PER_PAGE;
+  n_pages = 1;
 
   if (PREDICT_FALSE (b->as_u64 & mask.as_u64))
     {
       if (PREDICT_FALSE (b->linear_search))
-	limit <<= b->log2_pages;
+	n_pages <<= b->log2_pages;
       else
-	v += extract_bits (hash, h->log2_nbuckets, b->log2_pages);
+	v += extract_bits (hash, log2_nbuckets, b->log2_pages);
     }
 
-  for (i = 0; i < limit; i++)
-    {
-      if (BV (clib_bihash_key_compare) (v->kvp[i].key, search_key->key))
-	{
-	  rv = v->kvp[i];
-	  if (BV (clib_bihash_is_free) (&rv))
-	    return -1;
-	  *valuep = rv;
-	  return 0;
-	}
-    }
-  return -1;
+  return BV (clib_bihash_search_pages) (v, n_pages, search_key, valuep);
 }
 
 static inline int BV (clib_bihash_search_inline_2)
@@ -575,6 +717,67 @@ static inline int BV (clib_bihash_search_inline_2)
 						     valuep);
 }
 
+/*
+ * Search for a batch of keys, each in place as with
+ * clib_bihash_search_inline: a key that is found is overwritten with its
+ * key/value pair, one that is not is left as it was. Bucket and page
+ * loads are issued ahead of the searches that need them, so the cache
+ * misses of several keys overlap.
+ */
+static_always_inline u32 BV (clib_bihash_search_batch_with_hash)
+  (BVT (clib_bihash) * h, u64 * hashes, BVT (clib_bihash_kv) * kvs,
+   u32 n_kvs)
+{
+  const u32 ahead = BIHASH_SEARCH_BATCH_AHEAD;
+  u32 i, n_found = 0;
+
+#if BIHASH_LAZY_INSTANTIATE
+  if (PREDICT_FALSE (h->instantiated == 0))
+    return 0;
+#endif
+
+  for (i = 0; i < clib_min (n_kvs, ahead); i++)
+    BV (clib_bihash_prefetch_bucket) (h, hashes[i]);
+
+  for (i = 0; i < n_kvs; i++)
+    {
+      /* the bucket of a key is loaded by the time its page is wanted */
+      if (i + ahead < n_kvs)
+	BV (clib_bihash_prefetch_bucket) (h, hashes[i + ahead]);
+      if (i + ahead / 2 < n_kvs)
+	BV (clib_bihash_prefetch_data) (h, hashes[i + ahead / 2]);
+
+      n_found +=
+	BV (clib_bihash_search_inline_with_hash) (h, hashes[i], &kvs[i]) == 0;
+    }
+
+  return n_found;
+}
+
+static_always_inline u32 BV (clib_bihash_search_batch)
+  (BVT (clib_bihash) * h, BVT (clib_bihash_kv) * kvs, u32 n_kvs)
+{
+  u64 hashes[BIHASH_SEARCH_BATCH_SIZE];
+  u32 i, n, n_found = 0;
+
+  while (n_kvs)
+    {
+      n = clib_min (n_kvs, BIHASH_SEARCH_BATCH_SIZE);
+
+      for (i = 0; i < n; i++)
+	hashes[i] = BV (clib_bihash_hash) (&kvs[i]);
+
+      n_found += BV (clib_bihash_search_batch_with_hash) (h, hashes, kvs, n);
+
+      kvs += n;
+      n_kvs -= n;
+    }
+
+  return n_found;
+}
+
+/* the page match is per kvp type, see clib_bihash_search_pages */
+#undef BIHASH_KVP_PAGE_MATCH
 
 #endif /* __included_bihash_template_h__ */
 
@@ -0,0 +1,31 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#undef CLIB_CUCKOO_TYPE
+#undef CLIB_CUCKOO_KVP_PER_BUCKET
+
+#define CLIB_CUCKOO_TYPE	   _40_8
+#define CLIB_CUCKOO_KVP_PER_BUCKET 4
+
+#ifndef __included_cuckoo_40_8_h__
+#define __included_cuckoo_40_8_h__
+
+/* same kvp layout and hash as the bihash of the same type */
+#include <vppinfra/bihash_40_8.h>
+
+typedef clib_bihash_kv_40_8_t clib_cuckoo_kv_40_8_t;
+
+static inline u64
+clib_cuckoo_hash_40_8 (clib_cuckoo_kv_40_8_t *v)
+{
+  return clib_bihash_hash_40_8 (v);
+}
+
+static inline int
+clib_cuckoo_key_compare_40_8 (u64 *a, u64 *b)
+{
+  return clib_bihash_key_compare_40_8 (a, b);
+}
+
+#endif /* __included_cuckoo_40_8_h__ */
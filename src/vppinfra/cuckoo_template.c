@@ -0,0 +1,372 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+/** @cond DOCUMENTATION_IS_IN_CUCKOO_TEMPLATE_H */
+
+void
+CV (clib_cuckoo_init) (CVT (clib_cuckoo) * h, char *name, u32 nbuckets)
+{
+  uword n_bytes;
+
+  /* two buckets per key need at least two buckets */
+  nbuckets = 1 << max_log2 (clib_max (nbuckets, 2));
+  ASSERT (nbuckets >= 2);
+
+  clib_memset (h, 0, sizeof (*h));
+  h->name = (u8 *) name;
+  h->nbuckets = nbuckets;
+  h->mask = nbuckets - 1;
+
+  n_bytes = (uword) nbuckets * sizeof (h->buckets[0]);
+  h->buckets = clib_mem_alloc_aligned (n_bytes, CLIB_CACHE_LINE_BYTES);
+  clib_memset (h->buckets, 0, n_bytes);
+
+  h->writer_lock =
+    clib_mem_alloc_aligned (CLIB_CACHE_LINE_BYTES, CLIB_CACHE_LINE_BYTES);
+  h->writer_lock[0] = 0;
+}
+
+void
+CV (clib_cuckoo_free) (CVT (clib_cuckoo) * h)
+{
+  clib_mem_free (h->buckets);
+  clib_mem_free ((void *) h->writer_lock);
+  vec_free (h->paths);
+  clib_memset (h, 0, sizeof (*h));
+}
+
+static void
+CV (clib_cuckoo_writer_lock) (CVT (clib_cuckoo) * h)
+{
+  while (clib_atomic_test_and_set (h->writer_lock))
+    CLIB_PAUSE ();
+}
+
+static void
+CV (clib_cuckoo_writer_unlock) (CVT (clib_cuckoo) * h)
+{
+  clib_atomic_release (h->writer_lock);
+}
+
+/* Readers that overlap a change of the bucket will retry */
+static_always_inline void
+CV (clib_cuckoo_bucket_write_begin) (CVT (clib_cuckoo_bucket) * b)
+{
+  b->version++;
+  CLIB_MEMORY_STORE_BARRIER ();
+}
+
+static_always_inline void
+CV (clib_cuckoo_bucket_write_end) (CVT (clib_cuckoo_bucket) * b)
+{
+  CLIB_MEMORY_STORE_BARRIER ();
+  b->version++;
+}
+
+static int
+CV (clib_cuckoo_free_slot) (CVT (clib_cuckoo_bucket) * b)
+{
+  int i;
+
+  for (i = 0; i < CLIB_CUCKOO_KVP_PER_BUCKET; i++)
+    if (b->tags[i] == 0)
+      return i;
+
+  return -1;
+}
+
+static void
+CV (clib_cuckoo_write_slot) (CVT (clib_cuckoo_bucket) * b, int slot, u8 tag,
+			     CVT (clib_cuckoo_kv) * kvp)
+{
+  CV (clib_cuckoo_bucket_write_begin) (b);
+  clib_memcpy_fast (&b->kvp[slot], kvp, sizeof (*kvp));
+  b->tags[slot] = tag;
+  CV (clib_cuckoo_bucket_write_end) (b);
+}
+
+static void
+CV (clib_cuckoo_clear_slot) (CVT (clib_cuckoo_bucket) * b, int slot)
+{
+  CV (clib_cuckoo_bucket_write_begin) (b);
+  b->tags[slot] = 0;
+  CV (clib_cuckoo_bucket_write_end) (b);
+}
+
+static int
+CV (clib_cuckoo_path_has_bucket) (CVT (clib_cuckoo) * h, u32 node,
+				  u32 bucket)
+{
+  while (node != (u16) ~0)
+    {
+      if (h->paths[node].bucket == bucket)
+	return 1;
+      node = h->paths[node].parent;
+    }
+  return 0;
+}
+
+/*
+ * Breadth first search from the two full buckets of a key for a bucket
+ * with a free slot, that the kvps along the path to it can move into in
+ * turn. Returns the last node of the path, or ~0 if there is none.
+ */
+static u32
+CV (clib_cuckoo_find_path) (CVT (clib_cuckoo) * h, u32 bucket, u32 alt)
+{
+  CVT (clib_cuckoo_path) * p;
+  CVT (clib_cuckoo_bucket) * b;
+  u32 node, child_bucket, i;
+
+  vec_reset_length (h->paths);
+  vec_add2 (h->paths, p, 1);
+  p->bucket = bucket;
+  p->parent = ~0;
+  if (alt != bucket)
+    {
+      vec_add2 (h->paths, p, 1);
+      p->bucket = alt;
+      p->parent = ~0;
+    }
+
+  for (node = 0; node < vec_len (h->paths); node++)
+    {
+      b = CV (clib_cuckoo_get_bucket) (h, h->paths[node].bucket);
+
+      for (i = 0; i < CLIB_CUCKOO_KVP_PER_BUCKET; i++)
+	{
+	  child_bucket = CV (clib_cuckoo_alt_bucket) (
+	    h, h->paths[node].bucket, b->tags[i]);
+
+	  /* a path through a bucket twice would undo its own moves */
+	  if (CV (clib_cuckoo_path_has_bucket) (h, node, child_bucket))
+	    continue;
+	  if (vec_len (h->paths) >= CLIB_CUCKOO_BFS_MAX_NODES)
+	    return ~0;
+
+	  vec_add2 (h->paths, p, 1);
+	  p->bucket = child_bucket;
+	  p->parent = node;
+	  p->slot = i;
+
+	  if (CV (clib_cuckoo_free_slot) (
+		CV (clib_cuckoo_get_bucket) (h, child_bucket)) >= 0)
+	    return vec_len (h->paths) - 1;
+	}
+    }
+
+  return ~0;
+}
+
+/*
+ * Move the kvps along a path, last first, so that each is copied into
+ * the slot freed by the previous move before it leaves its own. Returns
+ * the bucket at the start of the path, which now has a free slot.
+ */
+static u32
+CV (clib_cuckoo_move_path) (CVT (clib_cuckoo) * h, u32 node)
+{
+  CVT (clib_cuckoo_bucket) * src, *dst;
+  CVT (clib_cuckoo_path) * p;
+  int slot;
+
+  h->move_version++;
+  CLIB_MEMORY_STORE_BARRIER ();
+
+  for (p = &h->paths[node]; p->parent != (u16) ~0; p = &h->paths[p->parent])
+    {
+      src = CV (clib_cuckoo_get_bucket) (h, h->paths[p->parent].bucket);
+      dst = CV (clib_cuckoo_get_bucket) (h, p->bucket);
+      slot = CV (clib_cuckoo_free_slot) (dst);
+      ASSERT (slot >= 0);
+
+      CV (clib_cuckoo_write_slot)
+      (dst, slot, src->tags[p->slot], &src->kvp[p->slot]);
+      CV (clib_cuckoo_clear_slot) (src, p->slot);
+      h->n_moves++;
+    }
+
+  CLIB_MEMORY_STORE_BARRIER ();
+  h->move_version++;
+
+  return p->bucket;
+}
+
+static int
+CV (clib_cuckoo_find_slot) (CVT (clib_cuckoo_bucket) * b, u8 tag,
+			    CVT (clib_cuckoo_kv) * kvp)
+{
+  int i;
+
+  for (i = 0; i < CLIB_CUCKOO_KVP_PER_BUCKET; i++)
+    if (b->tags[i] == tag &&
+	CV (clib_cuckoo_key_compare) (b->kvp[i].key, kvp->key))
+      return i;
+
+  return -1;
+}
+
+int
+CV (clib_cuckoo_add_del) (CVT (clib_cuckoo) * h, CVT (clib_cuckoo_kv) * add_v,
+			  int is_add)
+{
+  CVT (clib_cuckoo_bucket) * b;
+  u64 hash = CV (clib_cuckoo_hash) (add_v);
+  u8 tag = CV (clib_cuckoo_tag) (hash);
+  u32 buckets[2], node, i;
+  int slot, rv = 0;
+
+  buckets[0] = hash & h->mask;
+  buckets[1] = CV (clib_cuckoo_alt_bucket) (h, buckets[0], tag);
+
+  CV (clib_cuckoo_writer_lock) (h);
+
+  for (i = 0; i < 2; i++)
+    {
+      b = CV (clib_cuckoo_get_bucket) (h, buckets[i]);
+      slot = CV (clib_cuckoo_find_slot) (b, tag, add_v);
+      if (slot < 0)
+	continue;
+
+      if (is_add)
+	{
+	  /* overwrite the value */
+	  CV (clib_cuckoo_bucket_write_begin) (b);
+	  b->kvp[slot].value = add_v->value;
+	  CV (clib_cuckoo_bucket_write_end) (b);
+	}
+      else
+	{
+	  CV (clib_cuckoo_clear_slot) (b, slot);
+	  h->n_kvps--;
+	}
+      goto done;
+    }
+
+  if (!is_add)
+    {
+      rv = -1;
+      goto done;
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      b = CV (clib_cuckoo_get_bucket) (h, buckets[i]);
+      slot = CV (clib_cuckoo_free_slot) (b);
+      if (slot >= 0)
+	goto add;
+    }
+
+  node = CV (clib_cuckoo_find_path) (h, buckets[0], buckets[1]);
+  if (node == ~0)
+    {
+      h->n_add_fails++;
+      rv = -2;
+      goto done;
+    }
+
+  b = CV (clib_cuckoo_get_bucket) (h, CV (clib_cuckoo_move_path) (h, node));
+  slot = CV (clib_cuckoo_free_slot) (b);
+  ASSERT (slot >= 0);
+
+add:
+  CV (clib_cuckoo_write_slot) (b, slot, tag, add_v);
+  h->n_kvps++;
+
+done:
+  CV (clib_cuckoo_writer_unlock) (h);
+  return rv;
+}
+
+int
+CV (clib_cuckoo_search) (CVT (clib_cuckoo) * h,
+			 CVT (clib_cuckoo_kv) * search_v,
+			 CVT (clib_cuckoo_kv) * return_v)
+{
+  *return_v = *search_v;
+  return CV (clib_cuckoo_search_inline) (h, return_v);
+}
+
+/*
+ * The fallback of readers that kept racing writers: with the writer lock
+ * held, no bucket is being changed and no kvp is between buckets.
+ */
+int
+CV (clib_cuckoo_search_locked) (CVT (clib_cuckoo) * h, u64 hash,
+				CVT (clib_cuckoo_kv) * kvp)
+{
+  u8 tag = CV (clib_cuckoo_tag) (hash);
+  u32 bucket = hash & h->mask;
+  int rv;
+
+  CV (clib_cuckoo_writer_lock) (h);
+  rv = CV (clib_cuckoo_search_bucket) (CV (clib_cuckoo_get_bucket) (h, bucket),
+				       tag, kvp);
+  if (rv)
+    rv = CV (clib_cuckoo_search_bucket) (
+      CV (clib_cuckoo_get_bucket) (
+	h, CV (clib_cuckoo_alt_bucket) (h, bucket, tag)),
+      tag, kvp);
+  CV (clib_cuckoo_writer_unlock) (h);
+
+  ASSERT (rv != -2);
+  return rv;
+}
+
+void
+CV (clib_cuckoo_foreach_key_value_pair) (
+  CVT (clib_cuckoo) * h, CV (clib_cuckoo_foreach_key_value_pair_cb) cb,
+  void *arg)
+{
+  CVT (clib_cuckoo_bucket) * b;
+  u32 i, j;
+
+  for (i = 0; i < h->nbuckets; i++)
+    {
+      b = CV (clib_cuckoo_get_bucket) (h, i);
+      for (j = 0; j < CLIB_CUCKOO_KVP_PER_BUCKET; j++)
+	{
+	  if (b->tags[j] == 0)
+	    continue;
+	  if (CLIB_CUCKOO_WALK_STOP == cb (&b->kvp[j], arg))
+	    return;
+	}
+    }
+}
+
+u8 *
+CV (format_cuckoo) (u8 *s, va_list *args)
+{
+  CVT (clib_cuckoo) * h = va_arg (*args, CVT (clib_cuckoo) *);
+  int verbose = va_arg (*args, int);
+  CVT (clib_cuckoo_bucket) * b;
+  u32 i, j, n_used, hist[CLIB_CUCKOO_KVP_PER_BUCKET + 1] = { 0 };
+  u64 n_slots = (u64) h->nbuckets * CLIB_CUCKOO_KVP_PER_BUCKET;
+
+  s = format (s, "Cuckoo table '%s'\n", h->name ? h->name : (u8 *) "");
+  s = format (s, "    %u buckets of %u kvps, %llu kvps, load %.2f%%\n",
+	      h->nbuckets, CLIB_CUCKOO_KVP_PER_BUCKET, h->n_kvps,
+	      n_slots ? 100.0 * h->n_kvps / n_slots : 0.0);
+  s = format (s, "    %llu kvps moved, %llu adds failed\n", h->n_moves,
+	      h->n_add_fails);
+  s = format (s, "    memory %U\n", format_memory_size,
+	      (uword) h->nbuckets * sizeof (h->buckets[0]));
+
+  if (verbose)
+    {
+      for (i = 0; i < h->nbuckets; i++)
+	{
+	  b = CV (clib_cuckoo_get_bucket) (h, i);
+	  for (n_used = 0, j = 0; j < CLIB_CUCKOO_KVP_PER_BUCKET; j++)
+	    n_used += b->tags[j] != 0;
+	  hist[n_used]++;
+	}
+      for (i = 0; i <= CLIB_CUCKOO_KVP_PER_BUCKET; i++)
+	s = format (s, "    %u buckets with %u kvps\n", hist[i], i);
+    }
+
+  return s;
+}
+
+/** @endcond */
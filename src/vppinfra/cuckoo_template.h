@@ -0,0 +1,259 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+/*
+ * Bucketized cuckoo hash table template.
+ *
+ * Every key has two candidate buckets of CLIB_CUCKOO_KVP_PER_BUCKET
+ * slots, so a search touches at most two buckets however full the table
+ * is. When both are full an add makes room by moving kvps to their
+ * other bucket, along the shortest path found by a breadth first search.
+ *
+ * The second bucket is computed from the first and an 8 bit tag of the
+ * hash, kept per slot, so kvps can be moved without hashing their keys
+ * again. Searches compare the tags before the keys.
+ *
+ * Writers serialize on a spin lock; readers search optimistically. A
+ * bucket's version is odd while a writer changes it, and a reader's
+ * search of a bucket only counts if the version was even and unchanged
+ * across it. The table's move version covers a whole path of moves,
+ * during which a kvp may be in neither bucket a reader looks at; a
+ * reader that misses checks it the same way. A reader that keeps racing
+ * writers gives up after CLIB_CUCKOO_SEARCH_MAX_TRIES searches and
+ * takes the writer lock, so it may wait for one writer, but never spins
+ * on a version a stalled writer left odd.
+ *
+ * The table does not grow: size it for the number of kvps expected.
+ * An add fails when no path of moves makes room, which is rare below
+ * a load factor of 90%.
+ *
+ * Note: to instantiate the template multiple times in a single file,
+ * #undef __included_cuckoo_template_h__...
+ */
+
+#ifndef CLIB_CUCKOO_TYPE
+#error CLIB_CUCKOO_TYPE not defined
+#endif
+
+#ifndef CLIB_CUCKOO_KVP_PER_BUCKET
+#error CLIB_CUCKOO_KVP_PER_BUCKET not defined
+#endif
+
+#ifndef __included_cuckoo_template_h__
+#define __included_cuckoo_template_h__
+
+#include <vppinfra/clib.h>
+#include <vppinfra/cache.h>
+#include <vppinfra/lock.h>
+#include <vppinfra/format.h>
+
+/* most buckets visited looking for a path of moves */
+#ifndef CLIB_CUCKOO_BFS_MAX_NODES
+#define CLIB_CUCKOO_BFS_MAX_NODES 512
+#endif
+
+/* lock-free searches tried before a reader takes the writer lock */
+#ifndef CLIB_CUCKOO_SEARCH_MAX_TRIES
+#define CLIB_CUCKOO_SEARCH_MAX_TRIES 4
+#endif
+
+#define CLIB_CUCKOO_WALK_CONTINUE 0
+#define CLIB_CUCKOO_WALK_STOP	  1
+
+#define _cv(a, b)  a##b
+#define __cv(a, b) _cv (a, b)
+#define CV(a)	   __cv (a, CLIB_CUCKOO_TYPE)
+
+#define _cvt(a, b)  a##b##_t
+#define __cvt(a, b) _cvt (a, b)
+#define CVT(a)	    __cvt (a, CLIB_CUCKOO_TYPE)
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
+  /** odd while a writer changes the bucket */
+  volatile u32 version;
+
+  /** per slot tag of the hash of its key, 0 if the slot is free */
+  u8 tags[CLIB_CUCKOO_KVP_PER_BUCKET];
+
+  CVT (clib_cuckoo_kv) kvp[CLIB_CUCKOO_KVP_PER_BUCKET];
+} CVT (clib_cuckoo_bucket);
+
+/** A bucket on a path of moves, and the slot of its parent whose kvp
+    moves into it */
+typedef struct
+{
+  u32 bucket;
+  u16 parent;
+  u8 slot;
+} CVT (clib_cuckoo_path);
+
+typedef struct
+{
+  CVT (clib_cuckoo_bucket) * buckets;
+  u32 nbuckets;
+  u32 mask;
+
+  /** odd while a writer moves kvps between buckets */
+  volatile u32 move_version;
+
+  /** serializes writers */
+  volatile u32 *writer_lock;
+
+  /** breadth first search scratch, only used under the writer lock */
+  CVT (clib_cuckoo_path) * paths;
+
+  u64 n_kvps;
+  u64 n_moves;
+  u64 n_add_fails;
+
+  u8 *name;
+} CVT (clib_cuckoo);
+
+void CV (clib_cuckoo_init) (CVT (clib_cuckoo) * h, char *name, u32 nbuckets);
+void CV (clib_cuckoo_free) (CVT (clib_cuckoo) * h);
+int CV (clib_cuckoo_add_del) (CVT (clib_cuckoo) * h,
+			      CVT (clib_cuckoo_kv) * add_v, int is_add);
+int CV (clib_cuckoo_search) (CVT (clib_cuckoo) * h,
+			     CVT (clib_cuckoo_kv) * search_v,
+			     CVT (clib_cuckoo_kv) * return_v);
+int CV (clib_cuckoo_search_locked) (CVT (clib_cuckoo) * h, u64 hash,
+				    CVT (clib_cuckoo_kv) * kvp);
+
+typedef int (*CV (clib_cuckoo_foreach_key_value_pair_cb)) (
+  CVT (clib_cuckoo_kv) *, void *);
+void CV (clib_cuckoo_foreach_key_value_pair) (
+  CVT (clib_cuckoo) * h, CV (clib_cuckoo_foreach_key_value_pair_cb) cb,
+  void *arg);
+
+format_function_t CV (format_cuckoo);
+
+static_always_inline u8
+CV (clib_cuckoo_tag) (u64 hash)
+{
+  /*
+   * the top bits, the low ones select the bucket; of both halves, as the
+   * crc32c hash leaves the upper one clear
+   */
+  u8 tag = (hash >> 24) ^ (hash >> 56);
+
+  /* 0 marks a free slot */
+  return tag ? tag : 1;
+}
+
+static_always_inline u32
+CV (clib_cuckoo_alt_bucket) (CVT (clib_cuckoo) * h, u32 bucket, u8 tag)
+{
+  /* the same to and fro, so a kvp's other bucket is known from its tag */
+  u32 alt = (bucket ^ ((u32) tag * 0x5bd1e995u)) & h->mask;
+
+  /* never the bucket itself; flipping the low bit keeps it symmetric */
+  ASSERT (h->nbuckets >= 2);
+  alt ^= (alt == bucket);
+
+  return alt;
+}
+
+static_always_inline CVT (clib_cuckoo_bucket) *
+  CV (clib_cuckoo_get_bucket) (CVT (clib_cuckoo) * h, u32 bucket)
+{
+  return h->buckets + bucket;
+}
+
+static_always_inline void
+CV (clib_cuckoo_prefetch_bucket) (CVT (clib_cuckoo) * h, u64 hash)
+{
+  u32 bucket = hash & h->mask;
+
+  clib_prefetch_load (CV (clib_cuckoo_get_bucket) (h, bucket));
+  clib_prefetch_load (CV (clib_cuckoo_get_bucket) (
+    h, CV (clib_cuckoo_alt_bucket) (h, bucket, CV (clib_cuckoo_tag) (hash))));
+}
+
+/*
+ * Search a bucket: 0 if found, -1 if not, -2 if a writer changed the
+ * bucket meanwhile and the outcome cannot be trusted.
+ */
+static_always_inline int
+CV (clib_cuckoo_search_bucket) (CVT (clib_cuckoo_bucket) * b, u8 tag,
+				CVT (clib_cuckoo_kv) * kvp)
+{
+  CVT (clib_cuckoo_kv) rv;
+  u32 version, i;
+
+  version = clib_atomic_load_acq_n (&b->version);
+  if (PREDICT_FALSE (version & 1))
+    return -2;
+
+  for (i = 0; i < CLIB_CUCKOO_KVP_PER_BUCKET; i++)
+    {
+      if (b->tags[i] != tag)
+	continue;
+      if (!CV (clib_cuckoo_key_compare) (b->kvp[i].key, kvp->key))
+	continue;
+
+      rv = b->kvp[i];
+
+      /* the slot may have been rewritten while it was copied */
+      __atomic_thread_fence (__ATOMIC_ACQUIRE);
+      if (PREDICT_FALSE (b->version != version))
+	return -2;
+
+      *kvp = rv;
+      return 0;
+    }
+
+  /* a miss only counts if no writer was in the bucket */
+  __atomic_thread_fence (__ATOMIC_ACQUIRE);
+  if (PREDICT_FALSE (b->version != version))
+    return -2;
+
+  return -1;
+}
+
+static_always_inline int
+CV (clib_cuckoo_search_inline_with_hash) (CVT (clib_cuckoo) * h, u64 hash,
+					  CVT (clib_cuckoo_kv) * kvp)
+{
+  u32 move_version, bucket, alt, n_tries;
+  u8 tag = CV (clib_cuckoo_tag) (hash);
+  int rv;
+
+  bucket = hash & h->mask;
+  alt = CV (clib_cuckoo_alt_bucket) (h, bucket, tag);
+
+  for (n_tries = 0; n_tries < CLIB_CUCKOO_SEARCH_MAX_TRIES; n_tries++)
+    {
+      move_version = clib_atomic_load_acq_n (&h->move_version);
+
+      rv = CV (clib_cuckoo_search_bucket) (
+	CV (clib_cuckoo_get_bucket) (h, bucket), tag, kvp);
+      if (rv == -1)
+	rv = CV (clib_cuckoo_search_bucket) (
+	  CV (clib_cuckoo_get_bucket) (h, alt), tag, kvp);
+      if (rv == 0)
+	return 0;
+
+      /* the kvp may have been on its way from one bucket to the other */
+      __atomic_thread_fence (__ATOMIC_ACQUIRE);
+      if (rv == -1 && !(move_version & 1) && h->move_version == move_version)
+	return -1;
+
+      CLIB_PAUSE ();
+    }
+
+  return CV (clib_cuckoo_search_locked) (h, hash, kvp);
+}
+
+static_always_inline int
+CV (clib_cuckoo_search_inline) (CVT (clib_cuckoo) * h,
+				CVT (clib_cuckoo_kv) * kvp)
+{
+  return CV (clib_cuckoo_search_inline_with_hash) (
+    h, CV (clib_cuckoo_hash) (kvp), kvp);
+}
+
+#endif /* __included_cuckoo_template_h__ */
@@ -487,6 +487,8 @@ elog_nsec_per_clock (elog_main_t * em)
 static void
 elog_alloc_internal (elog_main_t * em, u32 n_events, int free_ring)
 {
+  elog_thread_ring_t *tr;
+
   if (free_ring && em->event_ring)
     vec_free (em->event_ring);
 
@@ -495,6 +497,15 @@ elog_alloc_internal (elog_main_t * em, u32 n_events, int free_ring)
 
   vec_validate_aligned (em->event_ring, n_events, CLIB_CACHE_LINE_BYTES);
   vec_set_len (em->event_ring, n_events);
+
+  /* Thread rings are the size of the shared ring; their events are lost. */
+  vec_foreach (tr, em->thread_rings)
+  {
+    vec_free (tr->event_ring);
+    vec_validate_aligned (tr->event_ring, n_events - 1,
+			  CLIB_CACHE_LINE_BYTES);
+    tr->n_total_events = 0;
+  }
 }
 
 __clib_export void
@@ -509,6 +520,32 @@ elog_resize (elog_main_t * em, u32 n_events)
   elog_alloc_internal (em, n_events, 0 /* do not free ring */ );
 }
 
+__clib_export void
+elog_thread_rings_enable (elog_main_t * em, u32 n_threads)
+{
+  elog_thread_ring_t *tr;
+
+  elog_thread_rings_disable (em);
+  if (n_threads == 0)
+    return;
+
+  vec_validate_aligned (em->thread_rings, n_threads - 1,
+			CLIB_CACHE_LINE_BYTES);
+  vec_foreach (tr, em->thread_rings)
+    vec_validate_aligned (tr->event_ring, em->event_ring_size - 1,
+			  CLIB_CACHE_LINE_BYTES);
+}
+
+__clib_export void
+elog_thread_rings_disable (elog_main_t * em)
+{
+  elog_thread_ring_t *tr;
+
+  vec_foreach (tr, em->thread_rings)
+    vec_free (tr->event_ring);
+  vec_free (em->thread_rings);
+}
+
 __clib_export void
 elog_init (elog_main_t * em, u32 n_events)
 {
@@ -533,10 +570,9 @@ elog_init (elog_main_t * em, u32 n_events)
 
 /* Returns number of events in ring and start index. */
 static uword
-elog_event_range (elog_main_t * em, uword * lo)
+elog_event_range (elog_main_t * em, u64 i, uword * lo)
 {
   uword l = em->event_ring_size;
-  u64 i = em->n_total_events;
 
   /* Ring never wrapped? */
   if (i <= (u64) l)
@@ -553,27 +589,82 @@ elog_event_range (elog_main_t * em, uword * lo)
     }
 }
 
-__clib_export elog_event_t *
-elog_peek_events (elog_main_t * em)
+static int elog_cmp (void *a1, void *a2);
+
+/* The events of one ring, oldest first */
+typedef struct
 {
-  elog_event_t *e, *f, *es = 0;
-  uword i, j, n;
+  elog_event_t *ring;
+  uword index;
+  uword n_left;
 
-  n = elog_event_range (em, &j);
-  for (i = 0; i < n; i++)
-    {
-      vec_add2 (es, e, 1);
-      f = vec_elt_at_index (em->event_ring, j);
-      e[0] = f[0];
+  /* the event time is t0 plus the cycles since cpu0 */
+  u64 cpu0;
+  f64 t0;
+} elog_ring_iter_t;
 
-      /* Convert absolute time from cycles to seconds from start. */
-      e->time =
-	(e->time_cycles -
-	 em->init_time.cpu) * em->cpu_timer.seconds_per_clock;
+static void
+elog_ring_iter_add (elog_main_t *em, elog_ring_iter_t **iters,
+		    elog_event_t *ring, u64 n_total_events, u64 cpu0, f64 t0)
+{
+  elog_ring_iter_t *it;
 
-      j = (j + 1) & (em->event_ring_size - 1);
-    }
+  vec_add2 (*iters, it, 1);
+  it->ring = ring;
+  it->n_left = elog_event_range (em, n_total_events, &it->index);
+  it->cpu0 = cpu0;
+  it->t0 = t0;
+}
+
+/* Iterators over the shared ring and each thread's ring */
+static elog_ring_iter_t *
+elog_ring_iters (elog_main_t *em)
+{
+  elog_ring_iter_t *iters = 0;
+  elog_thread_ring_t *tr;
+
+  elog_ring_iter_add (em, &iters, em->event_ring, em->n_total_events,
+		      em->init_time.cpu, 0);
+
+  /* Each thread's cycles count from when it logged its first event, so
+     cycle counters which are not in sync across cpus still line up. */
+  vec_foreach (tr, em->thread_rings)
+    elog_ring_iter_add (
+      em, &iters, tr->event_ring, tr->n_total_events, tr->time_stamp.cpu,
+      1e-9 * elog_time_stamp_diff_os_nsec (&tr->time_stamp, &em->init_time));
+
+  return iters;
+}
+
+/* Copy the next event of a ring, with its time in seconds from start */
+static int
+elog_ring_iter_next (elog_main_t *em, elog_ring_iter_t *it, elog_event_t *e)
+{
+  if (it->n_left == 0)
+    return 0;
 
+  e[0] = it->ring[it->index];
+  e->time = it->t0 + (i64) (e->time_cycles - it->cpu0) *
+		       em->cpu_timer.seconds_per_clock;
+
+  it->index = (it->index + 1) & (em->event_ring_size - 1);
+  it->n_left--;
+  return 1;
+}
+
+__clib_export elog_event_t *
+elog_peek_events (elog_main_t * em)
+{
+  elog_ring_iter_t *iters, *it;
+  elog_event_t *es = 0, e;
+
+  iters = elog_ring_iters (em);
+  vec_foreach (it, iters)
+    while (elog_ring_iter_next (em, it, &e))
+      vec_add1 (es, e);
+  vec_free (iters);
+
+  vec_sort_with_function (es, elog_cmp);
   return es;
 }
 
@@ -1195,6 +1286,110 @@ elog_write_file_not_inline (elog_main_t * em, char *clib_file, int flush_ring)
   return error;
 }
 
+/* Format a C string as the contents of a JSON string. */
+static u8 *
+format_elog_json_string (u8 * s, va_list * args)
+{
+  char *c = va_arg (*args, char *);
+
+  for (; c && *c; c++)
+    {
+      if (*c == '"' || *c == '\\')
+	s = format (s, "\\%c", *c);
+      else if ((u8) * c < 0x20)
+	s = format (s, "\\u%04x", (u8) * c);
+      else
+	vec_add1 (s, *c);
+    }
+  return s;
+}
+
+static void
+elog_write_chrome_event (FILE *f, elog_main_t *em, elog_event_t *e, u8 **msg)
+{
+  elog_event_type_t *t = vec_elt_at_index (em->event_types, e->event_type);
+
+  vec_reset_length (*msg);
+  *msg = format (*msg, "%U%c", format_elog_event, em, e, 0);
+
+  fformat (f,
+	   ",\n{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,"
+	   "\"ts\":%.3f,\"name\":\"%U\",\"args\":{\"msg\":\"%U\"}}",
+	   e->track, e->time * 1e6, format_elog_json_string, t->format,
+	   format_elog_json_string, *msg);
+}
+
+/*
+ * Write events in the Chrome trace event format: a JSON array of instant
+ * events, one track per thread. With flush_ring, the rings are merged an
+ * event at a time as they are written, in time order, so a large log
+ * needs no merged copy in memory; otherwise em->events is written.
+ */
+__clib_export clib_error_t *
+elog_write_chrome_trace (elog_main_t * em, char *clib_file, int flush_ring)
+{
+  elog_ring_iter_t *iters = 0, *it;
+  elog_event_t *heads = 0, *e;
+  elog_track_t *track;
+  u8 *msg = 0;
+  uword i, min;
+  FILE *f;
+
+  f = fopen (clib_file, "w");
+  if (!f)
+    return clib_error_return_unix (0, "open `%s'", clib_file);
+
+  /* the track names come first, and there is always the default one */
+  fformat (f, "[");
+
+  vec_foreach (track, em->tracks)
+    fformat (f,
+	     "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,"
+	     "\"tid\":%d,\"args\":{\"name\":\"%U\"}}",
+	     track == em->tracks ? "" : ",", track - em->tracks,
+	     format_elog_json_string, track->name);
+
+  if (!flush_ring)
+    {
+      vec_foreach (e, em->events)
+	elog_write_chrome_event (f, em, e, &msg);
+      goto done;
+    }
+
+  /* the oldest event not yet written from each ring */
+  iters = elog_ring_iters (em);
+  vec_validate (heads, vec_len (iters) - 1);
+  vec_foreach_index (i, iters)
+    if (!elog_ring_iter_next (em, iters + i, heads + i))
+      iters[i].ring = 0;
+
+  while (1)
+    {
+      min = ~0;
+      vec_foreach (it, iters)
+	if (it->ring && (min == ~0 || elog_cmp (heads + (it - iters),
+						heads + min) < 0))
+	  min = it - iters;
+      if (min == ~0)
+	break;
+
+      elog_write_chrome_event (f, em, heads + min, &msg);
+      if (!elog_ring_iter_next (em, iters + min, heads + min))
+	iters[min].ring = 0;
+    }
+
+  vec_free (iters);
+  vec_free (heads);
+
+done:
+  fformat (f, "\n]\n");
+  vec_free (msg);
+
+  if (fclose (f))
+    return clib_error_return_unix (0, "write `%s'", clib_file);
+  return 0;
+}
+
 __clib_export clib_error_t *
 elog_read_file_not_inline (elog_main_t * em, char *clib_file)
 {
@@ -55,6 +55,7 @@
 #include <vppinfra/time.h>	/* for clib_cpu_time_now */
 #include <vppinfra/hash.h>
 #include <vppinfra/mhash.h>
+#include <vppinfra/os.h>
 
 typedef struct
 {
@@ -129,6 +130,26 @@ typedef struct
   u64 os_nsec;
 } elog_time_stamp_t;
 
+void elog_time_now (elog_time_stamp_t * et);
+
+/** Event ring of one thread. Threads log to their own ring, without
+    sharing cache lines, once elog_thread_rings_enable() is called. */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
+  /** Number of events logged by the thread. */
+  u64 n_total_events;
+
+  /** Vector of events (circular buffer), of event_ring_size events. */
+  elog_event_t *event_ring;
+
+  /** Cycle counter and OS time, read on the thread when it logs its
+      first event. Threads' cycle counters are mapped to the OS time, so
+      their events can be merged on one timeline. */
+  elog_time_stamp_t time_stamp;
+} elog_thread_ring_t;
+
 typedef struct
 {
   /** Total number of events in buffer. */
@@ -180,6 +201,9 @@ typedef struct
 
   /** Vector of events converted to generic form after collection. */
   elog_event_t *events;
+
+  /** Per thread event rings, indexed by thread, if enabled. */
+  elog_thread_ring_t *thread_rings;
 } elog_main_t;
 
 /** @brief Return number of events in the event-log buffer
@@ -190,7 +214,12 @@ typedef struct
 always_inline uword
 elog_n_events_in_buffer (elog_main_t * em)
 {
-  return clib_min (em->n_total_events, em->event_ring_size);
+  elog_thread_ring_t *tr;
+  uword n = clib_min (em->n_total_events, em->event_ring_size);
+
+  vec_foreach (tr, em->thread_rings)
+    n += clib_min (tr->n_total_events, em->event_ring_size);
+  return n;
 }
 
 /** @brief Return number of events which can fit in the event buffer
@@ -209,8 +238,12 @@ elog_buffer_capacity (elog_main_t * em)
 always_inline void
 elog_reset_buffer (elog_main_t * em)
 {
+  elog_thread_ring_t *tr;
+
   em->n_total_events = 0;
   em->n_total_events_disable_limit = ~0;
+  vec_foreach (tr, em->thread_rings)
+    tr->n_total_events = 0;
 }
 
 /** @brief Enable or disable event logging
@@ -219,8 +252,12 @@ elog_reset_buffer (elog_main_t * em)
 always_inline void
 elog_enable_disable (elog_main_t * em, int is_enabled)
 {
+  elog_thread_ring_t *tr;
+
   em->n_total_events = 0;
   em->n_total_events_disable_limit = is_enabled ? ~0 : 0;
+  vec_foreach (tr, em->thread_rings)
+    tr->n_total_events = 0;
 }
 
 /** @brief disable logging after specified number of ievents have been logged.
@@ -228,6 +265,7 @@ elog_enable_disable (elog_main_t * em, int is_enabled)
    This is used as a "debug trigger" when a certain event has occurred.
    Events will be logged both before and after the "event" but the
    event will not be lost as long as N < RING_SIZE.
+   Only counts events logged to the shared ring, not to per thread rings.
 
    @param em elog_main_t *
    @param n uword number of events before disabling event logging
@@ -294,8 +332,9 @@ elog_event_data_inline (elog_main_t * em,
 			elog_event_type_t * type,
 			elog_track_t * track, u64 cpu_time)
 {
+  elog_thread_ring_t *tr;
   elog_event_t *e;
-  uword ei;
+  uword ei, thread_index;
   word type_index, track_index;
 
   /* Return the user placeholder memory to scribble data into. */
@@ -315,13 +354,25 @@ elog_event_data_inline (elog_main_t * em,
   ASSERT (track_index < vec_len (em->tracks));
   ASSERT (is_pow2 (vec_len (em->event_ring)));
 
-  if (em->lock)
-    ei = clib_atomic_fetch_add (&em->n_total_events, 1);
+  thread_index = os_get_thread_index ();
+  if (PREDICT_TRUE (thread_index < vec_len (em->thread_rings)))
+    {
+      tr = vec_elt_at_index (em->thread_rings, thread_index);
+      if (PREDICT_FALSE (tr->time_stamp.cpu == 0))
+	elog_time_now (&tr->time_stamp);
+      ei = tr->n_total_events++ & (em->event_ring_size - 1);
+      e = vec_elt_at_index (tr->event_ring, ei);
+    }
   else
-    ei = em->n_total_events++;
+    {
+      if (em->lock)
+	ei = clib_atomic_fetch_add (&em->n_total_events, 1);
+      else
+	ei = em->n_total_events++;
 
-  ei &= em->event_ring_size - 1;
-  e = vec_elt_at_index (em->event_ring, ei);
+      ei &= em->event_ring_size - 1;
+      e = vec_elt_at_index (em->event_ring, ei);
+    }
 
   e->time_cycles = cpu_time;
   e->event_type = type_index;
@@ -496,8 +547,6 @@ elog_data_inline (elog_main_t * em, elog_event_type_t * type,
 */
 u32 elog_string (elog_main_t * em, char *format, ...);
 
-void elog_time_now (elog_time_stamp_t * et);
-
 /** @brief convert event ring events to events, and return them as a vector.
     @param em elog_main_t *
     @return event vector with timestamps in f64 seconds
@@ -528,6 +577,14 @@ void elog_init (elog_main_t * em, u32 n_events);
 void elog_alloc (elog_main_t * em, u32 n_events);
 void elog_resize (elog_main_t * em, u32 n_events);
 
+/** @brief log events of each thread to its own ring
+    @param em elog_main_t *
+    @param n_threads number of threads, by os_get_thread_index()
+    @note no thread may be logging while the rings are enabled or disabled
+*/
+void elog_thread_rings_enable (elog_main_t * em, u32 n_threads);
+void elog_thread_rings_disable (elog_main_t * em);
+
 #ifdef CLIB_UNIX
 always_inline clib_error_t *
 elog_write_file (elog_main_t * em, char *clib_file, int flush_ring)
@@ -547,6 +604,14 @@ elog_write_file (elog_main_t * em, char *clib_file, int flush_ring)
 clib_error_t *elog_write_file_not_inline (elog_main_t * em, char *clib_file,
 					  int flush_ring);
 
+/** @brief write events as Chrome trace event JSON, as read by Perfetto
+    @param em elog_main_t *
+    @param clib_file file name
+    @param flush_ring collect the events from the rings first
+*/
+clib_error_t *elog_write_chrome_trace (elog_main_t * em, char *clib_file,
+				       int flush_ring);
+
 always_inline clib_error_t *
 elog_read_file (elog_main_t * em, char *clib_file)
 {
@@ -24,6 +24,14 @@
 
 #include <vppinfra/bihash_template.c>
 
+/* a call to run once every reader has been past a lookup since */
+typedef struct
+{
+  void (*fn) (void *);
+  u8 *arg;
+  u64 *seen;
+} test_bihash_reclaim_t;
+
 typedef struct
 {
   volatile u32 thread_barrier;
@@ -40,6 +48,13 @@ typedef struct
   int verbose;
   int non_random_keys;
   u32 nthreads;
+  volatile u32 n_keys_added;
+  volatile u32 readers_stop;
+  u64 *reader_lookups;
+  u64 *reader_misses;
+  u64 *reader_transient_misses;
+  u64 *reader_quiescent;
+  test_bihash_reclaim_t *reclaims;
   uword *key_hash;
   u64 *keys;
   uword hash_memory_size;
@@ -247,6 +262,239 @@ test_bihash_threads (test_main_t * tm)
   return 0;
 }
 
+void *
+test_bihash_resize_reader_fn (void *arg)
+{
+  test_main_t *tm = &test_main;
+  BVT (clib_bihash) * h = &tm->hash;
+  BVT (clib_bihash_kv) kv;
+  u32 my_thread_index = (u32) (u64) arg;
+  u32 seed = my_thread_index + 1, n;
+  u64 lookups = 0, misses = 0, transient = 0, quiescent = 0;
+
+  __os_thread_index = my_thread_index + 1;
+  clib_mem_set_per_cpu_heap (tm->global_heap);
+
+  while (tm->thread_barrier)
+    ;
+
+  while (tm->readers_stop == 0)
+    {
+      /* done with whatever an earlier lookup looked at */
+      __atomic_store_n (&tm->reader_quiescent[my_thread_index], ++quiescent,
+			__ATOMIC_SEQ_CST);
+
+      n = tm->n_keys_added;
+      if (n == 0)
+	continue;
+      kv.key = tm->keys[random_u32 (&seed) % n];
+      lookups++;
+      if (BV (clib_bihash_search) (h, &kv, &kv) == 0 && kv.value == kv.key + 1)
+	continue;
+      /*
+       * Retired pages are only reused once every reader has been past a
+       * lookup, so no search may miss. A miss that goes away on a second
+       * search is counted apart, to tell a reuse too early from a lost key.
+       */
+      transient++;
+      if (BV (clib_bihash_search) (h, &kv, &kv) < 0 || kv.value != kv.key + 1)
+	misses++;
+    }
+
+  tm->reader_lookups[my_thread_index] = lookups;
+  tm->reader_misses[my_thread_index] = misses;
+  tm->reader_transient_misses[my_thread_index] = transient;
+  (void) __atomic_sub_fetch (&tm->threads_running, 1, __ATOMIC_ACQUIRE);
+  return 0;
+}
+
+/* the table's reclaim function, called by the thread adding keys */
+static void
+test_bihash_reclaim (void (*fn) (void *), void *arg, u32 arg_size)
+{
+  test_main_t *tm = &test_main;
+  test_bihash_reclaim_t *r;
+  u32 i;
+
+  /* the table no longer points at what is retired */
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+  vec_add2 (tm->reclaims, r, 1);
+  r->fn = fn;
+  r->arg = 0;
+  vec_add (r->arg, arg, arg_size);
+  r->seen = 0;
+  for (i = 0; i < tm->nthreads; i++)
+    vec_add1 (r->seen, __atomic_load_n (&tm->reader_quiescent[i],
+					 __ATOMIC_SEQ_CST));
+}
+
+/* Run the reclaim calls, in order, the readers are done with; all of
+ * them once the readers have stopped */
+static void
+test_bihash_reclaim_poll (test_main_t *tm, int all)
+{
+  test_bihash_reclaim_t *r;
+  u32 n_done, i;
+
+  for (n_done = 0; n_done < vec_len (tm->reclaims); n_done++)
+    {
+      r = tm->reclaims + n_done;
+      for (i = 0; !all && i < tm->nthreads; i++)
+	if (__atomic_load_n (&tm->reader_quiescent[i], __ATOMIC_SEQ_CST) ==
+	    r->seen[i])
+	  goto done;
+      r->fn (r->arg);
+      vec_free (r->arg);
+      vec_free (r->seen);
+    }
+
+done:
+  vec_delete (tm->reclaims, n_done, 0);
+}
+
+static int
+test_bihash_u64_cmp (void *a1, void *a2)
+{
+  u64 *v1 = a1, *v2 = a2;
+
+  return *v1 < *v2 ? -1 : *v1 > *v2;
+}
+
+/*
+ * Grow an auto-resizing table from a few buckets to nitems keys while
+ * reader threads search it. No reader may miss a key that was added,
+ * even for a moment, and no add may stall for a whole rehash.
+ */
+static clib_error_t *
+test_bihash_resize (test_main_t *tm)
+{
+  BVT (clib_bihash_init2_args) _a, *a = &_a;
+  BVT (clib_bihash) * h = &tm->hash;
+  BVT (clib_bihash_kv) kv;
+  pthread_t handle, *handles = 0;
+  u64 *add_clocks = 0, t0, lookups = 0, misses = 0, transient = 0;
+  u32 seed = tm->seed, i;
+  f64 before, delta;
+  int rv;
+
+  clib_memset (a, 0, sizeof (*a));
+  a->h = h;
+  a->name = "test";
+  a->nbuckets = tm->nbuckets;
+  a->memory_size = tm->hash_memory_size;
+  a->instantiate_immediately = 1;
+  a->auto_resize = 1;
+  a->reclaim_fn = test_bihash_reclaim;
+  BV (clib_bihash_init2) (a);
+
+  for (i = 0; i < tm->nitems; i++)
+    vec_add1 (tm->keys, ((u64) random_u32 (&seed) << 32) | i);
+  vec_validate (add_clocks, tm->nitems - 1);
+  vec_validate (tm->reader_lookups, tm->nthreads);
+  vec_validate (tm->reader_misses, tm->nthreads);
+  vec_validate (tm->reader_transient_misses, tm->nthreads);
+  vec_validate (tm->reader_quiescent, tm->nthreads);
+
+  tm->thread_barrier = 1;
+  tm->readers_stop = 0;
+  tm->n_keys_added = 0;
+
+  for (i = 0; i < tm->nthreads; i++)
+    {
+      rv = pthread_create (&handle, NULL, test_bihash_resize_reader_fn,
+			   (void *) (u64) i);
+      if (rv)
+	return clib_error_return (0, "pthread_create returned %d", rv);
+      vec_add1 (handles, handle);
+    }
+  tm->threads_running = i;
+  CLIB_MEMORY_BARRIER ();
+  tm->thread_barrier = 0;
+
+  before = clib_time_now (&tm->clib_time);
+
+  for (i = 0; i < tm->nitems; i++)
+    {
+      kv.key = tm->keys[i];
+      kv.value = kv.key + 1;
+      t0 = clib_cpu_time_now ();
+      BV (clib_bihash_add_del) (h, &kv, 1 /* is_add */);
+      add_clocks[i] = clib_cpu_time_now () - t0;
+      CLIB_MEMORY_STORE_BARRIER ();
+      tm->n_keys_added = i + 1;
+      test_bihash_reclaim_poll (tm, 0 /* all */);
+    }
+
+  delta = clib_time_now (&tm->clib_time) - before;
+
+  tm->readers_stop = 1;
+  vec_foreach_index (i, handles)
+    pthread_join (handles[i], 0);
+  test_bihash_reclaim_poll (tm, 1 /* all */);
+
+  for (i = 0; i < tm->nthreads; i++)
+    {
+      lookups += tm->reader_lookups[i];
+      misses += tm->reader_misses[i];
+      transient += tm->reader_transient_misses[i];
+    }
+
+  vec_sort_with_function (add_clocks, test_bihash_u64_cmp);
+
+  fformat (stdout, "%d adds in %.6f seconds, %d buckets\n", tm->nitems,
+	   delta, h->nbuckets);
+  fformat (stdout, "add clocks: p50 %llu p99 %llu max %llu\n",
+	   add_clocks[tm->nitems / 2], add_clocks[(tm->nitems * 99ULL) / 100],
+	   add_clocks[tm->nitems - 1]);
+  if (tm->nthreads)
+    fformat (stdout,
+	     "%llu lookups by %d readers, %.2f/sec, %llu misses "
+	     "(%llu transient)\n",
+	     lookups, tm->nthreads, (f64) lookups / delta, misses, transient);
+
+  if (tm->verbose)
+    fformat (stdout, "%U", BV (format_bihash), h, tm->verbose > 1);
+
+  if (misses || transient)
+    return clib_error_return (0, "%llu lookups missed (%llu transient)",
+			      misses + transient, transient);
+
+  /* finish any resize without writes, as vpp's resize process does */
+  while (BV (clib_bihash_resize_step) (h, 16))
+    ;
+  if (h->resizing)
+    return clib_error_return (0, "resize not finished");
+  test_bihash_reclaim_poll (tm, 1 /* all */);
+
+  for (i = 0; i < tm->nitems; i++)
+    {
+      kv.key = tm->keys[i];
+      if (BV (clib_bihash_search) (h, &kv, &kv) < 0 || kv.value != kv.key + 1)
+	return clib_error_return (0, "search for key %lld failed", tm->keys[i]);
+    }
+
+  for (i = 0; i < tm->nitems; i++)
+    {
+      kv.key = tm->keys[i];
+      if (BV (clib_bihash_add_del) (h, &kv, 0 /* is_add */) < 0)
+	return clib_error_return (0, "delete key %lld failed", tm->keys[i]);
+    }
+
+  fformat (stdout, "%U", BV (format_bihash), h, 0 /* very verbose */);
+
+  test_bihash_reclaim_poll (tm, 1 /* all */);
+  BV (clib_bihash_free) (h);
+  vec_free (handles);
+  vec_free (add_clocks);
+  vec_free (tm->reader_lookups);
+  vec_free (tm->reader_misses);
+  vec_free (tm->reader_transient_misses);
+  vec_free (tm->reader_quiescent);
+
+  return 0;
+}
+
 static clib_error_t *
 test_bihash_vanilla_overwrite (test_main_t *tm)
 {
@@ -571,6 +819,10 @@ test_bihash_main (test_main_t * tm)
 	which = 4;
       else if (unformat (i, "value-assert"))
 	which = 5;
+      else if (unformat (i, "resize"))
+	which = 6;
+      else if (unformat (i, "readers %u", &tm->nthreads))
+	;
       else
 	return clib_error_return (0, "unknown input '%U'",
 				  format_unformat_error, i);
@@ -607,6 +859,10 @@ test_bihash_main (test_main_t * tm)
       error = test_bihash_value_assert (tm);
       break;
 
+    case 6:
+      error = test_bihash_resize (tm);
+      break;
+
     default:
       return clib_error_return (0, "no such test?");
     }
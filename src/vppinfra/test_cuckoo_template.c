@@ -0,0 +1,320 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vppinfra/time.h>
+#include <vppinfra/cache.h>
+#include <vppinfra/error.h>
+#include <vppinfra/random.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include <vppinfra/cuckoo_16_8.h>
+#include <vppinfra/cuckoo_template.h>
+
+#include <vppinfra/cuckoo_template.c>
+
+#include <vppinfra/bihash_16_8.h>
+#include <vppinfra/bihash_template.h>
+
+#include <vppinfra/bihash_template.c>
+
+typedef struct
+{
+  u32 seed;
+  u32 nitems;
+  u32 ncycles;
+  u32 nthreads;
+  f64 load;
+  int verbose;
+
+  clib_cuckoo_kv_16_8_t *kvs;
+  clib_cuckoo_16_8_t cuckoo;
+  clib_bihash_16_8_t bihash;
+
+  volatile u32 readers_stop;
+  u64 *reader_lookups;
+  u64 *reader_misses;
+
+  unformat_input_t *input;
+} test_main_t;
+
+test_main_t test_main;
+
+static void
+test_make_kvs (test_main_t *tm)
+{
+  clib_cuckoo_kv_16_8_t *kv;
+  u32 seed = tm->seed, i;
+
+  vec_validate (tm->kvs, 2 * tm->nitems - 1);
+
+  /* the second half are never added and are searched for misses */
+  for (i = 0; i < 2 * tm->nitems; i++)
+    {
+      kv = vec_elt_at_index (tm->kvs, i);
+      kv->key[0] = ((u64) random_u32 (&seed) << 32) | i;
+      kv->key[1] = random_u32 (&seed);
+      kv->value = i;
+    }
+}
+
+/* buckets for the requested load, with the items rounded down to keep it */
+static u32
+test_nbuckets (test_main_t *tm)
+{
+  u32 nbuckets = tm->nitems / (tm->load * CLIB_CUCKOO_KVP_PER_BUCKET);
+
+  nbuckets = 1 << min_log2 (clib_max (nbuckets, 2));
+  tm->nitems = clib_min (tm->nitems,
+			 nbuckets * CLIB_CUCKOO_KVP_PER_BUCKET * tm->load);
+  return nbuckets;
+}
+
+static clib_error_t *
+test_cuckoo_vs_bihash (test_main_t *tm)
+{
+  clib_cuckoo_16_8_t *h = &tm->cuckoo;
+  clib_bihash_16_8_t *bh = &tm->bihash;
+  clib_cuckoo_kv_16_8_t kv;
+  u32 i, nbuckets, n_wrong = 0, n_fails = 0;
+  u64 t[5];
+
+  nbuckets = test_nbuckets (tm);
+  test_make_kvs (tm);
+
+  clib_cuckoo_init_16_8 (h, "test cuckoo", nbuckets);
+  clib_bihash_init_16_8 (bh, "test bihash", nbuckets, 1ULL << 30);
+
+  t[0] = clib_cpu_time_now ();
+  for (i = 0; i < tm->nitems; i++)
+    n_fails += clib_cuckoo_add_del_16_8 (h, tm->kvs + i, 1) != 0;
+  t[1] = clib_cpu_time_now ();
+  for (i = 0; i < tm->nitems; i++)
+    clib_bihash_add_del_16_8 (bh, tm->kvs + i, 1);
+  t[2] = clib_cpu_time_now ();
+
+  fformat (stdout, "%u items, %u buckets, load %.2f\n", tm->nitems, nbuckets,
+	   (f64) tm->nitems / (nbuckets * CLIB_CUCKOO_KVP_PER_BUCKET));
+  fformat (stdout, "add:    cuckoo %8.2f bihash %8.2f clocks/kvp\n",
+	   (f64) (t[1] - t[0]) / tm->nitems, (f64) (t[2] - t[1]) / tm->nitems);
+
+  t[0] = clib_cpu_time_now ();
+  for (i = 0; i < tm->nitems; i++)
+    {
+      kv = tm->kvs[i];
+      kv.value = ~0;
+      if (clib_cuckoo_search_inline_16_8 (h, &kv) ||
+	  kv.value != tm->kvs[i].value)
+	n_wrong++;
+    }
+  t[1] = clib_cpu_time_now ();
+  for (i = 0; i < tm->nitems; i++)
+    {
+      kv = tm->kvs[i];
+      if (clib_bihash_search_inline_16_8 (bh, &kv))
+	n_wrong++;
+    }
+  t[2] = clib_cpu_time_now ();
+  for (i = tm->nitems; i < 2 * tm->nitems; i++)
+    {
+      kv = tm->kvs[i];
+      if (0 == clib_cuckoo_search_inline_16_8 (h, &kv))
+	n_wrong++;
+    }
+  t[3] = clib_cpu_time_now ();
+  for (i = tm->nitems; i < 2 * tm->nitems; i++)
+    {
+      kv = tm->kvs[i];
+      if (0 == clib_bihash_search_inline_16_8 (bh, &kv))
+	n_wrong++;
+    }
+  t[4] = clib_cpu_time_now ();
+
+  fformat (stdout, "hit:    cuckoo %8.2f bihash %8.2f clocks/search\n",
+	   (f64) (t[1] - t[0]) / tm->nitems, (f64) (t[2] - t[1]) / tm->nitems);
+  fformat (stdout, "miss:   cuckoo %8.2f bihash %8.2f clocks/search\n",
+	   (f64) (t[3] - t[2]) / tm->nitems, (f64) (t[4] - t[3]) / tm->nitems);
+
+  /* delete every other kvp, the rest must still be found */
+  for (i = 0; i < tm->nitems; i += 2)
+    if (clib_cuckoo_add_del_16_8 (h, tm->kvs + i, 0))
+      n_wrong++;
+  for (i = 0; i < tm->nitems; i++)
+    {
+      kv = tm->kvs[i];
+      if ((clib_cuckoo_search_inline_16_8 (h, &kv) == 0) != (i & 1))
+	n_wrong++;
+    }
+
+  fformat (stdout, "%U", format_cuckoo_16_8, h, tm->verbose);
+  fformat (stdout, "%U", format_bihash_16_8, bh, 0 /* verbose */);
+
+  clib_cuckoo_free_16_8 (h);
+  clib_bihash_free_16_8 (bh);
+  vec_free (tm->kvs);
+
+  if (n_fails)
+    return clib_error_return (0, "%u adds failed", n_fails);
+  if (n_wrong)
+    return clib_error_return (0, "%u wrong results", n_wrong);
+  return 0;
+}
+
+static void *
+test_reader_thread (void *arg)
+{
+  test_main_t *tm = &test_main;
+  uword thread_index = pointer_to_uword (arg);
+  clib_cuckoo_kv_16_8_t kv;
+  u64 n_lookups = 0, n_misses = 0;
+  u32 i;
+
+  while (!tm->readers_stop)
+    {
+      /* the first half of the kvps are never deleted */
+      for (i = 0; i < tm->nitems / 2; i++)
+	{
+	  kv = tm->kvs[i];
+	  kv.value = ~0;
+	  if (clib_cuckoo_search_inline_16_8 (&tm->cuckoo, &kv) ||
+	      kv.value != tm->kvs[i].value)
+	    n_misses++;
+	}
+      n_lookups += i;
+    }
+
+  tm->reader_lookups[thread_index] = n_lookups;
+  tm->reader_misses[thread_index] = n_misses;
+  return 0;
+}
+
+static clib_error_t *
+test_cuckoo_readers (test_main_t *tm)
+{
+  clib_cuckoo_16_8_t *h = &tm->cuckoo;
+  pthread_t *handles = 0, handle;
+  u64 n_lookups = 0, n_misses = 0;
+  u32 i, j, nbuckets;
+
+  nbuckets = test_nbuckets (tm);
+  test_make_kvs (tm);
+  clib_cuckoo_init_16_8 (h, "test cuckoo", nbuckets);
+
+  for (i = 0; i < tm->nitems; i++)
+    clib_cuckoo_add_del_16_8 (h, tm->kvs + i, 1);
+
+  vec_validate (tm->reader_lookups, tm->nthreads - 1);
+  vec_validate (tm->reader_misses, tm->nthreads - 1);
+
+  for (i = 0; i < tm->nthreads; i++)
+    {
+      if (pthread_create (&handle, NULL, test_reader_thread,
+			  uword_to_pointer (i, void *)))
+	return clib_error_return_unix (0, "pthread_create");
+      vec_add1 (handles, handle);
+    }
+
+  /* churn the second half, moving the permanent kvps about */
+  for (j = 0; j < tm->ncycles; j++)
+    {
+      for (i = tm->nitems / 2; i < tm->nitems; i++)
+	clib_cuckoo_add_del_16_8 (h, tm->kvs + i, 0);
+      for (i = tm->nitems / 2; i < tm->nitems; i++)
+	clib_cuckoo_add_del_16_8 (h, tm->kvs + i, 1);
+    }
+
+  tm->readers_stop = 1;
+  for (i = 0; i < vec_len (handles); i++)
+    pthread_join (handles[i], NULL);
+
+  for (i = 0; i < tm->nthreads; i++)
+    {
+      n_lookups += tm->reader_lookups[i];
+      n_misses += tm->reader_misses[i];
+    }
+
+  fformat (stdout, "%U", format_cuckoo_16_8, h, tm->verbose);
+  fformat (stdout, "%u readers: %llu lookups, %llu misses\n", tm->nthreads,
+	   n_lookups, n_misses);
+
+  clib_cuckoo_free_16_8 (h);
+  vec_free (handles);
+  vec_free (tm->kvs);
+  vec_free (tm->reader_lookups);
+  vec_free (tm->reader_misses);
+
+  if (n_misses)
+    return clib_error_return (0, "%llu permanent kvps missed", n_misses);
+  return 0;
+}
+
+clib_error_t *
+test_cuckoo_main (test_main_t *tm)
+{
+  unformat_input_t *i = tm->input;
+  int which = 0;
+
+  while (unformat_check_input (i) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (i, "seed %u", &tm->seed))
+	;
+      else if (unformat (i, "nitems %u", &tm->nitems))
+	;
+      else if (unformat (i, "ncycles %u", &tm->ncycles))
+	;
+      else if (unformat (i, "load %f", &tm->load))
+	;
+      else if (unformat (i, "readers %u", &tm->nthreads))
+	which = 1;
+      else if (unformat (i, "verbose"))
+	tm->verbose = 1;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, i);
+    }
+
+  if (tm->nitems == 0 || tm->load <= 0 || tm->load > 1)
+    return clib_error_return (0, "nitems must be non-zero, load in (0, 1]");
+
+  switch (which)
+    {
+    case 0:
+      return test_cuckoo_vs_bihash (tm);
+
+    case 1:
+      return test_cuckoo_readers (tm);
+
+    default:
+      return clib_error_return (0, "no such test?");
+    }
+}
+
+#ifdef CLIB_UNIX
+int
+main (int argc, char *argv[])
+{
+  unformat_input_t i;
+  clib_error_t *error;
+  test_main_t *tm = &test_main;
+
+  clib_mem_init (0, 4095ULL << 20);
+
+  tm->input = &i;
+  tm->seed = 0xdeaddabe;
+  tm->nitems = 1 << 20;
+  tm->ncycles = 10;
+  tm->load = 0.9;
+
+  unformat_init_command_line (&i, argv);
+  error = test_cuckoo_main (tm);
+  unformat_free (&i);
+
+  if (error)
+    {
+      clib_error_report (error);
+      return 1;
+    }
+  return 0;
+}
+#endif /* CLIB_UNIX */
@@ -98,7 +98,7 @@ u16x32_msb_mask (u16x32 v)
 }
 
 #define u64x8_i64gather(index, base, scale)                                   \
-  (u64x8) _mm512_i64gather_epi64 ((__m512i) index, base, scale)
+  (u64x8) _mm512_i64gather_epi64 ((__m512i) (index), base, scale)
 
 /* 512-bit packs */
 #define _(f, t, fn)                                                           \
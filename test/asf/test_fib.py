@@ -43,6 +43,46 @@ class TestFIB(VppAsfTestCase):
             self.logger.critical(error)
         self.assertNotIn("Failed", error)
 
+    def test_fib_bulk(self):
+        """FIB bulk route programming"""
+        error = self.vapi.cli("test fib bulk 2000")
+
+        if error:
+            self.logger.info(error)
+        self.assertNotIn("Failed", error)
+
+    def test_fib_pic(self):
+        """FIB prefix independent convergence"""
+        error = self.vapi.cli("test fib pic 5000")
+
+        if error:
+            self.logger.info(error)
+        self.assertNotIn("Failed", error)
+
+    def test_fib_resilient(self):
+        """FIB resilient hashing"""
+        error = self.vapi.cli("test fib resilient")
+
+        if error:
+            self.logger.info(error)
+        self.assertNotIn("Failed", error)
+
+    def test_ip4_mtrie(self):
+        """IPv4 MTRIE stride comparison"""
+        error = self.vapi.cli("test ip4 mtrie routes 10000 lookups 100000")
+
+        if error:
+            self.logger.info(error)
+        self.assertNotIn("Failed", error)
+
+    def test_ip6_mtrie(self):
+        """IPv6 MTRIE vs hash comparison"""
+        error = self.vapi.cli("test ip6 mtrie routes 10000 lookups 100000")
+
+        if error:
+            self.logger.info(error)
+        self.assertNotIn("Failed", error)
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
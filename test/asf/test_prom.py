@@ -3,6 +3,7 @@ from asfframework import VppAsfTestCase, VppTestRunner, get_testcase_dirname
 import unittest
 import subprocess
 import os
+import re
 from vpp_qemu_utils import (
     create_host_interface,
     delete_all_host_interfaces,
@@ -47,6 +48,8 @@ class TestProm(VppAsfTestCase):
         cls.vapi.cli(f"create host-interface name {cls.vpp_if_name}")
         cls.vapi.cli(f"set int state host-{cls.vpp_if_name} up")
         cls.vapi.cli(f"set int ip address host-{cls.vpp_if_name} 10.10.1.2/24")
+        cls.vapi.cli("http static server uri tcp://0.0.0.0/80 url-handlers")
+        cls.vapi.cli("prom enable")
 
     @classmethod
     def tearDownClass(cls):
@@ -55,10 +58,36 @@ class TestProm(VppAsfTestCase):
 
         super(TestProm, cls).tearDownClass()
 
+    def scrape(self):
+        """Fetch stats.prom, return its content type and its lines"""
+        process = subprocess.run(
+            [
+                "ip",
+                "netns",
+                "exec",
+                self.ns_name,
+                "curl",
+                "-s",
+                "-i",
+                f"10.10.1.2/stats.prom",
+            ],
+            capture_output=True,
+        )
+        headers, _, body = process.stdout.partition(b"\r\n\r\n")
+        m = re.search(rb"^content-type: *([^;\s]+)", headers, re.M | re.I)
+        self.assertIsNotNone(m, headers)
+        return m.group(1).decode(), body.decode().splitlines()
+
+    def show_prom(self):
+        """Return the stats matched, lines formatted and lines reused"""
+        reply = self.vapi.cli("show prom")
+        self.logger.info(reply)
+        matched = re.search(r"(\d+) stats matched", reply)
+        lines = re.search(r"lines formatted (\d+), reused (\d+)", reply)
+        return int(matched.group(1)), int(lines.group(1)), int(lines.group(2))
+
     def test_prom(self):
         """Enable HTTP Static server and prometheus exporter, get stats"""
-        self.vapi.cli("http static server uri tcp://0.0.0.0/80 url-handlers")
-        self.vapi.cli("prom enable")
         self.sleep(1, "wait for min-scrape-interval to expire")
 
         process = subprocess.run(
@@ -74,6 +103,83 @@ class TestProm(VppAsfTestCase):
         )
         self.assertIn(b"TYPE", process.stdout)
 
+    def test_prom_formats(self):
+        """Both exposition formats over http, scalars are gauges"""
+        self.vapi.cli("prom min-scrape-interval 0 all-stats format prometheus")
+
+        ct, lines = self.scrape()
+        self.assertEqual(ct, "text/plain")
+        self.assertIn("# TYPE vpp_sys_vector_rate gauge", lines)
+        self.assertTrue(any(l.startswith("vpp_sys_vector_rate ") for l in lines))
+        self.assertTrue(any(l.endswith(" counter") for l in lines))
+        self.assertFalse(any("_total{" in l for l in lines))
+        self.assertNotIn("# EOF", lines)
+
+        self.vapi.cli("prom format openmetrics")
+        ct, lines = self.scrape()
+        self.assertEqual(ct, "application/openmetrics-text")
+        self.assertEqual(lines[-1], "# EOF")
+        # counters are suffixed _total, gauges are not
+        self.assertIn("# TYPE vpp_sys_vector_rate gauge", lines)
+        self.assertTrue(any(l.startswith("vpp_sys_vector_rate ") for l in lines))
+        self.assertFalse(any(l.startswith("vpp_sys_vector_rate_total") for l in lines))
+        self.assertTrue(any(re.match(r"vpp_\S+_total\{thread=", l) for l in lines))
+
+        self.vapi.cli("prom format prometheus")
+
+    def test_prom_cache(self):
+        """Unchanged lines are reused, changes and switches reformat"""
+        self.vapi.cli("prom min-scrape-interval 0 all-stats format prometheus")
+
+        # every line of the first scrape after a format switch is new
+        _, formatted0, reused0 = self.show_prom()
+        self.vapi.cli("prom format openmetrics")
+        self.scrape()
+        _, formatted, reused = self.show_prom()
+        self.assertGreater(formatted, formatted0)
+        self.assertEqual(reused, reused0)
+
+        # most lines are unchanged, but the host interface's counters
+        # moved with the http traffic of the last scrape
+        rx = f"vpp_interfaces_host_{self.vpp_if_name}_rx_packets"
+        rx = re.sub(r"\W", "_", rx)
+        _, lines1 = self.scrape()
+        _, formatted1, reused1 = self.show_prom()
+        _, lines2 = self.scrape()
+        _, formatted2, reused2 = self.show_prom()
+        self.assertGreater(reused2 - reused1, formatted2 - formatted1)
+        self.assertGreater(formatted2 - formatted1, 0)
+        rx1 = [l for l in lines1 if l.startswith(rx)]
+        rx2 = [l for l in lines2 if l.startswith(rx)]
+        self.assertTrue(rx1)
+        self.assertNotEqual(rx1, rx2)
+
+        # switching to used-only flushes the cache and drops zero counters
+        zero = re.compile(r"\{thread=\"\d+\",interface=\"\d+\"\} 0$")
+        self.assertTrue(any(zero.search(l) for l in lines2))
+        self.vapi.cli("prom used-only")
+        _, lines = self.scrape()
+        _, _, reused3 = self.show_prom()
+        self.assertEqual(reused3, reused2)
+        self.assertFalse(any(zero.search(l) for l in lines))
+        self.vapi.cli("prom all-stats")
+        _, lines = self.scrape()
+        _, _, reused4 = self.show_prom()
+        self.assertEqual(reused4, reused3)
+        self.assertTrue(any(zero.search(l) for l in lines))
+
+        # a new interface changes the stats directory and its epoch, so
+        # the stats are listed again and the new ones are scraped
+        matched, _, _ = self.show_prom()
+        self.vapi.cli("create loopback interface")
+        _, lines = self.scrape()
+        matched_loop, _, _ = self.show_prom()
+        self.assertGreater(matched_loop, matched)
+        self.assertTrue(any(l.startswith("vpp_interfaces_loop0_") for l in lines))
+        self.vapi.cli("delete loopback interface intfc loop0")
+
+        self.vapi.cli("prom format prometheus")
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
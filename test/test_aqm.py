@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 Cisco Systems, Inc.
+
+import re
+import unittest
+
+from scapy.layers.inet import IP, UDP
+from scapy.layers.l2 import Ether
+from scapy.packet import Raw
+
+from framework import VppTestCase
+from asfframework import VppTestRunner
+
+NUM_PKTS = 100
+
+
+class TestAQM(VppTestCase):
+    """Active queue management"""
+
+    vpp_worker_count = 2
+
+    def setUp(self):
+        super(TestAQM, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+        self.pkt = (
+            Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+            / IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4)
+            / UDP(sport=1234, dport=1234)
+            / Raw(b"\xa5" * 100)
+        )
+
+    def tearDown(self):
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+        super(TestAQM, self).tearDown()
+
+    def handoff_queue_index(self):
+        reply = self.vapi.cli("show frame-queue occupancy")
+        self.logger.info(reply)
+        m = re.search(r"queue index (\d+) \(next node 'ethernet-input'\)", reply)
+        return int(m.group(1))
+
+    def test_aqm_frame_queue(self):
+        """CoDel on a worker handoff queue"""
+        self.vapi.cli("set interface handoff pg0 workers 1")
+        index = self.handoff_queue_index()
+
+        self.vapi.cli("set frame-queue aqm index %d codel" % index)
+        self.assertIn("aqm codel", self.vapi.cli("show frame-queue occupancy"))
+
+        # nothing waits for long, nothing is dropped
+        self.send_and_expect(self.pg0, self.pkt * NUM_PKTS, self.pg1)
+
+        name = "/aqm/frame-queue/%d/" % index
+        self.assertEqual(self.statistics[name + "sojourn"].sum_packets(), NUM_PKTS)
+        self.assertEqual(self.statistics[name + "drops"].sum(), 0)
+        self.logger.info(self.vapi.cli("show aqm"))
+
+        # queues which steal cannot have aqm
+        reply = self.vapi.cli("set frame-queue steal index %d any" % index)
+        self.assertIn("has AQM", reply)
+
+        self.vapi.cli("set frame-queue aqm index %d off" % index)
+        self.assertNotIn("frame-queue", self.vapi.cli("show aqm"))
+
+        self.vapi.cli("set interface handoff pg0 workers 1 disable")
+
+    def test_aqm_tx_queue(self):
+        """CoDel on a tx queue"""
+        self.vapi.cli("set interface tx-queue aqm pg1 codel target 10 interval 1000")
+        self.assertIn("aqm codel", self.vapi.cli("show hardware pg1"))
+
+        # a full 1024 descriptor ring at 10 Mbps holds some 100ms
+        self.vapi.cli("test interface tx-queue pg1 size 1024 free 0 speed 10000")
+
+        for i in range(10):
+            self.pg0.add_stream(self.pkt * 10)
+            self.pg_enable_capture(self.pg_interfaces)
+            self.pg_start()
+            self.sleep(0.01)
+
+        self.logger.info(self.vapi.cli("show aqm"))
+        sojourn = self.statistics["/aqm/tx/pg1/0/sojourn"]
+        drops = self.statistics["/aqm/tx/pg1/0/drops"].sum()
+        self.assertEqual(sojourn.sum_packets(), NUM_PKTS)
+        self.assertGreater(drops, 0)
+        self.assertLess(drops, NUM_PKTS)
+
+        # an empty ring drops nothing
+        self.vapi.cli("clear aqm")
+        self.vapi.cli("test interface tx-queue pg1 free 1024")
+        self.send_and_expect(self.pg0, self.pkt * NUM_PKTS, self.pg1)
+        self.assertEqual(self.statistics["/aqm/tx/pg1/0/drops"].sum(), 0)
+
+        self.vapi.cli("set interface tx-queue aqm pg1 off")
+        self.assertNotIn("aqm", self.vapi.cli("show hardware pg1"))
+        self.vapi.cli("test interface tx-queue pg1 size 0")
+
+    def test_aqm_unittest(self):
+        """CoDel, FQ-CoDel and PIE"""
+        error = self.vapi.cli("test aqm")
+        self.logger.info(error)
+        self.assertNotIn("failed", error)
+        self.assertIn("pie:", error)
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=VppTestRunner)
@@ -754,6 +754,69 @@ class TestClassifierComplex(TestClassifier):
         self.pg2.assert_nothing_captured(remark="packets forwarded")
         self.pg3.assert_nothing_captured(remark="packets forwarded")
 
+    def test_iacl_nested_compiled(self):
+        """Nested input ACL test with a compiled chain
+
+        Test scenario for a compiled chain matching on ip src and udp ports
+            - Create IPv4 stream for pg0 -> pg1 interface.
+            - Create a chain of two tables, the session in the second one
+            - Compile the chain
+            - Send and verify received packets on pg1 interface.
+        """
+
+        sport = 13721
+        dport = 9081
+        pkts = self.create_stream(
+            self.pg0, self.pg1, self.pg_if_packet_sizes, UDP(sport=sport, dport=dport)
+        )
+
+        self.pg0.add_stream(pkts)
+
+        subtable_key = "subtable_compiled_in"
+        self.create_classify_table(
+            subtable_key,
+            self.build_ip_mask(src_ip="ffffffff", src_port="ffff", dst_port="ffff"),
+        )
+
+        key = "compiled_in"
+        self.create_classify_table(
+            key,
+            self.build_ip_mask(dst_ip="ffffffff"),
+            next_table_index=self.acl_tbl_idx.get(subtable_key),
+        )
+
+        self.create_classify_session(
+            self.acl_tbl_idx.get(subtable_key),
+            self.build_ip_match(
+                src_ip=self.pg0.remote_ip4, src_port=sport, dst_port=dport
+            ),
+        )
+
+        self.vapi.cli("classify chain table %d" % self.acl_tbl_idx.get(key))
+        chains = self.vapi.cli("show classify chains")
+        self.assertIn("head table %d, 2 tables" % self.acl_tbl_idx.get(key), chains)
+
+        self.input_acl_set_interface(self.pg0, self.acl_tbl_idx.get(key))
+        self.acl_active_table = key
+
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+        pkts = self.pg1.get_capture(len(pkts))
+        self.verify_capture(self.pg1, pkts)
+        self.pg0.assert_nothing_captured(remark="packets forwarded")
+        self.pg2.assert_nothing_captured(remark="packets forwarded")
+        self.pg3.assert_nothing_captured(remark="packets forwarded")
+
+        self.vapi.cli("classify chain table %d del" % self.acl_tbl_idx.get(key))
+        self.assertIn("No compiled chains", self.vapi.cli("show classify chains"))
+
+    def test_classify_chain_unittest(self):
+        """Compiled chain against table by table lookup"""
+        error = self.vapi.cli("test classify chain packets 10000 rounds 2")
+        self.logger.info(error)
+        self.assertNotIn("failed", error)
+
     def test_oacl_nested(self):
         """Nested output ACL test
 
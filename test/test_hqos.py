@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 Cisco Systems, Inc.
+
+import re
+import unittest
+
+from scapy.layers.inet import IP, UDP
+from scapy.layers.l2 import Ether, Dot1Q
+from scapy.packet import Raw
+
+from framework import VppTestCase
+from asfframework import VppTestRunner
+from vpp_sub_interface import VppDot1QSubint
+
+NUM_PKTS = 100
+
+
+class TestHQoS(VppTestCase):
+    """Hierarchical QoS scheduler"""
+
+    vpp_worker_count = 2
+
+    def setUp(self):
+        super(TestHQoS, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+        self.pkt = (
+            Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+            / IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4)
+            / UDP(sport=1234, dport=1234)
+            / Raw(b"\xa5" * 100)
+        )
+
+    def tearDown(self):
+        self.vapi.cli("hqos port pg1 del")
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+        super(TestHQoS, self).tearDown()
+
+    def port_counter(self, name):
+        reply = self.vapi.cli("show hqos pg1")
+        self.logger.info(reply)
+        return int(re.search(r"%s (\d+)" % name, reply).group(1))
+
+    def test_hqos_unshaped(self):
+        """Unshaped port forwards everything"""
+        self.vapi.cli("hqos port pg1 worker 1")
+
+        self.send_and_expect(self.pg0, self.pkt * NUM_PKTS, self.pg1)
+
+        self.assertEqual(self.port_counter("enqueued"), NUM_PKTS)
+        self.assertEqual(self.port_counter("dequeued"), NUM_PKTS)
+        self.assertEqual(self.port_counter("dropped"), 0)
+
+    def test_hqos_pipe_shaped(self):
+        """Pipe shaper spreads a burst out"""
+        # 100 kbytes/s with a 2 kbyte burst, the 14 kbyte burst sent
+        # takes at least 120ms to come out
+        self.vapi.cli("hqos port pg1 queue-size 128")
+        self.vapi.cli("hqos pipe pg1 pipe 0 rate 800000 burst 2048")
+
+        self.pg0.add_stream(self.pkt * NUM_PKTS)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+        rx = self.pg1.get_capture(NUM_PKTS, timeout=5)
+
+        self.assertGreater(rx[-1].time - rx[0].time, 0.1)
+        self.assertEqual(self.port_counter("dropped"), 0)
+
+    def test_hqos_tail_drop(self):
+        """Full queues drop"""
+        self.vapi.cli("hqos port pg1 rate 80000 burst 1500 queue-size 16")
+
+        self.pg0.add_stream(self.pkt * NUM_PKTS)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+        self.sleep(0.5)
+
+        self.assertGreater(self.port_counter("dropped"), 0)
+        self.assertEqual(
+            self.port_counter("enqueued") + self.port_counter("dropped"), NUM_PKTS
+        )
+
+    def test_hqos_subinterface(self):
+        """Sub-interface mapped onto a pipe"""
+        sub = VppDot1QSubint(self, self.pg1, 100)
+        sub.admin_up()
+        sub.config_ip4()
+        sub.resolve_arp()
+
+        self.vapi.cli("hqos port pg1 pipes 4")
+        self.vapi.cli("hqos pipe pg1 pipe 2 rate 80000")
+        self.vapi.cli("hqos map %s port pg1 pipe 1" % sub.name)
+        self.assertIn("-> pipe 1", self.vapi.cli("show hqos pg1"))
+
+        pkt = (
+            Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+            / IP(src=self.pg0.remote_ip4, dst=sub.remote_ip4)
+            / UDP(sport=1234, dport=1234)
+            / Raw(b"\xa5" * 100)
+        )
+        rx = self.send_and_expect(self.pg0, pkt * NUM_PKTS, self.pg1)
+        for p in rx:
+            self.assertEqual(p[Dot1Q].vlan, 100)
+
+        reply = self.vapi.cli("show hqos pg1 verbose")
+        self.logger.info(reply)
+        self.assertIn("pipe 1:", reply)
+        self.assertNotIn("pipe 2:", reply)
+
+        self.vapi.cli("hqos map %s port pg1 del" % sub.name)
+        self.assertNotIn("-> pipe 1", self.vapi.cli("show hqos pg1"))
+
+        sub.unconfig_ip4()
+        sub.remove_vpp_config()
+
+    def test_hqos_unittest(self):
+        """Scheduler benchmark"""
+        error = self.vapi.cli("test hqos pipes 4096 packets 100000 rounds 2")
+        self.logger.info(error)
+        self.assertNotIn("failed", error)
+        self.assertNotIn("dequeued", error)
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=VppTestRunner)
@@ -191,5 +191,34 @@ class TestInterfaceDumpApi(VppTestCase):
         self.assertEqual(len(rv), 3, "Expected 3 interfaces.")
 
 
+
+class TestInterfaceRxRebalance(VppTestCase):
+    """test_interface_crud.TestInterfaceRxRebalance"""
+
+    def test_rx_rebalance(self):
+        self.vapi.sw_interface_rx_rebalance_enable_disable(
+            enable=True, interval=0.5, hold_down=10, threshold=32, n_samples=2
+        )
+        show = self.vapi.cli("show interface rx-rebalance")
+        self.assertIn("rx-rebalance enabled", show)
+        self.assertIn("threshold 32, samples 2, hold-down 10s", show)
+
+        # nothing to rebalance without busy workers
+        self.assertEqual(len(self.vapi.sw_interface_rx_rebalance_dump()), 0)
+
+        # the threshold is a vector rate
+        with self.vapi.assert_negative_api_retval():
+            self.vapi.sw_interface_rx_rebalance_enable_disable(threshold=1000)
+
+        # zero values keep the settings
+        self.vapi.sw_interface_rx_rebalance_enable_disable(enable=False)
+        show = self.vapi.cli("show interface rx-rebalance")
+        self.assertIn("rx-rebalance disabled: interval 0.50s", show)
+
+        self.vapi.cli("set interface rx-rebalance threshold 48 samples 4")
+        self.assertIn("threshold 48", self.vapi.cli("show interface rx-rebalance"))
+        self.vapi.cli("set interface rx-rebalance disable")
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
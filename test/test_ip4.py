@@ -831,6 +831,44 @@ class TestIPv4FibCrud(VppTestCase):
         )
         self.verify_not_in_route_dump(self.deleted_routes)
 
+    def test_4_bulk_routes(self):
+        """Add and delete 200 routes in bulk"""
+
+        path = VppRoutePath(self.pg0.remote_ip4, 0xFFFFFFFF)
+        routes = [
+            VppIpRoute(self, "10.0.%d.%d" % (2 + i // 100, i % 100), 32, [path])
+            for i in range(200)
+        ]
+        entries = [
+            {
+                "table_id": 0,
+                "is_multipath": False,
+                "prefix": r.prefix,
+                "path": path.encode(),
+            }
+            for r in routes
+        ]
+
+        reply = self.vapi.ip_route_add_del_bulk(
+            is_add=True, n_routes=len(entries), routes=entries
+        )
+        self.assertEqual(reply.n_done, len(entries))
+        self.verify_route_dump(routes)
+
+        self.stream_1 = self.create_stream(self.pg1, self.pg0, routes, 100)
+        self.pg1.add_stream(self.stream_1)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+        pkts = self.pg0.get_capture(len(self.stream_1))
+        self.verify_capture(self.pg0, pkts, self.stream_1)
+
+        reply = self.vapi.ip_route_add_del_bulk(
+            is_add=False, n_routes=len(entries), routes=entries
+        )
+        self.assertEqual(reply.n_done, len(entries))
+        self.verify_not_in_route_dump(routes)
+
 
 class TestIPNull(VppTestCase):
     """IPv4 routes via NULL"""
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 Cisco Systems, Inc.
+
+import unittest
+
+from scapy.layers.inet import IP, UDP
+from scapy.layers.l2 import Ether
+from scapy.packet import Raw
+
+from framework import VppTestCase
+from asfframework import VppTestRunner
+from vpp_papi_provider import CliFailedCommandError
+
+
+class TestNodeBatching(VppTestCase):
+    """Input node batching"""
+
+    def setUp(self):
+        super(TestNodeBatching, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+        self.pkts = [
+            (
+                Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+                / IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4)
+                / UDP(sport=1234, dport=1234 + i % 64)
+                / Raw(b"\xa5" * 100)
+            )
+            for i in range(2000)
+        ]
+
+    def tearDown(self):
+        self.vapi.cli("set node batching pg-input disable")
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+        super(TestNodeBatching, self).tearDown()
+
+    def send_at_rate(self, pps):
+        """Send the packets at the given rate, expect them all on pg1"""
+        self.pg0.add_stream(self.pkts)
+        self.vapi.cli(
+            "packet-generator configure %s rate %d" % (self.pg0.get_cap_name(), pps)
+        )
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start(trace=False)
+        self.pg1.get_capture(len(self.pkts))
+
+    def show_batching(self):
+        """Return the pg-input row of show node batching, by column"""
+        reply = self.vapi.cli("show node batching")
+        self.logger.info(reply)
+        for line in reply.splitlines():
+            f = line.split()
+            if f and f[0] == "pg-input":
+                return {
+                    "budget": float(f[2]),
+                    "min": int(f[3]),
+                    "before": float(f[4]),
+                    "vec_per_call": float(f[5]),
+                    "skipped": int(f[6]),
+                    "held": float(f[7]),
+                    "hold_us": float(f[8]),
+                }
+        return None
+
+    def test_batching(self):
+        """Polls are held down, frames coalesce, holds expire"""
+        budget_us = 1000
+        pps = 100000
+
+        # a slow stream is polled a packet or so at a time
+        self.vapi.cli("clear runtime")
+        self.send_at_rate(pps)
+        self.assertIsNone(self.show_batching())
+
+        with self.assertRaisesRegex(CliFailedCommandError, "not an input node"):
+            self.vapi.cli("set node batching ip4-lookup budget 10")
+        with self.assertRaisesRegex(CliFailedCommandError, "min-vectors"):
+            self.vapi.cli("set node batching pg-input budget 10 min-vectors 0")
+
+        self.vapi.cli("set node batching pg-input budget %d min-vectors 32" % budget_us)
+        b = self.show_batching()
+        self.assertEqual(b["budget"], budget_us)
+        self.assertEqual(b["min"], 32)
+        self.assertEqual(b["skipped"], 0)
+        self.assertGreater(b["before"], 0)
+
+        # small polls hold the node down, the packets that came in during
+        # the hold make up the next frame once it expires, and every
+        # packet still gets through
+        self.send_at_rate(pps)
+        b = self.show_batching()
+        self.assertGreater(b["skipped"], 0)
+        self.assertGreater(b["held"], b["before"])
+        self.assertGreaterEqual(b["held"], 8)
+        self.assertGreaterEqual(b["hold_us"], budget_us * 0.99)
+
+        self.vapi.cli("set node batching pg-input disable")
+        self.assertIsNone(self.show_batching())
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=VppTestRunner)
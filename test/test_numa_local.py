@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 Cisco Systems, Inc.
+
+import unittest
+
+from framework import VppTestCase
+from asfframework import VppTestRunner
+
+
+class TestNumaLocal(VppTestCase):
+    """NUMA local placement"""
+
+    vpp_worker_count = 2
+    extra_vpp_config = ["cpu", "{", "numa-local", "}"]
+
+    def test_rx_placement(self):
+        """Rx queues go to the workers of their interface's node"""
+        reply = self.vapi.cli("test interface rx-placement queues 4")
+        self.logger.info(reply)
+        self.assertIn("PASS", reply)
+        self.assertNotIn("FAIL", reply)
+
+        # a node without workers falls back to round robin over all
+        reply = self.vapi.cli("test interface rx-placement numa 63 queues 4")
+        self.logger.info(reply)
+        self.assertIn("PASS", reply)
+        self.assertNotIn("FAIL", reply)
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=VppTestRunner)
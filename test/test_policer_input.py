@@ -259,6 +259,70 @@ class TestPolicerInput(VppTestCase):
         """Worker thread handoff policer output"""
         self.policer_handoff_test(Dir.TX)
 
+    def policer_shared_test(self, dir: Dir):
+        pkts = self.pkt * NUM_PKTS
+
+        action_tx = PolicerAction(
+            VppEnum.vl_api_sse2_qos_action_type_t.SSE2_QOS_ACTION_API_TRANSMIT, 0
+        )
+        policer = VppPolicer(
+            self,
+            "pol3",
+            80,
+            0,
+            1000,
+            0,
+            conform_action=action_tx,
+            exceed_action=action_tx,
+            violate_action=action_tx,
+        )
+        policer.add_vpp_config()
+
+        sw_if_index = self.pg0.sw_if_index if dir == Dir.RX else self.pg1.sw_if_index
+
+        # Share the policer among the workers
+        policer.share_vpp_config(True)
+        self.assertIn("shared", self.vapi.cli("show policer name pol3"))
+
+        # Start policing on pg0
+        policer.apply_vpp_config(sw_if_index, dir, True)
+
+        for worker in [0, 1]:
+            self.send_and_expect(self.pg0, pkts, self.pg1, worker=worker)
+            self.logger.debug(self.vapi.cli("show trace max 100"))
+
+        stats = policer.get_stats()
+        stats0 = policer.get_stats(worker=0)
+        stats1 = policer.get_stats(worker=1)
+
+        # Both workers police, nothing is handed off, and the burst is shared
+        self.assertEqual(
+            stats0["conform_packets"] + stats0["violate_packets"], NUM_PKTS
+        )
+        self.assertEqual(
+            stats1["conform_packets"] + stats1["violate_packets"], NUM_PKTS
+        )
+        self.assertGreater(stats0["conform_packets"], 0)
+        self.assertGreater(stats["violate_packets"], 0)
+        self.assertLessEqual(stats["conform_packets"], NUM_PKTS)
+
+        # Unshare, and the policer binds to a worker again
+        policer.share_vpp_config(False)
+        self.assertNotIn("shared", self.vapi.cli("show policer name pol3"))
+
+        # Stop policing on pg0
+        policer.apply_vpp_config(sw_if_index, dir, False)
+
+        policer.remove_vpp_config()
+
+    def test_policer_shared_input(self):
+        """Policer shared among workers input"""
+        self.policer_shared_test(Dir.RX)
+
+    def test_policer_shared_output(self):
+        """Policer shared among workers output"""
+        self.policer_shared_test(Dir.TX)
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
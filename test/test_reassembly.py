@@ -613,6 +613,13 @@ Ethernet-Payload.IPv4-Packet.IPv4-Header.Fragment-Offset; Test-case: 5737"""
         self.send_and_assert_no_replies(self.src_if, frags)
         self.vapi.ip_local_reass_enable_disable(enable_ip4=True)
 
+    def test_unittest(self):
+        """2 to 64 fragments in and out of order"""
+        reply = self.vapi.cli("test ip full-reassembly ip4 datagrams 200")
+        self.logger.info(reply)
+        self.assertNotIn("failed", reply)
+        self.assertIn("random", reply)
+
 
 class TestIPv4SVReassembly(VppTestCase):
     """IPv4 Shallow Virtual Reassembly"""
@@ -1764,6 +1771,13 @@ class TestIPv6Reassembly(VppTestCase):
         self.send_and_assert_no_replies(self.src_if, frags)
         self.vapi.ip_local_reass_enable_disable(enable_ip6=True)
 
+    def test_unittest(self):
+        """2 to 64 fragments in and out of order"""
+        reply = self.vapi.cli("test ip full-reassembly ip6 datagrams 200")
+        self.logger.info(reply)
+        self.assertNotIn("failed", reply)
+        self.assertIn("random", reply)
+
 
 class TestIPv6MWReassembly(VppTestCase):
     """IPv6 Reassembly (multiple workers)"""
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 Cisco Systems, Inc.
+
+import re
+import unittest
+
+from scapy.layers.inet import IP, UDP
+from scapy.layers.l2 import Ether
+from scapy.packet import Raw
+
+from framework import VppTestCase
+from asfframework import VppTestRunner
+
+
+class TestTraceSample(VppTestCase):
+    """Sampled packet tracing"""
+
+    def setUp(self):
+        super(TestTraceSample, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+        self.pkt = (
+            Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+            / IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4)
+            / UDP(sport=1234, dport=1234)
+            / Raw(b"\xa5" * 100)
+        )
+
+    def tearDown(self):
+        self.vapi.cli("trace sample off")
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+        super(TestTraceSample, self).tearDown()
+
+    def test_trace_sample(self):
+        """Sampled traces are published without further traffic"""
+        # the nodes a packet is traced in
+        self.vapi.cli("clear trace")
+        self.vapi.cli("trace add pg-input 1")
+        self.send_and_expect(self.pg0, [self.pkt], self.pg1)
+        reply = self.vapi.cli("show trace")
+        self.logger.info(reply)
+        n_nodes = len(re.findall(r"^\d+:\d+:\d+:\d+: \S+$", reply, re.M))
+        self.assertGreater(n_nodes, 1)
+        self.vapi.cli("clear trace")
+
+        # every packet is sampled, and all its records are there once it
+        # is sent, the last one included
+        self.vapi.cli("trace sample pg-input every 1")
+        self.send_and_expect(self.pg0, [self.pkt], self.pg1)
+        reply = self.vapi.cli("show trace sample")
+        self.logger.info(reply)
+        m = re.search(r"(\d+) packets sampled, (\d+) records", reply)
+        self.assertEqual(int(m.group(1)), 1)
+        self.assertEqual(int(m.group(2)), n_nodes)
+        self.assertEqual(len(re.findall(r": packet \d+/\d+ ", reply)), n_nodes)
+        self.assertIn("pg-input", reply)
+
+        self.vapi.cli("trace sample off")
+        self.assertIn("off", self.vapi.cli("show trace sample"))
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=VppTestRunner)
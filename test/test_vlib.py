@@ -146,6 +146,8 @@ class TestVlib(VppTestCase):
             "clear interfaces",
             "test vlib",
             "test vlib2",
+            "test vlib task pairs 1000 rounds 3",
+            "show tasks",
             "show memory api-segment stats-segment main-heap verbose",
             "leak-check { show memory }",
             "show cpu",
@@ -326,5 +328,19 @@ class TestVlibFrameLeak(VppTestCase):
             self.assertEqual(frame_allocated[key], alloc)
 
 
+class TestVlibRcu(VppTestCase):
+    """Vlib epoch based reclamation"""
+
+    vpp_worker_count = 1
+
+    def test_vlib_rcu_stalled_worker(self):
+        """RCU callback waits for a stalled worker"""
+        reply = self.vapi.cli("test vlib rcu hold 0.1")
+        self.logger.info(reply)
+        self.assertIn("PASS", reply)
+        self.assertNotIn("FAIL", reply)
+        self.logger.info(self.vapi.cli("show rcu"))
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -93,6 +93,11 @@ class VppPolicer(VppObject):
             policer_index=self._policer_index, worker_index=worker, bind_enable=bind
         )
 
+    def share_vpp_config(self, share):
+        self._test.vapi.policer_share(
+            policer_index=self._policer_index, share_enable=share
+        )
+
     def apply_vpp_config(self, if_index, dir: Dir, apply):
         if dir == Dir.RX:
             self._test.vapi.policer_input_v2(